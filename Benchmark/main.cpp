@@ -0,0 +1,289 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================================
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Logging/ILogger.h"
+#include "Logging/Log.h"
+#include "Core/Context.h"
+#include "Core/Engine.h"
+#include "Core/Timer.h"
+#include "Core/Stopwatch.h"
+#include "IO/Package.h"
+#include "Threading/Threading.h"
+#include "RHI/RHI_PipelineState.h"
+#include "RHI/RHI_StagingRing.h"
+#include "RHI/RHI_ShaderCache.h"
+#include "RHI/RHI_Device.h"
+#include "RHI/RHI_SwapChain.h"
+#include "RHI/RHI_CommandList.h"
+#include "RHI/RHI_Implementation.h"
+#include "Resource/ResourceCache.h"
+#include "Resource/Import/ImportDatabase.h"
+#include "Resource/Import/ImageImporter.h"
+#include "Resource/Import/ModelImporter.h"
+#include "Resource/Import/MipGenerator.h"
+#include "Resource/Import/BlockCompressor.h"
+#include "Rendering/MeshOptimizer.h"
+#include "Rendering/VertexQuantizer.h"
+#include "Rendering/TextureStreamer.h"
+#include "Rendering/LightClusters.h"
+#include "Rendering/OcclusionCuller.h"
+#include "Rendering/DrawIndirect.h"
+#include "Rendering/DynamicResolution.h"
+#include "Rendering/Renderer.h"
+#include "World/World.h"
+#include "World/Entity.h"
+#include "World/Components/Transform.h"
+#include "World/Components/Renderable.h"
+#include "World/Components/Light.h"
+//===============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//============================
+
+// Runs every benchmark headless and fails if any of them does, then renders a synthetic world
+// on the null RHI and fails if the renderer misused it
+class ConsoleLogger : public ILogger
+{
+public:
+    void Log(const string& log, const uint32_t type) override
+    {
+        fprintf(type == Log_Info ? stdout : stderr, "%s\n", log.c_str());
+    }
+};
+
+// What the null RHI has been asked to do, the counters only go up so runs are compared through deltas
+struct RhiCounters
+{
+    RhiCounters(const RHI_Context* rhi_context)
+    {
+        commands            = rhi_context->commands;
+        draws               = rhi_context->draws;
+        state_changes       = rhi_context->state_changes;
+        submissions         = rhi_context->submissions;
+        bytes_uploaded      = rhi_context->bytes_uploaded;
+        validation_errors   = rhi_context->validation_errors;
+    }
+
+    uint64_t commands           = 0;
+    uint64_t draws              = 0;
+    uint64_t state_changes      = 0;
+    uint64_t submissions        = 0;
+    uint64_t bytes_uploaded     = 0;
+    uint64_t validation_errors  = 0;
+};
+
+static void create_world(World* world, const uint32_t grid_size)
+{
+    // A grid of cubes in front of the default camera, with a point light above every few of them
+    const float spacing = 3.0f;
+    for (uint32_t x = 0; x < grid_size; x++)
+    {
+        for (uint32_t z = 0; z < grid_size; z++)
+        {
+            const Vector3 position = Vector3((static_cast<float>(x) - grid_size * 0.5f) * spacing, 0.0f, static_cast<float>(z) * spacing + 5.0f);
+
+            shared_ptr<Entity>& entity = world->EntityCreate();
+            entity->SetName("Cube");
+            entity->GetTransform()->SetPosition(position);
+            Renderable* renderable = entity->AddComponent<Renderable>();
+            renderable->GeometrySet(Geometry_Default_Cube);
+            renderable->UseDefaultMaterial();
+
+            if ((x % 4) == 0 && (z % 4) == 0)
+            {
+                shared_ptr<Entity>& entity_light = world->EntityCreate();
+                entity_light->SetName("PointLight");
+                entity_light->GetTransform()->SetPosition(position + Vector3(0.0f, 2.0f, 0.0f));
+                Light* light = entity_light->AddComponent<Light>();
+                light->SetLightType(LightType_Point);
+                light->SetRange(spacing * 4.0f);
+                light->SetShadowsEnabled(false);
+            }
+        }
+    }
+}
+
+static bool benchmark_renderer(const Engine& engine, const uint32_t frame_count)
+{
+    Context* context    = engine.GetContext();
+    Renderer* renderer  = context->GetSubsystem<Renderer>();
+    if (!renderer->IsInitialized())
+    {
+        LOG_ERROR("Failed to initialize the renderer");
+        return false;
+    }
+
+    create_world(context->GetSubsystem<World>(), 32);
+
+    // Frames shouldn't be spread out to a frame rate, the limit is restored so that it's not saved to the settings
+    Timer* timer            = context->GetSubsystem<Timer>();
+    const double fps_target = timer->GetTargetFps();
+    timer->SetTargetFps(0.0);
+
+    RHI_SwapChain* swap_chain       = renderer->GetSwapChain();
+    const RHI_Context* rhi_context  = renderer->GetRhiDevice()->GetContextRhi();
+
+    // The first frames resolve the world and create pipelines, they aren't measured
+    const uint32_t frame_count_warmup = 10;
+    vector<float> frame_times;
+    frame_times.reserve(frame_count);
+    RhiCounters counters_start(rhi_context);
+    for (uint32_t i = 0; i < frame_count_warmup + frame_count; i++)
+    {
+        if (i == frame_count_warmup)
+        {
+            counters_start = RhiCounters(rhi_context);
+        }
+
+        Stopwatch stopwatch;
+        swap_chain->GetCmdList()->Begin();
+        engine.Tick();
+        renderer->Present();
+
+        if (i >= frame_count_warmup)
+        {
+            frame_times.emplace_back(stopwatch.GetElapsedTimeMs());
+        }
+    }
+
+    timer->SetTargetFps(fps_target);
+
+    const RhiCounters counters_end(rhi_context);
+    const float frames = static_cast<float>(frame_count);
+    float time_total = 0.0f;
+    for (const float frame_time : frame_times)
+    {
+        time_total += frame_time;
+    }
+    sort(frame_times.begin(), frame_times.end());
+
+    LOG_INFO("Renderer: %d frames, cpu %.2f ms avg, %.2f ms min, %.2f ms max, %.2f ms 95th percentile",
+        frame_count, time_total / frames, frame_times.front(), frame_times.back(), frame_times[static_cast<size_t>(frames * 0.95f)]);
+    LOG_INFO("Renderer: per frame, %.0f commands, %.0f draws, %.0f state changes, %.1f submissions, %.1f KB uploaded",
+        (counters_end.commands - counters_start.commands) / frames,
+        (counters_end.draws - counters_start.draws) / frames,
+        (counters_end.state_changes - counters_start.state_changes) / frames,
+        (counters_end.submissions - counters_start.submissions) / frames,
+        (counters_end.bytes_uploaded - counters_start.bytes_uploaded) / frames / 1024.0f);
+
+    // Errors made while warming up count too
+    if (counters_end.validation_errors != 0)
+    {
+        LOG_ERROR("Renderer: %llu validation errors", counters_end.validation_errors);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const string directory_data     = argc > 1 ? argv[1] : "Data";
+    const uint32_t frame_count      = argc > 2 ? static_cast<uint32_t>(max(atoi(argv[2]), 1)) : 300;
+    const string directory_shaders  = directory_data + "/shaders";
+    const string directory_temp     = (filesystem::temp_directory_path() / "spartan_benchmark").string();
+
+    shared_ptr<ConsoleLogger> logger = make_shared<ConsoleLogger>();
+    Log::SetLogger(logger);
+    LOG_TO_FILE(false);
+
+    // Only threading is needed, the benchmarks which take a context use it to go wide
+    Context context;
+    context.RegisterSubsystem<Threading>();
+    Threading* threading = context.GetSubsystem<Threading>();
+
+    const vector<pair<const char*, function<bool()>>> benchmarks =
+    {
+        { "RHI_PipelineState",  [&]() { return RHI_PipelineState::Benchmark(); } },
+        { "RHI_RingAllocator",  [&]() { return RHI_RingAllocator::Benchmark(); } },
+        { "RHI_ShaderCache",    [&]() { return RHI_ShaderCache::Benchmark(directory_shaders, directory_temp + "/shader_cache"); } },
+        { "ImportDatabase",     [&]() { return ImportDatabase::Benchmark(directory_temp); } },
+        { "ModelImporter",      [&]() { return ModelImporter::Benchmark(threading); } },
+        { "MipGenerator",       [&]() { return MipGenerator::Benchmark(threading); } },
+        { "BlockCompressor",    [&]() { return BlockCompressor::Benchmark(threading); } },
+        { "Package",            [&]() { return Package::Benchmark(directory_data, threading); } },
+        { "MeshOptimizer",      [&]() { return MeshOptimizer::Benchmark(); } },
+        { "VertexQuantizer",    [&]() { return VertexQuantizer::Benchmark(); } },
+        { "TextureStreamer",    [&]() { return TextureStreamer::Benchmark(); } },
+        { "LightClusters",      [&]() { return LightClusters::Benchmark(&context, 256); } },
+        { "OcclusionCuller",    [&]() { return OcclusionCuller::Benchmark(&context, 10000); } },
+        { "DrawIndirect",       [&]() { return DrawIndirect::Benchmark(10000); } },
+        { "DynamicResolution",  [&]() { return DynamicResolution::Simulate(); } }
+    };
+
+    error_code error;
+    filesystem::create_directories(directory_temp, error);
+
+    uint32_t failures = 0;
+    for (const auto& benchmark : benchmarks)
+    {
+        if (!benchmark.second())
+        {
+            LOG_ERROR("%s failed", benchmark.first);
+            failures++;
+        }
+    }
+
+    filesystem::remove_all(directory_temp, error);
+
+    // A null window handle makes the engine headless, which only the null RHI can render
+    WindowData window_data;
+    window_data.width   = 1920;
+    window_data.height  = 1080;
+    Engine engine(window_data);
+
+    const vector<pair<const char*, function<bool()>>> benchmarks_engine =
+    {
+        { "ImageImporter",      [&]() { return engine.GetContext()->GetSubsystem<ResourceCache>()->GetImageImporter()->Benchmark(); } },
+        { "Renderer",           [&]() { return benchmark_renderer(engine, frame_count); } }
+    };
+
+    for (const auto& benchmark : benchmarks_engine)
+    {
+        if (!benchmark.second())
+        {
+            LOG_ERROR("%s failed", benchmark.first);
+            failures++;
+        }
+    }
+
+    const uint32_t benchmark_count = static_cast<uint32_t>(benchmarks.size() + benchmarks_engine.size());
+    if (failures != 0)
+    {
+        LOG_ERROR("%d of %d benchmarks failed", failures, benchmark_count);
+        return 1;
+    }
+
+    LOG_INFO("All %d benchmarks passed", benchmark_count);
+    return 0;
+}
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common_Buffer.hlsl"
 #include "Common_Sampler.hlsl"
 #include "Common_Texture.hlsl"
+#include "Common_Instance.hlsl"
 //============================
 
 /*------------------------------------------------------------------------------
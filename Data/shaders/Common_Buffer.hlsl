@@ -29,6 +29,7 @@ cbuffer BufferFrame : register(b0)
     matrix g_viewProjectionInv;
     matrix g_viewProjectionOrtho;
     matrix g_viewProjectionUnjittered;
+    matrix g_viewProjectionPrevious;
 
     float g_delta_time;
     float g_time;
@@ -99,6 +100,8 @@ cbuffer BufferObject : register(b3)
     matrix g_object_transform;
     matrix g_object_wvp_current;
     matrix g_object_wvp_previous;
+    uint g_object_material_index;
+    float3 g_object_padding;
 };
 
 // High frequency - Updates per light
@@ -110,4 +113,24 @@ cbuffer LightBuffer : register(b4)
     float normal_bias;
     float4 position;
     float4 direction;
+    float4 light_atlas_rect[6]; // xy: offset, zw: scale
+    float2 light_atlas_texel_size;
+    float2 light_padding;
+};
+
+// Low frequency - Updates once per frame
+static const uint g_cluster_grid_x              = 16;
+static const uint g_cluster_grid_y              = 9;
+static const uint g_cluster_grid_z              = 24;
+static const uint g_cluster_count               = g_cluster_grid_x * g_cluster_grid_y * g_cluster_grid_z;
+static const uint g_cluster_max_lights          = 256;
+static const uint g_cluster_max_light_indices   = 16384;
+cbuffer BufferLightClusters : register(b5)
+{
+    float4 cluster_light_count_slice_scale_bias;
+    float4 cluster_position_range[g_cluster_max_lights];
+    float4 cluster_color_intensity[g_cluster_max_lights];
+    float4 cluster_direction_angle[g_cluster_max_lights];   // angle is negative for point lights
+    uint4 cluster_offset_count[g_cluster_count / 4];        // offset in the low 16 bits, count in the high 16 bits
+    uint4 cluster_light_indices[g_cluster_max_light_indices / 16]; // a byte per index
 };
\ No newline at end of file
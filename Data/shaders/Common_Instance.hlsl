@@ -0,0 +1,42 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#if INDIRECT
+// Indirect draws - every draw carries the index of its instance in its first instance
+struct Instance
+{
+    matrix transform;
+    matrix transform_previous;
+    float3 aabb_min;
+    uint material_index;
+    float3 aabb_max;
+    uint index_count;
+    uint index_offset;
+    int vertex_offset;
+    uint2 padding;
+};
+
+[[vk::binding(2, 1)]] StructuredBuffer<Instance> bindless_instances;
+
+// SV_InstanceID doesn't include the first instance, so it's added back
+#define INSTANCE_INPUT uint instance_id : SV_InstanceID, [[vk::builtin("BaseInstance")]] uint instance_base : BASE_INSTANCE
+#define instance_index (instance_base + instance_id)
+#endif
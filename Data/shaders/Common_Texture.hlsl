@@ -39,10 +39,8 @@ Texture2D tex_depth                     : register(t12);
 // Light depth/color maps
 Texture2DArray light_directional_depth  : register(t13);
 Texture2DArray light_directional_color  : register(t14);
-TextureCube light_point_depth           : register(t15);
-TextureCube light_point_color           : register(t16);
-Texture2D light_spot_depth              : register(t17);
-Texture2D light_spot_color              : register(t18);
+Texture2D light_atlas_depth             : register(t15); // point and spot lights
+Texture2D light_atlas_color             : register(t16); // point and spot lights
 
 // Misc
 Texture2D tex_lutIbl                    : register(t19);
@@ -44,6 +44,16 @@ struct Vertex_PosUvNorTan
     float3 tangent      : TANGENT0;
 };
 
+// Quantized Vertex_PosUvNorTan (RHI_Vertex_PosTexNorTan16), the input assembler converts the position (snorm, relative to the
+// model's bounding box, which the object's transform accounts for) and the uv (half), the normal and the tangent are octahedral
+struct Vertex_PosUvNorTan16
+{
+    float4 position     : POSITION0;
+    float2 uv           : TEXCOORD0;
+    float2 normal       : NORMAL0;
+    float2 tangent      : TANGENT0;
+};
+
 struct Vertex_Pos2dUvColor
 {
     float2 position     : POSITION0;
@@ -66,4 +76,35 @@ struct Pixel_PosColor
 {
     float4 position : SV_POSITION;
     float4 color    : COLOR;
-};
\ No newline at end of file
+};
+// The same as VertexQuantizer::OctahedralDecode()
+float3 octahedral_decode(float2 encoded)
+{
+    float3 direction = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold       = saturate(-direction.z);
+    direction.x      += direction.x >= 0.0f ? -fold : fold;
+    direction.y      += direction.y >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
+Vertex_PosUvNorTan vertex_decode(Vertex_PosUvNorTan16 input)
+{
+    Vertex_PosUvNorTan output;
+    output.position = input.position;
+    output.uv       = input.uv;
+    output.normal   = octahedral_decode(input.normal);
+    output.tangent  = octahedral_decode(input.tangent);
+    return output;
+}
+
+Vertex_PosUvNorTan vertex_decode(Vertex_PosUvNorTan input)
+{
+    return input;
+}
+
+// Meshes come in either layout, shaders which are compiled with QUANTIZED take the quantized one
+#if QUANTIZED
+#define Vertex_Mesh Vertex_PosUvNorTan16
+#else
+#define Vertex_Mesh Vertex_PosUvNorTan
+#endif
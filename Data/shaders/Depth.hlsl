@@ -23,7 +23,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common.hlsl"
 //====================
 
-Pixel_PosUv mainVS(Vertex_PosUv input)
+// Quantized meshes have a single layout, which the input assembler converts, so only the struct differs
+#if QUANTIZED
+#define Vertex_Depth Vertex_PosUvNorTan16
+#else
+#define Vertex_Depth Vertex_PosUv
+#endif
+
+#if INDIRECT
+// The object transform holds the pass' view projection, the world transform comes from the instance
+Pixel_PosUv mainVS(Vertex_Depth input, INSTANCE_INPUT)
+{
+    Pixel_PosUv output;
+
+    input.position.w    = 1.0f; 
+    output.position     = mul(mul(input.position, bindless_instances[instance_index].transform), g_object_transform);
+    output.uv           = input.uv;
+
+    return output;
+}
+#else
+Pixel_PosUv mainVS(Vertex_Depth input)
 {
     Pixel_PosUv output;
 
@@ -33,6 +53,7 @@ Pixel_PosUv mainVS(Vertex_PosUv input)
 
     return output;
 }
+#endif
 
 float4 mainPS(Pixel_PosUv input) : SV_TARGET
 {
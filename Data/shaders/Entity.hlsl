@@ -31,10 +31,11 @@ struct PixelInputType
     float3 positionWS   : POSITIONT_WS;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+PixelInputType mainVS(Vertex_Mesh input_mesh)
 {
     PixelInputType output;
 
+    Vertex_PosUvNorTan input = vertex_decode(input_mesh);
     input.position.w = 1.0f;
     output.positionWS = mul(input.position, g_transform).xyz;
     output.position = mul(float4(output.positionWS, 1.0f), g_viewProjectionUnjittered);
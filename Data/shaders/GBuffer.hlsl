@@ -32,6 +32,9 @@ struct PixelInputType
     float3 tangent              : TANGENT;
     float4 position_ss_current  : SCREEN_POS;
     float4 position_ss_previous : SCREEN_POS_PREVIOUS;
+    #if INDIRECT
+    nointerpolation uint material_index : MATERIAL_INDEX;
+    #endif
 };
 
 struct PixelOutputType
@@ -42,10 +45,33 @@ struct PixelOutputType
     float2 velocity : SV_Target3;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+#if INDIRECT
+// Transforms and the material index come from the instance, the previous frame's position is rebuilt from its previous transform
+PixelInputType mainVS(Vertex_Mesh input_mesh, INSTANCE_INPUT)
+{
+    PixelInputType output;
+
+    Vertex_PosUvNorTan input    = vertex_decode(input_mesh);
+    Instance instance           = bindless_instances[instance_index];
+
+    input.position.w            = 1.0f;
+    output.position_ss_previous = mul(mul(input.position, instance.transform_previous), g_viewProjectionPrevious);
+    output.position             = mul(input.position, instance.transform);
+    output.position             = mul(output.position, g_viewProjection);
+    output.position_ss_current  = output.position;
+    output.normal               = normalize(mul(input.normal, (float3x3)instance.transform)).xyz;
+    output.tangent              = normalize(mul(input.tangent, (float3x3)instance.transform)).xyz;
+    output.uv                   = input.uv;
+    output.material_index       = instance.material_index;
+
+    return output;
+}
+#else
+PixelInputType mainVS(Vertex_Mesh input_mesh)
 {
     PixelInputType output;
     
+    Vertex_PosUvNorTan input    = vertex_decode(input_mesh);
     input.position.w            = 1.0f;     
     output.position_ss_previous = mul(input.position, g_object_wvp_previous);
     output.position             = mul(input.position, g_object_transform);
@@ -57,19 +83,99 @@ PixelInputType mainVS(Vertex_PosUvNorTan input)
     
     return output;
 }
+#endif
+
+#if BINDLESS
+// Bindless path - textures and material parameters are fetched through the object's material index
+struct MaterialBindless
+{
+    float4 color;
+    float2 tiling_uv;
+    float2 offset_uv;
+    float roughness_mul;
+    float metallic_mul;
+    float normal_mul;
+    float height_mul;
+    uint texture_color;
+    uint texture_roughness;
+    uint texture_metallic;
+    uint texture_normal;
+    uint texture_height;
+    uint texture_occlusion;
+    uint texture_emission;
+    uint texture_mask;
+};
+
+[[vk::binding(0, 1)]] Texture2D bindless_textures[4096];
+[[vk::binding(1, 1)]] StructuredBuffer<MaterialBindless> bindless_materials;
+
+// Indirect draws share the object buffer, so the material slot travels with the vertices and the object buffer holds the frame's region
+#if INDIRECT
+#define bindless_material_slot  input.material_index
+#define bindless_material_index (g_object_material_index + input.material_index)
+#else
+#define bindless_material_slot  (g_object_material_index % g_max_materials)
+#define bindless_material_index g_object_material_index
+#endif
+
+// Index 0 is never handed out, so it doubles as "no texture"
+#define ALBEDO_MAP      (material.texture_color != 0)
+#define ROUGHNESS_MAP   (material.texture_roughness != 0)
+#define METALLIC_MAP    (material.texture_metallic != 0)
+#define NORMAL_MAP      (material.texture_normal != 0)
+#define HEIGHT_MAP      (material.texture_height != 0)
+#define OCCLUSION_MAP   (material.texture_occlusion != 0)
+#define EMISSION_MAP    (material.texture_emission != 0)
+#define MASK_MAP        (material.texture_mask != 0)
+
+#define material_albedo     bindless_textures[material.texture_color]
+#define material_roughness  bindless_textures[material.texture_roughness]
+#define material_metallic   bindless_textures[material.texture_metallic]
+#define material_normal     bindless_textures[material.texture_normal]
+#define material_height     bindless_textures[material.texture_height]
+#define material_occlusion  bindless_textures[material.texture_occlusion]
+#define material_emission   bindless_textures[material.texture_emission]
+#define material_mask       bindless_textures[material.texture_mask]
+#else
+#define material_albedo     tex_material_albedo
+#define material_roughness  tex_material_roughness
+#define material_metallic   tex_material_metallic
+#define material_normal     tex_material_normal
+#define material_height     tex_material_height
+#define material_occlusion  tex_material_occlusion
+#define material_emission   tex_material_emission
+#define material_mask       tex_material_mask
+#endif
 
 PixelOutputType mainPS(PixelInputType input)
 {
     PixelOutputType g_buffer;
 
-    float2 texCoords    = float2(input.uv.x * g_mat_tiling.x + g_mat_offset.x, input.uv.y * g_mat_tiling.y + g_mat_offset.y);
-    float4 albedo       = g_mat_color;
-    float roughness     = g_mat_roughness;
-    float metallic      = g_mat_metallic;
+    #if BINDLESS
+    MaterialBindless material   = bindless_materials[bindless_material_index];
+    float2 tiling               = material.tiling_uv;
+    float2 offset               = material.offset_uv;
+    float4 albedo               = material.color;
+    float roughness             = material.roughness_mul;
+    float metallic              = material.metallic_mul;
+    float normal_mul            = material.normal_mul;
+    float height_mul            = material.height_mul;
+    float material_id           = bindless_material_slot / float(65535);
+    #else
+    float2 tiling               = g_mat_tiling;
+    float2 offset               = g_mat_offset;
+    float4 albedo               = g_mat_color;
+    float roughness             = g_mat_roughness;
+    float metallic              = g_mat_metallic;
+    float normal_mul            = g_mat_normal;
+    float height_mul            = g_mat_height;
+    float material_id           = g_mat_id / float(65535);
+    #endif
+
+    float2 texCoords    = float2(input.uv.x * tiling.x + offset.x, input.uv.y * tiling.y + offset.y);
     float3 normal       = input.normal.xyz;
     float emission      = 0.0f;
     float occlusion     = 1.0f;
-    float material_id   = g_mat_id / float(65535);
     
     //= VELOCITY ================================================================================
     float2 position_current     = (input.position_ss_current.xy / input.position_ss_current.w);
@@ -78,58 +184,65 @@ PixelOutputType mainPS(PixelInputType input)
     float2 velocity             = (position_delta - g_taa_jitter_offset) * float2(0.5f, -0.5f);
     //===========================================================================================
 
-    // Make TBN
-    #if HEIGHT_MAP || NORMAL_MAP
+    // Make TBN (the compiler strips it when neither map can be present)
     float3x3 TBN = makeTBN(input.normal, input.tangent);
-    #endif
 
-    #if HEIGHT_MAP
+    if (HEIGHT_MAP)
+    {
         // Parallax Mapping
-        float height_scale      = g_mat_height * 0.04f;
+        float height_scale      = height_mul * 0.04f;
         float3 camera_to_pixel  = normalize(g_camera_position - input.position.xyz);
-        texCoords               = ParallaxMapping(tex_material_height, sampler_anisotropic_wrap, texCoords, camera_to_pixel, TBN, height_scale);
-    #endif
+        texCoords               = ParallaxMapping(material_height, sampler_anisotropic_wrap, texCoords, camera_to_pixel, TBN, height_scale);
+    }
     
     float mask_threshold = 0.6f;
     
-    #if MASK_MAP
-        float3 maskSample = tex_material_mask.Sample(sampler_anisotropic_wrap, texCoords).rgb;
+    if (MASK_MAP)
+    {
+        float3 maskSample = material_mask.Sample(sampler_anisotropic_wrap, texCoords).rgb;
         if (maskSample.r <= mask_threshold && maskSample.g <= mask_threshold && maskSample.b <= mask_threshold)
             discard;
-    #endif
+    }
 
-    #if ALBEDO_MAP
-        float4 albedo_sample = tex_material_albedo.Sample(sampler_anisotropic_wrap, texCoords);
+    if (ALBEDO_MAP)
+    {
+        float4 albedo_sample = material_albedo.Sample(sampler_anisotropic_wrap, texCoords);
         if (albedo_sample.a <= mask_threshold)
             discard;
 
         albedo_sample.rgb = degamma(albedo_sample.rgb);
         albedo *= albedo_sample;
-    #endif
+    }
     
-    #if ROUGHNESS_MAP
-        roughness *= tex_material_roughness.Sample(sampler_anisotropic_wrap, texCoords).r;
-    #endif
+    if (ROUGHNESS_MAP)
+    {
+        roughness *= material_roughness.Sample(sampler_anisotropic_wrap, texCoords).r;
+    }
     
-    #if METALLIC_MAP
-        metallic *= tex_material_metallic.Sample(sampler_anisotropic_wrap, texCoords).r;
-    #endif
+    if (METALLIC_MAP)
+    {
+        metallic *= material_metallic.Sample(sampler_anisotropic_wrap, texCoords).r;
+    }
     
-    #if NORMAL_MAP
-        // Get tangent space normal and apply intensity
-        float3 tangent_normal   = normalize(unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, texCoords).rgb));
-        float normal_intensity  = clamp(g_mat_normal, 0.012f, g_mat_normal);
+    if (NORMAL_MAP)
+    {
+        // Get tangent space normal (z is reconstructed, block compressed normal maps only store x and y) and apply intensity
+        float2 normal_xy        = unpack(material_normal.Sample(sampler_anisotropic_wrap, texCoords).rg);
+        float3 tangent_normal   = normalize(float3(normal_xy, sqrt(saturate(1.0f - dot(normal_xy, normal_xy)))));
+        float normal_intensity  = clamp(normal_mul, 0.012f, normal_mul);
         tangent_normal.xy       *= saturate(normal_intensity);
         normal                  = normalize(mul(tangent_normal, TBN).xyz); // Transform to world space
-    #endif
+    }
 
-    #if OCCLUSION_MAP
-        occlusion = tex_material_occlusion.Sample(sampler_anisotropic_wrap, texCoords).r;
-    #endif
+    if (OCCLUSION_MAP)
+    {
+        occlusion = material_occlusion.Sample(sampler_anisotropic_wrap, texCoords).r;
+    }
     
-    #if EMISSION_MAP
-        emission = tex_material_emission.Sample(sampler_anisotropic_wrap, texCoords).r;
-    #endif
+    if (EMISSION_MAP)
+    {
+        emission = material_emission.Sample(sampler_anisotropic_wrap, texCoords).r;
+    }
 
     // Write to G-Buffer
     g_buffer.albedo     = albedo;
@@ -39,15 +39,92 @@ float attunation_distance(const Light light)
     return attenuation * attenuation;
 }
 
-float attunation_angle(const Light light)
+float attunation_angle(const Light light, const float3 light_forward)
 {
     float cutoffAngle       = 1.0f - light.angle;
-    float light_dot_pixel   = dot(direction.xyz, light.direction);
+    float light_dot_pixel   = dot(light_forward, light.direction);
     float epsilon           = cutoffAngle - cutoffAngle * 0.9f;
     float attenuation       = saturate((light_dot_pixel - cutoffAngle) / epsilon); // attenuate when approaching the outer cone
     return attenuation * attenuation;
 }
 
+// Reflectance equation
+void reflectance(Surface surface, Material material, Light light, inout float3 diffuse_out, inout float3 specular_out, out float3 reflective_energy)
+{
+    // Compute some vectors and dot products
+    float3 l        = -light.direction;
+    float3 v        = -surface.camera_to_pixel;
+    float3 h        = normalize(v + l);
+    float l_dot_h   = saturate(dot(l, h));
+    float v_dot_h   = saturate(dot(v, h));
+    float n_dot_v   = saturate(dot(surface.normal, v));
+    float n_dot_l   = saturate(dot(surface.normal, l));
+    float n_dot_h   = saturate(dot(surface.normal, h));
+
+    float3 diffuse_energy   = 1.0f;
+    reflective_energy       = 1.0f;
+    
+    // Specular
+    float3 specular = 0.0f;
+    if (material.anisotropic == 0.0f)
+    {
+        specular = BRDF_Specular_Isotropic(material, n_dot_v, n_dot_l, n_dot_h, v_dot_h, diffuse_energy, reflective_energy);
+    }
+    else
+    {
+        specular = BRDF_Specular_Anisotropic(material, surface, v, l, h, n_dot_v, n_dot_l, n_dot_h, l_dot_h, diffuse_energy, reflective_energy);
+    }
+
+    // Specular clearcoat
+    float3 specular_clearcoat = 0.0f;
+    if (material.clearcoat != 0.0f)
+    {
+        specular_clearcoat = BRDF_Specular_Clearcoat(material, n_dot_h, v_dot_h, diffuse_energy, reflective_energy);
+    }
+
+    // Sheen
+    float3 specular_sheen = 0.0f;
+    if (material.sheen != 0.0f)
+    {
+        specular_sheen = BRDF_Specular_Sheen(material, n_dot_v, n_dot_l, n_dot_h, diffuse_energy, reflective_energy);
+    }
+    
+    // Diffuse
+    float3 diffuse = BRDF_Diffuse(material, n_dot_v, n_dot_l, v_dot_h);
+
+    // Tone down diffuse such as that only non metals have it
+    diffuse *= diffuse_energy;
+
+    float3 radiance = light.color * n_dot_l;
+
+    diffuse_out     += diffuse * radiance;
+    specular_out    += (specular + specular_clearcoat + specular_sheen) * radiance;
+}
+
+#if CLUSTERED
+uint cluster_get_index(float2 uv, float depth_view)
+{
+    // Exponential depth slices, see LightClusters.cpp
+    float slice_scale   = cluster_light_count_slice_scale_bias.y;
+    float slice_bias    = cluster_light_count_slice_scale_bias.z;
+    uint z              = (uint)clamp(floor(log(max(depth_view, g_camera_near)) * slice_scale - slice_bias), 0.0f, g_cluster_grid_z - 1.0f);
+    uint x              = min((uint)(uv.x * g_cluster_grid_x), g_cluster_grid_x - 1);
+    uint y              = min((uint)(uv.y * g_cluster_grid_y), g_cluster_grid_y - 1);
+    return x + g_cluster_grid_x * (y + g_cluster_grid_y * z);
+}
+
+uint cluster_get_offset_count(uint cluster_index)
+{
+    return cluster_offset_count[cluster_index / 4][cluster_index % 4];
+}
+
+uint cluster_get_light_index(uint i)
+{
+    uint word = cluster_light_indices[i / 16][(i / 4) % 4];
+    return (word >> ((i % 4) * 8)) & 0xFF;
+}
+#endif
+
 PixelOutputType mainPS(Pixel_PosUv input)
 {
     PixelOutputType light_out;
@@ -93,6 +170,59 @@ PixelOutputType mainPS(Pixel_PosUv input)
         material.is_sky                 = mat_id == 0;
     }
 
+    // Compute multi-bounce ambient occlusion
+    float3 multi_bounce_ao = MultiBounceAO(material.occlusion, sample_albedo.rgb);
+
+    float3 diffuse              = 0.0f;
+    float3 specular             = 0.0f;
+    float3 reflective_energy    = 1.0f;
+    bool lit                    = false;
+
+    #if CLUSTERED
+    // Iterate over the lights which overlap this pixel's cluster, the reflective energy is
+    // accumulated so that SSR ends up weighted the same as it would be by one pass per light
+    [branch]
+    if (!material.is_sky)
+    {
+        reflective_energy   = 0.0f;
+        float depth_view    = mul(float4(surface.position, 1.0f), g_view).z;
+        uint offset_count   = cluster_get_offset_count(cluster_get_index(input.uv, depth_view));
+        uint offset         = offset_count & 0xFFFF;
+        uint count          = offset_count >> 16;
+
+        [loop]
+        for (uint i = 0; i < count; i++)
+        {
+            uint index                  = cluster_get_light_index(offset + i);
+            float4 position_range       = cluster_position_range[index];
+            float4 color_intensity      = cluster_color_intensity[index];
+            float4 direction_angle      = cluster_direction_angle[index];
+
+            Light light;
+            light.color                 = color_intensity.rgb * color_intensity.a;
+            light.position              = position_range.xyz;
+            light.range                 = position_range.w;
+            light.angle                 = direction_angle.w;
+            light.bias                  = 0.0f;
+            light.normal_bias           = 0.0f;
+            light.array_size            = 1;
+            light.distance_to_pixel     = length(surface.position - light.position);
+            light.direction             = normalize(surface.position - light.position);
+            light.color                 *= attunation_distance(light); // attenuate
+            light.color                 *= light.angle >= 0.0f ? attunation_angle(light, direction_angle.xyz) : 1.0f;
+            light.color                 *= multi_bounce_ao;
+
+            [branch]
+            if (any(light.color))
+            {
+                float3 light_reflective_energy;
+                reflectance(surface, material, light, diffuse, specular, light_reflective_energy);
+                reflective_energy   += light_reflective_energy;
+                lit                 = true;
+            }
+        }
+    }
+    #else
     // Fill light struct
     float light_intensity = intensity_range_angle_bias.x;
     
@@ -114,7 +244,7 @@ PixelOutputType mainPS(Pixel_PosUv input)
     #elif SPOT
     light.array_size    = 1;
     light.direction     = normalize(surface.position - light.position);
-    light.color         *= attunation_distance(light) * attunation_angle(light); // attenuate
+    light.color         *= attunation_distance(light) * attunation_angle(light, direction.xyz); // attenuate
     #endif
     
     // Compute shadows and volumetric fog/light
@@ -143,60 +273,22 @@ PixelOutputType mainPS(Pixel_PosUv input)
         #endif
     }
 
-    // Compute multi-bounce ambient occlusion
-    float3 multi_bounce_ao = MultiBounceAO(material.occlusion, sample_albedo.rgb);
-
     // Modulate light with shadow color, visibility and ambient occlusion
     light.color *= shadow.rgb * shadow.a * multi_bounce_ao;
 
-    // Reflectance equation
     [branch]
     if (any(light.color) && !material.is_sky)
     {
-        // Compute some vectors and dot products
-        float3 l        = -light.direction;
-        float3 v        = -surface.camera_to_pixel;
-        float3 h        = normalize(v + l);
-        float l_dot_h   = saturate(dot(l, h));
-        float v_dot_h   = saturate(dot(v, h));
-        float n_dot_v   = saturate(dot(surface.normal, v));
-        float n_dot_l   = saturate(dot(surface.normal, l));
-        float n_dot_h   = saturate(dot(surface.normal, h));
-
-        float3 diffuse_energy       = 1.0f;
-        float3 reflective_energy    = 1.0f;
-        
-        // Specular
-        float3 specular = 0.0f;
-        if (material.anisotropic == 0.0f)
-        {
-            specular = BRDF_Specular_Isotropic(material, n_dot_v, n_dot_l, n_dot_h, v_dot_h, diffuse_energy, reflective_energy);
-        }
-        else
-        {
-            specular = BRDF_Specular_Anisotropic(material, surface, v, l, h, n_dot_v, n_dot_l, n_dot_h, l_dot_h, diffuse_energy, reflective_energy);
-        }
-
-        // Specular clearcoat
-        float3 specular_clearcoat = 0.0f;
-        if (material.clearcoat != 0.0f)
-        {
-            specular_clearcoat = BRDF_Specular_Clearcoat(material, n_dot_h, v_dot_h, diffuse_energy, reflective_energy);
-        }
-
-        // Sheen
-        float3 specular_sheen = 0.0f;
-        if (material.sheen != 0.0f)
-        {
-            specular_sheen = BRDF_Specular_Sheen(material, n_dot_v, n_dot_l, n_dot_h, diffuse_energy, reflective_energy);
-        }
-        
-        // Diffuse
-        float3 diffuse = BRDF_Diffuse(material, n_dot_v, n_dot_l, v_dot_h);
+        reflectance(surface, material, light, diffuse, specular, reflective_energy);
+        lit = true;
+    }
 
-        // Tone down diffuse such as that only non metals have it
-        diffuse *= diffuse_energy;
+    light_out.volumetric.rgb = saturate_16(volumetric);
+    #endif
 
+    [branch]
+    if (lit)
+    {
         // SSR
         float3 light_reflection = 0.0f;
         #if SCREEN_SPACE_REFLECTIONS
@@ -211,16 +303,9 @@ PixelOutputType mainPS(Pixel_PosUv input)
         }
         #endif
 
-        float3 radiance = light.color * n_dot_l;
-        
-        light_out.diffuse.rgb  = saturate_16(diffuse * radiance);
-        light_out.specular.rgb = saturate_16((specular + specular_clearcoat + specular_sheen) * radiance + light_reflection);
-        
+        light_out.diffuse.rgb  = saturate_16(diffuse);
+        light_out.specular.rgb = saturate_16(specular + light_reflection);
     }
 
-    light_out.volumetric.rgb = saturate_16(volumetric);
-
     return light_out;
 }
-
-
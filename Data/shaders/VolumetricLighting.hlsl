@@ -39,15 +39,16 @@ float vl_raymarch(Light light, float3 ray_pos, float3 ray_step, float ray_dot_li
     
     for (uint i = 0; i < g_vl_steps; i++)
     {
+        // The cube face (atlas tile) can change along the ray
+        #if POINT
+        array_index = direction_to_cube_face_index(normalize(ray_pos - light.position));
+        #endif
+
         // Compute position in clip space
         float3 pos = project(ray_pos, light_view_projection[array_index]);
         
         // Compare depth
-        #if POINT
-        float depth_delta = compare_depth(normalize(ray_pos - light.position), pos.z);
-        #else // directional & spot
         float depth_delta = compare_depth(float3(pos.xy, array_index), pos.z);
-        #endif
        
         // Depth test
         if (abs(g_vl_tolerance - depth_delta) > g_vl_tolerance)
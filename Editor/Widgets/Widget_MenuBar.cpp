@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../WidgetsDeferred/FileDialog.h"
 #include "Core/Settings.h"
 #include "Rendering/Model.h"
+#include "Rendering/Renderer.h"
 //========================================
 
 //= NAMESPACES ==========
@@ -94,6 +95,17 @@ void Widget_MenuBar::Tick()
 			ImGui::EndMenu();
 		}
 
+		if (ImGui::BeginMenu("Tools"))
+		{
+			// Fills the shader cache, so it can ship and nothing compiles at runtime
+			if (ImGui::MenuItem("Precompile all shader variations"))
+			{
+				m_context->GetSubsystem<Renderer>()->GetShaderPrecompiler()->Precompile(ShaderPrecompile_All);
+			}
+
+			ImGui::EndMenu();
+		}
+
 		if (ImGui::BeginMenu("Help"))
 		{
 			ImGui::MenuItem("About", nullptr, &_Widget_MenuBar::g_showAboutWindow);
@@ -424,6 +424,7 @@ void Widget_Properties::ShowRenderable(Renderable* renderable) const
 		auto material_name		= material ? material->GetResourceName() : "N/A";
 		bool cast_shadows		= renderable->GetCastShadows();
 		bool receive_shadows	= renderable->GetReceiveShadows();
+		bool occluder			= renderable->IsOccluder();
 		//=======================================================================
 
 		ImGui::Text("Mesh");
@@ -450,9 +451,15 @@ void Widget_Properties::ShowRenderable(Renderable* renderable) const
 		ImGui::Text("Receive Shadows");
 		ImGui::SameLine(ComponentProperty::g_column); ImGui::Checkbox("##RenderableReceiveShadows", &receive_shadows);
 
+		// Occluder
+		ImGui::Text("Occluder");
+		ImGui::SameLine(ComponentProperty::g_column); ImGui::Checkbox("##RenderableOccluder", &occluder);
+		ImGuiEx::Tooltip("Always rasterized by occlusion culling, best suited for large, low poly meshes like walls");
+
 		//= MAP ==============================================================================================
 		if (cast_shadows != renderable->GetCastShadows())		renderable->SetCastShadows(cast_shadows);
 		if (receive_shadows != renderable->GetReceiveShadows())	renderable->SetReceiveShadows(receive_shadows);
+		if (occluder != renderable->IsOccluder())				renderable->SetOccluder(occluder);
 		//====================================================================================================
 	}
 	ComponentProperty::End();
@@ -64,6 +64,7 @@ void Widget_RenderOptions::Tick()
         bool do_chromatic_aberration    = m_renderer->GetOption(Render_ChromaticAberration);
         bool do_dithering               = m_renderer->GetOption(Render_Dithering);
         bool do_indirect_bounce         = m_renderer->GetOption(Render_IndirectBounce);
+        bool do_dynamic_resolution      = m_renderer->GetOption(Render_DynamicResolution);
         int resolution_shadow           = m_renderer->GetOptionValue<int>(Option_Value_ShadowResolution);
 
         // Display
@@ -138,6 +139,20 @@ void Widget_RenderOptions::Tick()
                     }
                     ImGui::EndCombo();
                 }
+
+                // Dynamic resolution
+                ImGui::Checkbox("Dynamic resolution", &do_dynamic_resolution); ImGui::SameLine();
+                render_option_float("##dynamic_resolution_option_1", "Target (ms)", Option_Value_Dynamic_Resolution_Target, "Frame time that the GPU should stay under, the render resolution scales down when it's exceeded", 1.0f);
+                if (do_dynamic_resolution)
+                {
+                    const Vector2& resolution_render = m_renderer->GetResolutionRender();
+                    ImGui::Text("Rendering at %dx%d (%.0f%%)", static_cast<int>(resolution_render.x), static_cast<int>(resolution_render.y), m_renderer->GetResolutionScale() * 100.0f);
+                }
+                ImGui::Separator();
+
+                // Level of detail
+                render_option_float("##lod_option_1", "LOD threshold (px)", Option_Value_Lod_Threshold, "How far (in pixels) a coarser level of detail can be from the full one before a finer level is used instead");
+                ImGui::SameLine(); render_option_float("##lod_option_2", "Shadow LOD bias", Option_Value_Lod_Bias_Shadows, "How many levels coarser shadows are drawn", 1.0f);
                 ImGui::Separator();
             }
 
@@ -244,6 +259,7 @@ void Widget_RenderOptions::Tick()
         m_renderer->SetOption(Render_Sharpening_LumaSharpen,        do_sharperning);
         m_renderer->SetOption(Render_ChromaticAberration,           do_chromatic_aberration);
         m_renderer->SetOption(Render_Dithering,                     do_dithering);
+        m_renderer->SetOption(Render_DynamicResolution,             do_dynamic_resolution);
         m_renderer->SetOptionValue(Option_Value_ShadowResolution,   static_cast<float>(resolution_shadow));
     }
 
@@ -309,6 +325,9 @@ void Widget_RenderOptions::Tick()
         // Reflect from engine
         auto do_depth_prepass   = m_renderer->GetOption(Render_DepthPrepass);
         auto do_reverse_z       = m_renderer->GetOption(Render_ReverseZ);
+        auto do_clustered       = m_renderer->GetOption(Render_ClusteredLighting);
+        auto do_occlusion       = m_renderer->GetOption(Render_OcclusionCulling);
+        auto do_streaming       = m_renderer->GetOption(Render_TextureStreaming);
 
         {
             // Buffer
@@ -367,10 +386,24 @@ void Widget_RenderOptions::Tick()
 
             // Reverse-Z
             ImGui::Checkbox("Reverse-Z", &do_reverse_z);
+
+            // Clustered lighting
+            ImGui::Checkbox("Clustered lighting", &do_clustered);
+
+            // Occlusion culling
+            ImGui::Checkbox("Occlusion culling", &do_occlusion);
+            ImGuiEx::Tooltip("Skips meshes hidden behind large occluders, the occluders are rasterized on the CPU");
+
+            // Texture streaming
+            ImGui::Checkbox("Texture streaming", &do_streaming);
+            ImGuiEx::Tooltip("Keeps only the mips that the screen size of each texture needs resident, within the texture memory budget");
         }
 
         // Map back to engine
         m_renderer->SetOption(Render_DepthPrepass, do_depth_prepass);
         m_renderer->SetOption(Render_ReverseZ, do_reverse_z);
+        m_renderer->SetOption(Render_ClusteredLighting, do_clustered);
+        m_renderer->SetOption(Render_OcclusionCulling, do_occlusion);
+        m_renderer->SetOption(Render_TextureStreaming, do_streaming);
     }
 }
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Resource/ResourceCache.h"
 #include "../ImGui/Source/imgui.h"
 #include "Core/Spartan_Object.h"
+#include "Profiling/Profiler.h"
 //=================================
 
 //= NAMESPACES ==========
@@ -66,6 +67,26 @@ void Widget_ResourceCache::Tick()
 
 	ImGui::Text("Resource count: %d, Memory usage cpu: %d Mb, Memory usage gpu: %d Mb", static_cast<uint32_t>(resources.size()), static_cast<uint32_t>(memory_usage_cpu), static_cast<uint32_t>(memory_usage_gpu));
 	ImGui::Separator();
+
+    // GPU memory, per usage class
+    Profiler* profiler = m_context->GetSubsystem<Profiler>();
+    if (profiler->GpuHasMemoryStats() && ImGui::CollapsingHeader("GPU memory pools", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        const auto& memory_stats = profiler->GpuGetMemoryStats();
+        for (uint32_t i = 0; i < RHI_Memory_Pool_Count; i++)
+        {
+            const RHI_Memory_Stats& stats = memory_stats[i];
+            ImGui::Text("%s: %.1f/%.1f Mb used/reserved, %d allocations, %d blocks", rhi_memory_pool_to_string(static_cast<RHI_Memory_Pool>(i)), stats.bytes_used / 1000.0f / 1000.0f, stats.bytes_reserved / 1000.0f / 1000.0f, stats.allocation_count, stats.block_count);
+            if (stats.budget != 0)
+            {
+                ImGui::SameLine();
+                const bool over_budget = stats.bytes_used > stats.budget;
+                ImGui::TextColored(over_budget ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(budget: %.1f Mb)", stats.budget / 1000.0f / 1000.0f);
+            }
+        }
+        ImGui::Separator();
+    }
+
 	ImGui::Columns(7, "##Widget_ResourceCache");
 
     // Set column width - Has to be done only once in order to allow for the user to resize them
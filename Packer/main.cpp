@@ -0,0 +1,70 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "Logging/ILogger.h"
+#include "Logging/Log.h"
+#include "Core/Context.h"
+#include "IO/Package.h"
+#include "Threading/Threading.h"
+//======================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan;
+//============================
+
+// Packs a project directory into a package, which the engine mounts when it sits in the project directory
+class ConsoleLogger : public ILogger
+{
+public:
+    void Log(const string& log, const uint32_t type) override
+    {
+        fprintf(type == Log_Info ? stdout : stderr, "%s\n", log.c_str());
+    }
+};
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: Packer <directory> <package> [-benchmark]\n");
+        printf("Example: Packer Project/ Project/Project.pak\n");
+        return 1;
+    }
+
+    shared_ptr<ConsoleLogger> logger = make_shared<ConsoleLogger>();
+    Log::SetLogger(logger);
+    LOG_TO_FILE(false);
+
+    // Chunks of large files are compressed in parallel
+    Context context;
+    context.RegisterSubsystem<Threading>();
+    Threading* threading = context.GetSubsystem<Threading>();
+
+    if (argc > 3 && strcmp(argv[3], "-benchmark") == 0)
+        return Package::Benchmark(argv[1], threading) ? 0 : 1;
+
+    return Package::Build(argv[1], argv[2], threading) ? 0 : 1;
+}
@@ -33,7 +33,7 @@ namespace Spartan
 
     struct WindowData
     {
-        void* handle                    = nullptr;
+        void* handle                    = nullptr; // null for headless runs, which only the null RHI can render
         void* instance                  = nullptr;
         uint32_t message                = 0;
         float width                     = 0;
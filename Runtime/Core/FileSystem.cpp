@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <fstream>
 #include <sstream> 
 #include "../Logging/Log.h"
+#include "../IO/Package.h"
 #include <Windows.h>
 #include <shellapi.h>
 //=========================
@@ -257,7 +258,7 @@ namespace Spartan
             LOG_WARNING("%s, %s", e.what(), path.c_str());
         }
 
-        return false;
+        return Package::Exists(path);
     }
 
     bool FileSystem::IsDirectory(const string& path)
@@ -290,7 +291,7 @@ namespace Spartan
             LOG_WARNING("%s, %s", e.what(), path.c_str());
         }
 
-        return false;
+        return Package::Exists(path);
     }
 
 	bool FileSystem::CopyFileFromTo(const string& source, const string& destination)
@@ -48,9 +48,9 @@ namespace Spartan
         static void OpenDirectoryWindow(const std::string& path);
 		static bool CreateDirectory_(const std::string& path);
 		static bool Delete(const std::string& path);	
-		static bool Exists(const std::string& path);
+		static bool Exists(const std::string& path);       // on disk or in a mounted package
         static bool IsDirectory(const std::string& path);
-        static bool IsFile(const std::string& path);
+        static bool IsFile(const std::string& path);       // on disk or in a mounted package
 		static bool CopyFileFromTo(const std::string& source, const std::string& destination);
 		static std::string GetFileNameFromFilePath(const std::string& path);
 		static std::string GetFileNameNoExtensionFromFilePath(const std::string& path);
@@ -101,6 +101,7 @@ namespace Spartan
     static const char* EXTENSION_TEXTURE   = ".texture";
     static const char* EXTENSION_MESH      = ".mesh";
     static const char* EXTENSION_AUDIO     = ".audio";
+    static const char* EXTENSION_PACKAGE   = ".pak";
 
     static const std::vector<std::string> supported_formats_image
     {
@@ -35,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {
 	class Entity;
+	struct WorldResolveDelta;
 }
 //========================
 
@@ -48,6 +49,7 @@ namespace Spartan
 	double,											\
 	void*,											\
 	Spartan::Entity*,								\
+	Spartan::WorldResolveDelta*,					\
 	std::shared_ptr<Spartan::Entity>,				\
 	std::weak_ptr<Spartan::Entity>,					\
 	std::vector<std::weak_ptr<Spartan::Entity>>,	\
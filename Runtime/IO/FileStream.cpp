@@ -21,6 +21,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================
 #include "FileStream.h"
+#include <cstring>
+#include "Package.h"
 #include "../Logging/Log.h"
 #include "../RHI/RHI_Vertex.h"
 //============================
@@ -52,11 +54,21 @@ namespace Spartan
 		}
 		else if (m_flags & FileStream_Read)
 		{
-			in.open(path, ios_flags);
-			if(in.fail())
+			in_file.open(path, ios_flags);
+			if (!in_file.fail())
 			{
-				LOG_ERROR("Failed to open \"%s\" for reading", path.c_str());
-				return;
+				in.rdbuf(in_file.rdbuf());
+			}
+			else
+			{
+				// Not on disk, but it could be in a mounted package
+				if (!in_package.Open(path))
+				{
+					LOG_ERROR("Failed to open \"%s\" for reading", path.c_str());
+					return;
+				}
+
+				in.rdbuf(&in_package);
 			}
 		}
 
@@ -78,7 +90,7 @@ namespace Spartan
 		else if (m_flags & FileStream_Read)
 		{
 			in.clear();
-			in.close();
+			in_file.close();
 		}
 	}
 
@@ -129,6 +141,11 @@ namespace Spartan
 		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
 	}
 
+	void FileStream::Write(const std::byte* data, const uint64_t size)
+	{
+		out.write(reinterpret_cast<const char*>(data), static_cast<streamsize>(size));
+	}
+
 	void FileStream::Skip(uint32_t n)
 	{
 		// Set the seek cursor to offset n from the current position
@@ -142,6 +159,50 @@ namespace Spartan
 		}
 	}
 
+	void FileStream::Seek(const uint64_t position)
+	{
+		if (m_flags & FileStream_Write)
+		{
+			out.seekp(position, ios::beg);
+		}
+		else if (m_flags & FileStream_Read)
+		{
+			in.clear(); // a previous read might have hit the end
+			in.seekg(position, ios::beg);
+		}
+	}
+
+	uint64_t FileStream::GetPosition()
+	{
+		if (m_flags & FileStream_Write)
+			return static_cast<uint64_t>(out.tellp());
+
+		if (m_flags & FileStream_Read)
+			return static_cast<uint64_t>(in.tellg());
+
+		return 0;
+	}
+
+	uint64_t FileStream::GetSize()
+	{
+		const uint64_t position = GetPosition();
+
+		uint64_t size = 0;
+		if (m_flags & FileStream_Write)
+		{
+			out.seekp(0, ios::end);
+			size = static_cast<uint64_t>(out.tellp());
+		}
+		else if (m_flags & FileStream_Read)
+		{
+			in.seekg(0, ios::end);
+			size = static_cast<uint64_t>(in.tellg());
+		}
+
+		Seek(position);
+		return size;
+	}
+
 	void FileStream::Read(string* value)
 	{
 		uint32_t length = 0;
@@ -233,4 +294,117 @@ namespace Spartan
 
 		in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
 	}
+
+	void FileStream::Read(std::byte* data, const uint64_t size)
+	{
+		in.read(reinterpret_cast<char*>(data), static_cast<streamsize>(size));
+	}
+
+	bool FileStream::PackageBuffer::Open(const string& path)
+	{
+		m_package = Package::FindMounted(path, &m_path, &m_threading);
+		if (!m_package)
+			return false;
+
+		m_size = m_package->GetSize(m_path);
+		SetPosition(0);
+		return true;
+	}
+
+	void FileStream::PackageBuffer::SetPosition(const uint64_t position)
+	{
+		// Keep the decompressed chunk if the position falls within it, otherwise wait for the next read
+		if (position >= m_chunk_offset && position <= m_chunk_offset + m_chunk.size() && !m_chunk.empty())
+		{
+			char* begin = reinterpret_cast<char*>(m_chunk.data());
+			setg(begin, begin + (position - m_chunk_offset), begin + m_chunk.size());
+			return;
+		}
+
+		m_chunk.clear();
+		m_chunk_offset = position;
+		setg(nullptr, nullptr, nullptr);
+	}
+
+	bool FileStream::PackageBuffer::Load(const uint64_t position)
+	{
+		const uint64_t chunk_offset	= position - position % Package::chunk_size;
+		const uint64_t chunk_size	= min<uint64_t>(Package::chunk_size, m_size - chunk_offset);
+		m_chunk.resize(chunk_size);
+		if (!m_package->Read(m_path, chunk_offset, chunk_size, m_chunk.data()))
+		{
+			m_chunk.clear();
+			return false;
+		}
+
+		m_chunk_offset = chunk_offset;
+		SetPosition(position);
+		return true;
+	}
+
+	FileStream::PackageBuffer::int_type FileStream::PackageBuffer::underflow()
+	{
+		if (gptr() < egptr())
+			return traits_type::to_int_type(*gptr());
+
+		const uint64_t position = GetPosition();
+		if (position >= m_size || !Load(position))
+			return traits_type::eof();
+
+		return traits_type::to_int_type(*gptr());
+	}
+
+	streamsize FileStream::PackageBuffer::xsgetn(char* data, const streamsize size)
+	{
+		// Whatever is left of the current chunk first
+		const streamsize available	= min<streamsize>(size, egptr() - gptr());
+		if (available > 0)
+		{
+			memcpy(data, gptr(), static_cast<size_t>(available));
+			gbump(static_cast<int>(available));
+		}
+
+		if (available == size)
+			return size;
+
+		// Large reads (e.g. vertices or mips) go straight into the destination, with the chunks decompressed in parallel
+		const uint64_t position		= GetPosition();
+		const uint64_t remaining	= min<uint64_t>(static_cast<uint64_t>(size - available), m_size - position);
+		if (remaining >= Package::chunk_size)
+		{
+			if (!m_package->Read(m_path, position, remaining, reinterpret_cast<std::byte*>(data + available), m_threading))
+				return available;
+
+			SetPosition(position + remaining);
+			return available + static_cast<streamsize>(remaining);
+		}
+
+		// Small reads go through the chunk, so that the reads which follow are served from it
+		streamsize read = available;
+		while (read < size && underflow() != traits_type::eof())
+		{
+			const streamsize count = min<streamsize>(size - read, egptr() - gptr());
+			memcpy(data + read, gptr(), static_cast<size_t>(count));
+			gbump(static_cast<int>(count));
+			read += count;
+		}
+
+		return read;
+	}
+
+	FileStream::PackageBuffer::pos_type FileStream::PackageBuffer::seekoff(const off_type offset, const ios_base::seekdir direction, const ios_base::openmode which)
+	{
+		const int64_t origin	= direction == ios_base::beg ? 0 : direction == ios_base::cur ? static_cast<int64_t>(GetPosition()) : static_cast<int64_t>(m_size);
+		const int64_t position	= origin + offset;
+		if (!(which & ios_base::in) || position < 0 || position > static_cast<int64_t>(m_size))
+			return pos_type(off_type(-1));
+
+		SetPosition(static_cast<uint64_t>(position));
+		return pos_type(position);
+	}
+
+	FileStream::PackageBuffer::pos_type FileStream::PackageBuffer::seekpos(const pos_type position, const ios_base::openmode which)
+	{
+		return seekoff(off_type(position), ios_base::beg, which);
+	}
 }
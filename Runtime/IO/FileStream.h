@@ -34,6 +34,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {
 	class Entity;
+	class Package;
+	class Threading;
 
 	enum FileStream_Mode : uint32_t
 	{
@@ -85,8 +87,15 @@ namespace Spartan
 		void Write(const std::vector<uint32_t>& value);
 		void Write(const std::vector<unsigned char>& value);
 		void Write(const std::vector<std::byte>& value);
+		void Write(const std::byte* data, uint64_t size);	// raw, without a size prefix
 		void Skip(uint32_t n);
 		//===========================================================
+
+		//= POSITIONING ======================================
+		void Seek(uint64_t position);	// absolute, from the start of the file
+		uint64_t GetPosition();
+		uint64_t GetSize();
+		//====================================================
 		
 		//= READING ===========================================
 		template <class T, class = typename std::enable_if
@@ -122,6 +131,7 @@ namespace Spartan
 		void Read(std::vector<uint32_t>* vec);
 		void Read(std::vector<unsigned char>* vec);
 		void Read(std::vector<std::byte>* vec);
+		void Read(std::byte* data, uint64_t size);			// raw, without a size prefix
 
 		// Reading with explicit type definition
 		template <class T, class = typename std::enable_if
@@ -152,8 +162,35 @@ namespace Spartan
 		//=====================================================
 
 	private:
+		// Serves reads from a mounted package, decompressing only the chunks which are read
+		class PackageBuffer : public std::streambuf
+		{
+		public:
+			bool Open(const std::string& path);
+
+		protected:
+			int_type underflow() override;
+			std::streamsize xsgetn(char* data, std::streamsize size) override;
+			pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override;
+			pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+		private:
+			uint64_t GetPosition() const { return m_chunk_offset + (gptr() - eback()); }
+			void SetPosition(uint64_t position);
+			bool Load(uint64_t position);
+
+			Package* m_package		= nullptr;
+			Threading* m_threading	= nullptr;
+			std::string m_path;
+			uint64_t m_size			= 0;
+			uint64_t m_chunk_offset	= 0; // where the decompressed chunk starts in the file
+			std::vector<std::byte> m_chunk;
+		};
+
 		std::ofstream out;
-		std::ifstream in;
+		std::ifstream in_file;
+		PackageBuffer in_package;
+		std::istream in{ nullptr };	// reads from either of the above
 		uint32_t m_flags;
 		bool m_is_open;
 	};
@@ -0,0 +1,246 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "Lz4.h"
+#include <cstring>
+#include <vector>
+#include "../Math/MathHelper.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    static const uint32_t min_match         = 4;
+    static const uint32_t last_literals     = 5;    // the format requires the block to end with this many literals
+    static const uint32_t match_limit       = 12;   // and the last match to start at least this far from the end
+    static const uint32_t max_offset        = 65535;
+    static const uint32_t hash_bits         = 16;
+
+    inline uint32_t read_32(const uint8_t* p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t hash_32(const uint32_t value)
+    {
+        return (value * 2654435761u) >> (32 - hash_bits);
+    }
+
+    inline uint8_t* write_length(uint8_t* op, uint64_t length)
+    {
+        while (length >= 255)
+        {
+            *op++   = 255;
+            length  -= 255;
+        }
+        *op++ = static_cast<uint8_t>(length);
+
+        return op;
+    }
+
+    inline bool read_length(const uint8_t*& ip, const uint8_t* end, uint64_t& length)
+    {
+        uint8_t value = 255;
+        while (value == 255)
+        {
+            if (ip >= end)
+                return false;
+
+            value   = *ip++;
+            length  += value;
+        }
+
+        return true;
+    }
+
+    static uint8_t* write_sequence(uint8_t* op, const uint8_t* literals, const uint64_t literal_count, const uint32_t offset, const uint64_t match_length)
+    {
+        uint8_t* token = op++;
+        *token = static_cast<uint8_t>(Math::Helper::Min<uint64_t>(literal_count, 15) << 4);
+        if (literal_count >= 15)
+        {
+            op = write_length(op, literal_count - 15);
+        }
+
+        memcpy(op, literals, literal_count);
+        op += literal_count;
+
+        // The last sequence has literals only
+        if (match_length == 0)
+            return op;
+
+        op[0]   = static_cast<uint8_t>(offset & 0xFF);
+        op[1]   = static_cast<uint8_t>(offset >> 8);
+        op      += 2;
+
+        const uint64_t length = match_length - min_match;
+        *token |= static_cast<uint8_t>(Math::Helper::Min<uint64_t>(length, 15));
+        if (length >= 15)
+        {
+            op = write_length(op, length - 15);
+        }
+
+        return op;
+    }
+
+    uint64_t Lz4::Compress(const std::byte* source, const uint64_t size, std::byte* destination)
+    {
+        const uint8_t* const begin  = reinterpret_cast<const uint8_t*>(source);
+        const uint8_t* const end    = begin + size;
+        const uint8_t* ip           = begin;
+        const uint8_t* anchor       = begin;
+        uint8_t* op                 = reinterpret_cast<uint8_t*>(destination);
+
+        if (size > match_limit)
+        {
+            // Positions are relative to the start of the block, an empty slot (0) is rejected by the comparison below
+            vector<uint32_t> table(static_cast<size_t>(1) << hash_bits, 0);
+            const uint8_t* const limit_start    = end - match_limit;
+            const uint8_t* const limit_end      = end - last_literals;
+
+            ip++;
+            uint32_t attempts = 0;
+            while (ip < limit_start)
+            {
+                const uint32_t value    = read_32(ip);
+                const uint32_t hash     = hash_32(value);
+                const uint8_t* match    = begin + table[hash];
+                table[hash]             = static_cast<uint32_t>(ip - begin);
+
+                if (match >= ip || static_cast<uint64_t>(ip - match) > max_offset || read_32(match) != value)
+                {
+                    // Skip faster through data that doesn't compress
+                    ip += 1 + (attempts++ >> 6);
+                    continue;
+                }
+
+                // Extend backwards over literals, and forwards as far as it matches
+                while (ip > anchor && match > begin && ip[-1] == match[-1])
+                {
+                    ip--;
+                    match--;
+                }
+
+                uint64_t length = min_match;
+                while (ip + length < limit_end && ip[length] == match[length])
+                {
+                    length++;
+                }
+
+                op          = write_sequence(op, anchor, ip - anchor, static_cast<uint32_t>(ip - match), length);
+                ip          += length;
+                anchor      = ip;
+                attempts    = 0;
+
+                // Prime the table with a position inside the match, repeated data benefits from it
+                if (ip < limit_start)
+                {
+                    table[hash_32(read_32(ip - 2))] = static_cast<uint32_t>(ip - 2 - begin);
+                }
+            }
+        }
+
+        op = write_sequence(op, anchor, end - anchor, 0, 0);
+        return static_cast<uint64_t>(op - reinterpret_cast<uint8_t*>(destination));
+    }
+
+    bool Lz4::Decompress(const std::byte* source, const uint64_t size_compressed, std::byte* destination, const uint64_t size)
+    {
+        const uint8_t* ip               = reinterpret_cast<const uint8_t*>(source);
+        const uint8_t* const ip_end     = ip + size_compressed;
+        uint8_t* const op_begin         = reinterpret_cast<uint8_t*>(destination);
+        uint8_t* op                     = op_begin;
+        uint8_t* const op_end           = op_begin + size;
+
+        while (ip < ip_end)
+        {
+            const uint8_t token = *ip++;
+
+            // Literals
+            uint64_t literal_count = token >> 4;
+            if (literal_count == 15 && !read_length(ip, ip_end, literal_count))
+                return false;
+
+            if (literal_count > static_cast<uint64_t>(ip_end - ip) || literal_count > static_cast<uint64_t>(op_end - op))
+                return false;
+
+            // Short runs are the common case, copy them with a single fixed size copy when there's room to overshoot
+            if (literal_count <= 16 && ip_end - ip >= 16 && op_end - op >= 16)
+            {
+                memcpy(op, ip, 16);
+            }
+            else
+            {
+                memcpy(op, ip, literal_count);
+            }
+            ip += literal_count;
+            op += literal_count;
+
+            // The last sequence has literals only
+            if (ip == ip_end)
+                break;
+
+            // Match
+            if (ip_end - ip < 2)
+                return false;
+
+            const uint32_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<uint64_t>(op - op_begin))
+                return false;
+
+            uint64_t length = token & 15;
+            if (length == 15 && !read_length(ip, ip_end, length))
+                return false;
+
+            length += min_match;
+            if (length > static_cast<uint64_t>(op_end - op))
+                return false;
+
+            const uint8_t* match = op - offset;
+            if (offset >= 8 && static_cast<uint64_t>(op_end - op) >= length + 8)
+            {
+                // Overshooting is fine, the bytes past the match are written again by what follows
+                for (uint64_t i = 0; i < length; i += 8)
+                {
+                    memcpy(op + i, match + i, 8);
+                }
+            }
+            else
+            {
+                // Overlapping, the match repeats what it just wrote
+                for (uint64_t i = 0; i < length; i++)
+                {
+                    op[i] = match[i];
+                }
+            }
+            op += length;
+        }
+
+        return op == op_end;
+    }
+}
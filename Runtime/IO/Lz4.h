@@ -0,0 +1,46 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <cstdint>
+#include <cstddef>
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Spartan
+{
+    // Compression in the LZ4 block format. A greedy compressor with a single hash table (no chains), so it's
+    // fast rather than thorough, and a bounds checked decompressor which copies 8 bytes at a time when it can.
+    class SPARTAN_CLASS Lz4
+    {
+    public:
+        // The most bytes compressing size bytes can produce, when nothing matches
+        static uint64_t GetBoundSize(uint64_t size) { return size + size / 255 + 16; }
+
+        // Returns the compressed size, destination must hold GetBoundSize(size) bytes
+        static uint64_t Compress(const std::byte* source, uint64_t size, std::byte* destination);
+
+        // Fails on malformed input, or when it doesn't decompress to exactly size bytes
+        static bool Decompress(const std::byte* source, uint64_t size_compressed, std::byte* destination, uint64_t size);
+    };
+}
@@ -0,0 +1,619 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "Package.h"
+#include <filesystem>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include "Lz4.h"
+#include "../Core/FileSystem.h"
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Threading/Threading.h"
+//======================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::package_file
+{
+    // Layout: header | chunks, 16 byte aligned | entries, sorted by hash | chunk table | paths
+    static const uint32_t magic             = 0x4B415053; // "SPAK"
+    static const uint32_t version_current   = 1;
+    static const uint64_t chunk_alignment   = 16;
+
+    struct header
+    {
+        uint32_t magic              = package_file::magic;
+        uint32_t version            = version_current;
+        uint32_t entry_count        = 0;
+        uint32_t chunk_count        = 0;
+        uint64_t entries_offset     = 0;
+        uint64_t chunks_offset      = 0;
+        uint64_t paths_offset       = 0;
+        uint64_t paths_size         = 0;
+        uint32_t chunk_size         = 0;
+        uint32_t reserved[3]        = {};
+    };
+    static_assert(sizeof(header) == 64, "The header is part of the file format, its size can't change");
+
+    // FNV-1a
+    inline uint64_t hash(const string& path)
+    {
+        uint64_t value = 14695981039346656037ull;
+        for (const char c : path)
+        {
+            value ^= static_cast<uint8_t>(c);
+            value *= 1099511628211ull;
+        }
+
+        return value;
+    }
+
+    // Relative to the working directory, forward slashes and lowercase (file systems the engine runs on ignore case)
+    inline string normalize(const string& path)
+    {
+        filesystem::path path_fs = filesystem::path(path);
+        if (path_fs.is_absolute())
+        {
+            error_code error;
+            filesystem::path path_relative = filesystem::relative(path_fs, filesystem::current_path(), error);
+            if (!error && !path_relative.empty())
+            {
+                path_fs = path_relative;
+            }
+        }
+
+        string normalized = path_fs.lexically_normal().generic_string();
+        replace(normalized.begin(), normalized.end(), '\\', '/');
+        transform(normalized.begin(), normalized.end(), normalized.begin(), [](const char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+        if (normalized == ".")
+            return "";
+
+        if (normalized.rfind("./", 0) == 0)
+            normalized = normalized.substr(2);
+
+        return normalized;
+    }
+
+    inline bool read_file(const string& file_path, vector<std::byte>& data)
+    {
+        ifstream file(file_path, ios::binary | ios::ate);
+        if (!file.is_open())
+            return false;
+
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, ios::beg);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        return !file.fail();
+    }
+
+    struct mount
+    {
+        string directory; // normalized, with a trailing slash unless it's the working directory
+        unique_ptr<Package> package;
+        Threading* threading = nullptr;
+    };
+
+    static vector<mount> mounts;
+    static mutex mounts_mutex;
+}
+
+namespace Spartan
+{
+    bool Package::Open(const string& file_path)
+    {
+        m_file.open(file_path, ios::binary);
+        if (!m_file.is_open())
+        {
+            LOG_ERROR("Failed to open \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        package_file::header header;
+        m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (m_file.fail() || header.magic != package_file::magic || header.version > package_file::version_current)
+        {
+            LOG_ERROR("\"%s\" is not a package, or it's from a newer version", file_path.c_str());
+            return false;
+        }
+
+        // The table of contents, everything else is read on demand
+        m_entries.resize(header.entry_count);
+        m_chunks.resize(header.chunk_count);
+        m_paths.resize(header.paths_size);
+        m_file.seekg(header.entries_offset);
+        m_file.read(reinterpret_cast<char*>(m_entries.data()), m_entries.size() * sizeof(Entry));
+        m_file.seekg(header.chunks_offset);
+        m_file.read(reinterpret_cast<char*>(m_chunks.data()), m_chunks.size() * sizeof(Chunk));
+        m_file.seekg(header.paths_offset);
+        m_file.read(m_paths.data(), m_paths.size());
+        if (m_file.fail())
+        {
+            LOG_ERROR("\"%s\" is corrupted", file_path.c_str());
+            return false;
+        }
+
+        m_file_path = file_path;
+        return true;
+    }
+
+    const Package::Entry* Package::Find(const string& path) const
+    {
+        const uint64_t hash = package_file::hash(path);
+        auto it = lower_bound(m_entries.begin(), m_entries.end(), hash, [](const Entry& entry, const uint64_t value) { return entry.hash < value; });
+
+        // The path is compared as well, a hash could in theory collide with that of a file which isn't packed
+        if (it == m_entries.end() || it->hash != hash || m_paths.compare(it->path_offset, it->path_length, path) != 0)
+            return nullptr;
+
+        return &(*it);
+    }
+
+    bool Package::Contains(const string& path) const
+    {
+        return Find(package_file::normalize(path)) != nullptr;
+    }
+
+    bool Package::Read(const string& path, vector<std::byte>& data, Threading* threading /*= nullptr*/)
+    {
+        const Entry* entry = Find(package_file::normalize(path));
+        if (!entry)
+            return false;
+
+        data.resize(entry->size);
+        return ReadRange(*entry, 0, entry->size, data.data(), threading, path);
+    }
+
+    bool Package::Read(const string& path, const uint64_t offset, const uint64_t size, std::byte* data, Threading* threading /*= nullptr*/)
+    {
+        const Entry* entry = Find(package_file::normalize(path));
+        if (!entry)
+            return false;
+
+        if (offset + size > entry->size || (size != 0 && !data))
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        return ReadRange(*entry, offset, size, data, threading, path);
+    }
+
+    uint64_t Package::GetSize(const string& path) const
+    {
+        const Entry* entry = Find(package_file::normalize(path));
+        return entry ? entry->size : 0;
+    }
+
+    bool Package::ReadRange(const Entry& entry, const uint64_t offset, const uint64_t size, std::byte* data, Threading* threading, const string& path)
+    {
+        if (size == 0)
+            return true;
+
+        // The chunks of a file are contiguous, so the ones which cover the range are read at once
+        const uint32_t chunk_start  = static_cast<uint32_t>(offset / chunk_size);
+        const uint32_t chunk_count  = static_cast<uint32_t>((offset + size - 1) / chunk_size) + 1 - chunk_start;
+        const Chunk& chunk_first    = m_chunks[entry.chunk_first + chunk_start];
+        const Chunk& chunk_last     = m_chunks[entry.chunk_first + chunk_start + chunk_count - 1];
+        vector<std::byte> compressed(chunk_last.offset + chunk_last.size_compressed - chunk_first.offset);
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_file.clear();
+            m_file.seekg(chunk_first.offset);
+            m_file.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+            if (m_file.fail())
+            {
+                LOG_ERROR("Failed to read \"%s\" from \"%s\"", path.c_str(), m_file_path.c_str());
+                return false;
+            }
+        }
+
+        // Every chunk but the last one is full, so where each one goes is known upfront
+        atomic<bool> valid = true;
+        auto decompress = [this, &entry, offset, size, chunk_start, &chunk_first, &compressed, data, &valid](const uint32_t start, const uint32_t end)
+        {
+            vector<std::byte> decompressed;
+            for (uint32_t i = chunk_start + start; i < chunk_start + end; i++)
+            {
+                const Chunk& chunk          = m_chunks[entry.chunk_first + i];
+                const std::byte* source     = compressed.data() + (chunk.offset - chunk_first.offset);
+                const uint64_t chunk_offset = static_cast<uint64_t>(i) * chunk_size;
+                const uint64_t copy_start   = max(offset, chunk_offset);
+                const uint64_t copy_end     = min(offset + size, chunk_offset + chunk.size);
+                std::byte* destination      = data + (copy_start - offset);
+
+                if (chunk.size_compressed == chunk.size)
+                {
+                    memcpy(destination, source + (copy_start - chunk_offset), copy_end - copy_start);
+                }
+                else if (copy_end - copy_start == chunk.size)
+                {
+                    valid = Lz4::Decompress(source, chunk.size_compressed, destination, chunk.size) && valid;
+                }
+                else
+                {
+                    // Only partly covered (the edges of the range), so it goes through a copy
+                    decompressed.resize(chunk.size);
+                    if (Lz4::Decompress(source, chunk.size_compressed, decompressed.data(), chunk.size))
+                    {
+                        memcpy(destination, decompressed.data() + (copy_start - chunk_offset), copy_end - copy_start);
+                    }
+                    else
+                    {
+                        valid = false;
+                    }
+                }
+            }
+        };
+
+        if (threading && chunk_count > 1)
+        {
+            threading->AddTaskLoop(decompress, chunk_count);
+        }
+        else
+        {
+            decompress(0, chunk_count);
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("\"%s\" in \"%s\" is corrupted", path.c_str(), m_file_path.c_str());
+        }
+
+        return valid;
+    }
+
+    vector<string> Package::GetPaths() const
+    {
+        vector<string> paths;
+        paths.reserve(m_entries.size());
+        for (const Entry& entry : m_entries)
+        {
+            paths.emplace_back(m_paths.substr(entry.path_offset, entry.path_length));
+        }
+
+        return paths;
+    }
+
+    bool Package::Build(const string& directory, const string& file_path, Threading* threading /*= nullptr*/)
+    {
+        error_code error;
+        if (!filesystem::is_directory(directory, error))
+        {
+            LOG_ERROR("\"%s\" is not a directory", directory.c_str());
+            return false;
+        }
+
+        Stopwatch timer;
+
+        // Gather, in a stable order, skipping packages (including the one being built)
+        vector<string> file_paths;
+        for (const filesystem::directory_entry& entry : filesystem::recursive_directory_iterator(directory, error))
+        {
+            if (entry.is_regular_file() && entry.path().extension().string() != EXTENSION_PACKAGE && !filesystem::equivalent(entry.path(), file_path, error))
+            {
+                file_paths.emplace_back(entry.path().string());
+            }
+        }
+        sort(file_paths.begin(), file_paths.end());
+
+        ofstream file(file_path, ios::binary | ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to create \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        package_file::header header;
+        header.chunk_size = chunk_size;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        vector<Entry> entries;
+        vector<Chunk> chunks;
+        string paths;
+        uint64_t position       = sizeof(header);
+        uint64_t size_total     = 0;
+        vector<std::byte> data;
+        vector<vector<std::byte>> compressed;
+        for (const string& source_path : file_paths)
+        {
+            if (!package_file::read_file(source_path, data))
+            {
+                LOG_ERROR("Failed to read \"%s\"", source_path.c_str());
+                return false;
+            }
+
+            const string path = package_file::normalize(filesystem::relative(source_path, directory, error).generic_string());
+
+            Entry entry;
+            entry.hash          = package_file::hash(path);
+            entry.size          = data.size();
+            entry.chunk_first   = static_cast<uint32_t>(chunks.size());
+            entry.chunk_count   = static_cast<uint32_t>((data.size() + chunk_size - 1) / chunk_size);
+            entry.path_offset   = static_cast<uint32_t>(paths.size());
+            entry.path_length   = static_cast<uint32_t>(path.size());
+            entries.emplace_back(entry);
+            paths += path;
+            size_total += data.size();
+
+            // Compress the chunks in parallel, keeping the ones which don't get smaller as they are
+            compressed.resize(entry.chunk_count);
+            auto compress = [&data, &compressed](const uint32_t start, const uint32_t end)
+            {
+                for (uint32_t i = start; i < end; i++)
+                {
+                    const uint64_t offset   = static_cast<uint64_t>(i) * chunk_size;
+                    const uint64_t size     = min<uint64_t>(chunk_size, data.size() - offset);
+                    compressed[i].resize(Lz4::GetBoundSize(size));
+                    const uint64_t size_compressed = Lz4::Compress(data.data() + offset, size, compressed[i].data());
+                    if (size_compressed < size - size / 32)
+                    {
+                        compressed[i].resize(size_compressed);
+                    }
+                    else
+                    {
+                        compressed[i].assign(data.begin() + offset, data.begin() + offset + size);
+                    }
+                }
+            };
+
+            if (threading && entry.chunk_count > 1)
+            {
+                threading->AddTaskLoop(compress, entry.chunk_count);
+            }
+            else
+            {
+                compress(0, entry.chunk_count);
+            }
+
+            for (uint32_t i = 0; i < entry.chunk_count; i++)
+            {
+                const uint64_t offset = (position + package_file::chunk_alignment - 1) & ~(package_file::chunk_alignment - 1);
+                file.seekp(offset);
+                file.write(reinterpret_cast<const char*>(compressed[i].data()), compressed[i].size());
+
+                Chunk chunk;
+                chunk.offset            = offset;
+                chunk.size_compressed   = static_cast<uint32_t>(compressed[i].size());
+                chunk.size              = static_cast<uint32_t>(min<uint64_t>(chunk_size, data.size() - static_cast<uint64_t>(i) * chunk_size));
+                chunks.emplace_back(chunk);
+                position = offset + chunk.size_compressed;
+            }
+        }
+
+        // Sort the table of contents for lookups, two paths with the same hash can't be told apart
+        sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+        for (uint32_t i = 1; i < static_cast<uint32_t>(entries.size()); i++)
+        {
+            if (entries[i].hash == entries[i - 1].hash)
+            {
+                LOG_ERROR("\"%s\" and \"%s\" have the same hash", paths.substr(entries[i].path_offset, entries[i].path_length).c_str(), paths.substr(entries[i - 1].path_offset, entries[i - 1].path_length).c_str());
+                return false;
+            }
+        }
+
+        header.entry_count      = static_cast<uint32_t>(entries.size());
+        header.chunk_count      = static_cast<uint32_t>(chunks.size());
+        header.entries_offset   = position;
+        header.chunks_offset    = header.entries_offset + entries.size() * sizeof(Entry);
+        header.paths_offset     = header.chunks_offset + chunks.size() * sizeof(Chunk);
+        header.paths_size       = paths.size();
+        file.seekp(position);
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+        file.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(Chunk));
+        file.write(paths.data(), paths.size());
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (file.fail())
+        {
+            LOG_ERROR("Failed to write \"%s\"", file_path.c_str());
+            return false;
+        }
+
+        LOG_INFO("Packed %d files from \"%s\" into \"%s\", %.1f MB to %.1f MB in %.0f ms",
+            header.entry_count,
+            directory.c_str(),
+            file_path.c_str(),
+            size_total / 1048576.0f,
+            (header.paths_offset + header.paths_size) / 1048576.0f,
+            timer.GetElapsedTimeMs()
+        );
+
+        return true;
+    }
+
+    bool Package::Mount(const string& file_path, const string& mount_directory, Threading* threading /*= nullptr*/)
+    {
+        string directory = package_file::normalize(mount_directory);
+        if (!directory.empty() && directory.back() != '/')
+        {
+            directory += "/";
+        }
+
+        lock_guard<mutex> lock(package_file::mounts_mutex);
+
+        // Mounting again only updates where it's mounted
+        for (package_file::mount& mount : package_file::mounts)
+        {
+            if (mount.package->GetFilePath() == file_path)
+            {
+                mount.directory = directory;
+                mount.threading = threading;
+                return true;
+            }
+        }
+
+        unique_ptr<Package> package = make_unique<Package>();
+        if (!package->Open(file_path))
+            return false;
+
+        LOG_INFO("Mounted \"%s\" (%d files) at \"%s\"", file_path.c_str(), static_cast<uint32_t>(package->m_entries.size()), directory.c_str());
+        package_file::mounts.push_back({ directory, move(package), threading });
+        return true;
+    }
+
+    void Package::Unmount(const string& file_path)
+    {
+        lock_guard<mutex> lock(package_file::mounts_mutex);
+        package_file::mounts.erase(remove_if(package_file::mounts.begin(), package_file::mounts.end(), [&file_path](const package_file::mount& mount)
+        {
+            return mount.package->GetFilePath() == file_path;
+        }), package_file::mounts.end());
+    }
+
+    bool Package::Exists(const string& path)
+    {
+        lock_guard<mutex> lock(package_file::mounts_mutex);
+        if (package_file::mounts.empty())
+            return false;
+
+        const string path_normalized = package_file::normalize(path);
+        for (const package_file::mount& mount : package_file::mounts)
+        {
+            if (path_normalized.rfind(mount.directory, 0) == 0 && mount.package->Find(path_normalized.substr(mount.directory.size())))
+                return true;
+        }
+
+        return false;
+    }
+
+    bool Package::ReadMounted(const string& path, vector<std::byte>& data)
+    {
+        Threading* threading = nullptr;
+        string path_package;
+        Package* package = FindMounted(path, &path_package, &threading);
+        return package && package->Read(path_package, data, threading);
+    }
+
+    Package* Package::FindMounted(const string& path, string* path_package, Threading** threading /*= nullptr*/)
+    {
+        if (!path_package)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return nullptr;
+        }
+
+        lock_guard<mutex> lock(package_file::mounts_mutex);
+        if (package_file::mounts.empty())
+            return nullptr;
+
+        const string path_normalized = package_file::normalize(path);
+        for (const package_file::mount& mount : package_file::mounts)
+        {
+            if (path_normalized.rfind(mount.directory, 0) == 0 && mount.package->Find(path_normalized.substr(mount.directory.size())))
+            {
+                *path_package = path_normalized.substr(mount.directory.size());
+                if (threading)
+                {
+                    *threading = mount.threading;
+                }
+                return mount.package.get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool Package::Benchmark(const string& directory, Threading* threading /*= nullptr*/)
+    {
+        const string file_path = (filesystem::temp_directory_path() / "spartan_benchmark.pak").string();
+        if (!Build(directory, file_path, threading))
+            return false;
+
+        // The build just read every file, so the first pass is likely served by the OS cache as well,
+        // a truly cold run needs the cache flushed (or a reboot) between building and running this
+        vector<string> file_paths;
+        error_code error;
+        for (const filesystem::directory_entry& entry : filesystem::recursive_directory_iterator(directory, error))
+        {
+            if (entry.is_regular_file() && entry.path().extension().string() != EXTENSION_PACKAGE)
+            {
+                file_paths.emplace_back(entry.path().string());
+            }
+        }
+
+        vector<vector<std::byte>> loose(file_paths.size());
+        vector<vector<std::byte>> packed(file_paths.size());
+        float time_loose[2]     = {};
+        float time_packed[2]    = {};
+        float time_open         = 0.0f;
+        bool valid              = true;
+
+        Package package;
+        for (uint32_t pass = 0; pass < 2; pass++)
+        {
+            Stopwatch timer;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(file_paths.size()); i++)
+            {
+                valid = package_file::read_file(file_paths[i], loose[i]) && valid;
+            }
+            time_loose[pass] = timer.GetElapsedTimeMs();
+
+            timer.Start();
+            if (pass == 0)
+            {
+                valid       = package.Open(file_path) && valid;
+                time_open   = timer.GetElapsedTimeMs();
+            }
+            for (uint32_t i = 0; i < static_cast<uint32_t>(file_paths.size()); i++)
+            {
+                valid = package.Read(filesystem::relative(file_paths[i], directory, error).string(), packed[i], threading) && valid;
+            }
+            time_packed[pass] = timer.GetElapsedTimeMs();
+        }
+
+        valid = valid && loose == packed;
+
+        // A range from the middle of every file, long enough to start and end part way into a chunk
+        Stopwatch timer;
+        vector<std::byte> range;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(file_paths.size()) && valid; i++)
+        {
+            const uint64_t offset       = loose[i].size() / 3;
+            const uint64_t range_size   = min<uint64_t>(loose[i].size() - offset, chunk_size + chunk_size / 2);
+            range.resize(range_size);
+            valid = package.Read(filesystem::relative(file_paths[i], directory, error).string(), offset, range_size, range.data(), threading) && valid;
+            valid = equal(range.begin(), range.end(), loose[i].begin() + offset) && valid;
+        }
+        const float time_ranged = timer.GetElapsedTimeMs();
+
+        LOG_INFO("%d files: loose %.1f ms (then %.1f ms), packed %.1f ms (then %.1f ms, of which opening %.2f ms), ranged %.1f ms, contents %s",
+            static_cast<uint32_t>(file_paths.size()),
+            time_loose[0],
+            time_loose[1],
+            time_packed[0],
+            time_packed[1],
+            time_open,
+            time_ranged,
+            valid ? "match" : "differ"
+        );
+
+        package.m_file.close();
+        filesystem::remove(file_path, error);
+        return valid;
+    }
+}
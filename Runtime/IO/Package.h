@@ -0,0 +1,99 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <string>
+#include <fstream>
+#include <mutex>
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Spartan
+{
+    class Threading;
+
+    // Many files in one. A table of contents, sorted by the hash of every file's path, locates the files, which
+    // are split into chunks that are compressed (LZ4) independently, so a large file decompresses in parallel.
+    // Chunks start 16 byte aligned and the ones which don't compress are stored as is, so they can be used in
+    // place when the package is mapped. FileStream and FileSystem fall back to the mounted packages for any
+    // file that doesn't exist on disk, so loose files can still override packaged ones.
+    class SPARTAN_CLASS Package
+    {
+    public:
+        static const uint32_t chunk_size = 256 * 1024;
+
+        Package() = default;
+        ~Package() = default;
+
+        // Paths are relative to the directory that was packed
+        bool Open(const std::string& file_path);
+        bool Contains(const std::string& path) const;
+        bool Read(const std::string& path, std::vector<std::byte>& data, Threading* threading = nullptr);
+        bool Read(const std::string& path, uint64_t offset, uint64_t size, std::byte* data, Threading* threading = nullptr); // only decompresses the chunks which cover the range
+        uint64_t GetSize(const std::string& path) const;
+        std::vector<std::string> GetPaths() const;
+        const std::string& GetFilePath() const { return m_file_path; }
+
+        // Packs every file under a directory, recursively
+        static bool Build(const std::string& directory, const std::string& file_path, Threading* threading = nullptr);
+
+        // Paths under the mount directory resolve to the package
+        static bool Mount(const std::string& file_path, const std::string& mount_directory, Threading* threading = nullptr);
+        static void Unmount(const std::string& file_path);
+        static bool Exists(const std::string& path);
+        static bool ReadMounted(const std::string& path, std::vector<std::byte>& data);
+        static Package* FindMounted(const std::string& path, std::string* path_package, Threading** threading = nullptr); // valid until unmounted
+
+        // Packs a directory and compares every file, read loose and read through the package
+        static bool Benchmark(const std::string& directory, Threading* threading = nullptr);
+
+    private:
+        struct Entry
+        {
+            uint64_t hash           = 0;
+            uint64_t size           = 0;
+            uint32_t chunk_first    = 0;
+            uint32_t chunk_count    = 0;
+            uint32_t path_offset    = 0;    // into the paths
+            uint32_t path_length    = 0;
+        };
+
+        struct Chunk
+        {
+            uint64_t offset             = 0;
+            uint32_t size_compressed    = 0;    // equal to the size when stored as is
+            uint32_t size               = 0;
+        };
+
+        const Entry* Find(const std::string& path) const;
+        bool ReadRange(const Entry& entry, uint64_t offset, uint64_t size, std::byte* data, Threading* threading, const std::string& path);
+
+        std::string m_file_path;
+        std::vector<Entry> m_entries;
+        std::vector<Chunk> m_chunks;
+        std::string m_paths;
+        std::ifstream m_file;
+        std::mutex m_mutex; // reads are serialized, decompression isn't
+    };
+}
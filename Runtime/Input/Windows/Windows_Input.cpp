@@ -43,9 +43,10 @@ namespace Spartan
         const WindowData& window_data   = context->m_engine->GetWindowData();
 		const auto window_handle	    = static_cast<HWND>(window_data.handle);
 
+        // Headless, there is nothing to read input from
         if (!window_handle)
         {
-            LOG_ERROR("Invalid window handle");
+            LOG_INFO("No window, input is disabled");
             return;
         }
 
@@ -115,6 +115,10 @@ namespace Spartan
             {
                 UpdateRhiMetricsString();
             }
+
+            // Timed lookups come from the previous profiled frame, start over for this one
+            m_rhi_descriptor_set_lookups_timed  = 0;
+            m_rhi_descriptor_set_lookup_time    = 0.0f;
         }
 
         ClearRhiMetrics();
@@ -301,12 +305,21 @@ namespace Spartan
             m_gpu_driver            = physical_device->GetDriverVersion();
             m_gpu_api               = physical_device->GetApiVersion();
         }
+
+        // Per usage class, not every API can break its memory down
+        m_gpu_memory_stats_available = true;
+        for (uint32_t i = 0; i < RHI_Memory_Pool_Count; i++)
+        {
+            m_gpu_memory_stats_available = m_gpu_memory_stats_available && rhi_device->GetMemoryStats(static_cast<RHI_Memory_Pool>(i), m_gpu_memory_stats[i]);
+        }
     }
 
     void Profiler::UpdateRhiMetricsString()
 	{
 		const auto texture_count	= m_resource_manager->GetResourceCount(Resource_Texture) + m_resource_manager->GetResourceCount(Resource_Texture2d) + m_resource_manager->GetResourceCount(Resource_TextureCube);
 		const auto material_count	= m_resource_manager->GetResourceCount(Resource_Material);
+        const float descriptor_set_hit_rate     = m_rhi_descriptor_set_lookups ? 100.0f * m_rhi_descriptor_set_hits / m_rhi_descriptor_set_lookups : 0.0f;
+        const float descriptor_set_lookup_time  = m_rhi_descriptor_set_lookups_timed ? m_rhi_descriptor_set_lookup_time / m_rhi_descriptor_set_lookups_timed : 0.0f;
 
         static const char* text =
             // Times
@@ -329,6 +342,7 @@ namespace Spartan
             // Renderer
             "Resolution:\t\t%dx%d\n"
             "Meshes rendered:\t%d\n"
+            "Meshes occluded:\t%d\n"
             "Textures:\t\t\t%d\n"
             "Materials:\t\t%d\n"
             "\n"
@@ -345,7 +359,10 @@ namespace Spartan
             "Render target bindings:\t%d\n"
             "Pipeline bindings:\t\t\t%d\n"
             "Descriptor set bindings:\t%d\n"
-            "Pipeline barriers:\t\t\t%d";
+            "Pipeline barriers:\t\t\t%d\n"
+            "Descriptor set lookups:\t%d\n"
+            "Descriptor set hit rate:\t%.2f%%\n"
+            "Descriptor set lookup:\t\t%.3f us";
 
         static char buffer[2048];
 		sprintf_s
@@ -367,6 +384,7 @@ namespace Spartan
 			// Renderer
 			static_cast<int>(m_renderer->GetResolution().x), static_cast<int>(m_renderer->GetResolution().y),
 			m_renderer_meshes_rendered,
+			m_renderer_meshes_occluded,
 			texture_count,
 			material_count,
 
@@ -383,9 +401,24 @@ namespace Spartan
 			m_rhi_bindings_render_target,
             m_rhi_bindings_pipeline,
             m_rhi_bindings_descriptor_set,
-            m_rhi_pipeline_barriers
+            m_rhi_pipeline_barriers,
+            m_rhi_descriptor_set_lookups,
+            descriptor_set_hit_rate,
+            descriptor_set_lookup_time
 		);
 
 		m_metrics = string(buffer);
+
+        // Memory pools
+        if (m_gpu_memory_stats_available)
+        {
+            m_metrics += "\n\nMemory pools:\t\tused/reserved MB\tallocations";
+            for (uint32_t i = 0; i < RHI_Memory_Pool_Count; i++)
+            {
+                const RHI_Memory_Stats& stats = m_gpu_memory_stats[i];
+                sprintf_s(buffer, "\n%s:\t\t%.1f/%.1f\t\t%d%s", rhi_memory_pool_to_string(static_cast<RHI_Memory_Pool>(i)), stats.bytes_used / 1048576.0f, stats.bytes_reserved / 1048576.0f, stats.allocation_count, (stats.budget != 0 && stats.bytes_used > stats.budget) ? " (over budget)" : "");
+                m_metrics += buffer;
+            }
+        }
 	}
 }
@@ -24,8 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==================
 #include <string>
 #include <vector>
+#include <array>
 #include "TimeBlock.h"
 #include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
 #include "../Core/ISubsystem.h"
 #include "../Core/Stopwatch.h"
 //=============================
@@ -73,7 +75,10 @@ namespace Spartan
 		const auto& GpuGetName()                        const { return m_gpu_name; }
         auto GpuGetMemoryAvailable()                    const { return m_gpu_memory_available; }
         auto GpuGetMemoryUsed()                         const { return m_gpu_memory_used; }
+        bool GpuHasMemoryStats()                        const { return m_gpu_memory_stats_available; }
+        const auto& GpuGetMemoryStats()                 const { return m_gpu_memory_stats; } // per RHI_Memory_Pool
         bool IsCpuStuttering()                          const { return m_is_stuttering_cpu; }
+        bool IsProfilingCpu()                           const { return m_profile && m_profile_cpu_enabled; }
         bool IsGpuStuttering()                          const { return m_is_stuttering_gpu; }
 		
 		// Metrics - RHI
@@ -90,9 +95,14 @@ namespace Spartan
         uint32_t m_rhi_bindings_descriptor_set  = 0;     
         uint32_t m_rhi_bindings_pipeline        = 0;
         uint32_t m_rhi_pipeline_barriers        = 0;
+        uint32_t m_rhi_descriptor_set_lookups   = 0;
+        uint32_t m_rhi_descriptor_set_hits      = 0;
+        uint32_t m_rhi_descriptor_set_lookups_timed = 0;    // only lookups made on profiled frames are timed
+        float m_rhi_descriptor_set_lookup_time      = 0.0f; // microseconds, summed over the timed lookups
 
 		// Metrics - Renderer
 		uint32_t m_renderer_meshes_rendered = 0;
+		uint32_t m_renderer_meshes_occluded = 0;
 
 		// Metrics - Time
 		float m_time_frame_avg  = 0.0f;
@@ -113,6 +123,7 @@ namespace Spartan
         {
             m_rhi_draw_calls                = 0;
             m_renderer_meshes_rendered      = 0;
+            m_renderer_meshes_occluded      = 0;
             m_rhi_bindings_buffer_index     = 0;
             m_rhi_bindings_buffer_vertex    = 0;
             m_rhi_bindings_buffer_constant  = 0;
@@ -125,6 +136,8 @@ namespace Spartan
             m_rhi_bindings_descriptor_set   = 0;
             m_rhi_bindings_pipeline         = 0;
             m_rhi_pipeline_barriers         = 0;
+            m_rhi_descriptor_set_lookups        = 0;
+            m_rhi_descriptor_set_hits           = 0;
         }
 
 		TimeBlock* GetNewTimeBlock();
@@ -157,6 +170,8 @@ namespace Spartan
         std::string m_gpu_api           = "N/A";
 		uint32_t m_gpu_memory_available	= 0;
 		uint32_t m_gpu_memory_used		= 0;
+        std::array<RHI_Memory_Stats, RHI_Memory_Pool_Count> m_gpu_memory_stats;
+        bool m_gpu_memory_stats_available = false;
 
         // Stutter detection
         float m_stutter_delta_ms    = 0.5f;
@@ -51,6 +51,7 @@ namespace Spartan
 
         // Resource limits
         m_rhi_context->max_texture_dimension_2d = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+        m_rhi_context->max_constant_buffer_size = D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16;
 
         const PhysicalDevice* physical_device = GetPrimaryPhysicalDevice();
         if (!physical_device)
@@ -220,7 +221,7 @@ namespace Spartan
         d3d11_utility::release(m_rhi_context->annotation);
 	}
 
-    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* wait_fence /*= nullptr*/, uint32_t wait_flags /*= 0*/) const
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* wait_fence /*= nullptr*/, uint32_t wait_flags /*= 0*/, const uint64_t signal_semaphore_value /*= 0*/) const
     {
         return true;
     }
@@ -230,4 +231,27 @@ namespace Spartan
         m_rhi_context->device_context->Flush();
         return true;
     }
+
+    bool RHI_Device::Queue_WaitUploads() const
+    {
+        // Uploads are synchronous
+        return true;
+    }
+
+    void RHI_Device::DestroyDeferred(function<void()>&& destroy) const
+    {
+        // The runtime tracks resource lifetimes itself
+        destroy();
+    }
+
+    void RHI_Device::Tick()
+    {
+
+    }
+
+    bool RHI_Device::GetMemoryStats(const RHI_Memory_Pool pool, RHI_Memory_Stats& stats) const
+    {
+        // The runtime allocates the memory, it doesn't expose it per usage class
+        return false;
+    }
 }
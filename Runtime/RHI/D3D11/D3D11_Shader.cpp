@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Device.h"
 #include "../RHI_Shader.h"
 #include "../RHI_InputLayout.h"
+#include "../RHI_ShaderCache.h"
 #include "../../Logging/Log.h"
 #include "../../Core/FileSystem.h"
 #include <d3dcompiler.h>
@@ -77,47 +78,69 @@ namespace Spartan
 		}
 		defines.emplace_back(D3D_SHADER_MACRO{ nullptr, nullptr });
 
-		// Compile
+		// Look for the compiled shader in the cache
 		ID3DBlob* blob_error	= nullptr;
 		ID3DBlob* shader_blob	= nullptr;
-		HRESULT result;
-		if (FileSystem::IsFile(shader)) // From file ?
-		{
-            const auto file_path = FileSystem::StringToWstring(shader);
-			result = D3DCompileFromFile
-			(
-				file_path.c_str(),
-				defines.data(),
-				D3D_COMPILE_STANDARD_FILE_INCLUDE,
-				GetEntryPoint(),
-                GetTargetProfile(),
-				compile_flags,
-				0,
-				&shader_blob,
-				&blob_error
-			);
-		}
-		else if(shader.find("return") != std::string::npos) // From source ?
-		{
-            result = D3DCompile
-            (
-                shader.c_str(),
-                static_cast<SIZE_T>(shader.size()),
-                nullptr,
-                defines.data(),
-                nullptr,
-                GetEntryPoint(),
-                GetTargetProfile(),
-                compile_flags,
-                0,
-                &shader_blob,
-                &blob_error
-            );
+		HRESULT result          = E_FAIL;
+        uint64_t cache_key      = 0;
+        if (m_shader_cache && m_shader_cache->IsEnabled())
+        {
+            const string compiler = "d3dcompiler " + to_string(D3D_COMPILER_VERSION) + " " + to_string(compile_flags);
+            cache_key = RHI_ShaderCache::ComputeKey(shader, m_defines, GetEntryPoint(), GetTargetProfile(), compiler);
+
+            vector<uint8_t> bytecode;
+            if (m_shader_cache->Load(cache_key, &bytecode, &m_descriptors))
+            {
+                result = D3DCreateBlob(bytecode.size(), &shader_blob);
+                if (SUCCEEDED(result))
+                {
+                    memcpy(shader_blob->GetBufferPointer(), bytecode.data(), bytecode.size());
+                }
+            }
         }
-        else
+
+		// Compile
+        const bool is_cached = shader_blob != nullptr;
+        if (!is_cached)
         {
-            LOG_ERROR("\"%s\" is not file or a source", shader.c_str());
-            return nullptr;
+            if (FileSystem::IsFile(shader)) // From file ?
+            {
+                const auto file_path = FileSystem::StringToWstring(shader);
+                result = D3DCompileFromFile
+                (
+                    file_path.c_str(),
+                    defines.data(),
+                    D3D_COMPILE_STANDARD_FILE_INCLUDE,
+                    GetEntryPoint(),
+                    GetTargetProfile(),
+                    compile_flags,
+                    0,
+                    &shader_blob,
+                    &blob_error
+                );
+            }
+            else if(shader.find("return") != std::string::npos) // From source ?
+            {
+                result = D3DCompile
+                (
+                    shader.c_str(),
+                    static_cast<SIZE_T>(shader.size()),
+                    nullptr,
+                    defines.data(),
+                    nullptr,
+                    GetEntryPoint(),
+                    GetTargetProfile(),
+                    compile_flags,
+                    0,
+                    &shader_blob,
+                    &blob_error
+                );
+            }
+            else
+            {
+                LOG_ERROR("\"%s\" is not file or a source", shader.c_str());
+                return nullptr;
+            }
         }
 
 		// Log any compilation possible warnings and/or errors
@@ -155,6 +178,13 @@ namespace Spartan
 			}
 		}
 
+		// Save for the next run
+        if (!is_cached && shader_blob && m_shader_cache && m_shader_cache->IsEnabled())
+        {
+            const uint8_t* data = static_cast<const uint8_t*>(shader_blob->GetBufferPointer());
+            m_shader_cache->Save(cache_key, vector<uint8_t>(data, data + shader_blob->GetBufferSize()), m_descriptors);
+        }
+
 		// Create shader
 		void* shader_view = nullptr;
 		if (shader_blob)
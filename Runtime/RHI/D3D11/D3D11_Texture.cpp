@@ -93,8 +93,7 @@ namespace Spartan
 		void*& texture,
 		const uint32_t width,
 		const uint32_t height,
-		const uint32_t channels,
-		const uint32_t bits_per_channel,
+		const RHI_Texture* texture_rhi,
 		const uint32_t array_size,
 		const DXGI_FORMAT format,
 		const UINT bind_flags,
@@ -127,8 +126,8 @@ namespace Spartan
 			}
 
 			auto& subresource_data				= vec_subresource_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
-			subresource_data.pSysMem			= data[mip_level].data();					                // Data pointer		
-			subresource_data.SysMemPitch		= (width >> mip_level) * channels * (bits_per_channel / 8);	// Line width in bytes
+			subresource_data.pSysMem			= data[mip_level].data();					// Data pointer		
+			subresource_data.SysMemPitch		= texture_rhi->GetRowPitch(texture_rhi->GetMipFirst() + mip_level);	// Line width in bytes (of 4x4 blocks when block compressed)
 			subresource_data.SysMemSlicePitch	= 0;								                        // This is only used for 3D textures
 		}
 
@@ -284,10 +283,9 @@ namespace Spartan
 		result_tex = CreateTexture2d
 		(
             m_resource,
-			m_width,
-			m_height,
-			m_channel_count,
-			m_bits_per_channel,
+			GetWidthResident(),
+			GetHeightResident(),
+			this,
 			m_array_size,
 			format,
 			flags,
@@ -0,0 +1,53 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_BindlessTable.h"
+//================================
+
+namespace Spartan
+{
+    // Not supported, the renderer binds textures individually
+
+    RHI_BindlessTable::RHI_BindlessTable(RHI_Device* rhi_device, const uint32_t texture_capacity)
+    {
+        m_rhi_device        = rhi_device;
+        m_texture_capacity  = texture_capacity;
+    }
+
+    RHI_BindlessTable::~RHI_BindlessTable() = default;
+
+    bool RHI_BindlessTable::WriteTexture(const uint32_t index, RHI_Texture* texture)
+    {
+        return false;
+    }
+
+    bool RHI_BindlessTable::CreateMaterialBuffer()
+    {
+        return false;
+    }
+
+    bool RHI_BindlessTable::CreateInstanceBuffer()
+    {
+        return false;
+    }
+}
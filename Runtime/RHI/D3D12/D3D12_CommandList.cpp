@@ -108,6 +108,12 @@ namespace Spartan
         return true;
 	}
 
+    bool RHI_CommandList::DrawIndexedIndirect(RHI_IndirectBuffer* buffer, const uint32_t command_offset, const uint32_t command_count)
+    {
+        // Not supported, the renderer records draws individually
+        return false;
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z /*= 1*/) const
     {
         
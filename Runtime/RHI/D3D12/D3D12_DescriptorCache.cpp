@@ -29,13 +29,18 @@ namespace Spartan
     RHI_DescriptorCache::~RHI_DescriptorCache()
     = default;
 
-    void RHI_DescriptorCache::SetDescriptorSetCapacity(uint32_t descriptor_set_capacity)
+    void* RHI_DescriptorCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
+    {
+        return nullptr;
+    }
+
+    void RHI_DescriptorCache::DestroyDescriptorPool(DescriptorPool* pool)
     {
 
     }
 
-    bool RHI_DescriptorCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
+    void RHI_DescriptorCache::ResetDescriptorPool(const RHI_Device* rhi_device, DescriptorPool* pool)
     {
-        return true;
+
     }
 }
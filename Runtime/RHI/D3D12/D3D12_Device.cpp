@@ -108,7 +108,7 @@ namespace Spartan
         d3d12_utility::release(m_rhi_context->device);
 	}
 
-    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* wait_fence /*= nullptr*/, uint32_t wait_flags /*= 0*/) const
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* wait_fence /*= nullptr*/, uint32_t wait_flags /*= 0*/, const uint64_t signal_semaphore_value /*= 0*/) const
     {
         return true;
     }
@@ -117,4 +117,24 @@ namespace Spartan
     {
         return true;
     }
+
+    bool RHI_Device::Queue_WaitUploads() const
+    {
+        return true;
+    }
+
+    void RHI_Device::DestroyDeferred(function<void()>&& destroy) const
+    {
+        destroy();
+    }
+
+    void RHI_Device::Tick()
+    {
+
+    }
+
+    bool RHI_Device::GetMemoryStats(const RHI_Memory_Pool pool, RHI_Memory_Stats& stats) const
+    {
+        return false;
+    }
 }
@@ -0,0 +1,94 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_BindlessTable.h"
+#include "../RHI_Texture.h"
+#include <cstring>
+//================================
+
+namespace Spartan
+{
+    RHI_BindlessTable::RHI_BindlessTable(RHI_Device* rhi_device, const uint32_t texture_capacity)
+    {
+        m_rhi_device        = rhi_device;
+        m_texture_capacity  = texture_capacity;
+
+        m_descriptor_set_layout = null_utility::handle::create();
+        m_descriptor_pool       = null_utility::handle::create();
+        m_descriptor_set        = null_utility::handle::create();
+
+        m_initialized = true;
+    }
+
+    RHI_BindlessTable::~RHI_BindlessTable()
+    {
+        m_material_mapped   = nullptr;
+        m_material_buffer   = nullptr;
+        null_utility::memory::free(m_material_allocation);
+
+        m_instance_mapped   = nullptr;
+        m_instance_buffer   = nullptr;
+        null_utility::memory::free(m_instance_allocation);
+
+        m_descriptor_set        = nullptr;
+        m_descriptor_pool       = nullptr;
+        m_descriptor_set_layout = nullptr;
+    }
+
+    bool RHI_BindlessTable::WriteTexture(const uint32_t index, RHI_Texture* texture)
+    {
+        if (!null_utility::validation::check(index < m_texture_capacity, __FUNCTION__, "The texture index is out of the table"))
+            return false;
+
+        return null_utility::validation::check(texture->Get_Resource_View() != nullptr, __FUNCTION__, "The texture has no view to sample from");
+    }
+
+    bool RHI_BindlessTable::CreateMaterialBuffer()
+    {
+        const uint64_t size = static_cast<uint64_t>(m_materials.size()) * m_material_region_count;
+
+        m_material_allocation = null_utility::memory::allocate(size);
+        if (!m_material_allocation)
+            return false;
+
+        memset(m_material_allocation, 0, static_cast<size_t>(size));
+        m_material_mapped = m_material_allocation;
+        m_material_buffer = null_utility::handle::create();
+
+        return true;
+    }
+
+    bool RHI_BindlessTable::CreateInstanceBuffer()
+    {
+        const uint64_t size = static_cast<uint64_t>(m_instance_stride) * m_instance_capacity * m_instance_region_count;
+
+        m_instance_allocation = null_utility::memory::allocate(size);
+        if (!m_instance_allocation)
+            return false;
+
+        m_instance_mapped = m_instance_allocation;
+        m_instance_buffer = null_utility::handle::create();
+
+        return true;
+    }
+}
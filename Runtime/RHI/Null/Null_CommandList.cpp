@@ -0,0 +1,660 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "../RHI_Implementation.h"
+#include "../RHI_CommandList.h"
+#include "../RHI_Pipeline.h"
+#include "../RHI_VertexBuffer.h"
+#include "../RHI_IndexBuffer.h"
+#include "../RHI_IndirectBuffer.h"
+#include "../RHI_Texture.h"
+#include "../RHI_DescriptorCache.h"
+#include "../RHI_PipelineCache.h"
+#include "../RHI_BindlessTable.h"
+#include "../RHI_DescriptorSetLayout.h"
+#include "../../Profiling/Profiler.h"
+#include "../../Rendering/Renderer.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    RHI_CommandList::RHI_CommandList(uint32_t index, RHI_SwapChain* swap_chain, Context* context)
+	{
+        m_swap_chain        = swap_chain;
+        m_renderer          = context->GetSubsystem<Renderer>();
+        m_profiler          = context->GetSubsystem<Profiler>();
+		m_rhi_device	    = m_renderer->GetRhiDevice().get();
+        m_pipeline_cache    = m_renderer->GetPipelineCache();
+        m_descriptor_cache  = m_renderer->GetDescriptorCache();
+
+        m_cmd_buffer            = null_utility::handle::create();
+        m_processed_fence       = null_utility::handle::create();
+        m_processed_semaphore   = null_utility::handle::create();
+
+        m_timestamps.fill(0);
+	}
+
+	RHI_CommandList::~RHI_CommandList()
+	{
+        m_cmd_buffer            = nullptr;
+        m_processed_fence       = nullptr;
+        m_processed_semaphore   = nullptr;
+	}
+
+    bool RHI_CommandList::Begin()
+    {
+        // Sync CPU to GPU
+        if (!Wait())
+        {
+            LOG_ERROR("Failed to wait");
+            return false;
+        }
+
+        m_timestamp_index = 0;
+
+        if (m_cmd_state != RHI_Cmd_List_Idle)
+        {
+            LOG_ERROR("The command list is still being used");
+            return false;
+        }
+
+        m_cmd_state = RHI_Cmd_List_Recording;
+        m_flushed   = false;
+        return true;
+    }
+
+    bool RHI_CommandList::Stop()
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("The command list is not recording, no need to stop it");
+            return true;
+        }
+
+        m_cmd_state = RHI_Cmd_List_Submittable;
+        return true;
+    }
+
+    bool RHI_CommandList::Submit()
+    {
+        // Ensure the command list has recorded
+        if (m_cmd_state == RHI_Cmd_List_Idle)
+        {
+            LOG_WARNING("The command list is idle, nothing to submit");
+            return false;
+        }
+
+        // Ensure the command list is not recording
+        if (m_cmd_state == RHI_Cmd_List_Recording)
+        {
+            if (!Stop())
+            {
+                LOG_ERROR("Failed to stop recording");
+                return false;
+            }
+        }
+
+        if (!m_rhi_device->Queue_Submit(RHI_Queue_Graphics, m_cmd_buffer, nullptr, m_processed_semaphore, m_processed_fence))
+            return false;
+
+        m_cmd_state = RHI_Cmd_List_Pending;
+
+        return true;
+    }
+
+    bool RHI_CommandList::Wait()
+    {
+        // Submitted work completes immediately
+        if (m_cmd_state == RHI_Cmd_List_Pending)
+        {
+            m_cmd_state = RHI_Cmd_List_Idle;
+        }
+
+        return true;
+    }
+
+    bool RHI_CommandList::Reset()
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+            return true;
+
+        lock_guard<mutex> guard(m_mutex_reset);
+
+        m_cmd_state = RHI_Cmd_List_Idle;
+        return true;
+    }
+
+    bool RHI_CommandList::BeginRenderPass(RHI_PipelineState& pipeline_state)
+	{
+        null_utility::validation::check(!m_render_pass_active, __FUNCTION__, "A render pass is already active");
+
+        // Get pipeline
+        {
+            m_pipeline_active = false;
+
+            // Update the descriptor cache with the pipeline state and potentially create a new pipeline (if not already there)
+            m_descriptor_cache->SetPipelineState(pipeline_state);
+
+            // Get a pipeline which matches the pipeline state
+            m_pipeline = m_pipeline_cache->GetPipeline(this, pipeline_state, m_descriptor_cache->GetResource_DescriptorSetLayout());
+            if (!m_pipeline)
+            {
+                LOG_ERROR("Failed to acquire appropriate pipeline");
+                return false;
+            }
+
+            // Keep a local pointer for convenience
+            m_pipeline_state = &pipeline_state;
+        }
+
+        // Start profiler (if used)
+        Timeblock_Start(m_pipeline_state);
+
+        // Shader resources
+        {
+            // If the pipeline changed, resources have to be set again
+            m_vertex_buffer_id  = 0;
+            m_index_buffer_id   = 0;
+
+            // Same as Vulkan, global resources are set with every render pass
+            m_renderer->SetGlobalSamplersAndConstantBuffers(this);
+        }
+
+        return true;
+	}
+
+    bool RHI_CommandList::EndRenderPass()
+    {
+        // Render pass
+        if (m_render_pass_active)
+        {
+            m_rhi_device->GetContextRhi()->commands++;
+            m_render_pass_active = false;
+        }
+
+        // Profiling
+        Timeblock_End(m_pipeline_state);
+       
+        return true;
+    }
+
+    void RHI_CommandList::Clear(RHI_PipelineState& pipeline_state)
+    {
+        if (m_render_pass_active)
+        {
+            m_rhi_device->GetContextRhi()->commands++;
+        }
+        else if (BeginRenderPass(pipeline_state))
+        {
+            OnDraw();
+            EndRenderPass();
+        }
+    }
+
+    bool RHI_CommandList::Draw(const uint32_t vertex_count)
+	{
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        rhi_context->commands++;
+        rhi_context->draws++;
+
+        m_profiler->m_rhi_draw_calls++;
+
+        return true;
+	}
+
+    bool RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset)
+	{
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        if (!null_utility::validation::check(m_index_buffer_id != 0, __FUNCTION__, "No index buffer is bound"))
+            return false;
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        rhi_context->commands++;
+        rhi_context->draws++;
+
+        m_profiler->m_rhi_draw_calls++;
+
+        return true;
+	}
+
+    bool RHI_CommandList::DrawIndexedIndirect(RHI_IndirectBuffer* buffer, const uint32_t command_offset, const uint32_t command_count)
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        if (!buffer || !buffer->GetResource() || command_count == 0)
+            return false;
+
+        // The commands are read from the buffer by the GPU, so reading past its end wouldn't be caught until it's too late
+        if (!null_utility::validation::check(command_offset + command_count <= buffer->GetCommandCapacity() * buffer->GetRegionCount(), __FUNCTION__, "The commands are out of the buffer's range"))
+            return false;
+
+        if (!null_utility::validation::check(m_index_buffer_id != 0, __FUNCTION__, "No index buffer is bound"))
+            return false;
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        rhi_context->commands++;
+        rhi_context->draws += command_count;
+
+        m_profiler->m_rhi_draw_calls += command_count;
+
+        return true;
+    }
+
+    void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z /*= 1*/) const
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        m_rhi_device->GetContextRhi()->commands++;
+    }
+
+	void RHI_CommandList::SetViewport(const RHI_Viewport& viewport) const
+	{
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        null_utility::validation::check(viewport.width > 0.0f && viewport.height > 0.0f, __FUNCTION__, "Invalid viewport");
+
+        m_rhi_device->GetContextRhi()->commands++;
+	}
+
+	void RHI_CommandList::SetScissorRectangle(const Math::Rectangle& scissor_rectangle) const
+	{
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        m_rhi_device->GetContextRhi()->commands++;
+	}
+
+	void RHI_CommandList::SetBufferVertex(const RHI_VertexBuffer* buffer, const uint64_t offset /*= 0*/)
+	{
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        if (!null_utility::validation::check(buffer && buffer->GetResource(), __FUNCTION__, "Invalid vertex buffer"))
+            return;
+
+        if (m_vertex_buffer_id == buffer->GetId() && m_vertex_buffer_offset == offset)
+            return;
+
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        rhi_context->commands++;
+        rhi_context->state_changes++;
+
+        m_profiler->m_rhi_bindings_buffer_vertex++;
+        m_vertex_buffer_id      = buffer->GetId();
+        m_vertex_buffer_offset  = offset;
+	}
+
+	void RHI_CommandList::SetBufferIndex(const RHI_IndexBuffer* buffer, const uint64_t offset /*= 0*/)
+	{
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        if (!null_utility::validation::check(buffer && buffer->GetResource(), __FUNCTION__, "Invalid index buffer"))
+            return;
+
+        if (m_index_buffer_id == buffer->GetId() && m_index_buffer_offset == offset)
+            return;
+
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        rhi_context->commands++;
+        rhi_context->state_changes++;
+
+        m_profiler->m_rhi_bindings_buffer_index++;
+        m_index_buffer_id       = buffer->GetId();
+        m_index_buffer_offset   = offset;
+	}
+
+    bool RHI_CommandList::SetConstantBuffer(const uint32_t slot, const uint8_t scope, RHI_ConstantBuffer* constant_buffer) const
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        // Set (will only happen if it's not already set)
+        return m_descriptor_cache->SetConstantBuffer(slot, constant_buffer);
+    }
+
+    void RHI_CommandList::SetSampler(const uint32_t slot, RHI_Sampler* sampler) const
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        // Set (will only happen if it's not already set)
+        m_descriptor_cache->SetSampler(slot, sampler);
+    }
+
+    void RHI_CommandList::SetTexture(const uint32_t slot, RHI_Texture* texture, const uint8_t scope /*= RHI_Shader_Pixel*/)
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        // Null textures are allowed, and get replaced with a black texture here
+        if (!texture || !texture->Get_Resource_View())
+        {
+            texture = m_renderer->GetBlackTexture();
+        }
+
+        // Transition to appropriate layout (if needed)
+        {
+            RHI_Image_Layout target_layout = RHI_Image_Undefined;
+
+            // Color
+            if (texture->IsColorFormat() && texture->GetLayout() != RHI_Image_Shader_Read_Only_Optimal)
+            {
+                target_layout = RHI_Image_Shader_Read_Only_Optimal;
+            }
+
+            // Depth
+            if (texture->IsDepthFormat() && texture->GetLayout() != RHI_Image_Depth_Stencil_Read_Only_Optimal)
+            {
+                target_layout = RHI_Image_Depth_Stencil_Read_Only_Optimal;
+            }
+
+            bool transition_required = target_layout != RHI_Image_Undefined;
+
+            // Transition
+            if (transition_required && !m_render_pass_active)
+            {
+                texture->SetLayout(target_layout, this);
+            }
+            else if (transition_required && m_render_pass_active)
+            {
+                LOG_WARNING("Can't transition texture to target layout while a render pass is active");
+                texture = m_renderer->GetBlackTexture();
+            }
+        }
+
+        // Set (will only happen if it's not already set)
+        m_descriptor_cache->SetTexture(slot, texture);
+    }
+
+    uint32_t RHI_CommandList::Gpu_GetMemory(RHI_Device* rhi_device)
+    {
+        return 0;
+    }
+
+    uint32_t RHI_CommandList::Gpu_GetMemoryUsed(RHI_Device* rhi_device)
+    {
+        return 0;
+    }
+
+    bool RHI_CommandList::Timestamp_Start(void* query_disjoint /*= nullptr*/, void* query_start /*= nullptr*/)
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool RHI_CommandList::Timestamp_End(void* query_disjoint /*= nullptr*/, void* query_end /*= nullptr*/)
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        return true;
+    }
+
+    float RHI_CommandList::Timestamp_GetDuration(void* query_disjoint, void* query_start, void* query_end, const uint32_t pass_index)
+    {
+        // There is no GPU time, only the CPU time blocks mean something
+        return 0.0f;
+    }
+
+    bool RHI_CommandList::Gpu_QueryCreate(RHI_Device* rhi_device, void** query /*= nullptr*/, RHI_Query_Type type /*= RHI_Query_Timestamp*/)
+    {
+        // Not needed
+        return true;
+    }
+
+    void RHI_CommandList::Gpu_QueryRelease(void*& query_object)
+    {
+        // Not needed
+    }
+
+    bool RHI_CommandList::IsRecording() const
+    {
+        return m_cmd_state == RHI_Cmd_List_Recording;
+    }
+
+    bool RHI_CommandList::IsPending() const
+    {
+        return m_cmd_state == RHI_Cmd_List_Pending;
+    }
+
+    bool RHI_CommandList::IsIdle() const
+    {
+        return m_cmd_state == RHI_Cmd_List_Idle;
+    }
+
+    void RHI_CommandList::Timeblock_Start(const RHI_PipelineState* pipeline_state)
+    {
+        if (!pipeline_state || !pipeline_state->pass_name)
+            return;
+
+        // Allowed profiler ?
+        if (m_rhi_device->GetContextRhi()->profiler)
+        {
+            if (m_profiler && pipeline_state->profile)
+            {
+                m_profiler->TimeBlockStart(pipeline_state->pass_name, TimeBlock_Cpu, this);
+                m_profiler->TimeBlockStart(pipeline_state->pass_name, TimeBlock_Gpu, this);
+            }
+        }
+    }
+
+    void RHI_CommandList::Timeblock_End(const RHI_PipelineState* pipeline_state)
+    {
+        if (!pipeline_state)
+            return;
+
+        // Allowed profiler ?
+        if (m_rhi_device->GetContextRhi()->profiler && pipeline_state->profile)
+        {
+            if (m_profiler)
+            {
+                m_profiler->TimeBlockEnd(); // cpu
+                m_profiler->TimeBlockEnd(); // gpu
+            }
+        }
+    }
+
+    bool RHI_CommandList::Deferred_BeginRenderPass()
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        RHI_PipelineState* pipeline_state = m_pipeline->GetPipelineState();
+
+        if (!pipeline_state)
+        {
+            LOG_ERROR("There is no pipeline state");
+            return false;
+        }
+
+        if (!pipeline_state->GetRenderPass())
+        {
+            LOG_ERROR("Current pipeline has no render pass");
+            return false;
+        }
+
+        if (!pipeline_state->GetFrameBuffer())
+        {
+            LOG_ERROR("Current pipeline has no frame buffer");
+            return false;
+        }
+
+        m_rhi_device->GetContextRhi()->commands++;
+
+        m_render_pass_active = true;
+        return true;
+    }
+
+    bool RHI_CommandList::Deferred_BindDescriptorSet()
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+            return false;
+
+        // Descriptor set != null, result = true    -> the descriptor set must be bound
+        // Descriptor set == null, result = true    -> the descriptor set is already bound
+        // Descriptor set == null, result = false   -> a new descriptor set was needed but it couldn't be allocated
+
+        void* descriptor_set = nullptr;
+        bool result = m_descriptor_cache->GetResource_DescriptorSet(descriptor_set);
+
+        if (result && descriptor_set != nullptr)
+        {
+            RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+            rhi_context->commands++;
+            rhi_context->state_changes++;
+
+            m_profiler->m_rhi_bindings_descriptor_set++;
+        }
+
+        return result;
+    }
+
+    bool RHI_CommandList::Deferred_BindPipeline()
+    {
+        if (!m_pipeline->GetPipeline())
+        {
+            LOG_ERROR("Invalid pipeline");
+            return false;
+        }
+
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+        rhi_context->commands++;
+        rhi_context->state_changes++;
+
+        m_profiler->m_rhi_bindings_pipeline++;
+        m_pipeline_active = true;
+
+        // The bindless table is the second set, it stays bound while the first one changes from draw to draw
+        RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable();
+        if (m_pipeline_state->bindless && bindless_table)
+        {
+            rhi_context->commands++;
+            rhi_context->state_changes++;
+
+            m_profiler->m_rhi_bindings_descriptor_set++;
+        }
+
+        return true;
+    }
+
+    bool RHI_CommandList::OnDraw()
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+            return false;
+
+        if (m_flushed)
+            return false;
+
+        // Begin render pass
+        if (!m_render_pass_active)
+        {
+            if (!Deferred_BeginRenderPass())
+            {
+                LOG_ERROR("Failed to begin render pass");
+                return false;
+            }
+        }
+
+        // Set pipeline
+        if (!m_pipeline_active)
+        {
+            if (!Deferred_BindPipeline())
+            {
+                LOG_ERROR("Failed to begin render pass");
+                return false;
+            }
+        }
+
+        // Bind descriptor set
+        return Deferred_BindDescriptorSet();
+    }
+}
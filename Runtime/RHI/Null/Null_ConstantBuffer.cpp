@@ -0,0 +1,107 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_ConstantBuffer.h"
+#include "../RHI_Device.h"
+#include "../../Logging/Log.h"
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    void RHI_ConstantBuffer::_destroy()
+    {
+        m_mapped = nullptr;
+        m_buffer = nullptr;
+        null_utility::memory::free(m_allocation);
+    }
+
+    RHI_ConstantBuffer::RHI_ConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const string& name, bool is_dynamic /*= false*/)
+    {
+        m_rhi_device    = rhi_device;
+        m_name          = name;
+        m_is_dynamic    = is_dynamic;
+    }
+
+	bool RHI_ConstantBuffer::_create()
+	{
+		if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+        if (!null_utility::validation::check(m_stride != 0 && m_offset_count != 0, __FUNCTION__, "The buffer has no size"))
+            return false;
+
+        // Destroy previous buffer
+        _destroy();
+
+        // Same alignment as the strictest offset alignment a GPU asks for, so that offsets are computed the same way
+        const uint32_t min_ubo_alignment = 256;
+        m_stride    = (m_stride + min_ubo_alignment - 1) & ~(min_ubo_alignment - 1);
+        m_size_gpu  = m_offset_count * m_stride;
+
+        m_allocation    = null_utility::memory::allocate(m_size_gpu);
+        m_buffer        = null_utility::handle::create();
+
+		return true;
+	}
+
+    void* RHI_ConstantBuffer::Map()
+    {
+        if (!m_allocation)
+        {
+            LOG_ERROR("Invalid allocation");
+            return nullptr;
+        }
+
+        m_mapped = m_allocation;
+
+        return m_mapped;
+    }
+
+    bool RHI_ConstantBuffer::Unmap(const uint64_t offset /*= 0*/, const uint64_t size /*= 0*/)
+    {
+        if (!m_allocation)
+        {
+            LOG_ERROR("Invalid allocation");
+            return false;
+        }
+
+        if (!null_utility::validation::check(offset + size <= m_size_gpu, __FUNCTION__, "The flushed range is out of the buffer"))
+            return false;
+
+        m_rhi_device->GetContextRhi()->bytes_uploaded += size != 0 ? size : m_size_gpu - offset;
+
+        if (!m_persistent_mapping)
+        {
+            m_mapped = nullptr;
+        }
+
+        return true;
+    }
+}
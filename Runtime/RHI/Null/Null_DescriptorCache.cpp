@@ -0,0 +1,66 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "../RHI_Implementation.h"
+#include "../RHI_DescriptorCache.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_DescriptorCache::~RHI_DescriptorCache()
+    {
+        for (const shared_ptr<DescriptorPool>& pool : m_pools_frame)
+        {
+            DestroyDescriptorPool(pool.get());
+        }
+
+        for (const shared_ptr<DescriptorPool>& pool : m_pools_persistent)
+        {
+            DestroyDescriptorPool(pool.get());
+        }
+    }
+
+    void RHI_DescriptorCache::DestroyDescriptorPool(DescriptorPool* pool)
+    {
+        if (!pool)
+            return;
+
+        pool->resource = nullptr;
+    }
+
+    void RHI_DescriptorCache::ResetDescriptorPool(const RHI_Device* rhi_device, DescriptorPool* pool)
+    {
+        // Sets are handles, there is nothing to return to the pool
+    }
+
+    void* RHI_DescriptorCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
+    {
+        if (!null_utility::validation::check(descriptor_set_capacity != 0, __FUNCTION__, "A descriptor pool needs some capacity"))
+            return nullptr;
+
+        return null_utility::handle::create();
+    }
+}
@@ -0,0 +1,79 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "../RHI_Implementation.h"
+#include "../RHI_DescriptorSetLayout.h"
+//=====================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_DescriptorSetLayout::~RHI_DescriptorSetLayout()
+    {
+        m_descriptor_set_layout = nullptr;
+    }
+
+    void* RHI_DescriptorSetLayout::CreateDescriptorSet(void* descriptor_pool)
+    {
+        if (!null_utility::validation::check(descriptor_pool != nullptr, __FUNCTION__, "Invalid descriptor pool"))
+            return nullptr;
+
+        void* descriptor_set = null_utility::handle::create();
+
+        UpdateDescriptorSet(descriptor_set, m_descriptors);
+
+        return descriptor_set;
+    }
+
+    void RHI_DescriptorSetLayout::UpdateDescriptorSet(void* descriptor_set, const vector<RHI_Descriptor>& descriptors)
+    {
+        if (!descriptor_set)
+            return;
+
+        for (const RHI_Descriptor& descriptor : descriptors)
+        {
+            // Ignore null resources (this is legal, as a render pass can choose to not use one or more resources)
+            if (!descriptor.resource)
+                continue;
+
+            // A texture that was never transitioned can't be sampled from
+            if (descriptor.type == RHI_Descriptor_Texture)
+            {
+                null_utility::validation::check(descriptor.layout != RHI_Image_Undefined && descriptor.layout != RHI_Image_Preinitialized, __FUNCTION__, "A texture is bound in an undefined layout");
+            }
+
+            // A constant buffer without a range would be read as empty
+            if (descriptor.type == RHI_Descriptor_ConstantBuffer || descriptor.type == RHI_Descriptor_ConstantBufferDynamic)
+            {
+                null_utility::validation::check(descriptor.range != 0, __FUNCTION__, "A constant buffer is bound with no range");
+            }
+        }
+    }
+
+    void* RHI_DescriptorSetLayout::CreateDescriptorSetLayout(const vector<RHI_Descriptor>& descriptors)
+    {
+        return null_utility::handle::create();
+    }
+}
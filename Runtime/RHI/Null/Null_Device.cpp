@@ -0,0 +1,147 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "../RHI_Implementation.h"
+#include "../RHI_Device.h"
+#include "../RHI_BindlessTable.h"
+#include "../../Core/Context.h"
+#include "../../Logging/Log.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_Device::RHI_Device(Context* context)
+    {
+        m_context                           = context;
+        m_rhi_context                       = make_shared<RHI_Context>();
+        null_utility::globals::rhi_context  = m_rhi_context.get();
+        null_utility::globals::rhi_device   = this;
+
+        // Handles, so that anything which checks for a device or a queue finds one
+        m_rhi_context->device           = null_utility::handle::create();
+        m_rhi_context->queue_graphics   = null_utility::handle::create();
+        m_rhi_context->queue_compute    = null_utility::handle::create();
+        m_rhi_context->queue_transfer   = null_utility::handle::create();
+
+        // There is no GPU, the CPU stands in for it
+        RegisterPhysicalDevice(PhysicalDevice(0, 0, 0, RHI_PhysicalDevice_Cpu, "Null", 0, nullptr));
+
+        // The table's buffers live in host memory, so the bindless and indirect paths run as well
+        m_bindless_table = make_shared<RHI_BindlessTable>(this, 4096);
+        if (!m_bindless_table->IsInitialized())
+        {
+            m_bindless_table = nullptr;
+        }
+
+        LOG_INFO("Null device, commands are validated and counted but nothing is rendered");
+
+        m_initialized = true;
+    }
+
+    RHI_Device::~RHI_Device()
+    {
+        // Nothing is in flight, destroy everything that was waiting for the end of a frame
+        for (pair<uint64_t, function<void()>>& entry : m_destroy_queue)
+        {
+            entry.second();
+        }
+        m_destroy_queue.clear();
+
+        // After the destruction queue, since it returns texture slots to the table
+        m_bindless_table = nullptr;
+
+        LOG_INFO("%llu commands, %llu draws, %llu state changes, %llu submissions, %llu bytes uploaded, %llu validation errors",
+            m_rhi_context->commands.load(),
+            m_rhi_context->draws.load(),
+            m_rhi_context->state_changes.load(),
+            m_rhi_context->submissions.load(),
+            m_rhi_context->bytes_uploaded.load(),
+            m_rhi_context->validation_errors.load()
+        );
+    }
+
+    bool RHI_Device::Queue_Present(void* swapchain_view, uint32_t* image_index, void* wait_semaphore /*= nullptr*/) const
+    {
+        return null_utility::validation::check(swapchain_view && image_index, __FUNCTION__, "Invalid swapchain");
+    }
+
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* signal_fence /*= nullptr*/, const uint32_t wait_flags /*= 0*/, const uint64_t signal_semaphore_value /*= 0*/) const
+    {
+        if (!null_utility::validation::check(cmd_buffer != nullptr, __FUNCTION__, "Invalid command buffer"))
+            return false;
+
+        m_rhi_context->submissions++;
+        return true;
+    }
+
+    bool RHI_Device::Queue_Wait(const RHI_Queue_Type type) const
+    {
+        // Work completes as it's submitted
+        return true;
+    }
+
+    bool RHI_Device::Queue_WaitUploads() const
+    {
+        return true;
+    }
+
+    void RHI_Device::DestroyDeferred(function<void()>&& destroy) const
+    {
+        // Nothing reads the object after the frame which used it ends, but it's still deferred until then, so
+        // that callers see the same order of events as with a GPU (and can defer while holding their own locks)
+        lock_guard<mutex> lock(m_destroy_mutex);
+        m_destroy_queue.emplace_back(m_frame_index, move(destroy));
+    }
+
+    void RHI_Device::Tick()
+    {
+        vector<function<void()>> destroy;
+        {
+            lock_guard<mutex> lock(m_destroy_mutex);
+
+            // The frame completes as it ends
+            m_frame_index++;
+
+            while (!m_destroy_queue.empty())
+            {
+                destroy.emplace_back(move(m_destroy_queue.front().second));
+                m_destroy_queue.pop_front();
+            }
+        }
+
+        // Outside of the lock, destruction can defer more destruction
+        for (function<void()>& destroy_function : destroy)
+        {
+            destroy_function();
+        }
+    }
+
+    bool RHI_Device::GetMemoryStats(const RHI_Memory_Pool pool, RHI_Memory_Stats& stats) const
+    {
+        // There is no GPU memory
+        return false;
+    }
+}
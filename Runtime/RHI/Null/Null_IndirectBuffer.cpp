@@ -0,0 +1,57 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_IndirectBuffer.h"
+#include "../RHI_Device.h"
+//================================
+
+namespace Spartan
+{
+    RHI_IndirectBuffer::RHI_IndirectBuffer(const RHI_Device* rhi_device, const uint32_t command_capacity, const uint32_t region_count)
+    {
+        m_rhi_device        = rhi_device;
+        m_command_capacity  = command_capacity;
+        m_region_count      = region_count;
+
+        // Host memory, so that the renderer writes its commands exactly as it would for a GPU
+        const uint64_t size = static_cast<uint64_t>(sizeof(RHI_DrawIndexedIndirect)) * command_capacity * region_count;
+        m_allocation        = null_utility::memory::allocate(size);
+        m_mapped            = m_allocation;
+        m_buffer            = m_allocation ? null_utility::handle::create() : nullptr;
+    }
+
+    RHI_IndirectBuffer::~RHI_IndirectBuffer()
+    {
+        m_mapped = nullptr;
+        m_buffer = nullptr;
+        null_utility::memory::free(m_allocation);
+    }
+
+    RHI_DrawIndexedIndirect* RHI_IndirectBuffer::GetRegion(const uint32_t region) const
+    {
+        if (!m_mapped || region >= m_region_count)
+            return nullptr;
+
+        return static_cast<RHI_DrawIndexedIndirect*>(m_mapped) + static_cast<size_t>(region) * m_command_capacity;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_Pipeline.h"
+#include "../RHI_Shader.h"
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_Pipeline::RHI_Pipeline(const RHI_Device* rhi_device, RHI_PipelineState& pipeline_state, void* descriptor_set_layout, void* pipeline_cache)
+    {
+		m_rhi_device	= rhi_device;
+		m_state			= pipeline_state;
+
+        // What pipeline creation would have failed on
+        if (!null_utility::validation::check(m_state.shader_vertex && m_state.shader_vertex->IsCompiled(), __FUNCTION__, "The vertex shader is not compiled"))
+            return;
+
+        if (!null_utility::validation::check(!m_state.shader_pixel || m_state.shader_pixel->IsCompiled(), __FUNCTION__, "The pixel shader is not compiled"))
+            return;
+
+        if (!null_utility::validation::check(descriptor_set_layout != nullptr, __FUNCTION__, "Invalid descriptor set layout"))
+            return;
+
+        if (!m_state.CreateFrameResources(rhi_device))
+            return;
+
+        m_pipeline_layout   = null_utility::handle::create();
+        m_pipeline          = null_utility::handle::create();
+	}
+
+	RHI_Pipeline::~RHI_Pipeline() = default;
+}
@@ -0,0 +1,184 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "../RHI_Implementation.h"
+#include "../RHI_Device.h"
+#include "../RHI_Texture2D.h"
+#include "../RHI_TextureCube.h"
+#include "../RHI_CommandList.h"
+#include "../RHI_BindlessTable.h"
+#include "../../Profiling/Profiler.h"
+//===================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    inline RHI_Image_Layout get_target_layout(const RHI_Texture* texture)
+    {
+        RHI_Image_Layout target_layout = RHI_Image_Preinitialized;
+
+        if (texture->IsSampled() && texture->IsColorFormat())
+            target_layout = RHI_Image_Shader_Read_Only_Optimal;
+
+        if (texture->IsRenderTargetColor())
+            target_layout = RHI_Image_Color_Attachment_Optimal;
+
+        if (texture->IsRenderTargetDepthStencil())
+            target_layout = RHI_Image_Depth_Stencil_Attachment_Optimal;
+
+        return target_layout;
+    }
+
+    inline bool create(RHI_Texture* texture, void*& resource, void** resource_view, array<void*, state_max_render_target_count>& resource_view_render_target, array<void*, state_max_render_target_count>& resource_view_depth_stencil)
+    {
+        // What image creation would have failed on
+        const uint32_t max_dimension = null_utility::globals::rhi_context->max_texture_dimension_2d;
+        if (!null_utility::validation::check(texture->GetWidth() != 0 && texture->GetHeight() != 0, __FUNCTION__, "The texture has no size"))
+            return false;
+
+        if (!null_utility::validation::check(texture->GetWidth() <= max_dimension && texture->GetHeight() <= max_dimension, __FUNCTION__, "The texture is larger than the maximum dimension"))
+            return false;
+
+        if (!null_utility::validation::check(texture->GetFormat() != RHI_Format_Undefined, __FUNCTION__, "The texture has no format"))
+            return false;
+
+        if (!null_utility::validation::check(texture->GetArraySize() <= state_max_render_target_count || (!texture->IsRenderTargetColor() && !texture->IsRenderTargetDepthStencil()), __FUNCTION__, "Too many array slices for a render target"))
+            return false;
+
+        resource = null_utility::handle::create();
+
+        // The data a staging copy would have uploaded
+        for (const vector<std::byte>& mip : texture->GetData())
+        {
+            null_utility::globals::rhi_context->bytes_uploaded += mip.size();
+        }
+
+        // Shader resource views
+        if (texture->IsSampled())
+        {
+            resource_view[0] = null_utility::handle::create();
+
+            if (texture->IsStencilFormat())
+            {
+                resource_view[1] = null_utility::handle::create();
+            }
+        }
+
+        // Render target views
+        for (uint32_t i = 0; i < texture->GetArraySize(); i++)
+        {
+            if (texture->IsRenderTargetColor())
+            {
+                resource_view_render_target[i] = null_utility::handle::create();
+            }
+
+            if (texture->IsRenderTargetDepthStencil())
+            {
+                resource_view_depth_stencil[i] = null_utility::handle::create();
+            }
+        }
+
+        return true;
+    }
+
+    RHI_Texture2D::~RHI_Texture2D()
+    {
+        if (!m_rhi_device->IsInitialized())
+            return;
+
+        // Give back the bindless slot
+        if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
+        {
+            bindless_table->RemoveTexture(this);
+        }
+
+        m_data.clear();
+	}
+
+    void RHI_Texture::SetLayout(const RHI_Image_Layout new_layout, RHI_CommandList* command_list /*= nullptr*/)
+    {
+        // The texture is most likely still initialising
+        if (m_layout == RHI_Image_Undefined)
+            return;
+
+        if (m_layout == new_layout)
+            return;
+
+        // If a command list is provided, this is where a pipeline barrier would have been inserted
+        if (command_list)
+        {
+            if (!null_utility::validation::check(command_list->IsRecording(), __FUNCTION__, "A layout transition needs a recording command list"))
+                return;
+
+            m_rhi_device->GetContextRhi()->commands++;
+            m_context->GetSubsystem<Profiler>()->m_rhi_pipeline_barriers++;
+        }
+
+        m_layout = new_layout;
+    }
+
+	bool RHI_Texture2D::CreateResourceGpu()
+	{
+        if (!create(this, m_resource, m_resource_view, m_resource_view_renderTarget, m_resource_view_depthStencil))
+        {
+            LOG_ERROR("Failed to create image");
+            return false;
+        }
+
+        m_layout = get_target_layout(this);
+
+		return true;
+	}
+
+	// TEXTURE CUBE
+
+	RHI_TextureCube::~RHI_TextureCube()
+	{
+        if (!m_rhi_device->IsInitialized())
+            return;
+
+        // Give back the bindless slot
+        if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
+        {
+            bindless_table->RemoveTexture(this);
+        }
+
+        m_data.clear();
+	}
+
+	bool RHI_TextureCube::CreateResourceGpu()
+	{
+        if (!create(this, m_resource, m_resource_view, m_resource_view_renderTarget, m_resource_view_depthStencil))
+        {
+            LOG_ERROR("Failed to create image");
+            return false;
+        }
+
+        m_layout = get_target_layout(this);
+
+		return true;
+	}
+}
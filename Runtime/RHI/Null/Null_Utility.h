@@ -0,0 +1,79 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include "../RHI_Device.h"
+#include "../../Core/EngineDefs.h"
+#include "../../Logging/Log.h"
+//================================
+
+namespace Spartan::null_utility
+{
+    struct globals
+    {
+        static inline RHI_Device* rhi_device;
+        static inline RHI_Context* rhi_context;
+    };
+
+    // Stand-ins for API objects, they are unique and never null but nothing is behind them
+    namespace handle
+    {
+        inline void* create()
+        {
+            static std::atomic<uintptr_t> id = 0;
+            return reinterpret_cast<void*>(++id);
+        }
+    }
+
+    // Host memory, for whatever the CPU expects to be able to write to (mapped buffers)
+    namespace memory
+    {
+        inline void* allocate(const uint64_t size)
+        {
+            return size != 0 ? static_cast<void*>(new std::byte[size]()) : nullptr;
+        }
+
+        inline void free(void*& memory)
+        {
+            delete[] static_cast<std::byte*>(memory);
+            memory = nullptr;
+        }
+    }
+
+    namespace validation
+    {
+        // Misuse which a real API would have rejected (or crashed on), it gets logged and counted
+        inline bool check(const bool condition, const char* function, const char* message)
+        {
+            if (condition)
+                return true;
+
+            globals::rhi_context->validation_errors++;
+            Log::Write(std::string(function) + ": " + message, Log_Error);
+            return false;
+        }
+    }
+}
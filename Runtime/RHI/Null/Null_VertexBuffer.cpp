@@ -0,0 +1,117 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_Device.h"
+#include "../RHI_VertexBuffer.h"
+#include "../../Logging/Log.h"
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    void RHI_VertexBuffer::_destroy()
+    {
+        m_mapped = nullptr;
+        m_buffer = nullptr;
+        null_utility::memory::free(m_allocation);
+    }
+
+	bool RHI_VertexBuffer::_create(const void* vertices)
+	{
+		if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device)
+		{
+			LOG_ERROR_INVALID_INTERNALS();
+			return false;
+		}
+
+        if (!null_utility::validation::check(m_size_gpu != 0, __FUNCTION__, "The buffer has no size"))
+            return false;
+
+        // Destroy previous buffer
+        _destroy();
+
+        // Dynamic buffers get host memory to be written to, static ones only count as an upload
+        bool use_staging = vertices != nullptr;
+        if (!use_staging)
+        {
+            m_allocation  = null_utility::memory::allocate(m_size_gpu);
+            m_is_mappable = true;
+        }
+        else
+        {
+            m_rhi_device->GetContextRhi()->bytes_uploaded += m_size_gpu;
+            m_is_mappable = false;
+        }
+
+        m_buffer = null_utility::handle::create();
+
+		return true;
+	}
+
+	void* RHI_VertexBuffer::Map()
+	{
+        if (!m_is_mappable)
+        {
+            LOG_ERROR("Not mappable, can only be updated via staging");
+            return nullptr;
+        }
+
+        if (!m_allocation)
+        {
+            LOG_ERROR("Invalid allocation");
+            return nullptr;
+        }
+
+        m_mapped = m_allocation;
+
+        return m_mapped;
+	}
+
+	bool RHI_VertexBuffer::Unmap()
+	{
+        if (!m_is_mappable)
+        {
+            LOG_ERROR("Not mappable, can only be updated via staging");
+            return false;
+        }
+
+        if (!m_allocation)
+        {
+            LOG_ERROR("Invalid allocation");
+            return false;
+        }
+
+        // Flushing the whole buffer, or unmapping it, makes the writes visible to the GPU
+        m_rhi_device->GetContextRhi()->bytes_uploaded += m_size_gpu;
+
+        if (!m_persistent_mapping)
+        {
+            m_mapped = nullptr;
+        }
+
+        return true;
+	}
+}
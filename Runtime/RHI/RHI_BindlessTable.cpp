@@ -0,0 +1,256 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "RHI_BindlessTable.h"
+#include "RHI_Device.h"
+#include "RHI_Texture.h"
+#include "../Logging/Log.h"
+#include <cstring>
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    uint32_t RHI_BindlessTable::GetTextureIndex(RHI_Texture* texture)
+    {
+        if (!m_initialized || !texture)
+            return 0;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        auto it = m_textures.find(texture->GetId());
+        if (it != m_textures.end())
+            return it->second;
+
+        // Still uploading (or not meant for sampling), the material does without it until it's ready
+        if (!texture->IsSampled() || texture->GetLayout() != RHI_Image_Shader_Read_Only_Optimal || !texture->Get_Resource_View())
+            return 0;
+
+        uint32_t index = 0;
+        if (!m_texture_indices_free.empty())
+        {
+            index = m_texture_indices_free.back();
+            m_texture_indices_free.pop_back();
+        }
+        else if (m_texture_index_next < m_texture_capacity)
+        {
+            index = m_texture_index_next++;
+        }
+        else
+        {
+            LOG_ERROR("The bindless table has reached its maximum capacity of %d textures", m_texture_capacity);
+            return 0;
+        }
+
+        if (!WriteTexture(index, texture))
+        {
+            m_texture_indices_free.emplace_back(index);
+            return 0;
+        }
+
+        m_textures[texture->GetId()] = index;
+        return index;
+    }
+
+    void RHI_BindlessTable::RemoveTexture(const RHI_Texture* texture)
+    {
+        if (!m_initialized || !texture)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        auto it = m_textures.find(texture->GetId());
+        if (it == m_textures.end())
+            return;
+
+        const uint32_t index = it->second;
+        m_textures.erase(it);
+
+        // Frames in flight might still sample it, so the index can only be re-used once they complete
+        m_rhi_device->DestroyDeferred([this, index]()
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_texture_indices_free.emplace_back(index);
+        });
+    }
+
+    bool RHI_BindlessTable::SetMaterialLayout(const uint32_t stride, const uint32_t capacity, const uint32_t region_count)
+    {
+        if (!m_initialized)
+            return false;
+
+        if (m_material_buffer)
+        {
+            if (stride == m_material_stride && capacity == m_material_capacity && region_count == m_material_region_count)
+                return true;
+
+            LOG_ERROR("The material layout can only be set once");
+            return false;
+        }
+
+        if (region_count == 0 || region_count > 8)
+        {
+            LOG_ERROR("%d regions are more than the dirty masks can track", region_count);
+            return false;
+        }
+
+        m_material_stride       = stride;
+        m_material_capacity     = capacity;
+        m_material_region_count = region_count;
+        m_materials.assign(static_cast<size_t>(stride) * capacity, std::byte(0));
+        m_material_dirty_regions.assign(capacity, 0);
+
+        if (!CreateMaterialBuffer())
+        {
+            LOG_ERROR("Failed to create the material buffer");
+            m_materials.clear();
+            m_material_dirty_regions.clear();
+            m_material_stride       = 0;
+            m_material_capacity     = 0;
+            m_material_region_count = 0;
+            return false;
+        }
+
+        return true;
+    }
+
+    uint32_t RHI_BindlessTable::GetMaterialIndex(const uint64_t id)
+    {
+        if (!m_material_mapped)
+            return 0;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        auto it = m_material_indices.find(id);
+        if (it != m_material_indices.end())
+            return it->second;
+
+        uint32_t index = 0;
+        if (!m_material_indices_free.empty())
+        {
+            index = m_material_indices_free.back();
+            m_material_indices_free.pop_back();
+        }
+        else if (m_material_index_next < m_material_capacity)
+        {
+            index = m_material_index_next++;
+        }
+        else
+        {
+            LOG_ERROR("The bindless table has reached its maximum capacity of %d materials", m_material_capacity);
+            return 0;
+        }
+
+        m_material_indices[id] = index;
+        return index;
+    }
+
+    void RHI_BindlessTable::RemoveMaterial(const uint64_t id)
+    {
+        if (!m_material_mapped)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        auto it = m_material_indices.find(id);
+        if (it == m_material_indices.end())
+            return;
+
+        const uint32_t index = it->second;
+        m_material_indices.erase(it);
+
+        // Frames in flight might still read it, so the index can only be re-used once they complete
+        m_rhi_device->DestroyDeferred([this, index]()
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_material_indices_free.emplace_back(index);
+        });
+    }
+
+    bool RHI_BindlessTable::UpdateMaterial(const uint32_t region, const uint32_t index, const void* data)
+    {
+        if (!m_material_mapped || index >= m_material_capacity || region >= m_material_region_count)
+            return false;
+
+        // A change has to reach every region, but only the region of the frame being recorded can be written, the others may be read by the GPU
+        const size_t offset = static_cast<size_t>(index) * m_material_stride;
+        if (memcmp(m_materials.data() + offset, data, m_material_stride) != 0)
+        {
+            memcpy(m_materials.data() + offset, data, m_material_stride);
+            m_material_dirty_regions[index] = static_cast<uint8_t>((1u << m_material_region_count) - 1);
+        }
+
+        const uint8_t region_bit = static_cast<uint8_t>(1u << region);
+        if (m_material_dirty_regions[index] & region_bit)
+        {
+            const size_t offset_region = static_cast<size_t>(GetMaterialRegionOffset(region)) * m_material_stride + offset;
+            memcpy(static_cast<std::byte*>(m_material_mapped) + offset_region, m_materials.data() + offset, m_material_stride);
+            m_material_dirty_regions[index] &= ~region_bit;
+        }
+
+        return true;
+    }
+
+    bool RHI_BindlessTable::SetInstanceLayout(const uint32_t stride, const uint32_t capacity, const uint32_t region_count)
+    {
+        if (!m_initialized)
+            return false;
+
+        if (m_instance_buffer)
+        {
+            if (stride == m_instance_stride && capacity == m_instance_capacity && region_count == m_instance_region_count)
+                return true;
+
+            LOG_ERROR("The instance layout can only be set once");
+            return false;
+        }
+
+        m_instance_stride       = stride;
+        m_instance_capacity     = capacity;
+        m_instance_region_count = region_count;
+
+        if (!CreateInstanceBuffer())
+        {
+            LOG_ERROR("Failed to create the instance buffer");
+            m_instance_stride       = 0;
+            m_instance_capacity     = 0;
+            m_instance_region_count = 0;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool RHI_BindlessTable::WriteInstances(const uint32_t region, const uint32_t first, const uint32_t count, const void* data)
+    {
+        if (!m_instance_mapped || region >= m_instance_region_count || first + count > m_instance_capacity)
+            return false;
+
+        const size_t offset = (static_cast<size_t>(region) * m_instance_capacity + first) * m_instance_stride;
+        memcpy(static_cast<std::byte*>(m_instance_mapped) + offset, data, static_cast<size_t>(count) * m_instance_stride);
+
+        return true;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+//=================================
+
+namespace Spartan
+{
+    // One large descriptor set which shaders index into, instead of having textures bound per draw.
+    // It holds every texture which was asked for (index 0 means no texture), a structured buffer of materials
+    // and a structured buffer of instances, which indirect draws index through their first instance.
+    class SPARTAN_CLASS RHI_BindlessTable : public Spartan_Object
+    {
+    public:
+        RHI_BindlessTable(RHI_Device* rhi_device, const uint32_t texture_capacity);
+        ~RHI_BindlessTable();
+
+        // Textures, added on first use (if ready for sampling) and removed when destroyed
+        uint32_t GetTextureIndex(RHI_Texture* texture);
+        void RemoveTexture(const RHI_Texture* texture);
+
+        // Materials, the layout of an element is up to the shaders, it can be set only once. Like instances, there is one region
+        // per frame in flight. Indices are assigned on first use (index 0 is never handed out) and released when the material is destroyed.
+        bool SetMaterialLayout(const uint32_t stride, const uint32_t capacity, const uint32_t region_count);
+        uint32_t GetMaterialIndex(const uint64_t id);
+        void RemoveMaterial(const uint64_t id);
+        bool UpdateMaterial(const uint32_t region, const uint32_t index, const void* data);
+        uint32_t GetMaterialRegionOffset(const uint32_t region) const { return region * m_material_capacity; } // the first element of a region
+
+        // Instances, one region per frame in flight so that a frame can be written while the others are read
+        bool SetInstanceLayout(const uint32_t stride, const uint32_t capacity, const uint32_t region_count);
+        bool WriteInstances(const uint32_t region, const uint32_t first, const uint32_t count, const void* data);
+        uint32_t GetInstanceCapacity()  const { return m_instance_capacity; }
+
+        void* GetDescriptorSet()        const { return m_descriptor_set; }
+        void* GetDescriptorSetLayout()  const { return m_descriptor_set_layout; }
+        uint32_t GetTextureCount()      const { return static_cast<uint32_t>(m_textures.size()); }
+        uint32_t GetTextureCapacity()   const { return m_texture_capacity; }
+        bool IsInitialized()            const { return m_initialized; }
+
+    private:
+        // API specific
+        bool WriteTexture(const uint32_t index, RHI_Texture* texture);
+        bool CreateMaterialBuffer();
+        bool CreateInstanceBuffer();
+
+        // <texture id, index>
+        std::unordered_map<uint64_t, uint32_t> m_textures;
+        std::vector<uint32_t> m_texture_indices_free;
+        uint32_t m_texture_index_next   = 1;
+        uint32_t m_texture_capacity     = 0;
+        std::mutex m_mutex;
+
+        // Materials, with a copy so that unchanged materials are never written to the mapped memory, and
+        // a bit per region for every material which changed since the region was last written
+        std::unordered_map<uint64_t, uint32_t> m_material_indices;
+        std::vector<uint32_t> m_material_indices_free;
+        std::vector<std::byte> m_materials;
+        std::vector<uint8_t> m_material_dirty_regions;
+        uint32_t m_material_index_next      = 1;
+        uint32_t m_material_stride          = 0;
+        uint32_t m_material_capacity        = 0;
+        uint32_t m_material_region_count    = 0;
+        void* m_material_buffer         = nullptr;
+        void* m_material_allocation     = nullptr;
+        void* m_material_mapped         = nullptr;
+
+        // Instances
+        uint32_t m_instance_stride          = 0;
+        uint32_t m_instance_capacity        = 0;
+        uint32_t m_instance_region_count    = 0;
+        void* m_instance_buffer             = nullptr;
+        void* m_instance_allocation         = nullptr;
+        void* m_instance_mapped             = nullptr;
+
+        void* m_descriptor_pool         = nullptr;
+        void* m_descriptor_set_layout   = nullptr;
+        void* m_descriptor_set          = nullptr;
+        bool m_initialized              = false;
+        RHI_Device* m_rhi_device        = nullptr;
+    };
+}
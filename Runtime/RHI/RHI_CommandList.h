@@ -100,6 +100,7 @@ namespace Spartan
 		// Draw/Dispatch
         bool Draw(uint32_t vertex_count);
 		bool DrawIndexed(uint32_t index_count, uint32_t index_offset = 0, uint32_t vertex_offset = 0);
+        bool DrawIndexedIndirect(RHI_IndirectBuffer* buffer, uint32_t command_offset, uint32_t command_count);
         void Dispatch(uint32_t x, uint32_t y, uint32_t z = 1) const;
 
 		// Viewport
@@ -40,6 +40,7 @@ namespace Spartan
             m_stride        = static_cast<uint32_t>(sizeof(T));
             m_offset_count  = offset_count;
             m_size_gpu      = static_cast<uint64_t>(m_stride * m_offset_count);
+            m_generation++;
 
             return _create();
 		}
@@ -48,6 +49,7 @@ namespace Spartan
 		bool Unmap(const uint64_t offset = 0, const uint64_t size = 0);
 
 		void* GetResource()         const { return m_buffer; }
+        uint32_t GetGeneration()    const { return m_generation; } // increments every time the buffer is (re)created
         uint32_t GetStride()        const { return m_stride; }
         uint32_t GetOffsetCount()   const { return m_offset_count; }
 
@@ -73,6 +75,7 @@ namespace Spartan
         uint32_t m_offset_count         = 1;
         uint32_t m_offset_index         = 0;
         uint32_t m_offset_dynamic_index = 0;
+        uint32_t m_generation           = 0;
 
 		// API
 		void* m_buffer      = nullptr;
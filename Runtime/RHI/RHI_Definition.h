@@ -34,6 +34,8 @@ namespace Spartan
 	class RHI_CommandList;
 	class RHI_PipelineState;
 	class RHI_PipelineCache;
+	class RHI_StagingRing;
+	class RHI_BindlessTable;
 	class RHI_Pipeline;
     class RHI_DescriptorSetLayout;
     class RHI_DescriptorCache;
@@ -44,6 +46,7 @@ namespace Spartan
 	class RHI_InputLayout;
 	class RHI_VertexBuffer;
 	class RHI_IndexBuffer;
+	class RHI_IndirectBuffer;
 	class RHI_ConstantBuffer;
 	class RHI_Sampler;
 	class RHI_Viewport;
@@ -51,11 +54,13 @@ namespace Spartan
 	class RHI_Texture2D;
 	class RHI_TextureCube;
 	class RHI_Shader;
+	class RHI_ShaderCache;
 	struct RHI_Vertex_Undefined;
 	struct RHI_Vertex_PosTex;
 	struct RHI_Vertex_PosCol;
 	struct RHI_Vertex_PosUvCol;
 	struct RHI_Vertex_PosTexNorTan;
+	struct RHI_Vertex_PosTexNorTan16;
 
     enum RHI_PhysicalDevice_Type
     {
@@ -70,7 +75,8 @@ namespace Spartan
     {
         RHI_Api_D3d11,
         RHI_Api_D3d12,
-        RHI_Api_Vulkan
+        RHI_Api_Vulkan,
+        RHI_Api_Null
     };
 
 	enum RHI_Present_Mode : uint32_t
@@ -194,6 +200,15 @@ namespace Spartan
         // DEPTH
         RHI_Format_D32_Float,
         RHI_Format_D32_Float_S8X24_Uint,
+        // BLOCK COMPRESSED (4x4 pixels per block)
+        RHI_Format_BC1_Unorm,   // RGB, 1 bit alpha
+        RHI_Format_BC3_Unorm,   // RGBA
+        RHI_Format_BC4_Unorm,   // R
+        RHI_Format_BC5_Unorm,   // RG
+        RHI_Format_BC7_Unorm,   // RGBA, high quality
+        // VERTEX ATTRIBUTES (quantized)
+        RHI_Format_R16G16_Snorm,
+        RHI_Format_R16G16B16A16_Snorm,
 
         RHI_Format_Undefined
 	};
@@ -275,6 +290,7 @@ namespace Spartan
         RHI_Descriptor_Type type    = RHI_Descriptor_Undefined;
         RHI_Image_Layout layout     = RHI_Image_Undefined;
         void* resource              = nullptr;
+        uint64_t resource_id        = 0; // object id and generation, API handles can be reused once their object is destroyed
     };
 
     inline const char* rhi_format_to_string(const RHI_Format result)
@@ -295,12 +311,73 @@ namespace Spartan
             case RHI_Format_R32G32B32A32_Float:	    return "RHI_Format_R32G32B32A32_Float";
             case RHI_Format_D32_Float:	            return "RHI_Format_D32_Float";
             case RHI_Format_D32_Float_S8X24_Uint:	return "RHI_Format_D32_Float_S8X24_Uint";
+            case RHI_Format_BC1_Unorm:	            return "RHI_Format_BC1_Unorm";
+            case RHI_Format_BC3_Unorm:	            return "RHI_Format_BC3_Unorm";
+            case RHI_Format_BC4_Unorm:	            return "RHI_Format_BC4_Unorm";
+            case RHI_Format_BC5_Unorm:	            return "RHI_Format_BC5_Unorm";
+            case RHI_Format_BC7_Unorm:	            return "RHI_Format_BC7_Unorm";
             case RHI_Format_Undefined:              return "RHI_Format_Undefined";
         }
 
         return "Unknown format";
     }
 
+    // How a texture is used, which decides the block compressed format it's stored in
+    enum RHI_Texture_Compression : uint8_t
+    {
+        RHI_Texture_Compression_None,
+        RHI_Texture_Compression_Color,      // BC1 when opaque, BC7 when transparent
+        RHI_Texture_Compression_Normal,     // BC5, x and y only (z is reconstructed in the shader), grayscale images get BC4
+        RHI_Texture_Compression_Grayscale   // BC4, red only (height, roughness, metallic, occlusion)
+    };
+
+    inline bool rhi_format_is_block_compressed(const RHI_Format format)
+    {
+        return format >= RHI_Format_BC1_Unorm && format <= RHI_Format_BC7_Unorm;
+    }
+
+    // Bytes per 4x4 block
+    inline uint32_t rhi_format_block_size(const RHI_Format format)
+    {
+        return (format == RHI_Format_BC1_Unorm || format == RHI_Format_BC4_Unorm) ? 8 : 16;
+    }
+
+    // GPU memory is sub-allocated from a pool per usage class, so that each class can be tracked and budgeted
+    enum RHI_Memory_Pool
+    {
+        RHI_Memory_Pool_Default,        // anything which doesn't fit a class below, served by the allocator's own pools
+        RHI_Memory_Pool_RenderTarget,   // render targets and depth-stencil buffers, live as long as the resolution does
+        RHI_Memory_Pool_Texture,        // sampled textures, the ones that streaming loads and evicts
+        RHI_Memory_Pool_Geometry,       // device local vertex and index buffers
+        RHI_Memory_Pool_Upload,         // host visible buffers which are rewritten every frame (constant, dynamic, indirect, instance)
+        RHI_Memory_Pool_Staging,        // one-off staging copies, a linear ring since they are released in the order they were made
+        RHI_Memory_Pool_Count
+    };
+
+    struct RHI_Memory_Stats
+    {
+        uint64_t bytes_used         = 0; // held by live allocations
+        uint64_t bytes_reserved     = 0; // held by the pool's memory blocks, used or not
+        uint64_t budget             = 0; // 0 means no budget
+        uint32_t allocation_count   = 0;
+        uint32_t block_count        = 0;
+    };
+
+    inline const char* rhi_memory_pool_to_string(const RHI_Memory_Pool pool)
+    {
+        switch (pool)
+        {
+            case RHI_Memory_Pool_Default:       return "Default";
+            case RHI_Memory_Pool_RenderTarget:  return "Render targets";
+            case RHI_Memory_Pool_Texture:       return "Textures";
+            case RHI_Memory_Pool_Geometry:      return "Geometry";
+            case RHI_Memory_Pool_Upload:        return "Upload";
+            case RHI_Memory_Pool_Staging:       return "Staging";
+        }
+
+        return "Unknown pool";
+    }
+
     // Engine constants 
     static const Math::Vector4  state_color_dont_care           = Math::Vector4(-std::numeric_limits<float>::infinity(), 0.0f, 0.0f, 0.0f);
     static const Math::Vector4  state_color_load                = Math::Vector4(std::numeric_limits<float>::infinity(), 0.0f, 0.0f, 0.0f);
@@ -29,6 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Implementation.h"
 #include "RHI_DescriptorSetLayout.h"
 #include "..\Utilities\Hash.h"
+#include "..\Profiling\Profiler.h"
+#include <chrono>
 //==================================
 
 //= NAMESPACES =====
@@ -39,10 +41,15 @@ namespace Spartan
 {
     RHI_DescriptorCache::RHI_DescriptorCache(const RHI_Device* rhi_device)
     {
-        m_rhi_device = rhi_device;
-
-        // Set the descriptor set capacity to an initial value
-        SetDescriptorSetCapacity(m_descriptor_set_capacity);
+        m_rhi_device    = rhi_device;
+        m_profiler      = rhi_device->GetContext()->GetSubsystem<Profiler>();
+
+        // Persistent pool
+        m_pool_persistent               = make_shared<DescriptorPool>();
+        m_pool_persistent->resource     = CreateDescriptorPool(RHI_Context::descriptor_pool_persistent_set_capacity);
+        m_pool_persistent->set_capacity = m_pool_persistent->resource ? RHI_Context::descriptor_pool_persistent_set_capacity : 0;
+        m_pool_persistent->in_use       = true;
+        m_pools_persistent.emplace_back(m_pool_persistent);
     }
 
     void RHI_DescriptorCache::SetPipelineState(RHI_PipelineState& pipeline_state)
@@ -145,34 +152,194 @@ namespace Spartan
         return m_descriptor_layout_current->GetResource_DescriptorSet(this, descriptor_set);
     }
 
-    bool RHI_DescriptorCache::HasEnoughCapacity() const
+    void* RHI_DescriptorCache::GetDescriptorSet(RHI_DescriptorSetLayout* descriptor_set_layout, const size_t hash, const bool persistent_candidate)
     {
-        return m_descriptor_set_capacity > GetDescriptorSetCount();
+        // Taking the clock twice per lookup adds up, so only do it on frames the profiler looks at
+        const bool timed        = m_profiler && m_profiler->IsProfilingCpu();
+        const auto time_start   = timed ? chrono::high_resolution_clock::now() : chrono::high_resolution_clock::time_point();
+
+        BeginFrame();
+
+        void* descriptor_set = nullptr;
+        bool hit             = true;
+
+        auto it_persistent  = m_descriptor_sets_persistent.find(hash);
+        auto it_frame       = m_descriptor_sets_frame.end();
+        if (it_persistent != m_descriptor_sets_persistent.end())
+        {
+            descriptor_set                  = it_persistent->second.first;
+            it_persistent->second.second    = m_frame;
+        }
+        else if ((it_frame = m_descriptor_sets_frame.find(hash)) != m_descriptor_sets_frame.end())
+        {
+            descriptor_set = it_frame->second;
+        }
+        else
+        {
+            hit = false;
+
+            // Sets which keep coming back frame after frame get promoted to the persistent pool
+            bool persistent = false;
+            if (persistent_candidate)
+            {
+                // Sets that see no reuse across frames would otherwise accumulate here forever
+                if (m_descriptor_set_usage.size() >= RHI_Context::descriptor_pool_persistent_set_capacity * 16)
+                {
+                    m_descriptor_set_usage.clear();
+                }
+
+                pair<uint64_t, uint32_t>& usage = m_descriptor_set_usage[hash];
+                usage.second    = (usage.first + 1 == m_frame) ? usage.second + 1 : 1;
+                usage.first     = m_frame;
+                persistent      = usage.second >= RHI_Context::descriptor_set_persistent_frames;
+
+                // A full pool makes room by dropping its sets if some of them went stale
+                if (persistent && m_pool_persistent->set_count >= m_pool_persistent->set_capacity)
+                {
+                    persistent = TrimPersistentPool();
+                }
+            }
+
+            DescriptorPool* pool = persistent ? m_pool_persistent.get() : GetFramePool();
+            if (pool)
+            {
+                descriptor_set = descriptor_set_layout->CreateDescriptorSet(pool->resource);
+            }
+
+            if (descriptor_set)
+            {
+                pool->set_count++;
+
+                if (persistent)
+                {
+                    m_descriptor_sets_persistent[hash] = make_pair(descriptor_set, m_frame);
+                    m_descriptor_set_usage.erase(hash);
+                }
+                else
+                {
+                    m_descriptor_sets_frame[hash] = descriptor_set;
+                }
+            }
+        }
+
+        if (m_profiler)
+        {
+            m_profiler->m_rhi_descriptor_set_lookups++;
+            m_profiler->m_rhi_descriptor_set_hits += hit ? 1 : 0;
+
+            if (timed)
+            {
+                m_profiler->m_rhi_descriptor_set_lookups_timed++;
+                m_profiler->m_rhi_descriptor_set_lookup_time += chrono::duration<float, micro>(chrono::high_resolution_clock::now() - time_start).count();
+            }
+        }
+
+        return descriptor_set;
+    }
+
+    void RHI_DescriptorCache::BeginFrame()
+    {
+        const uint64_t frame = m_rhi_device->GetFrameIndex();
+        if (m_frame == frame)
+            return;
+
+        m_frame = frame;
+
+        // The pools of the previous frame are reset wholesale once the GPU has retired it, no waiting and no growing
+        for (const shared_ptr<DescriptorPool>& pool : m_pools_frame_active)
+        {
+            const RHI_Device* rhi_device = m_rhi_device;
+            m_rhi_device->DestroyDeferred([rhi_device, pool]()
+            {
+                ResetDescriptorPool(rhi_device, pool.get());
+                pool->set_count = 0;
+                pool->in_use    = false;
+            });
+        }
+        m_pools_frame_active.clear();
+        m_descriptor_sets_frame.clear();
     }
 
-    void RHI_DescriptorCache::GrowIfNeeded()
+    RHI_DescriptorCache::DescriptorPool* RHI_DescriptorCache::GetFramePool()
     {
-        // If there is room for at least one more descriptor set (hence +1), we don't need to re-allocate yet
-        const uint32_t required_capacity = GetDescriptorSetCount() + 1;
+        // Keep allocating linearly from the current pool until it's full
+        if (!m_pools_frame_active.empty() && m_pools_frame_active.back()->set_count < m_pools_frame_active.back()->set_capacity)
+            return m_pools_frame_active.back().get();
 
-        // If we are over-budget, re-allocate the descriptor pool with double size
-        if (required_capacity > m_descriptor_set_capacity)
+        // Then chain a pool the GPU is done with
+        for (const shared_ptr<DescriptorPool>& pool : m_pools_frame)
         {
-            m_descriptor_set_capacity *= 2;
-            SetDescriptorSetCapacity(m_descriptor_set_capacity);
-            LOG_INFO("Capacity has been increased to %d elements", m_descriptor_set_capacity);
+            if (!pool->in_use)
+            {
+                pool->in_use = true;
+                m_pools_frame_active.emplace_back(pool);
+                return pool.get();
+            }
         }
+
+        // Or create a new one
+        shared_ptr<DescriptorPool> pool = make_shared<DescriptorPool>();
+        pool->resource = CreateDescriptorPool(RHI_Context::descriptor_pool_frame_set_capacity);
+        if (!pool->resource)
+            return nullptr;
+
+        pool->set_capacity  = RHI_Context::descriptor_pool_frame_set_capacity;
+        pool->in_use        = true;
+        m_pools_frame.emplace_back(pool);
+        m_pools_frame_active.emplace_back(pool);
+
+        return pool.get();
     }
 
-    uint32_t RHI_DescriptorCache::GetDescriptorSetCount() const
+    bool RHI_DescriptorCache::TrimPersistentPool()
     {
-        uint32_t descriptor_set_count = 0;
-        for (const auto& it : m_descriptor_set_layouts)
+        // Sets can't be freed one by one, so the pool is only worth replacing if some of its sets haven't been used for a while
+        // (their resources were re-created or destroyed, which changes the hash, or the passes using them stopped running)
+        bool stale = false;
+        for (const auto& it : m_descriptor_sets_persistent)
+        {
+            if (m_frame - it.second.second > RHI_Context::descriptor_set_persistent_stale_frames)
+            {
+                stale = true;
+                break;
+            }
+        }
+
+        if (!stale)
+            return false;
+
+        // Frames in flight might still bind sets from the current pool, so it's reset once they have retired
+        const RHI_Device* rhi_device        = m_rhi_device;
+        shared_ptr<DescriptorPool> pool     = m_pool_persistent;
+        m_rhi_device->DestroyDeferred([rhi_device, pool]()
+        {
+            ResetDescriptorPool(rhi_device, pool.get());
+            pool->set_count = 0;
+            pool->in_use    = false;
+        });
+        m_descriptor_sets_persistent.clear();
+        m_pool_persistent = nullptr;
+
+        // Continue with a pool the GPU is done with, or a new one, the sets which are still hot get promoted again
+        for (const shared_ptr<DescriptorPool>& pool_retired : m_pools_persistent)
+        {
+            if (!pool_retired->in_use)
+            {
+                m_pool_persistent = pool_retired;
+                break;
+            }
+        }
+
+        if (!m_pool_persistent)
         {
-            descriptor_set_count += it.second->GetDescriptorSetCount();
+            m_pool_persistent               = make_shared<DescriptorPool>();
+            m_pool_persistent->resource     = CreateDescriptorPool(RHI_Context::descriptor_pool_persistent_set_capacity);
+            m_pool_persistent->set_capacity = m_pool_persistent->resource ? RHI_Context::descriptor_pool_persistent_set_capacity : 0;
+            m_pools_persistent.emplace_back(m_pool_persistent);
         }
+        m_pool_persistent->in_use = true;
 
-        return descriptor_set_count;
+        return m_pool_persistent->set_count < m_pool_persistent->set_capacity;
     }
 
     vector<RHI_Descriptor> RHI_DescriptorCache::GenerateDescriptors(RHI_PipelineState& pipeline_state)
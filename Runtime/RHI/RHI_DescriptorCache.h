@@ -27,10 +27,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <atomic>
 //=================================
 
 namespace Spartan
 {
+    // Forward declarations
+    class Profiler;
+
     class SPARTAN_CLASS RHI_DescriptorCache : public Spartan_Object
     {
     public:
@@ -46,29 +50,49 @@ namespace Spartan
         void SetTexture(const uint32_t slot, RHI_Texture* texture);
 
         // Properties
-        void* GetResource_DescriptorSetPool() const { return m_descriptor_pool; }
         void* GetResource_DescriptorSetLayout() const;
         bool GetResource_DescriptorSet(void*& descriptor_set);
 
-        // Capacity
-        bool HasEnoughCapacity() const;
-        void GrowIfNeeded();
+        // Returns a descriptor set which matches the hash, allocating and writing one (from the layout) on a miss
+        void* GetDescriptorSet(RHI_DescriptorSetLayout* descriptor_set_layout, const std::size_t hash, const bool persistent_candidate);
 
-    private:
-        uint32_t GetDescriptorSetCount() const;
-        void SetDescriptorSetCapacity(uint32_t descriptor_capacity);
-        bool CreateDescriptorPool(uint32_t descriptor_set_capacity);
+        // Merges the descriptors of the state's shaders, doesn't touch the cache so it can be called from any thread
         std::vector<RHI_Descriptor> GenerateDescriptors(RHI_PipelineState& pipeline_state);
 
+    private:
+        struct DescriptorPool
+        {
+            void* resource              = nullptr;
+            uint32_t set_count          = 0;
+            uint32_t set_capacity       = 0;
+            std::atomic<bool> in_use    = false; // from the first allocation of a frame until the GPU retires that frame
+        };
+
+        void BeginFrame();
+        DescriptorPool* GetFramePool();
+        bool TrimPersistentPool();
+        void* CreateDescriptorPool(uint32_t descriptor_set_capacity);
+        void DestroyDescriptorPool(DescriptorPool* pool);
+        static void ResetDescriptorPool(const RHI_Device* rhi_device, DescriptorPool* pool);
+
         // Descriptor set layouts 
         std::unordered_map<std::size_t, std::shared_ptr<RHI_DescriptorSetLayout>> m_descriptor_set_layouts;
         RHI_DescriptorSetLayout* m_descriptor_layout_current = nullptr;
 
-        // Descriptor pool
-        uint32_t m_descriptor_set_capacity = 16;
-        void* m_descriptor_pool = nullptr;
+        // Per-frame descriptor sets, allocated linearly and thrown away with their pools once the frame retires
+        std::vector<std::shared_ptr<DescriptorPool>> m_pools_frame;
+        std::vector<std::shared_ptr<DescriptorPool>> m_pools_frame_active; // pools the current frame allocates from
+        std::unordered_map<std::size_t, void*> m_descriptor_sets_frame;
+        uint64_t m_frame = 0;
+
+        // Persistent descriptor sets, the ones that keep coming back frame after frame (global constant buffers and samplers)
+        std::shared_ptr<DescriptorPool> m_pool_persistent;
+        std::vector<std::shared_ptr<DescriptorPool>> m_pools_persistent; // the current one plus retired ones waiting for (or done with) their reset
+        std::unordered_map<std::size_t, std::pair<void*, uint64_t>> m_descriptor_sets_persistent; // <hash, <set, last frame>>
+        std::unordered_map<std::size_t, std::pair<uint64_t, uint32_t>> m_descriptor_set_usage; // <hash, <last frame, frames used>>
 
         // Dependencies
         const RHI_Device* m_rhi_device;
+        Profiler* m_profiler = nullptr;
     };
 }
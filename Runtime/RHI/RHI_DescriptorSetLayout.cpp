@@ -40,18 +40,32 @@ namespace Spartan
         m_rhi_device            = rhi_device;
         m_descriptors           = descriptors;
         m_descriptor_set_layout = CreateDescriptorSetLayout(m_descriptors);
+
+        // Seed the hash with the layout, the cache holds sets of every layout
+        Utility::Hash::hash_combine(m_descriptor_set_hash, GetId());
+        m_descriptor_hashes.resize(m_descriptors.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
+        {
+            m_descriptor_hashes[i]  = ComputeDescriptorHash(m_descriptors[i]);
+            m_descriptor_set_hash   ^= m_descriptor_hashes[i];
+        }
     }
 
     bool RHI_DescriptorSetLayout::SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer)
     {
-        for (RHI_Descriptor& descriptor : m_descriptors)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
         {
+            RHI_Descriptor& descriptor = m_descriptors[i];
+
             if ((descriptor.type == RHI_Descriptor_ConstantBuffer || descriptor.type == RHI_Descriptor_ConstantBufferDynamic) && descriptor.slot == slot + m_rhi_device->GetContextRhi()->shader_shift_buffer)
             {
-                // Determine if the descriptor set needs to bind
-                m_needs_to_bind = descriptor.resource   != constant_buffer->GetResource()   ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
-                m_needs_to_bind = descriptor.offset     != constant_buffer->GetOffset()     ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
-                m_needs_to_bind = descriptor.range      != constant_buffer->GetStride()     ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
+                // Determine if the descriptor set needs to update
+                const uint64_t resource_id = (static_cast<uint64_t>(constant_buffer->GetId()) << 32) | constant_buffer->GetGeneration();
+                const bool changed =
+                    descriptor.resource     != constant_buffer->GetResource()   ||
+                    descriptor.resource_id  != resource_id                      ||
+                    descriptor.offset       != constant_buffer->GetOffset()     ||
+                    descriptor.range        != constant_buffer->GetStride();
 
                 // Keep track of dynamic offsets
                 if (constant_buffer->IsDynamic())
@@ -66,9 +80,16 @@ namespace Spartan
                 }
 
                 // Update
-                descriptor.resource = constant_buffer->GetResource();
-                descriptor.offset   = constant_buffer->GetOffset();
-                descriptor.range    = constant_buffer->GetStride();
+                if (changed)
+                {
+                    descriptor.resource     = constant_buffer->GetResource();
+                    descriptor.resource_id  = resource_id;
+                    descriptor.offset       = constant_buffer->GetOffset();
+                    descriptor.range        = constant_buffer->GetStride();
+
+                    UpdateDescriptorHash(i);
+                    m_needs_to_bind = true; // affects vkUpdateDescriptorSets
+                }
 
                 return true;
             }
@@ -79,15 +100,21 @@ namespace Spartan
 
     void RHI_DescriptorSetLayout::SetSampler(const uint32_t slot, RHI_Sampler* sampler)
     {
-        for (RHI_Descriptor& descriptor : m_descriptors)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
         {
+            RHI_Descriptor& descriptor = m_descriptors[i];
+
             if (descriptor.type == RHI_Descriptor_Sampler && descriptor.slot == slot + m_rhi_device->GetContextRhi()->shader_shift_sampler)
             {
-                // Determine if the descriptor set needs to bind
-                m_needs_to_bind = descriptor.resource != sampler->GetResource() ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
-
                 // Update
-                descriptor.resource = sampler->GetResource();
+                if (descriptor.resource != sampler->GetResource() || descriptor.resource_id != sampler->GetId())
+                {
+                    descriptor.resource     = sampler->GetResource();
+                    descriptor.resource_id  = sampler->GetId();
+
+                    UpdateDescriptorHash(i);
+                    m_needs_to_bind = true; // affects vkUpdateDescriptorSets
+                }
 
                 break;
             }
@@ -108,16 +135,22 @@ namespace Spartan
             return;
         }
 
-        for (RHI_Descriptor& descriptor : m_descriptors)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_descriptors.size()); i++)
         {
+            RHI_Descriptor& descriptor = m_descriptors[i];
+
             if (descriptor.type == RHI_Descriptor_Texture && descriptor.slot == slot + m_rhi_device->GetContextRhi()->shader_shift_texture)
             {
-                // Determine if the descriptor set needs to bind
-                m_needs_to_bind = descriptor.resource != texture->Get_Resource_View() ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
-
                 // Update
-                descriptor.resource = texture->Get_Resource_View();
-                descriptor.layout   = texture->GetLayout();
+                if (descriptor.resource != texture->Get_Resource_View() || descriptor.resource_id != texture->GetId() || descriptor.layout != texture->GetLayout())
+                {
+                    descriptor.resource     = texture->Get_Resource_View();
+                    descriptor.resource_id  = texture->GetId();
+                    descriptor.layout       = texture->GetLayout();
+
+                    UpdateDescriptorHash(i);
+                    m_needs_to_bind = true; // affects vkUpdateDescriptorSets
+                }
 
                 break;
             }
@@ -126,32 +159,27 @@ namespace Spartan
 
     bool RHI_DescriptorSetLayout::GetResource_DescriptorSet(RHI_DescriptorCache* descriptor_cache, void*& descriptor_set)
     {
-        // Get the hash of the current state of the descriptors
-        const size_t hash = ComputeDescriptorSetHash(m_descriptors);
+        // Nothing changed since the last bind
+        if (!m_needs_to_bind)
+            return true;
 
-        // If we don't have a descriptor set to match that state, create one
-        auto it = m_descriptor_sets.find(hash);
-        if (it == m_descriptor_sets.end())
-        {
-            // Only allocate if the descriptor set cache hash enough capacity
-            if (descriptor_cache->HasEnoughCapacity())
-            {
-                descriptor_set = CreateDescriptorSet(hash, descriptor_cache);
-            }
-            else
-            {
-                return false;
-            }
-        }
-        else // retrieve the existing one
+        // Sets without textures (constant buffers and samplers) are the ones that get reused frame after frame
+        bool persistent_candidate = true;
+        for (const RHI_Descriptor& descriptor : m_descriptors)
         {
-            if (m_needs_to_bind)
+            if (descriptor.type == RHI_Descriptor_Texture && descriptor.resource)
             {
-                descriptor_set  = it->second;
-                m_needs_to_bind = false;
+                persistent_candidate = false;
+                break;
             }
         }
 
+        // The hash is kept up to date by the setters, so this is just a lookup
+        descriptor_set = descriptor_cache->GetDescriptorSet(this, m_descriptor_set_hash, persistent_candidate);
+        if (!descriptor_set)
+            return false;
+
+        m_needs_to_bind = false;
         return true;
     }
 
@@ -187,21 +215,27 @@ namespace Spartan
         return dynamic_offset_count;
     }
 
-    size_t RHI_DescriptorSetLayout::ComputeDescriptorSetHash(const vector<RHI_Descriptor>& descriptors)
+    size_t RHI_DescriptorSetLayout::ComputeDescriptorHash(const RHI_Descriptor& descriptor) const
     {
         size_t hash = 0;
 
-        for (const RHI_Descriptor& descriptor : descriptors)
-        {
-            Utility::Hash::hash_combine(hash, descriptor.slot);
-            Utility::Hash::hash_combine(hash, descriptor.stage);
-            Utility::Hash::hash_combine(hash, descriptor.offset);
-            Utility::Hash::hash_combine(hash, descriptor.range);
-            Utility::Hash::hash_combine(hash, descriptor.resource);
-            Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.type));
-            Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.layout));
-        }
+        Utility::Hash::hash_combine(hash, descriptor.slot);
+        Utility::Hash::hash_combine(hash, descriptor.stage);
+        Utility::Hash::hash_combine(hash, descriptor.offset);
+        Utility::Hash::hash_combine(hash, descriptor.range);
+        Utility::Hash::hash_combine(hash, descriptor.resource);
+        Utility::Hash::hash_combine(hash, descriptor.resource_id);
+        Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.type));
+        Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.layout));
 
         return hash;
     }
+
+    void RHI_DescriptorSetLayout::UpdateDescriptorHash(const uint32_t index)
+    {
+        // Fold the old descriptor hash out and the new one in, the rest of the descriptors don't need to be visited
+        m_descriptor_set_hash       ^= m_descriptor_hashes[index];
+        m_descriptor_hashes[index]  = ComputeDescriptorHash(m_descriptors[index]);
+        m_descriptor_set_hash       ^= m_descriptor_hashes[index];
+    }
 }
@@ -43,15 +43,15 @@ namespace Spartan
         void SetTexture(const uint32_t slot, RHI_Texture* texture);
 
         bool GetResource_DescriptorSet(RHI_DescriptorCache* descriptor_cache, void*& descriptor_set);
+        void* CreateDescriptorSet(void* descriptor_pool); // allocates from the pool and writes the current descriptors
         const std::array<uint32_t, state_max_constant_buffer_count> GetDynamicOffsets() const;
         uint32_t GetDynamicOffsetCount() const;
         void* GetResource_DescriptorSetLayout() const { return m_descriptor_set_layout; }      
-        uint32_t GetDescriptorSetCount()        const { return static_cast<uint32_t>(m_descriptor_sets.size()); }
         void NeedsToBind()                            { m_needs_to_bind = true; }
 
     private:
-        std::size_t ComputeDescriptorSetHash(const std::vector<RHI_Descriptor>& descriptors);
-        void* CreateDescriptorSet(const std::size_t hash, const RHI_DescriptorCache* descriptor_cache);
+        std::size_t ComputeDescriptorHash(const RHI_Descriptor& descriptor) const;
+        void UpdateDescriptorHash(const uint32_t index);
         void UpdateDescriptorSet(void* descriptor_set, const std::vector<RHI_Descriptor>& descriptors);
         void* CreateDescriptorSetLayout(const std::vector<RHI_Descriptor>& descriptors);
 
@@ -72,8 +72,9 @@ namespace Spartan
         // Descriptors
         std::vector<RHI_Descriptor> m_descriptors;
 
-        // Descriptor sets
-        std::unordered_map<std::size_t, void*> m_descriptor_sets;
+        // Incremental hash, the hash of each descriptor is folded in and out as its slot changes
+        std::vector<std::size_t> m_descriptor_hashes;
+        std::size_t m_descriptor_set_hash = 0;
 
         // Descriptor set layout
         void* m_descriptor_set_layout = nullptr;
@@ -114,6 +114,16 @@ namespace Spartan
                 height > 0 && height <= m_rhi_context->max_texture_dimension_2d;
 	}
 
+    void RHI_Device::SetMemoryBudget(const RHI_Memory_Pool pool, const uint64_t bytes)
+    {
+        m_memory_budgets[pool] = bytes;
+
+        if (bytes != 0)
+        {
+            LOG_INFO("\"%s\" memory budget set to %llu MB", rhi_memory_pool_to_string(pool), bytes / 1024 / 1024);
+        }
+    }
+
 	bool RHI_Device::Queue_WaitAll() const
     {
         return Queue_Wait(RHI_Queue_Graphics) && Queue_Wait(RHI_Queue_Transfer) && Queue_Wait(RHI_Queue_Compute);
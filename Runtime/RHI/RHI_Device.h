@@ -25,6 +25,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/Spartan_Object.h"
 #include <mutex>
 #include <memory>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include "RHI_DisplayMode.h"
 #include "RHI_PhysicalDevice.h"
 //=================================
@@ -52,17 +56,30 @@ namespace Spartan
 
         // Queue
         bool Queue_Present(void* swapchain_view, uint32_t* image_index, void* wait_semaphore = nullptr) const;
-        bool Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore = nullptr, void* signal_semaphore = nullptr, void* signal_fence = nullptr, const uint32_t wait_flags = 0) const;
+        bool Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore = nullptr, void* signal_semaphore = nullptr, void* signal_fence = nullptr, const uint32_t wait_flags = 0, const uint64_t signal_semaphore_value = 0) const;
         bool Queue_Wait(const RHI_Queue_Type type) const;
         bool Queue_WaitAll() const;
+        bool Queue_WaitUploads() const; // waits for the asynchronous uploads in flight and makes their resources usable
         void* Queue_Get(const RHI_Queue_Type type) const;
         uint32_t Queue_Index(const RHI_Queue_Type type) const;
 
+        // Deferred destruction, runs once the GPU has completed every frame which could have used the object
+        void DestroyDeferred(std::function<void()>&& destroy) const;
+        void Tick(); // once per frame, marks the end of a frame and destroys what the GPU is done with
+        uint64_t GetFrameIndex() const { return m_frame_index; }
+
+        // Memory, budgets are soft, crossing one logs a warning and is visible in the stats
+        bool GetMemoryStats(const RHI_Memory_Pool pool, RHI_Memory_Stats& stats) const;
+        void SetMemoryBudget(const RHI_Memory_Pool pool, const uint64_t bytes);
+        uint64_t GetMemoryBudget(const RHI_Memory_Pool pool) const { return m_memory_budgets[pool]; }
+
         // Misc
-		auto IsInitialized()                const { return m_initialized; }
-        RHI_Context* GetContextRhi()	    const { return m_rhi_context.get(); }
-        Context* GetContext()               const { return m_context; }
-        uint32_t GetEnabledGraphicsStages() const { return m_enabled_graphics_shader_stages; }
+		auto IsInitialized()                    const { return m_initialized; }
+        RHI_Context* GetContextRhi()	        const { return m_rhi_context.get(); }
+        Context* GetContext()                   const { return m_context; }
+        uint32_t GetEnabledGraphicsStages()     const { return m_enabled_graphics_shader_stages; }
+        RHI_StagingRing* GetStagingRing()       const { return m_staging_ring.get(); }
+        RHI_BindlessTable* GetBindlessTable()   const { return m_bindless_table.get(); }
 
 	private:	
 		std::vector<PhysicalDevice> m_physical_devices;
@@ -73,5 +90,18 @@ namespace Spartan
         bool m_initialized                          = false;
         mutable std::mutex m_queue_mutex;
         std::shared_ptr<RHI_Context> m_rhi_context;
+        std::shared_ptr<RHI_StagingRing> m_staging_ring;        // null when uploads are immediate
+        std::shared_ptr<RHI_BindlessTable> m_bindless_table;    // null when descriptor indexing is not supported
+
+        // Deferred destruction
+        void* m_queue_graphics_semaphore        = nullptr; // timeline, every graphics submission signals the next value
+        mutable uint64_t m_queue_graphics_value = 0;
+        uint64_t m_frame_index                  = 1;
+        std::deque<std::pair<uint64_t, uint64_t>> m_frame_ends; // <frame, value of its last graphics submission>
+        mutable std::deque<std::pair<uint64_t, std::function<void()>>> m_destroy_queue; // <frame, destroy>
+        mutable std::mutex m_destroy_mutex;
+
+        // Memory
+        std::array<std::atomic<uint64_t>, RHI_Memory_Pool_Count> m_memory_budgets = {}; // bytes, 0 means no budget
 	};
 }
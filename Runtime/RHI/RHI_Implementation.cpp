@@ -38,11 +38,105 @@ namespace Spartan
         allocator_info.instance                 = instance;
         allocator_info.vulkanApiVersion         = api_version;
         
-        return vulkan_utility::error::check(vmaCreateAllocator(&allocator_info, &allocator));
+        if (!vulkan_utility::error::check(vmaCreateAllocator(&allocator_info, &allocator)))
+            return false;
+
+        // Pools, the memory type of each one is found from a resource which is representative of its usage class
+        const auto create_pool = [this](const RHI_Memory_Pool pool, const uint32_t memory_type_index, const VmaPoolCreateFlags flags, const uint64_t block_size, const size_t block_count_max)
+        {
+            VmaPoolCreateInfo pool_info = {};
+            pool_info.memoryTypeIndex   = memory_type_index;
+            pool_info.flags             = flags;
+            pool_info.blockSize         = block_size;       // 0 lets the allocator pick, based on the heap size
+            pool_info.maxBlockCount     = block_count_max;  // 0 means unlimited
+
+            pool_block_sizes[pool] = block_size;
+
+            if (vmaCreatePool(allocator, &pool_info, &pools[pool]) != VK_SUCCESS)
+            {
+                pools[pool] = nullptr;
+                LOG_WARNING("Failed to create the \"%s\" memory pool, its allocations will go to the default pools", rhi_memory_pool_to_string(pool));
+            }
+        };
+
+        const auto find_memory_type_image = [this](const VkImageUsageFlags usage, uint32_t& memory_type_index)
+        {
+            VkImageCreateInfo image_info    = {};
+            image_info.sType                = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            image_info.imageType            = VK_IMAGE_TYPE_2D;
+            image_info.extent               = { 1024, 1024, 1 };
+            image_info.mipLevels            = 1;
+            image_info.arrayLayers          = 1;
+            image_info.format               = VK_FORMAT_R8G8B8A8_UNORM;
+            image_info.tiling               = VK_IMAGE_TILING_OPTIMAL;
+            image_info.initialLayout        = VK_IMAGE_LAYOUT_UNDEFINED;
+            image_info.usage                = usage;
+            image_info.samples              = VK_SAMPLE_COUNT_1_BIT;
+            image_info.sharingMode          = VK_SHARING_MODE_EXCLUSIVE;
+
+            VmaAllocationCreateInfo allocation_info = {};
+            allocation_info.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+            return vmaFindMemoryTypeIndexForImageInfo(allocator, &image_info, &allocation_info, &memory_type_index) == VK_SUCCESS;
+        };
+
+        const auto find_memory_type_buffer = [this](const VkBufferUsageFlags usage, const VmaMemoryUsage memory_usage, uint32_t& memory_type_index)
+        {
+            VkBufferCreateInfo buffer_info  = {};
+            buffer_info.sType               = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size                = 1024;
+            buffer_info.usage               = usage;
+            buffer_info.sharingMode         = VK_SHARING_MODE_EXCLUSIVE;
+
+            VmaAllocationCreateInfo allocation_info = {};
+            allocation_info.usage                   = memory_usage;
+
+            return vmaFindMemoryTypeIndexForBufferInfo(allocator, &buffer_info, &allocation_info, &memory_type_index) == VK_SUCCESS;
+        };
+
+        uint32_t memory_type_index = 0;
+
+        if (find_memory_type_image(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, memory_type_index))
+        {
+            create_pool(RHI_Memory_Pool_RenderTarget, memory_type_index, 0, 0, 0);
+        }
+
+        if (find_memory_type_image(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, memory_type_index))
+        {
+            create_pool(RHI_Memory_Pool_Texture, memory_type_index, 0, 0, 0);
+        }
+
+        if (find_memory_type_buffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY, memory_type_index))
+        {
+            create_pool(RHI_Memory_Pool_Geometry, memory_type_index, 0, 0, 0);
+        }
+
+        const VkBufferUsageFlags usage_upload = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        if (find_memory_type_buffer(usage_upload, VMA_MEMORY_USAGE_CPU_TO_GPU, memory_type_index))
+        {
+            create_pool(RHI_Memory_Pool_Upload, memory_type_index, 0, memory_pool_upload_block_size, 0);
+        }
+
+        // Staging copies are released in the order they were made, so a linear pool with a single block behaves as a ring buffer
+        if (find_memory_type_buffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, memory_type_index))
+        {
+            create_pool(RHI_Memory_Pool_Staging, memory_type_index, VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT, memory_pool_staging_block_size, 1);
+        }
+
+        return true;
     }
 
     void RHI_Context::destroy_allocator()
     {
+        for (VmaPool& pool : pools)
+        {
+            if (pool != nullptr)
+            {
+                vmaDestroyPool(allocator, pool);
+                pool = nullptr;
+            }
+        }
+
         if (allocator != nullptr)
         {
             vmaDestroyAllocator(allocator);
@@ -80,6 +80,15 @@ static const DXGI_FORMAT d3d11_format[] =
     // Depth
     DXGI_FORMAT_D32_FLOAT,
     DXGI_FORMAT_D32_FLOAT_S8X24_UINT,
+    // Block compressed
+    DXGI_FORMAT_BC1_UNORM,
+    DXGI_FORMAT_BC3_UNORM,
+    DXGI_FORMAT_BC4_UNORM,
+    DXGI_FORMAT_BC5_UNORM,
+    DXGI_FORMAT_BC7_UNORM,
+    // Vertex attributes (quantized)
+    DXGI_FORMAT_R16G16_SNORM,
+    DXGI_FORMAT_R16G16B16A16_SNORM,
 
     DXGI_FORMAT_UNKNOWN
 };
@@ -210,6 +219,15 @@ static const VkFormat vulkan_format[] =
     // DEPTH
     VK_FORMAT_D32_SFLOAT,
     VK_FORMAT_D32_SFLOAT_S8_UINT,
+    // BLOCK COMPRESSED
+    VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    VK_FORMAT_BC3_UNORM_BLOCK,
+    VK_FORMAT_BC4_UNORM_BLOCK,
+    VK_FORMAT_BC5_UNORM_BLOCK,
+    VK_FORMAT_BC7_UNORM_BLOCK,
+    // VERTEX ATTRIBUTES (QUANTIZED)
+    VK_FORMAT_R16G16_SNORM,
+    VK_FORMAT_R16G16B16A16_SNORM,
 
     VK_FORMAT_MAX_ENUM
 };
@@ -317,7 +335,11 @@ static const VkImageLayout vulkan_image_layout[] =
 #if defined (API_GRAPHICS_VULKAN)
     #include "Vulkan/vk_mem_alloc.h"
     #include <vector>
+    #include <array>
+    #include <atomic>
     #include <unordered_map>
+#elif defined (API_GRAPHICS_NULL)
+    #include <atomic>
 #endif
 
 // RHI_Context
@@ -345,10 +367,19 @@ namespace Spartan
             VkDevice device                                 = nullptr;
             VkPhysicalDeviceProperties device_properties    = {};
             VkPhysicalDeviceFeatures device_features        = {};
+            bool timeline_semaphores                        = false;
+            bool descriptor_indexing                        = false;
+            bool multi_draw_indirect                        = false;
+            bool draw_indirect_first_instance               = false;
+            bool shader_draw_parameters                     = false;
             VkFormat surface_format                         = VK_FORMAT_UNDEFINED;
             VkColorSpaceKHR surface_color_space             = VK_COLOR_SPACE_MAX_ENUM_KHR;
             VmaAllocator allocator                          = nullptr;
             std::unordered_map<uint64_t, VmaAllocation> allocations;
+            std::array<VmaPool, RHI_Memory_Pool_Count> pools = {};                         // null when a pool couldn't be created, its allocations go to the default pools
+            std::array<uint64_t, RHI_Memory_Pool_Count> pool_block_sizes = {};             // 0 when the allocator picks the block size
+            std::array<std::atomic<uint64_t>, RHI_Memory_Pool_Count> pool_bytes_used = {};  // per usage class, whichever pool actually served the allocation
+            std::array<std::atomic<uint32_t>, RHI_Memory_Pool_Count> pool_allocations = {};
 
             // Extensions
             #ifdef DEBUG
@@ -381,6 +412,19 @@ namespace Spartan
                 void destroy_allocator();
         #endif
 
+        #if defined(API_GRAPHICS_NULL)
+            RHI_Api_Type api_type   = RHI_Api_Null;
+            void* device            = nullptr; // a handle, so that code which checks for a device finds one
+
+            // What a GPU would have been asked to do since the device was created, readers take deltas
+            std::atomic<uint64_t> commands          = 0; // everything recorded into a command list
+            std::atomic<uint64_t> draws             = 0;
+            std::atomic<uint64_t> state_changes     = 0; // pipelines, vertex/index buffers and descriptor sets that were bound
+            std::atomic<uint64_t> submissions       = 0;
+            std::atomic<uint64_t> bytes_uploaded    = 0; // buffer and texture data that would have crossed the bus
+            std::atomic<uint64_t> validation_errors = 0;
+        #endif
+
         // Debugging
         #ifdef DEBUG
             bool debug    = true;
@@ -404,9 +448,21 @@ namespace Spartan
         static const uint32_t descriptor_max_samplers                   = 10;
         static const uint32_t descriptor_max_textures                   = 10;
 
+        // Descriptor pools
+        static const uint32_t descriptor_pool_frame_set_capacity        = 256;  // sets per linear pool, a frame chains more pools if it needs them
+        static const uint32_t descriptor_pool_persistent_set_capacity   = 256;
+        static const uint32_t descriptor_set_persistent_frames          = 3;    // consecutive frames a set has to be used in before it becomes persistent
+        static const uint32_t descriptor_set_persistent_stale_frames    = 120;  // frames a persistent set can go unused before a full pool gets replaced
+
+        // Memory pools
+        static const uint64_t memory_pool_upload_block_size             = 32 * 1024 * 1024;
+        static const uint64_t memory_pool_staging_block_size            = 64 * 1024 * 1024; // a single block used as a ring, copies that don't fit spill to the default pools
+
         // Device limits
         uint32_t max_texture_dimension_2d   = 16384;
+        uint32_t max_constant_buffer_size   = 65536; // D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16
         uint32_t max_msaa_level             = 0;
+        bool texture_compression_bc         = true; // BC1-BC7, always there with D3D
 
         // Queues
         void* queue_graphics            = nullptr;
@@ -425,6 +481,8 @@ namespace Spartan
     #include "D3D12/D3D12_Utility.h"
 #elif defined (API_GRAPHICS_VULKAN)
     #include "Vulkan/Vulkan_Utility.h"
+#elif defined (API_GRAPHICS_NULL)
+    #include "Null/Null_Utility.h"
 #endif
 
 #endif // RUNTIME
@@ -0,0 +1,66 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+//=================================
+
+namespace Spartan
+{
+    // Arguments of an indexed draw which the GPU reads, matches VkDrawIndexedIndirectCommand
+    struct RHI_DrawIndexedIndirect
+    {
+        uint32_t index_count;
+        uint32_t instance_count;
+        uint32_t index_offset;
+        int32_t vertex_offset;
+        uint32_t instance_offset;
+    };
+    static_assert(sizeof(RHI_DrawIndexedIndirect) == 20, "RHI_DrawIndexedIndirect must match the layout the GPU expects");
+
+    // Persistently mapped draw arguments, split in regions so that the CPU can write one frame while the GPU reads the others
+    class SPARTAN_CLASS RHI_IndirectBuffer : public Spartan_Object
+    {
+    public:
+        RHI_IndirectBuffer(const RHI_Device* rhi_device, const uint32_t command_capacity, const uint32_t region_count);
+        ~RHI_IndirectBuffer();
+
+        RHI_DrawIndexedIndirect* GetRegion(const uint32_t region) const;
+
+        uint32_t GetCommandCapacity()   const { return m_command_capacity; }
+        uint32_t GetRegionCount()       const { return m_region_count; }
+        void* GetResource()             const { return m_buffer; }
+        bool IsInitialized()            const { return m_mapped != nullptr; }
+
+    private:
+        uint32_t m_command_capacity = 0;
+        uint32_t m_region_count     = 0;
+        void* m_buffer              = nullptr;
+        void* m_allocation          = nullptr;
+        void* m_mapped              = nullptr;
+
+        // Dependencies
+        const RHI_Device* m_rhi_device = nullptr;
+    };
+}
@@ -19,13 +19,30 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ===================
+//= INCLUDES ========================
 #include "RHI_PipelineCache.h"
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include "RHI_Device.h"
+#include "RHI_Shader.h"
 #include "RHI_Texture.h"
 #include "RHI_Pipeline.h"
 #include "RHI_SwapChain.h"
+#include "RHI_BlendState.h"
 #include "RHI_DescriptorCache.h"
-//==============================
+#include "RHI_RasterizerState.h"
+#include "RHI_DepthStencilState.h"
+#include "RHI_DescriptorSetLayout.h"
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../Core/FileSystem.h"
+#include "../Threading/Threading.h"
+#include "../Utilities/Hash.h"
+//===================================
 
 //= NAMESPACES =====
 using namespace std;
@@ -33,6 +50,248 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace
+    {
+        // Bump the version whenever the layout of a file (or of RHI_PipelineStateDesc) changes, older files will be discarded
+        const uint32_t cache_magic      = 0x43505053; // "SPPC"
+        const uint32_t cache_version    = 2;
+        const char* file_name_api       = "/pipelines.bin";
+        const char* file_name_states    = "/pipeline_states.bin";
+
+        // Descriptions are hashed and saved as bytes, so there can't be any padding
+        static_assert(sizeof(RHI_PipelineStateDesc) == 248, "RHI_PipelineStateDesc has padding or has changed, bump the cache version");
+
+        struct CacheHeader
+        {
+            uint32_t magic          = cache_magic;
+            uint32_t version        = cache_version;
+            uint32_t signature_size = 0;
+            uint32_t data_size      = 0;
+            uint64_t checksum       = 0;
+        };
+
+        bool write_file(const string& path, const vector<uint8_t>& signature, const void* data, const uint32_t data_size)
+        {
+            CacheHeader header;
+            header.signature_size   = static_cast<uint32_t>(signature.size());
+            header.data_size        = data_size;
+            header.checksum         = Utility::Hash::fnv1a_64(data, data_size);
+
+            // Write to a temporary file and then rename, so a crash never leaves a truncated file behind
+            const string path_temp = path + ".tmp";
+            {
+                ofstream out(path_temp, ios::out | ios::binary | ios::trunc);
+                if (!out.is_open())
+                    return false;
+
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                out.write(reinterpret_cast<const char*>(signature.data()), signature.size());
+                out.write(static_cast<const char*>(data), data_size);
+
+                if (!out.good())
+                    return false;
+            }
+
+            error_code error;
+            filesystem::rename(path_temp, path, error);
+            return !error;
+        }
+
+        bool read_file(const string& path, const vector<uint8_t>& signature, vector<uint8_t>* data)
+        {
+            ifstream in(path, ios::in | ios::binary);
+            if (!in.is_open())
+                return false;
+
+            CacheHeader header;
+            in.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!in.good() || header.magic != cache_magic || header.version != cache_version || header.signature_size != signature.size())
+                return false;
+
+            vector<uint8_t> signature_file(header.signature_size);
+            in.read(reinterpret_cast<char*>(signature_file.data()), signature_file.size());
+            if (!in.good() || signature_file != signature)
+                return false;
+
+            data->resize(header.data_size);
+            in.read(reinterpret_cast<char*>(data->data()), data->size());
+            return in.good() && Utility::Hash::fnv1a_64(data->data(), data->size()) == header.checksum;
+        }
+
+        inline uint64_t hash_string(const string& value, const uint64_t hash = Utility::Hash::fnv1a_64_offset)
+        {
+            return Utility::Hash::fnv1a_64(value.data(), value.size(), hash);
+        }
+
+        template<typename T>
+        inline uint64_t hash_value(const T& value, const uint64_t hash = Utility::Hash::fnv1a_64_offset)
+        {
+            return Utility::Hash::fnv1a_64(&value, sizeof(T), hash);
+        }
+
+        // Hashes which are the same across runs, ids are not
+
+        uint64_t get_stable_hash(const RHI_Shader* shader)
+        {
+            if (!shader || shader->GetFilePath().empty())
+                return 0;
+
+            // Defines are in an unordered map
+            vector<pair<string, string>> defines(shader->GetDefines().begin(), shader->GetDefines().end());
+            sort(defines.begin(), defines.end());
+
+            uint64_t hash = hash_string(shader->GetFilePath());
+            hash = hash_value(static_cast<uint32_t>(shader->GetShaderStage()), hash);
+            for (const auto& define : defines)
+            {
+                hash = hash_string(define.first, hash);
+                hash = hash_string(define.second, hash);
+            }
+
+            return hash;
+        }
+
+        uint64_t get_stable_hash(const RHI_RasterizerState* state)
+        {
+            if (!state)
+                return 0;
+
+            uint64_t hash = hash_value(static_cast<uint32_t>(state->GetCullMode()));
+            hash = hash_value(static_cast<uint32_t>(state->GetFillMode()),  hash);
+            hash = hash_value(state->GetDepthClipEnabled(),                 hash);
+            hash = hash_value(state->GetScissorEnabled(),                   hash);
+            hash = hash_value(state->GetMultiSampleEnabled(),               hash);
+            hash = hash_value(state->GetAntialisedLineEnabled(),            hash);
+            hash = hash_value(state->GetLineWidth(),                        hash);
+            return hash;
+        }
+
+        uint64_t get_stable_hash(const RHI_BlendState* state)
+        {
+            if (!state)
+                return 0;
+
+            uint64_t hash = hash_value(state->GetBlendEnabled());
+            hash = hash_value(static_cast<uint32_t>(state->GetSourceBlend()),       hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetDestBlend()),         hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetBlendOp()),           hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetSourceBlendAlpha()),  hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetDestBlendAlpha()),    hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetBlendOpAlpha()),      hash);
+            hash = hash_value(state->GetBlendFactor(),                              hash);
+            return hash;
+        }
+
+        uint64_t get_stable_hash(const RHI_DepthStencilState* state)
+        {
+            if (!state)
+                return 0;
+
+            uint64_t hash = hash_value(state->GetDepthTestEnabled());
+            hash = hash_value(state->GetDepthWriteEnabled(),                                    hash);
+            hash = hash_value(state->GetStencilTestEnabled(),                                   hash);
+            hash = hash_value(state->GetStencilWriteEnabled(),                                  hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetDepthFunction()),                 hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetStencilFunction()),               hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetStencilFailOperation()),          hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetStencilDepthFailOperation()),     hash);
+            hash = hash_value(static_cast<uint32_t>(state->GetStencilPassOperation()),          hash);
+            return hash;
+        }
+
+        uint64_t get_stable_hash(const RHI_Texture* texture)
+        {
+            // Render targets are named, anything else can't be told apart across runs
+            if (!texture || texture->GetName().empty())
+                return 0;
+
+            // Dimensions are included, so that states recorded at another resolution are not prewarmed
+            uint64_t hash = hash_string(texture->GetName());
+            hash = hash_value(static_cast<uint32_t>(texture->GetFormat()),  hash);
+            hash = hash_value(texture->GetWidth(),                          hash);
+            hash = hash_value(texture->GetHeight(),                         hash);
+            hash = hash_value(texture->GetArraySize(),                      hash);
+            return hash;
+        }
+
+        template<typename T>
+        unordered_map<uint64_t, T*> get_lookup(const vector<T*>& objects)
+        {
+            unordered_map<uint64_t, T*> lookup;
+            for (T* object : objects)
+            {
+                if (const uint64_t hash = get_stable_hash(object))
+                {
+                    lookup[hash] = object;
+                }
+            }
+
+            return lookup;
+        }
+
+        unordered_map<uint64_t, RHI_Texture*> get_lookup(const vector<shared_ptr<RHI_Texture>>& textures)
+        {
+            unordered_map<uint64_t, RHI_Texture*> lookup;
+            for (const shared_ptr<RHI_Texture>& texture : textures)
+            {
+                if (const uint64_t hash = get_stable_hash(texture.get()))
+                {
+                    lookup[hash] = texture.get();
+                }
+            }
+
+            return lookup;
+        }
+
+        template<typename T>
+        bool resolve(const unordered_map<uint64_t, T*>& lookup, const uint64_t hash, T*& object)
+        {
+            if (hash == 0)
+            {
+                object = nullptr;
+                return true;
+            }
+
+            const auto it = lookup.find(hash);
+            object = it != lookup.end() ? it->second : nullptr;
+            return object != nullptr;
+        }
+
+        uint32_t get_load_op(const Math::Vector4& color)    { return color == state_color_dont_care ? 0 : color == state_color_load ? 1 : 2; }
+        uint32_t get_load_op(const float depth)             { return depth == state_depth_dont_care ? 0 : depth == state_depth_load ? 1 : 2; }
+        uint32_t get_load_op(const uint32_t stencil)        { return stencil == state_stencil_dont_care ? 0 : stencil == state_stencil_load ? 1 : 2; }
+
+        // Any value with the same load op creates the same render pass, the actual clear values are set when the pass begins
+        Math::Vector4 get_clear_color(const uint32_t load_op)   { return load_op == 0 ? state_color_dont_care : load_op == 1 ? state_color_load : Math::Vector4::Zero; }
+        float get_clear_depth(const uint32_t load_op)           { return load_op == 0 ? state_depth_dont_care : load_op == 1 ? state_depth_load : 0.0f; }
+        uint32_t get_clear_stencil(const uint32_t load_op)      { return load_op == 0 ? state_stencil_dont_care : load_op == 1 ? state_stencil_load : 0; }
+    }
+
+    RHI_PipelineCache::RHI_PipelineCache(const RHI_Device* rhi_device, const string& directory)
+    {
+        m_rhi_device    = rhi_device;
+        m_directory     = directory;
+
+        if (!FileSystem::Exists(m_directory))
+        {
+            FileSystem::CreateDirectory_(m_directory);
+        }
+
+        Load();
+    }
+
+    RHI_PipelineCache::~RHI_PipelineCache()
+    {
+        // The prewarm task uses this object
+        while (m_prewarming)
+        {
+            this_thread::sleep_for(chrono::milliseconds(16));
+        }
+
+        Save();
+        DestroyResource();
+    }
+
     RHI_Pipeline* RHI_PipelineCache::GetPipeline(RHI_CommandList* cmd_list, RHI_PipelineState& pipeline_state, void* descriptor_set_layout)
     {
         // Validate it
@@ -75,18 +334,240 @@ namespace Spartan
             }
         }
 
-        // Compute a hash for it
+        // Only re-hashes if the state actually changed since the last time
         pipeline_state.ComputeHash();
-        size_t hash = pipeline_state.GetHash();
+        const uint64_t hash = pipeline_state.GetHash();
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+
+            auto it = m_cache.find(hash);
+            if (it != m_cache.end())
+                return it->second.get();
+        }
+
+        // If no pipeline exists for this state, create one (out of the lock, the prewarm might be creating others)
+        shared_ptr<RHI_Pipeline> pipeline = make_shared<RHI_Pipeline>(m_rhi_device, pipeline_state, descriptor_set_layout, m_resource);
+        Record(pipeline_state);
+
+        return Emplace(hash, pipeline);
+    }
+
+    void RHI_PipelineCache::Prewarm(const RHI_PipelineStateObjects& objects, RHI_DescriptorCache* descriptor_cache)
+    {
+        if (m_states_previous.empty() || m_prewarming)
+            return;
+
+        m_prewarming = true;
+
+        m_rhi_device->GetContext()->GetSubsystem<Threading>()->AddTask([this, objects, descriptor_cache]()
+        {
+            const Stopwatch timer;
+
+            const auto shaders                  = get_lookup(objects.shaders);
+            const auto rasterizer_states        = get_lookup(objects.rasterizer_states);
+            const auto blend_states             = get_lookup(objects.blend_states);
+            const auto depth_stencil_states     = get_lookup(objects.depth_stencil_states);
+            const auto textures                 = get_lookup(objects.textures);
+
+            uint32_t count = 0;
+            for (const RHI_PipelineStateDesc& desc : m_states_previous)
+            {
+                RHI_PipelineState state;
+
+                // Resolve the objects, the state is skipped if any of them no longer exists (e.g. a different resolution)
+                bool resolved = true;
+                resolved = resolved && resolve(shaders,                 desc.shader_vertex,         state.shader_vertex);
+                resolved = resolved && resolve(shaders,                 desc.shader_pixel,          state.shader_pixel);
+                resolved = resolved && resolve(rasterizer_states,       desc.rasterizer_state,      state.rasterizer_state);
+                resolved = resolved && resolve(blend_states,            desc.blend_state,           state.blend_state);
+                resolved = resolved && resolve(depth_stencil_states,    desc.depth_stencil_state,   state.depth_stencil_state);
+                resolved = resolved && resolve(textures,                desc.render_target_depth,   state.render_target_depth_texture);
+                for (uint32_t i = 0; i < state_max_render_target_count; i++)
+                {
+                    resolved = resolved && resolve(textures, desc.render_target_color[i], state.render_target_color_textures[i]);
+                    state.clear_color[i] = get_clear_color(desc.load_op_color[i]);
+                }
+
+                if (!resolved || !state.shader_vertex || (desc.swapchain && !objects.swapchain))
+                    continue;
+
+                // Shaders which didn't compile can't make a pipeline (and the shader won't wait)
+                if (!state.shader_vertex->IsCompiled() || (state.shader_pixel && !state.shader_pixel->IsCompiled()))
+                    continue;
+
+                state.render_target_swapchain                           = desc.swapchain ? objects.swapchain : nullptr;
+                state.clear_depth                                       = get_clear_depth(desc.load_op_depth);
+                state.clear_stencil                                     = get_clear_stencil(desc.load_op_stencil);
+                state.primitive_topology                                = static_cast<RHI_PrimitiveTopology_Mode>(desc.primitive_topology);
+                state.vertex_buffer_stride                              = desc.vertex_buffer_stride;
+                state.dynamic_scissor                                   = desc.dynamic_scissor != 0;
+                state.bindless                                          = desc.bindless != 0;
+                state.render_target_color_texture_array_index           = desc.color_array_index;
+                state.render_target_depth_stencil_texture_array_index   = desc.depth_array_index;
+                state.render_target_color_layout_initial                = static_cast<RHI_Image_Layout>(desc.color_layout_initial);
+                state.render_target_color_layout_final                  = static_cast<RHI_Image_Layout>(desc.color_layout_final);
+                state.render_target_depth_layout_initial                = static_cast<RHI_Image_Layout>(desc.depth_layout_initial);
+                state.render_target_depth_layout_final                  = static_cast<RHI_Image_Layout>(desc.depth_layout_final);
+                state.dynamic_constant_buffer_slot                      = desc.dynamic_constant_buffer_slot;
+                state.dynamic_constant_buffer_slot_2                    = desc.dynamic_constant_buffer_slot_2;
+                state.viewport                                          = RHI_Viewport(desc.viewport[0], desc.viewport[1], desc.viewport[2], desc.viewport[3], desc.viewport[4], desc.viewport[5]);
+                state.scissor                                           = Math::Rectangle(desc.scissor[0], desc.scissor[1], desc.scissor[2], desc.scissor[3]);
+                state.pass_name                                         = "prewarm";
+
+                state.ComputeHash();
+                const uint64_t hash = state.GetHash();
+                {
+                    lock_guard<mutex> lock(m_mutex);
+                    if (m_cache.find(hash) != m_cache.end())
+                        continue;
+                }
+
+                // A layout of our own, the descriptor cache is in use by the renderer. It only has to be compatible
+                // with the one the renderer will bind, and it is, since it comes from the same shaders.
+                RHI_DescriptorSetLayout descriptor_set_layout(m_rhi_device, descriptor_cache->GenerateDescriptors(state));
+                shared_ptr<RHI_Pipeline> pipeline = make_shared<RHI_Pipeline>(m_rhi_device, state, descriptor_set_layout.GetResource_DescriptorSetLayout(), m_resource);
+                if (!pipeline->GetPipeline())
+                    continue;
+
+                Record(state);
+                Emplace(hash, pipeline);
+                count++;
+            }
+
+            LOG_INFO("Prewarmed %d of %d pipelines in %.2f ms", count, static_cast<uint32_t>(m_states_previous.size()), timer.GetElapsedTimeMs());
+            m_prewarming = false;
+        });
+    }
+
+    bool RHI_PipelineCache::Save()
+    {
+        bool saved = true;
+
+        // API cache
+        vector<uint8_t> data;
+        if (GetResourceData(&data) && !data.empty())
+        {
+            saved = write_file(m_directory + file_name_api, GetDeviceSignature(), data.data(), static_cast<uint32_t>(data.size())) && saved;
+        }
+
+        // States which were used this run, or were prewarmed, others are dropped
+        vector<RHI_PipelineStateDesc> states;
+        {
+            lock_guard<mutex> lock(m_mutex);
+
+            states.reserve(m_states.size());
+            for (const auto& it : m_states)
+            {
+                states.emplace_back(it.second);
+            }
+        }
+        saved = write_file(m_directory + file_name_states, vector<uint8_t>(), states.data(), static_cast<uint32_t>(states.size() * sizeof(RHI_PipelineStateDesc))) && saved;
+
+        if (!saved)
+        {
+            LOG_ERROR("Failed to save the pipeline cache to \"%s\"", m_directory.c_str());
+        }
+
+        return saved;
+    }
+
+    bool RHI_PipelineCache::Load()
+    {
+        // API cache, which is only valid for the same device and driver
+        vector<uint8_t> data;
+        if (!read_file(m_directory + file_name_api, GetDeviceSignature(), &data))
+        {
+            data.clear();
+        }
+
+        if (!CreateResource(data))
+        {
+            // Pipelines can still be created, only slower
+            LOG_WARNING("Failed to create the pipeline cache");
+        }
+
+        // States recorded by previous runs
+        vector<uint8_t> states;
+        if (read_file(m_directory + file_name_states, vector<uint8_t>(), &states) && states.size() % sizeof(RHI_PipelineStateDesc) == 0)
+        {
+            m_states_previous.resize(states.size() / sizeof(RHI_PipelineStateDesc));
+            memcpy(m_states_previous.data(), states.data(), states.size());
+        }
+
+        return !data.empty();
+    }
+
+    bool RHI_PipelineCache::Record(const RHI_PipelineState& pipeline_state)
+    {
+        // Compute pipelines don't go through here
+        if (pipeline_state.shader_compute)
+            return false;
+
+        RHI_PipelineStateDesc desc;
+        desc.shader_vertex                      = get_stable_hash(pipeline_state.shader_vertex);
+        desc.shader_pixel                       = get_stable_hash(pipeline_state.shader_pixel);
+        desc.rasterizer_state                   = get_stable_hash(pipeline_state.rasterizer_state);
+        desc.blend_state                        = get_stable_hash(pipeline_state.blend_state);
+        desc.depth_stencil_state                = get_stable_hash(pipeline_state.depth_stencil_state);
+        desc.render_target_depth                = get_stable_hash(pipeline_state.render_target_depth_texture);
+        desc.load_op_depth                      = get_load_op(pipeline_state.clear_depth);
+        desc.load_op_stencil                    = get_load_op(pipeline_state.clear_stencil);
+        desc.swapchain                          = pipeline_state.render_target_swapchain != nullptr;
+        desc.primitive_topology                 = pipeline_state.primitive_topology;
+        desc.vertex_buffer_stride               = pipeline_state.vertex_buffer_stride;
+        desc.dynamic_scissor                    = pipeline_state.dynamic_scissor;
+        desc.bindless                           = pipeline_state.bindless;
+        desc.color_array_index                  = pipeline_state.render_target_color_texture_array_index;
+        desc.depth_array_index                  = pipeline_state.render_target_depth_stencil_texture_array_index;
+        desc.color_layout_initial               = pipeline_state.render_target_color_layout_initial;
+        desc.color_layout_final                 = pipeline_state.render_target_color_layout_final;
+        desc.depth_layout_initial               = pipeline_state.render_target_depth_layout_initial;
+        desc.depth_layout_final                 = pipeline_state.render_target_depth_layout_final;
+        desc.dynamic_constant_buffer_slot       = pipeline_state.dynamic_constant_buffer_slot;
+        desc.dynamic_constant_buffer_slot_2     = pipeline_state.dynamic_constant_buffer_slot_2;
+        desc.viewport[0]                        = pipeline_state.viewport.x;
+        desc.viewport[1]                        = pipeline_state.viewport.y;
+        desc.viewport[2]                        = pipeline_state.viewport.width;
+        desc.viewport[3]                        = pipeline_state.viewport.height;
+        desc.viewport[4]                        = pipeline_state.viewport.depth_min;
+        desc.viewport[5]                        = pipeline_state.viewport.depth_max;
+        desc.scissor[0]                         = pipeline_state.scissor.left;
+        desc.scissor[1]                         = pipeline_state.scissor.top;
+        desc.scissor[2]                         = pipeline_state.scissor.right;
+        desc.scissor[3]                         = pipeline_state.scissor.bottom;
+
+        for (uint32_t i = 0; i < state_max_render_target_count; i++)
+        {
+            desc.render_target_color[i] = get_stable_hash(pipeline_state.render_target_color_textures[i]);
+            desc.load_op_color[i]       = pipeline_state.render_target_color_textures[i] ? get_load_op(pipeline_state.clear_color[i]) : 0;
+
+            // An object which can't be identified across runs (an unnamed texture), so the state can't be prewarmed
+            if (pipeline_state.render_target_color_textures[i] && desc.render_target_color[i] == 0)
+                return false;
+        }
+
+        if (desc.shader_vertex == 0 || (pipeline_state.shader_pixel && desc.shader_pixel == 0) || (pipeline_state.render_target_depth_texture && desc.render_target_depth == 0))
+            return false;
+
+        lock_guard<mutex> lock(m_mutex);
+        m_states[Utility::Hash::fnv1a_64(&desc, sizeof(desc))] = desc;
+
+        return true;
+    }
+
+    RHI_Pipeline* RHI_PipelineCache::Emplace(const uint64_t hash, const shared_ptr<RHI_Pipeline>& pipeline)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        const auto result = m_cache.emplace(hash, pipeline);
 
-        // If no pipeline exists for this state, create one
-        auto it = m_cache.find(hash);
-        if (it == m_cache.end())
+        // Both the prewarm and the renderer created it, keep the other one alive, destroying it waits for the GPU
+        if (!result.second)
         {
-            // Cache a new pipeline
-            it = m_cache.emplace(make_pair(hash, move(make_shared<RHI_Pipeline>(m_rhi_device, pipeline_state, descriptor_set_layout)))).first;
+            m_cache_duplicates.emplace_back(pipeline);
         }
 
-        return it->second.get();
+        return result.first->second.get();
     }
 }
@@ -23,6 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ======================
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
 #include <unordered_map>
 #include "RHI_Definition.h"
 #include "../Core/Spartan_Object.h"
@@ -30,15 +34,86 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    // A pipeline state, with every object it refers to replaced by something which is the same across runs
+    struct RHI_PipelineStateDesc
+    {
+        uint64_t shader_vertex          = 0;
+        uint64_t shader_pixel           = 0;
+        uint64_t rasterizer_state       = 0;
+        uint64_t blend_state            = 0;
+        uint64_t depth_stencil_state    = 0;
+        uint64_t render_target_depth    = 0;
+        uint64_t render_target_color[state_max_render_target_count] = {};
+        uint32_t load_op_color[state_max_render_target_count]       = {};
+        uint32_t load_op_depth          = 0;
+        uint32_t load_op_stencil        = 0;
+        uint32_t swapchain              = 0;
+        uint32_t primitive_topology     = 0;
+        uint32_t vertex_buffer_stride   = 0;
+        uint32_t dynamic_scissor        = 0;
+        uint32_t bindless               = 0;
+        uint32_t padding                = 0;
+        uint32_t color_array_index      = 0;
+        uint32_t depth_array_index      = 0;
+        uint32_t color_layout_initial   = 0;
+        uint32_t color_layout_final     = 0;
+        uint32_t depth_layout_initial   = 0;
+        uint32_t depth_layout_final     = 0;
+        int32_t dynamic_constant_buffer_slot    = 0;
+        int32_t dynamic_constant_buffer_slot_2  = 0;
+        float viewport[6]               = {};
+        float scissor[4]                = {};
+    };
+
+    // The objects which recorded pipeline states can be resolved against, the renderer provides them
+    struct RHI_PipelineStateObjects
+    {
+        std::vector<RHI_Shader*> shaders;
+        std::vector<RHI_RasterizerState*> rasterizer_states;
+        std::vector<RHI_BlendState*> blend_states;
+        std::vector<RHI_DepthStencilState*> depth_stencil_states;
+        std::vector<std::shared_ptr<RHI_Texture>> textures;
+        RHI_SwapChain* swapchain = nullptr;
+    };
+
 	class RHI_PipelineCache : public Spartan_Object
 	{
 	public:
-        RHI_PipelineCache(const RHI_Device* rhi_device) { m_rhi_device = rhi_device; }
+        // The API's pipeline cache and the pipeline states which were seen are persisted in the directory
+        RHI_PipelineCache(const RHI_Device* rhi_device, const std::string& directory);
+        ~RHI_PipelineCache();
+
         RHI_Pipeline* GetPipeline(RHI_CommandList* cmd_list, RHI_PipelineState& pipeline_state, void* descriptor_set_layout);
 
+        // Creates, on a worker thread, the pipelines of the states which previous runs recorded
+        void Prewarm(const RHI_PipelineStateObjects& objects, RHI_DescriptorCache* descriptor_cache);
+        bool IsPrewarming() const { return m_prewarming; }
+
+        bool Save();
+
 	private:
+        // API specific
+        bool CreateResource(const std::vector<uint8_t>& data);
+        bool GetResourceData(std::vector<uint8_t>* data) const;
+        void DestroyResource();
+        std::vector<uint8_t> GetDeviceSignature() const; // data from previous drivers or devices is rejected
+
+        bool Load();
+        bool Record(const RHI_PipelineState& pipeline_state);
+        RHI_Pipeline* Emplace(uint64_t hash, const std::shared_ptr<RHI_Pipeline>& pipeline);
+
         // <hash of pipeline state, pipeline state object>
-        std::unordered_map<std::size_t, std::shared_ptr<RHI_Pipeline>> m_cache;
+        std::unordered_map<uint64_t, std::shared_ptr<RHI_Pipeline>> m_cache;
+        std::vector<std::shared_ptr<RHI_Pipeline>> m_cache_duplicates; // created by both the prewarm and the renderer, never destroyed on the worker
+        std::mutex m_mutex;
+
+        // <stable hash of pipeline state, description>
+        std::unordered_map<uint64_t, RHI_PipelineStateDesc> m_states;
+        std::vector<RHI_PipelineStateDesc> m_states_previous;
+        std::atomic<bool> m_prewarming = false;
+
+        std::string m_directory;
+        void* m_resource = nullptr;
 
         // Dependencies
         const RHI_Device* m_rhi_device;
@@ -28,7 +28,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_InputLayout.h"
 #include "RHI_RasterizerState.h"
 #include "RHI_DepthStencilState.h"
+#include "../Core/Stopwatch.h"
 #include "..\Utilities\Hash.h"
+#include <functional>
+#include <cstring>
 //================================
 
 //= NAMESPACES =====
@@ -143,107 +146,169 @@ namespace Spartan
         clear_stencil = state_stencil_load;
 	}
 
-	void RHI_PipelineState::ComputeHash()
+    void RHI_PipelineState::ComputeHash()
     {
-        m_hash = 0;
-
-        Utility::Hash::hash_combine(m_hash, dynamic_scissor);
-        Utility::Hash::hash_combine(m_hash, viewport.x);
-        Utility::Hash::hash_combine(m_hash, viewport.y);
-        Utility::Hash::hash_combine(m_hash, viewport.width);
-        Utility::Hash::hash_combine(m_hash, viewport.height);
-        Utility::Hash::hash_combine(m_hash, primitive_topology);
-        Utility::Hash::hash_combine(m_hash, vertex_buffer_stride);
-        Utility::Hash::hash_combine(m_hash, render_target_color_texture_array_index);
-        Utility::Hash::hash_combine(m_hash, render_target_depth_stencil_texture_array_index);
-        Utility::Hash::hash_combine(m_hash, render_target_swapchain != nullptr);
+        // The fields are public and the passes assign them every frame, mostly to the values they already had.
+        // So gather everything the hash depends on and only hash again if any of it actually changed.
+        array<uint32_t, hash_input_count> inputs = {};
+        uint32_t index = 0;
+        const auto add = [&inputs, &index](const uint32_t value) { inputs[index++] = value; };
+        const auto add_float = [&add](const float value) { uint32_t bits; memcpy(&bits, &value, sizeof(bits)); add(bits); };
+
+        add(dynamic_scissor);
+        add(bindless);
+        add_float(viewport.x);
+        add_float(viewport.y);
+        add_float(viewport.width);
+        add_float(viewport.height);
+        add_float(viewport.depth_min);
+        add_float(viewport.depth_max);
+        add(primitive_topology);
+        add(vertex_buffer_stride);
+        add(render_target_color_texture_array_index);
+        add(render_target_depth_stencil_texture_array_index);
+        add(render_target_swapchain != nullptr);
 
         if (!dynamic_scissor)
         {
-            Utility::Hash::hash_combine(m_hash, scissor.left);
-            Utility::Hash::hash_combine(m_hash, scissor.top);
-            Utility::Hash::hash_combine(m_hash, scissor.right);
-            Utility::Hash::hash_combine(m_hash, scissor.bottom);
+            add_float(scissor.left);
+            add_float(scissor.top);
+            add_float(scissor.right);
+            add_float(scissor.bottom);
         }
-
-        if (rasterizer_state)
+        else
         {
-            Utility::Hash::hash_combine(m_hash, rasterizer_state->GetId());
+            index += 4;
         }
 
-        if (blend_state)
-        {
-            Utility::Hash::hash_combine(m_hash, blend_state->GetId());
-        }
-
-        if (depth_stencil_state)
-        {
-            Utility::Hash::hash_combine(m_hash, depth_stencil_state->GetId());
-        }
+        add(rasterizer_state    ? rasterizer_state->GetId()     : 0);
+        add(blend_state         ? blend_state->GetId()          : 0);
+        add(depth_stencil_state ? depth_stencil_state->GetId()  : 0);
 
         // Shaders
-        {
-            if (shader_compute)
-            {
-                Utility::Hash::hash_combine(m_hash, shader_compute->GetId());
-            }
-
-            if (shader_vertex)
-            {
-                Utility::Hash::hash_combine(m_hash, shader_vertex->GetId());
-            }
-
-            if (shader_pixel)
-            {
-                Utility::Hash::hash_combine(m_hash, shader_pixel->GetId());
-            }
-        }
+        add(shader_compute  ? shader_compute->GetId()   : 0);
+        add(shader_vertex   ? shader_vertex->GetId()    : 0);
+        add(shader_pixel    ? shader_pixel->GetId()     : 0);
 
         // RTs
         bool has_rt_color = false;
         {
-            uint8_t load_op = 0;
-
             // Color
             for (uint32_t i = 0; i < state_max_render_target_count; i++)
             {
                 if (RHI_Texture* texture = render_target_color_textures[i])
                 {
-                    Utility::Hash::hash_combine(m_hash, texture->GetId());
-
-                    load_op = clear_color[i] == state_color_dont_care ? 0 : clear_color[i] == state_color_load ? 1 : 2;
-                    Utility::Hash::hash_combine(m_hash, load_op);
+                    add(texture->GetId());
+                    add(clear_color[i] == state_color_dont_care ? 0 : clear_color[i] == state_color_load ? 1 : 2);
 
                     has_rt_color = true;
                 }
+                else
+                {
+                    index += 2;
+                }
             }
 
             // Depth
             if (render_target_depth_texture)
             {
-                Utility::Hash::hash_combine(m_hash, render_target_depth_texture->GetId());
-
-                load_op = clear_depth == state_depth_dont_care ? 0 : clear_depth == state_depth_load ? 1 : 2;
-                Utility::Hash::hash_combine(m_hash, load_op);
-
-                load_op = clear_stencil == state_stencil_dont_care ? 0 : clear_stencil == state_stencil_load ? 1 : 2;
-                Utility::Hash::hash_combine(m_hash, load_op);
+                add(render_target_depth_texture->GetId());
+                add(clear_depth == state_depth_dont_care ? 0 : clear_depth == state_depth_load ? 1 : 2);
+                add(clear_stencil == state_stencil_dont_care ? 0 : clear_stencil == state_stencil_load ? 1 : 2);
+            }
+            else
+            {
+                index += 3;
             }
         }
 
         // Initial and final layouts
+        add(has_rt_color                ? render_target_color_layout_initial : 0);
+        add(has_rt_color                ? render_target_color_layout_final   : 0);
+        add(render_target_depth_texture ? render_target_depth_layout_initial : 0);
+        add(render_target_depth_texture ? render_target_depth_layout_final   : 0);
+
+        if (m_hash != 0 && inputs == m_hash_inputs)
+            return;
+
+        m_hash_inputs   = inputs;
+        m_hash          = Utility::Hash::fnv1a_64(m_hash_inputs.data(), sizeof(uint32_t) * index);
+    }
+
+    bool RHI_PipelineState::Benchmark(const uint32_t iterations /*= 100000*/)
+    {
+        // Only fields which don't need GPU objects, so this runs without a device
+        const auto make_state = []()
         {
-            if (has_rt_color)
-            {
-                Utility::Hash::hash_combine(m_hash, render_target_color_layout_initial);
-                Utility::Hash::hash_combine(m_hash, render_target_color_layout_final);
-            }
+            RHI_PipelineState state;
+            state.viewport              = RHI_Viewport(0.0f, 0.0f, 1920.0f, 1080.0f);
+            state.primitive_topology    = RHI_PrimitiveTopology_TriangleList;
+            state.vertex_buffer_stride  = 48;
+            state.scissor               = Math::Rectangle(0.0f, 0.0f, 1920.0f, 1080.0f);
+            return state;
+        };
+
+        bool passed = true;
+
+        // Stability, the same state hashes the same, no matter how many times and on which object
+        RHI_PipelineState state_a = make_state();
+        RHI_PipelineState state_b = make_state();
+        state_a.ComputeHash();
+        state_b.ComputeHash();
+        const uint64_t hash_reference = state_a.GetHash();
+        state_a.ComputeHash();
+        passed = passed && hash_reference != 0 && state_a.GetHash() == hash_reference && state_b.GetHash() == hash_reference;
+
+        // Every field which affects the pipeline must change the hash, and reverting it must restore it
+        const auto check_field = [&passed, &state_a, hash_reference](const char* name, const function<void(RHI_PipelineState&)>& change, const function<void(RHI_PipelineState&)>& revert)
+        {
+            change(state_a);
+            state_a.ComputeHash();
+            const bool changed = state_a.GetHash() != hash_reference;
 
-            if (render_target_depth_texture)
+            revert(state_a);
+            state_a.ComputeHash();
+            const bool restored = state_a.GetHash() == hash_reference;
+
+            if (!changed || !restored)
             {
-                Utility::Hash::hash_combine(m_hash, render_target_depth_layout_initial);
-                Utility::Hash::hash_combine(m_hash, render_target_depth_layout_final);
+                LOG_ERROR("Hash doesn't track \"%s\"", name);
+                passed = false;
             }
+        };
+
+        check_field("viewport",             [](RHI_PipelineState& s) { s.viewport.width = 1280.0f; },                           [](RHI_PipelineState& s) { s.viewport.width = 1920.0f; });
+        check_field("primitive_topology",   [](RHI_PipelineState& s) { s.primitive_topology = RHI_PrimitiveTopology_LineList; }, [](RHI_PipelineState& s) { s.primitive_topology = RHI_PrimitiveTopology_TriangleList; });
+        check_field("vertex_buffer_stride", [](RHI_PipelineState& s) { s.vertex_buffer_stride = 32; },                          [](RHI_PipelineState& s) { s.vertex_buffer_stride = 48; });
+        check_field("scissor",              [](RHI_PipelineState& s) { s.scissor.right = 960.0f; },                             [](RHI_PipelineState& s) { s.scissor.right = 1920.0f; });
+        check_field("dynamic_scissor",      [](RHI_PipelineState& s) { s.dynamic_scissor = true; },                             [](RHI_PipelineState& s) { s.dynamic_scissor = false; });
+        check_field("bindless",             [](RHI_PipelineState& s) { s.bindless = true; },                                    [](RHI_PipelineState& s) { s.bindless = false; });
+        check_field("array_index",          [](RHI_PipelineState& s) { s.render_target_color_texture_array_index = 1; },        [](RHI_PipelineState& s) { s.render_target_color_texture_array_index = 0; });
+
+        // Lookup cost, the state is re-assigned but unchanged (what the passes do every frame) against a state which does change
+        Stopwatch timer;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            state_a.vertex_buffer_stride = 48;
+            state_a.ComputeHash();
         }
+        const float ms_unchanged = timer.GetElapsedTimeMs();
+
+        timer.Start();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            state_a.vertex_buffer_stride = 48 + (i & 1);
+            state_a.ComputeHash();
+        }
+        const float ms_changed = timer.GetElapsedTimeMs();
+
+        LOG_INFO("%s, %d lookups: %.2f ns unchanged, %.2f ns changed",
+            passed ? "Passed" : "Failed",
+            iterations,
+            ms_unchanged * 1e6f / iterations,
+            ms_changed * 1e6f / iterations
+        );
+
+        return passed;
     }
 }
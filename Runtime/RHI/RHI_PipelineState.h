@@ -41,6 +41,7 @@ namespace Spartan
         bool CreateFrameResources(const RHI_Device* rhi_device);
         void* GetFrameBuffer() const;
         void ComputeHash();
+        static bool Benchmark(uint32_t iterations = 100000);
         uint32_t GetWidth() const;
         uint32_t GetHeight() const;
         void ResetClearValues();
@@ -60,6 +61,7 @@ namespace Spartan
         RHI_Viewport viewport                               = RHI_Viewport::Undefined;
         Math::Rectangle scissor                             = Math::Rectangle::Zero;
         bool dynamic_scissor                                = false;
+        bool bindless                                       = false;    // the device's bindless table is bound as a second descriptor set
         uint32_t vertex_buffer_stride                       = 0;
         RHI_Image_Layout render_target_color_layout_initial = RHI_Image_Undefined;
         RHI_Image_Layout render_target_color_layout_final   = RHI_Image_Undefined;
@@ -120,7 +122,11 @@ namespace Spartan
     private:
         void DestroyFrameResources();
 
-        std::size_t m_hash  = 0;
+        // Everything the hash depends on, as of the last ComputeHash()
+        static const uint32_t hash_input_count = 48;
+        std::array<uint32_t, hash_input_count> m_hash_inputs = {};
+
+        uint64_t m_hash     = 0;
         void* m_render_pass = nullptr;
         std::array<void*, state_max_render_target_count> m_frame_buffers =
         {
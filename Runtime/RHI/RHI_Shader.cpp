@@ -40,6 +40,7 @@ namespace Spartan
 	RHI_Shader::RHI_Shader(Context* context) : Spartan_Object(context)
 	{
 		m_rhi_device	= context->GetSubsystem<Renderer>()->GetRhiDevice();
+		m_shader_cache	= context->GetSubsystem<Renderer>()->GetShaderCache();
 		m_input_layout	= make_shared<RHI_InputLayout>(m_rhi_device);
 	}
 
@@ -166,6 +167,10 @@ namespace Spartan
         static const char* target_profile_vs = "vs_6_0";
         static const char* target_profile_ps = "ps_6_0";
         static const char* target_profile_cs = "cs_6_0";
+        #elif defined(API_GRAPHICS_NULL)
+        static const char* target_profile_vs = "vs_6_0";
+        static const char* target_profile_ps = "ps_6_0";
+        static const char* target_profile_cs = "cs_6_0";
         #endif
 
         if (m_shader_type == RHI_Shader_Vertex)     return target_profile_vs;
@@ -183,6 +188,8 @@ namespace Spartan
         static const char* shader_model = "6_0";
         #elif defined(API_GRAPHICS_VULKAN)
         static const char* shader_model = "6_0";
+        #elif defined(API_GRAPHICS_NULL)
+        static const char* shader_model = "6_0";
         #endif
 
         return shader_model;
@@ -196,9 +203,15 @@ namespace Spartan
 		// The SPIR-V is now parsed, and we can perform reflection on it
         spirv_cross::ShaderResources resources = compiler.get_shader_resources();
 
+        // Only the first set is reflected, any other (like the bindless table) is bound by whoever declares it
+        const auto is_first_set = [&compiler](const spirv_cross::Resource& resource) { return compiler.get_decoration(resource.id, spv::DecorationDescriptorSet) == 0; };
+
 		// Get samplers
 		for (const auto& resource : resources.separate_samplers)
 		{
+            if (!is_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 RHI_Descriptor_Type::RHI_Descriptor_Sampler,                    // Type
@@ -210,6 +223,9 @@ namespace Spartan
 		// Get textures
 		for (const auto& resource : resources.separate_images)
 		{
+            if (!is_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 RHI_Descriptor_Type::RHI_Descriptor_Texture,                    // Type
@@ -221,6 +237,9 @@ namespace Spartan
 		// Get constant buffers
 		for (const auto& resource : resources.uniform_buffers)
 		{
+            if (!is_first_set(resource))
+                continue;
+
             m_descriptors.emplace_back
             (
                 RHI_Descriptor_Type::RHI_Descriptor_ConstantBuffer,             // Type
@@ -237,5 +256,6 @@ namespace Spartan
     template void RHI_Shader::CompileAsync<RHI_Vertex_PosCol>(const RHI_Shader_Type, const std::string&);
     template void RHI_Shader::CompileAsync<RHI_Vertex_Pos2dTexCol8>(const RHI_Shader_Type, const std::string&);
     template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan>(const RHI_Shader_Type, const std::string&);
+    template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan16>(const RHI_Shader_Type, const std::string&);
     //=========================================================================================================
 }
@@ -80,6 +80,7 @@ namespace Spartan
 
 	protected:
 		std::shared_ptr<RHI_Device> m_rhi_device;
+        RHI_ShaderCache* m_shader_cache = nullptr;
 
 	private:
         // All compile functions resolve to this, and this is the underlying API implements
@@ -0,0 +1,373 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "RHI_ShaderCache.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include "../Logging/Log.h"
+#include "../Core/FileSystem.h"
+#include "../Core/Stopwatch.h"
+#include "../Utilities/Hash.h"
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        // Bump the version whenever the layout of an entry changes, older entries will be discarded
+        const uint32_t cache_magic              = 0x43485353; // "SSHC"
+        const uint32_t cache_version            = 1;
+        const uint32_t cache_bytecode_size_max  = 64 * 1024 * 1024;
+        const uint32_t cache_descriptor_max     = 1024;
+
+        struct CacheHeader
+        {
+            uint32_t magic              = cache_magic;
+            uint32_t version            = cache_version;
+            uint64_t key                = 0;
+            uint64_t checksum           = 0;
+            uint32_t descriptor_count   = 0;
+            uint32_t bytecode_size      = 0;
+        };
+
+        struct CacheDescriptor
+        {
+            uint32_t type;
+            uint32_t slot;
+            uint32_t stage;
+        };
+
+        inline bool read_file(const string& file_path, string* content)
+        {
+            ifstream file(file_path, ios::binary);
+            if (!file)
+                return false;
+
+            stringstream buffer;
+            buffer << file.rdbuf();
+            *content = buffer.str();
+            return true;
+        }
+
+        inline uint64_t hash_string(const string& value, const uint64_t hash)
+        {
+            // Hash the length as well, so that consecutive strings can't shift into each other
+            const uint64_t size = static_cast<uint64_t>(value.size());
+            return Utility::Hash::fnv1a_64(value.data(), value.size(), Utility::Hash::fnv1a_64(&size, sizeof(size), hash));
+        }
+
+        inline uint64_t compute_checksum(const vector<CacheDescriptor>& descriptors, const vector<uint8_t>& bytecode)
+        {
+            uint64_t checksum = Utility::Hash::fnv1a_64(descriptors.data(), descriptors.size() * sizeof(CacheDescriptor));
+            return Utility::Hash::fnv1a_64(bytecode.data(), bytecode.size(), checksum);
+        }
+    }
+
+    RHI_ShaderCache::RHI_ShaderCache(const string& directory)
+    {
+        m_directory = directory;
+
+        if (!FileSystem::Exists(m_directory) && !FileSystem::CreateDirectory_(m_directory))
+        {
+            LOG_WARNING("Failed to create \"%s\", shaders will not be cached", m_directory.c_str());
+            m_enabled = false;
+        }
+    }
+
+    uint64_t RHI_ShaderCache::ComputeKey(const string& shader, const unordered_map<string, string>& defines, const char* entry_point, const char* target_profile, const string& compiler)
+    {
+        uint64_t key = Utility::Hash::fnv1a_64_offset;
+
+        // Source, when it's a file then any included file has to be part of the key too
+        if (FileSystem::IsFile(shader))
+        {
+            string source;
+            read_file(shader, &source);
+            key = hash_string(source, key);
+
+            for (const string& include : FileSystem::GetIncludedFiles(shader))
+            {
+                read_file(include, &source);
+                key = hash_string(FileSystem::GetFileNameFromFilePath(include), key);
+                key = hash_string(source, key);
+            }
+        }
+        else
+        {
+            key = hash_string(shader, key);
+        }
+
+        // Defines, sorted as the map has no defined order
+        vector<pair<string, string>> defines_sorted(defines.begin(), defines.end());
+        sort(defines_sorted.begin(), defines_sorted.end());
+        for (const auto& define : defines_sorted)
+        {
+            key = hash_string(define.first, key);
+            key = hash_string(define.second, key);
+        }
+
+        key = hash_string(entry_point ? entry_point : "", key);
+        key = hash_string(target_profile ? target_profile : "", key);
+        key = hash_string(compiler, key);
+
+        return key;
+    }
+
+    bool RHI_ShaderCache::Load(const uint64_t key, vector<uint8_t>* bytecode, vector<RHI_Descriptor>* descriptors)
+    {
+        if (!m_enabled || !bytecode || !descriptors)
+            return false;
+
+        const string file_path = GetFilePath(key);
+        ifstream file(file_path, ios::binary);
+        if (!file)
+        {
+            m_miss_count++;
+            return false;
+        }
+
+        // Header
+        CacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader));
+        bool is_valid =
+            file                                                &&
+            header.magic            == cache_magic              &&
+            header.version          == cache_version            &&
+            header.key              == key                      &&
+            header.descriptor_count <= cache_descriptor_max     &&
+            header.bytecode_size    <= cache_bytecode_size_max  &&
+            header.bytecode_size    != 0;
+
+        // Payload
+        vector<CacheDescriptor> descriptors_cached;
+        if (is_valid)
+        {
+            descriptors_cached.resize(header.descriptor_count);
+            bytecode->resize(header.bytecode_size);
+            file.read(reinterpret_cast<char*>(descriptors_cached.data()), descriptors_cached.size() * sizeof(CacheDescriptor));
+            file.read(reinterpret_cast<char*>(bytecode->data()), bytecode->size());
+            is_valid = file && compute_checksum(descriptors_cached, *bytecode) == header.checksum;
+        }
+        file.close();
+
+        // Stale or corrupted (e.g. the engine closed while writing), drop it so that it gets rebuilt
+        if (!is_valid)
+        {
+            LOG_WARNING("Discarding invalid shader cache entry \"%s\"", file_path.c_str());
+            bytecode->clear();
+            FileSystem::Delete(file_path);
+            m_miss_count++;
+            return false;
+        }
+
+        descriptors->clear();
+        descriptors->reserve(descriptors_cached.size());
+        for (const CacheDescriptor& descriptor : descriptors_cached)
+        {
+            descriptors->emplace_back(static_cast<RHI_Descriptor_Type>(descriptor.type), descriptor.slot, descriptor.stage);
+        }
+
+        m_hit_count++;
+        return true;
+    }
+
+    bool RHI_ShaderCache::Save(const uint64_t key, const vector<uint8_t>& bytecode, const vector<RHI_Descriptor>& descriptors)
+    {
+        if (!m_enabled || bytecode.empty() || bytecode.size() > cache_bytecode_size_max || descriptors.size() > cache_descriptor_max)
+            return false;
+
+        vector<CacheDescriptor> descriptors_cached;
+        descriptors_cached.reserve(descriptors.size());
+        for (const RHI_Descriptor& descriptor : descriptors)
+        {
+            descriptors_cached.push_back({ static_cast<uint32_t>(descriptor.type), descriptor.slot, descriptor.stage });
+        }
+
+        CacheHeader header;
+        header.key              = key;
+        header.checksum         = compute_checksum(descriptors_cached, bytecode);
+        header.descriptor_count = static_cast<uint32_t>(descriptors_cached.size());
+        header.bytecode_size    = static_cast<uint32_t>(bytecode.size());
+
+        // Write to a temporary file and then rename it, so that a reader never sees a partial entry
+        const string file_path      = GetFilePath(key);
+        const string file_path_temp = file_path + ".tmp";
+        {
+            ofstream file(file_path_temp, ios::binary | ios::trunc);
+            if (!file)
+            {
+                LOG_ERROR("Failed to open \"%s\" for writing", file_path_temp.c_str());
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+            file.write(reinterpret_cast<const char*>(descriptors_cached.data()), descriptors_cached.size() * sizeof(CacheDescriptor));
+            file.write(reinterpret_cast<const char*>(bytecode.data()), bytecode.size());
+
+            if (!file)
+            {
+                LOG_ERROR("Failed to write \"%s\"", file_path_temp.c_str());
+                return false;
+            }
+        }
+
+        error_code error;
+        filesystem::rename(file_path_temp, file_path, error);
+        if (error)
+        {
+            LOG_ERROR("Failed to rename \"%s\", %s", file_path_temp.c_str(), error.message().c_str());
+            FileSystem::Delete(file_path_temp);
+            return false;
+        }
+
+        return true;
+    }
+
+    void RHI_ShaderCache::Clear()
+    {
+        FileSystem::Delete(m_directory);
+        FileSystem::CreateDirectory_(m_directory);
+        m_hit_count     = 0;
+        m_miss_count    = 0;
+    }
+
+    string RHI_ShaderCache::GetFilePath(const uint64_t key) const
+    {
+        stringstream stream;
+        stream << m_directory << "/" << hex << setw(16) << setfill('0') << key << ".bin";
+        return stream.str();
+    }
+
+    bool RHI_ShaderCache::Benchmark(const string& shader_directory, const string& cache_directory, const uint32_t variation_count)
+    {
+        vector<string> shaders;
+        for (const string& file_path : FileSystem::GetFilesInDirectory(shader_directory))
+        {
+            if (FileSystem::IsSupportedShaderFile(file_path))
+            {
+                shaders.emplace_back(file_path);
+            }
+        }
+
+        if (shaders.empty() || variation_count == 0)
+        {
+            LOG_ERROR("No shaders found in \"%s\"", shader_directory.c_str());
+            return false;
+        }
+
+        RHI_ShaderCache cache(cache_directory);
+        cache.Clear();
+        if (!cache.IsEnabled())
+            return false;
+
+        const string compiler       = "benchmark";
+        const uint32_t entry_count  = static_cast<uint32_t>(shaders.size()) * variation_count;
+        vector<uint64_t> keys;
+        keys.reserve(entry_count);
+        bool result = true;
+
+        // Keys, including the cost of reading the includes which is paid on every compilation
+        Stopwatch timer;
+        for (const string& shader : shaders)
+        {
+            for (uint32_t i = 0; i < variation_count; i++)
+            {
+                keys.emplace_back(ComputeKey(shader, { { "VARIATION", to_string(i) } }, "mainPS", "ps_6_0", compiler));
+            }
+        }
+        const float time_keys = timer.GetElapsedTimeMs();
+
+        // Keys have to be deterministic and unique
+        {
+            vector<uint64_t> keys_sorted = keys;
+            sort(keys_sorted.begin(), keys_sorted.end());
+            const bool unique   = adjacent_find(keys_sorted.begin(), keys_sorted.end()) == keys_sorted.end();
+            const bool stable   = ComputeKey(shaders[0], { { "VARIATION", "0" } }, "mainPS", "ps_6_0", compiler) == keys[0];
+            const bool compiler_invalidates = ComputeKey(shaders[0], { { "VARIATION", "0" } }, "mainPS", "ps_6_0", compiler + "_new") != keys[0];
+            const bool profile_invalidates  = ComputeKey(shaders[0], { { "VARIATION", "0" } }, "mainVS", "vs_6_0", compiler) != keys[0];
+            result = result && unique && stable && compiler_invalidates && profile_invalidates;
+        }
+
+        // Cold, every lookup misses and the result gets written (the compilation itself isn't part of this)
+        vector<uint8_t> bytecode(16 * 1024);
+        vector<RHI_Descriptor> descriptors = { RHI_Descriptor(RHI_Descriptor_ConstantBuffer, 0, 1), RHI_Descriptor(RHI_Descriptor_Texture, 1, 2) };
+        timer.Start();
+        for (uint32_t i = 0; i < entry_count; i++)
+        {
+            vector<uint8_t> bytecode_loaded;
+            vector<RHI_Descriptor> descriptors_loaded;
+            result = result && !cache.Load(keys[i], &bytecode_loaded, &descriptors_loaded);
+
+            for (size_t j = 0; j < bytecode.size(); j++)
+            {
+                bytecode[j] = static_cast<uint8_t>((keys[i] >> ((j % 8) * 8)) + j);
+            }
+            result = result && cache.Save(keys[i], bytecode, descriptors);
+        }
+        const float time_cold = timer.GetElapsedTimeMs();
+
+        // Warm, every lookup hits and has to return exactly what was written
+        timer.Start();
+        for (uint32_t i = 0; i < entry_count; i++)
+        {
+            vector<uint8_t> bytecode_loaded;
+            vector<RHI_Descriptor> descriptors_loaded;
+            const bool hit = cache.Load(keys[i], &bytecode_loaded, &descriptors_loaded);
+            result = result && hit && bytecode_loaded.size() == bytecode.size() && descriptors_loaded.size() == descriptors.size();
+            result = result && bytecode_loaded[1] == static_cast<uint8_t>((keys[i] >> 8) + 1);
+        }
+        const float time_warm = timer.GetElapsedTimeMs();
+
+        // A corrupted entry has to be discarded
+        {
+            ofstream file(cache.GetFilePath(keys[0]), ios::binary | ios::in | ios::out);
+            file.seekp(sizeof(CacheHeader) + 8);
+            file.put(0x7f);
+            file.close();
+
+            vector<uint8_t> bytecode_loaded;
+            vector<RHI_Descriptor> descriptors_loaded;
+            result = result && !cache.Load(keys[0], &bytecode_loaded, &descriptors_loaded) && !FileSystem::Exists(cache.GetFilePath(keys[0]));
+        }
+
+        LOG_INFO("%u entries (%u shaders), keys: %.2f ms, cold: %.2f ms, warm: %.2f ms, hits: %u, misses: %u, %s",
+            entry_count,
+            static_cast<uint32_t>(shaders.size()),
+            time_keys,
+            time_cold,
+            time_warm,
+            cache.GetHitCount(),
+            cache.GetMissCount(),
+            result ? "passed" : "failed"
+        );
+
+        cache.Clear();
+        return result;
+    }
+}
@@ -0,0 +1,73 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==============
+#include <string>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
+#include "RHI_Definition.h"
+//=========================
+
+namespace Spartan
+{
+    // Compiled shaders (bytecode and reflection) on disk, addressed by a hash of everything that affects compilation
+    class SPARTAN_CLASS RHI_ShaderCache
+    {
+    public:
+        RHI_ShaderCache(const std::string& directory);
+        ~RHI_ShaderCache() = default;
+
+        // Hashes the source (including any #include, recursively), the defines, the entry point, the profile and the compiler (version and arguments)
+        static uint64_t ComputeKey(
+            const std::string& shader,
+            const std::unordered_map<std::string, std::string>& defines,
+            const char* entry_point,
+            const char* target_profile,
+            const std::string& compiler
+        );
+
+        // Thread safe, shaders compile asynchronously
+        bool Load(uint64_t key, std::vector<uint8_t>* bytecode, std::vector<RHI_Descriptor>* descriptors);
+        bool Save(uint64_t key, const std::vector<uint8_t>& bytecode, const std::vector<RHI_Descriptor>& descriptors);
+        void Clear();
+
+        // Fills a cache with dummy variations of the shaders in a directory, then reads it back cold and warm
+        static bool Benchmark(const std::string& shader_directory, const std::string& cache_directory, uint32_t variation_count = 32);
+
+        // Properties
+        bool IsEnabled()                const { return m_enabled; }
+        void SetEnabled(bool enabled)         { m_enabled = enabled; }
+        const auto& GetDirectory()      const { return m_directory; }
+        uint32_t GetHitCount()          const { return m_hit_count; }
+        uint32_t GetMissCount()         const { return m_miss_count; }
+
+    private:
+        std::string GetFilePath(uint64_t key) const;
+
+        std::string m_directory;
+        bool m_enabled = true;
+        std::atomic<uint32_t> m_hit_count   = 0;
+        std::atomic<uint32_t> m_miss_count  = 0;
+    };
+}
@@ -0,0 +1,230 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "RHI_StagingRing.h"
+#include "../Core/Stopwatch.h"
+#include "../Math/MathHelper.h"
+#include "../Logging/Log.h"
+#include <random>
+//=============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    void RHI_RingAllocator::Reset(const uint64_t capacity)
+    {
+        m_capacity  = capacity;
+        m_head      = 0;
+        m_tail      = 0;
+        m_allocated = 0;
+        m_freed     = 0;
+        m_markers.clear();
+    }
+
+    bool RHI_RingAllocator::Allocate(const uint64_t size, const uint64_t alignment, uint64_t* offset)
+    {
+        if (size == 0 || size > m_capacity || !offset)
+            return false;
+
+        // Nothing is alive, start over so that the whole capacity is contiguous
+        const uint64_t used = GetUsed();
+        if (used == 0)
+        {
+            m_head = 0;
+            m_tail = 0;
+        }
+
+        // Alignment doesn't have to be a power of two (e.g. offsets of images with 12 byte texels)
+        const uint64_t _alignment   = alignment != 0 ? alignment : 1;
+        const uint64_t aligned      = ((m_head + _alignment - 1) / _alignment) * _alignment;
+        const bool wrapped          = m_head < m_tail || (m_head == m_tail && used != 0); // the free space is [head, tail)
+
+        uint64_t start = 0;
+        if (!wrapped)
+        {
+            // The free space is [head, capacity) followed by [0, tail)
+            if (aligned + size <= m_capacity)
+            {
+                start = aligned;
+            }
+            else if (size <= m_tail)
+            {
+                start = 0;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (aligned + size > m_tail)
+                return false;
+
+            start = aligned;
+        }
+
+        // Alignment padding and the space which is skipped when wrapping are owned by the allocation
+        m_allocated += (start == aligned ? aligned - m_head : m_capacity - m_head) + size;
+        m_head      = start + size;
+        *offset     = start;
+
+        return true;
+    }
+
+    void RHI_RingAllocator::Close(const uint64_t value)
+    {
+        // Nothing was allocated since the previous close
+        const uint64_t allocated_previous = m_markers.empty() ? m_freed : m_markers.back().allocated;
+        if (m_allocated == allocated_previous)
+            return;
+
+        m_markers.push_back({ value, m_head, m_allocated });
+    }
+
+    void RHI_RingAllocator::Retire(const uint64_t value)
+    {
+        while (!m_markers.empty() && m_markers.front().value <= value)
+        {
+            m_tail  = m_markers.front().head;
+            m_freed = m_markers.front().allocated;
+            m_markers.pop_front();
+        }
+    }
+
+    bool RHI_RingAllocator::Benchmark(const uint32_t batch_count /*= 100000*/)
+    {
+        struct Allocation
+        {
+            uint64_t value;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        const uint64_t capacity             = 1024 * 1024;
+        const uint64_t gpu_latency          = 3; // batches
+        const uint64_t alignments[]         = { 4, 12, 16, 256 };
+        mt19937 generator(1234);
+        uniform_int_distribution<uint64_t> distribution_size(1, 64 * 1024);
+        uniform_int_distribution<uint32_t> distribution_count(1, 8);
+        uniform_int_distribution<uint32_t> distribution_alignment(0, 3);
+
+        RHI_RingAllocator allocator(capacity);
+        deque<Allocation> allocations_live;
+        uint64_t value_completed    = 0;
+        uint64_t allocation_count   = 0;
+        uint64_t stall_count        = 0;
+        uint64_t used_peak          = 0;
+        bool passed                 = true;
+
+        const auto retire = [&allocator, &allocations_live, &value_completed](const uint64_t value)
+        {
+            allocator.Retire(value);
+            while (!allocations_live.empty() && allocations_live.front().value <= value)
+            {
+                allocations_live.pop_front();
+            }
+            value_completed = value;
+        };
+
+        Stopwatch timer;
+        for (uint64_t value = 1; value <= batch_count && passed; value++)
+        {
+            const uint32_t count = distribution_count(generator);
+            for (uint32_t i = 0; i < count && passed; i++)
+            {
+                const uint64_t size         = distribution_size(generator);
+                const uint64_t alignment    = alignments[distribution_alignment(generator)];
+
+                // When the ring is full, wait for the gpu, one batch at a time
+                uint64_t offset = 0;
+                while (!allocator.Allocate(size, alignment, &offset))
+                {
+                    if (value_completed + 1 >= value)
+                    {
+                        LOG_ERROR("Failed to allocate %llu bytes with nothing in flight", size);
+                        passed = false;
+                        break;
+                    }
+
+                    retire(value_completed + 1);
+                    stall_count++;
+                }
+
+                if (!passed)
+                    break;
+
+                // Validate
+                if (offset % alignment != 0 || offset + size > capacity)
+                {
+                    LOG_ERROR("Allocation [%llu, %llu) is misaligned or out of bounds", offset, offset + size);
+                    passed = false;
+                }
+
+                for (const Allocation& allocation : allocations_live)
+                {
+                    if (offset < allocation.offset + allocation.size && allocation.offset < offset + size)
+                    {
+                        LOG_ERROR("Allocation [%llu, %llu) overlaps with a live allocation of batch %llu", offset, offset + size, allocation.value);
+                        passed = false;
+                        break;
+                    }
+                }
+
+                allocations_live.push_back({ value, offset, size });
+                allocation_count++;
+                used_peak = Helper::Max(used_peak, allocator.GetUsed());
+            }
+
+            allocator.Close(value);
+
+            if (value > gpu_latency)
+            {
+                retire(Helper::Max(value - gpu_latency, value_completed));
+            }
+        }
+        const float ms = timer.GetElapsedTimeMs();
+
+        // Once everything retires the ring must be empty
+        retire(batch_count);
+        if (passed && allocator.GetUsed() != 0)
+        {
+            LOG_ERROR("%llu bytes are still in use after everything retired", allocator.GetUsed());
+            passed = false;
+        }
+
+        LOG_INFO("%llu allocations in %.2f ms (%.1f ns per allocation), %llu stalls, peak usage %.1f%%, %s",
+            allocation_count,
+            ms,
+            allocation_count ? static_cast<double>(ms) * 1000000.0 / allocation_count : 0.0,
+            stall_count,
+            100.0 * static_cast<double>(used_peak) / static_cast<double>(capacity),
+            passed ? "passed" : "failed"
+        );
+
+        return passed;
+    }
+}
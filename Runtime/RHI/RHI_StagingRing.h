@@ -0,0 +1,137 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include "RHI_Definition.h"
+#include "../Core/Spartan_Object.h"
+//=================================
+
+namespace Spartan
+{
+    // A fixed size ring of bytes, allocations are tagged with the value of the batch they were made
+    // in and they are reclaimed, oldest first, once the value of their batch has been retired.
+    class SPARTAN_CLASS RHI_RingAllocator
+    {
+    public:
+        RHI_RingAllocator(const uint64_t capacity = 0) { Reset(capacity); }
+
+        void Reset(const uint64_t capacity);
+        bool Allocate(const uint64_t size, const uint64_t alignment, uint64_t* offset);
+        void Close(const uint64_t value);   // tags every allocation since the previous close with the value
+        void Retire(const uint64_t value);  // reclaims the allocations of every value up to (and including) the value
+
+        uint64_t GetCapacity()  const { return m_capacity; }
+        uint64_t GetUsed()      const { return m_allocated - m_freed; }
+
+        // Simulates a gpu which lags behind by a few batches and validates that live allocations never overlap
+        static bool Benchmark(uint32_t batch_count = 100000);
+
+    private:
+        struct Marker
+        {
+            uint64_t value;
+            uint64_t head;
+            uint64_t allocated;
+        };
+
+        uint64_t m_capacity     = 0;
+        uint64_t m_head         = 0;
+        uint64_t m_tail         = 0;
+        uint64_t m_allocated    = 0; // total bytes, including alignment and wrap padding
+        uint64_t m_freed        = 0;
+        std::deque<Marker> m_markers;
+    };
+
+    // Uploads buffers and textures through a persistently mapped staging ring, the copies are batched
+    // and submitted on the transfer queue, which signals a timeline semaphore as batches complete.
+    // Only Vulkan implements it, the other APIs (and devices without timeline semaphores) upload immediately.
+    class RHI_StagingRing : public Spartan_Object
+    {
+    public:
+        RHI_StagingRing(RHI_Device* rhi_device, const uint64_t size);
+        ~RHI_StagingRing();
+
+        // The buffer can be used by anything which is submitted to the graphics queue after this returns
+        bool UploadBuffer(void* buffer, const void* data, const uint64_t size);
+        // The texture's layout is set to the final layout once the copy has retired, until then it reads as undefined
+        bool UploadTexture(RHI_Texture* texture, RHI_Image_Layout& texture_layout, const RHI_Image_Layout layout_final);
+
+        // Submits the batch which is being recorded
+        void Flush();
+        // Retires completed batches and flips their resources to ready, called once per frame (or to wait for everything)
+        void Tick(const bool wait = false);
+        // Forgets about a resource (the API object) which is about to be destroyed, a batch which is still recording writes to it gets submitted
+        void Release(const void* resource);
+
+        // Submissions to the graphics queue wait for this value, so they see every uploaded buffer
+        uint64_t GetWaitValue()     const { return m_value_wait; }
+        void* GetSemaphore()        const { return m_semaphore; }
+        uint64_t GetBytesUploaded() const { return m_bytes_uploaded; }
+        bool IsInitialized()        const { return m_initialized; }
+
+    private:
+        struct Batch
+        {
+            void* cmd_pool      = nullptr;
+            void* cmd_buffer    = nullptr;
+            uint64_t value      = 0;
+            bool recording      = false;
+            bool has_buffers    = false;
+            std::vector<void*> buffers_dedicated; // uploads which don't fit in the ring
+            std::vector<std::pair<const void*, std::function<void()>>> references; // resources the batch writes to, and what to do once it retires
+        };
+
+        // Writes the data to the ring (or to a dedicated buffer) and begins recording the batch which copies from it
+        bool Reserve(const uint64_t size, const uint64_t alignment, const std::function<void(std::byte*)>& write, void** buffer, uint64_t* offset);
+        bool BatchBegin();
+        bool Submit();
+        void Retire(const bool wait_for_oldest);
+        void DestroyBatch(Batch& batch);
+
+        RHI_RingAllocator m_allocator;
+        Batch m_batch;
+        std::deque<Batch> m_batches_in_flight;
+        std::vector<Batch> m_batches_free;
+        std::vector<std::pair<const void*, std::function<void()>>> m_on_retire; // run by Tick(), so resources only flip to ready on the thread which renders
+        std::mutex m_mutex;
+
+        void* m_buffer                          = nullptr;
+        void* m_buffer_allocation               = nullptr;
+        void* m_buffer_mapped                   = nullptr;
+        void* m_semaphore                       = nullptr;
+        uint64_t m_value_submitted              = 0;
+        uint64_t m_value_completed              = 0;
+        std::atomic<uint64_t> m_value_wait      = 0;
+        std::atomic<uint64_t> m_bytes_uploaded  = 0;
+        bool m_initialized                      = false;
+
+        // Dependencies
+        RHI_Device* m_rhi_device;
+    };
+}
@@ -22,16 +22,189 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ================================
 #include "RHI_Texture.h"
 #include "RHI_Device.h"
+#include "RHI_BindlessTable.h"
 #include "../IO/FileStream.h"
 #include "../Rendering/Renderer.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/Import/ImageImporter.h"
+#include "../Resource/Import/ImportDatabase.h"
+#include "../Math/MathHelper.h"
 //===========================================
 
 //= NAMESPACES =====
 using namespace std;
 //==================
 
+namespace Spartan::texture_file
+{
+    // Layout, all offsets are from the start of the file:
+    // header | subresource table (offset and size of every mip of every array slice) | payloads, 16 byte aligned | resource path
+    static const uint32_t magic             = 0x58455453; // "STEX"
+    static const uint32_t version_current   = 1;
+    static const uint64_t payload_alignment = 16;
+
+    struct header
+    {
+        uint32_t magic              = texture_file::magic;
+        uint32_t version            = version_current;
+        uint32_t width              = 0;
+        uint32_t height             = 0;
+        uint32_t array_size         = 1;
+        uint32_t mip_count          = 0;    // per array slice
+        uint32_t format             = 0;
+        uint32_t bits_per_channel   = 0;
+        uint32_t channel_count      = 0;
+        uint32_t flags              = 0;
+        uint32_t id                 = 0;
+        uint32_t reserved           = 0;
+        uint64_t table_offset       = 0;
+        uint64_t path_offset        = 0;    // a string, after the payloads so that it can change without moving them
+    };
+    static_assert(sizeof(header) == 64, "The header is part of the file format, its size can't change");
+
+    struct subresource
+    {
+        uint64_t offset = 0;
+        uint64_t size   = 0;
+    };
+
+    inline uint64_t align(const uint64_t value)
+    {
+        return (value + payload_alignment - 1) & ~(payload_alignment - 1);
+    }
+
+    inline bool read_header(FileStream* file, header& file_header)
+    {
+        if (file->GetSize() < sizeof(header))
+            return false;
+
+        file->Seek(0);
+        file->Read(reinterpret_cast<std::byte*>(&file_header), sizeof(header));
+        return file_header.magic == magic && file_header.version <= version_current;
+    }
+
+    inline bool read_table(FileStream* file, const header& file_header, vector<subresource>& table)
+    {
+        const uint64_t count = static_cast<uint64_t>(file_header.array_size) * file_header.mip_count;
+        if (file_header.table_offset + count * sizeof(subresource) > file->GetSize())
+            return false;
+
+        table.resize(count);
+        file->Seek(file_header.table_offset);
+        file->Read(reinterpret_cast<std::byte*>(table.data()), count * sizeof(subresource));
+        return true;
+    }
+
+    inline header make_header(const RHI_Texture* texture)
+    {
+        header file_header;
+        file_header.width               = texture->GetWidth();
+        file_header.height              = texture->GetHeight();
+        file_header.array_size          = texture->GetArraySize();
+        file_header.format              = static_cast<uint32_t>(texture->GetFormat());
+        file_header.bits_per_channel    = texture->GetBitsPerChannel();
+        file_header.channel_count       = texture->GetChannelCount();
+        file_header.flags               = texture->GetFlags();
+        file_header.id                  = texture->GetId();
+
+        return file_header;
+    }
+
+    inline bool write(const string& file_path, header file_header, const vector<vector<std::byte>>& data, const string& resource_path)
+    {
+        if (file_header.array_size == 0 || data.size() % file_header.array_size != 0)
+        {
+            LOG_ERROR("%d subresources can't be split into %d array slices", static_cast<uint32_t>(data.size()), file_header.array_size);
+            return false;
+        }
+
+        // Lay everything out first, so that the file is written front to back
+        file_header.magic           = magic;
+        file_header.version         = version_current;
+        file_header.mip_count       = static_cast<uint32_t>(data.size()) / file_header.array_size;
+        file_header.table_offset    = sizeof(header);
+        vector<subresource> table(data.size());
+        uint64_t position = align(file_header.table_offset + table.size() * sizeof(subresource));
+        for (uint32_t i = 0; i < static_cast<uint32_t>(data.size()); i++)
+        {
+            table[i].offset = position;
+            table[i].size   = data[i].size();
+            position        = align(position + table[i].size);
+        }
+        file_header.path_offset = position;
+
+        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        if (!file->IsOpen())
+            return false;
+
+        file->Write(reinterpret_cast<const std::byte*>(&file_header), sizeof(header));
+        file->Write(reinterpret_cast<const std::byte*>(table.data()), table.size() * sizeof(subresource));
+        for (uint32_t i = 0; i < static_cast<uint32_t>(data.size()); i++)
+        {
+            file->Seek(table[i].offset);
+            file->Write(data[i].data(), table[i].size);
+        }
+        file->Seek(file_header.path_offset);
+        file->Write(resource_path);
+
+        return true;
+    }
+
+    // Files which predate the header: byte count, mip count, every mip preceded by its size, the properties and
+    // possibly a table of mip offsets, which is ignored. They are rewritten once, the first time they are loaded.
+    inline bool migrate(const string& file_path)
+    {
+        header file_header;
+        vector<vector<std::byte>> data;
+        string resource_path;
+        {
+            auto file = make_unique<FileStream>(file_path, FileStream_Read);
+            if (!file->IsOpen())
+                return false;
+
+            if (read_header(file.get(), file_header))
+                return true;
+
+            if (file_header.magic == magic)
+            {
+                LOG_ERROR("\"%s\" is version %d, this build reads up to version %d", file_path.c_str(), file_header.version, version_current);
+                return false;
+            }
+
+            file_header = header();
+            file->Seek(0);
+            const uint32_t byte_count   = file->ReadAs<uint32_t>();
+            const uint32_t mip_count    = file->ReadAs<uint32_t>();
+            if (sizeof(uint32_t) * (2 + static_cast<uint64_t>(mip_count)) + byte_count > file->GetSize())
+            {
+                LOG_ERROR("\"%s\" is not a texture file", file_path.c_str());
+                return false;
+            }
+
+            data.resize(mip_count);
+            for (vector<std::byte>& mip : data)
+            {
+                file->Read(&mip);
+            }
+
+            file->Read(&file_header.bits_per_channel);
+            file->Read(&file_header.width);
+            file->Read(&file_header.height);
+            file->Read(&file_header.format);
+            file->Read(&file_header.channel_count);
+            file_header.flags   = file->ReadAs<uint16_t>();
+            file_header.id      = file->ReadAs<uint32_t>();
+            resource_path       = file->ReadAs<string>();
+        }
+
+        if (!write(file_path, file_header, data, resource_path))
+            return false;
+
+        LOG_INFO("Migrated \"%s\" to version %d", file_path.c_str(), version_current);
+        return true;
+    }
+}
+
 namespace Spartan
 {
 	RHI_Texture::RHI_Texture(Context* context) : IResource(context, Resource_Texture)
@@ -47,63 +220,50 @@ namespace Spartan
 
 	bool RHI_Texture::SaveToFile(const string& file_path)
 	{
-		// Check to see if the file already exists (if so, get the byte count)
-		uint32_t byte_count = 0;
-		{
-			if (FileSystem::Exists(file_path))
-			{
-				auto file = make_unique<FileStream>(file_path, FileStream_Read);
-				if (file->IsOpen())
-				{
-					file->Read(&byte_count);
-				}
-			}
-		}
+        texture_file::header file_header = texture_file::make_header(this);
 
-		auto append = true;
-		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
-		if (!file->IsOpen())
-			return false;
+        // The pixel data is freed once saved or uploaded, in which case it stays where it is
+        // in the file and only the header and the path (which follows the payloads) are rewritten
+        if (m_data.empty())
+        {
+            texture_file::header file_header_existing;
+            {
+                if (!FileSystem::Exists(file_path) || !texture_file::migrate(file_path))
+                {
+                    LOG_ERROR("There is no data to save to \"%s\"", file_path.c_str());
+                    return false;
+                }
 
-		// If the existing file has a byte count but we 
-		// hold no data, don't overwrite the file's bytes.
-		if (byte_count != 0 && m_data.empty())
-		{
-			file->Skip
-			(
-				sizeof(uint32_t) +	// byte count
-				sizeof(uint32_t) +	// mipmap count
-				byte_count			// bytes
-			);
-		}
-		else
-		{
-			byte_count = GetByteCount();
-
-			// Write byte count
-			file->Write(byte_count);
-			// Write mipmap count
-			file->Write(static_cast<uint32_t>(m_data.size()));
-			// Write bytes
-			for (auto& mip : m_data)
-			{
-				file->Write(mip);
-			}
+                auto file = make_unique<FileStream>(file_path, FileStream_Read);
+                if (!file->IsOpen() || !texture_file::read_header(file.get(), file_header_existing))
+                    return false;
+            }
 
-			// The bytes have been saved, so we can now free some memory
-			m_data.clear();
-			m_data.shrink_to_fit();
-		}
+            file_header.array_size      = file_header_existing.array_size;
+            file_header.mip_count       = file_header_existing.mip_count;
+            file_header.table_offset    = file_header_existing.table_offset;
+            file_header.path_offset     = file_header_existing.path_offset;
 
-		// Write properties
-		file->Write(m_bits_per_channel);
-		file->Write(m_width);
-		file->Write(m_height);
-        file->Write(static_cast<uint32_t>(m_format));
-		file->Write(m_channel_count);
-		file->Write(m_flags);
-		file->Write(GetId());
-		file->Write(GetResourceFilePath());
+            // Reading as well as writing opens the file without truncating it
+            auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Read);
+            if (!file->IsOpen())
+                return false;
+
+            file->Write(reinterpret_cast<const std::byte*>(&file_header), sizeof(texture_file::header));
+            file->Seek(file_header.path_offset);
+            file->Write(GetResourceFilePath());
+
+            return true;
+        }
+
+        if (!texture_file::write(file_path, file_header, m_data, GetResourceFilePath()))
+            return false;
+
+        m_mip_levels_total = static_cast<uint32_t>(m_data.size()) / m_array_size;
+
+        // The bytes have been saved, so we can now free some memory
+        m_data.clear();
+        m_data.shrink_to_fit();
 
 		return true;
 	}
@@ -119,7 +279,8 @@ namespace Spartan
 
 		m_data.clear();
 		m_data.shrink_to_fit();
-		m_load_state = LoadState_Started;
+        m_mip_first     = 0;
+		m_load_state    = LoadState_Started;
 
 		// Load from disk
 		auto texture_data_loaded = false;		
@@ -140,7 +301,8 @@ namespace Spartan
 			return false;
 		}
 
-        m_mip_levels = static_cast<uint32_t>(m_data.size());
+        m_mip_levels        = static_cast<uint32_t>(m_data.size());
+        m_mip_levels_total  = m_mip_first + m_mip_levels;
 
 		// Create GPU resource
         if (!m_context->GetSubsystem<Renderer>()->GetRhiDevice()->IsInitialized() || !CreateResourceGpu())
@@ -164,11 +326,8 @@ namespace Spartan
             m_size_gpu = 0;
             for (uint8_t mip_index = 0; mip_index < m_mip_levels; mip_index++)
             {
-                const uint32_t mip_width  = m_width >> mip_index;
-                const uint32_t mip_height = m_height >> mip_index;
-
                 m_size_cpu += mip_index < m_data.size() ? m_data[mip_index].size() * sizeof(std::byte) : 0;
-                m_size_gpu += mip_width * mip_height * (m_bits_per_channel / 8);
+                m_size_gpu += GetMipSize(m_mip_first + mip_index);
             }
         }
 
@@ -188,59 +347,164 @@ namespace Spartan
 
     vector<std::byte> RHI_Texture::GetMipmap(const uint32_t index)
     {
-        vector<std::byte> data;
-
         // Use existing data, if it's there
-        if (index < m_data.size())
+        if (index >= m_mip_first && index - m_mip_first < m_data.size())
+            return m_data[index - m_mip_first];
+
+        // Else attempt to load the data
+        vector<vector<std::byte>> mips;
+        if (!LoadMipsFromFile(GetResourceFilePathNative(), index, mips) || mips.empty())
         {
-            data = m_data[index];
+            LOG_ERROR("Unable to retreive data");
+            return vector<std::byte>();
         }
-        // Else attempt to load the data
-        else
+
+        return move(mips.front());
+    }
+
+    bool RHI_Texture::LoadMipsFromFile(const string& file_path, const uint32_t mip_first, vector<vector<std::byte>>& mips)
+    {
+        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        if (!file->IsOpen())
+            return false;
+
+        texture_file::header file_header;
+        vector<texture_file::subresource> table;
+        if (!texture_file::read_header(file.get(), file_header) || !texture_file::read_table(file.get(), file_header, table) || mip_first >= file_header.mip_count)
         {
-            auto file = make_unique<FileStream>(GetResourceFilePathNative(), FileStream_Read);
-            if (file->IsOpen())
-            {
-                auto byte_count = file->ReadAs<uint32_t>();
-                const auto mip_count  = file->ReadAs<uint32_t>();
+            LOG_ERROR("\"%s\" doesn't have mip %d", file_path.c_str(), mip_first);
+            return false;
+        }
 
-                if (index < mip_count)
-                {
-                    for (uint32_t i = 0; i <= index; i++)
-                    {
-                        file->Read(&data);
-                    }
-                }
-                else
-                {
-                    LOG_ERROR("Invalid index");
-                }
-                file->Close();
-            }
-            else
-            {
-                LOG_ERROR("Unable to retreive data");
-            }
+        // Of the first array slice
+        mips.resize(file_header.mip_count - mip_first);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(mips.size()); i++)
+        {
+            const texture_file::subresource& subresource = table[mip_first + i];
+            mips[i].resize(subresource.size);
+            file->Seek(subresource.offset);
+            file->Read(mips[i].data(), subresource.size);
+        }
+
+        return true;
+    }
+
+    void RHI_Texture::SwapResourceGpu(RHI_Texture* texture, const uint32_t mip_first)
+    {
+        if (!texture || mip_first + texture->m_mip_levels != m_mip_levels_total)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
         }
 
-        return data;
+        swap(m_resource,         texture->m_resource);
+        swap(m_resource_view[0], texture->m_resource_view[0]);
+        swap(m_resource_view[1], texture->m_resource_view[1]);
+        swap(m_layout,           texture->m_layout);
+        swap(m_mip_levels,       texture->m_mip_levels);
+        swap(m_data,             texture->m_data);
+        m_mip_first = mip_first;
+
+        m_size_gpu = 0;
+        for (uint32_t mip_index = 0; mip_index < m_mip_levels; mip_index++)
+        {
+            m_size_gpu += GetMipSize(m_mip_first + mip_index);
+        }
+
+        // The bindless slot still points to the previous view, the texture gets a new one when it's next used
+        if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
+        {
+            bindless_table->RemoveTexture(this);
+        }
+    }
+
+    bool RHI_Texture::IsStreamable() const
+    {
+        return
+            m_resource_type == Resource_Texture2d                               &&
+            IsSampled() && !IsRenderTargetColor() && !IsRenderTargetDepthStencil() && !IsRenderTargetCompute() &&
+            m_array_size == 1                                                   &&
+            m_mip_levels_total > TextureStreamer::GetMipTail(m_width, m_height, m_mip_levels_total) &&
+            FileSystem::IsEngineTextureFile(GetResourceFilePathNative());
+    }
+
+    uint32_t RHI_Texture::GetWidthResident() const
+    {
+        return m_mip_first == 0 ? m_width : Math::Helper::Max(m_width >> m_mip_first, 1u);
+    }
+
+    uint32_t RHI_Texture::GetHeightResident() const
+    {
+        return m_mip_first == 0 ? m_height : Math::Helper::Max(m_height >> m_mip_first, 1u);
+    }
+
+    uint32_t RHI_Texture::GetRowPitch(const uint32_t mip_index) const
+    {
+        const uint32_t mip_width = Math::Helper::Max(m_width >> mip_index, 1u);
+
+        if (rhi_format_is_block_compressed(m_format))
+            return ((mip_width + 3) / 4) * rhi_format_block_size(m_format);
+
+        return mip_width * GetBytesPerPixel();
+    }
+
+    uint64_t RHI_Texture::GetMipSize(const uint32_t mip_index) const
+    {
+        const uint32_t mip_height   = Math::Helper::Max(m_height >> mip_index, 1u);
+        const uint32_t rows         = rhi_format_is_block_compressed(m_format) ? (mip_height + 3) / 4 : mip_height;
+
+        return static_cast<uint64_t>(GetRowPitch(mip_index)) * rows;
     }
 
     bool RHI_Texture::LoadFromFile_ForeignFormat(const string& file_path, const bool generate_mipmaps)
 	{
+		ResourceCache* resource_cache   = m_context->GetSubsystem<ResourceCache>();
+		ImageImporter* importer         = resource_cache->GetImageImporter();
+		ImportDatabase* import_database = resource_cache->GetImportDatabase();
+
+		// If the same image was imported with the same settings before, load what that import produced
+		const uint64_t import_key = import_database ? import_database->GetKey(file_path, importer->GetSettings(this, generate_mipmaps)) : 0;
+		vector<string> products;
+		if (import_database && import_database->Find(import_key, products))
+		{
+			// Everything the texture is identified by stays as it is, it's only the pixels that are reused
+			const uint32_t id = GetId();
+			if (LoadFromFile_NativeFormat(products.front(), false))
+			{
+				SetId(id);
+				SetResourceFilePath(file_path);
+				return true;
+			}
+
+			LOG_WARNING("Failed to load the previous import of \"%s\", importing it again", file_path.c_str());
+		}
+
 		// Load texture
-		ImageImporter* importer = m_context->GetSubsystem<ResourceCache>()->GetImageImporter();	
 		if (!importer->Load(file_path, this, generate_mipmaps))
 			return false;
 
 		// Set resource file path so it can be used by the resource cache
 		SetResourceFilePath(file_path);
 
+		// Keep the result, it's saved as is since the data is still needed for the upload
+		if (import_database && import_key != 0)
+		{
+			const string product = import_database->GetProductPath(import_key, EXTENSION_TEXTURE);
+			if (texture_file::write(product, texture_file::make_header(this), m_data, file_path))
+			{
+				import_database->Add(import_key, { product });
+			}
+		}
+
 		return true;
 	}
 
-	bool RHI_Texture::LoadFromFile_NativeFormat(const string& file_path)
+	bool RHI_Texture::LoadFromFile_NativeFormat(const string& file_path, const bool streaming /*= true*/)
 	{
+        // Older files are upgraded in place
+        if (!texture_file::migrate(file_path))
+            return false;
+
 		auto file = make_unique<FileStream>(file_path, FileStream_Read);
 		if (!file->IsOpen())
 			return false;
@@ -248,26 +512,47 @@ namespace Spartan
 		m_data.clear();
 		m_data.shrink_to_fit();
 
-		// Read byte and mipmap count
-		auto byte_count = file->ReadAs<uint32_t>();
-        const auto mip_count  = file->ReadAs<uint32_t>();
+        // Read properties
+        texture_file::header file_header;
+        vector<texture_file::subresource> table;
+        if (!texture_file::read_header(file.get(), file_header) || !texture_file::read_table(file.get(), file_header, table))
+        {
+            LOG_ERROR("\"%s\" is corrupted", file_path.c_str());
+            return false;
+        }
+        m_width             = file_header.width;
+        m_height            = file_header.height;
+        m_array_size        = file_header.array_size;
+        m_format            = static_cast<RHI_Format>(file_header.format);
+        m_bits_per_channel  = file_header.bits_per_channel;
+        m_channel_count     = file_header.channel_count;
+        m_flags             = static_cast<uint16_t>(file_header.flags);
+        SetId(file_header.id);
+        file->Seek(file_header.path_offset);
+        SetResourceFilePath(file->ReadAs<string>());
+
+        // When streaming, only the tail is loaded, the texture streamer brings in the rest as it's needed
+        m_mip_levels_total  = file_header.mip_count;
+        m_mip_first         = 0;
+        if (streaming && m_context->GetSubsystem<Renderer>()->GetOption(Render_TextureStreaming) && IsStreamable())
+        {
+            m_mip_first = TextureStreamer::GetMipTail(m_width, m_height, m_mip_levels_total);
+        }
 
 		// Read bytes
-		m_data.resize(mip_count);
-		for (auto& mip : m_data)
-		{
-			file->Read(&mip);
-		}
-
-		// Read properties
-		file->Read(&m_bits_per_channel);
-		file->Read(&m_width);
-		file->Read(&m_height);
-        file->Read(reinterpret_cast<uint32_t*>(&m_format));
-		file->Read(&m_channel_count);
-		file->Read(&m_flags);
-		SetId(file->ReadAs<uint32_t>());
-		SetResourceFilePath(file->ReadAs<string>());
+        const uint32_t mip_count = m_mip_levels_total - m_mip_first;
+		m_data.resize(static_cast<uint64_t>(m_array_size) * mip_count);
+        for (uint32_t array_index = 0; array_index < m_array_size; array_index++)
+        {
+            for (uint32_t mip_index = 0; mip_index < mip_count; mip_index++)
+            {
+                const texture_file::subresource& subresource    = table[array_index * m_mip_levels_total + m_mip_first + mip_index];
+                vector<std::byte>& data                         = m_data[array_index * mip_count + mip_index];
+                data.resize(subresource.size);
+                file->Seek(subresource.offset);
+                file->Read(data.data(), subresource.size);
+            }
+        }
 
 		return true;
 	}
@@ -290,6 +575,13 @@ namespace Spartan
 			case RHI_Format_R32G32B32A32_Float:	    return 4;
             case RHI_Format_D32_Float:			    return 1;
             case RHI_Format_D32_Float_S8X24_Uint:   return 2;
+            case RHI_Format_BC1_Unorm:              return 4;
+            case RHI_Format_BC3_Unorm:              return 4;
+            case RHI_Format_BC4_Unorm:              return 1;
+            case RHI_Format_BC5_Unorm:              return 2;
+            case RHI_Format_BC7_Unorm:              return 4;
+            case RHI_Format_R16G16_Snorm:           return 2;
+            case RHI_Format_R16G16B16A16_Snorm:     return 4;
 			default:						        return 0;
 		}
 	}
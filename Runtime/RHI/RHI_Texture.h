@@ -67,6 +67,10 @@ namespace Spartan
 		auto GetHeight() const											{ return m_height; }
 		void SetHeight(const uint32_t height)							{ m_height = height; }
 
+        // Size of the first mip the GPU holds, smaller than the texture when the top mips are streamed out
+        uint32_t GetWidthResident() const;
+        uint32_t GetHeightResident() const;
+
 		auto GetGrayscale() const										{ return m_flags & RHI_Texture_Grayscale; }
 		void SetGrayscale(const bool is_grayscale)						{ is_grayscale ? m_flags |= RHI_Texture_Grayscale : m_flags &= ~RHI_Texture_Grayscale; }
 
@@ -84,15 +88,29 @@ namespace Spartan
 		auto GetFormat() const											{ return m_format; }
 		void SetFormat(const RHI_Format format)							{ m_format = format; }
 
+        // Block compression to apply when importing an image, the actual format is decided by the image
+        auto GetCompression() const                                     { return m_compression; }
+        void SetCompression(const RHI_Texture_Compression compression)  { m_compression = compression; }
+
 		// Data
         bool HasData() const                                            { return !m_data.empty(); }
 		const auto& GetData() const										{ return m_data; }		
+        auto& GetData()                                                 { return m_data; }
         void SetData(const std::vector<std::vector<std::byte>>& data)   { m_data = data; }
         auto AddMipmap()                                                { return &m_data.emplace_back(std::vector<std::byte>()); }
         bool HasMipmaps() const                                         { return !m_data.empty();  }
-        uint32_t GetMiplevels() const                                   { return m_mip_levels; }
+        uint32_t GetMiplevels() const                                   { return m_mip_levels; }        // on the GPU, starting at GetMipFirst()
+        uint32_t GetMiplevelsTotal() const                              { return m_mip_levels_total; }  // in the file (or the imported image)
+        uint32_t GetMipFirst() const                                    { return m_mip_first; }
         std::vector<std::byte>* GetData(uint32_t mipmap_index);
         std::vector<std::byte> GetMipmap(uint32_t index);
+        uint32_t GetRowPitch(const uint32_t mip_index) const; // bytes per row of pixels, or per row of 4x4 blocks when block compressed
+        uint64_t GetMipSize(const uint32_t mip_index) const;
+
+        // Streaming, mip indices are absolute (0 is the full size)
+        static bool LoadMipsFromFile(const std::string& file_path, uint32_t mip_first, std::vector<std::vector<std::byte>>& mips);
+        void SwapResourceGpu(RHI_Texture* texture, uint32_t mip_first); // takes the GPU resource of a texture which holds mips [mip_first, total) of this one, and gives it the current one
+        bool IsStreamable() const;
 
         // Binding type
         bool IsSampled()                    const { return m_flags & RHI_Texture_ShaderView; }
@@ -125,7 +143,7 @@ namespace Spartan
         void* Get_Resource_View_RenderTarget(const uint32_t i = 0)          const { return i < m_resource_view_renderTarget.size() ? m_resource_view_renderTarget[i] : nullptr; }
 
 	protected:
-		bool LoadFromFile_NativeFormat(const std::string& file_path);
+		bool LoadFromFile_NativeFormat(const std::string& file_path, bool streaming = true);
 		bool LoadFromFile_ForeignFormat(const std::string& file_path, bool generate_mipmaps);
 		static uint32_t GetChannelCountFromFormat(RHI_Format format);
         virtual bool CreateResourceGpu() { LOG_ERROR("Function not implemented by API"); return false; }
@@ -136,7 +154,10 @@ namespace Spartan
 		uint32_t m_channel_count	= 4;
         uint32_t m_array_size       = 1;
         uint32_t m_mip_levels       = 1;
+        uint32_t m_mip_levels_total = 1;
+        uint32_t m_mip_first        = 0;
 		RHI_Format m_format		    = RHI_Format_Undefined;
+        RHI_Texture_Compression m_compression = RHI_Texture_Compression_None;
         RHI_Image_Layout m_layout   = RHI_Image_Undefined;
         uint16_t m_flags	        = 0;
 		RHI_Viewport m_viewport;
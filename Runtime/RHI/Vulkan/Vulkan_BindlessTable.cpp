@@ -0,0 +1,276 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_BindlessTable.h"
+#include "../RHI_Device.h"
+#include "../RHI_Texture.h"
+#include "../../Math/MathHelper.h"
+#include <array>
+#include <cstring>
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_BindlessTable::RHI_BindlessTable(RHI_Device* rhi_device, const uint32_t texture_capacity)
+    {
+        m_rhi_device        = rhi_device;
+        m_texture_capacity  = texture_capacity;
+        RHI_Context* rhi_context = rhi_device->GetContextRhi();
+
+        if (!rhi_context->descriptor_indexing)
+        {
+            LOG_INFO("Descriptor indexing is not supported, materials will bind their textures individually");
+            return;
+        }
+
+        // The whole table is visible to the pixel shader, so both limits have to fit it
+        {
+            VkPhysicalDeviceVulkan12Properties properties_12 = {};
+            properties_12.sType                              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+            VkPhysicalDeviceProperties2 properties_2    = {};
+            properties_2.sType                          = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties_2.pNext                          = &properties_12;
+            vkGetPhysicalDeviceProperties2(rhi_context->device_physical, &properties_2);
+
+            const uint32_t limit = Math::Helper::Min(properties_12.maxDescriptorSetUpdateAfterBindSampledImages, properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages);
+            if (limit < m_texture_capacity)
+            {
+                LOG_INFO("The device can only index %d textures, materials will bind their textures individually", limit);
+                return;
+            }
+        }
+
+        // Layout, textures can be added while the set is in use and the ones which were never added are never read
+        {
+            array<VkDescriptorSetLayoutBinding, 3> bindings = {};
+            bindings[0].binding         = 0;
+            bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            bindings[0].descriptorCount = m_texture_capacity;
+            bindings[0].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+            bindings[1].binding         = 1;
+            bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[1].descriptorCount = 1;
+            bindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+            bindings[2].binding         = 2;
+            bindings[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[2].descriptorCount = 1;
+            bindings[2].stageFlags      = VK_SHADER_STAGE_VERTEX_BIT;
+
+            array<VkDescriptorBindingFlags, 3> binding_flags =
+            {
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+                0,
+                0
+            };
+
+            VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info  = {};
+            binding_flags_info.sType                                        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            binding_flags_info.bindingCount                                 = static_cast<uint32_t>(binding_flags.size());
+            binding_flags_info.pBindingFlags                                = binding_flags.data();
+
+            VkDescriptorSetLayoutCreateInfo create_info = {};
+            create_info.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            create_info.pNext                           = &binding_flags_info;
+            create_info.flags                           = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            create_info.bindingCount                    = static_cast<uint32_t>(bindings.size());
+            create_info.pBindings                       = bindings.data();
+
+            if (!vulkan_utility::error::check(vkCreateDescriptorSetLayout(rhi_context->device, &create_info, nullptr, reinterpret_cast<VkDescriptorSetLayout*>(&m_descriptor_set_layout))))
+                return;
+
+            vulkan_utility::debug::set_name(static_cast<VkDescriptorSetLayout>(m_descriptor_set_layout), "bindless_table");
+        }
+
+        // Pool
+        {
+            array<VkDescriptorPoolSize, 2> pool_sizes = {};
+            pool_sizes[0].type              = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            pool_sizes[0].descriptorCount   = m_texture_capacity;
+            pool_sizes[1].type              = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            pool_sizes[1].descriptorCount   = 2; // materials and instances
+
+            VkDescriptorPoolCreateInfo create_info  = {};
+            create_info.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            create_info.flags                       = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+            create_info.poolSizeCount               = static_cast<uint32_t>(pool_sizes.size());
+            create_info.pPoolSizes                  = pool_sizes.data();
+            create_info.maxSets                     = 1;
+
+            if (!vulkan_utility::error::check(vkCreateDescriptorPool(rhi_context->device, &create_info, nullptr, reinterpret_cast<VkDescriptorPool*>(&m_descriptor_pool))))
+                return;
+        }
+
+        // Set
+        {
+            VkDescriptorSetAllocateInfo allocate_info   = {};
+            allocate_info.sType                         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocate_info.descriptorPool                = static_cast<VkDescriptorPool>(m_descriptor_pool);
+            allocate_info.descriptorSetCount            = 1;
+            allocate_info.pSetLayouts                   = reinterpret_cast<VkDescriptorSetLayout*>(&m_descriptor_set_layout);
+
+            if (!vulkan_utility::error::check(vkAllocateDescriptorSets(rhi_context->device, &allocate_info, reinterpret_cast<VkDescriptorSet*>(&m_descriptor_set))))
+                return;
+
+            vulkan_utility::debug::set_name(static_cast<VkDescriptorSet>(m_descriptor_set), "bindless_table");
+        }
+
+        m_initialized = true;
+    }
+
+    RHI_BindlessTable::~RHI_BindlessTable()
+    {
+        // The device is idle by now
+        RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+
+        if (m_material_mapped)
+        {
+            vmaUnmapMemory(rhi_context->allocator, static_cast<VmaAllocation>(m_material_allocation));
+            m_material_mapped = nullptr;
+        }
+        vulkan_utility::buffer::destroy(m_material_buffer);
+
+        if (m_instance_mapped)
+        {
+            vmaUnmapMemory(rhi_context->allocator, static_cast<VmaAllocation>(m_instance_allocation));
+            m_instance_mapped = nullptr;
+        }
+        vulkan_utility::buffer::destroy(m_instance_buffer);
+
+        if (m_descriptor_pool)
+        {
+            vkDestroyDescriptorPool(rhi_context->device, static_cast<VkDescriptorPool>(m_descriptor_pool), nullptr);
+            m_descriptor_pool   = nullptr;
+            m_descriptor_set    = nullptr;
+        }
+
+        if (m_descriptor_set_layout)
+        {
+            vkDestroyDescriptorSetLayout(rhi_context->device, static_cast<VkDescriptorSetLayout>(m_descriptor_set_layout), nullptr);
+            m_descriptor_set_layout = nullptr;
+        }
+    }
+
+    bool RHI_BindlessTable::WriteTexture(const uint32_t index, RHI_Texture* texture)
+    {
+        VkDescriptorImageInfo image_info    = {};
+        image_info.imageView                = static_cast<VkImageView>(texture->Get_Resource_View());
+        image_info.imageLayout              = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write  = {};
+        write.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet                = static_cast<VkDescriptorSet>(m_descriptor_set);
+        write.dstBinding            = 0;
+        write.dstArrayElement       = index;
+        write.descriptorCount       = 1;
+        write.descriptorType        = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        write.pImageInfo            = &image_info;
+
+        vkUpdateDescriptorSets(m_rhi_device->GetContextRhi()->device, 1, &write, 0, nullptr);
+
+        return true;
+    }
+
+    bool RHI_BindlessTable::CreateMaterialBuffer()
+    {
+        RHI_Context* rhi_context    = m_rhi_device->GetContextRhi();
+        const uint64_t size         = static_cast<uint64_t>(m_materials.size()) * m_material_region_count;
+
+        // Persistently mapped, materials rarely change so there is no staging, the regions keep frames in flight apart
+        VmaAllocation allocation = vulkan_utility::buffer::create(m_material_buffer, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, true, nullptr, RHI_Memory_Pool_Upload);
+        if (!allocation)
+            return false;
+
+        m_material_allocation = static_cast<void*>(allocation);
+
+        if (!vulkan_utility::error::check(vmaMapMemory(rhi_context->allocator, allocation, &m_material_mapped)))
+        {
+            vulkan_utility::buffer::destroy(m_material_buffer);
+            return false;
+        }
+        memset(m_material_mapped, 0, static_cast<size_t>(size));
+
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_material_buffer), "bindless_materials");
+
+        VkDescriptorBufferInfo buffer_info  = {};
+        buffer_info.buffer                  = static_cast<VkBuffer>(m_material_buffer);
+        buffer_info.offset                  = 0;
+        buffer_info.range                   = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet write  = {};
+        write.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet                = static_cast<VkDescriptorSet>(m_descriptor_set);
+        write.dstBinding            = 1;
+        write.dstArrayElement       = 0;
+        write.descriptorCount       = 1;
+        write.descriptorType        = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo           = &buffer_info;
+
+        vkUpdateDescriptorSets(rhi_context->device, 1, &write, 0, nullptr);
+
+        return true;
+    }
+
+    bool RHI_BindlessTable::CreateInstanceBuffer()
+    {
+        RHI_Context* rhi_context    = m_rhi_device->GetContextRhi();
+        const uint64_t size         = static_cast<uint64_t>(m_instance_stride) * m_instance_capacity * m_instance_region_count;
+
+        // Persistently mapped, only instances which changed are written and the regions keep frames in flight apart
+        VmaAllocation allocation = vulkan_utility::buffer::create(m_instance_buffer, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, true, nullptr, RHI_Memory_Pool_Upload);
+        if (!allocation)
+            return false;
+
+        m_instance_allocation = static_cast<void*>(allocation);
+
+        if (!vulkan_utility::error::check(vmaMapMemory(rhi_context->allocator, allocation, &m_instance_mapped)))
+        {
+            vulkan_utility::buffer::destroy(m_instance_buffer);
+            return false;
+        }
+
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_instance_buffer), "bindless_instances");
+
+        VkDescriptorBufferInfo buffer_info  = {};
+        buffer_info.buffer                  = static_cast<VkBuffer>(m_instance_buffer);
+        buffer_info.offset                  = 0;
+        buffer_info.range                   = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet write  = {};
+        write.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet                = static_cast<VkDescriptorSet>(m_descriptor_set);
+        write.dstBinding            = 2;
+        write.dstArrayElement       = 0;
+        write.descriptorCount       = 1;
+        write.descriptorType        = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo           = &buffer_info;
+
+        vkUpdateDescriptorSets(rhi_context->device, 1, &write, 0, nullptr);
+
+        return true;
+    }
+}
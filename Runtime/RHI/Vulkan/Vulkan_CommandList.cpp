@@ -25,8 +25,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Pipeline.h"
 #include "../RHI_VertexBuffer.h"
 #include "../RHI_IndexBuffer.h"
+#include "../RHI_IndirectBuffer.h"
 #include "../RHI_DescriptorCache.h"
 #include "../RHI_PipelineCache.h"
+#include "../RHI_StagingRing.h"
+#include "../RHI_BindlessTable.h"
 #include "../RHI_DescriptorSetLayout.h"
 #include "../../Profiling/Profiler.h"
 #include "../../Rendering/Renderer.h"
@@ -232,7 +235,6 @@ namespace Spartan
             if (!vulkan_utility::fence::wait(m_processed_fence))
                 return false;
 
-            m_descriptor_cache->GrowIfNeeded();
             m_cmd_state = RHI_Cmd_List_Idle;
         }
 
@@ -415,6 +417,49 @@ namespace Spartan
         return true;
 	}
 
+    bool RHI_CommandList::DrawIndexedIndirect(RHI_IndirectBuffer* buffer, const uint32_t command_offset, const uint32_t command_count)
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return false;
+        }
+
+        if (!buffer || !buffer->GetResource() || command_count == 0)
+            return false;
+
+        // Ensure correct state before attempting to draw
+        if (!OnDraw())
+            return false;
+
+        const uint32_t stride = static_cast<uint32_t>(sizeof(RHI_DrawIndexedIndirect));
+        VkBuffer vk_buffer    = static_cast<VkBuffer>(buffer->GetResource());
+        VkDeviceSize offset   = static_cast<VkDeviceSize>(command_offset) * stride;
+
+        if (m_rhi_device->GetContextRhi()->multi_draw_indirect)
+        {
+            vkCmdDrawIndexedIndirect(
+                static_cast<VkCommandBuffer>(m_cmd_buffer), // commandBuffer
+                vk_buffer,                                  // buffer
+                offset,                                     // offset
+                command_count,                              // drawCount
+                stride                                      // stride
+            );
+        }
+        else
+        {
+            // Without multiDrawIndirect the draw count has to be 0 or 1
+            for (uint32_t i = 0; i < command_count; i++)
+            {
+                vkCmdDrawIndexedIndirect(static_cast<VkCommandBuffer>(m_cmd_buffer), vk_buffer, offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+            }
+        }
+
+        m_profiler->m_rhi_draw_calls += command_count;
+
+        return true;
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z /*= 1*/) const
     {
         
@@ -554,11 +599,14 @@ namespace Spartan
             texture = m_renderer->GetBlackTexture();
         }
 
-        // If the image has an invalid layout (can happen for a few frames during staging), replace with black
+        // If the image has an invalid layout (happens for a few frames while the staging ring uploads it), replace with black
         if (texture->GetLayout() == RHI_Image_Undefined || texture->GetLayout() == RHI_Image_Preinitialized)
         {
-            LOG_WARNING("Can't set texture without a layout");
             texture = m_renderer->GetBlackTexture();
+
+            // The renderer waits for the black texture when it initializes, if it's not usable it failed to load
+            if (texture->GetLayout() == RHI_Image_Undefined || texture->GetLayout() == RHI_Image_Preinitialized)
+                return;
         }
 
         // Transition to appropriate layout (if needed)
@@ -829,7 +877,7 @@ namespace Spartan
 
         // Descriptor set != null, result = true    -> the descriptor set must be bound
         // Descriptor set == null, result = true    -> the descriptor set is already bound
-        // Descriptor set == null, result = false   -> a new descriptor was needed but we are out of memory (allocates next frame)
+        // Descriptor set == null, result = false   -> a new descriptor set was needed but it couldn't be allocated
 
         void* descriptor_set = nullptr;
         bool result = m_descriptor_cache->GetResource_DescriptorSet(descriptor_set);
@@ -868,6 +916,26 @@ namespace Spartan
             vkCmdBindPipeline(static_cast<VkCommandBuffer>(m_cmd_buffer), VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline);
             m_profiler->m_rhi_bindings_pipeline++;
             m_pipeline_active = true;
+
+            // The bindless table is the second set, it stays bound while the first one changes from draw to draw
+            RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable();
+            if (m_pipeline_state->bindless && bindless_table)
+            {
+                VkDescriptorSet descriptor_set = static_cast<VkDescriptorSet>(bindless_table->GetDescriptorSet());
+                vkCmdBindDescriptorSets
+                (
+                    static_cast<VkCommandBuffer>(m_cmd_buffer),                     // commandBuffer
+                    VK_PIPELINE_BIND_POINT_GRAPHICS,                                // pipelineBindPoint
+                    static_cast<VkPipelineLayout>(m_pipeline->GetPipelineLayout()), // layout
+                    1,                                                              // firstSet
+                    1,                                                              // descriptorSetCount
+                    &descriptor_set,                                                // pDescriptorSets
+                    0,                                                              // dynamicOffsetCount
+                    nullptr                                                         // pDynamicOffsets
+                );
+
+                m_profiler->m_rhi_bindings_descriptor_set++;
+            }
         }
         else
         {
@@ -33,54 +33,49 @@ namespace Spartan
 {
     RHI_DescriptorCache::~RHI_DescriptorCache()
     {
-        if (m_descriptor_pool)
+        for (const shared_ptr<DescriptorPool>& pool : m_pools_frame)
         {
-            // Wait in case the buffer is still in use
-            m_rhi_device->Queue_WaitAll();
+            DestroyDescriptorPool(pool.get());
+        }
 
-            vkDestroyDescriptorPool(m_rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(m_descriptor_pool), nullptr);
-            m_descriptor_pool = nullptr;
+        for (const shared_ptr<DescriptorPool>& pool : m_pools_persistent)
+        {
+            DestroyDescriptorPool(pool.get());
         }
     }
 
-    void RHI_DescriptorCache::SetDescriptorSetCapacity(uint32_t descriptor_set_capacity)
+    void RHI_DescriptorCache::DestroyDescriptorPool(DescriptorPool* pool)
     {
-        if (!m_rhi_device || !m_rhi_device->GetContextRhi())
-        {
-            LOG_ERROR_INVALID_INTERNALS();
+        if (!pool || !pool->resource)
             return;
-        }
-
-        // Wait in case the pool is being used
-        m_rhi_device->Queue_WaitAll();
 
-        // Destroy layouts (and descriptor sets)
-        m_descriptor_set_layouts.clear();
-        m_descriptor_layout_current = nullptr;
+        // Frames in flight might still be using sets from the pool, so it's destroyed once they have completed
+        VkDevice device                     = m_rhi_device->GetContextRhi()->device;
+        VkDescriptorPool descriptor_pool    = static_cast<VkDescriptorPool>(pool->resource);
+        m_rhi_device->DestroyDeferred([device, descriptor_pool]() { vkDestroyDescriptorPool(device, descriptor_pool, nullptr); });
+        pool->resource = nullptr;
+    }
 
-        // Destroy pool
-        if (m_descriptor_pool)
-        {
-            vkDestroyDescriptorPool(m_rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(m_descriptor_pool), nullptr);
-            m_descriptor_pool = nullptr;
-        }
+    void RHI_DescriptorCache::ResetDescriptorPool(const RHI_Device* rhi_device, DescriptorPool* pool)
+    {
+        if (!pool->resource)
+            return;
 
-        // Re-allocate everything with double size
-        CreateDescriptorPool(descriptor_set_capacity);
+        vulkan_utility::error::check(vkResetDescriptorPool(rhi_device->GetContextRhi()->device, static_cast<VkDescriptorPool>(pool->resource), 0));
     }
 
-    bool RHI_DescriptorCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
+    void* RHI_DescriptorCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
     {
-        // Pool sizes
+        // Pool sizes, enough for every set to use the maximum amount of descriptors
         vector<VkDescriptorPoolSize> pool_sizes(4);
         pool_sizes[0].type              = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        pool_sizes[0].descriptorCount   = RHI_Context::descriptor_max_constant_buffers;
+        pool_sizes[0].descriptorCount   = RHI_Context::descriptor_max_constant_buffers * descriptor_set_capacity;
         pool_sizes[1].type              = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-        pool_sizes[1].descriptorCount   = RHI_Context::descriptor_max_constant_buffers_dynamic;
+        pool_sizes[1].descriptorCount   = RHI_Context::descriptor_max_constant_buffers_dynamic * descriptor_set_capacity;
         pool_sizes[2].type              = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        pool_sizes[2].descriptorCount   = RHI_Context::descriptor_max_textures;
+        pool_sizes[2].descriptorCount   = RHI_Context::descriptor_max_textures * descriptor_set_capacity;
         pool_sizes[3].type              = VK_DESCRIPTOR_TYPE_SAMPLER;
-        pool_sizes[3].descriptorCount   = RHI_Context::descriptor_max_samplers;
+        pool_sizes[3].descriptorCount   = RHI_Context::descriptor_max_samplers * descriptor_set_capacity;
 
         // Create info
         VkDescriptorPoolCreateInfo pool_create_info = {};
@@ -91,10 +86,12 @@ namespace Spartan
         pool_create_info.maxSets        = descriptor_set_capacity;
 
         // Pool
-        const auto descriptor_pool = reinterpret_cast<VkDescriptorPool*>(&m_descriptor_pool);
-        if (!vulkan_utility::error::check(vkCreateDescriptorPool(m_rhi_device->GetContextRhi()->device, &pool_create_info, nullptr, descriptor_pool)))
-            return false;
+        VkDescriptorPool descriptor_pool = nullptr;
+        if (!vulkan_utility::error::check(vkCreateDescriptorPool(m_rhi_device->GetContextRhi()->device, &pool_create_info, nullptr, &descriptor_pool)))
+            return nullptr;
+
+        vulkan_utility::debug::set_name(descriptor_pool, m_name.empty() ? "descriptor_cache" : m_name.c_str());
 
-        return true;
+        return static_cast<void*>(descriptor_pool);
     }
 }
@@ -22,7 +22,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==========================
 #include "../RHI_Implementation.h"
 #include "../RHI_DescriptorSetLayout.h"
-#include "../RHI_DescriptorCache.h"
 //=====================================
 
 //= NAMESPACES =====
@@ -40,7 +39,7 @@ namespace Spartan
         }
     }
 
-    void* RHI_DescriptorSetLayout::CreateDescriptorSet(const size_t hash, const RHI_DescriptorCache* descriptor_cache)
+    void* RHI_DescriptorSetLayout::CreateDescriptorSet(void* descriptor_pool)
     {
         // Allocate descriptor set
         void* descriptor_set = nullptr;
@@ -48,7 +47,7 @@ namespace Spartan
             // Allocate info
             VkDescriptorSetAllocateInfo allocate_info   = {};
             allocate_info.sType                         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            allocate_info.descriptorPool                = static_cast<VkDescriptorPool>(descriptor_cache->GetResource_DescriptorSetPool());
+            allocate_info.descriptorPool                = static_cast<VkDescriptorPool>(descriptor_pool);
             allocate_info.descriptorSetCount            = 1;
             allocate_info.pSetLayouts                   = reinterpret_cast<VkDescriptorSetLayout*>(&m_descriptor_set_layout);
 
@@ -61,9 +60,6 @@ namespace Spartan
 
         UpdateDescriptorSet(descriptor_set, m_descriptors);
 
-        // Cache descriptor
-        m_descriptor_sets[hash] = descriptor_set;
-
         return descriptor_set;
     }
 
@@ -21,8 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include "../RHI_Implementation.h"
+#include "../RHI_StagingRing.h"
+#include "../RHI_BindlessTable.h"
 #include "../../Core/Settings.h"
 #include "../../Core/Engine.h"
+#include <array>
 //================================
 
 //= NAMESPACES ===============
@@ -168,6 +171,7 @@ namespace Spartan
 
             // Resource limits
             m_rhi_context->max_texture_dimension_2d = m_rhi_context->device_properties.limits.maxImageDimension2D;
+            m_rhi_context->max_constant_buffer_size = m_rhi_context->device_properties.limits.maxUniformBufferRange;
 
             // Disable profiler if timestamps are not supported
             if (m_rhi_context->profiler && !m_rhi_context->device_properties.limits.timestampComputeAndGraphics)
@@ -197,6 +201,54 @@ namespace Spartan
                 ENABLE_FEATURE(fillModeNonSolid)
                 ENABLE_FEATURE(wideLines)
                 ENABLE_FEATURE(imageCubeArray)
+                ENABLE_FEATURE(multiDrawIndirect)
+                ENABLE_FEATURE(drawIndirectFirstInstance)
+                ENABLE_FEATURE(textureCompressionBC)
+
+                m_rhi_context->multi_draw_indirect          = device_features_enabled.multiDrawIndirect == VK_TRUE;
+                m_rhi_context->draw_indirect_first_instance = device_features_enabled.drawIndirectFirstInstance == VK_TRUE;
+                m_rhi_context->texture_compression_bc       = device_features_enabled.textureCompressionBC == VK_TRUE;
+            }
+
+            // Timeline semaphores and descriptor indexing (core in Vulkan 1.2), uploads are asynchronous and materials are bindless only if they are supported
+            VkPhysicalDeviceVulkan11Features device_features_11_enabled = {};
+            device_features_11_enabled.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+            VkPhysicalDeviceVulkan12Features device_features_12_enabled = {};
+            device_features_12_enabled.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            device_features_12_enabled.pNext                            = &device_features_11_enabled;
+            const bool vulkan_12 = m_rhi_context->api_version >= VK_API_VERSION_1_2 && m_rhi_context->device_properties.apiVersion >= VK_API_VERSION_1_2;
+            if (vulkan_12)
+            {
+                VkPhysicalDeviceVulkan11Features device_features_11 = {};
+                device_features_11.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+                VkPhysicalDeviceVulkan12Features device_features_12 = {};
+                device_features_12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+                device_features_12.pNext                            = &device_features_11;
+
+                VkPhysicalDeviceFeatures2 device_features_2 = {};
+                device_features_2.sType                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                device_features_2.pNext                     = &device_features_12;
+                vkGetPhysicalDeviceFeatures2(m_rhi_context->device_physical, &device_features_2);
+
+                device_features_12_enabled.timelineSemaphore    = device_features_12.timelineSemaphore;
+                m_rhi_context->timeline_semaphores              = device_features_12.timelineSemaphore == VK_TRUE;
+
+                // Textures are added to the bindless table while it's bound, and most of it is never written
+                m_rhi_context->descriptor_indexing =
+                    device_features_12.descriptorIndexing                           == VK_TRUE &&
+                    device_features_12.descriptorBindingPartiallyBound              == VK_TRUE &&
+                    device_features_12.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE;
+
+                if (m_rhi_context->descriptor_indexing)
+                {
+                    device_features_12_enabled.descriptorIndexing                           = VK_TRUE;
+                    device_features_12_enabled.descriptorBindingPartiallyBound              = VK_TRUE;
+                    device_features_12_enabled.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                }
+
+                // Indirect draws pass the instance index through the base instance
+                device_features_11_enabled.shaderDrawParameters = device_features_11.shaderDrawParameters;
+                m_rhi_context->shader_draw_parameters           = device_features_11.shaderDrawParameters == VK_TRUE;
             }
 
             // Determine enabled graphics shader stages
@@ -217,6 +269,7 @@ namespace Spartan
 			VkDeviceCreateInfo create_info = {};
 			{
 				create_info.sType					= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+				create_info.pNext					= vulkan_12 ? &device_features_12_enabled : nullptr;
 				create_info.queueCreateInfoCount	= static_cast<uint32_t>(queue_create_infos.size());
 				create_info.pQueueCreateInfos		= queue_create_infos.data();
 				create_info.pEnabledFeatures		= &device_features_enabled;
@@ -249,6 +302,38 @@ namespace Spartan
         // Initialise the memory allocator
         m_rhi_context->initalise_allocator();
 
+        // Timeline semaphore which tracks graphics submissions, used to know when a frame has completed on the GPU
+        if (m_rhi_context->timeline_semaphores)
+        {
+            VkSemaphoreTypeCreateInfo type_info = {};
+            type_info.sType                     = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            type_info.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+            type_info.initialValue              = 0;
+
+            VkSemaphoreCreateInfo create_info   = {};
+            create_info.sType                   = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            create_info.pNext                   = &type_info;
+
+            if (vulkan_utility::error::check(vkCreateSemaphore(m_rhi_context->device, &create_info, nullptr, reinterpret_cast<VkSemaphore*>(&m_queue_graphics_semaphore))))
+            {
+                vulkan_utility::debug::set_name(static_cast<VkSemaphore>(m_queue_graphics_semaphore), "queue_graphics");
+            }
+        }
+
+        // Staging ring for asynchronous uploads (64 MB, larger uploads get a buffer of their own)
+        m_staging_ring = make_shared<RHI_StagingRing>(this, 64 * 1024 * 1024);
+        if (!m_staging_ring->IsInitialized())
+        {
+            m_staging_ring = nullptr;
+        }
+
+        // Bindless material textures, the renderer binds textures individually without it
+        m_bindless_table = make_shared<RHI_BindlessTable>(this, 4096);
+        if (!m_bindless_table->IsInitialized())
+        {
+            m_bindless_table = nullptr;
+        }
+
 		// Detect and log version
 		string version_major	= to_string(VK_VERSION_MAJOR(app_info.apiVersion));
 		string version_minor	= to_string(VK_VERSION_MINOR(app_info.apiVersion));
@@ -269,6 +354,24 @@ namespace Spartan
         // Release resources
 		if (Queue_Wait(RHI_Queue_Graphics))
 		{
+            m_staging_ring = nullptr;
+
+            // The GPU is idle, destroy everything that was waiting for it
+            for (pair<uint64_t, function<void()>>& entry : m_destroy_queue)
+            {
+                entry.second();
+            }
+            m_destroy_queue.clear();
+
+            // After the destruction queue, since it returns texture slots to the table
+            m_bindless_table = nullptr;
+
+            if (m_queue_graphics_semaphore)
+            {
+                vkDestroySemaphore(m_rhi_context->device, static_cast<VkSemaphore>(m_queue_graphics_semaphore), nullptr);
+                m_queue_graphics_semaphore = nullptr;
+            }
+
             m_rhi_context->destroy_allocator();
 
             if (m_rhi_context->debug)
@@ -297,23 +400,79 @@ namespace Spartan
         return vulkan_utility::error::check(vkQueuePresentKHR(static_cast<VkQueue>(m_rhi_context->queue_graphics), &present_info));
     }
 
-    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* signal_fence /*= nullptr*/, uint32_t wait_flags /*= 0*/) const
+    bool RHI_Device::Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore /*= nullptr*/, void* signal_semaphore /*= nullptr*/, void* signal_fence /*= nullptr*/, uint32_t wait_flags /*= 0*/, const uint64_t signal_semaphore_value /*= 0*/) const
     {
-        VkSemaphore wait_semaphores[]       = { static_cast<VkSemaphore>(wait_semaphore) };
-        VkSemaphore signal_semaphores[]     = { static_cast<VkSemaphore>(signal_semaphore) };
-        VkPipelineStageFlags _wait_flags[]  = { wait_flags };
+        array<VkSemaphore, 2> wait_semaphores       = {};
+        array<VkPipelineStageFlags, 2> _wait_flags  = {};
+        array<uint64_t, 2> wait_values              = {};
+        uint32_t wait_count                         = 0;
+        bool wait_timeline                          = false;
+
+        if (wait_semaphore)
+        {
+            wait_semaphores[wait_count] = static_cast<VkSemaphore>(wait_semaphore);
+            _wait_flags[wait_count]     = wait_flags;
+            wait_count++;
+        }
+
+        // Graphics work waits for the staging ring so that it sees every upload (by the time a texture is used, the wait is already satisfied)
+        if (type == RHI_Queue_Graphics && m_staging_ring)
+        {
+            m_staging_ring->Flush();
+
+            if (const uint64_t value = m_staging_ring->GetWaitValue())
+            {
+                wait_semaphores[wait_count] = static_cast<VkSemaphore>(m_staging_ring->GetSemaphore());
+                _wait_flags[wait_count]     = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+                wait_values[wait_count]     = value;
+                wait_count++;
+                wait_timeline = true;
+            }
+        }
+
+        array<VkSemaphore, 2> signal_semaphores     = {};
+        array<uint64_t, 2> signal_values            = {};
+        uint32_t signal_count                       = 0;
+        bool signal_timeline                        = signal_semaphore_value != 0;
+
+        if (signal_semaphore)
+        {
+            signal_semaphores[signal_count] = static_cast<VkSemaphore>(signal_semaphore);
+            signal_values[signal_count]     = signal_semaphore_value;
+            signal_count++;
+        }
+
+        // The value is assigned under the queue lock so that it increases in submission order
+        lock_guard<mutex> lock(m_queue_mutex);
+
+        // Graphics work signals the next value of the graphics timeline, which is what deferred destruction tracks
+        if (type == RHI_Queue_Graphics && m_queue_graphics_semaphore)
+        {
+            signal_semaphores[signal_count] = static_cast<VkSemaphore>(m_queue_graphics_semaphore);
+            signal_values[signal_count]     = ++m_queue_graphics_value;
+            signal_count++;
+            signal_timeline = true;
+        }
+
+        // Values of timeline semaphores, binary semaphores ignore theirs
+        VkTimelineSemaphoreSubmitInfo timeline_info = {};
+        timeline_info.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.waitSemaphoreValueCount       = wait_count;
+        timeline_info.pWaitSemaphoreValues          = wait_values.data();
+        timeline_info.signalSemaphoreValueCount     = signal_count;
+        timeline_info.pSignalSemaphoreValues        = signal_values.data();
 
         VkSubmitInfo submit_info            = {};
         submit_info.sType                   = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit_info.waitSemaphoreCount      = wait_semaphore ? 1 : 0;
-        submit_info.pWaitSemaphores         = wait_semaphores;
-        submit_info.signalSemaphoreCount    = signal_semaphore ? 1 : 0;
-        submit_info.pSignalSemaphores       = signal_semaphores;
-        submit_info.pWaitDstStageMask       = _wait_flags;
+        submit_info.pNext                   = (wait_timeline || signal_timeline) ? &timeline_info : nullptr;
+        submit_info.waitSemaphoreCount      = wait_count;
+        submit_info.pWaitSemaphores         = wait_semaphores.data();
+        submit_info.signalSemaphoreCount    = signal_count;
+        submit_info.pSignalSemaphores       = signal_semaphores.data();
+        submit_info.pWaitDstStageMask       = _wait_flags.data();
         submit_info.commandBufferCount      = 1;
         submit_info.pCommandBuffers         = reinterpret_cast<VkCommandBuffer*>(&cmd_buffer);
-        
-        lock_guard<mutex> lock(m_queue_mutex);
+
         return vulkan_utility::error::check(vkQueueSubmit(static_cast<VkQueue>(Queue_Get(type)), 1, &submit_info, static_cast<VkFence>(signal_fence)));
     }
 
@@ -322,4 +481,116 @@ namespace Spartan
         lock_guard<mutex> lock(m_queue_mutex);
         return vulkan_utility::error::check(vkQueueWaitIdle(static_cast<VkQueue>(Queue_Get(type))));
     }
+
+    bool RHI_Device::Queue_WaitUploads() const
+    {
+        if (m_staging_ring)
+        {
+            m_staging_ring->Tick(true);
+        }
+
+        return true;
+    }
+
+    void RHI_Device::DestroyDeferred(function<void()>&& destroy) const
+    {
+        // Without a way to tell when a frame completes, wait for the GPU to go idle
+        if (!m_queue_graphics_semaphore)
+        {
+            Queue_WaitAll();
+            destroy();
+            return;
+        }
+
+        lock_guard<mutex> lock(m_destroy_mutex);
+        m_destroy_queue.emplace_back(m_frame_index, move(destroy));
+    }
+
+    void RHI_Device::Tick()
+    {
+        if (!m_queue_graphics_semaphore)
+            return;
+
+        vector<function<void()>> destroy;
+        {
+            lock_guard<mutex> lock(m_destroy_mutex);
+
+            // The current frame ends with the last graphics submission so far
+            uint64_t value_submitted = 0;
+            {
+                lock_guard<mutex> lock_queue(m_queue_mutex);
+                value_submitted = m_queue_graphics_value;
+            }
+            m_frame_ends.emplace_back(m_frame_index++, value_submitted);
+
+            uint64_t value_completed = 0;
+            if (!vulkan_utility::error::check(vkGetSemaphoreCounterValue(m_rhi_context->device, static_cast<VkSemaphore>(m_queue_graphics_semaphore), &value_completed)))
+                return;
+
+            // Latest frame which the GPU has completed
+            uint64_t frame_completed = 0;
+            while (!m_frame_ends.empty() && m_frame_ends.front().second <= value_completed)
+            {
+                frame_completed = m_frame_ends.front().first;
+                m_frame_ends.pop_front();
+            }
+
+            while (!m_destroy_queue.empty() && m_destroy_queue.front().first <= frame_completed)
+            {
+                destroy.emplace_back(move(m_destroy_queue.front().second));
+                m_destroy_queue.pop_front();
+            }
+        }
+
+        // Outside of the lock, destruction can defer more destruction
+        for (function<void()>& destroy_function : destroy)
+        {
+            destroy_function();
+        }
+    }
+
+    bool RHI_Device::GetMemoryStats(const RHI_Memory_Pool pool, RHI_Memory_Stats& stats) const
+    {
+        if (!m_rhi_context || !m_rhi_context->allocator)
+            return false;
+
+        stats.bytes_used        = m_rhi_context->pool_bytes_used[pool];
+        stats.allocation_count  = m_rhi_context->pool_allocations[pool];
+        stats.budget            = m_memory_budgets[pool];
+
+        if (pool != RHI_Memory_Pool_Default)
+        {
+            stats.bytes_reserved    = 0;
+            stats.block_count       = 0;
+
+            if (VmaPool vma_pool = m_rhi_context->pools[pool])
+            {
+                VmaPoolStats pool_stats;
+                vmaGetPoolStats(m_rhi_context->allocator, vma_pool, &pool_stats);
+                stats.bytes_reserved    = pool_stats.size;
+                stats.block_count       = static_cast<uint32_t>(pool_stats.blockCount);
+            }
+
+            return true;
+        }
+
+        // The default pools hold whatever the dedicated pools don't, so subtract those from the total
+        VmaStats vma_stats;
+        vmaCalculateStats(m_rhi_context->allocator, &vma_stats);
+        stats.bytes_reserved    = vma_stats.total.usedBytes + vma_stats.total.unusedBytes;
+        stats.block_count       = vma_stats.total.blockCount;
+
+        for (VmaPool vma_pool : m_rhi_context->pools)
+        {
+            if (vma_pool)
+            {
+                VmaPoolStats pool_stats;
+                vmaGetPoolStats(m_rhi_context->allocator, vma_pool, &pool_stats);
+                stats.bytes_reserved    -= pool_stats.size;
+                stats.block_count       -= static_cast<uint32_t>(pool_stats.blockCount);
+            }
+        }
+
+        return true;
+    }
 }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Device.h"
 #include "../RHI_IndexBuffer.h"
 #include "../RHI_CommandList.h"
+#include "../RHI_StagingRing.h"
 #include "../../Logging/Log.h"
 //================================
 
@@ -35,8 +36,11 @@ namespace Spartan
 {
     void RHI_IndexBuffer::_destroy()
     {
-        // Wait in case the buffer is still in use
-        m_rhi_device->Queue_WaitAll();
+        // Drop any pending upload
+        if (RHI_StagingRing* staging_ring = m_rhi_device->GetStagingRing())
+        {
+            staging_ring->Release(m_buffer);
+        }
 
         // Unmap
         if (m_mapped)
@@ -45,8 +49,8 @@ namespace Spartan
             m_mapped = nullptr;
         }
 
-        // Destroy
-        vulkan_utility::buffer::destroy(m_buffer);
+        // Destroy, once the GPU is done with the frames that could have used it
+        vulkan_utility::buffer::destroy_deferred(m_buffer);
     }
 
 	bool RHI_IndexBuffer::_create(const void* indices)
@@ -72,7 +76,7 @@ namespace Spartan
         {
             VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
             flags |= !m_persistent_mapping ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0;
-            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, flags, true);
+            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, flags, true, nullptr, RHI_Memory_Pool_Upload);
             if (!allocation)
                 return false;
 
@@ -83,36 +87,41 @@ namespace Spartan
         {
             // The reason we use staging is because memory with VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT is not mappable but it's fast, we want that.
 
-            // Create staging/source buffer and copy the indices to it
-            void* staging_buffer = nullptr;
-            VmaAllocation allocation_staging = vulkan_utility::buffer::create(staging_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, indices);
-            if (!allocation_staging)
-                return false;
-
             // Create destination buffer
-            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, nullptr, RHI_Memory_Pool_Geometry);
             if (!allocation)
                 return false;
 
-            // Copy staging buffer to destination buffer
+            // Upload through the staging ring, anything which is submitted to the graphics queue from now on sees the indices
+            RHI_StagingRing* staging_ring = m_rhi_device->GetStagingRing();
+            if (!staging_ring || !staging_ring->UploadBuffer(m_buffer, indices, m_size_gpu))
             {
-                // Create command buffer
-                VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Transfer);
+                // Create staging/source buffer and copy the indices to it
+                void* staging_buffer = nullptr;
+                VmaAllocation allocation_staging = vulkan_utility::buffer::create(staging_buffer, m_size_gpu, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, indices, RHI_Memory_Pool_Staging);
+                if (!allocation_staging)
+                    return false;
 
-                VkBuffer* buffer_vk         = reinterpret_cast<VkBuffer*>(&m_buffer);
-                VkBuffer* buffer_staging_vk = reinterpret_cast<VkBuffer*>(&staging_buffer);
+                // Copy staging buffer to destination buffer
+                {
+                    // Create command buffer
+                    VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Transfer);
 
-                // Copy
-                VkBufferCopy copy_region = {};
-                copy_region.size = m_size_gpu;
-                vkCmdCopyBuffer(cmd_buffer, *buffer_staging_vk, *buffer_vk, 1, &copy_region);
+                    VkBuffer* buffer_vk         = reinterpret_cast<VkBuffer*>(&m_buffer);
+                    VkBuffer* buffer_staging_vk = reinterpret_cast<VkBuffer*>(&staging_buffer);
 
-                // Flush and free command buffer
-                if (!vulkan_utility::command_buffer_immediate::end(RHI_Queue_Transfer))
-                    return false;
+                    // Copy
+                    VkBufferCopy copy_region = {};
+                    copy_region.size = m_size_gpu;
+                    vkCmdCopyBuffer(cmd_buffer, *buffer_staging_vk, *buffer_vk, 1, &copy_region);
+
+                    // Flush and free command buffer
+                    if (!vulkan_utility::command_buffer_immediate::end(RHI_Queue_Transfer))
+                        return false;
 
-                // Destroy staging buffer
-                vulkan_utility::buffer::destroy(staging_buffer);
+                    // Destroy staging buffer
+                    vulkan_utility::buffer::destroy(staging_buffer);
+                }
             }
 
             m_allocation    = static_cast<void*>(allocation);
@@ -0,0 +1,81 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_IndirectBuffer.h"
+#include "../RHI_Device.h"
+//================================
+
+namespace Spartan
+{
+    RHI_IndirectBuffer::RHI_IndirectBuffer(const RHI_Device* rhi_device, const uint32_t command_capacity, const uint32_t region_count)
+    {
+        m_rhi_device        = rhi_device;
+        m_command_capacity  = command_capacity;
+        m_region_count      = region_count;
+
+        // Commands carry the instance index in firstInstance, which the vertex shaders read as their base instance
+        RHI_Context* rhi_context = rhi_device->GetContextRhi();
+        if (!rhi_context->draw_indirect_first_instance || !rhi_context->shader_draw_parameters)
+        {
+            LOG_INFO("Indirect draws can't offset the first instance, draws will be recorded individually");
+            return;
+        }
+
+        // Written every frame, so it stays host visible instead of going through staging
+        const uint64_t size = static_cast<uint64_t>(sizeof(RHI_DrawIndexedIndirect)) * command_capacity * region_count;
+        VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, size, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, true, nullptr, RHI_Memory_Pool_Upload);
+        if (!allocation)
+            return;
+
+        m_allocation = static_cast<void*>(allocation);
+
+        if (!vulkan_utility::error::check(vmaMapMemory(rhi_context->allocator, allocation, &m_mapped)))
+        {
+            vulkan_utility::buffer::destroy(m_buffer);
+            m_allocation = nullptr;
+            return;
+        }
+
+        vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_buffer), "indirect_draws");
+    }
+
+    RHI_IndirectBuffer::~RHI_IndirectBuffer()
+    {
+        if (m_mapped)
+        {
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_allocation));
+            m_mapped = nullptr;
+        }
+
+        // Frames in flight might still read their arguments
+        vulkan_utility::buffer::destroy_deferred(m_buffer);
+    }
+
+    RHI_DrawIndexedIndirect* RHI_IndirectBuffer::GetRegion(const uint32_t region) const
+    {
+        if (!m_mapped || region >= m_region_count)
+            return nullptr;
+
+        return static_cast<RHI_DrawIndexedIndirect*>(m_mapped) + static_cast<size_t>(region) * m_command_capacity;
+    }
+}
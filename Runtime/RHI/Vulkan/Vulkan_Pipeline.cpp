@@ -31,7 +31,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_PipelineState.h"
 #include "../RHI_RasterizerState.h"
 #include "../RHI_DepthStencilState.h"
+#include "../RHI_BindlessTable.h"
 #include "../../Logging/Log.h"
+#include <array>
 //===================================
 
 //= NAMESPACES =====
@@ -40,7 +42,7 @@ using namespace std;
 
 namespace Spartan
 {
-	RHI_Pipeline::RHI_Pipeline(const RHI_Device* rhi_device, RHI_PipelineState& pipeline_state, void* descriptor_set_layout)
+	RHI_Pipeline::RHI_Pipeline(const RHI_Device* rhi_device, RHI_PipelineState& pipeline_state, void* descriptor_set_layout, void* pipeline_cache)
 	{
 		m_rhi_device    = rhi_device;
 		m_state         = pipeline_state;
@@ -281,10 +283,21 @@ namespace Spartan
         // Pipeline layout
 		VkPipelineLayoutCreateInfo pipeline_layout_info	= {};
         { 
+            // Bindless pipelines also get the bindless table, as the second set
+            array<VkDescriptorSetLayout, 2> set_layouts = { static_cast<VkDescriptorSetLayout>(descriptor_set_layout), nullptr };
+            uint32_t set_layout_count                   = 1;
+            if (m_state.bindless)
+            {
+                if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
+                {
+                    set_layouts[set_layout_count++] = static_cast<VkDescriptorSetLayout>(bindless_table->GetDescriptorSetLayout());
+                }
+            }
+
 		    pipeline_layout_info.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		    pipeline_layout_info.pushConstantRangeCount	= 0;
-		    pipeline_layout_info.setLayoutCount			= 1;		
-		    pipeline_layout_info.pSetLayouts			= reinterpret_cast<VkDescriptorSetLayout*>(&descriptor_set_layout);
+		    pipeline_layout_info.setLayoutCount			= set_layout_count;
+		    pipeline_layout_info.pSetLayouts			= set_layouts.data();
 
             if (!vulkan_utility::error::check(vkCreatePipelineLayout(m_rhi_device->GetContextRhi()->device, &pipeline_layout_info, nullptr, reinterpret_cast<VkPipelineLayout*>(&m_pipeline_layout))))
 			    return;
@@ -313,7 +326,7 @@ namespace Spartan
 
             // Create
             auto pipeline = reinterpret_cast<VkPipeline*>(&m_pipeline);
-            vulkan_utility::error::check(vkCreateGraphicsPipelines(m_rhi_device->GetContextRhi()->device, nullptr, 1, &pipeline_info, nullptr, pipeline));
+            vulkan_utility::error::check(vkCreateGraphicsPipelines(m_rhi_device->GetContextRhi()->device, static_cast<VkPipelineCache>(pipeline_cache), 1, &pipeline_info, nullptr, pipeline));
 
             // Name
             vulkan_utility::debug::set_name(*pipeline, m_state.pass_name);
@@ -322,13 +335,17 @@ namespace Spartan
 
 	RHI_Pipeline::~RHI_Pipeline()
 	{
-        // Wait in case the buffer is still in use
-        m_rhi_device->Queue_WaitAll();
-
-		vkDestroyPipeline(m_rhi_device->GetContextRhi()->device, static_cast<VkPipeline>(m_pipeline), nullptr);
-		m_pipeline = nullptr;
+        // Destroyed once the GPU is done with the frames that could have used the pipeline
+        VkDevice device                     = m_rhi_device->GetContextRhi()->device;
+        VkPipeline pipeline                 = static_cast<VkPipeline>(m_pipeline);
+        VkPipelineLayout pipeline_layout    = static_cast<VkPipelineLayout>(m_pipeline_layout);
+        m_rhi_device->DestroyDeferred([device, pipeline, pipeline_layout]()
+        {
+            vkDestroyPipeline(device, pipeline, nullptr);
+            vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+        });
 
-		vkDestroyPipelineLayout(m_rhi_device->GetContextRhi()->device, static_cast<VkPipelineLayout>(m_pipeline_layout), nullptr);
-		m_pipeline_layout = nullptr;
+		m_pipeline          = nullptr;
+		m_pipeline_layout   = nullptr;
 	}
 }
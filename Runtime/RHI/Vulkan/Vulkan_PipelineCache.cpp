@@ -0,0 +1,99 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_PipelineCache.h"
+#include "../RHI_Device.h"
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    bool RHI_PipelineCache::CreateResource(const vector<uint8_t>& data)
+    {
+        VkPipelineCacheCreateInfo create_info   = {};
+        create_info.sType                       = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        create_info.initialDataSize             = data.size();
+        create_info.pInitialData                = data.empty() ? nullptr : data.data();
+
+        // The driver validates the data as well, if it still refuses it, start empty
+        VkPipelineCache* pipeline_cache = reinterpret_cast<VkPipelineCache*>(&m_resource);
+        if (vkCreatePipelineCache(m_rhi_device->GetContextRhi()->device, &create_info, nullptr, pipeline_cache) == VK_SUCCESS)
+            return true;
+
+        if (data.empty())
+            return false;
+
+        LOG_WARNING("Pipeline cache data was rejected by the driver, starting with an empty cache");
+        create_info.initialDataSize = 0;
+        create_info.pInitialData    = nullptr;
+        return vulkan_utility::error::check(vkCreatePipelineCache(m_rhi_device->GetContextRhi()->device, &create_info, nullptr, pipeline_cache));
+    }
+
+    bool RHI_PipelineCache::GetResourceData(vector<uint8_t>* data) const
+    {
+        if (!m_resource)
+            return false;
+
+        const VkDevice device                   = m_rhi_device->GetContextRhi()->device;
+        const VkPipelineCache pipeline_cache = static_cast<VkPipelineCache>(m_resource);
+
+        size_t size = 0;
+        if (!vulkan_utility::error::check(vkGetPipelineCacheData(device, pipeline_cache, &size, nullptr)))
+            return false;
+
+        data->resize(size);
+        return vulkan_utility::error::check(vkGetPipelineCacheData(device, pipeline_cache, &size, data->data()));
+    }
+
+    void RHI_PipelineCache::DestroyResource()
+    {
+        if (!m_resource)
+            return;
+
+        vkDestroyPipelineCache(m_rhi_device->GetContextRhi()->device, static_cast<VkPipelineCache>(m_resource), nullptr);
+        m_resource = nullptr;
+    }
+
+    vector<uint8_t> RHI_PipelineCache::GetDeviceSignature() const
+    {
+        // What the driver itself checks in the cache header, so data from another device or driver never reaches it
+        const VkPhysicalDeviceProperties& properties = m_rhi_device->GetContextRhi()->device_properties;
+
+        vector<uint8_t> signature;
+        const auto append = [&signature](const void* data, const size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            signature.insert(signature.end(), bytes, bytes + size);
+        };
+
+        append(&properties.vendorID,        sizeof(properties.vendorID));
+        append(&properties.deviceID,        sizeof(properties.deviceID));
+        append(&properties.driverVersion,   sizeof(properties.driverVersion));
+        append(properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        return signature;
+    }
+}
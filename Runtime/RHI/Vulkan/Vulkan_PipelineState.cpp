@@ -278,23 +278,26 @@ namespace Spartan
 
     void RHI_PipelineState::DestroyFrameResources()
     {
-        if (!m_rhi_device)
+        if (!m_rhi_device || !m_render_pass)
             return;
 
-        // Wait in case the buffer is still in use by the graphics queue
-        m_rhi_device->Queue_Wait(RHI_Queue_Graphics);
-
-        for (uint32_t i = 0; i < state_max_render_target_count; i++)
+        // Destroyed once the GPU is done with the frames that could have used them
+        VkDevice device             = m_rhi_device->GetContextRhi()->device;
+        VkRenderPass render_pass    = static_cast<VkRenderPass>(m_render_pass);
+        m_rhi_device->DestroyDeferred([device, frame_buffers = m_frame_buffers, render_pass]()
         {
-            if (void* frame_buffer = m_frame_buffers[i])
+            for (void* frame_buffer : frame_buffers)
             {
-                vkDestroyFramebuffer(m_rhi_device->GetContextRhi()->device, static_cast<VkFramebuffer>(frame_buffer), nullptr);
+                if (frame_buffer)
+                {
+                    vkDestroyFramebuffer(device, static_cast<VkFramebuffer>(frame_buffer), nullptr);
+                }
             }
-        }
-        m_frame_buffers.fill(nullptr);
 
-        // Destroy render pass
-        vkDestroyRenderPass(m_rhi_device->GetContextRhi()->device, static_cast<VkRenderPass>(m_render_pass), nullptr);
+            vkDestroyRenderPass(device, render_pass, nullptr);
+        });
+
+        m_frame_buffers.fill(nullptr);
         m_render_pass = nullptr;
     }
 }
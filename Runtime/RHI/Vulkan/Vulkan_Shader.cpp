@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Device.h"
 #include "../RHI_Shader.h"
 #include "../RHI_InputLayout.h"
+#include "../RHI_ShaderCache.h"
 #include "../../Logging/Log.h"
 #include "../../Core/FileSystem.h"
 #include <sstream> 
@@ -234,6 +235,38 @@ namespace Spartan
 			CComPtr<IDxcLibrary> library = nullptr;
 		};
 
+        // Identifies the exact compiler build, so that cached shaders get invalidated when it's updated
+        inline const string& GetVersion()
+        {
+            static const string version = []()
+            {
+                UINT32 major = 0;
+                UINT32 minor = 0;
+                CComPtr<IDxcVersionInfo> version_info = nullptr;
+                if (SUCCEEDED(Instance::Get().compiler->QueryInterface(&version_info)))
+                {
+                    version_info->GetVersion(&major, &minor);
+                }
+                string version = "dxc " + to_string(major) + "." + to_string(minor);
+
+                CComPtr<IDxcVersionInfo2> version_info_2 = nullptr;
+                if (SUCCEEDED(Instance::Get().compiler->QueryInterface(&version_info_2)))
+                {
+                    UINT32 commit_count = 0;
+                    char* commit_hash   = nullptr;
+                    if (SUCCEEDED(version_info_2->GetCommitInfo(&commit_count, &commit_hash)))
+                    {
+                        version += " " + to_string(commit_count) + " " + (commit_hash ? commit_hash : "");
+                        CoTaskMemFree(commit_hash);
+                    }
+                }
+
+                return version;
+            }();
+
+            return version;
+        }
+
 		typedef std::vector<uint8_t> Blob;
 		Blob* IncludeDirectiveLoadCallback(const std::string& include_path)
 		{
@@ -402,31 +435,47 @@ namespace Spartan
 			defines.emplace_back(DxcDefine{ define.first.c_str(), define.second.c_str() });
 		}
 
-		// Get shader source as a buffer
-		CComPtr<IDxcBlobEncoding> shader_blob = nullptr;
-		{
-			HRESULT result;
-			if (is_file)
-			{
-                const auto file_path = FileSystem::StringToWstring(shader);				
-				result = DxShaderCompiler::Instance::Get().library->CreateBlobFromFile(file_path.c_str(), nullptr, &shader_blob);
-			}
-			else // Source
-			{
-				result = DxShaderCompiler::Instance::Get().library->CreateBlobWithEncodingFromPinned(shader.c_str(), static_cast<uint32_t>(shader.size()), CP_UTF8, &shader_blob);
-			}
+        // Look for the compiled shader in the cache, the key covers everything that affects compilation
+        vector<uint8_t> bytecode;
+        uint64_t cache_key = 0;
+        if (m_shader_cache && m_shader_cache->IsEnabled())
+        {
+            string compiler = DxShaderCompiler::GetVersion();
+            for (const LPCWSTR argument : arguments)
+            {
+                compiler += " " + string(CW2A(argument));
+            }
 
-			if (FAILED(result))
-			{
-				LOG_ERROR("Failed to create source buffer.");
-				return nullptr;
-			}
-		}
+            cache_key = RHI_ShaderCache::ComputeKey(shader, m_defines, GetEntryPoint(), GetTargetProfile(), compiler);
+            m_shader_cache->Load(cache_key, &bytecode, &m_descriptors);
+        }
 
-		// Compile
-        const CComPtr<IDxcIncludeHandler> include_handler = new DxShaderCompiler::SpartanIncludeHandler(file_directory);
-		CComPtr<IDxcOperationResult> compilation_result = nullptr;
-		{
+        // Compile
+        if (bytecode.empty())
+        {
+            // Get shader source as a buffer
+            CComPtr<IDxcBlobEncoding> shader_blob = nullptr;
+            {
+                HRESULT result;
+                if (is_file)
+                {
+                    const auto file_path = FileSystem::StringToWstring(shader);				
+                    result = DxShaderCompiler::Instance::Get().library->CreateBlobFromFile(file_path.c_str(), nullptr, &shader_blob);
+                }
+                else // Source
+                {
+                    result = DxShaderCompiler::Instance::Get().library->CreateBlobWithEncodingFromPinned(shader.c_str(), static_cast<uint32_t>(shader.size()), CP_UTF8, &shader_blob);
+                }
+
+                if (FAILED(result))
+                {
+                    LOG_ERROR("Failed to create source buffer.");
+                    return nullptr;
+                }
+            }
+
+            const CComPtr<IDxcIncludeHandler> include_handler = new DxShaderCompiler::SpartanIncludeHandler(file_directory);
+            CComPtr<IDxcOperationResult> compilation_result = nullptr;
             DxShaderCompiler::Instance::Get().compiler->Compile
             (
                 shader_blob,												// shader blob
@@ -439,55 +488,58 @@ namespace Spartan
                 &compilation_result
             );
 
-			if (!DxShaderCompiler::ValidateOperationResult(compilation_result))
-			{
-				LOG_ERROR("Failed to compile %s", shader.c_str());
-				return nullptr;
-			}
-		}
-		
-		// Create shader module
-		CComPtr<IDxcBlob> shader_compiled	= nullptr;
-		VkShaderModule shader_module		= nullptr;
-        if (SUCCEEDED(compilation_result->GetResult(&shader_compiled)))
+            if (!DxShaderCompiler::ValidateOperationResult(compilation_result))
+            {
+                LOG_ERROR("Failed to compile %s", shader.c_str());
+                return nullptr;
+            }
+
+            CComPtr<IDxcBlob> shader_compiled = nullptr;
+            if (FAILED(compilation_result->GetResult(&shader_compiled)))
+            {
+                LOG_ERROR("Failed to get shader buffer.");
+                return nullptr;
+            }
+
+            const uint8_t* shader_compiled_data = static_cast<const uint8_t*>(shader_compiled->GetBufferPointer());
+            bytecode.assign(shader_compiled_data, shader_compiled_data + shader_compiled->GetBufferSize());
+
+            // Reflect shader resources (so that descriptor sets can be created later)
+            m_descriptors.clear();
+            _Reflect(m_shader_type, reinterpret_cast<const uint32_t*>(bytecode.data()), static_cast<uint32_t>(bytecode.size() / 4));
+
+            // Save for the next run
+            if (m_shader_cache && m_shader_cache->IsEnabled())
+            {
+                m_shader_cache->Save(cache_key, bytecode, m_descriptors);
+            }
+        }
+
+        // Create shader module
+        VkShaderModule shader_module = nullptr;
         {
-			VkShaderModuleCreateInfo create_info = {};
-			create_info.sType		= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-			create_info.codeSize	= static_cast<size_t>(shader_compiled->GetBufferSize());
-			create_info.pCode		= reinterpret_cast<const uint32_t*>(shader_compiled->GetBufferPointer());
-	
-			if (vkCreateShaderModule(m_rhi_device->GetContextRhi()->device, &create_info, nullptr, &shader_module) == VK_SUCCESS)
-			{
-				// Reflect shader resources (so that descriptor sets can be created later)
-				_Reflect
-				(
-                    m_shader_type,
-					reinterpret_cast<uint32_t*>(shader_compiled->GetBufferPointer()),
-					static_cast<uint32_t>(shader_compiled->GetBufferSize() / 4)
-				);
+            VkShaderModuleCreateInfo create_info = {};
+            create_info.sType		= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            create_info.codeSize	= bytecode.size();
+            create_info.pCode		= reinterpret_cast<const uint32_t*>(bytecode.data());
 
-                // Create input layout
-                if (m_vertex_type != RHI_Vertex_Type_Unknown)
-                {
-                    if (!m_input_layout->Create(m_vertex_type, nullptr))
-                    {
-                        LOG_ERROR("Failed to create input layout for %s", FileSystem::GetFileNameFromFilePath(shader).c_str());
-                        return nullptr;
-                    }
-                }
-			}
-            else
+            if (vkCreateShaderModule(m_rhi_device->GetContextRhi()->device, &create_info, nullptr, &shader_module) != VK_SUCCESS)
             {
                 LOG_ERROR("Failed to create shader module.");
                 return nullptr;
             }
-		}	
-        else
-		{
-            LOG_ERROR("Failed to get shader buffer.");
-            return nullptr;
-		}
 
-		return static_cast<void*>(shader_module);
+            // Create input layout
+            if (m_vertex_type != RHI_Vertex_Type_Unknown)
+            {
+                if (!m_input_layout->Create(m_vertex_type, nullptr))
+                {
+                    LOG_ERROR("Failed to create input layout for %s", FileSystem::GetFileNameFromFilePath(shader).c_str());
+                    return nullptr;
+                }
+            }
+        }
+
+        return static_cast<void*>(shader_module);
 	}		
 }
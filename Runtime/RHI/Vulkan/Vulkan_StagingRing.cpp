@@ -0,0 +1,457 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "../RHI_Implementation.h"
+#include "../RHI_StagingRing.h"
+#include "../RHI_Device.h"
+#include "../RHI_Texture.h"
+#include "../../Math/MathHelper.h"
+#include <numeric>
+#include <algorithm>
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    RHI_StagingRing::RHI_StagingRing(RHI_Device* rhi_device, const uint64_t size)
+    {
+        m_rhi_device = rhi_device;
+        RHI_Context* rhi_context = rhi_device->GetContextRhi();
+
+        if (!rhi_context->timeline_semaphores)
+        {
+            LOG_INFO("Timeline semaphores are not supported, uploads will be immediate");
+            return;
+        }
+
+        // Timeline semaphore, the transfer queue signals the value of each batch as it completes
+        {
+            VkSemaphoreTypeCreateInfo type_info = {};
+            type_info.sType                     = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            type_info.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+            type_info.initialValue              = 0;
+
+            VkSemaphoreCreateInfo create_info   = {};
+            create_info.sType                   = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            create_info.pNext                   = &type_info;
+
+            if (!vulkan_utility::error::check(vkCreateSemaphore(rhi_context->device, &create_info, nullptr, reinterpret_cast<VkSemaphore*>(&m_semaphore))))
+                return;
+
+            vulkan_utility::debug::set_name(static_cast<VkSemaphore>(m_semaphore), "staging_ring");
+        }
+
+        // Persistently mapped ring (CPU only memory is always host coherent)
+        {
+            VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, nullptr, RHI_Memory_Pool_Staging);
+            if (!allocation)
+                return;
+
+            m_buffer_allocation = static_cast<void*>(allocation);
+
+            if (!vulkan_utility::error::check(vmaMapMemory(rhi_context->allocator, allocation, &m_buffer_mapped)))
+                return;
+
+            vulkan_utility::debug::set_name(static_cast<VkBuffer>(m_buffer), "staging_ring");
+        }
+
+        m_allocator.Reset(size);
+        m_initialized = true;
+    }
+
+    RHI_StagingRing::~RHI_StagingRing()
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // Wait for everything in flight
+        if (m_initialized)
+        {
+            Submit();
+            m_rhi_device->Queue_Wait(RHI_Queue_Transfer);
+            Retire(false);
+        }
+        m_on_retire.clear();
+
+        DestroyBatch(m_batch);
+        for (Batch& batch : m_batches_free)
+        {
+            DestroyBatch(batch);
+        }
+        m_batches_free.clear();
+
+        if (m_buffer_mapped)
+        {
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_buffer_allocation));
+            m_buffer_mapped = nullptr;
+        }
+
+        vulkan_utility::buffer::destroy(m_buffer);
+        vulkan_utility::semaphore::destroy(m_semaphore);
+    }
+
+    bool RHI_StagingRing::UploadBuffer(void* buffer, const void* data, const uint64_t size)
+    {
+        if (!m_initialized || !buffer || !data || size == 0)
+            return false;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        void* staging_buffer    = nullptr;
+        uint64_t offset         = 0;
+        if (!Reserve(size, 16, [data, size](std::byte* mapped) { memcpy(mapped, data, size); }, &staging_buffer, &offset))
+            return false;
+
+        VkBufferCopy copy_region    = {};
+        copy_region.srcOffset       = offset;
+        copy_region.dstOffset       = 0;
+        copy_region.size            = size;
+        vkCmdCopyBuffer(static_cast<VkCommandBuffer>(m_batch.cmd_buffer), static_cast<VkBuffer>(staging_buffer), static_cast<VkBuffer>(buffer), 1, &copy_region);
+
+        // Buffers have no fallback while they are being uploaded, so graphics submissions wait for this batch
+        m_batch.has_buffers = true;
+        m_batch.references.emplace_back(buffer, nullptr);
+        m_bytes_uploaded += size;
+
+        return true;
+    }
+
+    bool RHI_StagingRing::UploadTexture(RHI_Texture* texture, RHI_Image_Layout& texture_layout, const RHI_Image_Layout layout_final)
+    {
+        if (!m_initialized || !texture || !texture->HasData() || !texture->Get_Resource())
+            return false;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        vector<VkBufferImageCopy> buffer_image_copies;
+        const uint64_t size = vulkan_utility::image::get_staging_regions(texture, buffer_image_copies);
+
+        // Offsets have to be a multiple of the texel (or block) size and of 4, the device might also prefer a coarser alignment
+        const uint64_t texel_size           = rhi_format_is_block_compressed(texture->GetFormat()) ? rhi_format_block_size(texture->GetFormat()) : Math::Helper::Max(texture->GetBytesPerPixel(), 1u);
+        const uint64_t alignment_optimal    = m_rhi_device->GetContextRhi()->device_properties.limits.optimalBufferCopyOffsetAlignment;
+        const uint64_t alignment            = lcm(lcm(texel_size, uint64_t(4)), Math::Helper::Max(alignment_optimal, uint64_t(1)));
+
+        void* staging_buffer    = nullptr;
+        uint64_t offset         = 0;
+        if (!Reserve(size, alignment, [texture](std::byte* mapped) { vulkan_utility::image::copy_to_staging(texture, mapped); }, &staging_buffer, &offset))
+            return false;
+
+        for (VkBufferImageCopy& buffer_image_copy : buffer_image_copies)
+        {
+            buffer_image_copy.bufferOffset += offset;
+        }
+
+        VkCommandBuffer cmd_buffer  = static_cast<VkCommandBuffer>(m_batch.cmd_buffer);
+        VkImage image               = static_cast<VkImage>(texture->Get_Resource());
+
+        // Only the transfer stage exists on the transfer queue, so the barriers are spelled out here instead of using image::set_layout()
+        VkImageMemoryBarrier image_barrier              = {};
+        image_barrier.sType                             = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        image_barrier.oldLayout                         = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_barrier.newLayout                         = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        image_barrier.srcQueueFamilyIndex               = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.dstQueueFamilyIndex               = VK_QUEUE_FAMILY_IGNORED;
+        image_barrier.image                             = image;
+        image_barrier.subresourceRange.aspectMask       = vulkan_utility::image::get_aspect_mask(texture);
+        image_barrier.subresourceRange.baseMipLevel     = 0;
+        image_barrier.subresourceRange.levelCount       = texture->GetMiplevels();
+        image_barrier.subresourceRange.baseArrayLayer   = 0;
+        image_barrier.subresourceRange.layerCount       = texture->GetArraySize();
+        image_barrier.srcAccessMask                     = 0;
+        image_barrier.dstAccessMask                     = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+        vkCmdCopyBufferToImage(
+            cmd_buffer,
+            static_cast<VkBuffer>(staging_buffer),
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(buffer_image_copies.size()),
+            buffer_image_copies.data()
+        );
+
+        // The graphics queue waits on the timeline semaphore before it reads, which makes the copy visible
+        image_barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        image_barrier.newLayout     = vulkan_image_layout[layout_final];
+        image_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        image_barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+        m_batch.references.emplace_back(texture->Get_Resource(), [&texture_layout, layout_final]() { texture_layout = layout_final; });
+        m_bytes_uploaded += size;
+
+        return true;
+    }
+
+    void RHI_StagingRing::Flush()
+    {
+        if (!m_initialized)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+        Submit();
+    }
+
+    void RHI_StagingRing::Tick(const bool wait /*= false*/)
+    {
+        if (!m_initialized)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        Submit();
+        Retire(false);
+        while (wait && !m_batches_in_flight.empty())
+        {
+            Retire(true);
+        }
+
+        // Under the lock, so that a resource can't be released while it flips to ready
+        for (const pair<const void*, function<void()>>& reference : m_on_retire)
+        {
+            reference.second();
+        }
+        m_on_retire.clear();
+    }
+
+    void RHI_StagingRing::Release(const void* resource)
+    {
+        if (!m_initialized || !resource)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        const auto references_resource = [resource](const pair<const void*, function<void()>>& reference) { return reference.first == resource; };
+
+        // A recorded copy would write to a destroyed resource, so get it to the GPU while the resource still exists
+        if (any_of(m_batch.references.begin(), m_batch.references.end(), references_resource))
+        {
+            Submit();
+        }
+
+        // The GPU might still be copying to it, so wait for the batches which reference it (rare, a resource released right after its upload)
+        const auto batch_references_resource = [&references_resource](const Batch& batch) { return any_of(batch.references.begin(), batch.references.end(), references_resource); };
+        while (any_of(m_batches_in_flight.begin(), m_batches_in_flight.end(), batch_references_resource))
+        {
+            Retire(true);
+        }
+
+        m_on_retire.erase(remove_if(m_on_retire.begin(), m_on_retire.end(), references_resource), m_on_retire.end());
+    }
+
+    bool RHI_StagingRing::Reserve(const uint64_t size, const uint64_t alignment, const function<void(std::byte*)>& write, void** buffer, uint64_t* offset)
+    {
+        // Too large for the ring, use a dedicated buffer which is destroyed once the batch retires
+        if (size > m_allocator.GetCapacity() / 2)
+        {
+            void* buffer_dedicated = nullptr;
+            VmaAllocation allocation = vulkan_utility::buffer::create(buffer_dedicated, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, nullptr, RHI_Memory_Pool_Staging);
+            if (!allocation)
+                return false;
+
+            void* mapped = nullptr;
+            if (!vulkan_utility::error::check(vmaMapMemory(m_rhi_device->GetContextRhi()->allocator, allocation, &mapped)))
+            {
+                vulkan_utility::buffer::destroy(buffer_dedicated);
+                return false;
+            }
+
+            write(static_cast<std::byte*>(mapped));
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, allocation);
+
+            // Nothing would ever retire the buffer without a batch to copy from it
+            if (!BatchBegin())
+            {
+                vulkan_utility::buffer::destroy(buffer_dedicated);
+                return false;
+            }
+
+            m_batch.buffers_dedicated.emplace_back(buffer_dedicated);
+            *buffer = buffer_dedicated;
+            *offset = 0;
+
+            return true;
+        }
+
+        while (!m_allocator.Allocate(size, alignment, offset))
+        {
+            // The ring is full, submit what's being recorded (it owns part of the ring) and wait for the oldest batch
+            if (!Submit())
+                return false;
+
+            if (m_batches_in_flight.empty())
+            {
+                LOG_ERROR("Failed to allocate %llu bytes from the staging ring", size);
+                return false;
+            }
+
+            Retire(true);
+        }
+
+        write(static_cast<std::byte*>(m_buffer_mapped) + *offset);
+        *buffer = m_buffer;
+
+        return BatchBegin();
+    }
+
+    bool RHI_StagingRing::BatchBegin()
+    {
+        if (m_batch.recording)
+            return true;
+
+        // Re-use a retired batch or create a new one
+        if (!m_batch.cmd_buffer)
+        {
+            if (!m_batches_free.empty())
+            {
+                m_batch.cmd_pool    = m_batches_free.back().cmd_pool;
+                m_batch.cmd_buffer  = m_batches_free.back().cmd_buffer;
+                m_batches_free.pop_back();
+            }
+            else
+            {
+                if (!vulkan_utility::command_pool::create(m_batch.cmd_pool, RHI_Queue_Transfer))
+                    return false;
+
+                if (!vulkan_utility::command_buffer::create(m_batch.cmd_pool, m_batch.cmd_buffer, VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+                    return false;
+
+                vulkan_utility::debug::set_name(static_cast<VkCommandBuffer>(m_batch.cmd_buffer), "staging_ring");
+            }
+        }
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (!vulkan_utility::error::check(vkBeginCommandBuffer(static_cast<VkCommandBuffer>(m_batch.cmd_buffer), &begin_info)))
+            return false;
+
+        m_batch.recording = true;
+        return true;
+    }
+
+    bool RHI_StagingRing::Submit()
+    {
+        if (!m_batch.recording)
+            return true;
+
+        if (!vulkan_utility::error::check(vkEndCommandBuffer(static_cast<VkCommandBuffer>(m_batch.cmd_buffer))))
+            return false;
+
+        m_batch.recording   = false;
+        m_batch.value       = m_value_submitted + 1;
+
+        if (!m_rhi_device->Queue_Submit(RHI_Queue_Transfer, m_batch.cmd_buffer, nullptr, m_semaphore, nullptr, 0, m_batch.value))
+        {
+            LOG_ERROR("Failed to submit to the transfer queue");
+            return false;
+        }
+
+        m_value_submitted = m_batch.value;
+        m_allocator.Close(m_batch.value);
+
+        if (m_batch.has_buffers)
+        {
+            m_value_wait = m_batch.value;
+        }
+
+        m_batches_in_flight.emplace_back(move(m_batch));
+        m_batch = Batch();
+
+        return true;
+    }
+
+    void RHI_StagingRing::Retire(const bool wait_for_oldest)
+    {
+        const VkDevice device = m_rhi_device->GetContextRhi()->device;
+
+        if (wait_for_oldest && !m_batches_in_flight.empty())
+        {
+            VkSemaphoreWaitInfo wait_info   = {};
+            wait_info.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            wait_info.semaphoreCount        = 1;
+            wait_info.pSemaphores           = reinterpret_cast<VkSemaphore*>(&m_semaphore);
+            wait_info.pValues               = &m_batches_in_flight.front().value;
+            vulkan_utility::error::check(vkWaitSemaphores(device, &wait_info, numeric_limits<uint64_t>::max()));
+        }
+
+        uint64_t value_completed = 0;
+        if (!vulkan_utility::error::check(vkGetSemaphoreCounterValue(device, static_cast<VkSemaphore>(m_semaphore), &value_completed)))
+            return;
+
+        while (!m_batches_in_flight.empty() && m_batches_in_flight.front().value <= value_completed)
+        {
+            Batch& batch = m_batches_in_flight.front();
+
+            for (void*& buffer : batch.buffers_dedicated)
+            {
+                vulkan_utility::buffer::destroy(buffer);
+            }
+            batch.buffers_dedicated.clear();
+
+            for (pair<const void*, function<void()>>& reference : batch.references)
+            {
+                if (reference.second)
+                {
+                    m_on_retire.emplace_back(move(reference));
+                }
+            }
+            batch.references.clear();
+
+            batch.value         = 0;
+            batch.has_buffers   = false;
+            m_batches_free.emplace_back(move(batch));
+            m_batches_in_flight.pop_front();
+        }
+
+        m_allocator.Retire(value_completed);
+        m_value_completed = value_completed;
+
+        // Waiting on a value which has completed is free, and it makes the retired copies visible to the graphics queue
+        if (m_value_completed > m_value_wait)
+        {
+            m_value_wait = m_value_completed;
+        }
+    }
+
+    void RHI_StagingRing::DestroyBatch(Batch& batch)
+    {
+        if (batch.cmd_buffer)
+        {
+            vulkan_utility::command_buffer::destroy(batch.cmd_pool, batch.cmd_buffer);
+            batch.cmd_buffer = nullptr;
+        }
+
+        if (batch.cmd_pool)
+        {
+            vulkan_utility::command_pool::destroy(batch.cmd_pool);
+        }
+
+        for (void*& buffer : batch.buffers_dedicated)
+        {
+            vulkan_utility::buffer::destroy(buffer);
+        }
+        batch.buffers_dedicated.clear();
+    }
+}
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Device.h"
 #include "../RHI_CommandList.h"
 #include "../RHI_Pipeline.h"
+#include "../RHI_StagingRing.h"
 #include "../../Logging/Log.h"
 #include "../../Math/MathHelper.h"
 #include "../../Profiling/Profiler.h"
@@ -377,6 +378,15 @@ namespace Spartan
 
 	bool RHI_SwapChain::Present()
 	{
+        // Once per frame, retire finished uploads so that their resources become usable
+        if (RHI_StagingRing* staging_ring = m_rhi_device->GetStagingRing())
+        {
+            staging_ring->Tick();
+        }
+
+        // Destroy what the GPU is done with
+        m_rhi_device->Tick();
+
         if (!m_present)
             return true;
 
@@ -25,6 +25,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI_Texture2D.h"
 #include "../RHI_TextureCube.h"
 #include "../RHI_CommandList.h"
+#include "../RHI_StagingRing.h"
+#include "../RHI_BindlessTable.h"
 #include "../../Math/MathHelper.h"
 #include "../../Profiling/Profiler.h"
 //===================================
@@ -75,68 +77,53 @@ namespace Spartan
             return true;
         }
 
-        const uint32_t width            = texture->GetWidth();
-        const uint32_t height           = texture->GetHeight();
-        const uint32_t array_size       = texture->GetArraySize();
-        const uint32_t mip_levels       = texture->GetMiplevels();
-        const uint32_t bytes_per_pixel  = texture->GetBytesPerPixel();
-
-        // Fill out VkBufferImageCopy structs describing the array and the mip levels   
-        VkDeviceSize buffer_offset = 0;
-        for (uint32_t array_index = 0; array_index < array_size; array_index++)
-        {
-            for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
-            {
-                uint32_t mip_width  = width >> mip_index;
-                uint32_t mip_height = height >> mip_index;
-
-                VkBufferImageCopy region				= {};
-                region.bufferOffset						= buffer_offset;
-                region.bufferRowLength					= 0;
-                region.bufferImageHeight				= 0;
-                region.imageSubresource.aspectMask      = vulkan_utility::image::get_aspect_mask(texture);
-                region.imageSubresource.mipLevel		= mip_index;
-                region.imageSubresource.baseArrayLayer	= array_index;
-                region.imageSubresource.layerCount		= array_size;
-                region.imageOffset						= { 0, 0, 0 };
-                region.imageExtent						= { mip_width, mip_height, 1 };
-
-                buffer_image_copies[mip_index] = region;
-
-                // Update staging buffer memory requirement (in bytes)
-                buffer_offset += mip_width * mip_height * bytes_per_pixel;
-            }
-        }
+        // Fill out VkBufferImageCopy structs describing the array and the mip levels
+        const uint64_t staging_size = vulkan_utility::image::get_staging_regions(texture, buffer_image_copies);
 
         // Create staging buffer
-        VmaAllocation allocation = vulkan_utility::buffer::create(staging_buffer, buffer_offset, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VmaAllocation allocation = vulkan_utility::buffer::create(staging_buffer, staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, false, nullptr, RHI_Memory_Pool_Staging);
 
         // Copy array and mip level data to the staging buffer
         void* data = nullptr;
-        buffer_offset = 0;
         if (vulkan_utility::error::check(vmaMapMemory(vulkan_utility::globals::rhi_context->allocator, allocation, &data)))
         {
-            for (uint32_t array_index = 0; array_index < array_size; array_index++)
-            {
-                for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
-                {
-                    uint64_t buffer_size = (width >> mip_index) * (height >> mip_index) * bytes_per_pixel;
-                    memcpy(static_cast<std::byte*>(data) + buffer_offset, texture->GetData(array_index + mip_index)->data(), buffer_size);
-                    buffer_offset += buffer_size;
-                }
-            }
-
+            vulkan_utility::image::copy_to_staging(texture, static_cast<std::byte*>(data));
             vmaUnmapMemory(vulkan_utility::globals::rhi_context->allocator, allocation);
         }
 
         return true;
     }
 
-    inline bool stage(RHI_Texture* texture, RHI_Image_Layout& texture_layout)
+    inline RHI_Image_Layout get_target_layout(const RHI_Texture* texture)
     {
+        RHI_Image_Layout target_layout = RHI_Image_Preinitialized;
+
+        if (texture->IsSampled() && texture->IsColorFormat())
+            target_layout = RHI_Image_Shader_Read_Only_Optimal;
+
+        if (texture->IsRenderTargetColor())
+            target_layout = RHI_Image_Color_Attachment_Optimal;
+
+        if (texture->IsRenderTargetDepthStencil())
+            target_layout = RHI_Image_Depth_Stencil_Attachment_Optimal;
+
+        return target_layout;
+    }
+
+    inline bool stage(RHI_Texture* texture, RHI_Image_Layout& texture_layout, bool& staged_async)
+    {
+        // Sampled textures go through the staging ring, they read as black until the copy has retired
+        RHI_StagingRing* staging_ring = vulkan_utility::globals::rhi_device->GetStagingRing();
+        if (staging_ring && get_target_layout(texture) == RHI_Image_Shader_Read_Only_Optimal)
+        {
+            staged_async = staging_ring->UploadTexture(texture, texture_layout, RHI_Image_Shader_Read_Only_Optimal);
+            if (staged_async)
+                return true;
+        }
+
         // Copy the texture's data to a staging buffer
         void* staging_buffer = nullptr;
-        std::vector<VkBufferImageCopy> buffer_image_copies(texture->GetMiplevels());
+        std::vector<VkBufferImageCopy> buffer_image_copies;
         if (!copy_to_staging_buffer(texture, buffer_image_copies, staging_buffer))
             return false;
 
@@ -179,17 +166,25 @@ namespace Spartan
         if (!m_rhi_device->IsInitialized())
             return;
 
-        m_rhi_device->Queue_WaitAll();
-        m_data.clear();
+        // Drop any pending upload
+        if (RHI_StagingRing* staging_ring = m_rhi_device->GetStagingRing())
+        {
+            staging_ring->Release(m_resource);
+        }
 
-        vulkan_utility::image::view::destroy(m_resource_view[0]);
-        vulkan_utility::image::view::destroy(m_resource_view[1]);
-        for (uint32_t i = 0; i < state_max_render_target_count; i++)
+        // Give back the bindless slot
+        if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
         {
-            vulkan_utility::image::view::destroy(m_resource_view_depthStencil[i]);
-            vulkan_utility::image::view::destroy(m_resource_view_renderTarget[i]);
+            bindless_table->RemoveTexture(this);
         }
-        vulkan_utility::image::destroy(this);
+
+        m_data.clear();
+
+        // Destroyed once the GPU is done with the frames that could have used the texture
+        vector<void*> views = { m_resource_view[0], m_resource_view[1] };
+        views.insert(views.end(), m_resource_view_depthStencil.begin(), m_resource_view_depthStencil.end());
+        views.insert(views.end(), m_resource_view_renderTarget.begin(), m_resource_view_renderTarget.end());
+        vulkan_utility::image::destroy_deferred(this, move(views));
 	}
 
     void RHI_Texture::SetLayout(const RHI_Image_Layout new_layout, RHI_CommandList* command_list /*= nullptr*/)
@@ -223,28 +218,20 @@ namespace Spartan
         }
 
         // If the texture has any data, stage it
+        bool staged_async = false;
         if (HasData())
         {
-            if (!stage(this, m_layout))
+            if (!stage(this, m_layout, staged_async))
             {
                 LOG_ERROR("Failed to stage");
                 return false;
             }
         }
 
-        // Transition to target layout
-        if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
+        // Transition to target layout (asynchronous uploads transition once their copy has retired)
+        if (VkCommandBuffer cmd_buffer = !staged_async ? vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics) : nullptr)
         {    
-            RHI_Image_Layout target_layout = RHI_Image_Preinitialized;
-        
-            if (IsSampled() && IsColorFormat())
-                target_layout = RHI_Image_Shader_Read_Only_Optimal;
-        
-            if (IsRenderTargetColor())
-                target_layout = RHI_Image_Color_Attachment_Optimal;
-        
-            if (IsRenderTargetDepthStencil())
-                target_layout = RHI_Image_Depth_Stencil_Attachment_Optimal;
+            RHI_Image_Layout target_layout = get_target_layout(this);
         
             // Transition to the final layout
             if (!vulkan_utility::image::set_layout(cmd_buffer, this, target_layout))
@@ -318,17 +305,25 @@ namespace Spartan
         if (!m_rhi_device->IsInitialized())
             return;
 
-        m_rhi_device->Queue_WaitAll();
-        m_data.clear();
+        // Drop any pending upload
+        if (RHI_StagingRing* staging_ring = m_rhi_device->GetStagingRing())
+        {
+            staging_ring->Release(m_resource);
+        }
 
-        vulkan_utility::image::view::destroy(m_resource_view[0]);
-        vulkan_utility::image::view::destroy(m_resource_view[1]);
-        for (uint32_t i = 0; i < state_max_render_target_count; i++)
+        // Give back the bindless slot
+        if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
         {
-            vulkan_utility::image::view::destroy(m_resource_view_depthStencil[i]);
-            vulkan_utility::image::view::destroy(m_resource_view_renderTarget[i]);
+            bindless_table->RemoveTexture(this);
         }
-        vulkan_utility::image::destroy(this);
+
+        m_data.clear();
+
+        // Destroyed once the GPU is done with the frames that could have used the texture
+        vector<void*> views = { m_resource_view[0], m_resource_view[1] };
+        views.insert(views.end(), m_resource_view_depthStencil.begin(), m_resource_view_depthStencil.end());
+        views.insert(views.end(), m_resource_view_renderTarget.begin(), m_resource_view_renderTarget.end());
+        vulkan_utility::image::destroy_deferred(this, move(views));
 	}
 
 	bool RHI_TextureCube::CreateResourceGpu()
@@ -341,25 +336,17 @@ namespace Spartan
         }
 
         // If the texture has any data, stage it
+        bool staged_async = false;
         if (HasData())
         {
-            if (!stage(this, m_layout))
+            if (!stage(this, m_layout, staged_async))
                 return false;
         }
 
-        // Transition to target layout
-        if (VkCommandBuffer cmd_buffer = vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics))
+        // Transition to target layout (asynchronous uploads transition once their copy has retired)
+        if (VkCommandBuffer cmd_buffer = !staged_async ? vulkan_utility::command_buffer_immediate::begin(RHI_Queue_Graphics) : nullptr)
         {
-            RHI_Image_Layout target_layout = RHI_Image_Preinitialized;
-
-            if (IsSampled() && IsColorFormat())
-                target_layout = RHI_Image_Shader_Read_Only_Optimal;
-
-            if (IsRenderTargetColor())
-                target_layout = RHI_Image_Color_Attachment_Optimal;
-
-            if (IsRenderTargetDepthStencil())
-                target_layout = RHI_Image_Depth_Stencil_Attachment_Optimal;
+            RHI_Image_Layout target_layout = get_target_layout(this);
 
             // Transition to the final layout
             if (!vulkan_utility::image::set_layout(cmd_buffer, this, target_layout))
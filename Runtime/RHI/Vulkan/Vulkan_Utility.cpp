@@ -43,18 +43,57 @@ namespace Spartan::vulkan_utility
     mutex                                                                   command_buffer_immediate::m_mutex_end;
     unordered_map<RHI_Queue_Type, command_buffer_immediate::cmdbi_object>   command_buffer_immediate::m_objects;
 
+    VmaAllocationCreateInfo memory::get_allocation_info(const RHI_Memory_Pool pool, const VmaMemoryUsage usage)
+    {
+        // The usage class travels with the allocation, so that it can be accounted for when it's destroyed
+        VmaAllocationCreateInfo allocation_info = {};
+        allocation_info.usage                   = usage;
+        allocation_info.pool                    = globals::rhi_context->pools[pool];
+        allocation_info.pUserData               = reinterpret_cast<void*>(static_cast<uintptr_t>(pool));
+
+        return allocation_info;
+    }
+
+    void memory::track(VmaAllocation allocation)
+    {
+        VmaAllocationInfo allocation_info;
+        vmaGetAllocationInfo(globals::rhi_context->allocator, allocation, &allocation_info);
+        const RHI_Memory_Pool pool = static_cast<RHI_Memory_Pool>(reinterpret_cast<uintptr_t>(allocation_info.pUserData));
+
+        const uint64_t bytes_used = globals::rhi_context->pool_bytes_used[pool].fetch_add(allocation_info.size) + allocation_info.size;
+        globals::rhi_context->pool_allocations[pool]++;
+
+        // Budgets are soft, warn once when a usage class crosses its budget so that the cause can be found
+        const uint64_t budget = globals::rhi_device->GetMemoryBudget(pool);
+        if (budget != 0 && bytes_used > budget && bytes_used - allocation_info.size <= budget)
+        {
+            LOG_WARNING("\"%s\" memory is over budget (%llu/%llu MB)", rhi_memory_pool_to_string(pool), bytes_used / 1024 / 1024, budget / 1024 / 1024);
+        }
+    }
+
+    void memory::untrack(VmaAllocation allocation)
+    {
+        VmaAllocationInfo allocation_info;
+        vmaGetAllocationInfo(globals::rhi_context->allocator, allocation, &allocation_info);
+        const RHI_Memory_Pool pool = static_cast<RHI_Memory_Pool>(reinterpret_cast<uintptr_t>(allocation_info.pUserData));
+
+        globals::rhi_context->pool_bytes_used[pool] -= allocation_info.size;
+        globals::rhi_context->pool_allocations[pool]--;
+    }
+
 	bool image::create(RHI_Texture* texture)
 	{
         // Get format support
         RHI_Format format                   = texture->GetFormat();
         bool is_render_target_depth_stencil = texture->IsRenderTargetDepthStencil();
-        VkFormatFeatureFlags format_flags   = is_render_target_depth_stencil ? VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+        bool is_render_target_color         = texture->IsRenderTargetColor();
+        VkFormatFeatureFlags format_flags   = is_render_target_depth_stencil ? VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT : (is_render_target_color ? VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT : VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT); // block compressed formats can only be sampled
         VkImageTiling image_tiling          = get_format_tiling(format, format_flags);
         
         // Ensure the format is supported by the GPU
         if (image_tiling == VK_IMAGE_TILING_MAX_ENUM)
         {
-            LOG_ERROR("GPU does not support the usage of %s as a %s.", rhi_format_to_string(format), is_render_target_depth_stencil ? "depth-stencil attachment" : "color attachment");
+            LOG_ERROR("GPU does not support the usage of %s as a %s.", rhi_format_to_string(format), is_render_target_depth_stencil ? "depth-stencil attachment" : (is_render_target_color ? "color attachment" : "sampled image"));
             return false;
         }
         
@@ -72,8 +111,8 @@ namespace Spartan::vulkan_utility
         create_info.sType               = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         create_info.imageType           = VK_IMAGE_TYPE_2D;
         create_info.flags               = (texture->GetResourceType() == Resource_TextureCube) ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
-        create_info.extent.width        = texture->GetWidth();
-        create_info.extent.height       = texture->GetHeight();
+        create_info.extent.width        = texture->GetWidthResident();
+        create_info.extent.height       = texture->GetHeightResident();
         create_info.extent.depth        = 1;
         create_info.mipLevels           = texture->GetMiplevels();
         create_info.arrayLayers         = texture->GetArraySize();
@@ -84,15 +123,34 @@ namespace Spartan::vulkan_utility
         create_info.samples             = VK_SAMPLE_COUNT_1_BIT;
         create_info.sharingMode         = VK_SHARING_MODE_EXCLUSIVE;
 
-        VmaAllocationCreateInfo allocation_info = {};
-        allocation_info.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+        // Uploads are copied on the transfer queue, share the image instead of transferring queue family ownership
+        const uint32_t queue_family_indices[] = { globals::rhi_context->queue_graphics_index, globals::rhi_context->queue_transfer_index };
+        if ((create_info.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) && queue_family_indices[0] != queue_family_indices[1])
+        {
+            create_info.sharingMode             = VK_SHARING_MODE_CONCURRENT;
+            create_info.queueFamilyIndexCount   = 2;
+            create_info.pQueueFamilyIndices     = queue_family_indices;
+        }
+
+        const RHI_Memory_Pool pool              = (texture->IsRenderTargetColor() || texture->IsRenderTargetCompute() || is_render_target_depth_stencil) ? RHI_Memory_Pool_RenderTarget : RHI_Memory_Pool_Texture;
+        VmaAllocationCreateInfo allocation_info = memory::get_allocation_info(pool, VMA_MEMORY_USAGE_GPU_ONLY);
 
         // Create image, allocate memory and bind memory to image
         VmaAllocation allocation;
-        void* resource = nullptr;
-        if (!error::check(vmaCreateImage(globals::rhi_context->allocator, &create_info, &allocation_info, reinterpret_cast<VkImage*>(&resource), &allocation, nullptr)))
+        void* resource  = nullptr;
+        VkResult result = vmaCreateImage(globals::rhi_context->allocator, &create_info, &allocation_info, reinterpret_cast<VkImage*>(&resource), &allocation, nullptr);
+
+        // The pool can be full, or of a memory type this image can't live in, fall back to the default pools
+        if (result != VK_SUCCESS && allocation_info.pool != nullptr)
+        {
+            allocation_info.pool = nullptr;
+            result = vmaCreateImage(globals::rhi_context->allocator, &create_info, &allocation_info, reinterpret_cast<VkImage*>(&resource), &allocation, nullptr);
+        }
+
+        if (!error::check(result))
             return false;
 
+        memory::track(allocation);
         texture->Set_Resource(resource);
 
         // Keep allocation reference
@@ -110,13 +168,46 @@ namespace Spartan::vulkan_utility
         if (it != globals::rhi_context->allocations.end())
         {
             VmaAllocation allocation = it->second;
+            memory::untrack(allocation);
             vmaDestroyImage(globals::rhi_context->allocator, static_cast<VkImage>(resource), allocation);
             globals::rhi_context->allocations.erase(allocation_id);
             texture->Set_Resource(nullptr);
         }
     }
 
-    VmaAllocation buffer::create(void*& _buffer, const uint64_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_property_flags, const bool written_frequently /*= false*/, const void* data /*= nullptr*/)
+    void image::destroy_deferred(RHI_Texture* texture, vector<void*>&& views)
+    {
+        VkImage resource            = static_cast<VkImage>(texture->Get_Resource());
+        VmaAllocation allocation    = nullptr;
+
+        // The allocation is keyed by the texture id, so it has to leave the map while the texture still exists
+        auto it = globals::rhi_context->allocations.find(texture->GetId());
+        if (it != globals::rhi_context->allocations.end())
+        {
+            allocation = it->second;
+            globals::rhi_context->allocations.erase(it);
+            texture->Set_Resource(nullptr);
+        }
+
+        globals::rhi_device->DestroyDeferred([resource, allocation, views = move(views)]()
+        {
+            for (void* view : views)
+            {
+                if (view)
+                {
+                    vkDestroyImageView(globals::rhi_context->device, static_cast<VkImageView>(view), nullptr);
+                }
+            }
+
+            if (allocation)
+            {
+                memory::untrack(allocation);
+                vmaDestroyImage(globals::rhi_context->allocator, resource, allocation);
+            }
+        });
+    }
+
+    VmaAllocation buffer::create(void*& _buffer, const uint64_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_property_flags, const bool written_frequently /*= false*/, const void* data /*= nullptr*/, const RHI_Memory_Pool pool /*= RHI_Memory_Pool_Default*/)
     {
         VmaAllocator allocator = globals::rhi_context->allocator;
 
@@ -126,18 +217,45 @@ namespace Spartan::vulkan_utility
         buffer_create_info.usage				= usage;
         buffer_create_info.sharingMode			= VK_SHARING_MODE_EXCLUSIVE;
 
+        // Uploads are copied on the transfer queue, share the buffer instead of transferring queue family ownership
+        const uint32_t queue_family_indices[] = { globals::rhi_context->queue_graphics_index, globals::rhi_context->queue_transfer_index };
+        if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && queue_family_indices[0] != queue_family_indices[1])
+        {
+            buffer_create_info.sharingMode              = VK_SHARING_MODE_CONCURRENT;
+            buffer_create_info.queueFamilyIndexCount    = 2;
+            buffer_create_info.pQueueFamilyIndices      = queue_family_indices;
+        }
+
         bool used_for_staging = (usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) != 0;
 
-        VmaAllocationCreateInfo allocation_create_info  = {};
-        allocation_create_info.usage                    = used_for_staging ? VMA_MEMORY_USAGE_CPU_ONLY : (written_frequently ? VMA_MEMORY_USAGE_CPU_TO_GPU : VMA_MEMORY_USAGE_GPU_ONLY);
+        VmaAllocationCreateInfo allocation_create_info  = memory::get_allocation_info(pool, used_for_staging ? VMA_MEMORY_USAGE_CPU_ONLY : (written_frequently ? VMA_MEMORY_USAGE_CPU_TO_GPU : VMA_MEMORY_USAGE_GPU_ONLY));
         allocation_create_info.preferredFlags           = memory_property_flags;
 
+        // A buffer which would take up a whole block would starve its pool (the staging ring is as large as the staging pool),
+        // so it goes to the default pools instead, it's still accounted for under its usage class
+        const uint64_t pool_block_size = globals::rhi_context->pool_block_sizes[pool];
+        if (pool_block_size != 0 && size >= pool_block_size)
+        {
+            allocation_create_info.pool = nullptr;
+        }
+
         // Create buffer, allocate memory and bind it to the buffer
         VmaAllocation allocation = nullptr;
         VmaAllocationInfo allocation_info;
-        if (!error::check(vmaCreateBuffer(allocator, &buffer_create_info, &allocation_create_info, reinterpret_cast<VkBuffer*>(&_buffer), &allocation, &allocation_info)))
+        VkResult result = vmaCreateBuffer(allocator, &buffer_create_info, &allocation_create_info, reinterpret_cast<VkBuffer*>(&_buffer), &allocation, &allocation_info);
+
+        // The pool can be full (the staging ring has a single block), fall back to the default pools
+        if (result != VK_SUCCESS && allocation_create_info.pool != nullptr)
+        {
+            allocation_create_info.pool = nullptr;
+            result = vmaCreateBuffer(allocator, &buffer_create_info, &allocation_create_info, reinterpret_cast<VkBuffer*>(&_buffer), &allocation, &allocation_info);
+        }
+
+        if (!error::check(result))
             return false;
 
+        memory::track(allocation);
+
         // Keep allocation reference
         globals::rhi_context->allocations[reinterpret_cast<uint64_t>(_buffer)] = allocation;
 
@@ -196,9 +314,31 @@ namespace Spartan::vulkan_utility
         if (it != globals::rhi_context->allocations.end())
         {
             VmaAllocation allocation = it->second;
+            memory::untrack(allocation);
             vmaDestroyBuffer(globals::rhi_context->allocator, static_cast<VkBuffer>(_buffer), allocation);
             globals::rhi_context->allocations.erase(allocation_id);
             _buffer = nullptr;
         }
     }
+
+    void buffer::destroy_deferred(void*& _buffer)
+    {
+        if (!_buffer)
+            return;
+
+        auto it = globals::rhi_context->allocations.find(reinterpret_cast<uint64_t>(_buffer));
+        if (it != globals::rhi_context->allocations.end())
+        {
+            VkBuffer buffer             = static_cast<VkBuffer>(_buffer);
+            VmaAllocation allocation    = it->second;
+            globals::rhi_context->allocations.erase(it);
+            _buffer = nullptr;
+
+            globals::rhi_device->DestroyDeferred([buffer, allocation]()
+            {
+                memory::untrack(allocation);
+                vmaDestroyBuffer(globals::rhi_context->allocator, buffer, allocation);
+            });
+        }
+    }
 }
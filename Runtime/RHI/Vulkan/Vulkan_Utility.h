@@ -465,10 +465,18 @@ namespace Spartan::vulkan_utility
         static std::unordered_map<RHI_Queue_Type, cmdbi_object> m_objects;
     };
 
+    namespace memory
+    {
+        VmaAllocationCreateInfo get_allocation_info(const RHI_Memory_Pool pool, const VmaMemoryUsage usage);
+        void track(VmaAllocation allocation);   // once created, adds it to the stats of its usage class
+        void untrack(VmaAllocation allocation); // before it's destroyed
+    }
+
 	namespace buffer
 	{
-        VmaAllocation create(void*& _buffer, const uint64_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_property_flags, const bool written_frequently = false, const void* data = nullptr);
+        VmaAllocation create(void*& _buffer, const uint64_t size, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_property_flags, const bool written_frequently = false, const void* data = nullptr, const RHI_Memory_Pool pool = RHI_Memory_Pool_Default);
         void destroy(void*& _buffer);
+        void destroy_deferred(void*& _buffer); // once the GPU is done with the frames that could have used it
 	}
 
     namespace image
@@ -541,6 +549,7 @@ namespace Spartan::vulkan_utility
         bool create(RHI_Texture* texture);
 
         void destroy(RHI_Texture* texture);
+        void destroy_deferred(RHI_Texture* texture, std::vector<void*>&& views); // the image and its views, once the GPU is done with the frames that could have used them
 
         inline VkPipelineStageFlags access_flags_to_pipeline_stage(VkAccessFlags access_flags, const VkPipelineStageFlags enabled_graphics_shader_stages)
         {
@@ -773,6 +782,65 @@ namespace Spartan::vulkan_utility
             return set_layout(cmd_buffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, swapchain->GetLayout(), layout_new);
         }
 
+        // Fills out VkBufferImageCopy structs describing the array and the mip levels, returns the required staging size (in bytes)
+        inline uint64_t get_staging_regions(RHI_Texture* texture, std::vector<VkBufferImageCopy>& buffer_image_copies, const uint64_t buffer_offset_base = 0)
+        {
+            const uint32_t width            = texture->GetWidthResident();
+            const uint32_t height           = texture->GetHeightResident();
+            const uint32_t array_size       = texture->GetArraySize();
+            const uint32_t mip_levels       = texture->GetMiplevels();
+            const uint32_t mip_first        = texture->GetMipFirst(); // the data starts at the first mip the image holds
+
+            buffer_image_copies.resize(mip_levels);
+
+            VkDeviceSize buffer_offset = 0;
+            for (uint32_t array_index = 0; array_index < array_size; array_index++)
+            {
+                for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
+                {
+                    uint32_t mip_width  = width >> mip_index > 0 ? width >> mip_index : 1;
+                    uint32_t mip_height = height >> mip_index > 0 ? height >> mip_index : 1;
+
+                    VkBufferImageCopy region				= {};
+                    region.bufferOffset						= buffer_offset_base + buffer_offset;
+                    region.bufferRowLength					= 0;
+                    region.bufferImageHeight				= 0;
+                    region.imageSubresource.aspectMask      = get_aspect_mask(texture);
+                    region.imageSubresource.mipLevel		= mip_index;
+                    region.imageSubresource.baseArrayLayer	= array_index;
+                    region.imageSubresource.layerCount		= array_size;
+                    region.imageOffset						= { 0, 0, 0 };
+                    region.imageExtent						= { mip_width, mip_height, 1 };
+
+                    buffer_image_copies[mip_index] = region;
+
+                    // Update staging buffer memory requirement (in bytes)
+                    buffer_offset += texture->GetMipSize(mip_first + mip_index);
+                }
+            }
+
+            return buffer_offset;
+        }
+
+        // Copies the array and mip level data to mapped staging memory, laid out as described by get_staging_regions()
+        inline void copy_to_staging(RHI_Texture* texture, std::byte* mapped)
+        {
+            const uint32_t array_size       = texture->GetArraySize();
+            const uint32_t mip_levels       = texture->GetMiplevels();
+            const uint32_t mip_first        = texture->GetMipFirst();
+
+            uint64_t buffer_offset = 0;
+            for (uint32_t array_index = 0; array_index < array_size; array_index++)
+            {
+                for (uint32_t mip_index = 0; mip_index < mip_levels; mip_index++)
+                {
+                    uint64_t buffer_size = texture->GetMipSize(mip_first + mip_index);
+                    memcpy(mapped + buffer_offset, texture->GetData(array_index + mip_index)->data(), buffer_size);
+                    buffer_offset += buffer_size;
+                }
+            }
+        }
+
         namespace view
         {
             inline bool create(void* image, void*& image_view, VkImageViewType type, const VkFormat format, const VkImageAspectFlags aspect_mask, const uint32_t level_count = 1, const uint32_t layer_index = 0, const uint32_t layer_count = 1)
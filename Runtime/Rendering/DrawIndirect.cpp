@@ -0,0 +1,463 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "DrawIndirect.h"
+#include <random>
+#include <cstddef>
+#include <algorithm>
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../RHI/RHI_BindlessTable.h"
+#include "../RHI/RHI_IndirectBuffer.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    // The shaders read the instance buffer with std430 rules, so the layout has to match Instance in Common_Instance.hlsl
+    static_assert(sizeof(DrawInstance)                          == 176, "DrawInstance doesn't match the shader's layout");
+    static_assert(offsetof(DrawInstance, transform_previous)    == 64,  "DrawInstance doesn't match the shader's layout");
+    static_assert(offsetof(DrawInstance, material_index)        == 140, "DrawInstance doesn't match the shader's layout");
+    static_assert(offsetof(DrawInstance, index_count)           == 156, "DrawInstance doesn't match the shader's layout");
+    static_assert(offsetof(DrawInstance, vertex_offset)         == 164, "DrawInstance doesn't match the shader's layout");
+
+    DrawIndirect::DrawIndirect(const uint32_t instance_capacity, const uint32_t command_capacity, const uint32_t region_count)
+    {
+        m_instance_capacity = instance_capacity;
+        m_command_capacity  = command_capacity;
+        m_region_count      = region_count;
+
+        if (region_count > 8)
+        {
+            LOG_ERROR("%d regions are more than the dirty masks can track, only 8 will be used", region_count);
+            m_region_count = 8;
+        }
+
+        m_instances.resize(instance_capacity);
+        m_models.resize(instance_capacity, nullptr);
+        m_updated.resize(instance_capacity, 0);
+        m_dirty_regions.resize(instance_capacity, 0);
+        m_slots.reserve(instance_capacity);
+    }
+
+    void DrawIndirect::BeginUpdate()
+    {
+        m_frame++;
+        m_command_count = 0;
+    }
+
+    bool DrawIndirect::UpdateInstance(const uint64_t id, const Model* model, const Matrix& transform, const BoundingBox& aabb, const uint32_t material_index, const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset)
+    {
+        uint32_t slot   = 0;
+        bool changed    = false;
+        const auto it   = m_slots.find(id);
+        if (it != m_slots.end())
+        {
+            slot = it->second;
+
+            // Updating twice in a frame would settle the previous transform too early
+            if (m_updated[slot] == m_frame)
+                return true;
+        }
+        else
+        {
+            if (!m_slots_free.empty())
+            {
+                slot = m_slots_free.back();
+                m_slots_free.pop_back();
+            }
+            else if (m_slot_next < m_instance_capacity)
+            {
+                slot = m_slot_next++;
+            }
+            else
+            {
+                if (!m_full)
+                {
+                    LOG_ERROR("The instance buffer has reached its maximum capacity of %d instances", m_instance_capacity);
+                    m_full = true;
+                }
+                return false;
+            }
+
+            m_slots[id] = slot;
+
+            // Nothing to compare against, so it starts at rest
+            m_instances[slot].transform             = transform;
+            m_instances[slot].transform_previous    = transform;
+            changed                                 = true;
+        }
+
+        m_models[slot]  = model;
+        m_updated[slot] = m_frame;
+
+        DrawInstance& instance = m_instances[slot];
+
+        if (instance.transform != transform)
+        {
+            instance.transform_previous = instance.transform;
+            instance.transform          = transform;
+            changed                     = true;
+        }
+        else if (instance.transform_previous != instance.transform)
+        {
+            // Stopped moving, the velocity goes back to zero
+            instance.transform_previous = instance.transform;
+            changed                     = true;
+        }
+
+        const int32_t vertex_offset_signed = static_cast<int32_t>(vertex_offset);
+        if (instance.aabb_min       != aabb.GetMin()    ||
+            instance.aabb_max       != aabb.GetMax()    ||
+            instance.material_index != material_index   ||
+            instance.index_count    != index_count      ||
+            instance.index_offset   != index_offset     ||
+            instance.vertex_offset  != vertex_offset_signed)
+        {
+            instance.aabb_min       = aabb.GetMin();
+            instance.aabb_max       = aabb.GetMax();
+            instance.material_index = material_index;
+            instance.index_count    = index_count;
+            instance.index_offset   = index_offset;
+            instance.vertex_offset  = vertex_offset_signed;
+            changed                 = true;
+        }
+
+        if (changed)
+        {
+            MarkDirty(slot);
+        }
+
+        return true;
+    }
+
+    void DrawIndirect::EndUpdate(const uint32_t region, RHI_BindlessTable* table)
+    {
+        // Remove what wasn't updated, nothing draws it anymore so its data can stay where it is
+        for (auto it = m_slots.begin(); it != m_slots.end();)
+        {
+            if (m_updated[it->second] != m_frame)
+            {
+                m_models[it->second] = nullptr;
+                m_slots_free.emplace_back(it->second);
+                it = m_slots.erase(it);
+                m_full = false;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        m_region        = region;
+        m_upload_count  = 0;
+
+        if (region >= m_region_count || m_dirty_slots.empty())
+            return;
+
+        // Write the slots which changed since the region was last written, neighbours as a single write
+        sort(m_dirty_slots.begin(), m_dirty_slots.end());
+
+        const uint8_t region_bit    = static_cast<uint8_t>(1u << region);
+        uint32_t run_first          = 0;
+        uint32_t run_count          = 0;
+        const auto write_run = [this, table, region, &run_first, &run_count]()
+        {
+            if (run_count == 0)
+                return;
+
+            if (table)
+            {
+                table->WriteInstances(region, run_first, run_count, &m_instances[run_first]);
+            }
+
+            m_upload_count  += run_count;
+            run_count       = 0;
+        };
+
+        uint32_t kept = 0;
+        for (const uint32_t slot : m_dirty_slots)
+        {
+            if (m_dirty_regions[slot] & region_bit)
+            {
+                if (run_count != 0 && slot != run_first + run_count)
+                {
+                    write_run();
+                }
+
+                if (run_count == 0)
+                {
+                    run_first = slot;
+                }
+                run_count++;
+
+                m_dirty_regions[slot] &= ~region_bit;
+            }
+
+            // Other regions still have to receive it
+            if (m_dirty_regions[slot] != 0)
+            {
+                m_dirty_slots[kept++] = slot;
+            }
+        }
+        write_run();
+
+        m_dirty_slots.resize(kept);
+    }
+
+    void DrawIndirect::BeginPass()
+    {
+        m_pass_draws.clear();
+        m_batches.clear();
+    }
+
+    bool DrawIndirect::AddDraw(const uint64_t id)
+    {
+        const auto it = m_slots.find(id);
+        if (it == m_slots.end())
+            return false;
+
+        const DrawInstance& instance = m_instances[it->second];
+        m_pass_draws.push_back({ it->second, instance.index_count, instance.index_offset });
+        return true;
+    }
+
+    bool DrawIndirect::AddDraw(const uint64_t id, const uint32_t index_count, const uint32_t index_offset)
+    {
+        const auto it = m_slots.find(id);
+        if (it == m_slots.end())
+            return false;
+
+        m_pass_draws.push_back({ it->second, index_count, index_offset });
+        return true;
+    }
+
+    const vector<DrawIndirect::Batch>& DrawIndirect::EndPass(RHI_DrawIndexedIndirect* commands)
+    {
+        m_batches.clear();
+
+        if (!commands || m_pass_draws.empty())
+            return m_batches;
+
+        // Passes of the same frame share the region
+        const uint32_t command_space = m_command_capacity - m_command_count;
+        if (m_pass_draws.size() > command_space)
+        {
+            LOG_WARNING("The indirect buffer can't fit %d more draws, %d will be skipped", static_cast<uint32_t>(m_pass_draws.size()), static_cast<uint32_t>(m_pass_draws.size()) - command_space);
+            m_pass_draws.resize(command_space);
+        }
+
+        // Group by model, so that each group is a single multi-draw with its geometry bound once
+        sort(m_pass_draws.begin(), m_pass_draws.end(), [this](const PassDraw& a, const PassDraw& b)
+        {
+            return m_models[a.slot] != m_models[b.slot] ? m_models[a.slot] < m_models[b.slot] : a.slot < b.slot;
+        });
+
+        const uint32_t region_command_offset    = m_region * m_command_capacity;
+        const uint32_t region_instance_offset   = m_region * m_instance_capacity;
+        for (const PassDraw& draw : m_pass_draws)
+        {
+            const uint32_t slot             = draw.slot;
+            const DrawInstance& instance    = m_instances[slot];
+
+            RHI_DrawIndexedIndirect& command    = commands[m_command_count];
+            command.index_count                 = draw.index_count;
+            command.instance_count              = 1;
+            command.index_offset                = draw.index_offset;
+            command.vertex_offset               = instance.vertex_offset;
+            command.instance_offset             = region_instance_offset + slot;
+
+            if (m_batches.empty() || m_batches.back().model != m_models[slot])
+            {
+                Batch batch;
+                batch.model             = m_models[slot];
+                batch.command_offset    = region_command_offset + m_command_count;
+                m_batches.emplace_back(batch);
+            }
+
+            m_batches.back().command_count++;
+            m_command_count++;
+        }
+
+        return m_batches;
+    }
+
+    uint32_t DrawIndirect::GetDirtyCount(const uint32_t region) const
+    {
+        if (region >= m_region_count)
+            return 0;
+
+        const uint8_t region_bit = static_cast<uint8_t>(1u << region);
+        return static_cast<uint32_t>(count_if(m_dirty_slots.begin(), m_dirty_slots.end(), [this, region_bit](const uint32_t slot) { return (m_dirty_regions[slot] & region_bit) != 0; }));
+    }
+
+    const DrawInstance* DrawIndirect::GetInstance(const uint64_t id) const
+    {
+        const auto it = m_slots.find(id);
+        return it != m_slots.end() ? &m_instances[it->second] : nullptr;
+    }
+
+    void DrawIndirect::MarkDirty(const uint32_t slot)
+    {
+        if (m_dirty_regions[slot] == 0)
+        {
+            m_dirty_slots.emplace_back(slot);
+        }
+
+        m_dirty_regions[slot] = static_cast<uint8_t>((1u << m_region_count) - 1);
+    }
+
+    bool DrawIndirect::Benchmark(const uint32_t instance_count, const uint32_t iterations /*= 100*/)
+    {
+        if (instance_count < 2 || iterations == 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        const uint32_t region_count = 2;
+        DrawIndirect draws(instance_count, instance_count * 2, region_count);
+
+        // A few models, only their addresses matter
+        const uint32_t model_count = 8;
+        char model_storage[model_count] = {};
+        const auto get_model = [&model_storage](const uint32_t index) { return reinterpret_cast<const Model*>(&model_storage[index % model_count]); };
+
+        // Scatter instances, with a fixed seed so that runs are comparable
+        vector<Matrix> transforms(instance_count);
+        mt19937 generator(1337);
+        uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+        for (Matrix& transform : transforms)
+        {
+            transform = Matrix::CreateTranslation(Vector3(distribution(generator), distribution(generator), distribution(generator)));
+        }
+
+        const BoundingBox aabb(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+        const auto update = [&](const uint32_t region, const uint32_t skip = numeric_limits<uint32_t>::max())
+        {
+            draws.BeginUpdate();
+            for (uint32_t i = 0; i < instance_count; i++)
+            {
+                if (i != skip)
+                {
+                    draws.UpdateInstance(i, get_model(i), transforms[i], aabb.Transform(transforms[i]), i % 16, 36, 36 * (i % model_count), 0);
+                }
+            }
+            draws.EndUpdate(region, nullptr);
+        };
+
+        bool valid = true;
+        const auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        // New instances reach every region, each region is written once
+        update(0);
+        check(draws.GetInstanceCount() == instance_count,                                       "every instance has a slot");
+        check(draws.GetUploadCount() == instance_count,                                         "the first region receives every instance");
+        check(draws.GetDirtyCount(1) == instance_count,                                         "the second region waits for every instance");
+        update(1);
+        check(draws.GetUploadCount() == instance_count,                                         "the second region receives every instance");
+        update(0);
+        check(draws.GetUploadCount() == 0 && draws.GetDirtyCount(1) == 0,                       "unchanged instances are not written");
+
+        // A moving instance keeps its previous transform for a frame, then settles
+        const uint32_t moved        = instance_count / 2;
+        const Matrix transform_old  = transforms[moved];
+        transforms[moved]           = Matrix::CreateTranslation(Vector3(0.0f, 1.0f, 0.0f)) * transform_old;
+        update(1);
+        check(draws.GetInstance(moved)->transform_previous == transform_old,                "a moved instance keeps its previous transform");
+        check(draws.GetUploadCount() == 1,                                                  "a moved instance is the only write");
+        check(draws.GetDirtyCount(0) == 1,                                                  "a moved instance waits for the other region");
+        update(0);
+        check(draws.GetInstance(moved)->transform_previous == transforms[moved],            "a stopped instance settles");
+        update(1);
+        update(0);
+        check(draws.GetUploadCount() == 0,                                                  "a settled instance is not written");
+
+        // Removed instances free their slot for the next one
+        update(1, moved);
+        check(draws.GetInstanceCount() == instance_count - 1 && !draws.GetInstance(moved),  "an instance which isn't updated is removed");
+        update(0);
+        check(draws.GetInstanceCount() == instance_count,                                   "a removed slot is re-used");
+
+        // A pass draws every instance, as one batch per model
+        vector<RHI_DrawIndexedIndirect> commands(static_cast<size_t>(instance_count) * 2 * region_count);
+        draws.BeginPass();
+        for (uint32_t i = 0; i < instance_count; i++)
+        {
+            draws.AddDraw(i);
+        }
+        const vector<Batch>& batches = draws.EndPass(commands.data());
+        uint32_t command_count = 0;
+        for (const Batch& batch : batches)
+        {
+            for (uint32_t i = 0; i < batch.command_count; i++)
+            {
+                const RHI_DrawIndexedIndirect& command = commands[batch.command_offset + i];
+                check(command.instance_offset < instance_count && command.index_offset == 36 * (command.instance_offset % model_count), "a command points to its instance");
+            }
+            command_count += batch.command_count;
+        }
+        check(batches.size() == min(instance_count, model_count) && command_count == instance_count, "every model is a single batch");
+
+        // Steady state, a tenth of the instances move every frame
+        Stopwatch timer;
+        uint64_t upload_count = 0;
+        for (uint32_t iteration = 0; iteration < iterations; iteration++)
+        {
+            for (uint32_t i = iteration % 10; i < instance_count; i += 10)
+            {
+                transforms[i] = Matrix::CreateTranslation(Vector3(0.0f, 0.01f, 0.0f)) * transforms[i];
+            }
+            update(iteration % region_count);
+            upload_count += draws.GetUploadCount();
+
+            draws.BeginPass();
+            for (uint32_t i = 0; i < instance_count; i++)
+            {
+                draws.AddDraw(i);
+            }
+            draws.EndPass(commands.data());
+        }
+        const float time_frame = timer.GetElapsedTimeMs() / iterations;
+
+        LOG_INFO("%d instances: update and pass %.3f ms, %.1f KB written per frame (%.1f KB if everything was), checks %s",
+            instance_count,
+            time_frame,
+            static_cast<float>(upload_count * sizeof(DrawInstance)) / iterations / 1024.0f,
+            static_cast<float>(instance_count * sizeof(DrawInstance)) / 1024.0f,
+            valid ? "pass" : "fail"
+        );
+
+        return valid;
+    }
+}
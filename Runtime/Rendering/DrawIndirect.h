@@ -0,0 +1,125 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include <unordered_map>
+#include "../Core/EngineDefs.h"
+#include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+//===============================
+
+namespace Spartan
+{
+    class Model;
+    class RHI_BindlessTable;
+    struct RHI_DrawIndexedIndirect;
+
+    // One element of the instance buffer, matches Instance in Common_Instance.hlsl
+    struct DrawInstance
+    {
+        Math::Matrix transform;
+        Math::Matrix transform_previous;    // what the velocity is computed against, settles to the transform a frame after it stops moving
+        Math::Vector3 aabb_min;
+        uint32_t material_index = 0;
+        Math::Vector3 aabb_max;
+        uint32_t index_count    = 0;
+        uint32_t index_offset   = 0;
+        int32_t vertex_offset   = 0;
+        uint32_t padding[2]     = {};
+    };
+
+    // Indirect draw submission. Every renderable which might be drawn has a persistent slot in the instance buffer,
+    // which is only written when the instance changes. Passes then add the instances they draw, and get back
+    // one multi-draw per model, where each command carries its instance index in its first instance.
+    // The instance and command buffers are split in regions (one per frame in flight), so a region's
+    // changes are kept until that region is written. Nothing here touches the GPU, so it can run headless.
+    class SPARTAN_CLASS DrawIndirect
+    {
+    public:
+        struct Batch
+        {
+            const Model* model      = nullptr;
+            uint32_t command_offset = 0; // from the start of the command buffer, not the region
+            uint32_t command_count  = 0;
+        };
+
+        DrawIndirect(const uint32_t instance_capacity, const uint32_t command_capacity, const uint32_t region_count);
+        ~DrawIndirect() = default;
+
+        // Instances, updated once per frame
+        void BeginUpdate();
+        bool UpdateInstance(const uint64_t id, const Model* model, const Math::Matrix& transform, const Math::BoundingBox& aabb, const uint32_t material_index, const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset);
+        void EndUpdate(const uint32_t region, RHI_BindlessTable* table); // removes instances which weren't updated and writes the region's changes
+
+        // Draws, one pass at a time, using the region of the last update
+        void BeginPass();
+        bool AddDraw(const uint64_t id);
+        bool AddDraw(const uint64_t id, const uint32_t index_count, const uint32_t index_offset); // draws other indices (e.g. another level of detail) than the instance's
+        const std::vector<Batch>& EndPass(RHI_DrawIndexedIndirect* commands);
+
+        // Moves, stops and removes instances of a generated scene, only the ones that changed may be written and every model has to be one batch
+        static bool Benchmark(uint32_t instance_count, uint32_t iterations = 100);
+
+        // Properties
+        uint32_t GetDirtyCount(const uint32_t region) const;
+        const DrawInstance* GetInstance(const uint64_t id) const;
+        uint32_t GetInstanceCount()     const { return static_cast<uint32_t>(m_slots.size()); }
+        uint32_t GetInstanceCapacity()  const { return m_instance_capacity; }
+        uint32_t GetUploadCount()       const { return m_upload_count; }
+        uint32_t GetCommandCount()      const { return m_command_count; }
+
+    private:
+        void MarkDirty(const uint32_t slot);
+
+        // Instances, <id, slot>
+        std::unordered_map<uint64_t, uint32_t> m_slots;
+        std::vector<uint32_t> m_slots_free;
+        std::vector<DrawInstance> m_instances;
+        std::vector<const Model*> m_models;
+        std::vector<uint64_t> m_updated;    // the frame each slot was last updated in
+        uint32_t m_slot_next            = 0;
+        uint32_t m_instance_capacity    = 0;
+        uint64_t m_frame                = 0;
+        bool m_full                     = false;
+
+        // Changes which some region hasn't received yet, a bit per region for every slot
+        std::vector<uint8_t> m_dirty_regions;
+        std::vector<uint32_t> m_dirty_slots;
+        uint32_t m_region_count = 0;
+        uint32_t m_region       = 0;
+        uint32_t m_upload_count = 0;
+
+        // Commands, written by every pass of the frame one after the other
+        struct PassDraw
+        {
+            uint32_t slot;
+            uint32_t index_count;
+            uint32_t index_offset;
+        };
+        std::vector<PassDraw> m_pass_draws;
+        std::vector<Batch> m_batches;
+        uint32_t m_command_capacity = 0;
+        uint32_t m_command_count    = 0;
+    };
+}
@@ -0,0 +1,242 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "DynamicResolution.h"
+#include "../Logging/Log.h"
+#include "../Math/MathHelper.h"
+//===============================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    bool DynamicResolution::Update(const float time_cpu_ms, const float time_gpu_ms, const float delta_time_sec)
+    {
+        if (delta_time_sec <= 0.0f)
+            return false;
+
+        // Wait for the profiler to measure the current level
+        if (m_time_settle_sec > 0.0f)
+        {
+            m_time_settle_sec -= delta_time_sec;
+            return false;
+        }
+
+        // Without gpu timings (e.g. gpu profiling is disabled) there is nothing to go by
+        if (time_gpu_ms <= 0.0f)
+            return false;
+
+        // Smooth out the timings
+        if (m_time_sampled_sec == 0.0f)
+        {
+            m_time_cpu_avg = time_cpu_ms;
+            m_time_gpu_avg = time_gpu_ms;
+        }
+        else
+        {
+            const float weight  = Helper::Clamp(delta_time_sec / m_smoothing_sec, 0.0f, 1.0f);
+            m_time_cpu_avg      = Helper::Lerp(m_time_cpu_avg, time_cpu_ms, weight);
+            m_time_gpu_avg      = Helper::Lerp(m_time_gpu_avg, time_gpu_ms, weight);
+        }
+
+        m_time_sampled_sec += delta_time_sec;
+        if (m_time_sampled_sec < m_sample_window_sec)
+            return false;
+
+        // If the cpu is the bottleneck, lowering the resolution won't help, so hold the current level
+        const bool cpu_bound = m_time_cpu_avg >= m_time_gpu_avg && m_time_cpu_avg > m_target_frame_time_ms;
+        if (cpu_bound)
+            return false;
+
+        const float scale = GetScale();
+
+        // Over budget, jump straight to the level which is predicted to fit (gpu cost roughly scales with the pixel count)
+        if (m_time_gpu_avg > m_target_frame_time_ms * m_tolerance_over && m_level > 0)
+        {
+            const float scale_desired = scale * Helper::Sqrt((m_target_frame_time_ms * m_headroom) / m_time_gpu_avg);
+
+            uint32_t level = m_level - 1;
+            while (level > 0 && GetScale(level) > scale_desired)
+            {
+                level--;
+            }
+
+            SetLevel(level);
+            return true;
+        }
+
+        // Under budget, go up a level at a time, as long as the next level is predicted to fit with some headroom
+        if (m_level < level_full)
+        {
+            const float scale_next      = GetScale(m_level + 1);
+            const float time_predicted  = m_time_gpu_avg * (scale_next * scale_next) / (scale * scale);
+
+            if (time_predicted < m_target_frame_time_ms * m_headroom)
+            {
+                SetLevel(m_level + 1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void DynamicResolution::Reset()
+    {
+        m_level             = level_full;
+        m_time_cpu_avg      = 0.0f;
+        m_time_gpu_avg      = 0.0f;
+        m_time_sampled_sec  = 0.0f;
+        m_time_settle_sec   = 0.0f;
+    }
+
+    void DynamicResolution::SetTargetFrameTime(const float time_ms)
+    {
+        if (time_ms <= 0.0f)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        m_target_frame_time_ms = time_ms;
+    }
+
+    void DynamicResolution::SetLevel(const uint32_t level)
+    {
+        m_level             = Helper::Min(level, level_full);
+        m_time_sampled_sec  = 0.0f;
+        m_time_settle_sec   = m_settle_sec;
+    }
+
+    bool DynamicResolution::Simulate(const float target_frame_time_ms /*= 16.6f*/)
+    {
+        if (target_frame_time_ms <= 0.0f)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // A synthetic scene, its gpu cost is a fixed part plus a part which scales with the pixel count
+        struct Phase
+        {
+            const char* name;
+            float load;
+            float time_cpu_ms;
+            float duration_sec;
+        };
+
+        const Phase phases[] =
+        {
+            { "light",      0.5f, 5.0f,  8.0f },
+            { "heavy",      1.4f, 5.0f,  8.0f },
+            { "extreme",    4.0f, 5.0f,  8.0f },
+            { "moderate",   0.9f, 5.0f,  8.0f },
+            { "cpu bound",  1.4f, 25.0f, 8.0f }
+        };
+
+        const float time_fixed_ms       = 0.1f * target_frame_time_ms;
+        const float time_per_load_ms    = 0.75f * target_frame_time_ms;
+        auto time_gpu = [time_fixed_ms, time_per_load_ms](const float load, const uint32_t level)
+        {
+            const float scale = GetScale(level);
+            return time_fixed_ms + load * time_per_load_ms * scale * scale;
+        };
+
+        // The profiler refreshes its timings periodically, emulate that, along with some deterministic noise
+        const float profiler_interval_sec   = 0.3f;
+        float profiler_time_sec             = profiler_interval_sec;
+        float profiler_cpu_ms               = 0.0f;
+        float profiler_gpu_ms               = 0.0f;
+        uint32_t noise_state                = 1337;
+        auto noise = [&noise_state]()
+        {
+            noise_state = noise_state * 1664525u + 1013904223u;
+            return 1.0f + ((static_cast<float>(noise_state >> 8) / 16777216.0f) * 2.0f - 1.0f) * 0.04f;
+        };
+
+        DynamicResolution controller;
+        controller.SetTargetFrameTime(target_frame_time_ms);
+
+        bool passed = true;
+        for (const Phase& phase : phases)
+        {
+            const uint32_t level_start      = controller.GetLevel();
+            uint32_t changes_settled        = 0;
+            float time_phase_sec            = 0.0f;
+
+            while (time_phase_sec < phase.duration_sec)
+            {
+                const float time_cpu_ms = phase.time_cpu_ms;
+                const float time_gpu_ms = time_gpu(phase.load, controller.GetLevel());
+
+                profiler_time_sec += Helper::Max(time_cpu_ms, time_gpu_ms) / 1000.0f;
+                if (profiler_time_sec >= profiler_interval_sec)
+                {
+                    profiler_time_sec   = 0.0f;
+                    profiler_cpu_ms     = time_cpu_ms * noise();
+                    profiler_gpu_ms     = time_gpu_ms * noise();
+                }
+
+                const float delta_time_sec = Helper::Max(time_cpu_ms, time_gpu_ms) / 1000.0f;
+                if (controller.Update(profiler_cpu_ms, profiler_gpu_ms, delta_time_sec) && time_phase_sec > phase.duration_sec * 0.5f)
+                {
+                    changes_settled++;
+                }
+
+                time_phase_sec += delta_time_sec;
+            }
+
+            // Judge the phase
+            const uint32_t level    = controller.GetLevel();
+            const float time_ms     = time_gpu(phase.load, level);
+            const bool cpu_bound    = phase.time_cpu_ms > target_frame_time_ms;
+            bool phase_passed       = changes_settled == 0;
+            if (cpu_bound)
+            {
+                phase_passed = phase_passed && level == level_start;
+            }
+            else
+            {
+                const bool fits     = time_ms <= target_frame_time_ms * controller.m_tolerance_over || level == 0;
+                const bool wasteful = level < level_full && time_gpu(phase.load, level + 1) < target_frame_time_ms * controller.m_headroom * 0.9f;
+                phase_passed        = phase_passed && fits && !wasteful;
+            }
+
+            LOG_INFO("%s: level %d (scale %.3f), gpu %.2f ms, target %.2f ms, %d changes after settling, %s",
+                phase.name,
+                level,
+                GetScale(level),
+                time_ms,
+                target_frame_time_ms,
+                changes_settled,
+                phase_passed ? "passed" : "failed"
+            );
+
+            passed = passed && phase_passed;
+        }
+
+        return passed;
+    }
+}
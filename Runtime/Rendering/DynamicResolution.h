@@ -0,0 +1,79 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Spartan
+{
+    // Picks a resolution scale from measured frame times so that the GPU hits a target frame time.
+    // Scales are quantized into a few levels, so that the renderer can keep a set of render targets
+    // per level and switch between them without re-creating anything.
+    // The controller only sees numbers, it doesn't touch the renderer, so it can run headless.
+    class SPARTAN_CLASS DynamicResolution
+    {
+    public:
+        static const uint32_t level_count   = 5;
+        static const uint32_t level_full    = level_count - 1;
+
+        DynamicResolution() = default;
+        ~DynamicResolution() = default;
+
+        // Feeds the last measured cpu and gpu times (in ms), returns true if the level changed
+        bool Update(float time_cpu_ms, float time_gpu_ms, float delta_time_sec);
+
+        // Goes back to full resolution and forgets any measurements
+        void Reset();
+
+        // Runs the controller against a synthetic gpu load, logs how it responded and whether it behaved
+        static bool Simulate(float target_frame_time_ms = 16.6f);
+
+        // Properties
+        static float GetScale(const uint32_t level) { return 0.5f + 0.5f * static_cast<float>(level) / static_cast<float>(level_full); }
+        float GetScale()                    const   { return GetScale(m_level); }
+        uint32_t GetLevel()                 const   { return m_level; }
+        float GetTargetFrameTime()          const   { return m_target_frame_time_ms; }
+        void SetTargetFrameTime(float time_ms);
+        float GetTimeCpuAverage()           const   { return m_time_cpu_avg; }
+        float GetTimeGpuAverage()           const   { return m_time_gpu_avg; }
+
+    private:
+        void SetLevel(uint32_t level);
+
+        // Tuning
+        const float m_smoothing_sec         = 0.25f;    // time constant of the timing averages
+        const float m_sample_window_sec     = 0.5f;     // how long to measure a level before judging it
+        const float m_settle_sec            = 0.5f;     // profiler timings are refreshed periodically, so ignore them for a while after a change
+        const float m_tolerance_over        = 1.05f;    // scale down once the gpu is this much over the target
+        const float m_headroom              = 0.9f;     // scale up only if the next level is predicted to stay under this fraction of the target
+
+        // State
+        uint32_t m_level                    = level_full;
+        float m_target_frame_time_ms        = 16.6f;
+        float m_time_cpu_avg                = 0.0f;
+        float m_time_gpu_avg                = 0.0f;
+        float m_time_sampled_sec            = 0.0f;
+        float m_time_settle_sec             = 0.0f;
+    };
+}
@@ -0,0 +1,543 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "LightClusters.h"
+#include <random>
+#include <cstring>
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+//======================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    static const uint32_t cluster_tile_count = cluster_grid_x * cluster_grid_y;
+
+    inline bool sphere_intersects_aabb(const Vector4& sphere, const Vector3& min, const Vector3& max)
+    {
+        float distance_squared = 0.0f;
+
+        const float x = Helper::Clamp(sphere.x, min.x, max.x) - sphere.x;
+        const float y = Helper::Clamp(sphere.y, min.y, max.y) - sphere.y;
+        const float z = Helper::Clamp(sphere.z, min.z, max.z) - sphere.z;
+        distance_squared = x * x + y * y + z * z;
+
+        return distance_squared <= sphere.w * sphere.w;
+    }
+
+    inline uint32_t ndc_to_tile(const float ndc, const uint32_t tile_count, const int32_t expand)
+    {
+        const float tile = Helper::Floor((ndc * 0.5f + 0.5f) * tile_count) + expand;
+        return static_cast<uint32_t>(Helper::Clamp(tile, 0.0f, static_cast<float>(tile_count - 1)));
+    }
+
+    LightClusters::LightClusters(Context* context /*= nullptr*/)
+    {
+        // Without a context, the builder runs single-threaded and without profiling
+        m_context = context;
+        if (m_context)
+        {
+            m_profiler  = m_context->GetSubsystem<Profiler>();
+            m_threading = m_context->GetSubsystem<Threading>();
+        }
+
+        m_cluster_min.resize(cluster_count);
+        m_cluster_max.resize(cluster_count);
+        m_slice_indices.resize(cluster_grid_z);
+        m_slice_counts.resize(cluster_grid_z, vector<uint16_t>(cluster_tile_count, 0));
+        m_offset_count.resize(cluster_count, 0);
+        m_light_indices.reserve(cluster_max_light_indices);
+    }
+
+    bool LightClusters::Build(const Matrix& view, const Matrix& projection, const float near_plane, const float far_plane, const vector<ClusterLight>& lights)
+    {
+        if (m_profiler)
+        {
+            TIME_BLOCK_START_NAMED(m_profiler, "LightClusters::Build");
+        }
+
+        bool result = Prepare(view, projection, near_plane, far_plane, lights);
+        if (result)
+        {
+            // Slices are independent of each other, so they are distributed across threads
+            if (m_threading)
+            {
+                auto build_slices = [this](uint32_t slice_start, uint32_t slice_end) { BuildSlices(slice_start, slice_end); };
+                m_threading->AddTaskLoop(build_slices, cluster_grid_z);
+            }
+            else
+            {
+                BuildSlices(0, cluster_grid_z);
+            }
+
+            Compact();
+        }
+
+        if (m_profiler)
+        {
+            TIME_BLOCK_END(m_profiler);
+        }
+
+        return result;
+    }
+
+    bool LightClusters::BuildReference(const Matrix& view, const Matrix& projection, const float near_plane, const float far_plane, const vector<ClusterLight>& lights)
+    {
+        // Shares nothing with the fast path (slice ranges, tile rectangles, cluster bounds), so that it can catch their mistakes
+        if (projection.m23 != 1.0f || near_plane <= 0.0f || far_plane <= near_plane)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        const float log_far_over_near   = Helper::Log(far_plane / near_plane);
+        m_slice_scale                   = static_cast<float>(cluster_grid_z) / log_far_over_near;
+        m_slice_bias                    = static_cast<float>(cluster_grid_z) * Helper::Log(near_plane) / log_far_over_near;
+
+        // The cluster bounds are about to be overwritten, make sure that the fast path re-computes its own
+        m_projection_x = 0.0f;
+
+        // Un-project the eight corners of every froxel through the inverse projection and keep the extremes
+        const Matrix projection_inverse = projection.Inverted();
+        for (uint32_t cluster_index = 0; cluster_index < cluster_count; cluster_index++)
+        {
+            const uint32_t x = cluster_index % cluster_grid_x;
+            const uint32_t y = (cluster_index / cluster_grid_x) % cluster_grid_y;
+            const uint32_t z = cluster_index / cluster_tile_count;
+
+            const float depth_near  = near_plane * Helper::Pow(far_plane / near_plane, static_cast<float>(z) / cluster_grid_z);
+            const float depth_far   = near_plane * Helper::Pow(far_plane / near_plane, static_cast<float>(z + 1) / cluster_grid_z);
+            const float ndc_z_near  = (Vector3(0.0f, 0.0f, depth_near) * projection).z;
+            const float ndc_z_far   = (Vector3(0.0f, 0.0f, depth_far) * projection).z;
+            const float ndc_left    = -1.0f + 2.0f * static_cast<float>(x) / cluster_grid_x;
+            const float ndc_right   = -1.0f + 2.0f * static_cast<float>(x + 1) / cluster_grid_x;
+            const float ndc_top     = 1.0f - 2.0f * static_cast<float>(y) / cluster_grid_y;
+            const float ndc_bottom  = 1.0f - 2.0f * static_cast<float>(y + 1) / cluster_grid_y;
+
+            Vector3 cluster_min = Vector3::Infinity;
+            Vector3 cluster_max = Vector3::InfinityNeg;
+            for (uint32_t corner = 0; corner < 8; corner++)
+            {
+                const Vector3 corner_ndc    = Vector3((corner & 1) ? ndc_right : ndc_left, (corner & 2) ? ndc_top : ndc_bottom, (corner & 4) ? ndc_z_far : ndc_z_near);
+                const Vector3 corner_view   = corner_ndc * projection_inverse;
+                cluster_min = Vector3(Helper::Min(cluster_min.x, corner_view.x), Helper::Min(cluster_min.y, corner_view.y), Helper::Min(cluster_min.z, corner_view.z));
+                cluster_max = Vector3(Helper::Max(cluster_max.x, corner_view.x), Helper::Max(cluster_max.y, corner_view.y), Helper::Max(cluster_max.z, corner_view.z));
+            }
+            m_cluster_min[cluster_index] = cluster_min;
+            m_cluster_max[cluster_index] = cluster_max;
+        }
+
+        // Lights in view space
+        const uint32_t light_count = Helper::Min(static_cast<uint32_t>(lights.size()), cluster_max_lights);
+        m_lights_view.resize(light_count);
+        for (uint32_t i = 0; i < light_count; i++)
+        {
+            const Vector3 position  = lights[i].position * view;
+            m_lights_view[i]        = Vector4(position.x, position.y, position.z, lights[i].range);
+        }
+
+        // Every light against every cluster
+        m_light_indices.clear();
+        m_overflow = false;
+        for (uint32_t cluster_index = 0; cluster_index < cluster_count; cluster_index++)
+        {
+            const uint32_t offset   = static_cast<uint32_t>(m_light_indices.size());
+            uint32_t count          = 0;
+
+            for (uint32_t light_index = 0; light_index < light_count; light_index++)
+            {
+                if (m_lights_view[light_index].w <= 0.0f)
+                    continue;
+
+                if (!sphere_intersects_aabb(m_lights_view[light_index], m_cluster_min[cluster_index], m_cluster_max[cluster_index]))
+                    continue;
+
+                if (m_light_indices.size() == cluster_max_light_indices)
+                {
+                    m_overflow = true;
+                    break;
+                }
+
+                m_light_indices.emplace_back(static_cast<uint8_t>(light_index));
+                count++;
+            }
+
+            m_offset_count[cluster_index] = offset | (count << 16);
+        }
+
+        return true;
+    }
+
+    bool LightClusters::Prepare(const Matrix& view, const Matrix& projection, const float near_plane, const float far_plane, const vector<ClusterLight>& lights)
+    {
+        // Clusters are defined in a perspective projection
+        if (projection.m23 != 1.0f || near_plane <= 0.0f || far_plane <= near_plane)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // Re-compute cluster bounds only when the projection changes
+        if (m_projection_x != projection.m00 || m_projection_y != projection.m11 || m_near_plane != near_plane || m_far_plane != far_plane)
+        {
+            ComputeClusterBounds(projection, near_plane, far_plane);
+        }
+
+        // Light indices are stored as bytes
+        if (lights.size() > cluster_max_lights)
+        {
+            LOG_WARNING("Only the first %d of %d lights will be clustered", cluster_max_lights, static_cast<uint32_t>(lights.size()));
+        }
+        const uint32_t light_count = Helper::Min(static_cast<uint32_t>(lights.size()), cluster_max_lights);
+
+        // Transform lights to view space and find which depth slices they can touch
+        m_lights_view.resize(light_count);
+        m_lights_slice_range.resize(light_count);
+        m_lights_tile_rect.resize(light_count);
+        for (uint32_t i = 0; i < light_count; i++)
+        {
+            const Vector3 position  = lights[i].position * view;
+            const float range       = lights[i].range;
+            m_lights_view[i]        = Vector4(position.x, position.y, position.z, range);
+
+            // Lights which are behind the near plane or beyond the far plane get an empty range
+            if (range <= 0.0f || position.z + range < near_plane || position.z - range > far_plane)
+            {
+                m_lights_slice_range[i] = 1; // first > last
+                continue;
+            }
+
+            // Expand by a slice on each side, the sphere test is what decides and this keeps float imprecision out of the way
+            const uint32_t slice_first  = GetSlice(position.z - range);
+            const uint32_t slice_last   = GetSlice(position.z + range);
+            const uint32_t slice_min    = slice_first > 0 ? slice_first - 1 : 0;
+            const uint32_t slice_max    = Helper::Min(slice_last + 1, cluster_grid_z - 1);
+            m_lights_slice_range[i]     = slice_min | (slice_max << 16);
+
+            // Project the sphere's bounding box to find which tiles it can touch (the smallest depth gives the largest footprint).
+            // The depths are those of the slices rather than the sphere's, as a cluster's bounds span the whole depth of its slice.
+            const float depth_min   = near_plane * Helper::Pow(far_plane / near_plane, static_cast<float>(slice_min) / cluster_grid_z);
+            const float depth_max   = near_plane * Helper::Pow(far_plane / near_plane, static_cast<float>(slice_max + 1) / cluster_grid_z);
+            const float x_min       = position.x - range;
+            const float x_max       = position.x + range;
+            const float y_min       = position.y - range;
+            const float y_max       = position.y + range;
+            const float ndc_x_min   = x_min * m_projection_x / (x_min < 0.0f ? depth_min : depth_max);
+            const float ndc_x_max   = x_max * m_projection_x / (x_max > 0.0f ? depth_min : depth_max);
+            const float ndc_y_min   = y_min * m_projection_y / (y_min < 0.0f ? depth_min : depth_max);
+            const float ndc_y_max   = y_max * m_projection_y / (y_max > 0.0f ? depth_min : depth_max);
+
+            // Tile rows go top to bottom, so y is flipped. Expanded by a tile on each side, like the slices.
+            const uint32_t tile_x_first = ndc_to_tile(ndc_x_min, cluster_grid_x, -1);
+            const uint32_t tile_x_last  = ndc_to_tile(ndc_x_max, cluster_grid_x, 1);
+            const uint32_t tile_y_first = ndc_to_tile(-ndc_y_max, cluster_grid_y, -1);
+            const uint32_t tile_y_last  = ndc_to_tile(-ndc_y_min, cluster_grid_y, 1);
+            m_lights_tile_rect[i]       = tile_x_first | (tile_x_last << 8) | (tile_y_first << 16) | (tile_y_last << 24);
+        }
+
+        return true;
+    }
+
+    void LightClusters::BuildSlices(const uint32_t slice_start, const uint32_t slice_end)
+    {
+        const uint32_t light_count = static_cast<uint32_t>(m_lights_view.size());
+
+        // One bit per light, per tile
+        vector<array<uint64_t, cluster_max_lights / 64>> tile_masks(cluster_tile_count);
+        vector<uint8_t> slice_lights;
+        slice_lights.reserve(light_count);
+
+        for (uint32_t slice = slice_start; slice < slice_end; slice++)
+        {
+            vector<uint8_t>& indices    = m_slice_indices[slice];
+            vector<uint16_t>& counts    = m_slice_counts[slice];
+            const uint32_t cluster_offset = slice * cluster_tile_count;
+            indices.clear();
+            slice_lights.clear();
+            for (auto& mask : tile_masks)
+            {
+                mask.fill(0);
+            }
+
+            // Test the lights which overlap this slice, against the tiles they can touch
+            for (uint32_t i = 0; i < light_count; i++)
+            {
+                const uint32_t slice_first  = m_lights_slice_range[i] & 0xFFFF;
+                const uint32_t slice_last   = m_lights_slice_range[i] >> 16;
+                if (slice < slice_first || slice > slice_last)
+                    continue;
+
+                const uint32_t rect         = m_lights_tile_rect[i];
+                const uint32_t x_first      = rect & 0xFF;
+                const uint32_t x_last       = (rect >> 8) & 0xFF;
+                const uint32_t y_first      = (rect >> 16) & 0xFF;
+                const uint32_t y_last       = rect >> 24;
+                bool touches_slice          = false;
+
+                for (uint32_t y = y_first; y <= y_last; y++)
+                {
+                    for (uint32_t x = x_first; x <= x_last; x++)
+                    {
+                        const uint32_t tile = x + y * cluster_grid_x;
+                        if (sphere_intersects_aabb(m_lights_view[i], m_cluster_min[cluster_offset + tile], m_cluster_max[cluster_offset + tile]))
+                        {
+                            tile_masks[tile][i / 64] |= 1ull << (i % 64);
+                            touches_slice = true;
+                        }
+                    }
+                }
+
+                if (touches_slice)
+                {
+                    slice_lights.emplace_back(static_cast<uint8_t>(i));
+                }
+            }
+
+            // Emit the lights of each tile, in ascending order
+            for (uint32_t tile = 0; tile < cluster_tile_count; tile++)
+            {
+                const auto& mask    = tile_masks[tile];
+                uint16_t count      = 0;
+
+                for (const uint8_t light_index : slice_lights)
+                {
+                    if (mask[light_index / 64] & (1ull << (light_index % 64)))
+                    {
+                        indices.emplace_back(light_index);
+                        count++;
+                    }
+                }
+
+                counts[tile] = count;
+            }
+        }
+    }
+
+    void LightClusters::Compact()
+    {
+        m_light_indices.clear();
+        m_overflow = false;
+
+        for (uint32_t slice = 0; slice < cluster_grid_z; slice++)
+        {
+            const vector<uint8_t>& indices  = m_slice_indices[slice];
+            const vector<uint16_t>& counts  = m_slice_counts[slice];
+            uint32_t read                   = 0;
+
+            for (uint32_t tile = 0; tile < cluster_tile_count; tile++)
+            {
+                const uint32_t offset   = static_cast<uint32_t>(m_light_indices.size());
+                const uint32_t capacity = cluster_max_light_indices - offset;
+                uint32_t count          = counts[tile];
+
+                // Drop whatever doesn't fit, lights will go missing but nothing will read out of bounds
+                if (count > capacity)
+                {
+                    m_overflow = true;
+                    count = capacity;
+                }
+
+                m_light_indices.insert(m_light_indices.end(), indices.begin() + read, indices.begin() + read + count);
+                m_offset_count[slice * cluster_tile_count + tile] = offset | (count << 16);
+                read += counts[tile];
+            }
+        }
+    }
+
+    void LightClusters::ComputeClusterBounds(const Matrix& projection, const float near_plane, const float far_plane)
+    {
+        m_projection_x  = projection.m00;
+        m_projection_y  = projection.m11;
+        m_near_plane    = near_plane;
+        m_far_plane     = far_plane;
+
+        // slice = log(depth) * scale - bias
+        const float log_far_over_near   = Helper::Log(far_plane / near_plane);
+        m_slice_scale                   = static_cast<float>(cluster_grid_z) / log_far_over_near;
+        m_slice_bias                    = static_cast<float>(cluster_grid_z) * Helper::Log(near_plane) / log_far_over_near;
+
+        for (uint32_t z = 0; z < cluster_grid_z; z++)
+        {
+            // Exponential depth slices
+            const float depth_near  = near_plane * Helper::Pow(far_plane / near_plane, static_cast<float>(z) / cluster_grid_z);
+            const float depth_far   = near_plane * Helper::Pow(far_plane / near_plane, static_cast<float>(z + 1) / cluster_grid_z);
+
+            for (uint32_t y = 0; y < cluster_grid_y; y++)
+            {
+                // Tile rows go top to bottom, same as uv
+                const float ndc_top     = 1.0f - 2.0f * static_cast<float>(y) / cluster_grid_y;
+                const float ndc_bottom  = 1.0f - 2.0f * static_cast<float>(y + 1) / cluster_grid_y;
+
+                for (uint32_t x = 0; x < cluster_grid_x; x++)
+                {
+                    const float ndc_left    = -1.0f + 2.0f * static_cast<float>(x) / cluster_grid_x;
+                    const float ndc_right   = -1.0f + 2.0f * static_cast<float>(x + 1) / cluster_grid_x;
+
+                    // Un-project the tile's edges at both depths and keep the extremes
+                    const float x_near_left     = ndc_left      * depth_near    / m_projection_x;
+                    const float x_far_left      = ndc_left      * depth_far     / m_projection_x;
+                    const float x_near_right    = ndc_right     * depth_near    / m_projection_x;
+                    const float x_far_right     = ndc_right     * depth_far     / m_projection_x;
+                    const float y_near_bottom   = ndc_bottom    * depth_near    / m_projection_y;
+                    const float y_far_bottom    = ndc_bottom    * depth_far     / m_projection_y;
+                    const float y_near_top      = ndc_top       * depth_near    / m_projection_y;
+                    const float y_far_top       = ndc_top       * depth_far     / m_projection_y;
+
+                    const uint32_t cluster_index    = x + cluster_grid_x * (y + cluster_grid_y * z);
+                    m_cluster_min[cluster_index]    = Vector3(Helper::Min(x_near_left, x_far_left), Helper::Min(y_near_bottom, y_far_bottom), depth_near);
+                    m_cluster_max[cluster_index]    = Vector3(Helper::Max(x_near_right, x_far_right), Helper::Max(y_near_top, y_far_top), depth_far);
+                }
+            }
+        }
+    }
+
+    uint32_t LightClusters::GetSlice(const float depth_view) const
+    {
+        if (depth_view <= m_near_plane)
+            return 0;
+
+        const float slice = Helper::Floor(Helper::Log(depth_view) * m_slice_scale - m_slice_bias);
+        return static_cast<uint32_t>(Helper::Clamp(slice, 0.0f, static_cast<float>(cluster_grid_z - 1)));
+    }
+
+    void LightClusters::Fill(BufferLightClusters* buffer) const
+    {
+        if (!buffer)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        buffer->light_count_slice_scale_bias.x = static_cast<float>(m_lights_view.size());
+        buffer->light_count_slice_scale_bias.y = m_slice_scale;
+        buffer->light_count_slice_scale_bias.z = m_slice_bias;
+        memcpy(buffer->offset_count, m_offset_count.data(), m_offset_count.size() * sizeof(uint32_t));
+        memcpy(buffer->light_indices, m_light_indices.data(), m_light_indices.size() * sizeof(uint8_t));
+    }
+
+    bool LightClusters::Benchmark(Context* context, const uint32_t light_count, const uint32_t iterations /*= 100*/)
+    {
+        if (light_count == 0 || iterations == 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // A camera looking down +Z, with a 16:9 aspect ratio
+        const float near_plane      = 0.3f;
+        const float far_plane       = 1000.0f;
+        const Matrix view           = Matrix::CreateLookAtLH(Vector3::Zero, Vector3::Forward, Vector3::Up);
+        const Matrix projection     = Matrix::CreatePerspectiveFieldOfViewLH(Helper::DegreesToRadians(60.0f), 16.0f / 9.0f, near_plane, far_plane);
+
+        // Scatter lights in front of the camera, with a fixed seed so that runs are comparable
+        vector<ClusterLight> lights(light_count);
+        mt19937 generator(1337);
+        uniform_real_distribution<float> distribution_xy(-60.0f, 60.0f);
+        uniform_real_distribution<float> distribution_z(1.0f, 150.0f);
+        uniform_real_distribution<float> distribution_range(1.0f, 12.0f);
+        for (ClusterLight& light : lights)
+        {
+            light.position  = Vector3(distribution_xy(generator), distribution_xy(generator) * 0.5f, distribution_z(generator));
+            light.range     = distribution_range(generator);
+        }
+
+        LightClusters clusters(context);
+        LightClusters clusters_reference;
+
+        // Parallel
+        Stopwatch timer;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            clusters.Build(view, projection, near_plane, far_plane, lights);
+        }
+        const float time_build = timer.GetElapsedTimeMs() / iterations;
+
+        // Reference
+        timer.Start();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            clusters_reference.BuildReference(view, projection, near_plane, far_plane, lights);
+        }
+        const float time_reference = timer.GetElapsedTimeMs() / iterations;
+
+        // The two builders derive the cluster bounds differently, so a light which grazes a cluster can land on either side
+        // of it due to float rounding. Such lights are tolerated, anything else is a mismatch.
+        uint32_t mismatches = 0;
+        uint32_t grazing    = 0;
+        for (uint32_t cluster_index = 0; cluster_index < cluster_count; cluster_index++)
+        {
+            array<bool, cluster_max_lights> in_build      = {};
+            array<bool, cluster_max_lights> in_reference  = {};
+            const uint32_t offset_count             = clusters.m_offset_count[cluster_index];
+            const uint32_t offset_count_reference   = clusters_reference.m_offset_count[cluster_index];
+            for (uint32_t i = 0; i < (offset_count >> 16); i++)
+            {
+                in_build[clusters.m_light_indices[(offset_count & 0xFFFF) + i]] = true;
+            }
+            for (uint32_t i = 0; i < (offset_count_reference >> 16); i++)
+            {
+                in_reference[clusters_reference.m_light_indices[(offset_count_reference & 0xFFFF) + i]] = true;
+            }
+
+            const Vector3& cluster_min = clusters_reference.m_cluster_min[cluster_index];
+            const Vector3& cluster_max = clusters_reference.m_cluster_max[cluster_index];
+            for (uint32_t light_index = 0; light_index < clusters_reference.m_lights_view.size(); light_index++)
+            {
+                if (in_build[light_index] == in_reference[light_index])
+                    continue;
+
+                const Vector4& sphere   = clusters_reference.m_lights_view[light_index];
+                const Vector3 closest   = Vector3(Helper::Clamp(sphere.x, cluster_min.x, cluster_max.x), Helper::Clamp(sphere.y, cluster_min.y, cluster_max.y), Helper::Clamp(sphere.z, cluster_min.z, cluster_max.z));
+                const float distance    = Vector3::Distance(closest, Vector3(sphere.x, sphere.y, sphere.z));
+                if (Helper::Abs(distance - sphere.w) <= 1e-3f * Helper::Max(sphere.w, 1.0f))
+                {
+                    grazing++;
+                }
+                else
+                {
+                    mismatches++;
+                }
+            }
+        }
+
+        const bool match = mismatches == 0 && !clusters.IsOverflowing() && !clusters_reference.IsOverflowing();
+        LOG_INFO("%d lights, %d clusters, %d indices: build %.3f ms, reference %.3f ms, results %s (%d grazing, %d mismatching)",
+            light_count,
+            cluster_count,
+            clusters.GetLightIndexCount(),
+            time_build,
+            time_reference,
+            match ? "match" : "differ",
+            grazing,
+            mismatches
+        );
+
+        return match;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========================
+#include <vector>
+#include <array>
+#include "Renderer_ConstantBuffers.h"
+#include "../Core/EngineDefs.h"
+//====================================
+
+namespace Spartan
+{
+    class Context;
+    class Profiler;
+    class Threading;
+
+    // A light as seen by the cluster builder, kept free of any component so the builder can run headless
+    struct ClusterLight
+    {
+        ClusterLight() = default;
+        ClusterLight(const Math::Vector3& position, const float range) { this->position = position; this->range = range; }
+
+        Math::Vector3 position  = Math::Vector3::Zero;
+        float range             = 0.0f;
+    };
+
+    // Bins lights into a view space froxel grid (exponential depth slices) so that
+    // the light pass only has to evaluate the lights which overlap a pixel's cluster.
+    class SPARTAN_CLASS LightClusters
+    {
+    public:
+        LightClusters(Context* context = nullptr);
+        ~LightClusters() = default;
+
+        // Multi-threaded builder, used every frame
+        bool Build(const Math::Matrix& view, const Math::Matrix& projection, float near_plane, float far_plane, const std::vector<ClusterLight>& lights);
+
+        // Single-threaded brute force builder (every light against every froxel, bounds taken from the inverse projection), used as a reference
+        bool BuildReference(const Math::Matrix& view, const Math::Matrix& projection, float near_plane, float far_plane, const std::vector<ClusterLight>& lights);
+
+        // Bins random lights with Build() and BuildReference(), every cluster has to end up with the same lights
+        static bool Benchmark(Context* context, uint32_t light_count, uint32_t iterations = 100);
+
+        // Copies the grid into the GPU layout
+        void Fill(BufferLightClusters* buffer) const;
+
+        // Properties
+        const auto& GetOffsetCounts()   const { return m_offset_count; }
+        const auto& GetLightIndices()   const { return m_light_indices; }
+        uint32_t GetLightIndexCount()   const { return static_cast<uint32_t>(m_light_indices.size()); }
+        float GetSliceScale()           const { return m_slice_scale; }
+        float GetSliceBias()            const { return m_slice_bias; }
+        bool IsOverflowing()            const { return m_overflow; }
+        bool operator==(const LightClusters& rhs) const { return m_offset_count == rhs.m_offset_count && m_light_indices == rhs.m_light_indices; }
+
+    private:
+        bool Prepare(const Math::Matrix& view, const Math::Matrix& projection, float near_plane, float far_plane, const std::vector<ClusterLight>& lights);
+        void BuildSlices(uint32_t slice_start, uint32_t slice_end);
+        void Compact();
+        void ComputeClusterBounds(const Math::Matrix& projection, float near_plane, float far_plane);
+        uint32_t GetSlice(float depth_view) const;
+
+        // Per cluster view space bounds (only re-computed when the projection changes)
+        std::vector<Math::Vector3> m_cluster_min;
+        std::vector<Math::Vector3> m_cluster_max;
+        float m_projection_x    = 0.0f;
+        float m_projection_y    = 0.0f;
+        float m_near_plane      = 0.0f;
+        float m_far_plane       = 0.0f;
+        float m_slice_scale     = 0.0f;
+        float m_slice_bias      = 0.0f;
+
+        // View space lights
+        std::vector<Math::Vector4> m_lights_view;       // xyz: position, w: range
+        std::vector<uint32_t> m_lights_slice_range;     // first slice in the low 16 bits, last slice in the high 16 bits
+        std::vector<uint32_t> m_lights_tile_rect;       // first x, last x, first y, last y tile, a byte each
+
+        // Per slice intermediate results, so that slices can be built in parallel
+        std::vector<std::vector<uint8_t>> m_slice_indices;
+        std::vector<std::vector<uint16_t>> m_slice_counts;
+
+        // Output
+        std::vector<uint32_t> m_offset_count;
+        std::vector<uint8_t> m_light_indices;
+        bool m_overflow = false;
+
+        // Dependencies
+        Context* m_context      = nullptr;
+        Profiler* m_profiler    = nullptr;
+        Threading* m_threading  = nullptr;
+    };
+}
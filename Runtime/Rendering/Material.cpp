@@ -27,7 +27,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IO/XmlDocument.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
+#include "../RHI/RHI_BindlessTable.h"
+#include "../RHI/RHI_Device.h"
 #include "../World/World.h"
+#include "../World/Entity.h"
+#include "../World/Components/Renderable.h"
 //====================================
 
 //= NAMESPACES ===============
@@ -57,6 +61,15 @@ namespace Spartan
         ShaderGBuffer::GenerateVariation(context, m_flags);
 	}
 
+	Material::~Material()
+	{
+		// Release the bindless slot, it's re-used once the frames which could be reading it complete
+		if (RHI_BindlessTable* bindless_table = m_rhi_device ? m_rhi_device->GetBindlessTable() : nullptr)
+		{
+			bindless_table->RemoveMaterial(GetId());
+		}
+	}
+
 	bool Material::LoadFromFile(const string& file_path)
 	{
 		auto xml = make_unique<XmlDocument>();
@@ -160,6 +173,8 @@ namespace Spartan
             m_flags &= ~type;
 		}
 
+        m_revision++;
+
         // Ensure an a suitable shader exists
         ShaderGBuffer::GenerateVariation(m_context, m_flags);
 	}
@@ -188,6 +203,16 @@ namespace Spartan
 		return false;
 	}
 
+    bool Material::IsAlphaTested() const
+    {
+        // The G-buffer pass discards pixels through the mask map, or through the albedo map's alpha
+        if (HasTexture(Material_Mask))
+            return true;
+
+        const auto it = m_textures.find(Material_Color);
+        return HasTexture(Material_Color) && it != m_textures.end() && it->second && it->second->GetTransparency();
+    }
+
     string Material::GetTexturePathByType(const Material_Property type)
 	{
 		if (!HasTexture(type))
@@ -218,13 +243,21 @@ namespace Spartan
 
     void Material::SetColorAlbedo(const Math::Vector4& color)
     {
-        // If an object switches from opaque to transparent or vice versa, make the world update so that the renderer
-        // goes through the entities and makes the ones that use this material, render in the correct mode.
+        // If an object switches from opaque to transparent or vice versa, mark the entities which use this material
+        // as modified, so that the renderer moves them to the correct render mode without a full world resolve.
         if ((m_color_albedo.w != 1.0f && color.w == 1.0f) || (m_color_albedo.w == 1.0f && color.w != 1.0f))
         {
-            m_context->GetSubsystem<World>()->MakeDirty();
+            for (const auto& entity : m_context->GetSubsystem<World>()->EntityGetAll())
+            {
+                Renderable* renderable = entity->GetRenderable();
+                if (renderable && renderable->GetMaterial() == this)
+                {
+                    FIRE_EVENT_DATA(Event_World_Resolve_Pending, entity.get());
+                }
+            }
         }
 
         m_color_albedo = color;
+        m_revision++;
     }
 }
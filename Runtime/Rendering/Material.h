@@ -57,7 +57,7 @@ namespace Spartan
 	{
 	public:
 		Material(Context* context);
-        ~Material() = default;
+        ~Material();
 
 		//= IResource ===========================================
 		bool LoadFromFile(const std::string& file_path) override;
@@ -74,6 +74,7 @@ namespace Spartan
 		std::vector<std::string> GetTexturePaths();
 		RHI_Texture* GetTexture_Ptr(const Material_Property type) { return HasTexture(type) ? m_textures[type].get() : nullptr; }
         std::shared_ptr<RHI_Texture>& GetTexture_PtrShared(const Material_Property type);
+        bool IsAlphaTested() const;
 		//=======================================================================================================================
         
         //= PROPERTIES =====================================================================================
@@ -81,18 +82,19 @@ namespace Spartan
         void SetColorAlbedo(const Math::Vector4& color);
 
         const Math::Vector2& GetTiling()                                    const { return m_uv_tiling; }
-        void SetTiling(const Math::Vector2& tiling)                         { m_uv_tiling = tiling; }
+        void SetTiling(const Math::Vector2& tiling)                         { m_uv_tiling = tiling; m_revision++; }
 
         const Math::Vector2& GetOffset()                                    const { return m_uv_offset; }
-        void SetOffset(const Math::Vector2& offset)                         { m_uv_offset = offset; }
+        void SetOffset(const Math::Vector2& offset)                         { m_uv_offset = offset; m_revision++; }
 
         auto IsEditable()                                                   const { return m_is_editable; }
         void SetIsEditable(const bool is_editable)                          { m_is_editable = is_editable; }
 
         auto& GetProperty(const Material_Property type)                     { return m_properties[type]; }
-        void SetProperty(const Material_Property type, const float value)   { m_properties[type] = value; }
+        void SetProperty(const Material_Property type, const float value)   { m_properties[type] = value; m_revision++; }
 
         uint16_t GetFlags()                                                 const { return m_flags; }
+        uint32_t GetRevision()                                              const { return m_revision; } // increments every time a texture or property is set
         //==================================================================================================
 
 	private:
@@ -101,6 +103,7 @@ namespace Spartan
 		Math::Vector2 m_uv_offset		= Math::Vector2(0.0f, 0.0f);
 		bool m_is_editable				= true;
         uint16_t m_flags                = 0;
+        uint32_t m_revision             = 0;
 		std::unordered_map<Material_Property, std::shared_ptr<RHI_Texture>> m_textures;
 		std::unordered_map<Material_Property, float> m_properties;
 		std::shared_ptr<RHI_Device> m_rhi_device;
@@ -24,10 +24,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <vector>
 #include "../RHI/RHI_Definition.h"
+#include "../RHI/RHI_Vertex.h"
 //================================
 
 namespace Spartan
 {
+	// A level of detail, a range of the model's indices which draws the same vertices with fewer triangles
+	struct Geometry_Lod
+	{
+		uint32_t index_offset	= 0;
+		uint32_t index_count	= 0;
+		float error				= 0.0f; // relative to the size of the geometry
+	};
+
 	class Mesh
 	{
 	public:
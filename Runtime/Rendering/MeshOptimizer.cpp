@@ -0,0 +1,901 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <random>
+#include <array>
+#include <map>
+#include <set>
+#include <cstring>
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Math/Vector3.h"
+#include "../RHI/RHI_Vertex.h"
+//============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::mesh_optimizer
+{
+    static const uint32_t invalid = 0xFFFFFFFF;
+
+    // A FIFO cache, a vertex is in it if fewer than cache_size vertices entered it since it did, returns 1 on a miss
+    inline uint32_t cache_update(const uint32_t vertex, uint32_t* timestamps, uint32_t& timestamp, const uint32_t cache_size)
+    {
+        if (timestamp - timestamps[vertex] <= cache_size)
+            return 0;
+
+        timestamps[vertex] = timestamp++;
+        return 1;
+    }
+
+    inline uint32_t cache_update(const uint32_t* triangle, uint32_t* timestamps, uint32_t& timestamp, const uint32_t cache_size)
+    {
+        return cache_update(triangle[0], timestamps, timestamp, cache_size) + cache_update(triangle[1], timestamps, timestamp, cache_size) + cache_update(triangle[2], timestamps, timestamp, cache_size);
+    }
+
+    // FNV-1a
+    inline uint64_t hash(const RHI_Vertex_PosTexNorTan& vertex)
+    {
+        const uint8_t* bytes    = reinterpret_cast<const uint8_t*>(&vertex);
+        uint64_t hash           = 14695981039346656037ULL;
+        for (size_t i = 0; i < sizeof(RHI_Vertex_PosTexNorTan); i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    inline Vector3 position(const RHI_Vertex_PosTexNorTan& vertex)  { return Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]); }
+    inline Vector3 normal(const RHI_Vertex_PosTexNorTan& vertex)    { return Vector3(vertex.nor[0], vertex.nor[1], vertex.nor[2]); }
+
+    // The sum of the squared distances to a set of planes, weighted, in double precision since the terms cancel out
+    struct Quadric
+    {
+        Quadric() = default;
+        Quadric(const Vector3& normal, const Vector3& point, const double weight)
+        {
+            const double a = normal.x, b = normal.y, c = normal.z;
+            const double d = -static_cast<double>(Vector3::Dot(normal, point));
+
+            a2 = a * a * weight; ab = a * b * weight; ac = a * c * weight; ad = a * d * weight;
+            b2 = b * b * weight; bc = b * c * weight; bd = b * d * weight;
+            c2 = c * c * weight; cd = c * d * weight;
+            d2 = d * d * weight;
+            this->weight = weight;
+        }
+
+        void operator+=(const Quadric& other)
+        {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+        }
+
+        // The weighted average of the squared distances
+        double Error(const Vector3& point) const
+        {
+            const double x = point.x, y = point.y, z = point.z;
+            const double error =
+                a2 * x * x + b2 * y * y + c2 * z * z +
+                2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+                2.0 * (ad * x + bd * y + cd * z) +
+                d2;
+
+            return weight > 0.0 ? max(error, 0.0) / weight : 0.0;
+        }
+
+        double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+        double weight = 0.0;
+    };
+
+    // Borders are kept in place by planes which are perpendicular to them, weighted more than the surface
+    static const double border_weight = 10.0;
+    // A collapse is rejected if it turns a triangle by more than this (the cosine of the angle)
+    static const float flip_threshold = 0.25f;
+}
+
+namespace Spartan
+{
+    void MeshOptimizer::MergeVertices(uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count)
+    {
+        // Open addressing, at most half full
+        uint32_t table_size = 1;
+        while (table_size < vertex_count * 2)
+        {
+            table_size <<= 1;
+        }
+        vector<uint32_t> table(table_size, mesh_optimizer::invalid);
+        vector<uint32_t> remap(vertex_count);
+
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            uint32_t slot = static_cast<uint32_t>(mesh_optimizer::hash(vertices[vertex])) & (table_size - 1);
+            while (true)
+            {
+                const uint32_t existing = table[slot];
+                if (existing == mesh_optimizer::invalid)
+                {
+                    table[slot]     = vertex;
+                    remap[vertex]   = vertex;
+                    break;
+                }
+
+                if (memcmp(&vertices[existing], &vertices[vertex], sizeof(RHI_Vertex_PosTexNorTan)) == 0)
+                {
+                    remap[vertex] = existing;
+                    break;
+                }
+
+                slot = (slot + 1) & (table_size - 1);
+            }
+        }
+
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            indices[i] = remap[indices[i]];
+        }
+    }
+
+    void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count)
+    {
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        // The triangles of every vertex, and how many of them are yet to be emitted
+        vector<uint32_t> live(vertex_count, 0);
+        for (uint32_t i = 0; i < triangle_count * 3; i++)
+        {
+            live[indices[i]]++;
+        }
+
+        vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            offsets[vertex + 1] = offsets[vertex] + live[vertex];
+        }
+
+        vector<uint32_t> adjacency(triangle_count * 3);
+        {
+            vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+            for (uint32_t i = 0; i < triangle_count * 3; i++)
+            {
+                adjacency[cursors[indices[i]]++] = i / 3;
+            }
+        }
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t timestamp = cache_size + 1;
+        vector<uint8_t> emitted(triangle_count, 0);
+        vector<uint32_t> dead_end;
+        dead_end.reserve(triangle_count * 3);
+        vector<uint32_t> result(triangle_count * 3);
+        uint32_t result_count = 0;
+        uint32_t cursor = 0; // for when there is nothing left around, the next vertex in input order which still has triangles
+
+        uint32_t fanning = indices[0];
+        while (fanning != mesh_optimizer::invalid)
+        {
+            // Emit every remaining triangle around the fanning vertex, their vertices become candidates for the next one
+            const size_t candidates_begin = dead_end.size();
+            for (uint32_t i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+            {
+                const uint32_t triangle = adjacency[i];
+                if (emitted[triangle])
+                    continue;
+
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex       = indices[triangle * 3 + corner];
+                    result[result_count++]      = vertex;
+                    dead_end.emplace_back(vertex);
+                    live[vertex]--;
+                    mesh_optimizer::cache_update(vertex, timestamps.data(), timestamp, cache_size);
+                }
+                emitted[triangle] = 1;
+            }
+
+            // The candidate which entered the cache first, among those that will still be in it after emitting their own fan
+            uint32_t best           = mesh_optimizer::invalid;
+            int64_t best_priority   = -1;
+            for (size_t i = candidates_begin; i < dead_end.size(); i++)
+            {
+                const uint32_t vertex = dead_end[i];
+                if (live[vertex] == 0)
+                    continue;
+
+                int64_t priority = 0;
+                if (timestamp - timestamps[vertex] + 2 * live[vertex] <= cache_size)
+                {
+                    priority = timestamp - timestamps[vertex];
+                }
+
+                if (priority > best_priority)
+                {
+                    best            = vertex;
+                    best_priority   = priority;
+                }
+            }
+
+            // A dead end, try the most recently used vertices and then those which come next in input order
+            while (best == mesh_optimizer::invalid && !dead_end.empty())
+            {
+                const uint32_t vertex = dead_end.back();
+                dead_end.pop_back();
+                best = live[vertex] != 0 ? vertex : best;
+            }
+
+            while (best == mesh_optimizer::invalid && cursor < vertex_count)
+            {
+                best = live[cursor] != 0 ? cursor : best;
+                cursor++;
+            }
+
+            fanning = best;
+        }
+
+        copy(result.begin(), result.end(), indices);
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, const float threshold /*= 1.05f*/)
+    {
+        const uint32_t triangle_count = index_count / 3;
+        if (triangle_count == 0)
+            return;
+
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t timestamp = cache_size + 1;
+
+        // Hard boundaries, where all three vertices of a triangle miss the cache, which is where the cache optimization started over
+        vector<uint32_t> boundaries_hard;
+        for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+        {
+            if (mesh_optimizer::cache_update(&indices[triangle * 3], timestamps.data(), timestamp, cache_size) == 3 || triangle == 0)
+            {
+                boundaries_hard.emplace_back(triangle);
+            }
+        }
+        boundaries_hard.emplace_back(triangle_count);
+
+        // Soft boundaries, a cluster ends as soon as its ACMR is within the threshold of the ACMR of the hard cluster it's part of
+        vector<uint32_t> clusters;
+        for (size_t i = 0; i + 1 < boundaries_hard.size(); i++)
+        {
+            const uint32_t start    = boundaries_hard[i];
+            const uint32_t end      = boundaries_hard[i + 1];
+
+            timestamp += cache_size + 1;
+            uint32_t misses = 0;
+            for (uint32_t triangle = start; triangle < end; triangle++)
+            {
+                misses += mesh_optimizer::cache_update(&indices[triangle * 3], timestamps.data(), timestamp, cache_size);
+            }
+            const float acmr_threshold = threshold * static_cast<float>(misses) / static_cast<float>(end - start);
+
+            timestamp += cache_size + 1;
+            uint32_t cluster_start  = start;
+            uint32_t cluster_misses = 0;
+            for (uint32_t triangle = start; triangle < end; triangle++)
+            {
+                cluster_misses += mesh_optimizer::cache_update(&indices[triangle * 3], timestamps.data(), timestamp, cache_size);
+                if (triangle + 1 < end && static_cast<float>(cluster_misses) / static_cast<float>(triangle - cluster_start + 1) <= acmr_threshold)
+                {
+                    clusters.emplace_back(cluster_start);
+                    cluster_start   = triangle + 1;
+                    cluster_misses  = 0;
+                    timestamp       += cache_size + 1;
+                }
+            }
+            clusters.emplace_back(cluster_start);
+        }
+        clusters.emplace_back(triangle_count);
+
+        // The area weighted centroid of the mesh
+        Vector3 centroid_mesh   = Vector3::Zero;
+        float area_mesh         = 0.0f;
+        vector<Vector3> centroids(clusters.size() - 1, Vector3::Zero);
+        vector<Vector3> normals(clusters.size() - 1, Vector3::Zero);
+        for (size_t cluster = 0; cluster + 1 < clusters.size(); cluster++)
+        {
+            float area_cluster = 0.0f;
+            for (uint32_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++)
+            {
+                const RHI_Vertex_PosTexNorTan& a    = vertices[indices[triangle * 3 + 0]];
+                const RHI_Vertex_PosTexNorTan& b    = vertices[indices[triangle * 3 + 1]];
+                const RHI_Vertex_PosTexNorTan& c    = vertices[indices[triangle * 3 + 2]];
+                const Vector3 p0                    = mesh_optimizer::position(a);
+                const Vector3 p1                    = mesh_optimizer::position(b);
+                const Vector3 p2                    = mesh_optimizer::position(c);
+                const float area                    = Vector3::Cross(p1 - p0, p2 - p0).Length() * 0.5f;
+
+                centroids[cluster]  += (p0 + p1 + p2) * (area / 3.0f);
+                area_cluster        += area;
+
+                // The vertex normals, rather than the winding, tell which way a triangle faces
+                normals[cluster] += (mesh_optimizer::normal(a) + mesh_optimizer::normal(b) + mesh_optimizer::normal(c)) * area;
+            }
+
+            centroid_mesh   += centroids[cluster];
+            area_mesh       += area_cluster;
+            centroids[cluster] = area_cluster > 0.0f ? centroids[cluster] / area_cluster : centroids[cluster];
+        }
+        centroid_mesh = area_mesh > 0.0f ? centroid_mesh / area_mesh : centroid_mesh;
+
+        // Clusters which are further out in the direction they face come first
+        vector<float> keys(clusters.size() - 1);
+        vector<uint32_t> order(clusters.size() - 1);
+        for (uint32_t cluster = 0; cluster < static_cast<uint32_t>(order.size()); cluster++)
+        {
+            const float length  = normals[cluster].Length();
+            keys[cluster]       = length > 0.0f ? Vector3::Dot(centroids[cluster] - centroid_mesh, normals[cluster] / length) : 0.0f;
+            order[cluster]      = cluster;
+        }
+        stable_sort(order.begin(), order.end(), [&keys](const uint32_t a, const uint32_t b) { return keys[a] > keys[b]; });
+
+        vector<uint32_t> result;
+        result.reserve(triangle_count * 3);
+        for (const uint32_t cluster : order)
+        {
+            result.insert(result.end(), indices + clusters[cluster] * 3, indices + clusters[cluster + 1] * 3);
+        }
+        copy(result.begin(), result.end(), indices);
+    }
+
+    uint32_t MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, const uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count)
+    {
+        vector<uint32_t> remap(vertex_count, mesh_optimizer::invalid);
+        uint32_t vertex_count_new = 0;
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            uint32_t& vertex = remap[indices[i]];
+            if (vertex == mesh_optimizer::invalid)
+            {
+                vertex = vertex_count_new++;
+            }
+            indices[i] = vertex;
+        }
+
+        const vector<RHI_Vertex_PosTexNorTan> vertices_old(vertices, vertices + vertex_count);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            if (remap[vertex] != mesh_optimizer::invalid)
+            {
+                vertices[remap[vertex]] = vertices_old[vertex];
+            }
+        }
+
+        return vertex_count_new;
+    }
+
+    uint32_t MeshOptimizer::Optimize(uint32_t* indices, const uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count)
+    {
+        MergeVertices(indices, index_count, vertices, vertex_count);
+        OptimizeVertexCache(indices, index_count, vertex_count);
+        OptimizeOverdraw(indices, index_count, vertices, vertex_count);
+        return OptimizeVertexFetch(indices, index_count, vertices, vertex_count);
+    }
+
+    uint32_t MeshOptimizer::Simplify(uint32_t* destination, const uint32_t* indices, const uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, const uint32_t target_index_count, float* error /*= nullptr*/)
+    {
+        // Vertices with the same position but different attributes (wedges) collapse together, a position is identified by its first wedge
+        vector<uint32_t> positions(vertex_count);
+        {
+            uint32_t table_size = 1;
+            while (table_size < vertex_count * 2)
+            {
+                table_size <<= 1;
+            }
+            vector<uint32_t> table(table_size, mesh_optimizer::invalid);
+
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                uint32_t hash = 2166136261u;
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(vertices[vertex].pos);
+                for (size_t i = 0; i < sizeof(vertices[vertex].pos); i++)
+                {
+                    hash = (hash ^ bytes[i]) * 16777619u;
+                }
+
+                uint32_t slot = hash & (table_size - 1);
+                while (table[slot] != mesh_optimizer::invalid && memcmp(vertices[table[slot]].pos, vertices[vertex].pos, sizeof(vertices[vertex].pos)) != 0)
+                {
+                    slot = (slot + 1) & (table_size - 1);
+                }
+
+                table[slot]         = table[slot] == mesh_optimizer::invalid ? vertex : table[slot];
+                positions[vertex]   = table[slot];
+            }
+        }
+        const auto position = [&vertices](const uint32_t vertex) { return mesh_optimizer::position(vertices[vertex]); };
+
+        // Triangles which are degenerate (in position) can't be seen, so they go first
+        vector<uint32_t> result;
+        result.reserve(index_count);
+        for (uint32_t i = 0; i + 2 < index_count; i += 3)
+        {
+            const uint32_t a = positions[indices[i]], b = positions[indices[i + 1]], c = positions[indices[i + 2]];
+            if (a != b && b != c && c != a)
+            {
+                result.insert(result.end(), { indices[i], indices[i + 1], indices[i + 2] });
+            }
+        }
+
+        // Errors are relative to the size of the mesh
+        Vector3 position_min = Vector3::Infinity;
+        Vector3 position_max = Vector3::InfinityNeg;
+        for (const uint32_t index : result)
+        {
+            const Vector3 point = position(index);
+            position_min        = Vector3(min(position_min.x, point.x), min(position_min.y, point.y), min(position_min.z, point.z));
+            position_max        = Vector3(max(position_max.x, point.x), max(position_max.y, point.y), max(position_max.z, point.z));
+        }
+        const float scale = result.empty() ? 1.0f : max((position_max - position_min).Length() * 0.5f, numeric_limits<float>::min());
+
+        // The planes of the triangles around every position
+        vector<mesh_optimizer::Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const Vector3 p0        = position(result[i]);
+            const Vector3 normal    = Vector3::Cross(position(result[i + 1]) - p0, position(result[i + 2]) - p0);
+            const float length      = normal.Length();
+            if (length == 0.0f)
+                continue;
+
+            const mesh_optimizer::Quadric quadric(normal / length, p0, length * 0.5f);
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                quadrics[positions[result[i + corner]]] += quadric;
+            }
+        }
+
+        vector<uint32_t> offsets(vertex_count + 1);
+        vector<uint32_t> adjacency;
+        vector<uint32_t> open_count(vertex_count);
+        vector<uint8_t> open_edges;
+        vector<uint32_t> open_next(vertex_count);
+        vector<uint32_t> open_previous(vertex_count);
+        vector<uint8_t> locked(vertex_count);
+        vector<uint32_t> remap(vertex_count);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++) { remap[vertex] = vertex; }
+
+        struct Collapse
+        {
+            float cost;
+            uint32_t from;
+            uint32_t to;
+        };
+        vector<Collapse> collapses;
+        vector<pair<uint32_t, uint32_t>> wedges;
+        double error_max = 0.0;
+
+        const uint32_t target_triangle_count = target_index_count / 3;
+        for (uint32_t pass = 0; result.size() / 3 > target_triangle_count; pass++)
+        {
+            const uint32_t triangle_count = static_cast<uint32_t>(result.size() / 3);
+
+            // The triangles around every position
+            fill(offsets.begin(), offsets.end(), 0);
+            for (const uint32_t index : result)
+            {
+                offsets[positions[index] + 1]++;
+            }
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                offsets[vertex + 1] += offsets[vertex];
+            }
+            adjacency.resize(result.size());
+            {
+                vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(result.size()); i++)
+                {
+                    adjacency[cursors[positions[result[i]]]++] = i / 3;
+                }
+            }
+            const auto corner_of = [&](const uint32_t triangle, const uint32_t position_index)
+            {
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    if (positions[result[triangle * 3 + corner]] == position_index)
+                        return corner;
+                }
+                return mesh_optimizer::invalid;
+            };
+
+            // Open edges, which no triangle has the other way around
+            fill(open_count.begin(), open_count.end(), 0);
+            open_edges.assign(result.size(), 0);
+            for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+            {
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t a = positions[result[triangle * 3 + corner]];
+                    const uint32_t b = positions[result[triangle * 3 + (corner + 1) % 3]];
+
+                    bool twin = false;
+                    for (uint32_t i = offsets[b]; i < offsets[b + 1] && !twin; i++)
+                    {
+                        const uint32_t other = adjacency[i];
+                        twin = positions[result[other * 3 + (corner_of(other, b) + 1) % 3]] == a;
+                    }
+                    if (twin)
+                        continue;
+
+                    open_edges[triangle * 3 + corner] = 1;
+                    open_count[a]++;
+                    open_count[b]++;
+                    open_next[a]        = b;
+                    open_previous[b]    = a;
+
+                    // The borders are those of the original, collapses along them keep them where they are
+                    if (pass == 0)
+                    {
+                        const Vector3 p0        = position(result[triangle * 3 + corner]);
+                        const Vector3 p1        = position(result[triangle * 3 + (corner + 1) % 3]);
+                        const Vector3 p2        = position(result[triangle * 3 + (corner + 2) % 3]);
+                        const Vector3 edge      = p1 - p0;
+                        const Vector3 normal    = Vector3::Cross(edge, Vector3::Cross(edge, p2 - p0));
+                        const float length      = normal.Length();
+                        if (length > 0.0f)
+                        {
+                            const mesh_optimizer::Quadric quadric(normal / length, p0, edge.LengthSquared() * mesh_optimizer::border_weight);
+                            quadrics[a] += quadric;
+                            quadrics[b] += quadric;
+                        }
+                    }
+                }
+            }
+
+            // Every edge once (the triangle on the other side has it the other way around), in the cheaper of the directions it can collapse in,
+            // positions on a border only move along it and other non-manifold ones don't move at all
+            collapses.clear();
+            for (uint32_t i = 0; i < static_cast<uint32_t>(result.size()); i++)
+            {
+                const uint32_t a = positions[result[i]];
+                const uint32_t b = positions[result[i - i % 3 + (i % 3 + 1) % 3]];
+                if (a > b && !open_edges[i])
+                    continue;
+
+                Collapse collapse = { numeric_limits<float>::max(), mesh_optimizer::invalid, mesh_optimizer::invalid };
+                for (const auto& [from, to] : { make_pair(a, b), make_pair(b, a) })
+                {
+                    const bool interior = open_count[from] == 0;
+                    const bool border   = open_count[from] == 2 && (open_next[from] == to || open_previous[from] == to);
+                    const float cost    = interior || border ? static_cast<float>(quadrics[from].Error(position(to))) : numeric_limits<float>::max();
+                    collapse            = cost < collapse.cost ? Collapse{ cost, from, to } : collapse;
+                }
+
+                if (collapse.from != mesh_optimizer::invalid)
+                {
+                    collapses.emplace_back(collapse);
+                }
+            }
+            sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            // Collapse the cheapest edges, each one removes about two triangles, and the triangles around them don't change again during this pass
+            const uint32_t collapse_goal = (triangle_count - target_triangle_count) / 2 + 1;
+            uint32_t collapse_count = 0;
+            fill(locked.begin(), locked.end(), 0);
+            for (const Collapse& collapse : collapses)
+            {
+                if (collapse_count >= collapse_goal)
+                    break;
+
+                if (locked[collapse.from] || locked[collapse.to])
+                    continue;
+
+                // Every wedge has to go to the wedge it shares an edge with, which is what keeps the seams in place
+                wedges.clear();
+                bool valid = true;
+                for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1] && valid; i++)
+                {
+                    const uint32_t triangle     = adjacency[i];
+                    const uint32_t corner_to    = corner_of(triangle, collapse.to);
+                    if (corner_to == mesh_optimizer::invalid)
+                        continue;
+
+                    const uint32_t wedge_from   = result[triangle * 3 + corner_of(triangle, collapse.from)];
+                    const uint32_t wedge_to     = result[triangle * 3 + corner_to];
+                    const auto it               = find_if(wedges.begin(), wedges.end(), [wedge_from](const auto& wedge) { return wedge.first == wedge_from; });
+                    valid                       = it == wedges.end() || it->second == wedge_to;
+                    if (it == wedges.end())
+                    {
+                        wedges.emplace_back(wedge_from, wedge_to);
+                    }
+                }
+
+                // The triangles which remain can't turn around
+                for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1] && valid; i++)
+                {
+                    const uint32_t triangle = adjacency[i];
+                    if (corner_of(triangle, collapse.to) != mesh_optimizer::invalid)
+                        continue;
+
+                    const uint32_t corner       = corner_of(triangle, collapse.from);
+                    const uint32_t wedge_from   = result[triangle * 3 + corner];
+                    valid                       = find_if(wedges.begin(), wedges.end(), [wedge_from](const auto& wedge) { return wedge.first == wedge_from; }) != wedges.end();
+
+                    const Vector3 p1                = position(result[triangle * 3 + (corner + 1) % 3]);
+                    const Vector3 p2                = position(result[triangle * 3 + (corner + 2) % 3]);
+                    const Vector3 normal_before     = Vector3::Cross(p1 - position(wedge_from), p2 - position(wedge_from));
+                    const Vector3 normal_after      = Vector3::Cross(p1 - position(collapse.to), p2 - position(collapse.to));
+                    valid = valid && Vector3::Dot(normal_before, normal_after) >= mesh_optimizer::flip_threshold * normal_before.Length() * normal_after.Length();
+                }
+
+                if (!valid)
+                    continue;
+
+                for (const auto& [wedge_from, wedge_to] : wedges)
+                {
+                    remap[wedge_from] = wedge_to;
+                }
+
+                for (uint32_t i = offsets[collapse.from]; i < offsets[collapse.from + 1]; i++)
+                {
+                    const uint32_t triangle = adjacency[i];
+                    locked[positions[result[triangle * 3 + 0]]] = 1;
+                    locked[positions[result[triangle * 3 + 1]]] = 1;
+                    locked[positions[result[triangle * 3 + 2]]] = 1;
+                }
+
+                quadrics[collapse.to] += quadrics[collapse.from];
+                error_max = max(error_max, static_cast<double>(collapse.cost));
+                collapse_count++;
+            }
+
+            if (collapse_count == 0)
+                break;
+
+            // Move the corners and drop the triangles which collapsed
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+                if (positions[a] != positions[b] && positions[b] != positions[c] && positions[c] != positions[a])
+                {
+                    result[write++] = a;
+                    result[write++] = b;
+                    result[write++] = c;
+                }
+            }
+            result.resize(write);
+        }
+
+        copy(result.begin(), result.end(), destination);
+
+        if (error)
+        {
+            *error = static_cast<float>(sqrt(error_max)) / scale;
+        }
+
+        return static_cast<uint32_t>(result.size());
+    }
+
+    MeshOptimizer::Statistics MeshOptimizer::ComputeStatistics(const uint32_t* indices, const uint32_t index_count, const uint32_t vertex_count, const uint32_t cache_size /*= MeshOptimizer::cache_size*/)
+    {
+        vector<uint32_t> timestamps(vertex_count, 0);
+        vector<uint8_t> used(vertex_count, 0);
+        uint32_t timestamp      = cache_size + 1;
+        uint32_t misses         = 0;
+        uint32_t used_count     = 0;
+        for (uint32_t i = 0; i < index_count; i++)
+        {
+            misses      += mesh_optimizer::cache_update(indices[i], timestamps.data(), timestamp, cache_size);
+            used_count  += used[indices[i]] == 0 ? 1 : 0;
+            used[indices[i]] = 1;
+        }
+
+        Statistics statistics;
+        statistics.acmr = index_count != 0 ? static_cast<float>(misses) / static_cast<float>(index_count / 3) : 0.0f;
+        statistics.atvr = used_count != 0 ? static_cast<float>(misses) / static_cast<float>(used_count) : 0.0f;
+        return statistics;
+    }
+
+    bool MeshOptimizer::Benchmark(const uint32_t grid_size /*= 512*/)
+    {
+        bool valid = true;
+        const auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        // A sphere, grid_size segments around and grid_size rings, closed (in position) at the seam and the poles
+        const float pi = 3.14159265f;
+        vector<RHI_Vertex_PosTexNorTan> vertices;
+        vector<uint32_t> indices;
+        for (uint32_t ring = 0; ring <= grid_size; ring++)
+        {
+            for (uint32_t segment = 0; segment <= grid_size; segment++)
+            {
+                const float u           = static_cast<float>(segment) / grid_size;
+                const float v           = static_cast<float>(ring) / grid_size;
+                const float longitude   = static_cast<float>(segment % grid_size) / grid_size * 2.0f * pi;
+                const float latitude    = v * pi;
+                Vector3 point           = Vector3(sin(latitude) * cos(longitude), cos(latitude), sin(latitude) * sin(longitude));
+                point                   = ring == 0 ? Vector3::Up : ring == grid_size ? Vector3::Down : point;
+                vertices.emplace_back(point, Vector2(u, v), point, Vector3(-sin(longitude), 0.0f, cos(longitude)));
+            }
+        }
+        for (uint32_t ring = 0; ring < grid_size; ring++)
+        {
+            for (uint32_t segment = 0; segment < grid_size; segment++)
+            {
+                const uint32_t a = ring * (grid_size + 1) + segment;
+                const uint32_t b = a + grid_size + 1;
+                indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+        const uint32_t vertex_count_unique = static_cast<uint32_t>(vertices.size());
+
+        // Every vertex twice, the triangles in random order and the vertices too, the way an unoptimized import might look
+        mt19937 generator(1337);
+        vertices.insert(vertices.end(), vertices.begin(), vertices.end());
+        for (uint32_t& index : indices)
+        {
+            index += (generator() & 1) * vertex_count_unique;
+        }
+        {
+            vector<uint32_t> triangles(indices.size() / 3);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(triangles.size()); i++) { triangles[i] = i; }
+            shuffle(triangles.begin(), triangles.end(), generator);
+            vector<uint32_t> shuffled;
+            shuffled.reserve(indices.size());
+            for (const uint32_t triangle : triangles) { shuffled.insert(shuffled.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3); }
+            indices = move(shuffled);
+
+            vector<uint32_t> permutation(vertices.size());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(permutation.size()); i++) { permutation[i] = i; }
+            shuffle(permutation.begin(), permutation.end(), generator);
+            vector<RHI_Vertex_PosTexNorTan> permuted(vertices.size());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(permutation.size()); i++) { permuted[permutation[i]] = vertices[i]; }
+            vertices = move(permuted);
+            for (uint32_t& index : indices) { index = permutation[index]; }
+        }
+        const uint32_t index_count  = static_cast<uint32_t>(indices.size());
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+        // The triangles, as positions, with the same winding, starting from the smallest vertex, in order
+        const auto get_triangles = [](const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices)
+        {
+            vector<array<float, 9>> triangles(indices.size() / 3);
+            for (size_t i = 0; i < triangles.size(); i++)
+            {
+                array<array<float, 3>, 3> corners;
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    const float* position = vertices[indices[i * 3 + corner]].pos;
+                    corners[corner] = { position[0], position[1], position[2] };
+                }
+                rotate(corners.begin(), min_element(corners.begin(), corners.end()), corners.end());
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    copy(corners[corner].begin(), corners[corner].end(), triangles[i].begin() + corner * 3);
+                }
+            }
+            sort(triangles.begin(), triangles.end());
+            return triangles;
+        };
+        const vector<array<float, 9>> triangles = get_triangles(indices, vertices);
+        const Statistics statistics_input       = ComputeStatistics(indices.data(), index_count, vertex_count);
+
+        Stopwatch timer;
+        MergeVertices(indices.data(), index_count, vertices.data(), vertex_count);
+        const float time_merge              = timer.GetElapsedTimeMs();
+        const Statistics statistics_merge   = ComputeStatistics(indices.data(), index_count, vertex_count);
+
+        timer.Start();
+        OptimizeVertexCache(indices.data(), index_count, vertex_count);
+        const float time_cache              = timer.GetElapsedTimeMs();
+        const Statistics statistics_cache   = ComputeStatistics(indices.data(), index_count, vertex_count);
+
+        timer.Start();
+        OptimizeOverdraw(indices.data(), index_count, vertices.data(), vertex_count);
+        const float time_overdraw               = timer.GetElapsedTimeMs();
+        const Statistics statistics_overdraw    = ComputeStatistics(indices.data(), index_count, vertex_count);
+
+        timer.Start();
+        const uint32_t vertex_count_new = OptimizeVertexFetch(indices.data(), index_count, vertices.data(), vertex_count);
+        const float time_fetch          = timer.GetElapsedTimeMs();
+        vertices.resize(vertex_count_new);
+
+        check(get_triangles(indices, vertices) == triangles, "the triangles are the same");
+        check(vertex_count_new == vertex_count_unique, "the duplicate vertices are merged");
+        check(statistics_cache.acmr <= statistics_merge.acmr, "the vertex cache optimization doesn't make things worse");
+        check(grid_size < 16 || statistics_cache.acmr < 0.8f, "the vertex cache is reused");
+        check(statistics_overdraw.acmr <= statistics_cache.acmr * 1.1f, "the overdraw optimization keeps most of the vertex cache reuse");
+        check(ComputeStatistics(indices.data(), index_count, vertex_count_new).acmr == statistics_overdraw.acmr, "the vertex fetch optimization doesn't affect the vertex cache");
+        uint32_t index_max  = 0;
+        bool first_use      = true;
+        for (const uint32_t index : indices)
+        {
+            first_use = first_use && index <= index_max;
+            index_max = max(index_max, index + 1);
+        }
+        check(first_use, "the vertices are in the order they are used");
+
+        // Levels of detail, which should stay closed (in position, the seams have the same positions on both sides) and close to the sphere
+        const auto is_closed = [&vertices](const vector<uint32_t>& indices)
+        {
+            map<array<float, 3>, uint32_t> positions;
+            set<pair<uint32_t, uint32_t>> edges;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                uint32_t corners[3];
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    const float* position   = vertices[indices[i + corner]].pos;
+                    corners[corner]         = positions.emplace(array<float, 3>{ position[0], position[1], position[2] }, static_cast<uint32_t>(positions.size())).first->second;
+                }
+                edges.insert({ { corners[0], corners[1] }, { corners[1], corners[2] }, { corners[2], corners[0] } });
+            }
+            return all_of(edges.begin(), edges.end(), [&edges](const auto& edge) { return edges.count({ edge.second, edge.first }) != 0; });
+        };
+
+        float error_previous = 0.0f;
+        for (const float ratio : { 0.5f, 0.25f, 0.125f })
+        {
+            const uint32_t target_index_count = static_cast<uint32_t>(index_count * ratio) / 3 * 3;
+            vector<uint32_t> lod(index_count);
+            float error = 0.0f;
+
+            timer.Start();
+            lod.resize(Simplify(lod.data(), indices.data(), index_count, vertices.data(), vertex_count_new, target_index_count, &error));
+            const float time_simplify = timer.GetElapsedTimeMs();
+
+            // How far the triangles are from the sphere, at their centers, where they are the furthest
+            float deviation = 0.0f;
+            for (size_t i = 0; i < lod.size(); i += 3)
+            {
+                const Vector3 center = (mesh_optimizer::position(vertices[lod[i]]) + mesh_optimizer::position(vertices[lod[i + 1]]) + mesh_optimizer::position(vertices[lod[i + 2]])) / 3.0f;
+                deviation = max(deviation, 1.0f - center.Length());
+            }
+
+            // Too few triangles to simplify them much
+            if (grid_size >= 8)
+            {
+                check(lod.size() <= target_index_count, "the simplification reaches its target");
+                check(is_closed(lod), "the simplification keeps the sphere closed");
+                check(error >= error_previous && deviation <= error * 3.0f + 0.0001f, "the simplification error grows with every level and is close to the actual one (which is the largest, not the average)");
+            }
+            LOG_INFO("Simplified to %d triangles (%d%%) in %.2f ms, error %.5f, deviation %.5f", static_cast<uint32_t>(lod.size() / 3), static_cast<uint32_t>(ratio * 100.0f), time_simplify, error, deviation);
+
+            error_previous = error;
+        }
+
+        LOG_INFO("%d triangles, %d vertices: ACMR %.3f (ATVR %.3f), merged %.3f (%.3f), vertex cache %.3f (%.3f), overdraw %.3f (%.3f)",
+            index_count / 3, vertex_count, statistics_input.acmr, statistics_input.atvr, statistics_merge.acmr, statistics_merge.atvr, statistics_cache.acmr, statistics_cache.atvr, statistics_overdraw.acmr, statistics_overdraw.atvr);
+        LOG_INFO("Merge %.2f ms, vertex cache %.2f ms, overdraw %.2f ms, vertex fetch %.2f ms", time_merge, time_cache, time_overdraw, time_fetch);
+        LOG_INFO("%s", valid ? "Mesh optimizer is valid" : "Mesh optimizer is invalid");
+
+        return valid;
+    }
+}
@@ -0,0 +1,71 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
+//===================================
+
+namespace Spartan
+{
+    // Reorders indexed triangle lists (in place) so that the GPU does less work drawing them:
+    // - Vertex cache: triangles are reordered with Tipsify (Sander et al. 2007), so that their vertices are reused while they
+    //   are still in the post-transform cache, which is simulated as a FIFO.
+    // - Overdraw: the cache optimized order is split into clusters, at the points where the cache starts over or where the
+    //   ACMR of a cluster is already within a threshold of the ACMR of the whole, and the clusters which face away from the
+    //   center of the mesh, and are likely to occlude the rest, are drawn first.
+    // - Vertex fetch: vertices are reordered by first use and the unused ones are dropped, so they are read front to back.
+    // It also simplifies meshes, for levels of detail, by collapsing edges in the order of their quadric error (Garland and
+    // Heckbert 1997). Only the indices are simplified, the levels reference the vertices of the original.
+    class SPARTAN_CLASS MeshOptimizer
+    {
+    public:
+        static const uint32_t cache_size = 16;
+
+        struct Statistics
+        {
+            float acmr = 0.0f; // average cache miss ratio, vertex shader invocations per triangle, 0.5 at best and 3 at worst
+            float atvr = 0.0f; // average transformed vertex ratio, vertex shader invocations per vertex, 1 at best
+        };
+
+        // Points identical vertices (byte for byte) to the first of them, the vertices themselves are left as they are
+        static void MergeVertices(uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count);
+        static void OptimizeVertexCache(uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+        // Expects triangles which are already cache optimized, a threshold of 1.05 lets the ACMR grow by up to 5%
+        static void OptimizeOverdraw(uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, float threshold = 1.05f);
+        // Returns the new vertex count
+        static uint32_t OptimizeVertexFetch(uint32_t* indices, uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count);
+        // All of the above, in order, returns the new vertex count
+        static uint32_t Optimize(uint32_t* indices, uint32_t index_count, RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count);
+
+        // Writes up to index_count indices (aiming for target_index_count) to destination and returns their count. Vertices with the same
+        // position collapse together, borders only collapse along themselves and the error (relative to the size of the mesh) is optional.
+        static uint32_t Simplify(uint32_t* destination, const uint32_t* indices, uint32_t index_count, const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, uint32_t target_index_count, float* error = nullptr);
+
+        static Statistics ComputeStatistics(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size = MeshOptimizer::cache_size);
+
+        // Runs every step on a shuffled sphere, each one has to keep the triangles intact and not undo the previous one
+        static bool Benchmark(uint32_t grid_size = 512);
+    };
+}
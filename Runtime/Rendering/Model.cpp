@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Model.h"
 #include "Mesh.h"
 #include "Renderer.h"
+#include "VertexQuantizer.h"
 #include "../IO/FileStream.h"
 #include "../Core/Stopwatch.h"
 #include "../Resource/ResourceCache.h"
@@ -41,6 +42,14 @@ using namespace std;
 using namespace Spartan::Math;
 //=============================
 
+namespace Spartan::model_file
+{
+    // Layout: magic | version | resource path | normalized scale | vertex quantization (2+) | indices | vertices | levels of detail (1+)
+    // Files which predate the header start directly with the resource path (a string, so a byte count).
+    static const uint32_t magic             = 0x4C444F4D; // "MODL"
+    static const uint32_t version_current   = 2;
+}
+
 namespace Spartan
 {
 	Model::Model(Context* context) : IResource(context, Resource_Model)
@@ -61,9 +70,13 @@ namespace Spartan
         m_vertex_buffer.reset();
         m_index_buffer.reset();
         m_mesh->Geometry_Clear();
+        m_lods.clear();
         m_aabb.Undefine();
+        m_vertex_transform = Matrix::Identity;
         m_normalized_scale = 1.0f;
         m_is_animated = false;
+        m_vertex_quantization = false;
+        m_vertex_buffer_quantized = false;
     }
 
 	bool Model::LoadFromFile(const string& file_path)
@@ -84,12 +97,56 @@ namespace Spartan
             if (!file->IsOpen())
                 return false;
 
+            uint32_t version = 0;
+            if (file->ReadAs<uint32_t>() == model_file::magic)
+            {
+                file->Read(&version);
+                if (version > model_file::version_current)
+                {
+                    LOG_ERROR("\"%s\" is version %d, this build reads up to version %d", file_path.c_str(), version, model_file::version_current);
+                    return false;
+                }
+            }
+            else
+            {
+                file->Seek(0);
+            }
+
             SetResourceFilePath(file->ReadAs<string>());
             file->Read(&m_normalized_scale);
+            if (version >= 2)
+            {
+                file->Read(&m_vertex_quantization);
+            }
             file->Read(&m_mesh->Indices_Get());
             file->Read(&m_mesh->Vertices_Get());
+            if (version >= 1)
+            {
+                const uint32_t geometry_count = file->ReadAs<uint32_t>();
+                for (uint32_t i = 0; i < geometry_count; i++)
+                {
+                    vector<Geometry_Lod>& lods = m_lods[file->ReadAs<uint32_t>()];
+                    lods.resize(file->ReadAs<uint32_t>());
+                    for (Geometry_Lod& lod : lods)
+                    {
+                        file->Read(&lod.index_offset);
+                        file->Read(&lod.index_count);
+                        file->Read(&lod.error);
+                    }
+                }
+            }
+            file->Close();
 
             UpdateGeometry();
+
+            // Older files are rewritten once, the first time they are loaded (packaged files stay as they are)
+            if (version < model_file::version_current && FileSystem::Exists(file_path))
+            {
+                if (SaveToFile(file_path))
+                {
+                    LOG_INFO("Migrated \"%s\" to version %d", file_path.c_str(), model_file::version_current);
+                }
+            }
         }
         // Load foreign format
         else
@@ -133,10 +190,25 @@ namespace Spartan
 		if (!file->IsOpen())
 			return false;
 
+		file->Write(model_file::magic);
+		file->Write(model_file::version_current);
 		file->Write(GetResourceFilePath());
 		file->Write(m_normalized_scale);
+		file->Write(m_vertex_quantization);
 		file->Write(m_mesh->Indices_Get());
 		file->Write(m_mesh->Vertices_Get());
+		file->Write(static_cast<uint32_t>(m_lods.size()));
+		for (const auto& geometry : m_lods)
+		{
+			file->Write(geometry.first);
+			file->Write(static_cast<uint32_t>(geometry.second.size()));
+			for (const Geometry_Lod& lod : geometry.second)
+			{
+				file->Write(lod.index_offset);
+				file->Write(lod.index_count);
+				file->Write(lod.error);
+			}
+		}
 
         file->Close();
 
@@ -161,6 +233,24 @@ namespace Spartan
 		m_mesh->Geometry_Get(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
 	}
 
+	void Model::SetLods(const uint32_t index_offset, const vector<Geometry_Lod>& lods)
+	{
+		if (lods.empty())
+		{
+			m_lods.erase(index_offset);
+			return;
+		}
+
+		m_lods[index_offset] = lods;
+	}
+
+	const vector<Geometry_Lod>& Model::GetLods(const uint32_t index_offset) const
+	{
+		static const vector<Geometry_Lod> empty;
+		const auto it = m_lods.find(index_offset);
+		return it != m_lods.end() ? it->second : empty;
+	}
+
 	void Model::UpdateGeometry()
 	{
 		if (m_mesh->Indices_Count() == 0 || m_mesh->Vertices_Count() == 0)
@@ -169,9 +259,10 @@ namespace Spartan
 			return;
 		}
 
+		// The bounding box comes first, quantized vertex buffers are relative to it
+		m_aabb				= BoundingBox(m_mesh->Vertices_Get().data(), static_cast<uint32_t>(m_mesh->Vertices_Get().size()));
 		GeometryCreateBuffers();
 		m_normalized_scale	= GeometryComputeNormalizedScale();
-		m_aabb				= BoundingBox(m_mesh->Vertices_Get().data(), static_cast<uint32_t>(m_mesh->Vertices_Get().size()));
 	}
 
 	void Model::AddMaterial(shared_ptr<Material>& material, const shared_ptr<Entity>& entity) const
@@ -210,6 +301,8 @@ namespace Spartan
 			// Load texture
 			auto generate_mipmaps = true;
             texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
+
+            texture->SetCompression(GetTextureCompression(texture_type));
 			texture->LoadFromFile(file_path);
 
 			// Set the texture to the provided material
@@ -217,6 +310,19 @@ namespace Spartan
 		}
 	}
 
+    RHI_Texture_Compression Model::GetTextureCompression(const Material_Property texture_type)
+    {
+        // Pick a block compression which suits how the material samples the texture
+        if (texture_type == Material_Normal)
+            return RHI_Texture_Compression_Normal;
+
+        // Height maps are often stored as rgb, but only red is sampled
+        if (texture_type == Material_Height || texture_type == Material_Roughness || texture_type == Material_Metallic || texture_type == Material_Occlusion)
+            return RHI_Texture_Compression_Grayscale;
+
+        return RHI_Texture_Compression_Color; // color, emission and mask (which is sampled as rgb)
+    }
+
 	bool Model::GeometryCreateBuffers()
 	{
 		auto success = true;
@@ -240,10 +346,34 @@ namespace Spartan
 			success = false;
 		}
 
+		m_vertex_transform			= Matrix::Identity;
+		m_vertex_buffer_quantized	= false;
 		if (!vertices.empty())
 		{
 			m_vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
-			if (!m_vertex_buffer->Create(vertices))
+
+			// Quantize, if the vertices can take it, otherwise fall back to the full vertices
+			const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+			bool created = false;
+			if (m_vertex_quantization && VertexQuantizer::IsSuitable(vertices.data(), vertex_count))
+			{
+				vector<RHI_Vertex_PosTexNorTan16> vertices_quantized(vertex_count);
+				VertexQuantizer::Quantize(vertices.data(), vertex_count, m_aabb, vertices_quantized.data());
+				created						= m_vertex_buffer->Create(vertices_quantized);
+				m_vertex_buffer_quantized	= created;
+				m_vertex_transform			= created ? VertexQuantizer::GetDequantizeTransform(m_aabb) : Matrix::Identity;
+			}
+			else
+			{
+				if (m_vertex_quantization)
+				{
+					LOG_INFO("\"%s\" has texture coordinates beyond %.0f, its vertices won't be quantized", GetResourceName().c_str(), VertexQuantizer::uv_max);
+				}
+
+				created = m_vertex_buffer->Create(vertices);
+			}
+
+			if (!created)
 			{
 				LOG_ERROR("Failed to create vertex buffer for \"%s\".", GetResourceName().c_str());
 				success = false;
@@ -22,19 +22,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =====================
+#include <map>
 #include <memory>
 #include <vector>
+#include "Mesh.h"
 #include "Material.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Matrix.h"
 //================================
 
 namespace Spartan
 {
 	class ResourceCache;
 	class Entity;
-	class Mesh;
 	namespace Math{ class BoundingBox; }
 
 	class SPARTAN_CLASS Model : public IResource, public std::enable_shared_from_this<Model>
@@ -69,10 +71,23 @@ namespace Spartan
         const auto& GetAabb() const { return m_aabb; }
         const auto& GetMesh() const { return m_mesh; }
 
+        // Levels of detail, the index ranges which follow the full detail geometry that starts at index_offset
+        void SetLods(uint32_t index_offset, const std::vector<Geometry_Lod>& lods);
+        const std::vector<Geometry_Lod>& GetLods(uint32_t index_offset) const;
+
+        // Vertex quantization, when enabled (and the vertices are suitable) the vertex buffer holds RHI_Vertex_PosTexNorTan16 instead of
+        // RHI_Vertex_PosTexNorTan, the mesh keeps the full vertices. It takes effect the next time the geometry is updated.
+        void SetVertexQuantization(const bool vertex_quantization)  { m_vertex_quantization = vertex_quantization; }
+        bool GetVertexQuantization()                          const { return m_vertex_quantization; }
+        bool IsVertexBufferQuantized()                        const { return m_vertex_buffer_quantized; }
+        const auto& GetVertexTransform()                      const { return m_vertex_transform; } // goes in front of the object's transform
+
 		// Add resources to the model
         void SetRootEntity(const std::shared_ptr<Entity>& entity) { m_root_entity = entity; }
+        std::shared_ptr<Entity> GetRootEntity() const { return m_root_entity.lock(); }
 		void AddMaterial(std::shared_ptr<Material>& material, const std::shared_ptr<Entity>& entity) const;
 		void AddTexture(std::shared_ptr<Material>& material, Material_Property texture_type, const std::string& file_path);
+        static RHI_Texture_Compression GetTextureCompression(Material_Property texture_type);
 
         // Misc
         bool IsAnimated()                           const { return m_is_animated; }
@@ -91,9 +106,13 @@ namespace Spartan
 		std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
 		std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
 		std::shared_ptr<Mesh> m_mesh;
+		std::map<uint32_t, std::vector<Geometry_Lod>> m_lods; // keyed by the index offset of the full detail geometry
 		Math::BoundingBox m_aabb;
+		Math::Matrix m_vertex_transform		= Math::Matrix::Identity;
 		float m_normalized_scale	= 1.0f;
 		bool m_is_animated			= false;
+		bool m_vertex_quantization		= false;
+		bool m_vertex_buffer_quantized	= false;
 
         // Dependencies
 		ResourceCache* m_resource_manager;
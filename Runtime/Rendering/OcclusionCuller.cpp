@@ -0,0 +1,515 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "OcclusionCuller.h"
+#include <random>
+#include <emmintrin.h>
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+#include "../RHI/RHI_Vertex.h"
+//======================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    static const uint32_t rows_per_band = 8;
+    static const uint32_t band_count    = OcclusionCuller::buffer_height / rows_per_band;
+
+    inline Vector4 lerp_clip(const Vector4& a, const Vector4& b, const float t)
+    {
+        return Vector4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
+    }
+
+    OcclusionCuller::OcclusionCuller(Context* context /*= nullptr*/)
+    {
+        // Without a context, the culler runs single-threaded and without profiling
+        m_context = context;
+        if (m_context)
+        {
+            m_profiler  = m_context->GetSubsystem<Profiler>();
+            m_threading = m_context->GetSubsystem<Threading>();
+        }
+
+        // Allocate the depth hierarchy, all the way down to 1x1
+        uint32_t width  = buffer_width;
+        uint32_t height = buffer_height;
+        while (true)
+        {
+            m_mips.emplace_back(width * height, 0.0f);
+            m_mip_sizes.push_back({ width, height });
+
+            if (width == 1 && height == 1)
+                break;
+
+            width   = Helper::Max(width / 2, 1u);
+            height  = Helper::Max(height / 2, 1u);
+        }
+    }
+
+    bool OcclusionCuller::Build(const Matrix& view, const Matrix& projection, const float near_plane, const vector<Occluder>& occluders)
+    {
+        m_valid = false;
+
+        // Depth is stored as 1/w, which requires a perspective projection
+        if (projection.m23 != 1.0f || near_plane <= 0.0f)
+            return false;
+
+        if (m_profiler)
+        {
+            TIME_BLOCK_START_NAMED(m_profiler, "OcclusionCuller::Build");
+        }
+
+        m_view_projection   = view * projection;
+        m_near_plane        = near_plane;
+
+        // Set up triangles
+        m_triangles.clear();
+        for (const Occluder& occluder : occluders)
+        {
+            if (!occluder.vertices || !occluder.indices || occluder.index_count < 3)
+                continue;
+
+            // Transform only the range of vertices which is referenced
+            uint32_t index_min = numeric_limits<uint32_t>::max();
+            uint32_t index_max = 0;
+            for (uint32_t i = 0; i < occluder.index_count; i++)
+            {
+                index_min = Helper::Min(index_min, occluder.indices[i]);
+                index_max = Helper::Max(index_max, occluder.indices[i]);
+            }
+
+            const Matrix transform = occluder.transform * m_view_projection;
+            m_clip_positions.resize(index_max - index_min + 1);
+            for (uint32_t i = index_min; i <= index_max; i++)
+            {
+                const float* position = occluder.vertices[i].pos;
+                m_clip_positions[i - index_min] = transform * Vector4(position[0], position[1], position[2], 1.0f);
+            }
+
+            for (uint32_t i = 0; i + 2 < occluder.index_count; i += 3)
+            {
+                const array<Vector4, 3> triangle =
+                {
+                    m_clip_positions[occluder.indices[i]     - index_min],
+                    m_clip_positions[occluder.indices[i + 1] - index_min],
+                    m_clip_positions[occluder.indices[i + 2] - index_min]
+                };
+
+                const uint32_t inside_count = (triangle[0].w >= near_plane ? 1 : 0) + (triangle[1].w >= near_plane ? 1 : 0) + (triangle[2].w >= near_plane ? 1 : 0);
+                if (inside_count == 0)
+                    continue;
+
+                if (inside_count == 3)
+                {
+                    SetupTriangle(triangle[0], triangle[1], triangle[2]);
+                    continue;
+                }
+
+                // Clip against the near plane, which yields at most a quad
+                array<Vector4, 4> polygon;
+                uint32_t polygon_count = 0;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    const Vector4& a    = triangle[j];
+                    const Vector4& b    = triangle[(j + 1) % 3];
+                    const float d_a     = a.w - near_plane;
+                    const float d_b     = b.w - near_plane;
+
+                    if (d_a >= 0.0f)
+                    {
+                        polygon[polygon_count++] = a;
+                    }
+
+                    if ((d_a >= 0.0f) != (d_b >= 0.0f))
+                    {
+                        polygon[polygon_count++] = lerp_clip(a, b, d_a / (d_a - d_b));
+                    }
+                }
+
+                for (uint32_t j = 1; j + 1 < polygon_count; j++)
+                {
+                    SetupTriangle(polygon[0], polygon[j], polygon[j + 1]);
+                }
+            }
+        }
+
+        // Clear to infinitely far away
+        fill(m_mips[0].begin(), m_mips[0].end(), 0.0f);
+
+        // Bands of rows are independent of each other, so they are distributed across threads
+        if (m_threading && !m_triangles.empty())
+        {
+            auto rasterize_bands = [this](uint32_t band_start, uint32_t band_end) { RasterizeRows(band_start * rows_per_band, band_end * rows_per_band); };
+            m_threading->AddTaskLoop(rasterize_bands, band_count);
+        }
+        else
+        {
+            RasterizeRows(0, buffer_height);
+        }
+
+        BuildHierarchy();
+        m_valid = true;
+
+        if (m_profiler)
+        {
+            TIME_BLOCK_END(m_profiler);
+        }
+
+        return true;
+    }
+
+    bool OcclusionCuller::IsVisible(const BoundingBox& box) const
+    {
+        if (!m_valid)
+            return true;
+
+        const Vector3& box_min = box.GetMin();
+        const Vector3& box_max = box.GetMax();
+
+        // Project the corners and find the nearest depth
+        float x_min     = numeric_limits<float>::max();
+        float y_min     = numeric_limits<float>::max();
+        float x_max     = numeric_limits<float>::lowest();
+        float y_max     = numeric_limits<float>::lowest();
+        float depth_max = 0.0f;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            const Vector4 corner = Vector4(
+                (i & 1) ? box_max.x : box_min.x,
+                (i & 2) ? box_max.y : box_min.y,
+                (i & 4) ? box_max.z : box_min.z,
+                1.0f
+            );
+            const Vector4 clip = m_view_projection * corner;
+
+            // Crossing the near plane, can't be occluded
+            if (clip.w < m_near_plane)
+                return true;
+
+            const float w_rcp   = 1.0f / clip.w;
+            const float x       = (clip.x * w_rcp * 0.5f + 0.5f) * buffer_width;
+            const float y       = (0.5f - clip.y * w_rcp * 0.5f) * buffer_height;
+            x_min               = Helper::Min(x_min, x);
+            x_max               = Helper::Max(x_max, x);
+            y_min               = Helper::Min(y_min, y);
+            y_max               = Helper::Max(y_max, y);
+            depth_max           = Helper::Max(depth_max, w_rcp);
+        }
+
+        // Off-screen, that's for frustum culling to decide
+        if (x_max < 0.0f || y_max < 0.0f || x_min >= buffer_width || y_min >= buffer_height)
+            return true;
+
+        const uint32_t x0 = static_cast<uint32_t>(Helper::Clamp(x_min, 0.0f, buffer_width - 1.0f));
+        const uint32_t x1 = static_cast<uint32_t>(Helper::Clamp(x_max, 0.0f, buffer_width - 1.0f));
+        const uint32_t y0 = static_cast<uint32_t>(Helper::Clamp(y_min, 0.0f, buffer_height - 1.0f));
+        const uint32_t y1 = static_cast<uint32_t>(Helper::Clamp(y_max, 0.0f, buffer_height - 1.0f));
+
+        // Pick the level where the box covers at most 4x4 texels
+        uint32_t level = 0;
+        while (((x1 >> level) - (x0 >> level)) > 3 || ((y1 >> level) - (y0 >> level)) > 3)
+        {
+            level++;
+        }
+
+        return IsRegionVisible(level, x0, y0, x1, y1, depth_max);
+    }
+
+    bool OcclusionCuller::IsRegionVisible(const uint32_t level, const uint32_t x0, const uint32_t y0, const uint32_t x1, const uint32_t y1, const float depth) const
+    {
+        const vector<float>& mip    = m_mips[level];
+        const uint32_t mip_width    = m_mip_sizes[level][0];
+
+        for (uint32_t y = y0 >> level; y <= (y1 >> level); y++)
+        {
+            for (uint32_t x = x0 >> level; x <= (x1 >> level); x++)
+            {
+                // Every occluder in this texel is nearer than the region
+                if (mip[y * mip_width + x] >= depth)
+                    continue;
+
+                if (level == 0)
+                    return true;
+
+                // Coarse texels can stick out of the region, so refine with the part of the region that the texel covers
+                const uint32_t texel_x0 = Helper::Max(x0, x << level);
+                const uint32_t texel_y0 = Helper::Max(y0, y << level);
+                const uint32_t texel_x1 = Helper::Min(x1, ((x + 1) << level) - 1);
+                const uint32_t texel_y1 = Helper::Min(y1, ((y + 1) << level) - 1);
+                if (IsRegionVisible(level - 1, texel_x0, texel_y0, texel_x1, texel_y1, depth))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    void OcclusionCuller::SetupTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+    {
+        // To pixels, with depth as 1/w (which, unlike w, is linear in screen space)
+        const array<float, 3> w_rcp = { 1.0f / v0.w, 1.0f / v1.w, 1.0f / v2.w };
+        const array<float, 3> x     = { (v0.x * w_rcp[0] * 0.5f + 0.5f) * buffer_width,  (v1.x * w_rcp[1] * 0.5f + 0.5f) * buffer_width,  (v2.x * w_rcp[2] * 0.5f + 0.5f) * buffer_width };
+        const array<float, 3> y     = { (0.5f - v0.y * w_rcp[0] * 0.5f) * buffer_height, (0.5f - v1.y * w_rcp[1] * 0.5f) * buffer_height, (0.5f - v2.y * w_rcp[2] * 0.5f) * buffer_height };
+
+        // Cull back faces (clockwise is front facing, same as the rasterizer states) and degenerate triangles
+        const float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area <= 0.0f)
+            return;
+
+        Triangle triangle;
+        triangle.x_min = Helper::Min3(x[0], x[1], x[2]);
+        triangle.x_max = Helper::Max3(x[0], x[1], x[2]);
+        triangle.y_min = Helper::Min3(y[0], y[1], y[2]);
+        triangle.y_max = Helper::Max3(y[0], y[1], y[2]);
+
+        // Off-screen
+        if (triangle.x_max < 0.0f || triangle.y_max < 0.0f || triangle.x_min >= buffer_width || triangle.y_min >= buffer_height)
+            return;
+
+        // Edge functions, the edge opposite to each vertex
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const uint32_t a        = (i + 1) % 3;
+            const uint32_t b        = (i + 2) % 3;
+            triangle.edge_a[i]      = y[a] - y[b];
+            triangle.edge_b[i]      = x[b] - x[a];
+            triangle.edge_c[i]      = -(triangle.edge_a[i] * x[a] + triangle.edge_b[i] * y[a]);
+        }
+
+        // Depth plane, biased towards the farthest point of each pixel so that occluders stay conservative
+        const float d1x         = x[1] - x[0];
+        const float d1y         = y[1] - y[0];
+        const float d1z         = w_rcp[1] - w_rcp[0];
+        const float d2x         = x[2] - x[0];
+        const float d2y         = y[2] - y[0];
+        const float d2z         = w_rcp[2] - w_rcp[0];
+        triangle.depth_dx       = (d1z * d2y - d2z * d1y) / area;
+        triangle.depth_dy       = (d2z * d1x - d1z * d2x) / area;
+        const float bias        = 0.5f * (Helper::Abs(triangle.depth_dx) + Helper::Abs(triangle.depth_dy));
+        triangle.depth_c        = w_rcp[0] - triangle.depth_dx * x[0] - triangle.depth_dy * y[0] - bias;
+
+        m_triangles.emplace_back(triangle);
+    }
+
+    void OcclusionCuller::RasterizeRows(const uint32_t row_start, const uint32_t row_end)
+    {
+        const __m128 pixel_offsets  = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero           = _mm_setzero_ps();
+        vector<float>& depth        = m_mips[0];
+
+        for (const Triangle& triangle : m_triangles)
+        {
+            // Rows and columns whose pixel centers overlap the triangle's bounds
+            const float row_first = Helper::Max(Helper::Ceil(triangle.y_min - 0.5f), static_cast<float>(row_start));
+            const float row_last  = Helper::Min(Helper::Floor(triangle.y_max - 0.5f), static_cast<float>(row_end) - 1.0f);
+            if (row_first > row_last)
+                continue;
+
+            const float column_first = Helper::Max(Helper::Ceil(triangle.x_min - 0.5f), 0.0f);
+            const float column_last  = Helper::Min(Helper::Floor(triangle.x_max - 0.5f), buffer_width - 1.0f);
+            if (column_first > column_last)
+                continue;
+
+            // Columns are processed 4 at a time, starting from an aligned one
+            const uint32_t x_first  = static_cast<uint32_t>(column_first) & ~3u;
+            const uint32_t x_last   = static_cast<uint32_t>(column_last);
+            const uint32_t y_first  = static_cast<uint32_t>(row_first);
+            const uint32_t y_last   = static_cast<uint32_t>(row_last);
+
+            const __m128 edge_a0    = _mm_set1_ps(triangle.edge_a[0]);
+            const __m128 edge_a1    = _mm_set1_ps(triangle.edge_a[1]);
+            const __m128 edge_a2    = _mm_set1_ps(triangle.edge_a[2]);
+            const __m128 depth_dx   = _mm_set1_ps(triangle.depth_dx);
+
+            for (uint32_t y = y_first; y <= y_last; y++)
+            {
+                const float pixel_y     = y + 0.5f;
+                const __m128 edge_row0  = _mm_set1_ps(triangle.edge_b[0] * pixel_y + triangle.edge_c[0]);
+                const __m128 edge_row1  = _mm_set1_ps(triangle.edge_b[1] * pixel_y + triangle.edge_c[1]);
+                const __m128 edge_row2  = _mm_set1_ps(triangle.edge_b[2] * pixel_y + triangle.edge_c[2]);
+                const __m128 depth_row  = _mm_set1_ps(triangle.depth_dy * pixel_y + triangle.depth_c);
+                float* row              = &depth[y * buffer_width];
+
+                for (uint32_t x = x_first; x <= x_last; x += 4)
+                {
+                    const __m128 pixel_x = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixel_offsets);
+
+                    // Coverage
+                    const __m128 edge0  = _mm_add_ps(_mm_mul_ps(edge_a0, pixel_x), edge_row0);
+                    const __m128 edge1  = _mm_add_ps(_mm_mul_ps(edge_a1, pixel_x), edge_row1);
+                    const __m128 edge2  = _mm_add_ps(_mm_mul_ps(edge_a2, pixel_x), edge_row2);
+                    const __m128 mask   = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+                    if (_mm_movemask_ps(mask) == 0)
+                        continue;
+
+                    // Keep the nearest depth
+                    const __m128 depth_pixel    = _mm_add_ps(_mm_mul_ps(depth_dx, pixel_x), depth_row);
+                    const __m128 depth_old      = _mm_loadu_ps(row + x);
+                    const __m128 depth_new      = _mm_max_ps(depth_old, depth_pixel);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(mask, depth_new), _mm_andnot_ps(mask, depth_old)));
+                }
+            }
+        }
+    }
+
+    void OcclusionCuller::BuildHierarchy()
+    {
+        for (uint32_t level = 1; level < static_cast<uint32_t>(m_mips.size()); level++)
+        {
+            const vector<float>& source     = m_mips[level - 1];
+            const uint32_t source_width     = m_mip_sizes[level - 1][0];
+            const uint32_t source_height    = m_mip_sizes[level - 1][1];
+            vector<float>& destination      = m_mips[level];
+            const uint32_t width            = m_mip_sizes[level][0];
+            const uint32_t height           = m_mip_sizes[level][1];
+
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const uint32_t y0 = Helper::Min(y * 2, source_height - 1);
+                const uint32_t y1 = Helper::Min(y * 2 + 1, source_height - 1);
+
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const uint32_t x0 = Helper::Min(x * 2, source_width - 1);
+                    const uint32_t x1 = Helper::Min(x * 2 + 1, source_width - 1);
+
+                    // Farthest
+                    destination[y * width + x] = Helper::Min
+                    (
+                        Helper::Min(source[y0 * source_width + x0], source[y0 * source_width + x1]),
+                        Helper::Min(source[y1 * source_width + x0], source[y1 * source_width + x1])
+                    );
+                }
+            }
+        }
+    }
+
+    bool OcclusionCuller::Benchmark(Context* context, const uint32_t box_count, const uint32_t iterations /*= 100*/)
+    {
+        if (box_count == 0 || iterations == 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // A camera looking down +Z, with a 16:9 aspect ratio
+        const float near_plane  = 0.3f;
+        const Matrix view       = Matrix::CreateLookAtLH(Vector3::Zero, Vector3::Forward, Vector3::Up);
+        const Matrix projection = Matrix::CreatePerspectiveFieldOfViewLH(Helper::DegreesToRadians(60.0f), 16.0f / 9.0f, near_plane, 1000.0f);
+
+        // A wall facing the camera
+        const float wall_z          = 10.0f;
+        const Vector3 wall_extents  = Vector3(8.0f, 4.0f, 0.0f);
+        vector<RHI_Vertex_PosTexNorTan> wall_vertices;
+        wall_vertices.emplace_back(Vector3(-wall_extents.x,  wall_extents.y, wall_z), Vector2(0, 0)); // 0 top-left
+        wall_vertices.emplace_back(Vector3( wall_extents.x,  wall_extents.y, wall_z), Vector2(1, 0)); // 1 top-right
+        wall_vertices.emplace_back(Vector3(-wall_extents.x, -wall_extents.y, wall_z), Vector2(0, 1)); // 2 bottom-left
+        wall_vertices.emplace_back(Vector3( wall_extents.x, -wall_extents.y, wall_z), Vector2(1, 1)); // 3 bottom-right
+        const vector<uint32_t> wall_indices = { 0, 1, 3, 0, 3, 2 };
+        const vector<Occluder> occluders    = { Occluder(wall_vertices.data(), wall_indices.data(), static_cast<uint32_t>(wall_indices.size()), Matrix::Identity) };
+
+        // Scatter boxes in front of, around and behind the wall, with a fixed seed so that runs are comparable
+        vector<BoundingBox> boxes(box_count);
+        mt19937 generator(1337);
+        uniform_real_distribution<float> distribution_x(-30.0f, 30.0f);
+        uniform_real_distribution<float> distribution_y(-10.0f, 10.0f);
+        uniform_real_distribution<float> distribution_z(2.0f, 60.0f);
+        uniform_real_distribution<float> distribution_size(0.2f, 2.0f);
+        for (BoundingBox& box : boxes)
+        {
+            const Vector3 center    = Vector3(distribution_x(generator), distribution_y(generator), distribution_z(generator));
+            const Vector3 extents   = Vector3(distribution_size(generator), distribution_size(generator), distribution_size(generator));
+            box                     = BoundingBox(center - extents, center + extents);
+        }
+
+        OcclusionCuller culler(context);
+        OcclusionCuller culler_reference;
+
+        // Build
+        Stopwatch timer;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            culler.Build(view, projection, near_plane, occluders);
+        }
+        const float time_build = timer.GetElapsedTimeMs() / iterations;
+
+        // Test
+        uint32_t occluded = 0;
+        timer.Start();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            occluded = 0;
+            for (const BoundingBox& box : boxes)
+            {
+                occluded += culler.IsVisible(box) ? 0 : 1;
+            }
+        }
+        const float time_test = timer.GetElapsedTimeMs() / iterations;
+
+        // Validate, boxes in front of the wall must be visible, boxes behind the middle of the wall must be occluded
+        culler_reference.Build(view, projection, near_plane, occluders);
+        const bool match        = culler.GetDepth() == culler_reference.GetDepth();
+        uint32_t false_occluded = 0;
+        uint32_t missed         = 0;
+        for (const BoundingBox& box : boxes)
+        {
+            const bool visible = culler.IsVisible(box);
+
+            if (box.GetMin().z < wall_z && !visible)
+            {
+                false_occluded++;
+            }
+
+            // Projected onto the wall (from the camera), with a margin of a few texels
+            const float scale = wall_z / box.GetMin().z;
+            const bool hidden = box.GetMin().z > wall_z &&
+                Helper::Max(Helper::Abs(box.GetMin().x), Helper::Abs(box.GetMax().x)) * scale < wall_extents.x * 0.9f &&
+                Helper::Max(Helper::Abs(box.GetMin().y), Helper::Abs(box.GetMax().y)) * scale < wall_extents.y * 0.9f;
+
+            if (hidden && visible)
+            {
+                missed++;
+            }
+        }
+
+        const bool passed = match && false_occluded == 0 && missed == 0;
+        LOG_INFO("%d boxes, %d triangles: build %.3f ms, test %.3f ms, %d occluded, %d wrongly occluded, %d missed, threaded results %s",
+            box_count,
+            culler.GetTriangleCount(),
+            time_build,
+            time_test,
+            occluded,
+            false_occluded,
+            missed,
+            match ? "match" : "differ"
+        );
+
+        return passed;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include <array>
+#include "../Core/EngineDefs.h"
+#include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+//===============================
+
+namespace Spartan
+{
+    class Context;
+    class Profiler;
+    class Threading;
+    struct RHI_Vertex_PosTexNorTan;
+
+    // An occluder as seen by the culler, kept free of any component so the culler can run headless
+    struct Occluder
+    {
+        Occluder() = default;
+        Occluder(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count, const Math::Matrix& transform)
+        {
+            this->vertices      = vertices;
+            this->indices       = indices;
+            this->index_count   = index_count;
+            this->transform     = transform;
+        }
+
+        const RHI_Vertex_PosTexNorTan* vertices = nullptr;  // indices are relative to this
+        const uint32_t* indices                 = nullptr;
+        uint32_t index_count                    = 0;
+        Math::Matrix transform                  = Math::Matrix::Identity;
+    };
+
+    // Software occlusion culling. A few occluders are rasterized (multi-threaded, 4 pixels at a time with SSE)
+    // into a low resolution depth buffer, from which a hierarchy of the farthest depths is built. Bounding boxes
+    // are then tested starting from the level of the hierarchy where they cover at most 4x4 texels,
+    // refining towards finer levels only where a coarse texel can't prove occlusion.
+    // Depth is stored as 1/w, so it works the same with and without reverse-z.
+    class SPARTAN_CLASS OcclusionCuller
+    {
+    public:
+        static const uint32_t buffer_width  = 256;
+        static const uint32_t buffer_height = 128;
+
+        OcclusionCuller(Context* context = nullptr);
+        ~OcclusionCuller() = default;
+
+        // Rasterizes the occluders and builds the depth hierarchy
+        bool Build(const Math::Matrix& view, const Math::Matrix& projection, float near_plane, const std::vector<Occluder>& occluders);
+
+        // Returns false only if the box is guaranteed to be hidden behind the occluders
+        bool IsVisible(const Math::BoundingBox& box) const;
+
+        // A wall with boxes around it, the ones in front have to stay visible and the ones behind its middle have to be culled
+        static bool Benchmark(Context* context, uint32_t box_count, uint32_t iterations = 100);
+
+        // Properties
+        uint32_t GetTriangleCount()             const { return static_cast<uint32_t>(m_triangles.size()); }
+        const std::vector<float>& GetDepth()    const { return m_mips[0]; }
+        bool IsValid()                          const { return m_valid; }
+
+    private:
+        struct Triangle
+        {
+            float y_min;
+            float y_max;
+            float x_min;
+            float x_max;
+            std::array<float, 3> edge_a;    // edge functions, a * x + b * y + c >= 0 inside
+            std::array<float, 3> edge_b;
+            std::array<float, 3> edge_c;
+            float depth_dx;                 // depth plane, already biased towards the farthest point of each pixel
+            float depth_dy;
+            float depth_c;
+        };
+
+        void SetupTriangle(const Math::Vector4& v0, const Math::Vector4& v1, const Math::Vector4& v2);
+        void RasterizeRows(uint32_t row_start, uint32_t row_end);
+        void BuildHierarchy();
+        bool IsRegionVisible(uint32_t level, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, float depth) const;
+
+        // Setup
+        Math::Matrix m_view_projection;
+        float m_near_plane  = 0.0f;
+        bool m_valid        = false;
+        std::vector<Triangle> m_triangles;
+        std::vector<Math::Vector4> m_clip_positions;
+
+        // Depth hierarchy, level 0 holds the nearest depth, every level after that the farthest of the 2x2 below it
+        std::vector<std::vector<float>> m_mips;
+        std::vector<std::array<uint32_t, 2>> m_mip_sizes;
+
+        // Dependencies
+        Context* m_context      = nullptr;
+        Profiler* m_profiler    = nullptr;
+        Threading* m_threading  = nullptr;
+    };
+}
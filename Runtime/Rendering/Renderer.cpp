@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============================
 #include "Renderer.h"
 #include "Model.h"
+#include "Mesh.h"
 #include "ShaderGBuffer.h"
 #include "Font/Font.h"
 #include "Gizmos/Grid.h"
@@ -31,6 +32,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Resource/ResourceCache.h"
 #include "../Core/Engine.h"
 #include "../Core/Timer.h"
+#include "../World/World.h"
 #include "../World/Entity.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
@@ -45,6 +47,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_DescriptorCache.h"
+#include "../RHI/RHI_ShaderCache.h"
+#include "../RHI/RHI_BindlessTable.h"
 //=========================================
 
 //= NAMESPACES ===============
@@ -70,6 +74,9 @@ namespace Spartan
         m_options |= Render_ScreenSpaceReflections;
         m_options |= Render_AntiAliasing_Taa;
         m_options |= Render_Sharpening_LumaSharpen;
+        m_options |= Render_ClusteredLighting;
+        m_options |= Render_OcclusionCulling;
+        m_options |= Render_TextureStreaming;
 
         // Option values
         m_option_values[Option_Value_Anisotropy]              = 16.0f;
@@ -81,6 +88,9 @@ namespace Spartan
         m_option_values[Option_Value_Sharpen_Clamp]           = 0.35f;
         m_option_values[Option_Value_Bloom_Intensity]         = 0.1f;
         m_option_values[Option_Value_Motion_Blur_Intensity]   = 0.02f;
+        m_option_values[Option_Value_Dynamic_Resolution_Target] = 1000.0f / 60.0f;
+        m_option_values[Option_Value_Lod_Threshold]             = 1.0f;
+        m_option_values[Option_Value_Lod_Bias_Shadows]          = 1.0f;
 
 		// Subscribe to events
 		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Complete,    EVENT_HANDLER_VARIANT(RenderablesAcquire));
@@ -92,6 +102,12 @@ namespace Spartan
 		// Unsubscribe from events
 		UNSUBSCRIBE_FROM_EVENT(Event_World_Resolve_Complete, EVENT_HANDLER_VARIANT(RenderablesAcquire));
 
+        // Remember which shader variations were used, so the next run can compile them at startup
+        if (m_shader_precompiler)
+        {
+            m_shader_precompiler->SaveManifest();
+        }
+
 		m_entities.clear();
 		m_camera = nullptr;
 
@@ -125,11 +141,30 @@ namespace Spartan
         }
 
         // Create pipeline cache
-        m_pipeline_cache = make_shared<RHI_PipelineCache>(m_rhi_device.get());
+        m_pipeline_cache = make_shared<RHI_PipelineCache>(m_rhi_device.get(), m_resource_cache->GetDataDirectory() + "/pipeline_cache");
 
         // Create descriptor cache
         m_descriptor_cache = make_shared<RHI_DescriptorCache>(m_rhi_device.get());
 
+        // Create shader cache (compiled shaders persist across runs)
+        m_shader_cache = make_shared<RHI_ShaderCache>(m_resource_cache->GetDataDirectory() + "/shader_cache");
+
+        // Create light cluster builder
+        m_light_clusters = make_unique<LightClusters>(m_context);
+
+        // Create shadow atlas
+        m_shadow_atlas = make_unique<ShadowAtlas>(m_context);
+
+        // Create occlusion culler
+        m_occlusion_culler = make_unique<OcclusionCuller>(m_context);
+
+        // Create texture streamer
+        m_texture_streamer = make_unique<TextureStreamer>(m_context);
+
+        // Create dynamic resolution controller
+        m_dynamic_resolution = make_unique<DynamicResolution>();
+        m_dynamic_resolution->SetTargetFrameTime(m_option_values[Option_Value_Dynamic_Resolution_Target]);
+
         // Create swap chain
         {
             m_swap_chain = make_shared<RHI_SwapChain>
@@ -171,6 +206,13 @@ namespace Spartan
 		CreateSamplers();
 		CreateTextures();
 
+        // The default textures stand in for the ones which are still uploading, so they have to be usable from the first frame
+        m_rhi_device->Queue_WaitUploads();
+
+        // Start compiling the shader variations which previous runs ended up using
+        m_shader_precompiler = make_unique<ShaderPrecompiler>(m_context);
+        m_shader_precompiler->Precompile(ShaderPrecompile_Manifest);
+
 		if (!m_initialized)
 		{
 			// Log on-screen as the renderer is ready
@@ -195,6 +237,12 @@ namespace Spartan
         if (m_swap_chain && !m_swap_chain->IsPresenting())
             return;
 
+        // Once the shaders have compiled, create the pipelines previous runs used, in the background
+        if (!m_pipelines_prewarmed)
+        {
+            PrewarmPipelines();
+        }
+
 		// If there is no camera, clear
 		if (!m_camera)
 		{
@@ -209,6 +257,9 @@ namespace Spartan
 			return;
 		}
 
+        // Pick the resolution to render at, has to happen before anything that depends on it
+        UpdateResolutionScale(delta_time);
+
         // Reset dynamic buffer indices when the swapchain resets to first buffer/command list
         if (m_swap_chain->GetCmdIndex() == 0)
         {
@@ -239,8 +290,8 @@ namespace Spartan
 				const uint64_t samples	        = 16;
 				const uint64_t index	        = m_frame_num % samples;
 				m_taa_jitter			        = (Utility::Sampling::Halton2D(index, 2, 3) * 2.0f - 1.0f);
-				m_taa_jitter.x			        = (m_taa_jitter.x / m_resolution.x) * scale;
-				m_taa_jitter.y			        = (m_taa_jitter.y / m_resolution.y) * scale;
+				m_taa_jitter.x			        = (m_taa_jitter.x / m_resolution_render.x) * scale;
+				m_taa_jitter.y			        = (m_taa_jitter.y / m_resolution_render.y) * scale;
                 m_buffer_frame_cpu.projection   *= Matrix::CreateTranslation(Vector3(m_taa_jitter.x, m_taa_jitter.y, 0.0f));
 			}
 			else
@@ -249,12 +300,19 @@ namespace Spartan
 				m_taa_jitter_previous   = Vector2::Zero;		
 			}
 
-            // Compute some TAA affected matrices
+            // Compute some TAA affected matrices (indirect draws rebuild last frame's positions from the previous one)
+            m_buffer_frame_cpu.view_projection_previous     = m_buffer_frame_cpu.view_projection;
             m_buffer_frame_cpu.view_projection              = m_buffer_frame_cpu.view * m_buffer_frame_cpu.projection;
             m_buffer_frame_cpu.view_projection_inv          = Matrix::Invert(m_buffer_frame_cpu.view_projection);   
             m_buffer_frame_cpu.view_projection_unjittered   = m_buffer_frame_cpu.view * m_camera->GetProjectionMatrix();
 		}
 
+        // Decide which texture mips should be resident and stream them, when disabled everything streams back in
+        if (m_texture_streamer)
+        {
+            m_texture_streamer->Tick(m_entities[Renderer_Object_Opaque], m_entities[Renderer_Object_Transparent], m_camera.get(), m_viewport.height, GetOption(Render_TextureStreaming));
+        }
+
         m_is_rendering = true;
         Pass_Main(m_swap_chain->GetCmdList());
         m_is_rendering = false;
@@ -320,6 +378,108 @@ namespace Spartan
 		LOG_INFO("Resolution set to %dx%d", width, height);
 	}
 
+    void Renderer::UpdateResolutionScale(const float delta_time)
+    {
+        const bool enabled = GetOption(Render_DynamicResolution);
+
+        if (enabled)
+        {
+            m_dynamic_resolution->Update(m_profiler->GetTimeCpuLast(), m_profiler->GetTimeGpuLast(), delta_time);
+        }
+        else if (m_dynamic_resolution->GetLevel() != DynamicResolution::level_full)
+        {
+            m_dynamic_resolution->Reset();
+        }
+
+        SetResolutionScaleLevel(m_dynamic_resolution->GetLevel());
+
+        // Once disabled, the render textures of the other levels are no longer needed
+        if (!enabled)
+        {
+            bool parked = false;
+            for (const RenderTextureSet& set : m_render_texture_sets)
+            {
+                parked = parked || !set.render_targets.empty();
+            }
+
+            if (parked)
+            {
+                Flush(); // they might still be in use
+
+                for (RenderTextureSet& set : m_render_texture_sets)
+                {
+                    set.render_targets.clear();
+                    set.render_tex_bloom.clear();
+                }
+                m_taa_history_previous = nullptr;
+            }
+        }
+    }
+
+    void Renderer::SetResolutionScaleLevel(const uint32_t level)
+    {
+        if (level == m_resolution_scale_level || level >= DynamicResolution::level_count)
+            return;
+
+        // The new level's TAA history gets resampled from the current one, so that the switch doesn't ghost
+        m_taa_history_previous = m_render_targets[RenderTarget_TaaHistory];
+
+        // Park the active render textures
+        RenderTextureSet& set_current = m_render_texture_sets[m_resolution_scale_level];
+        set_current.render_targets.swap(m_render_targets);
+        set_current.render_tex_bloom.swap(m_render_tex_bloom);
+
+        // Take over the render textures of the requested level
+        RenderTextureSet& set_next = m_render_texture_sets[level];
+        m_render_targets.swap(set_next.render_targets);
+        m_render_tex_bloom.swap(set_next.render_tex_bloom);
+
+        // Resolution independent render targets always stay with the active level
+        for (const Renderer_RenderTarget_Type type : { RenderTarget_Brdf_Specular_Lut, RenderTarget_Brdf_Prefiltered_Environment })
+        {
+            auto it = set_current.render_targets.find(type);
+            if (it != set_current.render_targets.end())
+            {
+                m_render_targets[type] = it->second;
+                set_current.render_targets.erase(it);
+            }
+        }
+
+        m_resolution_scale_level = level;
+
+        // Only the active level and full resolution (the upsample target) stay resident, a level dynamic resolution returns to
+        // gets its render textures created again, releasing them doesn't need a flush since their destruction is deferred
+        for (uint32_t i = 0; i < DynamicResolution::level_count; i++)
+        {
+            if (i != level && i != DynamicResolution::level_full)
+            {
+                m_render_texture_sets[i].render_targets.clear();
+                m_render_texture_sets[i].render_tex_bloom.clear();
+            }
+        }
+
+        // Compute the render resolution, keeping it pixel perfect
+        const float scale   = DynamicResolution::GetScale(level);
+        uint32_t width      = static_cast<uint32_t>(m_resolution.x * scale);
+        uint32_t height     = static_cast<uint32_t>(m_resolution.y * scale);
+        width               -= (width  % 2 != 0) ? 1 : 0;
+        height              -= (height % 2 != 0) ? 1 : 0;
+        m_resolution_render = Vector2(static_cast<float>(width), static_cast<float>(height));
+
+        // Render textures of a level are created the first time it's used
+        if (m_render_targets.find(RenderTarget_Gbuffer_Albedo) == m_render_targets.end())
+        {
+            CreateRenderTexturesScaled(width, height);
+        }
+    }
+
+    RHI_Texture* Renderer::GetFrameTexture() const
+    {
+        // When rendering at a lower resolution, the frame ends up upsampled in the full resolution render target
+        const auto& render_targets = m_resolution_scale_level == DynamicResolution::level_full ? m_render_targets : m_render_texture_sets[DynamicResolution::level_full].render_targets;
+        return render_targets.at(RenderTarget_Composition_Ldr).get();
+    }
+
 	void Renderer::DrawLine(const Vector3& from, const Vector3& to, const Vector4& color_from, const Vector4& color_to, const bool depth /*= true*/)
 	{
 		if (depth)
@@ -439,6 +599,87 @@ namespace Spartan
         return m_buffer_material_gpu->Unmap();
     }
 
+    uint32_t Renderer::GetMaterialBindlessSlot(const Material* material)
+    {
+        // Slots stay with a material until it's destroyed (slot 0 is the sky), so its bindless entry only gets rewritten when it changes
+        return m_rhi_device->GetBindlessTable()->GetMaterialIndex(material->GetId());
+    }
+
+    uint32_t Renderer::UpdateMaterialBindless(Material* material)
+    {
+        RHI_BindlessTable* bindless = m_rhi_device->GetBindlessTable();
+        const uint32_t slot         = GetMaterialBindlessSlot(material);
+
+        // Only rewritten when it changed, the table compares against its own copy
+        BufferMaterialBindless material_bindless;
+        material_bindless.color             = material->GetColorAlbedo();
+        material_bindless.tiling_uv         = material->GetTiling();
+        material_bindless.offset_uv         = material->GetOffset();
+        material_bindless.roughness_mul     = material->GetProperty(Material_Roughness);
+        material_bindless.metallic_mul      = material->GetProperty(Material_Metallic);
+        material_bindless.normal_mul        = material->GetProperty(Material_Normal);
+        material_bindless.height_mul        = material->GetProperty(Material_Height);
+        material_bindless.texture_color     = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Color));
+        material_bindless.texture_roughness = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Roughness));
+        material_bindless.texture_metallic  = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Metallic));
+        material_bindless.texture_normal    = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Normal));
+        material_bindless.texture_height    = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Height));
+        material_bindless.texture_occlusion = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Occlusion));
+        material_bindless.texture_emission  = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Emission));
+        material_bindless.texture_mask      = bindless->GetTextureIndex(material->GetTexture_Ptr(Material_Mask));
+        bindless->UpdateMaterial(m_swap_chain->GetCmdIndex(), slot, &material_bindless);
+
+        return slot;
+    }
+
+    void Renderer::UpdateDrawIndirect(RHI_CommandList* cmd_list)
+    {
+        if (!m_draw_indirect)
+            return;
+
+        // The region is about to be written, so the previous submission of this command list, which read it, has to be done
+        if (!cmd_list->Wait())
+            return;
+
+        // Every opaque renderable gets an instance, shadows need the ones outside of the camera's view too
+        unordered_map<uint32_t, uint32_t> material_slots;
+        m_draw_indirect->BeginUpdate();
+        for (Entity* entity : m_entities[Renderer_Object_Opaque])
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            const Model* model = renderable->GeometryModel();
+            if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                continue;
+
+            Material* material = renderable->GetMaterial();
+            if (!material)
+                continue;
+
+            // Materials are shared, so each is only updated once
+            auto it = material_slots.find(material->GetId());
+            if (it == material_slots.end())
+            {
+                it = material_slots.emplace(material->GetId(), UpdateMaterialBindless(material)).first;
+            }
+
+            m_draw_indirect->UpdateInstance
+            (
+                entity->GetId(),
+                model,
+                model->GetVertexTransform() * entity->GetTransform()->GetMatrix(),
+                renderable->GetAabb(),
+                it->second,
+                renderable->GeometryIndexCount(renderable->GeometryLod()),
+                renderable->GeometryIndexOffset(renderable->GeometryLod()),
+                renderable->GeometryVertexOffset()
+            );
+        }
+        m_draw_indirect->EndUpdate(m_swap_chain->GetCmdIndex(), m_rhi_device->GetBindlessTable());
+    }
+
     template<typename T>
     inline bool update_dynamic_buffer(RHI_CommandList* cmd_list, RHI_ConstantBuffer* buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index)
     {
@@ -548,6 +789,8 @@ namespace Spartan
         const bool contact_shadows    = static_cast<float>(m_options & Render_ScreenSpaceShadows);
 
         for (uint32_t i = 0; i < light->GetShadowArraySize(); i++) { m_buffer_light_cpu.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i); }
+        for (uint32_t i = 0; i < light->GetShadowArraySize(); i++) { m_buffer_light_cpu.atlas_rect[i] = m_shadow_atlas->GetTileUv(light, i); }
+        m_buffer_light_cpu.atlas_texel_size             = Vector2(1.0f / static_cast<float>(Helper::Max(m_shadow_atlas->GetResolution(), 1u)));
         m_buffer_light_cpu.intensity_range_angle_bias   = Vector4(light->GetIntensity(), light->GetRange(), light->GetAngle(), GetOption(Render_ReverseZ) ? light->GetBias() : -light->GetBias());
         m_buffer_light_cpu.color                        = light->GetColor();
         m_buffer_light_cpu.normal_bias                  = light->GetNormalBias();
@@ -562,52 +805,183 @@ namespace Spartan
         return m_buffer_light_gpu->Unmap();
     }
 
-	void Renderer::RenderablesAcquire(const Variant& entities_variant)
+    bool Renderer::UpdateLightClustersBuffer()
+    {
+        m_light_clusters_valid = false;
+
+        if (!GetOption(Render_ClusteredLighting) || m_camera->GetProjectionType() != Projection_Perspective)
+            return true;
+
+        // The grid is a single constant buffer, Vulkan only guarantees 16 KB of those, so smaller devices keep a pass per light.
+        // The option is left alone, the frame simply falls back since m_light_clusters_valid stays false.
+        const uint32_t max_constant_buffer_size = m_rhi_device->GetContextRhi()->max_constant_buffer_size;
+        if (sizeof(BufferLightClusters) > max_constant_buffer_size)
+        {
+            if (!m_light_clusters_unsupported_logged)
+            {
+                LOG_WARNING("Light clusters need a %d byte constant buffer but the device supports up to %d bytes, falling back to a pass per light...", static_cast<uint32_t>(sizeof(BufferLightClusters)), max_constant_buffer_size);
+                m_light_clusters_unsupported_logged = true;
+            }
+            return true;
+        }
+
+        // Gather the lights which can be shaded without their own pass
+        vector<const Light*> lights;
+        m_cluster_lights.clear();
+        for (const auto& entity : m_entities[Renderer_Object_Light])
+        {
+            if (const Light* light = entity->GetComponent<Light>())
+            {
+                if (IsLightClusterable(light) && lights.size() < cluster_max_lights)
+                {
+                    lights.emplace_back(light);
+                    m_cluster_lights.emplace_back(light->GetTransform()->GetPosition(), light->GetRange());
+                }
+            }
+        }
+
+        if (m_cluster_lights.empty())
+            return true;
+
+        // Bin them
+        if (!m_light_clusters->Build(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix(), m_camera->GetNearPlane(), m_camera->GetFarPlane(), m_cluster_lights))
+            return false;
+
+        // Map
+        BufferLightClusters* buffer = static_cast<BufferLightClusters*>(m_buffer_light_clusters_gpu->Map());
+        if (!buffer)
+        {
+            LOG_ERROR("Failed to map buffer");
+            return false;
+        }
+
+        // Update
+        for (uint32_t i = 0; i < static_cast<uint32_t>(lights.size()); i++)
+        {
+            const Light* light              = lights[i];
+            const bool is_spot              = light->GetLightType() == LightType_Spot;
+            const Vector4& color            = light->GetColor();
+            buffer->position_range[i]       = Vector4(m_cluster_lights[i].position, m_cluster_lights[i].range);
+            buffer->color_intensity[i]      = Vector4(color.x, color.y, color.z, light->GetIntensity());
+            buffer->direction_angle[i]      = Vector4(light->GetDirection(), is_spot ? light->GetAngle() : -1.0f);
+        }
+        m_light_clusters->Fill(buffer);
+
+        // Unmap
+        m_light_clusters_valid = m_buffer_light_clusters_gpu->Unmap();
+        return m_light_clusters_valid;
+    }
+
+	void Renderer::RenderablesAcquire(const Variant& delta_variant)
 	{
         SCOPED_TIME_BLOCK(m_profiler);
 
-		// Clear previous state
-		m_entities.clear();
-		m_camera = nullptr;
+        const WorldResolveDelta* delta = delta_variant.Get<WorldResolveDelta*>();
+        if (!delta)
+            return;
 
-		vector<shared_ptr<Entity>> entities = entities_variant.Get<vector<shared_ptr<Entity>>>();
-		for (const auto& entity : entities)
-		{
-			if (!entity || !entity->IsActive())
-				continue;
+        // Drop everything on a full resolve
+        if (delta->reset)
+        {
+            m_entities.clear();
+            m_entity_indices.clear();
+            m_camera = nullptr;
 
-			// Get all the components we are interested in
-            Renderable* renderable  = entity->GetComponent<Renderable>();
-            Light* light            = entity->GetComponent<Light>();
-            Camera* camera          = entity->GetComponent<Camera>();
+            // A new world, get its materials and lights compiling before anything draws with them
+            if (m_shader_precompiler)
+            {
+                m_shader_precompiler->Precompile(ShaderPrecompile_World);
+            }
+        }
 
-			if (renderable)
-			{
-                bool is_transparent = false;
+        for (Entity* entity : delta->added)
+        {
+            RenderableAdd(entity);
+        }
 
-                if (const Material* material = renderable->GetMaterial())
-                {
-                    is_transparent = material->GetColorAlbedo().w < 1.0f;
-                }
+        // Components might have been added or removed, so re-acquire from scratch
+        for (Entity* entity : delta->modified)
+        {
+            RenderableRemove(entity);
+            RenderableAdd(entity);
+        }
 
-                m_entities[is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque].emplace_back(entity.get());
-			}
+        for (Entity* entity : delta->removed)
+        {
+            RenderableRemove(entity);
+        }
+	}
 
-			if (light)
-			{
-				m_entities[Renderer_Object_Light].emplace_back(entity.get());
-			}
+    void Renderer::RenderableAdd(Entity* entity)
+    {
+        if (!entity || !entity->IsActive() || entity->IsPendingDestruction())
+            return;
 
-			if (camera)
-			{
-				m_entities[Renderer_Object_Camera].emplace_back(entity.get());
-				m_camera = camera->GetPtrShared<Camera>();
-			}
-		}
+        const auto add = [this, entity](const Renderer_Object_Type object_type)
+        {
+            vector<Entity*>& entities = m_entities[object_type];
+            if (m_entity_indices[object_type].emplace(entity, static_cast<uint32_t>(entities.size())).second)
+            {
+                entities.emplace_back(entity);
+            }
+        };
 
-		RenderablesSort(&m_entities[Renderer_Object_Opaque]);
-		RenderablesSort(&m_entities[Renderer_Object_Transparent]);
-	}
+        // Get all the components we are interested in
+        Renderable* renderable  = entity->GetComponent<Renderable>();
+        Light* light            = entity->GetComponent<Light>();
+        Camera* camera          = entity->GetComponent<Camera>();
+
+        if (renderable)
+        {
+            bool is_transparent = false;
+
+            if (const Material* material = renderable->GetMaterial())
+            {
+                is_transparent = material->GetColorAlbedo().w < 1.0f;
+            }
+
+            add(is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque);
+        }
+
+        if (light)
+        {
+            add(Renderer_Object_Light);
+        }
+
+        if (camera)
+        {
+            add(Renderer_Object_Camera);
+            m_camera = camera->GetPtrShared<Camera>();
+        }
+    }
+
+    void Renderer::RenderableRemove(Entity* entity)
+    {
+        // Swap with the last entity and pop, the order doesn't matter as the visible entities get sorted every frame
+        for (auto& it : m_entity_indices)
+        {
+            auto& indices   = it.second;
+            auto index_it   = indices.find(entity);
+            if (index_it == indices.end())
+                continue;
+
+            vector<Entity*>& entities   = m_entities[it.first];
+            const uint32_t index        = index_it->second;
+            Entity* entity_last         = entities.back();
+
+            entities[index]         = entity_last;
+            indices[entity_last]    = index;
+            entities.pop_back();
+            indices.erase(entity);
+        }
+
+        // Fall back to any other camera
+        if (m_camera && m_camera->GetEntity() == entity)
+        {
+            const vector<Entity*>& cameras = m_entities[Renderer_Object_Camera];
+            m_camera = cameras.empty() ? nullptr : cameras.back()->GetComponent<Camera>()->GetPtrShared<Camera>();
+        }
+    }
 
 	void Renderer::RenderablesSort(vector<Entity*>* renderables)
 	{
@@ -630,6 +1004,114 @@ namespace Spartan
 		});
 	}
 
+    void Renderer::RenderablesUpdateLod()
+    {
+        const Vector3 camera_position   = m_camera->GetTransform()->GetPosition();
+        const bool orthographic         = m_camera->GetProjectionType() == Projection_Orthographic;
+        const float fov_vertical_rad    = m_camera->GetFovVerticalRad();
+        const float threshold           = m_option_values[Option_Value_Lod_Threshold];
+        const uint32_t shadow_bias      = static_cast<uint32_t>(m_option_values[Option_Value_Lod_Bias_Shadows]);
+
+        // Every renderable, not just the visible ones, since shadows need the ones outside of the camera's view too
+        for (const Renderer_Object_Type object_type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            for (Entity* entity : m_entities[object_type])
+            {
+                Renderable* renderable = entity->GetRenderable();
+                if (!renderable || renderable->GeometryLodCount() == 1)
+                    continue;
+
+                const float screen_size = orthographic ? m_viewport.height : TextureStreamer::ComputeScreenSize(renderable->GetAabb(), camera_position, fov_vertical_rad, m_viewport.height);
+                renderable->GeometryLodUpdate(screen_size, threshold, shadow_bias);
+            }
+        }
+    }
+
+    void Renderer::RenderablesCull()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        const bool occlusion_culling = GetOption(Render_OcclusionCulling) && m_occlusion_culler;
+        const Vector3 camera_position = m_camera->GetTransform()->GetPosition();
+
+        // Pick occluders, flagged renderables first and then the biggest (on screen) of the rest
+        m_occluders.clear();
+        if (occlusion_culling)
+        {
+            m_occluder_candidates.clear();
+            for (Entity* entity : m_entities[Renderer_Object_Opaque])
+            {
+                Renderable* renderable = entity->GetRenderable();
+                if (!renderable || !renderable->GeometryModel() || !m_camera->IsInViewFrustrum(renderable))
+                    continue;
+
+                const BoundingBox& aabb = renderable->GetAabb();
+                const float distance    = Helper::Max((aabb.GetCenter() - camera_position).Length(), m_camera->GetNearPlane());
+                const float size        = aabb.GetExtents().Length() / distance;
+
+                // Alpha tested geometry has holes in it, so it's only used when explicitly flagged
+                const Material* material    = renderable->GetMaterial();
+                const bool is_alpha_tested  = material && material->IsAlphaTested();
+
+                if (renderable->IsOccluder())
+                {
+                    m_occluder_candidates.emplace_back(numeric_limits<float>::max(), entity);
+                }
+                else if (!is_alpha_tested && size >= m_occluder_screen_size_min && renderable->GeometryIndexCount() / 3 <= m_occluder_triangle_max)
+                {
+                    m_occluder_candidates.emplace_back(size, entity);
+                }
+            }
+
+            sort(m_occluder_candidates.begin(), m_occluder_candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            const size_t occluder_count = Helper::Min(m_occluder_candidates.size(), static_cast<size_t>(m_occluder_count_max));
+            for (size_t i = 0; i < occluder_count; i++)
+            {
+                Entity* entity          = m_occluder_candidates[i].second;
+                Renderable* renderable  = entity->GetRenderable();
+                Mesh* mesh              = renderable->GeometryModel()->GetMesh().get();
+                if (!mesh || mesh->Indices_Get().empty())
+                    continue;
+
+                m_occluders.emplace_back
+                (
+                    mesh->Vertices_Get().data() + renderable->GeometryVertexOffset(),
+                    mesh->Indices_Get().data() + renderable->GeometryIndexOffset(),
+                    renderable->GeometryIndexCount(),
+                    entity->GetTransform()->GetMatrix()
+                );
+            }
+        }
+
+        const bool occlusion_valid = occlusion_culling && m_occlusion_culler->Build(m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix(), m_camera->GetNearPlane(), m_occluders);
+
+        // Frustum and occlusion test
+        for (const Renderer_Object_Type object_type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            vector<Entity*>& entities_visible = m_entities_visible[object_type];
+            entities_visible.clear();
+
+            for (Entity* entity : m_entities[object_type])
+            {
+                Renderable* renderable = entity->GetRenderable();
+                if (!renderable || !m_camera->IsInViewFrustrum(renderable))
+                    continue;
+
+                if (occlusion_valid && !m_occlusion_culler->IsVisible(renderable->GetAabb()))
+                {
+                    m_profiler->m_renderer_meshes_occluded++;
+                    continue;
+                }
+
+                entities_visible.emplace_back(entity);
+            }
+
+            // Front to back
+            RenderablesSort(&entities_visible);
+        }
+    }
+
     void Renderer::ClearEntities()
     {
         m_rhi_device->Queue_WaitAll();
@@ -642,6 +1124,29 @@ namespace Spartan
         }
 
         m_entities.clear();
+        m_entity_indices.clear();
+        m_entities_visible.clear();
+        m_occluders.clear();
+        m_cluster_lights.clear();
+        m_light_clusters_valid = false;
+
+        // The same entity ids may come back (e.g. reloading a world), so don't trust any cached shadows
+        m_shadow_atlas->Invalidate();
+    }
+
+    bool Renderer::IsLightClusterable(const Light* light) const
+    {
+        // Shadow maps (and therefore volumetric lighting) are bound per light, so those lights keep their own pass
+        return
+            light->GetLightType() != LightType_Directional  &&
+            !light->GetShadowsEnabled()                     &&
+            light->GetIntensity() != 0.0f;
+    }
+
+    RHI_Shader* Renderer::GetCompiledShader(const Renderer_Shader_Type type) const
+    {
+        const auto it = m_shaders.find(type);
+        return (it != m_shaders.end() && it->second->IsCompiled()) ? it->second.get() : nullptr;
     }
 
     const shared_ptr<Spartan::RHI_Texture>& Renderer::GetEnvironmentTexture()
@@ -686,6 +1191,10 @@ namespace Spartan
         {
             value = Helper::Clamp(value, static_cast<float>(m_resolution_shadow_min), static_cast<float>(m_rhi_device->GetContextRhi()->max_texture_dimension_2d));
         }
+        else if (option == Option_Value_Dynamic_Resolution_Target)
+        {
+            value = Helper::Clamp(value, 1.0f, 1000.0f);
+        }
 
         if (m_option_values[option] == value)
             return;
@@ -705,6 +1214,10 @@ namespace Spartan
                 }
             }
         }
+        else if (option == Option_Value_Dynamic_Resolution_Target)
+        {
+            m_dynamic_resolution->SetTargetFrameTime(value);
+        }
     }
 
     bool Renderer::Present()
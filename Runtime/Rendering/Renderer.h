@@ -25,7 +25,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_map>
 #include <array>
 #include <atomic>
+#include <bitset>
+#include <limits>
 #include "Renderer_ConstantBuffers.h"
+#include "LightClusters.h"
+#include "ShadowAtlas.h"
+#include "DynamicResolution.h"
+#include "OcclusionCuller.h"
+#include "TextureStreamer.h"
+#include "DrawIndirect.h"
+#include "ShaderPrecompiler.h"
 #include "Material.h"
 #include "../Core/ISubsystem.h"
 #include "../Math/Rectangle.h"
@@ -77,7 +86,11 @@ namespace Spartan
 		Render_ChromaticAberration	    = 1 << 19,
 		Render_Dithering			    = 1 << 20,
         Render_ReverseZ                 = 1 << 21,
-        Render_DepthPrepass             = 1 << 22
+        Render_DepthPrepass             = 1 << 22,
+        Render_ClusteredLighting        = 1 << 23,
+        Render_DynamicResolution        = 1 << 24,
+        Render_OcclusionCulling         = 1 << 25,
+        Render_TextureStreaming         = 1 << 26
 	};
 
     enum Renderer_Option_Value
@@ -90,7 +103,10 @@ namespace Spartan
         Option_Value_Bloom_Intensity,
         Option_Value_Sharpen_Strength,
         Option_Value_Sharpen_Clamp, // Limits maximum amount of sharpening a pixel receives - Algorithm's default: 0.035f
-        Option_Value_Motion_Blur_Intensity
+        Option_Value_Motion_Blur_Intensity,
+        Option_Value_Dynamic_Resolution_Target, // Frame time (in ms) that dynamic resolution aims for
+        Option_Value_Lod_Threshold,             // How far (in pixels) a level of detail can be from the full one
+        Option_Value_Lod_Bias_Shadows           // How many levels coarser shadows are drawn
     };
 
     enum Renderer_ToneMapping_Type
@@ -113,8 +129,16 @@ namespace Spartan
 	{
 		Shader_Gbuffer_V,
         Shader_Gbuffer_P,
+        Shader_GbufferBindless_P,
+        Shader_GbufferIndirect_V,
+        Shader_GbufferIndirect_P,
+        Shader_GbufferQuantized_V,
+        Shader_GbufferIndirectQuantized_V,
 		Shader_Depth_V,
         Shader_Depth_P,
+        Shader_DepthIndirect_V,
+        Shader_DepthQuantized_V,
+        Shader_DepthIndirectQuantized_V,
 		Shader_Quad_V,
 		Shader_Texture_P,
         Shader_Copy_C,
@@ -149,6 +173,7 @@ namespace Spartan
         Shader_Hbao_IndirectBounce_P,
         Shader_Ssr_P,
 		Shader_Entity_V,
+        Shader_EntityQuantized_V,
         Shader_Entity_Transform_P,
 		Shader_BlurBox_P,
 		Shader_BlurGaussian_P,
@@ -204,6 +229,8 @@ namespace Spartan
         // Resolution
         const Math::Vector2& GetResolution() const { return m_resolution; }
         void SetResolution(uint32_t width, uint32_t height);
+        const Math::Vector2& GetResolutionRender() const { return m_resolution_render; } // lower than the resolution when dynamic resolution kicks in
+        float GetResolutionScale() const { return DynamicResolution::GetScale(m_resolution_scale_level); }
 
 		// Editor
 		float m_gizmo_transform_size    = 0.015f;
@@ -242,7 +269,9 @@ namespace Spartan
         const std::shared_ptr<RHI_Device>& GetRhiDevice()   const { return m_rhi_device; } 
         RHI_PipelineCache* GetPipelineCache()               const { return m_pipeline_cache.get(); }
         RHI_DescriptorCache* GetDescriptorCache()           const { return m_descriptor_cache.get(); }
-        RHI_Texture* GetFrameTexture()                      const { return m_render_targets.at(RenderTarget_Composition_Ldr).get(); }
+        RHI_ShaderCache* GetShaderCache()                   const { return m_shader_cache.get(); }
+        ShaderPrecompiler* GetShaderPrecompiler()           const { return m_shader_precompiler.get(); }
+        RHI_Texture* GetFrameTexture() const;
         auto GetFrameNum()                                  const { return m_frame_num; }
         const auto& GetCamera()                             const { return m_camera; }
         auto IsInitialized()                                const { return m_initialized; }
@@ -266,6 +295,12 @@ namespace Spartan
 		void CreateShaders();
 		void CreateSamplers();
 		void CreateRenderTextures();
+        void CreateRenderTexturesScaled(uint32_t width, uint32_t height);
+        void PrewarmPipelines();
+
+        // Dynamic resolution
+        void UpdateResolutionScale(float delta_time);
+        void SetResolutionScaleLevel(uint32_t level);
 
 		// Passes
 		void Pass_Main(RHI_CommandList* cmd_list);
@@ -301,6 +336,8 @@ namespace Spartan
         void Pass_BrdfSpecularLut(RHI_CommandList* cmd_list);
         void Pass_Copy(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_Copy_CS(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
+        void Pass_ShadowAtlasClear(RHI_CommandList* cmd_list, const Math::Rectangle& tile);
+        void Pass_DrawIndirect(RHI_CommandList* cmd_list, const std::vector<DrawIndirect::Batch>& batches, const bool quantized); // only draws the batches with the given vertex layout
 
         // Constant buffers
         bool UpdateFrameBuffer();
@@ -308,16 +345,34 @@ namespace Spartan
         bool UpdateUberBuffer(RHI_CommandList* cmd_list);
         bool UpdateObjectBuffer(RHI_CommandList* cmd_list);
         bool UpdateLightBuffer(const Light* light);
+        bool UpdateLightClustersBuffer();
+        uint32_t GetMaterialBindlessSlot(const Material* material);
+        uint32_t UpdateMaterialBindless(Material* material);
+        void UpdateDrawIndirect(RHI_CommandList* cmd_list);
 
         // Misc
-        void RenderablesAcquire(const Variant& renderables);
+        void RenderablesAcquire(const Variant& delta);
+        void RenderableAdd(Entity* entity);
+        void RenderableRemove(Entity* entity);
         void RenderablesSort(std::vector<Entity*>* renderables);
+        void RenderablesCull();
+        void RenderablesUpdateLod();
         void ClearEntities();
+        bool IsLightClusterable(const Light* light) const;
+        RHI_Shader* GetCompiledShader(const Renderer_Shader_Type type) const; // null if it was never created (optional shaders) or hasn't compiled yet
 
         // Render textures
         std::unordered_map<Renderer_RenderTarget_Type, std::shared_ptr<RHI_Texture>> m_render_targets;
         std::vector<std::shared_ptr<RHI_Texture>> m_render_tex_bloom;
 
+        // Render textures of the inactive resolution scale levels, only full resolution is kept (it's the upsample target)
+        struct RenderTextureSet
+        {
+            std::unordered_map<Renderer_RenderTarget_Type, std::shared_ptr<RHI_Texture>> render_targets;
+            std::vector<std::shared_ptr<RHI_Texture>> render_tex_bloom;
+        };
+        std::array<RenderTextureSet, DynamicResolution::level_count> m_render_texture_sets;
+
         // Standard textures
         std::shared_ptr<RHI_Texture> m_tex_noise_normal;
         std::shared_ptr<RHI_Texture> m_tex_blue_noise;
@@ -337,6 +392,7 @@ namespace Spartan
 		std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_on_off_w;
         std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_on_off_r;
         std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_on_on_w;
+        std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_on_off_w_always;
 
         // Blend states 
         std::shared_ptr<RHI_BlendState> m_blend_disabled;
@@ -372,6 +428,7 @@ namespace Spartan
 
         // Resolution & Viewport
 		Math::Vector2 m_resolution	            = Math::Vector2::Zero;
+        Math::Vector2 m_resolution_render       = Math::Vector2::Zero;
 		RHI_Viewport m_viewport		            = RHI_Viewport(0, 0, 1920, 1080);
         Math::Vector2 m_viewport_editor_offset  = Math::Vector2::Zero;
 
@@ -416,19 +473,58 @@ namespace Spartan
         BufferLight m_buffer_light_cpu;
         BufferLight m_buffer_light_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_gpu;
+
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_clusters_gpu;
         //========================================================
 
         // Entities and material references
         std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities;
+        std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities_visible; // opaque and transparent entities which survived culling, updated every frame
+        std::unordered_map<Renderer_Object_Type, std::unordered_map<Entity*, uint32_t>> m_entity_indices; // position of each entity in m_entities, for constant time removal
         std::array<Material*, m_max_material_instances> m_material_instances;
+        std::bitset<std::numeric_limits<uint16_t>::max() + 1> m_gbuffer_variations_used; // indexed by variation flags, reused by every G-Buffer pass
         
         std::shared_ptr<Camera> m_camera;
 
+        // Clustered lighting
+        std::unique_ptr<LightClusters> m_light_clusters;
+        std::vector<ClusterLight> m_cluster_lights;
+        bool m_light_clusters_valid             = false;
+        bool m_light_clusters_unsupported_logged = false;
+
+        // Shadow atlas (point and spot lights)
+        std::unique_ptr<ShadowAtlas> m_shadow_atlas;
+
+        // Dynamic resolution
+        std::unique_ptr<DynamicResolution> m_dynamic_resolution;
+        uint32_t m_resolution_scale_level = DynamicResolution::level_full;
+        std::shared_ptr<RHI_Texture> m_taa_history_previous; // history of the previous level, resampled into the new one
+
+        // Texture streaming
+        std::unique_ptr<TextureStreamer> m_texture_streamer;
+
+        // Occlusion culling
+        std::unique_ptr<OcclusionCuller> m_occlusion_culler;
+        std::vector<Occluder> m_occluders;
+        std::vector<std::pair<float, Entity*>> m_occluder_candidates;
+        const uint32_t m_occluder_count_max         = 32;   // occluders per frame, flagged ones included
+        const uint32_t m_occluder_triangle_max      = 2048; // meshes with more triangles than that are never picked automatically
+        const float m_occluder_screen_size_min      = 0.2f; // bounding box radius over distance, for automatic picking
+
+        // Indirect draws (opaque geometry, with the bindless table)
+        std::unique_ptr<DrawIndirect> m_draw_indirect;
+        std::shared_ptr<RHI_IndirectBuffer> m_indirect_buffer;
+        const uint32_t m_draw_indirect_instance_capacity    = 16384;
+        const uint32_t m_draw_indirect_command_capacity     = 65536;    // per frame, shared by the depth pre-pass, g-buffer and light depth passes
+
         // RHI Core
         std::shared_ptr<RHI_Device> m_rhi_device;
         std::shared_ptr<RHI_SwapChain> m_swap_chain;
         std::shared_ptr<RHI_PipelineCache> m_pipeline_cache;
         std::shared_ptr<RHI_DescriptorCache> m_descriptor_cache;
+        std::shared_ptr<RHI_ShaderCache> m_shader_cache;
+        std::unique_ptr<ShaderPrecompiler> m_shader_precompiler;
+        bool m_pipelines_prewarmed = false;
 
         // Dependencies
         Profiler* m_profiler            = nullptr;
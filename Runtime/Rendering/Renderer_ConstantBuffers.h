@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===============
 #include "..\Math\Vector2.h"
 #include "..\Math\Vector3.h"
+#include "..\Math\Vector4.h"
 #include "..\Math\Matrix.h"
 //==========================
 
@@ -39,6 +40,7 @@ namespace Spartan
         Math::Matrix view_projection_inv;
         Math::Matrix view_projection_ortho;
         Math::Matrix view_projection_unjittered;
+        Math::Matrix view_projection_previous;
     
         float delta_time;
         float time;
@@ -130,17 +132,41 @@ namespace Spartan
         Math::Matrix object;
         Math::Matrix wvp_current;
         Math::Matrix wvp_previous;
+        uint32_t material_index;        // element of the bindless material buffer, within the frame's region (indirect draws get the region's first element and add their slot)
+        Math::Vector3 padding;
     
         bool operator==(const BufferObject& rhs) const
         {
             return
                 object          == rhs.object       &&
                 wvp_current     == rhs.wvp_current  &&
-                wvp_previous    == rhs.wvp_previous;
+                wvp_previous    == rhs.wvp_previous &&
+                material_index  == rhs.material_index;
         }
 
         bool operator!=(const BufferObject& rhs) const { return !(*this == rhs); }
     };
+
+    // Bindless material - One element of the structured buffer, texture indices point into the bindless texture array (0 means none)
+    struct BufferMaterialBindless
+    {
+        Math::Vector4 color;
+        Math::Vector2 tiling_uv;
+        Math::Vector2 offset_uv;
+        float roughness_mul;
+        float metallic_mul;
+        float normal_mul;
+        float height_mul;
+        uint32_t texture_color;
+        uint32_t texture_roughness;
+        uint32_t texture_metallic;
+        uint32_t texture_normal;
+        uint32_t texture_height;
+        uint32_t texture_occlusion;
+        uint32_t texture_emission;
+        uint32_t texture_mask;
+    };
+    static_assert(sizeof(BufferMaterialBindless) % 16 == 0, "BufferMaterialBindless must match the structured buffer stride");
     
     // Light buffer
     struct BufferLight
@@ -151,6 +177,9 @@ namespace Spartan
         float normal_bias;
         Math::Vector4 position;
         Math::Vector4 direction;
+        Math::Vector4 atlas_rect[6];    // xy: offset, zw: scale, zero when the light has no atlas tile
+        Math::Vector2 atlas_texel_size;
+        Math::Vector2 padding;
     
         bool operator==(const BufferLight& rhs)
         {
@@ -160,7 +189,26 @@ namespace Spartan
                 normal_bias                 == rhs.normal_bias                  &&
                 color                       == rhs.color                        &&
                 position                    == rhs.position                     &&
-                direction                   == rhs.direction;
+                direction                   == rhs.direction                    &&
+                atlas_rect                  == rhs.atlas_rect                   &&
+                atlas_texel_size            == rhs.atlas_texel_size;
         }
     };
+
+    // Clustered lighting - Updates once per frame
+    static const uint32_t cluster_grid_x            = 16;    // must match the shader
+    static const uint32_t cluster_grid_y            = 9;     // must match the shader
+    static const uint32_t cluster_grid_z            = 24;    // must match the shader
+    static const uint32_t cluster_count             = cluster_grid_x * cluster_grid_y * cluster_grid_z;
+    static const uint32_t cluster_max_lights        = 256;   // light indices are stored as bytes
+    static const uint32_t cluster_max_light_indices = 16384; // must match the shader
+    struct BufferLightClusters
+    {
+        Math::Vector4 light_count_slice_scale_bias;
+        Math::Vector4 position_range[cluster_max_lights];
+        Math::Vector4 color_intensity[cluster_max_lights];
+        Math::Vector4 direction_angle[cluster_max_lights];    // angle is negative for point lights
+        uint32_t offset_count[cluster_count];                 // offset in the low 16 bits, count in the high 16 bits
+        uint8_t light_indices[cluster_max_light_indices];
+    };
 }
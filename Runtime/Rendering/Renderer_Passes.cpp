@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==============================
 #include "Renderer.h"
+#include <algorithm>
 #include "Model.h"
 #include "ShaderGBuffer.h"
 #include "ShaderLight.h"
@@ -33,6 +34,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_PipelineState.h"
 #include "../RHI/RHI_Texture.h"
+#include "../RHI/RHI_BindlessTable.h"
+#include "../RHI/RHI_IndirectBuffer.h"
+#include "../RHI/RHI_SwapChain.h"
 #include "../World/Entity.h"
 #include "../World/Components/Light.h"
 #include "../World/Components/Camera.h"
@@ -47,14 +51,26 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Quantized vertex buffers have an input layout of their own, so they are drawn in render passes of their own
+    static bool has_batches(const vector<DrawIndirect::Batch>& batches, const bool quantized)
+    {
+        return any_of(batches.begin(), batches.end(), [quantized](const DrawIndirect::Batch& batch) { return batch.model->IsVertexBufferQuantized() == quantized; });
+    }
+
+    static uint32_t get_vertex_stride(const bool quantized)
+    {
+        return static_cast<uint32_t>(quantized ? sizeof(RHI_Vertex_PosTexNorTan16) : sizeof(RHI_Vertex_PosTexNorTan));
+    }
+
     void Renderer::SetGlobalSamplersAndConstantBuffers(RHI_CommandList* cmd_list) const
     {
         // Constant buffers
         cmd_list->SetConstantBuffer(0, RHI_Shader_Vertex | RHI_Shader_Pixel, m_buffer_frame_gpu);
         cmd_list->SetConstantBuffer(1, RHI_Shader_Pixel, m_buffer_material_gpu);
         cmd_list->SetConstantBuffer(2, RHI_Shader_Vertex | RHI_Shader_Pixel, m_buffer_uber_gpu);
-        cmd_list->SetConstantBuffer(3, RHI_Shader_Vertex, m_buffer_object_gpu);
+        cmd_list->SetConstantBuffer(3, RHI_Shader_Vertex | RHI_Shader_Pixel, m_buffer_object_gpu);
         cmd_list->SetConstantBuffer(4, RHI_Shader_Pixel, m_buffer_light_gpu);
+        cmd_list->SetConstantBuffer(5, RHI_Shader_Pixel, m_buffer_light_clusters_gpu);
         
         // Samplers
         cmd_list->SetSampler(0, m_sampler_compare_depth);
@@ -75,9 +91,34 @@ namespace Spartan
 
         // Updates onces, used almost everywhere
         UpdateFrameBuffer();
+
+        // Updates once, used by the light pass
+        UpdateLightClustersBuffer();
+
+        // Updates once, used by every pass which draws geometry and by the shadow atlas, which redraws tiles whose casters changed level
+        RenderablesUpdateLod();
+
+        // Updates once, used by the light depth and light passes
+        m_shadow_atlas->Update(m_camera.get(), m_entities[Renderer_Object_Light], m_entities[Renderer_Object_Opaque], m_entities[Renderer_Object_Transparent]);
+
+        // Updates once, used by the depth pre-pass and g-buffer passes
+        RenderablesCull();
+
+        // Updates once, used by the opaque light depth, depth pre-pass and g-buffer passes
+        UpdateDrawIndirect(cmd_list);
         
         // Runs only once
         Pass_BrdfSpecularLut(cmd_list);
+
+        // The resolution scale level changed, carry the TAA history over to the new level
+        if (m_taa_history_previous)
+        {
+            if (GetOption(Render_AntiAliasing_Taa))
+            {
+                Pass_Copy(cmd_list, m_taa_history_previous, m_render_targets[RenderTarget_TaaHistory]);
+            }
+            m_taa_history_previous = nullptr;
+        }
         
         const bool draw_transparent_objects = !m_entities[Renderer_Object_Transparent].empty();
         
@@ -118,15 +159,27 @@ namespace Spartan
             }
         }
         
-        // Post-processing
+        // Post-processing, outlines and lines test against the depth buffer so they are drawn at the render resolution
         {
             Pass_PostProcess(cmd_list);
             Pass_Outline(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]);
             Pass_Lines(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]);
-            Pass_TransformHandle(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get());
-            Pass_Icons(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get());
-            Pass_DebugBuffer(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]);
-            Pass_Text(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get());
+        }
+
+        // Dynamic resolution, reconstruct to the output resolution
+        const bool upsample              = m_resolution_scale_level != DynamicResolution::level_full;
+        shared_ptr<RHI_Texture>& tex_out = upsample ? m_render_texture_sets[DynamicResolution::level_full].render_targets[RenderTarget_Composition_Ldr] : m_render_targets[RenderTarget_Composition_Ldr];
+        if (upsample)
+        {
+            Pass_Upsample(cmd_list, m_render_targets[RenderTarget_Composition_Ldr], tex_out);
+        }
+
+        // Overlays, drawn at the output resolution so that text and gizmos stay sharp
+        {
+            Pass_TransformHandle(cmd_list, tex_out.get());
+            Pass_Icons(cmd_list, tex_out.get());
+            Pass_DebugBuffer(cmd_list, tex_out);
+            Pass_Text(cmd_list, tex_out.get());
         }
 	}
 
@@ -135,20 +188,34 @@ namespace Spartan
         // All opaque objects are rendered from the lights point of view.
         // Opaque objects write their depth information to a depth buffer, using just a vertex shader.
         // Transparent objects, read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
+        // Point and spot lights render into tiles of the shadow atlas, and only the tiles which the atlas marked as dirty.
 
 		// Acquire shader
-		RHI_Shader* shader_v = m_shaders[Shader_Depth_V].get();
-        RHI_Shader* shader_p = m_shaders[Shader_Depth_P].get();
-		if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+		RHI_Shader* shader_v            = m_shaders[Shader_Depth_V].get();
+        RHI_Shader* shader_v_quantized  = m_shaders[Shader_DepthQuantized_V].get();
+        RHI_Shader* shader_p            = m_shaders[Shader_Depth_P].get();
+		if (!shader_v->IsCompiled() || !shader_v_quantized->IsCompiled() || !shader_p->IsCompiled())
+        {
+            // Nothing will be rendered, so the atlas can't assume that its tiles are up to date
+            m_shadow_atlas->Invalidate();
 			return;
+        }
+
+        const bool transparent_pass = object_type == Renderer_Object_Transparent;
+
+        // Opaque casters go through indirect draws when available (for both vertex layouts)
+        RHI_Shader* shader_v_indirect           = (!transparent_pass && m_draw_indirect) ? GetCompiledShader(Shader_DepthIndirect_V) : nullptr;
+        RHI_Shader* shader_v_indirect_quantized = (!transparent_pass && m_draw_indirect) ? GetCompiledShader(Shader_DepthIndirectQuantized_V) : nullptr;
+        if (!shader_v_indirect_quantized)
+        {
+            shader_v_indirect = nullptr;
+        }
 
-        // Get entities
+        // Get entities (the opaque pass still has to clear dirty atlas tiles, even if there is nothing to render)
         const auto& entities = m_entities[object_type];
-        if (entities.empty())
+        if (entities.empty() && transparent_pass)
             return;
 
-        const bool transparent_pass = object_type == Renderer_Object_Transparent;
-
         // Go through all of the lights
 		const auto& entities_light = m_entities[Renderer_Object_Light];
         for (uint32_t light_index = 0; light_index < entities_light.size(); light_index++)
@@ -164,34 +231,39 @@ namespace Spartan
                 continue;
 
             // Acquire light's shadow maps
-            RHI_Texture* tex_depth = light->GetDepthTexture();
-            RHI_Texture* tex_color = light->GetColorTexture();
+            const bool in_atlas     = ShadowAtlas::IsLightInAtlas(light);
+            RHI_Texture* tex_depth  = in_atlas ? m_shadow_atlas->GetTextureDepth() : light->GetDepthTexture();
+            RHI_Texture* tex_color  = in_atlas ? m_shadow_atlas->GetTextureColor() : light->GetColorTexture();
             if (!tex_depth)
                 continue;
 
             // Set render state
             static RHI_PipelineState pipeline_state;
-            pipeline_state.shader_vertex                    = shader_v;
-            pipeline_state.vertex_buffer_stride             = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
             pipeline_state.shader_pixel                     = transparent_pass ? shader_p : nullptr;
+            pipeline_state.bindless                         = shader_v_indirect != nullptr;
             pipeline_state.blend_state                      = transparent_pass ? m_blend_alpha.get() : m_blend_disabled.get();
             pipeline_state.depth_stencil_state              = transparent_pass ? m_depth_stencil_on_off_r.get() : m_depth_stencil_on_off_w.get();
             pipeline_state.render_target_color_textures[0]  = tex_color; // always bind so we can clear to white (in case there are now transparent objects)
             pipeline_state.render_target_depth_texture      = tex_depth;
             pipeline_state.clear_stencil                    = state_stencil_dont_care;
-            pipeline_state.viewport                         = tex_depth->GetViewport();
+            pipeline_state.viewport                         = in_atlas ? RHI_Viewport::Undefined : tex_depth->GetViewport(); // atlas tiles set their own viewport
+            pipeline_state.dynamic_scissor                  = in_atlas;
             pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
             pipeline_state.pass_name                        = transparent_pass ? "Pass_LightDepthTransparent" : "Pass_LightDepth";
 
-            for (uint32_t array_index = 0; array_index < tex_depth->GetArraySize(); array_index++)
+            for (uint32_t array_index = 0; array_index < light->GetShadowArraySize(); array_index++)
             {
-                // Set render target texture array index
-                pipeline_state.render_target_color_texture_array_index          = array_index;
-                pipeline_state.render_target_depth_stencil_texture_array_index  = array_index;
+                // Skip atlas tiles which are still up to date
+                if (in_atlas && !m_shadow_atlas->IsTileDirty(light, array_index))
+                    continue;
 
-                // Set clear values
-                pipeline_state.clear_color[0] = Vector4::One;
-                pipeline_state.clear_depth    = transparent_pass ? state_depth_load : GetClearDepth();
+                // Set render target texture array index (the atlas is a single texture)
+                pipeline_state.render_target_color_texture_array_index          = in_atlas ? 0 : array_index;
+                pipeline_state.render_target_depth_stencil_texture_array_index  = in_atlas ? 0 : array_index;
+
+                // Set clear values (render pass clears affect the whole texture, so atlas tiles are cleared separately)
+                pipeline_state.clear_color[0] = in_atlas ? state_color_load : Vector4::One;
+                pipeline_state.clear_depth    = (transparent_pass || in_atlas) ? state_depth_load : GetClearDepth();
 
                 const Matrix& view_projection = light->GetViewMatrix(array_index) * light->GetProjectionMatrix(array_index);
 
@@ -208,99 +280,249 @@ namespace Spartan
                     pipeline_state.rasterizer_state = m_rasterizer_cull_back_solid.get();
                 }
 
-                // State tracking
-                bool render_pass_active     = false;
-                uint32_t m_set_material_id  = 0;
-
-                for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
+                // Clear the atlas tile
+                const Math::Rectangle tile = in_atlas ? m_shadow_atlas->GetSlot(light)->tiles[array_index] : Math::Rectangle::Zero;
+                if (in_atlas && !transparent_pass)
                 {
-                    Entity* entity = entities[entity_index];
+                    Pass_ShadowAtlasClear(cmd_list, tile);
+                }
 
-                    // Acquire renderable component
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+                // Indirect, the casters are grouped into a single draw per model
+                if (shader_v_indirect)
+                {
+                    m_draw_indirect->BeginPass();
+                    for (Entity* entity : entities)
+                    {
+                        Renderable* renderable = entity->GetRenderable();
+                        if (renderable && renderable->GetCastShadows() && light->IsInViewFrustrum(renderable, array_index))
+                        {
+                            const uint32_t lod = renderable->GeometryLodShadows();
+                            m_draw_indirect->AddDraw(entity->GetId(), renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod));
+                        }
+                    }
 
-                    // Skip meshes that don't cast shadows
-                    if (!renderable->GetCastShadows())
-                        continue;
+                    const auto& batches = m_draw_indirect->EndPass(m_indirect_buffer->GetRegion(m_swap_chain->GetCmdIndex()));
+                    for (const bool quantized : { false, true })
+                    {
+                        if (!has_batches(batches, quantized))
+                            continue;
 
-                    // Acquire geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                        pipeline_state.shader_vertex        = quantized ? shader_v_indirect_quantized : shader_v_indirect;
+                        pipeline_state.vertex_buffer_stride = get_vertex_stride(quantized);
+                        if (cmd_list->BeginRenderPass(pipeline_state))
+                        {
+                            // Restrict rendering to the atlas tile
+                            if (in_atlas)
+                            {
+                                cmd_list->SetViewport(RHI_Viewport(tile.left, tile.top, tile.Width(), tile.Height()));
+                                cmd_list->SetScissorRectangle(tile);
+                            }
 
-                    // Acquire material
-                    const auto& material = renderable->GetMaterial();
-                    if (!material)
-                        continue;
+                            // The instances carry the world transform, so the object buffer only has the cascade transform
+                            m_buffer_object_cpu.object = view_projection;
+                            if (UpdateObjectBuffer(cmd_list))
+                            {
+                                Pass_DrawIndirect(cmd_list, batches, quantized);
+                            }
 
-                    // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustrum(renderable, array_index))
-                        continue;
+                            cmd_list->EndRenderPass();
+                        }
 
-                    if (!render_pass_active)
-                    {
-                        render_pass_active = cmd_list->BeginRenderPass(pipeline_state);
+                        // The next render pass draws on top
+                        pipeline_state.clear_color[0]   = state_color_load;
+                        pipeline_state.clear_depth      = state_depth_load;
                     }
 
-                    // Bind material
-                    if (transparent_pass && m_set_material_id != material->GetId())
+                    continue;
+                }
+
+                // One render pass per vertex layout
+                for (const bool quantized : { false, true })
+                {
+                    pipeline_state.shader_vertex        = quantized ? shader_v_quantized : shader_v;
+                    pipeline_state.vertex_buffer_stride = get_vertex_stride(quantized);
+
+                    // State tracking
+                    bool render_pass_active     = false;
+                    uint32_t m_set_material_id  = 0;
+
+                    for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
                     {
-                        // Bind material textures
-                        RHI_Texture* tex_albedo = material->GetTexture_Ptr(Material_Color);
-                        cmd_list->SetTexture(28, tex_albedo ? tex_albedo : m_tex_white.get());
+                        Entity* entity = entities[entity_index];
 
-                        // Update uber buffer with material properties
-                        m_buffer_uber_cpu.mat_albedo    = material->GetColorAlbedo();
-                        m_buffer_uber_cpu.mat_tiling_uv = material->GetTiling();
-                        m_buffer_uber_cpu.mat_offset_uv = material->GetOffset();
+                        // Acquire renderable component
+                        const auto& renderable = entity->GetRenderable();
+                        if (!renderable)
+                            continue;
 
-                        // Update constant buffer
-                        UpdateUberBuffer(cmd_list);
+                        // Skip meshes that don't cast shadows
+                        if (!renderable->GetCastShadows())
+                            continue;
 
-                        m_set_material_id = material->GetId();
-                    }
+                        // Acquire geometry
+                        const auto& model = renderable->GeometryModel();
+                        if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexBufferQuantized() != quantized)
+                            continue;
 
-                    // Bind geometry
-                    cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                        // Acquire material
+                        const auto& material = renderable->GetMaterial();
+                        if (!material)
+                            continue;
 
-                    // Update uber buffer with cascade transform
-                    m_buffer_object_cpu.object = entity->GetTransform()->GetMatrix() * view_projection;
-                    if (!UpdateObjectBuffer(cmd_list))
-                        continue;
+                        // Skip objects outside of the view frustum
+                        if (!light->IsInViewFrustrum(renderable, array_index))
+                            continue;
 
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                        if (!render_pass_active)
+                        {
+                            render_pass_active = cmd_list->BeginRenderPass(pipeline_state);
 
-                }
+                            // Restrict rendering to the atlas tile
+                            if (render_pass_active && in_atlas)
+                            {
+                                cmd_list->SetViewport(RHI_Viewport(tile.left, tile.top, tile.Width(), tile.Height()));
+                                cmd_list->SetScissorRectangle(tile);
+                            }
+                        }
 
-                if (render_pass_active)
-                {
-                    cmd_list->EndRenderPass();
+                        // Bind material
+                        if (transparent_pass && m_set_material_id != material->GetId())
+                        {
+                            // Bind material textures
+                            RHI_Texture* tex_albedo = material->GetTexture_Ptr(Material_Color);
+                            cmd_list->SetTexture(28, tex_albedo ? tex_albedo : m_tex_white.get());
+
+                            // Update uber buffer with material properties
+                            m_buffer_uber_cpu.mat_albedo    = material->GetColorAlbedo();
+                            m_buffer_uber_cpu.mat_tiling_uv = material->GetTiling();
+                            m_buffer_uber_cpu.mat_offset_uv = material->GetOffset();
+
+                            // Update constant buffer
+                            UpdateUberBuffer(cmd_list);
+
+                            m_set_material_id = material->GetId();
+                        }
+
+                        // Bind geometry
+                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
+
+                        // Update uber buffer with cascade transform
+                        m_buffer_object_cpu.object = model->GetVertexTransform() * entity->GetTransform()->GetMatrix() * view_projection;
+                        if (!UpdateObjectBuffer(cmd_list))
+                            continue;
+
+                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(renderable->GeometryLodShadows()), renderable->GeometryIndexOffset(renderable->GeometryLodShadows()), renderable->GeometryVertexOffset());
+
+                    }
+
+                    if (render_pass_active)
+                    {
+                        cmd_list->EndRenderPass();
+
+                        // The next render pass draws on top
+                        pipeline_state.clear_color[0]   = state_color_load;
+                        pipeline_state.clear_depth      = state_depth_load;
+                    }
                 }
             }
         }
 	}
 
+    void Renderer::Pass_ShadowAtlasClear(RHI_CommandList* cmd_list, const Math::Rectangle& tile)
+    {
+        // Render pass clears affect the whole texture, which would wipe the cached tiles,
+        // so a tile is cleared by drawing a quad at the clear depth (and white, if there is a color atlas).
+
+        // Acquire shaders
+        RHI_Shader* shader_v = m_shaders[Shader_Depth_V].get();
+        RHI_Shader* shader_p = m_shaders[Shader_Depth_P].get();
+        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+            return;
+
+        RHI_Texture* tex_depth = m_shadow_atlas->GetTextureDepth();
+        RHI_Texture* tex_color = m_shadow_atlas->GetTextureColor();
+
+        // Set render state
+        static RHI_PipelineState pipeline_state;
+        pipeline_state.shader_vertex                    = shader_v;
+        pipeline_state.shader_pixel                     = tex_color ? shader_p : nullptr;
+        pipeline_state.vertex_buffer_stride             = m_viewport_quad.GetVertexBuffer()->GetStride();
+        pipeline_state.rasterizer_state                 = m_rasterizer_cull_back_solid.get();
+        pipeline_state.blend_state                      = m_blend_disabled.get();
+        pipeline_state.depth_stencil_state              = m_depth_stencil_on_off_w_always.get();
+        pipeline_state.render_target_color_textures[0]  = tex_color;
+        pipeline_state.clear_color[0]                   = state_color_load;
+        pipeline_state.render_target_depth_texture      = tex_depth;
+        pipeline_state.clear_depth                      = state_depth_load;
+        pipeline_state.clear_stencil                    = state_stencil_dont_care;
+        pipeline_state.viewport                         = RHI_Viewport::Undefined;
+        pipeline_state.dynamic_scissor                  = true;
+        pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
+        pipeline_state.pass_name                        = "Pass_ShadowAtlasClear";
+
+        if (cmd_list->BeginRenderPass(pipeline_state))
+        {
+            cmd_list->SetViewport(RHI_Viewport(tile.left, tile.top, tile.Width(), tile.Height()));
+            cmd_list->SetScissorRectangle(tile);
+
+            // White material
+            cmd_list->SetTexture(28, m_tex_white);
+            m_buffer_uber_cpu.mat_albedo    = Vector4::One;
+            m_buffer_uber_cpu.mat_tiling_uv = Vector2::One;
+            m_buffer_uber_cpu.mat_offset_uv = Vector2::Zero;
+            UpdateUberBuffer(cmd_list);
+
+            // Map the full-screen quad to clip space, at the clear depth
+            m_buffer_object_cpu.object = Matrix::CreateScale(2.0f / m_viewport.width, 2.0f / m_viewport.height, 1.0f) * Matrix::CreateTranslation(Vector3(0.0f, 0.0f, GetClearDepth()));
+            UpdateObjectBuffer(cmd_list);
+
+            cmd_list->SetBufferVertex(m_viewport_quad.GetVertexBuffer());
+            cmd_list->SetBufferIndex(m_viewport_quad.GetIndexBuffer());
+            cmd_list->DrawIndexed(Rectangle::GetIndexCount());
+            cmd_list->EndRenderPass();
+        }
+    }
+
+    void Renderer::Pass_DrawIndirect(RHI_CommandList* cmd_list, const vector<DrawIndirect::Batch>& batches, const bool quantized)
+    {
+        // Each batch shares a model, so its geometry is bound once for all of its draws
+        for (const DrawIndirect::Batch& batch : batches)
+        {
+            // The other vertex layout is drawn by another render pass
+            if (batch.model->IsVertexBufferQuantized() != quantized)
+                continue;
+
+            cmd_list->SetBufferIndex(batch.model->GetIndexBuffer());
+            cmd_list->SetBufferVertex(batch.model->GetVertexBuffer());
+            cmd_list->DrawIndexedIndirect(m_indirect_buffer.get(), batch.command_offset, batch.command_count);
+        }
+    }
+
     void Renderer::Pass_DepthPrePass(RHI_CommandList* cmd_list)
     {
         // Description: All the opaque meshes are rendered, outputting
         // just their depth information into a depth map.
 
         // Acquire required resources/data
-        const auto& shader_depth    = m_shaders[Shader_Depth_V];
-        const auto& tex_depth       = m_render_targets[RenderTarget_Gbuffer_Depth];
-        const auto& entities        = m_entities[Renderer_Object_Opaque];
+        const auto& shader_depth            = m_shaders[Shader_Depth_V];
+        const auto& shader_depth_quantized  = m_shaders[Shader_DepthQuantized_V];
+        const auto& tex_depth               = m_render_targets[RenderTarget_Gbuffer_Depth];
+        const auto& entities                = m_entities_visible[Renderer_Object_Opaque];
 
-        // Ensure the shader has compiled
-        if (!shader_depth->IsCompiled())
+        // Ensure the shaders have compiled
+        if (!shader_depth->IsCompiled() || !shader_depth_quantized->IsCompiled())
             return;
 
+        // Indirect draws are used when available (for both vertex layouts)
+        RHI_Shader* shader_depth_indirect           = m_draw_indirect ? GetCompiledShader(Shader_DepthIndirect_V) : nullptr;
+        RHI_Shader* shader_depth_indirect_quantized = m_draw_indirect ? GetCompiledShader(Shader_DepthIndirectQuantized_V) : nullptr;
+        const bool indirect                         = shader_depth_indirect && shader_depth_indirect_quantized;
+
         // Set render state
         static RHI_PipelineState pipeline_state;
-        pipeline_state.shader_vertex                = shader_depth.get();
         pipeline_state.shader_pixel                 = nullptr;
+        pipeline_state.bindless                     = indirect;
         pipeline_state.rasterizer_state             = m_rasterizer_cull_back_solid.get();
         pipeline_state.blend_state                  = m_blend_disabled.get();
         pipeline_state.depth_stencil_state          = m_depth_stencil_on_off_w.get();
@@ -310,52 +532,91 @@ namespace Spartan
         pipeline_state.primitive_topology           = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                    = "Pass_DepthPrePass";
 
-        // Record commands
-        if (cmd_list->BeginRenderPass(pipeline_state))
-        { 
-            if (!entities.empty())
+        static const vector<DrawIndirect::Batch> batches_none;
+        const vector<DrawIndirect::Batch>* batches = &batches_none;
+        if (indirect && !entities.empty())
+        {
+            m_draw_indirect->BeginPass();
+            for (Entity* entity : entities)
             {
-                // Variables that help reduce state changes
-                uint32_t currently_bound_geometry = 0;
+                m_draw_indirect->AddDraw(entity->GetId());
+            }
+            batches = &m_draw_indirect->EndPass(m_indirect_buffer->GetRegion(m_swap_chain->GetCmdIndex()));
+        }
 
-                // Draw opaque
-                for (const auto& entity : entities)
+        // One render pass per vertex layout, the first one clears the depth, even if there is nothing to draw
+        for (const bool quantized : { false, true })
+        {
+            if (quantized)
+            {
+                const bool has_quantized = indirect ? has_batches(*batches, true) : any_of(entities.begin(), entities.end(), [](Entity* entity)
                 {
-                    // Get renderable
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+                    const Renderable* renderable = entity->GetRenderable();
+                    return renderable && renderable->GeometryModel() && renderable->GeometryModel()->IsVertexBufferQuantized();
+                });
 
-                    // Get geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                if (!has_quantized)
+                    break;
+            }
 
-                    // Skip objects outside of the view frustum
-                    if (!m_camera->IsInViewFrustrum(renderable))
-                        continue;
+            pipeline_state.shader_vertex        = indirect ? (quantized ? shader_depth_indirect_quantized : shader_depth_indirect) : (quantized ? shader_depth_quantized.get() : shader_depth.get());
+            pipeline_state.vertex_buffer_stride = get_vertex_stride(quantized);
 
-                    // Bind geometry
-                    if (currently_bound_geometry != model->GetId())
+            // Record commands
+            if (cmd_list->BeginRenderPass(pipeline_state))
+            { 
+                if (indirect && !batches->empty())
+                {
+                    // The instances carry the world transform, so the object buffer only has the view projection
+                    m_buffer_object_cpu.object = m_buffer_frame_cpu.view_projection;
+                    if (UpdateObjectBuffer(cmd_list))
                     {
-                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
-                        currently_bound_geometry = model->GetId();
+                        Pass_DrawIndirect(cmd_list, *batches, quantized);
                     }
+                }
+                else if (!indirect && !entities.empty())
+                {
+                    // Variables that help reduce state changes
+                    uint32_t currently_bound_geometry = 0;
 
-                    // Update uber buffer with entity transform
-                    if (Transform* transform = entity->GetTransform())
+                    // Draw opaque
+                    for (const auto& entity : entities)
                     {
-                        // Update uber buffer with cascade transform
-                        m_buffer_uber_cpu.transform = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                        UpdateUberBuffer(cmd_list);
-                    }
+                        // Get renderable
+                        const auto& renderable = entity->GetRenderable();
+                        if (!renderable)
+                            continue;
+
+                        // Get geometry
+                        const auto& model = renderable->GeometryModel();
+                        if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexBufferQuantized() != quantized)
+                            continue;
+
+                        // Bind geometry
+                        if (currently_bound_geometry != model->GetId())
+                        {
+                            cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                            cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                            currently_bound_geometry = model->GetId();
+                        }
 
-                    // Draw	
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                        // Update uber buffer with entity transform
+                        if (Transform* transform = entity->GetTransform())
+                        {
+                            // Update uber buffer with cascade transform
+                            m_buffer_uber_cpu.transform = model->GetVertexTransform() * transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
+                            UpdateUberBuffer(cmd_list);
+                        }
+
+                        // Draw	
+                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(renderable->GeometryLod()), renderable->GeometryIndexOffset(renderable->GeometryLod()), renderable->GeometryVertexOffset());
+                    }
                 }
+                cmd_list->EndRenderPass();
             }
-            cmd_list->EndRenderPass();
+
+            // The next render pass draws on top
+            pipeline_state.clear_depth = state_depth_load;
         }
     }
 
@@ -367,20 +628,28 @@ namespace Spartan
         RHI_Texture* tex_material     = m_render_targets[RenderTarget_Gbuffer_Material].get();
         RHI_Texture* tex_velocity     = m_render_targets[RenderTarget_Gbuffer_Velocity].get();
         RHI_Texture* tex_depth        = m_render_targets[RenderTarget_Gbuffer_Depth].get();
-        RHI_Shader* shader_v          = m_shaders[Shader_Gbuffer_V].get();
-        ShaderGBuffer* shader_p       = static_cast<ShaderGBuffer*>(m_shaders[Shader_Gbuffer_P].get());
+        RHI_Shader* shader_v            = m_shaders[Shader_Gbuffer_V].get();
+        RHI_Shader* shader_v_quantized  = m_shaders[Shader_GbufferQuantized_V].get();
+        ShaderGBuffer* shader_p         = static_cast<ShaderGBuffer*>(m_shaders[Shader_Gbuffer_P].get());
+        RHI_BindlessTable* bindless     = m_rhi_device->GetBindlessTable();
 
-        // Validate that the shader has compiled
-        if (!shader_v->IsCompiled())
+        // Validate that the shaders have compiled
+        if (!shader_v->IsCompiled() || !shader_v_quantized->IsCompiled())
             return;
 
+        // When the bindless table is available, a single pixel shader covers every material
+        RHI_Shader* shader_p_bindless = bindless ? GetCompiledShader(Shader_GbufferBindless_P) : nullptr;
+
         // Clear values that depend on the objects being opaque or transparent
         const bool is_transparent = object_type == Renderer_Object_Transparent;
 
+        // Opaque objects go through indirect draws when available
+        RHI_Shader* shader_v_indirect           = (!is_transparent && m_draw_indirect) ? GetCompiledShader(Shader_GbufferIndirect_V) : nullptr;
+        RHI_Shader* shader_v_indirect_quantized = (!is_transparent && m_draw_indirect) ? GetCompiledShader(Shader_GbufferIndirectQuantized_V) : nullptr;
+        RHI_Shader* shader_p_indirect           = (!is_transparent && m_draw_indirect) ? GetCompiledShader(Shader_GbufferIndirect_P) : nullptr;
+
         // Set render state
         RHI_PipelineState pso;
-        pso.shader_vertex                   = shader_v;
-        pso.vertex_buffer_stride            = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
         pso.blend_state                     = m_blend_disabled.get();
         pso.rasterizer_state                = GetOption(Render_Debug_Wireframe) ? m_rasterizer_cull_back_wireframe.get() : m_rasterizer_cull_back_solid.get();
         pso.depth_stencil_state             = is_transparent ? m_depth_stencil_on_on_w.get() : m_depth_stencil_on_off_w.get(); // GetOptionValue(Render_DepthPrepass) is not accounted for anymore, have to fix
@@ -397,144 +666,232 @@ namespace Spartan
         pso.clear_stencil                   = 0;
         pso.viewport                        = tex_albedo->GetViewport();
         pso.primitive_topology              = RHI_PrimitiveTopology_TriangleList;
+        pso.bindless                        = shader_p_bindless != nullptr;
 
         bool cleared = false;
         uint32_t material_index = 0;
         uint32_t material_bound_id = 0;
         m_material_instances.fill(nullptr);
 
-        // Iterate through all the G-Buffer shader variations
-        for (const auto& it : ShaderGBuffer::GetVariations())
+        // The bindless material buffer has a region per frame in flight, the shaders are given the index within this frame's
+        const uint32_t material_region_offset = bindless ? bindless->GetMaterialRegionOffset(m_swap_chain->GetCmdIndex()) : 0;
+
+        // Indirect, a render pass (per vertex layout) with one draw per model
+        if (shader_v_indirect && shader_v_indirect_quantized && shader_p_indirect)
         {
-            // Skip the shader until it compiles or the users spots a compilation error
-            if (!it.second->IsCompiled())
-                continue;
+            pso.shader_pixel    = shader_p_indirect;
+            pso.bindless        = true;
+            pso.pass_name       = "Pass_GBuffer_Indirect";
+
+            m_draw_indirect->BeginPass();
+            for (Entity* entity : m_entities_visible[object_type])
+            {
+                if (!m_draw_indirect->AddDraw(entity->GetId()))
+                    continue;
+
+                // Keep reference (the instance already points to the material's slot)
+                Material* material = entity->GetRenderable()->GetMaterial();
+                m_material_instances[GetMaterialBindlessSlot(material)] = material;
+                m_profiler->m_renderer_meshes_rendered++;
+            }
 
+            // The first render pass clears, even if there is nothing to draw
+            const auto& batches = m_draw_indirect->EndPass(m_indirect_buffer->GetRegion(m_swap_chain->GetCmdIndex()));
+            for (const bool quantized : { false, true })
+            {
+                if (quantized && !has_batches(batches, quantized))
+                    break;
+
+                pso.shader_vertex           = quantized ? shader_v_indirect_quantized : shader_v_indirect;
+                pso.vertex_buffer_stride    = get_vertex_stride(quantized);
+                if (cmd_list->BeginRenderPass(pso))
+                {
+                    // The instances hold the slots, the object buffer the region
+                    m_buffer_object_cpu.material_index = material_region_offset;
+                    UpdateObjectBuffer(cmd_list);
+
+                    Pass_DrawIndirect(cmd_list, batches, quantized);
+                    cmd_list->EndRenderPass();
+                }
+
+                pso.ResetClearValues();
+            }
+
+            // Update constant buffer (light pass will access it using material IDs)
+            UpdateMaterialBuffer();
+            return;
+        }
+
+        // Precompiling can leave plenty of variations around, only go through the ones the visible materials use
+        vector<RHI_Shader*> shaders_pixel;
+        if (pso.bindless)
+        {
+            shaders_pixel.emplace_back(shader_p_bindless);
+        }
+        else
+        {
+            m_gbuffer_variations_used.reset();
+            for (Entity* entity : m_entities_visible[object_type])
+            {
+                if (const Renderable* renderable = entity->GetRenderable())
+                {
+                    if (const Material* material = renderable->GetMaterial())
+                    {
+                        m_gbuffer_variations_used.set(ShaderGBuffer::GetVariationFlags(material->GetFlags()));
+                    }
+                }
+            }
+
+            for (const auto& it : ShaderGBuffer::GetVariations())
+            {
+                // Skip the shader until it compiles or the users spots a compilation error
+                if (m_gbuffer_variations_used.test(it.first) && it.second->IsCompiled())
+                {
+                    shaders_pixel.emplace_back(static_cast<RHI_Shader*>(it.second.get()));
+                }
+            }
+        }
+
+        // Iterate through all the G-Buffer shader variations
+        for (RHI_Shader* shader_pixel : shaders_pixel)
+        {
             // Set pixel shader
-            pso.shader_pixel = static_cast<RHI_Shader*>(it.second.get());
+            pso.shader_pixel = shader_pixel;
 
             // Set pass name
             pso.pass_name = pso.shader_pixel->GetName().c_str();
 
-            bool render_pass_active = false;
-            auto& entities = m_entities[object_type];
-
-            // Record commands
-            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+            // One render pass per vertex layout
+            for (const bool quantized : { false, true })
             {
-                Entity* entity = entities[i];
+                pso.shader_vertex           = quantized ? shader_v_quantized : shader_v;
+                pso.vertex_buffer_stride    = get_vertex_stride(quantized);
 
-                // Get renderable
-                const auto& renderable = entity->GetRenderable();
-                if (!renderable)
-                    continue;
+                bool render_pass_active = false;
+                auto& entities = m_entities_visible[object_type]; // frustum and occlusion culled
 
-                // Get material
-                Material* material = renderable->GetMaterial();
-                if (!material)
-                    continue;
+                // Record commands
+                for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+                {
+                    Entity* entity = entities[i];
 
-                // Skip objects with different shader requirements
-                if (!static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->GetFlags()))
-                    continue;
+                    // Get renderable
+                    const auto& renderable = entity->GetRenderable();
+                    if (!renderable)
+                        continue;
 
-                // Skip transparent objects that won't contribute
-                if (material->GetColorAlbedo().w == 0 && is_transparent)
-                    continue;
+                    // Get material
+                    Material* material = renderable->GetMaterial();
+                    if (!material)
+                        continue;
 
-                // Get geometry
-                const auto& model = renderable->GeometryModel();
-                if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                    continue;
+                    // Skip objects with different shader requirements
+                    if (!pso.bindless && !static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->GetFlags()))
+                        continue;
 
-                // Skip objects outside of the view frustum
-                if (!m_camera->IsInViewFrustrum(renderable))
-                    continue;
+                    // Skip transparent objects that won't contribute
+                    if (material->GetColorAlbedo().w == 0 && is_transparent)
+                        continue;
 
-                if (!render_pass_active)
-                {
-                    render_pass_active = cmd_list->BeginRenderPass(pso);
-                }
+                    // Get geometry
+                    const auto& model = renderable->GeometryModel();
+                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexBufferQuantized() != quantized)
+                        continue;
 
-                // Set geometry (will only happen if not already set)
-                cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                    if (!render_pass_active)
+                    {
+                        render_pass_active = cmd_list->BeginRenderPass(pso);
+                    }
 
-                // Bind material
-                bool firs_run       = material_index == 0;
-                bool new_material   = material_bound_id != material->GetId();
-                if (firs_run || new_material)
-                {
-                    material_bound_id = material->GetId();
+                    // Set geometry (will only happen if not already set)
+                    cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(model->GetVertexBuffer());
 
-                    // Keep track of used material instances (they get mapped to shaders)
-                    if (material_index + 1 < m_material_instances.size())
+                    // Bind material
+                    bool firs_run       = material_index == 0;
+                    bool new_material   = material_bound_id != material->GetId();
+                    if ((firs_run || new_material) && pso.bindless)
                     {
-                        // Advance index (0 is reserved for the sky)
-                        material_index++;
+                        material_bound_id = material->GetId();
+                        material_index    = UpdateMaterialBindless(material);
 
                         // Keep reference
                         m_material_instances[material_index] = material;
                     }
-                    else
+                    else if (firs_run || new_material)
                     {
-                        LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
-                    }
+                        material_bound_id = material->GetId();
+
+                        // Keep track of used material instances (they get mapped to shaders)
+                        if (material_index + 1 < m_material_instances.size())
+                        {
+                            // Advance index (0 is reserved for the sky)
+                            material_index++;
+
+                            // Keep reference
+                            m_material_instances[material_index] = material;
+                        }
+                        else
+                        {
+                            LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
+                        }
 
-                    // Bind material textures		
-                    cmd_list->SetTexture(0, material->GetTexture_Ptr(Material_Color));
-                    cmd_list->SetTexture(1, material->GetTexture_Ptr(Material_Roughness));
-                    cmd_list->SetTexture(2, material->GetTexture_Ptr(Material_Metallic));
-                    cmd_list->SetTexture(3, material->GetTexture_Ptr(Material_Normal));
-                    cmd_list->SetTexture(4, material->GetTexture_Ptr(Material_Height));
-                    cmd_list->SetTexture(5, material->GetTexture_Ptr(Material_Occlusion));
-                    cmd_list->SetTexture(6, material->GetTexture_Ptr(Material_Emission));
-                    cmd_list->SetTexture(7, material->GetTexture_Ptr(Material_Mask));
+                        // Bind material textures		
+                        cmd_list->SetTexture(0, material->GetTexture_Ptr(Material_Color));
+                        cmd_list->SetTexture(1, material->GetTexture_Ptr(Material_Roughness));
+                        cmd_list->SetTexture(2, material->GetTexture_Ptr(Material_Metallic));
+                        cmd_list->SetTexture(3, material->GetTexture_Ptr(Material_Normal));
+                        cmd_list->SetTexture(4, material->GetTexture_Ptr(Material_Height));
+                        cmd_list->SetTexture(5, material->GetTexture_Ptr(Material_Occlusion));
+                        cmd_list->SetTexture(6, material->GetTexture_Ptr(Material_Emission));
+                        cmd_list->SetTexture(7, material->GetTexture_Ptr(Material_Mask));
                 
-                    // Update uber buffer with material properties
-                    m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
-                    m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
-                    m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
-                    m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
-                    m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
-                    m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
-                    m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
-                    m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
-
-                    // Update constant buffer
-                    UpdateUberBuffer(cmd_list);
-                }
+                        // Update uber buffer with material properties
+                        m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
+                        m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
+                        m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
+                        m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
+                        m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
+                        m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
+                        m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
+                        m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
+
+                        // Update constant buffer
+                        UpdateUberBuffer(cmd_list);
+                    }
                 
-                // Update uber buffer with entity transform
-                if (Transform* transform = entity->GetTransform())
-                {
-                    m_buffer_object_cpu.object          = transform->GetMatrix();
-                    m_buffer_object_cpu.wvp_current     = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                    m_buffer_object_cpu.wvp_previous    = transform->GetWvpLastFrame();
+                    // Update uber buffer with entity transform
+                    if (Transform* transform = entity->GetTransform())
+                    {
+                        m_buffer_object_cpu.object          = model->GetVertexTransform() * transform->GetMatrix();
+                        m_buffer_object_cpu.wvp_current     = m_buffer_object_cpu.object * m_buffer_frame_cpu.view_projection;
+                        m_buffer_object_cpu.wvp_previous    = transform->GetWvpLastFrame();
+                        m_buffer_object_cpu.material_index  = pso.bindless ? material_region_offset + material_index : material_index;
 
-                    // Save matrix for velocity computation
-                    transform->SetWvpLastFrame(m_buffer_object_cpu.wvp_current);
+                        // Save matrix for velocity computation
+                        transform->SetWvpLastFrame(m_buffer_object_cpu.wvp_current);
 
-                    // Update object buffer
-                    if (!UpdateObjectBuffer(cmd_list))
-                        continue;
-                }
+                        // Update object buffer
+                        if (!UpdateObjectBuffer(cmd_list))
+                            continue;
+                    }
                 
-                // Render	
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
-                m_profiler->m_renderer_meshes_rendered++;
+                    // Render	
+                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(renderable->GeometryLod()), renderable->GeometryIndexOffset(renderable->GeometryLod()), renderable->GeometryVertexOffset());
+                    m_profiler->m_renderer_meshes_rendered++;
 
-                // Clear only on first pass
-                if (!cleared)
-                {
-                    pso.ResetClearValues();
-                    cleared = true;
+                    // Clear only on first pass
+                    if (!cleared)
+                    {
+                        pso.ResetClearValues();
+                        cleared = true;
+                    }
                 }
-            }
 
-            if (render_pass_active)
-            {
-                cmd_list->EndRenderPass();
+                if (render_pass_active)
+                {
+                    cmd_list->EndRenderPass();
+                }
             }
         }
 
@@ -737,11 +1094,59 @@ namespace Spartan
 
         bool cleared = false;
 
+        const auto set_textures = [this, cmd_list, tex_depth]()
+        {
+            cmd_list->SetBufferVertex(m_viewport_quad.GetVertexBuffer());
+            cmd_list->SetBufferIndex(m_viewport_quad.GetIndexBuffer());
+            cmd_list->SetTexture(8, m_render_targets[RenderTarget_Gbuffer_Albedo]);
+            cmd_list->SetTexture(9, m_render_targets[RenderTarget_Gbuffer_Normal]);
+            cmd_list->SetTexture(10, m_render_targets[RenderTarget_Gbuffer_Material]);
+            cmd_list->SetTexture(12, tex_depth);
+            cmd_list->SetTexture(22, (m_options & Render_Hbao) ? m_render_targets[RenderTarget_Hbao] : m_tex_black_opaque);
+            cmd_list->SetTexture(26, (m_options & Render_ScreenSpaceReflections) ? m_render_targets[RenderTarget_Ssr] : m_tex_black_transparent);
+            cmd_list->SetTexture(27, m_render_targets[RenderTarget_Composition_Hdr_2]); // previous frame before post-processing
+            cmd_list->SetTexture(31, m_tex_blue_noise);
+        };
+
+        // Clustered lights, all of them in a single pass
+        bool clustered_drawn = false;
+        if (m_light_clusters_valid)
+        {
+            pipeline_state.shader_pixel = static_cast<RHI_Shader*>(ShaderLight::GetVariationClustered(m_context, m_options));
+
+            // Skip the shader until it compiles or the users spots a compilation error
+            if (pipeline_state.shader_pixel->IsCompiled())
+            {
+                if (cmd_list->BeginRenderPass(pipeline_state))
+                {
+                    set_textures();
+
+                    // Draw
+                    cmd_list->DrawIndexed(Rectangle::GetIndexCount());
+                    cmd_list->EndRenderPass();
+                    clustered_drawn = true;
+
+                    // Clear only on first pass
+                    if (!use_stencil)
+                    {
+                        pipeline_state.ResetClearValues();
+                        cleared = true;
+                    }
+                }
+            }
+        }
+
         // Iterate through all the light entities
+        uint32_t clustered_count = 0;
         for (const auto& entity : entities)
         {
             if (Light* light = entity->GetComponent<Light>())
             {
+                // Skip lights which were shaded by the clustered pass (the same ones UpdateLightClustersBuffer() picked),
+                // if it didn't draw (e.g. its shader is still compiling) they fall back to their own pass
+                if (clustered_drawn && IsLightClusterable(light) && clustered_count++ < cluster_max_lights)
+                    continue;
+
                 if (light->GetIntensity() != 0)
                 {
                     // Set pixel shader
@@ -753,16 +1158,7 @@ namespace Spartan
 
                     if (cmd_list->BeginRenderPass(pipeline_state))
                     {
-                        cmd_list->SetBufferVertex(m_viewport_quad.GetVertexBuffer());
-                        cmd_list->SetBufferIndex(m_viewport_quad.GetIndexBuffer());
-                        cmd_list->SetTexture(8, m_render_targets[RenderTarget_Gbuffer_Albedo]);
-                        cmd_list->SetTexture(9, m_render_targets[RenderTarget_Gbuffer_Normal]);
-                        cmd_list->SetTexture(10, m_render_targets[RenderTarget_Gbuffer_Material]);
-                        cmd_list->SetTexture(12, tex_depth);
-                        cmd_list->SetTexture(22, (m_options & Render_Hbao) ? m_render_targets[RenderTarget_Hbao] : m_tex_black_opaque);
-                        cmd_list->SetTexture(26, (m_options & Render_ScreenSpaceReflections) ? m_render_targets[RenderTarget_Ssr] : m_tex_black_transparent);
-                        cmd_list->SetTexture(27, m_render_targets[RenderTarget_Composition_Hdr_2]); // previous frame before post-processing
-                        cmd_list->SetTexture(31, m_tex_blue_noise);
+                        set_textures();
 
                         // Update light buffer
                         UpdateLightBuffer(light);
@@ -770,23 +1166,21 @@ namespace Spartan
                         // Set shadow map
                         if (light->GetShadowsEnabled())
                         {
-                            RHI_Texture* tex_depth = light->GetDepthTexture();
-                            RHI_Texture* tex_color = light->GetShadowsTransparentEnabled() ? light->GetColorTexture() : m_tex_white.get();
-
                             if (light->GetLightType() == LightType_Directional)
                             {
+                                RHI_Texture* tex_depth = light->GetDepthTexture();
+                                RHI_Texture* tex_color = light->GetShadowsTransparentEnabled() ? light->GetColorTexture() : m_tex_white.get();
+
                                 cmd_list->SetTexture(13, tex_depth);
                                 cmd_list->SetTexture(14, tex_color);
                             }
-                            else if (light->GetLightType() == LightType_Point)
+                            else // point and spot lights share the atlas
                             {
+                                RHI_Texture* tex_depth = m_shadow_atlas->GetTextureDepth();
+                                RHI_Texture* tex_color = light->GetShadowsTransparentEnabled() ? m_shadow_atlas->GetTextureColor() : m_tex_white.get();
+
                                 cmd_list->SetTexture(15, tex_depth);
-                                cmd_list->SetTexture(16, tex_color);
-                            }
-                            else if (light->GetLightType() == LightType_Spot)
-                            {
-                                cmd_list->SetTexture(17, tex_depth);
-                                cmd_list->SetTexture(18, tex_color);
+                                cmd_list->SetTexture(16, tex_color ? tex_color : m_tex_white.get());
                             }
                         }
 
@@ -1800,7 +2194,7 @@ namespace Spartan
                 if (cmd_list->BeginRenderPass(pipeline_state))
                 {
                     // Update uber buffer
-                    m_buffer_uber_cpu.resolution    = m_resolution;
+                    m_buffer_uber_cpu.resolution    = m_resolution_render;
                     m_buffer_uber_cpu.transform     = m_gizmo_grid->ComputeWorldMatrix(m_camera->GetTransform()) * m_buffer_frame_cpu.view_projection_unjittered;
                     UpdateUberBuffer(cmd_list);
 
@@ -2086,7 +2480,7 @@ namespace Spartan
                 return;
 
             // Acquire shaders
-            const auto& shader_v = m_shaders[Shader_Entity_V];
+            const auto& shader_v = m_shaders[model->IsVertexBufferQuantized() ? Shader_EntityQuantized_V : Shader_Entity_V];
             const auto& shader_p = m_shaders[Shader_Entity_Outline_P];
             if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
                 return;
@@ -2115,7 +2509,7 @@ namespace Spartan
                  // Update uber buffer with entity transform
                 if (Transform* transform = entity->GetTransform())
                 {
-                    m_buffer_uber_cpu.transform     = transform->GetMatrix();
+                    m_buffer_uber_cpu.transform     = model->GetVertexTransform() * transform->GetMatrix();
                     m_buffer_uber_cpu.resolution    = Vector2(tex_out->GetWidth(), tex_out->GetHeight());
                     UpdateUberBuffer(cmd_list);
                 }
@@ -2124,7 +2518,7 @@ namespace Spartan
                 cmd_list->SetTexture(9, tex_normal);
                 cmd_list->SetBufferVertex(model->GetVertexBuffer());
                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                cmd_list->DrawIndexed(renderable->GeometryIndexCount(renderable->GeometryLod()), renderable->GeometryIndexOffset(renderable->GeometryLod()), renderable->GeometryVertexOffset());
                 cmd_list->EndRenderPass();
             }
         }
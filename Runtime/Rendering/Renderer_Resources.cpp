@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ShaderLight.h"
 #include "Font/Font.h"
 #include "../Resource/ResourceCache.h"
+#include "../RHI/RHI_Device.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_Shader.h"
 #include "../RHI/RHI_Sampler.h"
@@ -34,6 +35,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_DepthStencilState.h"
 #include "../RHI/RHI_SwapChain.h"
 #include "../RHI/RHI_CommandList.h"
+#include "../RHI/RHI_PipelineCache.h"
+#include "../RHI/RHI_BindlessTable.h"
+#include "../RHI/RHI_IndirectBuffer.h"
 //=======================================
 
 //= NAMESPACES ===============
@@ -61,6 +65,28 @@ namespace Spartan
 
         m_buffer_light_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light");
         m_buffer_light_gpu->Create<BufferLight>();
+
+        m_buffer_light_clusters_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light_clusters");
+        m_buffer_light_clusters_gpu->Create<BufferLightClusters>();
+
+        // Bindless materials live in a structured buffer owned by the bindless table
+        if (RHI_BindlessTable* bindless_table = m_rhi_device->GetBindlessTable())
+        {
+            // Every frame in flight has its own region, for materials as well as for indirect draws
+            const uint32_t region_count = m_swap_chain->GetBufferCount();
+            bindless_table->SetMaterialLayout(static_cast<uint32_t>(sizeof(BufferMaterialBindless)), m_max_material_instances, region_count);
+
+            // Indirect draws, instances live next to the materials
+            m_indirect_buffer = make_shared<RHI_IndirectBuffer>(m_rhi_device.get(), m_draw_indirect_command_capacity, region_count);
+            if (m_indirect_buffer->IsInitialized() && bindless_table->SetInstanceLayout(static_cast<uint32_t>(sizeof(DrawInstance)), m_draw_indirect_instance_capacity, region_count))
+            {
+                m_draw_indirect = make_unique<DrawIndirect>(m_draw_indirect_instance_capacity, m_draw_indirect_command_capacity, region_count);
+            }
+            else
+            {
+                m_indirect_buffer = nullptr;
+            }
+        }
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -71,6 +97,7 @@ namespace Spartan
         m_depth_stencil_on_off_r    = make_shared<RHI_DepthStencilState>(m_rhi_device, true,    false,  GetComparisonFunction(), false, false);                         // depth
         m_depth_stencil_off_on_r    = make_shared<RHI_DepthStencilState>(m_rhi_device, false,   false,  GetComparisonFunction(), true,  false,  RHI_Comparison_Equal);  // depth + stencil
         m_depth_stencil_on_on_w     = make_shared<RHI_DepthStencilState>(m_rhi_device, true,    true,   GetComparisonFunction(), true,  true,   RHI_Comparison_Always); // depth + stencil
+        m_depth_stencil_on_off_w_always = make_shared<RHI_DepthStencilState>(m_rhi_device, true, true, RHI_Comparison_Always, false, false); // depth, always passes (used to clear regions)
     }
 
     void Renderer::CreateRasterizerStates()
@@ -115,6 +142,25 @@ namespace Spartan
 
         Flush();
 
+        // Render textures of the other resolution scale levels were sized for the previous resolution
+        for (RenderTextureSet& set : m_render_texture_sets)
+        {
+            set.render_targets.clear();
+            set.render_tex_bloom.clear();
+        }
+        m_taa_history_previous      = nullptr;
+        m_resolution_scale_level    = DynamicResolution::level_full;
+        m_resolution_render         = m_resolution;
+
+        // BRDF Specular Lut
+        m_render_targets[RenderTarget_Brdf_Specular_Lut] = make_unique<RHI_Texture2D>(m_context, 400, 400, RHI_Format_R8G8_Unorm, 1, 0, "rt_brdf_specular_lut");
+        m_brdf_specular_lut_rendered = false;
+
+        CreateRenderTexturesScaled(width, height);
+    }
+
+    void Renderer::CreateRenderTexturesScaled(const uint32_t width, const uint32_t height)
+    {
         // G-Buffer
         // Stencil is used to mask transparent objects and also has a read only version
         // From and below Texture_Format_R8G8B8A8_UNORM, normals have noticeable banding
@@ -129,10 +175,6 @@ namespace Spartan
         m_render_targets[RenderTarget_Light_Specular]   = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_specular");
         m_render_targets[RenderTarget_Light_Volumetric] = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, 0, "rt_light_volumetric");
 
-        // BRDF Specular Lut
-        m_render_targets[RenderTarget_Brdf_Specular_Lut] = make_unique<RHI_Texture2D>(m_context, 400, 400, RHI_Format_R8G8_Unorm, 1, 0, "rt_brdf_specular_lut");
-        m_brdf_specular_lut_rendered = false;
-
         // Composition
         {
             m_render_targets[RenderTarget_Composition_Hdr]      = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Float, 1, 0, "rt_composition_hdr"); // Investigate using less bits but have an alpha channel
@@ -184,6 +226,35 @@ namespace Spartan
         m_shaders[Shader_Gbuffer_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[Shader_Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
 
+        // G-Buffer - Quantized, for the vertex buffers of static models
+        m_shaders[Shader_GbufferQuantized_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[Shader_GbufferQuantized_V]->AddDefine("QUANTIZED");
+        m_shaders[Shader_GbufferQuantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan16>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+
+        // G-Buffer - Bindless, a single variation which reads its textures and material from the bindless table
+        if (m_rhi_device->GetBindlessTable())
+        {
+            m_shaders[Shader_GbufferBindless_P] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Shader_GbufferBindless_P]->AddDefine("BINDLESS");
+            m_shaders[Shader_GbufferBindless_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "GBuffer.hlsl");
+        }
+
+        // G-Buffer - Indirect, transforms and material indices come from the instance buffer
+        if (m_draw_indirect)
+        {
+            m_shaders[Shader_GbufferIndirect_V] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Shader_GbufferIndirect_V]->AddDefine("INDIRECT");
+            m_shaders[Shader_GbufferIndirect_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+            m_shaders[Shader_GbufferIndirectQuantized_V] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Shader_GbufferIndirectQuantized_V]->AddDefine("INDIRECT");
+            m_shaders[Shader_GbufferIndirectQuantized_V]->AddDefine("QUANTIZED");
+            m_shaders[Shader_GbufferIndirectQuantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan16>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+            m_shaders[Shader_GbufferIndirect_P] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Shader_GbufferIndirect_P]->AddDefine("BINDLESS");
+            m_shaders[Shader_GbufferIndirect_P]->AddDefine("INDIRECT");
+            m_shaders[Shader_GbufferIndirect_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "GBuffer.hlsl");
+        }
+
         // Quad - Used by almost everything
         m_shaders[Shader_Quad_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[Shader_Quad_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Quad.hlsl");
@@ -191,8 +262,21 @@ namespace Spartan
         // Depth Vertex
         m_shaders[Shader_Depth_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[Shader_Depth_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[Shader_DepthQuantized_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[Shader_DepthQuantized_V]->AddDefine("QUANTIZED");
+        m_shaders[Shader_DepthQuantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan16>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
         m_shaders[Shader_Depth_P] = make_shared<RHI_Shader>(m_context);
         m_shaders[Shader_Depth_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "Depth.hlsl");
+        if (m_draw_indirect)
+        {
+            m_shaders[Shader_DepthIndirect_V] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Shader_DepthIndirect_V]->AddDefine("INDIRECT");
+            m_shaders[Shader_DepthIndirect_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+            m_shaders[Shader_DepthIndirectQuantized_V] = make_shared<RHI_Shader>(m_context);
+            m_shaders[Shader_DepthIndirectQuantized_V]->AddDefine("INDIRECT");
+            m_shaders[Shader_DepthIndirectQuantized_V]->AddDefine("QUANTIZED");
+            m_shaders[Shader_DepthIndirectQuantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan16>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        }
 
         // BRDF - Specular Lut
         m_shaders[Shader_BrdfSpecularLut] = make_shared<RHI_Shader>(m_context);
@@ -334,6 +418,9 @@ namespace Spartan
         // Entity
         m_shaders[Shader_Entity_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[Shader_Entity_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
+        m_shaders[Shader_EntityQuantized_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[Shader_EntityQuantized_V]->AddDefine("QUANTIZED");
+        m_shaders[Shader_EntityQuantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan16>(RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
 
         // Entity - Transform
         m_shaders[Shader_Entity_Transform_P] = make_shared<RHI_Shader>(m_context);
@@ -408,4 +495,58 @@ namespace Spartan
         m_gizmo_tex_light_spot = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
         m_gizmo_tex_light_spot->LoadFromFile(dir_texture + "flashlight.png");
     }
+
+    void Renderer::PrewarmPipelines()
+    {
+        // Shaders which are still compiling would be skipped, so wait for them
+        for (const auto& it : m_shaders)
+        {
+            const Shader_Compilation_State state = it.second->GetCompilationState();
+            if (state == Shader_Compilation_Unknown || state == Shader_Compilation_Compiling)
+                return;
+        }
+
+        if (m_shader_precompiler->IsCompiling())
+            return;
+
+        RHI_PipelineStateObjects objects;
+
+        for (const auto& it : m_shaders)                        { objects.shaders.emplace_back(it.second.get()); }
+        for (const auto& it : ShaderGBuffer::GetVariations())   { objects.shaders.emplace_back(it.second.get()); }
+        for (const auto& it : ShaderLight::GetVariations())     { objects.shaders.emplace_back(it.second.get()); }
+        for (const auto& it : m_render_targets)                 { objects.textures.emplace_back(it.second); } // shared, they can be re-created while prewarming
+
+        objects.rasterizer_states =
+        {
+            m_rasterizer_cull_back_solid.get(),
+            m_rasterizer_cull_back_solid_no_clip.get(),
+            m_rasterizer_cull_front_solid.get(),
+            m_rasterizer_cull_none_solid.get(),
+            m_rasterizer_cull_back_wireframe.get(),
+            m_rasterizer_cull_front_wireframe.get(),
+            m_rasterizer_cull_none_wireframe.get()
+        };
+
+        objects.blend_states =
+        {
+            m_blend_disabled.get(),
+            m_blend_alpha.get(),
+            m_blend_additive.get()
+        };
+
+        objects.depth_stencil_states =
+        {
+            m_depth_stencil_off_off.get(),
+            m_depth_stencil_off_on_r.get(),
+            m_depth_stencil_on_off_w.get(),
+            m_depth_stencil_on_off_r.get(),
+            m_depth_stencil_on_on_w.get(),
+            m_depth_stencil_on_off_w_always.get()
+        };
+
+        objects.swapchain = m_swap_chain.get();
+
+        m_pipeline_cache->Prewarm(objects, m_descriptor_cache.get());
+        m_pipelines_prewarmed = true;
+    }
 }
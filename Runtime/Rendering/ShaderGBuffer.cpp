@@ -33,6 +33,16 @@ namespace Spartan
 {
 	unordered_map<uint16_t, shared_ptr<ShaderGBuffer>> ShaderGBuffer::m_variations;
 
+    static const uint16_t variation_mask =
+        Material_Color      |
+        Material_Roughness  |
+        Material_Metallic   |
+        Material_Normal     |
+        Material_Height     |
+        Material_Occlusion  |
+        Material_Emission   |
+        Material_Mask;
+
 	ShaderGBuffer::ShaderGBuffer(Context* context, const uint16_t flags /*= 0*/) : RHI_Shader(context)
 	{
         m_flags = flags;
@@ -40,12 +50,54 @@ namespace Spartan
 
     const ShaderGBuffer* ShaderGBuffer::GenerateVariation(Context* context, const uint16_t flags)
     {
+        // Material flags which don't affect the shader are irrelevant
+        const uint16_t variation_flags = GetVariationFlags(flags);
+
         // Return existing shader, if it's already compiled
-        if (m_variations.find(flags) != m_variations.end())
-            return m_variations.at(flags).get();
+        if (m_variations.find(variation_flags) != m_variations.end())
+            return m_variations.at(variation_flags).get();
 
         // Compile new shader
-        return Compile(context, flags);
+        return Compile(context, variation_flags);
+    }
+
+    uint16_t ShaderGBuffer::GetVariationFlags(const uint16_t material_flags)
+    {
+        return material_flags & variation_mask;
+    }
+
+    vector<uint16_t> ShaderGBuffer::GetVariationFlagsAll()
+    {
+        // Every subset of the mask
+        vector<uint16_t> flags_all;
+        uint16_t flags = variation_mask;
+        while (true)
+        {
+            flags_all.emplace_back(flags);
+
+            if (flags == 0)
+                break;
+
+            flags = (flags - 1) & variation_mask;
+        }
+
+        return flags_all;
+    }
+
+    uint32_t ShaderGBuffer::Precompile(Context* context, const vector<uint16_t>& flags)
+    {
+        uint32_t count = 0;
+        for (const uint16_t variation_flags : flags)
+        {
+            const uint16_t flags_masked = GetVariationFlags(variation_flags);
+            if (m_variations.find(flags_masked) == m_variations.end())
+            {
+                Compile(context, flags_masked);
+                count++;
+            }
+        }
+
+        return count;
     }
 
     ShaderGBuffer* ShaderGBuffer::Compile(Context* context, const uint16_t flags)
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <memory>
+#include <vector>
 #include <unordered_map>
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Shader.h"
@@ -36,11 +37,18 @@ namespace Spartan
 		ShaderGBuffer(Context* context, const uint16_t flags = 0);
 		~ShaderGBuffer() = default;
         
-        bool IsSuitable(const uint16_t flags)  { return m_flags == flags; }
+        bool IsSuitable(const uint16_t flags)  { return m_flags == GetVariationFlags(flags); }
 
         static const ShaderGBuffer* GenerateVariation(Context* context, const uint16_t flags);
         static const auto& GetVariations() { return m_variations; }
 
+        // Keeps only the material flags which affect the shader, so materials which differ elsewhere share a variation
+        static uint16_t GetVariationFlags(const uint16_t material_flags);
+        // Every variation a material can end up with
+        static std::vector<uint16_t> GetVariationFlagsAll();
+        // Compiles (asynchronously) the variations which don't exist yet, returns how many were queued
+        static uint32_t Precompile(Context* context, const std::vector<uint16_t>& flags);
+
 	private:
         static ShaderGBuffer* Compile(Context* context, const uint16_t flags);
 
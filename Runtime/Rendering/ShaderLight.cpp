@@ -41,7 +41,30 @@ namespace Spartan
 
     ShaderLight* ShaderLight::GetVariation(Context* context, const Light* light, const uint64_t renderer_flags)
     {
-        // Compute flags
+        const uint16_t flags = GetVariationFlags(light, renderer_flags);
+
+        // Return existing shader, if it's already compiled
+        if (m_variations.find(flags) != m_variations.end())
+            return m_variations.at(flags).get();
+
+        // Compile new shader
+        return Compile(context, flags);
+    }
+
+    ShaderLight* ShaderLight::GetVariationClustered(Context* context, const uint64_t renderer_flags)
+    {
+        const uint16_t flags = GetVariationFlagsClustered(renderer_flags);
+
+        // Return existing shader, if it's already compiled
+        if (m_variations.find(flags) != m_variations.end())
+            return m_variations.at(flags).get();
+
+        // Compile new shader
+        return Compile(context, flags);
+    }
+
+    uint16_t ShaderLight::GetVariationFlags(const Light* light, const uint64_t renderer_flags)
+    {
         uint16_t flags = 0;
         flags |= light->GetLightType() == LightType_Directional                                             ? Shader_Light_Directional              : flags;
         flags |= light->GetLightType() == LightType_Point                                                   ? Shader_Light_Point                    : flags;
@@ -52,12 +75,64 @@ namespace Spartan
         flags |= (light->GetVolumetricEnabled() && (renderer_flags & Render_VolumetricLighting))            ? Shader_Light_Volumetric               : flags;
         flags |= (renderer_flags & Render_ScreenSpaceReflections)                                           ? Shader_Light_ScreenSpaceReflections   : flags;
 
-        // Return existing shader, if it's already compiled
-        if (m_variations.find(flags) != m_variations.end())
-            return m_variations.at(flags).get();
+        return flags;
+    }
 
-        // Compile new shader
-        return Compile(context, flags);
+    uint16_t ShaderLight::GetVariationFlagsClustered(const uint64_t renderer_flags)
+    {
+        uint16_t flags = Shader_Light_Clustered;
+        flags |= (renderer_flags & Render_ScreenSpaceReflections) ? Shader_Light_ScreenSpaceReflections : flags;
+
+        return flags;
+    }
+
+    vector<uint16_t> ShaderLight::GetVariationFlagsAll()
+    {
+        const uint16_t types[] = { Shader_Light_Directional, Shader_Light_Point, Shader_Light_Spot };
+        const uint16_t optional_mask =
+            Shader_Light_Shadows                |
+            Shader_Light_ShadowsScreenSpace     |
+            Shader_Light_ShadowsTransparent     |
+            Shader_Light_Volumetric             |
+            Shader_Light_ScreenSpaceReflections;
+
+        vector<uint16_t> flags_all;
+
+        // Every light type, with every subset of the optional features
+        for (const uint16_t type : types)
+        {
+            uint16_t optional = optional_mask;
+            while (true)
+            {
+                flags_all.emplace_back(type | optional);
+
+                if (optional == 0)
+                    break;
+
+                optional = (optional - 1) & optional_mask;
+            }
+        }
+
+        // Clustered, with and without screen space reflections
+        flags_all.emplace_back(GetVariationFlagsClustered(0));
+        flags_all.emplace_back(GetVariationFlagsClustered(Render_ScreenSpaceReflections));
+
+        return flags_all;
+    }
+
+    uint32_t ShaderLight::Precompile(Context* context, const vector<uint16_t>& flags)
+    {
+        uint32_t count = 0;
+        for (const uint16_t variation_flags : flags)
+        {
+            if (m_variations.find(variation_flags) == m_variations.end())
+            {
+                Compile(context, variation_flags);
+                count++;
+            }
+        }
+
+        return count;
     }
 
     ShaderLight* ShaderLight::Compile(Context* context, const uint16_t flags)
@@ -77,6 +152,7 @@ namespace Spartan
         shader->AddDefine("SHADOWS_TRANSPARENT",        (flags & Shader_Light_ShadowsTransparent)       ? "1" : "0");
         shader->AddDefine("VOLUMETRIC",                 (flags & Shader_Light_Volumetric)               ? "1" : "0");
         shader->AddDefine("SCREEN_SPACE_REFLECTIONS",   (flags & Shader_Light_ScreenSpaceReflections)   ? "1" : "0");
+        shader->AddDefine("CLUSTERED",                  (flags & Shader_Light_Clustered)                ? "1" : "0");
 
         // Compile
         shader->CompileAsync(RHI_Shader_Pixel, file_path);
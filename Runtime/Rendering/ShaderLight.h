@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <memory>
+#include <vector>
 #include <unordered_map>
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Shader.h"
@@ -42,7 +43,8 @@ namespace Spartan
         Shader_Light_ShadowsScreenSpace     = 1 << 4,
         Shader_Light_ShadowsTransparent     = 1 << 5,
         Shader_Light_Volumetric             = 1 << 6,
-        Shader_Light_ScreenSpaceReflections = 1 << 7
+        Shader_Light_ScreenSpaceReflections = 1 << 7,
+        Shader_Light_Clustered              = 1 << 8
     };
 
     class SPARTAN_CLASS ShaderLight : public RHI_Shader
@@ -52,8 +54,17 @@ namespace Spartan
         ~ShaderLight() = default;
 
         static ShaderLight* GetVariation(Context* context, const Light* light, const uint64_t renderer_flags);
+        static ShaderLight* GetVariationClustered(Context* context, const uint64_t renderer_flags);
         static auto& GetVariations() { return m_variations; }
 
+        // The flags GetVariation() and GetVariationClustered() would pick
+        static uint16_t GetVariationFlags(const Light* light, const uint64_t renderer_flags);
+        static uint16_t GetVariationFlagsClustered(const uint64_t renderer_flags);
+        // Every variation any light, with any renderer options, can end up with
+        static std::vector<uint16_t> GetVariationFlagsAll();
+        // Compiles (asynchronously) the variations which don't exist yet, returns how many were queued
+        static uint32_t Precompile(Context* context, const std::vector<uint16_t>& flags);
+
     private:
         static ShaderLight* Compile(Context* context, const uint16_t flags);
 
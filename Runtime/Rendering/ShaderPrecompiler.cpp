@@ -0,0 +1,228 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "ShaderPrecompiler.h"
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include "Renderer.h"
+#include "ShaderGBuffer.h"
+#include "ShaderLight.h"
+#include "../Logging/Log.h"
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../World/World.h"
+#include "../World/Entity.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Light.h"
+#include "../RHI/RHI_ShaderCache.h"
+//======================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        const char* manifest_name_gbuffer   = "gbuffer";
+        const char* manifest_name_light     = "light";
+
+        template<typename T>
+        bool is_any_compiling(const T& variations)
+        {
+            for (const auto& it : variations)
+            {
+                const Shader_Compilation_State state = it.second->GetCompilationState();
+                if (state == Shader_Compilation_Unknown || state == Shader_Compilation_Compiling)
+                    return true;
+            }
+
+            return false;
+        }
+
+        template<typename T>
+        void write_variations(ofstream& out, const char* name, const T& variations)
+        {
+            for (const auto& it : variations)
+            {
+                // Failed variations would fail again
+                if (it.second->IsCompiled())
+                {
+                    out << name << " " << it.first << "\n";
+                }
+            }
+        }
+    }
+
+    ShaderPrecompiler::ShaderPrecompiler(Context* context)
+    {
+        m_context = context;
+
+        if (const RHI_ShaderCache* shader_cache = context->GetSubsystem<Renderer>()->GetShaderCache())
+        {
+            m_manifest_path = shader_cache->GetDirectory() + "/variations.manifest";
+        }
+    }
+
+    uint32_t ShaderPrecompiler::Precompile(const ShaderPrecompile_Scope scope, const bool wait /*= false*/)
+    {
+        const Stopwatch timer;
+
+        vector<uint16_t> flags_gbuffer;
+        vector<uint16_t> flags_light;
+
+        if (scope == ShaderPrecompile_Manifest)
+        {
+            LoadManifest(&flags_gbuffer, &flags_light);
+        }
+        else if (scope == ShaderPrecompile_World)
+        {
+            GetWorldVariations(&flags_gbuffer, &flags_light);
+        }
+        else if (scope == ShaderPrecompile_All)
+        {
+            flags_gbuffer   = ShaderGBuffer::GetVariationFlagsAll();
+            flags_light     = ShaderLight::GetVariationFlagsAll();
+        }
+
+        // Each variation compiles as a separate task, so they spread across all the threads
+        const uint32_t count = ShaderGBuffer::Precompile(m_context, flags_gbuffer) + ShaderLight::Precompile(m_context, flags_light);
+
+        if (count == 0)
+            return 0;
+
+        if (!wait)
+        {
+            LOG_INFO("Queued %d shader variations for compilation", count);
+            return count;
+        }
+
+        Wait();
+        SaveManifest();
+        LOG_INFO("Compiled %d shader variations in %.2f ms", count, timer.GetElapsedTimeMs());
+
+        return count;
+    }
+
+    void ShaderPrecompiler::Wait() const
+    {
+        while (IsCompiling())
+        {
+            this_thread::sleep_for(chrono::milliseconds(16));
+        }
+    }
+
+    bool ShaderPrecompiler::IsCompiling() const
+    {
+        return is_any_compiling(ShaderGBuffer::GetVariations()) || is_any_compiling(ShaderLight::GetVariations());
+    }
+
+    bool ShaderPrecompiler::SaveManifest() const
+    {
+        if (m_manifest_path.empty())
+            return false;
+
+        ofstream out(m_manifest_path, ios::out | ios::trunc);
+        if (!out.is_open())
+        {
+            LOG_ERROR("Failed to open \"%s\" for writing", m_manifest_path.c_str());
+            return false;
+        }
+
+        out << "# Shader variations to compile at startup, one per line: <shader> <flags>\n";
+        write_variations(out, manifest_name_gbuffer,    ShaderGBuffer::GetVariations());
+        write_variations(out, manifest_name_light,      ShaderLight::GetVariations());
+
+        return true;
+    }
+
+    bool ShaderPrecompiler::LoadManifest(vector<uint16_t>* flags_gbuffer, vector<uint16_t>* flags_light) const
+    {
+        if (m_manifest_path.empty())
+            return false;
+
+        // It's fine if there is none, it will be written on shutdown
+        ifstream in(m_manifest_path);
+        if (!in.is_open())
+            return false;
+
+        string line;
+        while (getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            const size_t separator = line.find(' ');
+            if (separator == string::npos)
+            {
+                LOG_WARNING("Ignoring invalid manifest line \"%s\"", line.c_str());
+                continue;
+            }
+
+            const string name           = line.substr(0, separator);
+            const unsigned long flags   = strtoul(line.c_str() + separator + 1, nullptr, 10);
+
+            if (name == manifest_name_gbuffer)
+            {
+                flags_gbuffer->emplace_back(static_cast<uint16_t>(flags));
+            }
+            else if (name == manifest_name_light)
+            {
+                flags_light->emplace_back(static_cast<uint16_t>(flags));
+            }
+            else
+            {
+                LOG_WARNING("Ignoring unknown shader \"%s\"", name.c_str());
+            }
+        }
+
+        return true;
+    }
+
+    void ShaderPrecompiler::GetWorldVariations(vector<uint16_t>* flags_gbuffer, vector<uint16_t>* flags_light) const
+    {
+        const uint64_t renderer_flags = m_context->GetSubsystem<Renderer>()->GetOptions();
+
+        for (const auto& entity : m_context->GetSubsystem<World>()->EntityGetAll())
+        {
+            if (const Renderable* renderable = entity->GetComponent<Renderable>())
+            {
+                if (const Material* material = renderable->GetMaterial())
+                {
+                    flags_gbuffer->emplace_back(material->GetFlags());
+                }
+            }
+
+            if (const Light* light = entity->GetComponent<Light>())
+            {
+                flags_light->emplace_back(ShaderLight::GetVariationFlags(light, renderer_flags));
+            }
+        }
+
+        if (renderer_flags & Render_ClusteredLighting)
+        {
+            flags_light->emplace_back(ShaderLight::GetVariationFlagsClustered(renderer_flags));
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==============
+#include <string>
+#include <vector>
+#include "../Core/EngineDefs.h"
+//=========================
+
+namespace Spartan
+{
+    class Context;
+
+    enum ShaderPrecompile_Scope
+    {
+        ShaderPrecompile_Manifest,  // Variations which were used in previous runs
+        ShaderPrecompile_World,     // Variations referenced by the materials and lights of the loaded world
+        ShaderPrecompile_All        // Every reachable variation, what a shipping build wants in its shader cache
+    };
+
+    // Compiles shader variations ahead of time, on all cores, so they come out of the shader cache instead of
+    // being compiled the first time something draws with them. Variations which exist when the engine shuts down
+    // are written to a manifest, next to the shader cache, so the next run can compile them at startup.
+    class SPARTAN_CLASS ShaderPrecompiler
+    {
+    public:
+        ShaderPrecompiler(Context* context);
+        ~ShaderPrecompiler() = default;
+
+        // Returns how many variations were queued, compilation is asynchronous unless told to wait
+        uint32_t Precompile(ShaderPrecompile_Scope scope, bool wait = false);
+        // Blocks until every variation is done compiling
+        void Wait() const;
+        bool IsCompiling() const;
+
+        bool SaveManifest() const;
+
+    private:
+        bool LoadManifest(std::vector<uint16_t>* flags_gbuffer, std::vector<uint16_t>* flags_light) const;
+        void GetWorldVariations(std::vector<uint16_t>* flags_gbuffer, std::vector<uint16_t>* flags_light) const;
+
+        std::string m_manifest_path;
+        Context* m_context = nullptr;
+    };
+}
@@ -0,0 +1,384 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================================
+#include "ShadowAtlas.h"
+#include <algorithm>
+#include "Renderer.h"
+#include "Material.h"
+#include "../Core/Context.h"
+#include "../Logging/Log.h"
+#include "../Utilities/Hash.h"
+#include "../RHI/RHI_Device.h"
+#include "../RHI/RHI_Texture2D.h"
+#include "../World/Entity.h"
+#include "../World/Components/Light.h"
+#include "../World/Components/Camera.h"
+#include "../World/Components/Transform.h"
+#include "../World/Components/Renderable.h"
+//============================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    // The smallest tile is this many times smaller than the biggest one
+    static const uint32_t tile_size_steps = 16;
+
+    inline uint32_t power_of_two_floor(const uint32_t x)
+    {
+        uint32_t result = 1;
+        while (result <= x / 2)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+
+    // Extracts the even bits, used to turn a morton (z-order) index into a coordinate
+    inline uint32_t morton_compact(uint32_t x)
+    {
+        x &= 0x55555555;
+        x = (x ^ (x >> 1)) & 0x33333333;
+        x = (x ^ (x >> 2)) & 0x0f0f0f0f;
+        x = (x ^ (x >> 4)) & 0x00ff00ff;
+        x = (x ^ (x >> 8)) & 0x0000ffff;
+        return x;
+    }
+
+    ShadowAtlas::ShadowAtlas(Context* context)
+    {
+        m_context   = context;
+        m_renderer  = context->GetSubsystem<Renderer>();
+    }
+
+    void ShadowAtlas::Update(const Camera* camera, const vector<Entity*>& lights, const vector<Entity*>& casters_opaque, const vector<Entity*>& casters_transparent)
+    {
+        m_frame++;
+        m_tiles_rendered    = 0;
+        m_tiles_cached      = 0;
+
+        // A full resolution tile is as big as a regular shadow map, the atlas fits four of them
+        const uint32_t shadow_resolution = m_renderer->GetOptionValue<uint32_t>(Option_Value_ShadowResolution);
+        uint32_t tile_max   = power_of_two_floor(Helper::Max(shadow_resolution, tile_size_steps));
+        uint32_t resolution = tile_max * 2;
+        while (resolution > tile_size_steps && !m_renderer->GetRhiDevice()->ValidateResolution(resolution, resolution))
+        {
+            resolution /= 2;
+        }
+        m_tile_max = Helper::Min(tile_max, resolution);
+        m_tile_min = m_tile_max / tile_size_steps;
+
+        // Request a slot for every light which needs one
+        vector<pair<const Light*, ShadowAtlasSlot*>> requests;
+        bool needs_color = false;
+        for (Entity* entity : lights)
+        {
+            const Light* light = entity->GetComponent<Light>();
+            if (!IsLightInAtlas(light) || light->GetShadowArraySize() == 0)
+                continue;
+
+            ShadowAtlasSlot& slot           = m_slots[light->GetId()];
+            const bool previous_valid       = slot.resolution_requested >= m_tile_min && slot.resolution_requested <= m_tile_max;
+            slot.resolution_requested       = ComputeTileResolution(camera, light, previous_valid ? slot.resolution_requested : 0);
+            slot.resolution                 = slot.resolution_requested;
+            slot.tile_count                 = light->GetShadowArraySize();
+            slot.frame                      = m_frame;
+            needs_color                     |= light->GetShadowsTransparentEnabled();
+
+            requests.emplace_back(light, &slot);
+        }
+
+        // Forget lights which are gone
+        for (auto it = m_slots.begin(); it != m_slots.end();)
+        {
+            it = it->second.frame != m_frame ? m_slots.erase(it) : next(it);
+        }
+
+        if (requests.empty())
+            return;
+
+        // (Re)create the atlas if needed, the contents of every tile are lost so everything has to be re-rendered
+        const bool reverse_z = m_renderer->GetOption(Render_ReverseZ);
+        if (resolution != m_resolution || (needs_color && !m_texture_color) || reverse_z != m_reverse_z)
+        {
+            if (!CreateTextures(resolution, needs_color))
+                return;
+
+            m_reverse_z = reverse_z;
+            Invalidate();
+        }
+
+        // Shrink the biggest tiles until everything fits
+        {
+            const auto area_required = [&requests]()
+            {
+                uint64_t area = 0;
+                for (const auto& request : requests)
+                {
+                    area += static_cast<uint64_t>(request.second->resolution) * request.second->resolution * request.second->tile_count;
+                }
+                return area;
+            };
+
+            const uint64_t area_available = static_cast<uint64_t>(m_resolution) * m_resolution;
+            while (area_required() > area_available)
+            {
+                uint32_t resolution_largest = 0;
+                for (const auto& request : requests)
+                {
+                    resolution_largest = Helper::Max(resolution_largest, request.second->resolution);
+                }
+
+                // Nothing more to shrink, the lights which don't fit will go without shadows
+                if (resolution_largest <= m_tile_min)
+                    break;
+
+                for (const auto& request : requests)
+                {
+                    if (request.second->resolution == resolution_largest)
+                    {
+                        request.second->resolution /= 2;
+                    }
+                }
+            }
+        }
+
+        // Pack, largest tiles first and in a stable order so that unchanged lights tend to keep their tiles.
+        // Since all tile sizes are powers of two and go in descending order, walking a morton curve in units
+        // of the smallest tile always yields a square and aligned region, without any gaps or overlaps.
+        sort(requests.begin(), requests.end(), [](const auto& a, const auto& b)
+        {
+            if (a.second->resolution != b.second->resolution)
+                return a.second->resolution > b.second->resolution;
+
+            return a.first->GetId() < b.first->GetId();
+        });
+
+        const uint32_t cells_per_side   = m_resolution / m_tile_min;
+        const uint32_t cell_count       = cells_per_side * cells_per_side;
+        uint32_t cell                   = 0;
+        for (const auto& request : requests)
+        {
+            ShadowAtlasSlot& slot       = *request.second;
+            const uint32_t tile_cells   = (slot.resolution / m_tile_min) * (slot.resolution / m_tile_min);
+
+            for (uint32_t i = 0; i < slot.tile_count; i++)
+            {
+                Rectangle tile = Rectangle(0.0f, 0.0f, 0.0f, 0.0f);
+                if (cell + tile_cells <= cell_count)
+                {
+                    const float x   = static_cast<float>(morton_compact(cell) * m_tile_min);
+                    const float y   = static_cast<float>(morton_compact(cell >> 1) * m_tile_min);
+                    tile            = Rectangle(x, y, x + slot.resolution, y + slot.resolution);
+                    cell            += tile_cells;
+                }
+
+                if (slot.tiles[i] != tile)
+                {
+                    slot.tiles[i]   = tile;
+                    slot.hashes[i]  = 0;
+                }
+            }
+        }
+
+        // Work out which tiles have to be re-rendered
+        for (const auto& request : requests)
+        {
+            ShadowAtlasSlot& slot = *request.second;
+
+            for (uint32_t i = 0; i < slot.tile_count; i++)
+            {
+                slot.dirty[i] = false;
+
+                if (slot.tiles[i].Width() == 0.0f)
+                    continue;
+
+                const size_t hash = ComputeTileHash(request.first, i, casters_opaque, casters_transparent);
+                if (hash != slot.hashes[i])
+                {
+                    slot.hashes[i]  = hash;
+                    slot.dirty[i]   = true;
+                    m_tiles_rendered++;
+                }
+                else
+                {
+                    m_tiles_cached++;
+                }
+            }
+        }
+    }
+
+    void ShadowAtlas::Invalidate()
+    {
+        for (auto& it : m_slots)
+        {
+            it.second.hashes.fill(0);
+        }
+    }
+
+    bool ShadowAtlas::IsLightInAtlas(const Light* light)
+    {
+        // Directional light cascades follow the camera, so they gain nothing from caching and keep their own texture array
+        return light && light->GetShadowsEnabled() && light->GetLightType() != LightType_Directional;
+    }
+
+    const ShadowAtlasSlot* ShadowAtlas::GetSlot(const Light* light) const
+    {
+        if (!light)
+            return nullptr;
+
+        auto it = m_slots.find(light->GetId());
+        return it != m_slots.end() ? &it->second : nullptr;
+    }
+
+    bool ShadowAtlas::IsTileDirty(const Light* light, const uint32_t index) const
+    {
+        const ShadowAtlasSlot* slot = GetSlot(light);
+        return slot && index < slot->tile_count && slot->dirty[index];
+    }
+
+    Vector4 ShadowAtlas::GetTileUv(const Light* light, const uint32_t index) const
+    {
+        const ShadowAtlasSlot* slot = GetSlot(light);
+        if (!slot || index >= slot->tile_count || m_resolution == 0)
+            return Vector4::Zero;
+
+        const Rectangle& tile   = slot->tiles[index];
+        const float texel_size  = 1.0f / static_cast<float>(m_resolution);
+        return Vector4(tile.left * texel_size, tile.top * texel_size, tile.Width() * texel_size, tile.Height() * texel_size);
+    }
+
+    bool ShadowAtlas::CreateTextures(const uint32_t resolution, const bool color)
+    {
+        if (!m_renderer->GetRhiDevice()->ValidateResolution(resolution, resolution))
+        {
+            LOG_ERROR("Invalid shadow atlas resolution %dx%d", resolution, resolution);
+            return false;
+        }
+
+        m_texture_depth = make_shared<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, 1);
+        m_texture_color = color ? make_shared<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_R8G8B8A8_Unorm, 1) : nullptr;
+        m_resolution    = resolution;
+
+        return true;
+    }
+
+    uint32_t ShadowAtlas::ComputeTileResolution(const Camera* camera, const Light* light, const uint32_t resolution_previous) const
+    {
+        const auto resolution_from_coverage = [this](const float coverage)
+        {
+            const float size    = coverage * m_tile_max;
+            uint32_t resolution = m_tile_max;
+            while (resolution > m_tile_min && resolution / 2 >= size)
+            {
+                resolution /= 2;
+            }
+            return resolution;
+        };
+
+        // Approximate the fraction of the screen the light's sphere of influence covers
+        float coverage = 1.0f;
+        if (camera && camera->GetProjectionType() == Projection_Perspective)
+        {
+            const float distance = Vector3::Distance(camera->GetTransform()->GetPosition(), light->GetTransform()->GetPosition());
+            if (distance > light->GetRange())
+            {
+                coverage = light->GetRange() / (distance * Helper::Tan(camera->GetFovVerticalRad() * 0.5f));
+            }
+        }
+
+        // Grow immediately but only shrink once the coverage has clearly dropped, so that tiles
+        // (and with them the cached shadows) don't flip between two sizes every other frame.
+        const uint32_t resolution_grow      = resolution_from_coverage(coverage);
+        const uint32_t resolution_shrink    = resolution_from_coverage(coverage * 1.5f);
+
+        if (resolution_previous == 0 || resolution_grow > resolution_previous)
+            return resolution_grow;
+
+        if (resolution_shrink < resolution_previous)
+            return resolution_shrink;
+
+        return resolution_previous;
+    }
+
+    size_t ShadowAtlas::ComputeTileHash(const Light* light, const uint32_t index, const vector<Entity*>& casters_opaque, const vector<Entity*>& casters_transparent) const
+    {
+        size_t hash = 0;
+
+        // The light and its tile
+        const Matrix view_projection = light->GetViewMatrix(index) * light->GetProjectionMatrix(index);
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            Utility::Hash::hash_combine(hash, view_projection.Data()[i]);
+        }
+        const Rectangle& tile = m_slots.at(light->GetId()).tiles[index];
+        Utility::Hash::hash_combine(hash, tile.left);
+        Utility::Hash::hash_combine(hash, tile.top);
+        Utility::Hash::hash_combine(hash, tile.right);
+        Utility::Hash::hash_combine(hash, light->GetShadowsTransparentEnabled());
+
+        // The shadow casters within the light's frustum, a moved caster has a different transform revision.
+        // Each caster is hashed on its own and the results are summed, so the order in which the renderer
+        // happens to list the casters (it changes as entities are added or sorted) doesn't dirty the tile.
+        size_t hash_casters_sum = 0;
+        const auto hash_casters = [&hash_casters_sum, light, index](const vector<Entity*>& casters)
+        {
+            for (Entity* entity : casters)
+            {
+                Renderable* renderable = entity->GetRenderable();
+                if (!renderable || !renderable->GetCastShadows() || !renderable->GeometryModel())
+                    continue;
+
+                if (!light->IsInViewFrustrum(renderable, index))
+                    continue;
+
+                const uint32_t lod = renderable->GeometryLodShadows();
+
+                size_t hash_caster = 0;
+                Utility::Hash::hash_combine(hash_caster, entity->GetId());
+                Utility::Hash::hash_combine(hash_caster, entity->GetTransform()->GetRevision());
+                Utility::Hash::hash_combine(hash_caster, lod);
+                Utility::Hash::hash_combine(hash_caster, renderable->GeometryIndexOffset(lod));
+                Utility::Hash::hash_combine(hash_caster, renderable->GeometryIndexCount(lod));
+                if (const Material* material = renderable->GetMaterial())
+                {
+                    Utility::Hash::hash_combine(hash_caster, material->GetId());
+                    Utility::Hash::hash_combine(hash_caster, material->GetRevision());
+                }
+
+                hash_casters_sum += hash_caster;
+            }
+        };
+
+        hash_casters(casters_opaque);
+        if (light->GetShadowsTransparentEnabled())
+        {
+            hash_casters(casters_transparent);
+        }
+        Utility::Hash::hash_combine(hash, hash_casters_sum);
+
+        return hash;
+    }
+}
@@ -0,0 +1,102 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =================
+#include <vector>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include "../Math/Rectangle.h"
+#include "../Math/Vector4.h"
+#include "../Core/EngineDefs.h"
+//============================
+
+namespace Spartan
+{
+    class Context;
+    class Camera;
+    class Entity;
+    class Light;
+    class Renderer;
+
+    // The part of the atlas which belongs to a single light
+    struct ShadowAtlasSlot
+    {
+        uint32_t resolution             = 0;    // tile resolution, in pixels
+        uint32_t resolution_requested   = 0;    // tile resolution based on screen coverage, before packing
+        uint32_t tile_count             = 0;    // 6 for point lights (one per cube face), 1 for spot lights
+        std::array<Math::Rectangle, 6> tiles;   // in pixels, zero sized when the atlas ran out of space
+        std::array<size_t, 6> hashes    = {};   // the state each tile was last rendered with
+        std::array<bool, 6> dirty       = {};   // tiles which have to be re-rendered this frame
+        uint64_t frame                  = 0;    // last frame the light requested a slot
+    };
+
+    // A single depth (and color, for transparent shadows) texture which is shared by all the point and spot lights.
+    // Tiles are sized by the light's screen coverage and are only re-rendered when the light, its tile or any
+    // shadow caster within its frustum changes, so static lights with static casters cost nothing after the first frame.
+    class SPARTAN_CLASS ShadowAtlas
+    {
+    public:
+        ShadowAtlas(Context* context);
+        ~ShadowAtlas() = default;
+
+        // Sizes and packs the tiles, then works out which of them have to be re-rendered
+        void Update(const Camera* camera, const std::vector<Entity*>& lights, const std::vector<Entity*>& casters_opaque, const std::vector<Entity*>& casters_transparent);
+
+        // Forces every tile to be re-rendered
+        void Invalidate();
+
+        // Lights which render their shadows into the atlas
+        static bool IsLightInAtlas(const Light* light);
+
+        // Properties
+        const ShadowAtlasSlot* GetSlot(const Light* light) const;
+        bool IsTileDirty(const Light* light, uint32_t index) const;
+        Math::Vector4 GetTileUv(const Light* light, uint32_t index) const; // xy: offset, zw: scale
+        RHI_Texture* GetTextureDepth()  const { return m_texture_depth.get(); }
+        RHI_Texture* GetTextureColor()  const { return m_texture_color.get(); }
+        uint32_t GetResolution()        const { return m_resolution; }
+        uint32_t GetTilesRendered()     const { return m_tiles_rendered; }
+        uint32_t GetTilesCached()       const { return m_tiles_cached; }
+
+    private:
+        bool CreateTextures(uint32_t resolution, bool color);
+        uint32_t ComputeTileResolution(const Camera* camera, const Light* light, uint32_t resolution_previous) const;
+        size_t ComputeTileHash(const Light* light, uint32_t index, const std::vector<Entity*>& casters_opaque, const std::vector<Entity*>& casters_transparent) const;
+
+        std::unordered_map<uint32_t, ShadowAtlasSlot> m_slots; // keyed by light id
+        std::shared_ptr<RHI_Texture> m_texture_depth;
+        std::shared_ptr<RHI_Texture> m_texture_color;
+        uint32_t m_resolution       = 0;
+        uint32_t m_tile_max         = 0;
+        uint32_t m_tile_min         = 0;
+        uint32_t m_tiles_rendered   = 0;
+        uint32_t m_tiles_cached     = 0;
+        uint64_t m_frame            = 0;
+        bool m_reverse_z            = false;
+
+        // Dependencies
+        Context* m_context      = nullptr;
+        Renderer* m_renderer    = nullptr;
+    };
+}
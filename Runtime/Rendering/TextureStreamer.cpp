@@ -0,0 +1,486 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "TextureStreamer.h"
+#include <queue>
+#include <random>
+#include <unordered_set>
+#include "Material.h"
+#include "Renderer.h"
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+#include "../World/Entity.h"
+#include "../World/Components/Camera.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Transform.h"
+#include "../RHI/RHI_Device.h"
+#include "../RHI/RHI_Texture2D.h"
+//=====================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    // Screen pixels per texel, the lower it is the less the top mip is missed
+    static float get_priority(const TextureResidency& texture, const uint32_t mip)
+    {
+        const uint32_t size = Helper::Max(Helper::Max(texture.width, texture.height) >> mip, 1u);
+        return texture.screen_size / static_cast<float>(size);
+    }
+
+    TextureStreamer::TextureStreamer(Context* context)
+    {
+        m_context       = context;
+        m_profiler      = m_context->GetSubsystem<Profiler>();
+        m_threading     = m_context->GetSubsystem<Threading>();
+        m_rhi_device    = m_context->GetSubsystem<Renderer>()->GetRhiDevice().get();
+    }
+
+    void TextureStreamer::Tick(const vector<Entity*>& entities_opaque, const vector<Entity*>& entities_transparent, const Camera* camera, const float viewport_height, const bool enabled)
+    {
+        if (!camera)
+            return;
+
+        TIME_BLOCK_START_NAMED(m_profiler, "TextureStreamer::Tick");
+
+        m_textures.clear();
+        m_texture_ptrs.clear();
+        m_texture_indices.clear();
+        Gather(entities_opaque, camera, viewport_height);
+        Gather(entities_transparent, camera, viewport_height);
+
+        // Swap in what finished loading, before deciding what to load next
+        CompleteJobs();
+
+        // When disabled, everything streams back in, regardless of the budget
+        const uint64_t budget_device = m_rhi_device ? m_rhi_device->GetMemoryBudget(RHI_Memory_Pool_Texture) : 0;
+        m_budget = budget_device != 0 ? budget_device : budget_default;
+        if (!enabled)
+        {
+            for (TextureResidency& texture : m_textures)
+            {
+                texture.mip_desired = 0;
+            }
+        }
+        ComputeResidency(m_textures, enabled ? m_budget : numeric_limits<uint64_t>::max());
+
+        StartJobs();
+
+        m_bytes_resident = 0;
+        for (const TextureResidency& texture : m_textures)
+        {
+            m_bytes_resident += GetChainSize(texture, texture.mip_resident);
+        }
+
+        TIME_BLOCK_END(m_profiler);
+    }
+
+    void TextureStreamer::Gather(const vector<Entity*>& entities, const Camera* camera, const float viewport_height)
+    {
+        const Vector3 camera_position   = camera->GetTransform()->GetPosition();
+        const bool orthographic         = camera->GetProjectionType() == Projection_Orthographic;
+        const float fov_vertical_rad    = camera->GetFovVerticalRad();
+
+        for (Entity* entity : entities)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            Material* material = renderable->GetMaterial();
+            if (!material)
+                continue;
+
+            // Distance based only, so that looking around doesn't stream textures in and out
+            const float screen_size = orthographic ? viewport_height : ComputeScreenSize(renderable->GetAabb(), camera_position, fov_vertical_rad, viewport_height);
+
+            for (uint32_t property = Material_Color; property <= Material_Mask; property <<= 1)
+            {
+                RHI_Texture* texture = material->GetTexture_Ptr(static_cast<Material_Property>(property));
+                if (!texture || texture->GetLoadState() != LoadState_Completed || !texture->IsStreamable())
+                    continue;
+
+                // A texture shared by many renderables needs the mip of the largest one
+                auto it = m_texture_indices.find(texture->GetId());
+                if (it != m_texture_indices.end())
+                {
+                    TextureResidency& residency = m_textures[it->second];
+                    residency.screen_size       = Helper::Max(residency.screen_size, screen_size);
+                    continue;
+                }
+
+                TextureResidency residency;
+                residency.id            = texture->GetId();
+                residency.width         = texture->GetWidth();
+                residency.height        = texture->GetHeight();
+                residency.mip_count     = Helper::Min(texture->GetMiplevelsTotal(), TextureResidency::mip_count_max);
+                residency.mip_tail      = GetMipTail(residency.width, residency.height, residency.mip_count);
+                residency.mip_resident  = texture->GetMipFirst();
+                residency.screen_size   = screen_size;
+                for (uint32_t mip_index = 0; mip_index < residency.mip_count; mip_index++)
+                {
+                    residency.mip_sizes[mip_index] = texture->GetMipSize(mip_index);
+                }
+
+                m_texture_indices[residency.id] = static_cast<uint32_t>(m_textures.size());
+                m_textures.emplace_back(residency);
+                m_texture_ptrs.emplace_back(texture);
+            }
+        }
+
+        for (TextureResidency& texture : m_textures)
+        {
+            texture.mip_desired = ComputeDesiredMip(texture.width, texture.height, texture.mip_count, texture.screen_size);
+        }
+    }
+
+    void TextureStreamer::CompleteJobs()
+    {
+        RHI_StagingRing* staging_ring = m_rhi_device ? m_rhi_device->GetStagingRing() : nullptr;
+
+        for (auto it = m_jobs.begin(); it != m_jobs.end();)
+        {
+            const shared_ptr<Job>& job = *it;
+            if (!job->done)
+            {
+                it++;
+                continue;
+            }
+
+            // With a staging ring, the upload completes on the GPU a few frames later
+            if (job->texture && staging_ring && job->texture->GetLayout() != RHI_Image_Shader_Read_Only_Optimal)
+            {
+                it++;
+                continue;
+            }
+
+            // Textures that are no longer rendered have been gathered out, along with any guarantee they still exist
+            auto index = m_texture_indices.find(job->texture_id);
+            if (job->texture && job->texture->Get_Resource() && index != m_texture_indices.end())
+            {
+                m_texture_ptrs[index->second]->SwapResourceGpu(job->texture.get(), job->mip_first);
+                m_textures[index->second].mip_resident = m_texture_ptrs[index->second]->GetMipFirst();
+            }
+
+            // The temporary texture now owns the previous resource, which is destroyed once the GPU is done with it
+            it = m_jobs.erase(it);
+        }
+    }
+
+    void TextureStreamer::StartJobs()
+    {
+        if (m_jobs.size() >= m_jobs_max)
+            return;
+
+        unordered_set<uint32_t> streaming;
+        for (const shared_ptr<Job>& job : m_jobs)
+        {
+            streaming.insert(job->texture_id);
+        }
+
+        vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_textures.size()); i++)
+        {
+            if (m_textures[i].mip_target != m_textures[i].mip_resident && streaming.find(m_textures[i].id) == streaming.end())
+            {
+                candidates.emplace_back(i);
+            }
+        }
+
+        // Stream out first, to make room, then stream in what's missed the most
+        sort(candidates.begin(), candidates.end(), [this](const uint32_t a, const uint32_t b)
+        {
+            const TextureResidency& texture_a = m_textures[a];
+            const TextureResidency& texture_b = m_textures[b];
+            const bool out_a = texture_a.mip_target > texture_a.mip_resident;
+            const bool out_b = texture_b.mip_target > texture_b.mip_resident;
+            if (out_a != out_b)
+                return out_a;
+
+            return get_priority(texture_a, texture_a.mip_resident) > get_priority(texture_b, texture_b.mip_resident);
+        });
+
+        for (const uint32_t index : candidates)
+        {
+            if (m_jobs.size() >= m_jobs_max)
+                break;
+
+            const TextureResidency& residency   = m_textures[index];
+            const RHI_Texture* texture          = m_texture_ptrs[index];
+            shared_ptr<Job> job                 = make_shared<Job>();
+            job->texture_id                     = residency.id;
+            job->mip_first                      = residency.mip_target;
+            m_jobs.emplace_back(job);
+
+            Context* context        = m_context;
+            const string file_path  = texture->GetResourceFilePathNative();
+            const RHI_Format format = texture->GetFormat();
+            const uint32_t width    = Helper::Max(residency.width >> job->mip_first, 1u);
+            const uint32_t height   = Helper::Max(residency.height >> job->mip_first, 1u);
+
+            m_threading->AddTask([context, job, file_path, format, width, height]()
+            {
+                vector<vector<std::byte>> mips;
+                if (RHI_Texture::LoadMipsFromFile(file_path, job->mip_first, mips))
+                {
+                    job->texture = make_shared<RHI_Texture2D>(context, width, height, format, mips);
+                }
+                else
+                {
+                    LOG_ERROR("Failed to stream \"%s\"", file_path.c_str());
+                }
+
+                job->done = true;
+            });
+        }
+    }
+
+    uint32_t TextureStreamer::GetMipTail(const uint32_t width, const uint32_t height, const uint32_t mip_count)
+    {
+        if (mip_count == 0)
+            return 0;
+
+        uint32_t mip = 0;
+        while (mip < mip_count - 1 && (Helper::Max(width, height) >> mip) > tail_size)
+        {
+            mip++;
+        }
+
+        return mip;
+    }
+
+    uint32_t TextureStreamer::ComputeDesiredMip(const uint32_t width, const uint32_t height, const uint32_t mip_count, const float screen_size)
+    {
+        if (mip_count == 0)
+            return 0;
+
+        // Not on screen, only the tail is needed
+        if (screen_size <= 0.0f)
+            return mip_count - 1;
+
+        // Every mip halves the texels, so one texel per pixel is log2 of the ratio
+        const float ratio = static_cast<float>(Helper::Max(width, height)) / screen_size;
+        if (ratio <= 1.0f)
+            return 0;
+
+        return Helper::Min(static_cast<uint32_t>(floor(log2(ratio))), mip_count - 1);
+    }
+
+    float TextureStreamer::ComputeScreenSize(const BoundingBox& aabb, const Vector3& camera_position, const float fov_vertical_rad, const float viewport_height)
+    {
+        // The projected diameter of the bounding sphere, the full viewport when the camera is inside it
+        const float radius      = aabb.GetExtents().Length();
+        const float distance    = (aabb.GetCenter() - camera_position).Length();
+        if (distance <= radius)
+            return viewport_height;
+
+        return Helper::Min(radius * viewport_height / (distance * tan(fov_vertical_rad * 0.5f)), viewport_height);
+    }
+
+    uint64_t TextureStreamer::GetChainSize(const TextureResidency& texture, const uint32_t mip_first)
+    {
+        uint64_t size = 0;
+        for (uint32_t mip_index = mip_first; mip_index < texture.mip_count; mip_index++)
+        {
+            size += texture.mip_sizes[mip_index];
+        }
+
+        return size;
+    }
+
+    uint64_t TextureStreamer::ComputeResidency(vector<TextureResidency>& textures, const uint64_t budget)
+    {
+        // Everything gets what it asks for, if it fits
+        uint64_t size = 0;
+        for (TextureResidency& texture : textures)
+        {
+            texture.mip_target = Helper::Min(texture.mip_desired, texture.mip_tail);
+
+            // Don't drop a single mip right away, a texture that sits on the boundary would keep streaming in and out
+            if (texture.mip_target == texture.mip_resident + 1)
+            {
+                texture.mip_target = texture.mip_resident;
+            }
+
+            size += GetChainSize(texture, texture.mip_target);
+        }
+
+        if (size <= budget)
+            return size;
+
+        // Otherwise, drop top mips from the textures which need them the least, one mip at a time
+        using entry = pair<float, uint32_t>;
+        priority_queue<entry, vector<entry>, greater<entry>> queue;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(textures.size()); i++)
+        {
+            if (textures[i].mip_target < textures[i].mip_tail)
+            {
+                queue.emplace(get_priority(textures[i], textures[i].mip_target), i);
+            }
+        }
+
+        while (size > budget && !queue.empty())
+        {
+            const uint32_t index        = queue.top().second;
+            TextureResidency& texture   = textures[index];
+            queue.pop();
+
+            size -= texture.mip_sizes[texture.mip_target];
+            texture.mip_target++;
+
+            if (texture.mip_target < texture.mip_tail)
+            {
+                queue.emplace(get_priority(texture, texture.mip_target), index);
+            }
+        }
+
+        return size;
+    }
+
+    bool TextureStreamer::Benchmark(const uint32_t texture_count /*= 10000*/)
+    {
+        if (texture_count == 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        bool valid = true;
+        auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        // Mip selection
+        check(GetMipTail(2048, 2048, 12) == 4,                      "the tail of a 2048 texture starts at 128");
+        check(GetMipTail(64, 64, 7) == 0,                           "a small texture is all tail");
+        check(ComputeDesiredMip(2048, 2048, 12, 512.0f) == 2,       "a 2048 texture covering 512 pixels wants mip 2");
+        check(ComputeDesiredMip(2048, 1024, 12, 4096.0f) == 0,      "a magnified texture wants mip 0");
+        check(ComputeDesiredMip(2048, 2048, 12, 0.0f) == 11,        "an invisible texture wants the last mip");
+        const float screen_size = ComputeScreenSize(BoundingBox(Vector3(-1.0f, -1.0f, 9.0f), Vector3(1.0f, 1.0f, 11.0f)), Vector3::Zero, Helper::DegreesToRadians(90.0f), 1000.0f);
+        check(Helper::Abs(screen_size - 1000.0f * sqrt(3.0f) / 10.0f) < 0.01f, "the screen size is the projected bounding sphere");
+
+        // Hysteresis
+        {
+            vector<TextureResidency> textures(1);
+            TextureResidency& texture   = textures[0];
+            texture.width               = 2048;
+            texture.height              = 2048;
+            texture.mip_count           = 12;
+            texture.mip_tail            = GetMipTail(texture.width, texture.height, texture.mip_count);
+            texture.mip_resident        = 1;
+            texture.mip_desired         = 2;
+            ComputeResidency(textures, numeric_limits<uint64_t>::max());
+            check(texture.mip_target == 1, "a texture one mip above what it needs keeps it");
+            texture.mip_desired = 3;
+            ComputeResidency(textures, numeric_limits<uint64_t>::max());
+            check(texture.mip_target == 3, "a texture two mips above what it needs drops them");
+        }
+
+        // Synthetic textures, with a fixed seed so that runs are comparable
+        vector<TextureResidency> textures(texture_count);
+        mt19937 generator(1337);
+        uniform_int_distribution<uint32_t> distribution_size(9, 12);
+        uniform_real_distribution<float> distribution_screen(0.0f, 1440.0f);
+        for (uint32_t i = 0; i < texture_count; i++)
+        {
+            TextureResidency& texture   = textures[i];
+            texture.id                  = i;
+            texture.width               = 1 << distribution_size(generator);
+            texture.height              = 1 << distribution_size(generator);
+            texture.mip_count           = static_cast<uint32_t>(log2(Helper::Max(texture.width, texture.height))) + 1;
+            texture.mip_tail            = GetMipTail(texture.width, texture.height, texture.mip_count);
+            texture.mip_resident        = texture.mip_tail;
+            texture.screen_size         = distribution_screen(generator) < 200.0f ? 0.0f : distribution_screen(generator);
+            texture.mip_desired         = ComputeDesiredMip(texture.width, texture.height, texture.mip_count, texture.screen_size);
+
+            // Block compressed, 8 bytes per 4x4 block
+            for (uint32_t mip_index = 0; mip_index < texture.mip_count; mip_index++)
+            {
+                texture.mip_sizes[mip_index] = static_cast<uint64_t>(Helper::Max(texture.width >> mip_index, 4u) / 4) * (Helper::Max(texture.height >> mip_index, 4u) / 4) * 8;
+            }
+        }
+
+        // Unlimited, everything gets what it asks for
+        const uint64_t size_desired = ComputeResidency(textures, numeric_limits<uint64_t>::max());
+        for (const TextureResidency& texture : textures)
+        {
+            check(texture.mip_target == Helper::Min(texture.mip_desired, texture.mip_tail), "without pressure, the desired mip is resident");
+        }
+
+        // A quarter of that, time it and validate
+        const uint64_t budget       = size_desired / 4;
+        const uint32_t iterations   = 100;
+        uint64_t size               = 0;
+        Stopwatch timer;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            size = ComputeResidency(textures, budget);
+        }
+        const float time = timer.GetElapsedTimeMs() / iterations;
+
+        uint64_t size_tail              = 0;
+        float priority_dropped_max      = 0.0f;
+        float priority_remaining_min    = numeric_limits<float>::max();
+        for (const TextureResidency& texture : textures)
+        {
+            size_tail += GetChainSize(texture, texture.mip_tail);
+
+            check(texture.mip_target <= texture.mip_tail, "the tail is never dropped");
+
+            // Dropping happens in order of priority, so nothing dropped needed its mip more than anything that kept it
+            if (texture.mip_target > Helper::Min(texture.mip_desired, texture.mip_tail))
+            {
+                priority_dropped_max = Helper::Max(priority_dropped_max, get_priority(texture, texture.mip_target - 1));
+            }
+
+            if (texture.mip_target < texture.mip_tail)
+            {
+                priority_remaining_min = Helper::Min(priority_remaining_min, get_priority(texture, texture.mip_target));
+            }
+        }
+        check(size <= budget || size == size_tail,                  "the budget is respected");
+        check(priority_dropped_max <= priority_remaining_min,       "the textures smallest on screen lose their mips first");
+
+        LOG_INFO("%d textures: %.3f ms, desired %.1f MB, budget %.1f MB, resident %.1f MB, tails %.1f MB",
+            texture_count,
+            time,
+            size_desired / 1048576.0f,
+            budget / 1048576.0f,
+            size / 1048576.0f,
+            size_tail / 1048576.0f
+        );
+
+        LOG_INFO("%s", valid ? "Texture streaming residency is valid" : "Texture streaming residency is invalid");
+        return valid;
+    }
+}
@@ -0,0 +1,123 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include "../Core/EngineDefs.h"
+#include "../Math/BoundingBox.h"
+//================================
+
+namespace Spartan
+{
+    class Context;
+    class Entity;
+    class Camera;
+    class Profiler;
+    class Threading;
+    class RHI_Device;
+    class RHI_Texture;
+
+    // A texture as seen by the streamer, kept free of any GPU object so that the residency decision can run headless
+    struct TextureResidency
+    {
+        static const uint32_t mip_count_max = 16;
+
+        uint32_t id                                 = 0;
+        uint32_t width                              = 0;
+        uint32_t height                             = 0;
+        uint32_t mip_count                          = 0;    // the whole chain, as stored in the file
+        uint32_t mip_tail                           = 0;    // this mip and the ones below it are always resident
+        uint32_t mip_resident                       = 0;    // first mip on the GPU
+        uint32_t mip_desired                        = 0;    // first mip the screen size asks for
+        uint32_t mip_target                         = 0;    // first mip to make resident, decided within the budget
+        float screen_size                           = 0.0f; // pixels, the largest among the renderables which use it, 0 when none is visible
+        std::array<uint64_t, mip_count_max> mip_sizes = {};  // bytes
+    };
+
+    // Keeps only the mips that the renderables need on the GPU. Every frame, the textures of the renderables are
+    // gathered, each one asks for the mip that matches its projected size on screen, and when the sum exceeds the
+    // texture memory budget, the top mips of the textures that are smallest on screen (per texel) are dropped first.
+    // A tail of small mips is always resident, so a texture is never missing. Loads happen on worker threads, the
+    // texture's GPU resource is only swapped on the render thread once the new one has been uploaded.
+    class SPARTAN_CLASS TextureStreamer
+    {
+    public:
+        static const uint32_t tail_size         = 128;              // mips with no dimension larger than this are never streamed out
+        static const uint64_t budget_default    = 512 * 1024 * 1024;// bytes, used when the device has no texture budget
+
+        TextureStreamer(Context* context);
+        ~TextureStreamer() = default;
+
+        // Gathers the textures of the renderables, decides which mips should be resident and streams them in and out
+        void Tick(const std::vector<Entity*>& entities_opaque, const std::vector<Entity*>& entities_transparent, const Camera* camera, float viewport_height, bool enabled);
+
+        // Residency decision
+        static uint32_t GetMipTail(uint32_t width, uint32_t height, uint32_t mip_count);
+        static uint32_t ComputeDesiredMip(uint32_t width, uint32_t height, uint32_t mip_count, float screen_size);
+        static float ComputeScreenSize(const Math::BoundingBox& aabb, const Math::Vector3& camera_position, float fov_vertical_rad, float viewport_height);
+        static uint64_t GetChainSize(const TextureResidency& texture, uint32_t mip_first);
+        static uint64_t ComputeResidency(std::vector<TextureResidency>& textures, uint64_t budget);
+
+        // Checks the mip selection rules, then fits a generated set of textures into a budget which can't hold them all
+        static bool Benchmark(uint32_t texture_count = 10000);
+
+        // Properties
+        uint64_t GetBudget()        const { return m_budget; }
+        uint64_t GetBytesResident() const { return m_bytes_resident; }
+        uint32_t GetJobCount()      const { return static_cast<uint32_t>(m_jobs.size()); }
+
+    private:
+        struct Job
+        {
+            uint32_t texture_id = 0;
+            uint32_t mip_first  = 0;
+            std::shared_ptr<RHI_Texture> texture;   // the new mips, created on a worker thread
+            std::atomic<bool> done = false;
+        };
+
+        void Gather(const std::vector<Entity*>& entities, const Camera* camera, float viewport_height);
+        void CompleteJobs();
+        void StartJobs();
+
+        // Gathered every tick
+        std::vector<TextureResidency> m_textures;
+        std::vector<RHI_Texture*> m_texture_ptrs;
+        std::unordered_map<uint32_t, uint32_t> m_texture_indices; // texture id -> index
+
+        // Streaming
+        std::vector<std::shared_ptr<Job>> m_jobs;
+        const uint32_t m_jobs_max   = 8;
+        uint64_t m_budget           = budget_default;
+        uint64_t m_bytes_resident   = 0;
+
+        // Dependencies
+        Context* m_context          = nullptr;
+        Profiler* m_profiler        = nullptr;
+        Threading* m_threading      = nullptr;
+        RHI_Device* m_rhi_device    = nullptr;
+    };
+}
@@ -0,0 +1,342 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "VertexQuantizer.h"
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <cmath>
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+#include "../Math/Quaternion.h"
+#include "../RHI/RHI_Vertex.h"
+//============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::vertex_quantizer
+{
+    static const float snorm_max = 32767.0f;
+
+    // What the input assembler does with a 16 bit snorm
+    inline float snorm_to_float(const int16_t value) { return max(static_cast<float>(value) / snorm_max, -1.0f); }
+    inline int16_t float_to_snorm(const float value) { return static_cast<int16_t>(round(clamp(value, -1.0f, 1.0f) * snorm_max)); }
+
+    // The largest extent, so that the scale is uniform, degenerate boxes (a single point) still get a valid transform
+    inline float get_scale(const BoundingBox& aabb)
+    {
+        const Vector3 extents   = aabb.GetExtents();
+        const float scale       = max(extents.x, max(extents.y, extents.z));
+        return scale > 0.0f ? scale : 1.0f;
+    }
+
+    // The lower hemisphere is folded over the diagonals
+    inline Vector2 octahedral_project(const Vector3& direction)
+    {
+        const float length = abs(direction.x) + abs(direction.y) + abs(direction.z);
+        if (length == 0.0f)
+            return Vector2::Zero;
+
+        Vector2 projected = Vector2(direction.x / length, direction.y / length);
+        if (direction.z < 0.0f)
+        {
+            projected = Vector2
+            (
+                (1.0f - abs(projected.y)) * (projected.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - abs(projected.x)) * (projected.y >= 0.0f ? 1.0f : -1.0f)
+            );
+        }
+
+        return projected;
+    }
+}
+
+namespace Spartan
+{
+    using namespace vertex_quantizer;
+
+    bool VertexQuantizer::IsSuitable(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count)
+    {
+        if (!vertices || vertex_count == 0)
+            return false;
+
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            if (!(abs(vertices[i].tex[0]) <= uv_max && abs(vertices[i].tex[1]) <= uv_max)) // also rejects NaN
+                return false;
+        }
+
+        return true;
+    }
+
+    void VertexQuantizer::Quantize(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t vertex_count, const BoundingBox& aabb, RHI_Vertex_PosTexNorTan16* destination)
+    {
+        if (!vertices || !destination)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        const Vector3 center    = aabb.GetCenter();
+        const float scale       = 1.0f / get_scale(aabb);
+
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const RHI_Vertex_PosTexNorTan& vertex   = vertices[i];
+            RHI_Vertex_PosTexNorTan16& quantized    = destination[i];
+
+            quantized.pos[0] = float_to_snorm((vertex.pos[0] - center.x) * scale);
+            quantized.pos[1] = float_to_snorm((vertex.pos[1] - center.y) * scale);
+            quantized.pos[2] = float_to_snorm((vertex.pos[2] - center.z) * scale);
+            quantized.pos[3] = static_cast<int16_t>(snorm_max);
+            quantized.tex[0] = FloatToHalf(vertex.tex[0]);
+            quantized.tex[1] = FloatToHalf(vertex.tex[1]);
+            OctahedralEncode(Vector3(vertex.nor[0], vertex.nor[1], vertex.nor[2]), quantized.nor);
+            OctahedralEncode(Vector3(vertex.tan[0], vertex.tan[1], vertex.tan[2]), quantized.tan);
+        }
+    }
+
+    Matrix VertexQuantizer::GetDequantizeTransform(const BoundingBox& aabb)
+    {
+        return Matrix(aabb.GetCenter(), Quaternion::Identity, Vector3(get_scale(aabb)));
+    }
+
+    RHI_Vertex_PosTexNorTan VertexQuantizer::Dequantize(const RHI_Vertex_PosTexNorTan16& vertex, const BoundingBox& aabb)
+    {
+        const Vector3 position = Vector3(snorm_to_float(vertex.pos[0]), snorm_to_float(vertex.pos[1]), snorm_to_float(vertex.pos[2])) * GetDequantizeTransform(aabb);
+
+        return RHI_Vertex_PosTexNorTan
+        (
+            position,
+            Vector2(HalfToFloat(vertex.tex[0]), HalfToFloat(vertex.tex[1])),
+            OctahedralDecode(vertex.nor),
+            OctahedralDecode(vertex.tan)
+        );
+    }
+
+    uint16_t VertexQuantizer::FloatToHalf(const float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        const uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t magnitude  = bits & 0x7FFFFFFF;
+
+        // Infinity and NaN (which stays a NaN)
+        if (magnitude >= 0x7F800000)
+            return static_cast<uint16_t>(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x0200 : 0));
+
+        // Past halfway between the largest half (65504) and the next power of two
+        if (magnitude >= 0x477FF000)
+            return static_cast<uint16_t>(sign | 0x7C00);
+
+        // Below the smallest normal half, the implicit bit is shifted in and anything up to half the smallest denormal is zero
+        if (magnitude < 0x38800000)
+        {
+            if (magnitude <= 0x33000000)
+                return static_cast<uint16_t>(sign);
+
+            const uint32_t exponent     = magnitude >> 23;
+            const uint32_t mantissa     = (magnitude & 0x007FFFFF) | 0x00800000;
+            const uint32_t shift        = 126 - exponent;
+            const uint32_t remainder    = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway      = 1u << (shift - 1);
+            uint32_t half               = mantissa >> shift;
+            half += (remainder > halfway || (remainder == halfway && (half & 1))) ? 1 : 0;
+
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        // Rebias the exponent and round the 13 bits of mantissa which don't fit, a carry correctly moves to the exponent
+        magnitude -= (127 - 15) << 23;
+        const uint32_t remainder    = magnitude & 0x1FFF;
+        uint32_t half               = magnitude >> 13;
+        half += (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) ? 1 : 0;
+
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    float VertexQuantizer::HalfToFloat(const uint16_t value)
+    {
+        const uint32_t sign     = static_cast<uint32_t>(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x03FF;
+
+        // Denormal, which is a normal float
+        if (exponent == 0)
+        {
+            const float magnitude = static_cast<float>(mantissa) / 16777216.0f; // 2^-24
+            return sign ? -magnitude : magnitude;
+        }
+
+        const uint32_t bits = sign | (exponent == 31 ? 0x7F800000 | (mantissa << 13) : ((exponent + 127 - 15) << 23) | (mantissa << 13));
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void VertexQuantizer::OctahedralEncode(const Vector3& direction, int16_t* destination)
+    {
+        const Vector2 projected = octahedral_project(direction);
+        const Vector3 normal    = direction.Normalized();
+
+        // Rounding each component on its own isn't the closest encoding, so try the neighbours and keep the one which decodes closest
+        const float base[2] = { floor(clamp(projected.x, -1.0f, 1.0f) * snorm_max), floor(clamp(projected.y, -1.0f, 1.0f) * snorm_max) };
+        float best_dot      = -2.0f;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            const int16_t candidate[2] =
+            {
+                static_cast<int16_t>(clamp(base[0] + static_cast<float>(i & 1), -snorm_max, snorm_max)),
+                static_cast<int16_t>(clamp(base[1] + static_cast<float>(i >> 1), -snorm_max, snorm_max))
+            };
+
+            const float dot = Vector3::Dot(OctahedralDecode(candidate), normal);
+            if (dot > best_dot)
+            {
+                best_dot        = dot;
+                destination[0]  = candidate[0];
+                destination[1]  = candidate[1];
+            }
+        }
+    }
+
+    Vector3 VertexQuantizer::OctahedralDecode(const int16_t* encoded)
+    {
+        // The same as octahedral_decode() in Common_Vertex.hlsl
+        Vector3 direction   = Vector3(snorm_to_float(encoded[0]), snorm_to_float(encoded[1]), 0.0f);
+        direction.z         = 1.0f - abs(direction.x) - abs(direction.y);
+        const float fold    = max(-direction.z, 0.0f);
+        direction.x         += direction.x >= 0.0f ? -fold : fold;
+        direction.y         += direction.y >= 0.0f ? -fold : fold;
+
+        return direction.Normalized();
+    }
+
+    bool VertexQuantizer::Benchmark(const uint32_t vertex_count /*= 1000000*/)
+    {
+        bool valid = true;
+        const auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        // Every half float (except NaNs, which have more than one encoding) goes through a float and back unchanged
+        bool half_exact = true;
+        for (uint32_t i = 0; i <= 0xFFFF; i++)
+        {
+            const uint16_t half = static_cast<uint16_t>(i);
+            if ((half & 0x7C00) != 0x7C00 || (half & 0x03FF) == 0)
+            {
+                half_exact = half_exact && FloatToHalf(HalfToFloat(half)) == half;
+            }
+        }
+        check(half_exact, "every half float survives a round trip");
+        check(FloatToHalf(65504.0f) == 0x7BFF && FloatToHalf(65520.0f) == 0x7C00 && FloatToHalf(-1e9f) == 0xFC00, "half floats overflow to infinity");
+        check(FloatToHalf(1.0f + 1.0f / 2048.0f) == 0x3C00 && FloatToHalf(1.0f + 3.0f / 2048.0f) == 0x3C02, "half floats round to nearest even");
+        check(FloatToHalf(1e-8f) == 0 && FloatToHalf(-1e-8f) == 0x8000, "half floats flush to signed zero below the smallest denormal");
+
+        // Random vertices in a box which is far from the origin and not a cube, random directions and uvs in the suitable range
+        mt19937 generator(1337);
+        uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        const Vector3 center    = Vector3(1000.0f, -50.0f, 20.0f);
+        const Vector3 extents   = Vector3(20.0f, 5.0f, 60.0f);
+        const auto random_direction = [&]()
+        {
+            Vector3 direction;
+            do { direction = Vector3(distribution(generator), distribution(generator), distribution(generator)); } while (direction.LengthSquared() < 0.01f || direction.LengthSquared() > 1.0f);
+            return direction.Normalized();
+        };
+
+        vector<RHI_Vertex_PosTexNorTan> vertices(vertex_count);
+        for (RHI_Vertex_PosTexNorTan& vertex : vertices)
+        {
+            const Vector3 position = center + Vector3(distribution(generator) * extents.x, distribution(generator) * extents.y, distribution(generator) * extents.z);
+            vertex = RHI_Vertex_PosTexNorTan(position, Vector2(distribution(generator) * uv_max, distribution(generator) * uv_max), random_direction(), random_direction());
+        }
+        // The axes, the diagonals and the folded corners of the octahedron are where the encoding is most likely to go wrong
+        const Vector3 directions[] = { Vector3::Right, Vector3::Left, Vector3::Up, Vector3::Down, Vector3::Forward, Vector3::Backward, Vector3(1.0f, 1.0f, -1.0f), Vector3(-1.0f, 1.0f, -1.0f), Vector3(1.0f, -1.0f, -1.0f), Vector3(-1.0f, -1.0f, 1.0f) };
+        for (uint32_t i = 0; i < min(vertex_count, static_cast<uint32_t>(sizeof(directions) / sizeof(directions[0]))); i++)
+        {
+            const Vector3 direction = directions[i].Normalized();
+            memcpy(vertices[i].nor, &direction.x, sizeof(vertices[i].nor));
+        }
+        const BoundingBox aabb = BoundingBox(vertices.data(), vertex_count);
+
+        check(IsSuitable(vertices.data(), vertex_count), "uvs within the range are suitable");
+        RHI_Vertex_PosTexNorTan unsuitable = vertices.front();
+        unsuitable.tex[1] = uv_max * 2.0f;
+        check(!IsSuitable(&unsuitable, 1), "uvs outside of the range aren't suitable");
+
+        vector<RHI_Vertex_PosTexNorTan16> quantized(vertex_count);
+        Stopwatch timer;
+        Quantize(vertices.data(), vertex_count, aabb, quantized.data());
+        const float time_quantize = timer.GetElapsedTimeMs();
+
+        // The errors, positions relative to the largest extent, directions in degrees
+        float error_position    = 0.0f;
+        float error_uv          = 0.0f;
+        float error_normal      = 0.0f;
+        float error_tangent     = 0.0f;
+        const auto error_angle  = [](const float* a, const Vector3& b) { return atan2(Vector3::Cross(Vector3(a[0], a[1], a[2]), b).Length(), Vector3::Dot(Vector3(a[0], a[1], a[2]), b)) * 57.2957795f; }; // acos() isn't precise enough for small angles
+        timer.Start();
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            const RHI_Vertex_PosTexNorTan& vertex       = vertices[i];
+            const RHI_Vertex_PosTexNorTan dequantized   = Dequantize(quantized[i], aabb);
+
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                error_position = max(error_position, abs(dequantized.pos[axis] - vertex.pos[axis]));
+            }
+            for (uint32_t axis = 0; axis < 2; axis++)
+            {
+                error_uv = max(error_uv, abs(dequantized.tex[axis] - vertex.tex[axis]));
+            }
+            error_normal    = max(error_normal, error_angle(vertex.nor, Vector3(dequantized.nor[0], dequantized.nor[1], dequantized.nor[2])));
+            error_tangent   = max(error_tangent, error_angle(vertex.tan, Vector3(dequantized.tan[0], dequantized.tan[1], dequantized.tan[2])));
+        }
+        const float time_dequantize = timer.GetElapsedTimeMs();
+
+        // Half a step of each encoding, positions also get the float precision of where the box is
+        const float scale = aabb.GetExtents().z;
+        check(error_position <= scale / (2.0f * snorm_max) + center.Length() * 2.0f * numeric_limits<float>::epsilon(), "positions are within half a step of a 16 bit snorm across the largest extent");
+        check(error_uv <= uv_max / 2048.0f, "uvs are within half a step of a half float");
+        check(error_normal < 0.01f && error_tangent < 0.01f, "directions are within a hundredth of a degree");
+        check(sizeof(RHI_Vertex_PosTexNorTan16) * 2 < sizeof(RHI_Vertex_PosTexNorTan), "the vertices take less than half the memory");
+
+        LOG_INFO("%d vertices, %d bytes each instead of %d, quantized in %.2f ms, dequantized in %.2f ms", vertex_count, static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan16)), static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)), time_quantize, time_dequantize);
+        LOG_INFO("Largest error: position %.6f (%.2e of the largest extent), uv %.6f, normal %.5f degrees, tangent %.5f degrees", error_position, error_position / scale, error_uv, error_normal, error_tangent);
+        LOG_INFO("%s", valid ? "Vertex quantizer is valid" : "Vertex quantizer is invalid");
+
+        return valid;
+    }
+}
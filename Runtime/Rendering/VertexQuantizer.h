@@ -0,0 +1,62 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
+#include "../Math/Matrix.h"
+#include "../Math/BoundingBox.h"
+//===================================
+
+namespace Spartan
+{
+    // Packs RHI_Vertex_PosTexNorTan (44 bytes) into RHI_Vertex_PosTexNorTan16 (20 bytes), for static meshes:
+    // - Position: 16 bit snorm, relative to the center of the bounding box and scaled by its largest extent. The scale is uniform,
+    //   so the dequantization is a transform which goes in front of the object's transform without affecting the normals.
+    // - Texture coordinates: half floats, which are only precise enough for coordinates which don't repeat too many times.
+    // - Normal and tangent: 16 bit snorm octahedral (Cigolle et al. 2014), picking whichever of the neighbouring encodings decodes closest.
+    //   There is no bitangent sign, the shaders rebuild the bitangent from the normal and the tangent.
+    // The inputs of the vertex shader are converted by the input assembler, so the shaders only have to decode the normal and the tangent.
+    class SPARTAN_CLASS VertexQuantizer
+    {
+    public:
+        static constexpr float uv_max = 4.0f; // half floats have a step of 1/512 up to here, which is a texel on a 512 texture
+
+        // Whether the vertices keep their precision once quantized
+        static bool IsSuitable(const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count);
+        static void Quantize(const RHI_Vertex_PosTexNorTan* vertices, uint32_t vertex_count, const Math::BoundingBox& aabb, RHI_Vertex_PosTexNorTan16* destination);
+        // Takes quantized positions back to where they were
+        static Math::Matrix GetDequantizeTransform(const Math::BoundingBox& aabb);
+        // What the vertex shaders see, for validation
+        static RHI_Vertex_PosTexNorTan Dequantize(const RHI_Vertex_PosTexNorTan16& vertex, const Math::BoundingBox& aabb);
+
+        // Encoding
+        static uint16_t FloatToHalf(float value); // rounds to nearest even
+        static float HalfToFloat(uint16_t value);
+        static void OctahedralEncode(const Math::Vector3& direction, int16_t* destination);
+        static Math::Vector3 OctahedralDecode(const int16_t* encoded);
+
+        // Round trips random vertices and all 65536 half floats
+        static bool Benchmark(uint32_t vertex_count = 1000000);
+    };
+}
@@ -0,0 +1,969 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "BlockCompressor.h"
+#include <cmath>
+#include <random>
+#include <cfloat>
+#include <cstring>
+#include <algorithm>
+#include "../../Core/Stopwatch.h"
+#include "../../Logging/Log.h"
+#include "../../Threading/Threading.h"
+//======================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::block_compressor
+{
+    // A 4x4 tile, as floats so that fitting doesn't quantize
+    struct Tile
+    {
+        float pixels[16][4];
+    };
+
+    // BC7 weights of 4 bit indices, out of 64
+    static const int bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    inline float clamp_255(const float value) { return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value); }
+
+    inline void load_tile(const uint8_t* pixels, const uint32_t width, const uint32_t height, const uint32_t block_x, const uint32_t block_y, Tile& tile)
+    {
+        // Tiles which go past the edge repeat the last row and column
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                const uint32_t pixel_x  = min(block_x * 4 + x, width - 1);
+                const uint32_t pixel_y  = min(block_y * 4 + y, height - 1);
+                const uint8_t* pixel    = pixels + (static_cast<size_t>(pixel_y) * width + pixel_x) * 4;
+
+                for (uint32_t channel = 0; channel < 4; channel++)
+                {
+                    tile.pixels[y * 4 + x][channel] = pixel[channel];
+                }
+            }
+        }
+    }
+
+    // End points are the extremes of the projections of the pixels onto the principal axis
+    inline void fit_principal_axis(const Tile& tile, const uint32_t channels, const bool* mask, float end_point_0[4], float end_point_1[4])
+    {
+        float mean[4]   = {};
+        float count     = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (mask && !mask[i])
+                continue;
+
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                mean[c] += tile.pixels[i][c];
+            }
+            count++;
+        }
+
+        if (count == 0.0f)
+        {
+            fill(end_point_0, end_point_0 + 4, 0.0f);
+            fill(end_point_1, end_point_1 + 4, 0.0f);
+            return;
+        }
+
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            mean[c] /= count;
+        }
+
+        float covariance[4][4] = {};
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (mask && !mask[i])
+                continue;
+
+            for (uint32_t a = 0; a < channels; a++)
+            {
+                for (uint32_t b = 0; b < channels; b++)
+                {
+                    covariance[a][b] += (tile.pixels[i][a] - mean[a]) * (tile.pixels[i][b] - mean[b]);
+                }
+            }
+        }
+
+        // Power iteration, starting from the row of the channel with the largest variance (so it's never orthogonal to the axis)
+        uint32_t channel_max = 0;
+        for (uint32_t c = 1; c < channels; c++)
+        {
+            channel_max = covariance[c][c] > covariance[channel_max][channel_max] ? c : channel_max;
+        }
+
+        float axis[4] = {};
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            axis[c] = covariance[channel_max][c];
+        }
+
+        for (uint32_t iteration = 0; iteration < 8; iteration++)
+        {
+            float axis_next[4]  = {};
+            float length        = 0.0f;
+            for (uint32_t a = 0; a < channels; a++)
+            {
+                for (uint32_t b = 0; b < channels; b++)
+                {
+                    axis_next[a] += covariance[a][b] * axis[b];
+                }
+                length += axis_next[a] * axis_next[a];
+            }
+
+            if (length < FLT_EPSILON)
+                break;
+
+            length = sqrt(length);
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                axis[c] = axis_next[c] / length;
+            }
+        }
+
+        float projection_min = FLT_MAX;
+        float projection_max = -FLT_MAX;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (mask && !mask[i])
+                continue;
+
+            float projection = 0.0f;
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                projection += (tile.pixels[i][c] - mean[c]) * axis[c];
+            }
+            projection_min = min(projection_min, projection);
+            projection_max = max(projection_max, projection);
+        }
+
+        // A flat tile has no axis, both end points are its color
+        if (projection_min > projection_max)
+        {
+            projection_min = projection_max = 0.0f;
+        }
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            end_point_0[c] = c < channels ? clamp_255(mean[c] + axis[c] * projection_min) : 255.0f;
+            end_point_1[c] = c < channels ? clamp_255(mean[c] + axis[c] * projection_max) : 255.0f;
+        }
+    }
+
+    // Least squares end points, given how far along (0 to 1) each pixel was placed
+    inline bool refine_end_points(const Tile& tile, const uint32_t channels, const bool* mask, const float weights[16], float end_point_0[4], float end_point_1[4])
+    {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float x[4] = {}, y[4] = {};
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (mask && !mask[i])
+                continue;
+
+            const float w   = weights[i];
+            const float w_1 = 1.0f - w;
+            a += w_1 * w_1;
+            b += w_1 * w;
+            c += w * w;
+            for (uint32_t channel = 0; channel < channels; channel++)
+            {
+                x[channel] += w_1 * tile.pixels[i][channel];
+                y[channel] += w * tile.pixels[i][channel];
+            }
+        }
+
+        const float determinant = a * c - b * b;
+        if (fabs(determinant) < 1e-4f)
+            return false;
+
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            end_point_0[channel] = clamp_255((c * x[channel] - b * y[channel]) / determinant);
+            end_point_1[channel] = clamp_255((a * y[channel] - b * x[channel]) / determinant);
+        }
+
+        return true;
+    }
+
+    //= BC1 (and the color of BC3) ========================================================================================
+    inline uint16_t to_565(const float color[4])
+    {
+        const uint32_t r = static_cast<uint32_t>(clamp_255(color[0]) * 31.0f / 255.0f + 0.5f);
+        const uint32_t g = static_cast<uint32_t>(clamp_255(color[1]) * 63.0f / 255.0f + 0.5f);
+        const uint32_t b = static_cast<uint32_t>(clamp_255(color[2]) * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    inline void from_565(const uint16_t value, int color[3])
+    {
+        const int r = (value >> 11) & 31;
+        const int g = (value >> 5) & 63;
+        const int b = value & 31;
+        color[0]    = (r << 3) | (r >> 2);
+        color[1]    = (g << 2) | (g >> 4);
+        color[2]    = (b << 3) | (b >> 2);
+    }
+
+    // The palette as the GPU decodes it, BC1 has a 3 color mode (with transparent black) when color_0 <= color_1
+    inline uint32_t get_palette_color(const uint16_t color_0, const uint16_t color_1, const bool always_four_colors, int palette[4][4])
+    {
+        int a[3], b[3];
+        from_565(color_0, a);
+        from_565(color_1, b);
+
+        const bool four_colors = always_four_colors || color_0 > color_1;
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            palette[0][c] = a[c];
+            palette[1][c] = b[c];
+            palette[2][c] = four_colors ? (2 * a[c] + b[c]) / 3 : (a[c] + b[c]) / 2;
+            palette[3][c] = four_colors ? (a[c] + 2 * b[c]) / 3 : 0;
+        }
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = four_colors ? 255 : 0;
+
+        return four_colors ? 4 : 3;
+    }
+
+    inline float select_indices_color(const Tile& tile, const int palette[4][4], const uint32_t palette_size, const bool* mask, uint8_t indices[16])
+    {
+        float error_total = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            // Transparent pixels of a 3 color block use the transparent entry
+            if (mask && !mask[i])
+            {
+                indices[i] = 3;
+                continue;
+            }
+
+            float error_best = FLT_MAX;
+            for (uint32_t p = 0; p < palette_size; p++)
+            {
+                float error = 0.0f;
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    const float d = tile.pixels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+
+                if (error < error_best)
+                {
+                    error_best  = error;
+                    indices[i]  = static_cast<uint8_t>(p);
+                }
+            }
+            error_total += error_best;
+        }
+
+        return error_total;
+    }
+
+    inline void encode_color(const Tile& tile, const bool is_bc3, uint8_t* block)
+    {
+        // BC1 pixels with less than half alpha become transparent, which needs the 3 color mode
+        bool mask[16];
+        bool punch_through = false;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            mask[i]         = is_bc3 || tile.pixels[i][3] >= 128.0f;
+            punch_through   = punch_through || !mask[i];
+        }
+
+        float end_point_0[4], end_point_1[4];
+        fit_principal_axis(tile, 3, mask, end_point_0, end_point_1);
+
+        float error_best        = FLT_MAX;
+        uint16_t color_0_best   = 0;
+        uint16_t color_1_best   = 0;
+        uint8_t indices_best[16] = {};
+        for (uint32_t iteration = 0; iteration < 3; iteration++)
+        {
+            uint16_t color_0 = to_565(end_point_0);
+            uint16_t color_1 = to_565(end_point_1);
+
+            // The order of the end points selects the mode
+            if ((punch_through && color_0 > color_1) || (!punch_through && color_0 < color_1))
+            {
+                swap(color_0, color_1);
+            }
+
+            int palette[4][4];
+            const uint32_t palette_size = get_palette_color(color_0, color_1, is_bc3, palette);
+
+            uint8_t indices[16];
+            const float error = select_indices_color(tile, palette, punch_through ? 3 : palette_size, punch_through ? mask : nullptr, indices);
+            if (error < error_best)
+            {
+                error_best      = error;
+                color_0_best    = color_0;
+                color_1_best    = color_1;
+                memcpy(indices_best, indices, sizeof(indices));
+            }
+
+            if (error_best == 0.0f)
+                break;
+
+            // Refit the end points to where the pixels landed
+            float weights[16];
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                static const float weights_four[4]  = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+                static const float weights_three[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+                weights[i] = palette_size == 4 ? weights_four[indices[i]] : weights_three[indices[i]];
+            }
+
+            if (!refine_end_points(tile, 3, mask, weights, end_point_0, end_point_1))
+                break;
+        }
+
+        uint32_t index_bits = 0;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            index_bits |= static_cast<uint32_t>(indices_best[i]) << (i * 2);
+        }
+
+        block[0] = static_cast<uint8_t>(color_0_best & 0xFF);
+        block[1] = static_cast<uint8_t>(color_0_best >> 8);
+        block[2] = static_cast<uint8_t>(color_1_best & 0xFF);
+        block[3] = static_cast<uint8_t>(color_1_best >> 8);
+        memcpy(block + 4, &index_bits, sizeof(index_bits));
+    }
+
+    inline void decode_color(const uint8_t* block, const bool is_bc3, uint8_t pixels[16][4])
+    {
+        const uint16_t color_0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        const uint16_t color_1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+
+        int palette[4][4];
+        get_palette_color(color_0, color_1, is_bc3, palette);
+
+        uint32_t index_bits;
+        memcpy(&index_bits, block + 4, sizeof(index_bits));
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const uint32_t index = (index_bits >> (i * 2)) & 3;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                pixels[i][c] = static_cast<uint8_t>(palette[index][c]);
+            }
+        }
+    }
+    //=====================================================================================================================
+
+    //= BC4 (and the alpha of BC3, and the two channels of BC5) ===========================================================
+    inline void get_palette_channel(const int value_0, const int value_1, int palette[8])
+    {
+        palette[0] = value_0;
+        palette[1] = value_1;
+
+        if (value_0 > value_1)
+        {
+            for (int i = 2; i < 8; i++)
+            {
+                palette[i] = ((8 - i) * value_0 + (i - 1) * value_1 + 3) / 7;
+            }
+        }
+        else
+        {
+            for (int i = 2; i < 6; i++)
+            {
+                palette[i] = ((6 - i) * value_0 + (i - 1) * value_1 + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    inline void encode_channel(const Tile& tile, const uint32_t channel, uint8_t* block)
+    {
+        float value_min = 255.0f;
+        float value_max = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            value_min = min(value_min, tile.pixels[i][channel]);
+            value_max = max(value_max, tile.pixels[i][channel]);
+        }
+
+        // The 8 value mode needs value_0 > value_1, a flat tile is exact with either mode
+        const int value_0 = static_cast<int>(value_max + 0.5f);
+        const int value_1 = static_cast<int>(value_min + 0.5f);
+
+        int palette[8];
+        get_palette_channel(value_0, value_1, palette);
+
+        uint64_t index_bits = 0;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint64_t index_best = 0;
+            float error_best    = FLT_MAX;
+            for (uint32_t p = 0; p < 8; p++)
+            {
+                const float error = fabs(tile.pixels[i][channel] - palette[p]);
+                if (error < error_best)
+                {
+                    error_best = error;
+                    index_best = p;
+                }
+            }
+            index_bits |= index_best << (i * 3);
+        }
+
+        block[0] = static_cast<uint8_t>(value_0);
+        block[1] = static_cast<uint8_t>(value_1);
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            block[2 + i] = static_cast<uint8_t>((index_bits >> (i * 8)) & 0xFF);
+        }
+    }
+
+    inline void decode_channel(const uint8_t* block, const uint32_t channel, uint8_t pixels[16][4])
+    {
+        int palette[8];
+        get_palette_channel(block[0], block[1], palette);
+
+        uint64_t index_bits = 0;
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            index_bits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            pixels[i][channel] = static_cast<uint8_t>(palette[(index_bits >> (i * 3)) & 7]);
+        }
+    }
+    //=====================================================================================================================
+
+    //= BC7 (mode 6) ======================================================================================================
+    inline void write_bits(uint8_t* block, uint32_t& position, const uint32_t value, const uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++, position++)
+        {
+            if ((value >> i) & 1)
+            {
+                block[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+            }
+        }
+    }
+
+    inline uint32_t read_bits(const uint8_t* block, uint32_t& position, const uint32_t count)
+    {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; i++, position++)
+        {
+            value |= static_cast<uint32_t>((block[position >> 3] >> (position & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+    inline int interpolate_bc7(const int value_0, const int value_1, const uint32_t index)
+    {
+        return ((64 - bc7_weights[index]) * value_0 + bc7_weights[index] * value_1 + 32) >> 6;
+    }
+
+    // Each end point is 7 bits per channel plus a p-bit which is shared by its channels
+    inline float select_indices_bc7(const Tile& tile, const int end_point_0[4], const int end_point_1[4], uint8_t indices[16])
+    {
+        int palette[16][4];
+        for (uint32_t p = 0; p < 16; p++)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                palette[p][c] = interpolate_bc7(end_point_0[c], end_point_1[c], p);
+            }
+        }
+
+        float error_total = 0.0f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float error_best = FLT_MAX;
+            for (uint32_t p = 0; p < 16; p++)
+            {
+                float error = 0.0f;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    const float d = tile.pixels[i][c] - palette[p][c];
+                    error += d * d;
+                }
+
+                if (error < error_best)
+                {
+                    error_best  = error;
+                    indices[i]  = static_cast<uint8_t>(p);
+                }
+            }
+            error_total += error_best;
+        }
+
+        return error_total;
+    }
+
+    inline void encode_bc7(const Tile& tile, uint8_t* block)
+    {
+        float end_point_0[4], end_point_1[4];
+        fit_principal_axis(tile, 4, nullptr, end_point_0, end_point_1);
+
+        float error_best            = FLT_MAX;
+        int quantized_best[2][4]    = {};
+        uint32_t p_bits_best[2]     = {};
+        uint8_t indices_best[16]    = {};
+        for (uint32_t iteration = 0; iteration < 2; iteration++)
+        {
+            // Every combination of p-bits, since they move all the channels of an end point
+            for (uint32_t p_bit_0 = 0; p_bit_0 < 2; p_bit_0++)
+            {
+                for (uint32_t p_bit_1 = 0; p_bit_1 < 2; p_bit_1++)
+                {
+                    int quantized[2][4];
+                    int end_point_0_decoded[4], end_point_1_decoded[4];
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        quantized[0][c]         = min(max(static_cast<int>((end_point_0[c] - p_bit_0) * 0.5f + 0.5f), 0), 127);
+                        quantized[1][c]         = min(max(static_cast<int>((end_point_1[c] - p_bit_1) * 0.5f + 0.5f), 0), 127);
+                        end_point_0_decoded[c]  = (quantized[0][c] << 1) | p_bit_0;
+                        end_point_1_decoded[c]  = (quantized[1][c] << 1) | p_bit_1;
+                    }
+
+                    uint8_t indices[16];
+                    const float error = select_indices_bc7(tile, end_point_0_decoded, end_point_1_decoded, indices);
+                    if (error < error_best)
+                    {
+                        error_best      = error;
+                        p_bits_best[0]  = p_bit_0;
+                        p_bits_best[1]  = p_bit_1;
+                        memcpy(quantized_best, quantized, sizeof(quantized));
+                        memcpy(indices_best, indices, sizeof(indices));
+                    }
+                }
+            }
+
+            if (error_best == 0.0f)
+                break;
+
+            float weights[16];
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                weights[i] = bc7_weights[indices_best[i]] / 64.0f;
+            }
+
+            if (!refine_end_points(tile, 4, nullptr, weights, end_point_0, end_point_1))
+                break;
+        }
+
+        // The most significant bit of the first index is implied to be 0, swap the end points if it isn't
+        if (indices_best[0] & 8)
+        {
+            swap(quantized_best[0], quantized_best[1]);
+            swap(p_bits_best[0], p_bits_best[1]);
+            for (uint8_t& index : indices_best)
+            {
+                index = 15 - index;
+            }
+        }
+
+        memset(block, 0, 16);
+        uint32_t position = 0;
+        write_bits(block, position, 1 << 6, 7); // mode 6
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            write_bits(block, position, quantized_best[0][c], 7);
+            write_bits(block, position, quantized_best[1][c], 7);
+        }
+        write_bits(block, position, p_bits_best[0], 1);
+        write_bits(block, position, p_bits_best[1], 1);
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            write_bits(block, position, indices_best[i], i == 0 ? 3 : 4);
+        }
+    }
+
+    inline bool decode_bc7(const uint8_t* block, uint8_t pixels[16][4])
+    {
+        // Only mode 6 is produced by the encoder
+        uint32_t position = 0;
+        if (read_bits(block, position, 7) != (1 << 6))
+            return false;
+
+        int quantized[2][4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            quantized[0][c] = read_bits(block, position, 7);
+            quantized[1][c] = read_bits(block, position, 7);
+        }
+        const uint32_t p_bit_0 = read_bits(block, position, 1);
+        const uint32_t p_bit_1 = read_bits(block, position, 1);
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const uint32_t index = read_bits(block, position, i == 0 ? 3 : 4);
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                pixels[i][c] = static_cast<uint8_t>(interpolate_bc7((quantized[0][c] << 1) | p_bit_0, (quantized[1][c] << 1) | p_bit_1, index));
+            }
+        }
+
+        return true;
+    }
+    //=====================================================================================================================
+
+    inline void encode_block(const Tile& tile, const RHI_Format format, uint8_t* block)
+    {
+        switch (format)
+        {
+            case RHI_Format_BC1_Unorm: encode_color(tile, false, block);                                    break;
+            case RHI_Format_BC3_Unorm: encode_channel(tile, 3, block); encode_color(tile, true, block + 8);  break;
+            case RHI_Format_BC4_Unorm: encode_channel(tile, 0, block);                                      break;
+            case RHI_Format_BC5_Unorm: encode_channel(tile, 0, block); encode_channel(tile, 1, block + 8);  break;
+            case RHI_Format_BC7_Unorm: encode_bc7(tile, block);                                             break;
+            default:                                                                                        break;
+        }
+    }
+
+    inline bool decode_block(const uint8_t* block, const RHI_Format format, uint8_t pixels[16][4])
+    {
+        // Channels which the format doesn't store decode as they would on the GPU
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            pixels[i][0] = pixels[i][1] = pixels[i][2] = 0;
+            pixels[i][3] = 255;
+        }
+
+        switch (format)
+        {
+            case RHI_Format_BC1_Unorm: decode_color(block, false, pixels);                                          return true;
+            case RHI_Format_BC3_Unorm: decode_color(block + 8, true, pixels); decode_channel(block, 3, pixels);      return true;
+            case RHI_Format_BC4_Unorm: decode_channel(block, 0, pixels);                                            return true;
+            case RHI_Format_BC5_Unorm: decode_channel(block, 0, pixels); decode_channel(block + 8, 1, pixels);      return true;
+            case RHI_Format_BC7_Unorm: return decode_bc7(block, pixels);
+            default:                   return false;
+        }
+    }
+
+    // The channels which a format stores
+    inline uint32_t get_channel_mask(const RHI_Format format)
+    {
+        switch (format)
+        {
+            case RHI_Format_BC1_Unorm: return 0b0111;
+            case RHI_Format_BC4_Unorm: return 0b0001;
+            case RHI_Format_BC5_Unorm: return 0b0011;
+            default:                   return 0b1111;
+        }
+    }
+}
+
+namespace Spartan
+{
+    RHI_Format BlockCompressor::GetFormat(const RHI_Texture_Compression compression, const bool transparent, const bool grayscale)
+    {
+        switch (compression)
+        {
+            case RHI_Texture_Compression_Color:     return transparent ? RHI_Format_BC7_Unorm : RHI_Format_BC1_Unorm;
+            case RHI_Texture_Compression_Normal:    return grayscale ? RHI_Format_BC4_Unorm : RHI_Format_BC5_Unorm;
+            case RHI_Texture_Compression_Grayscale: return RHI_Format_BC4_Unorm;
+            default:                                return RHI_Format_Undefined;
+        }
+    }
+
+    bool BlockCompressor::Compress(vector<vector<std::byte>>& mips, const uint32_t width, const uint32_t height, const RHI_Format format, Threading* threading /*= nullptr*/)
+    {
+        if (mips.empty() || width == 0 || height == 0 || !rhi_format_is_block_compressed(format))
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        // Every row of tiles, of every mip, is a unit of work
+        struct Row
+        {
+            uint32_t mip;
+            uint32_t block_y;
+        };
+
+        const uint32_t block_size = rhi_format_block_size(format);
+        vector<vector<std::byte>> blocks(mips.size());
+        vector<Row> rows;
+        for (uint32_t mip = 0; mip < static_cast<uint32_t>(mips.size()); mip++)
+        {
+            const uint32_t mip_width  = max(width >> mip, 1u);
+            const uint32_t mip_height = max(height >> mip, 1u);
+            if (mips[mip].size() < static_cast<size_t>(mip_width) * mip_height * 4)
+            {
+                LOG_ERROR("Mip %d is not %dx%d RGBA8", mip, mip_width, mip_height);
+                return false;
+            }
+
+            const uint32_t block_count_y = (mip_height + 3) / 4;
+            blocks[mip].resize(static_cast<size_t>((mip_width + 3) / 4) * block_count_y * block_size);
+            for (uint32_t block_y = 0; block_y < block_count_y; block_y++)
+            {
+                rows.push_back({ mip, block_y });
+            }
+        }
+
+        const auto encode_rows = [&](const uint32_t start, const uint32_t end)
+        {
+            block_compressor::Tile tile;
+            for (uint32_t i = start; i < end; i++)
+            {
+                const Row& row              = rows[i];
+                const uint32_t mip_width    = max(width >> row.mip, 1u);
+                const uint32_t mip_height   = max(height >> row.mip, 1u);
+                const uint32_t block_count  = (mip_width + 3) / 4;
+                const uint8_t* pixels       = reinterpret_cast<const uint8_t*>(mips[row.mip].data());
+                uint8_t* row_blocks         = reinterpret_cast<uint8_t*>(blocks[row.mip].data()) + static_cast<size_t>(row.block_y) * block_count * block_size;
+
+                for (uint32_t block_x = 0; block_x < block_count; block_x++)
+                {
+                    block_compressor::load_tile(pixels, mip_width, mip_height, block_x, row.block_y, tile);
+                    block_compressor::encode_block(tile, format, row_blocks + static_cast<size_t>(block_x) * block_size);
+                }
+            }
+        };
+
+        if (threading)
+        {
+            threading->AddTaskLoop(encode_rows, static_cast<uint32_t>(rows.size()));
+        }
+        else
+        {
+            encode_rows(0, static_cast<uint32_t>(rows.size()));
+        }
+
+        mips = move(blocks);
+        return true;
+    }
+
+    bool BlockCompressor::Decompress(const vector<std::byte>& blocks, const uint32_t width, const uint32_t height, const RHI_Format format, vector<std::byte>& pixels)
+    {
+        const uint32_t block_size       = rhi_format_block_size(format);
+        const uint32_t block_count_x    = (width + 3) / 4;
+        const uint32_t block_count_y    = (height + 3) / 4;
+        if (!rhi_format_is_block_compressed(format) || blocks.size() < static_cast<size_t>(block_count_x) * block_count_y * block_size)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+        uint8_t* destination = reinterpret_cast<uint8_t*>(pixels.data());
+        for (uint32_t block_y = 0; block_y < block_count_y; block_y++)
+        {
+            for (uint32_t block_x = 0; block_x < block_count_x; block_x++)
+            {
+                uint8_t tile[16][4];
+                const uint8_t* block = reinterpret_cast<const uint8_t*>(blocks.data()) + (static_cast<size_t>(block_y) * block_count_x + block_x) * block_size;
+                if (!block_compressor::decode_block(block, format, tile))
+                {
+                    LOG_ERROR("Unsupported block at %dx%d", block_x, block_y);
+                    return false;
+                }
+
+                for (uint32_t y = 0; y < 4 && block_y * 4 + y < height; y++)
+                {
+                    for (uint32_t x = 0; x < 4 && block_x * 4 + x < width; x++)
+                    {
+                        memcpy(destination + ((static_cast<size_t>(block_y) * 4 + y) * width + block_x * 4 + x) * 4, tile[y * 4 + x], 4);
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    float BlockCompressor::ComputePsnr(const vector<std::byte>& pixels, const vector<std::byte>& pixels_decoded, const RHI_Format format)
+    {
+        if (pixels.size() != pixels_decoded.size() || pixels.empty())
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return 0.0f;
+        }
+
+        const uint32_t channel_mask = block_compressor::get_channel_mask(format);
+        double error_sum            = 0.0;
+        size_t sample_count         = 0;
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            if (channel_mask & (1u << (i % 4)))
+            {
+                const double d = static_cast<double>(pixels[i]) - static_cast<double>(pixels_decoded[i]);
+                error_sum += d * d;
+                sample_count++;
+            }
+        }
+
+        const double mse = error_sum / static_cast<double>(sample_count);
+        return mse == 0.0 ? 99.0f : static_cast<float>(10.0 * log10(255.0 * 255.0 / mse));
+    }
+
+    bool BlockCompressor::Benchmark(Threading* threading, const uint32_t size /*= 1024*/)
+    {
+        if (size < 4 || size % 4 != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        bool valid = true;
+        const auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        // Smooth gradients, a pattern, hard edges and noise, with a fixed seed so that runs are comparable
+        vector<std::byte> image(static_cast<size_t>(size) * size * 4);
+        {
+            mt19937 generator(1337);
+            uniform_int_distribution<int> noise(-6, 6);
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    const float u       = static_cast<float>(x) / size;
+                    const float v       = static_cast<float>(y) / size;
+                    const bool edge     = ((x / 32) + (y / 32)) % 2 == 0;
+                    const int pattern   = static_cast<int>(127.5f + 127.5f * sin(u * 40.0f) * cos(v * 25.0f));
+                    const int value[4]  =
+                    {
+                        static_cast<int>(u * 255.0f) + noise(generator),
+                        static_cast<int>(v * 255.0f) + noise(generator),
+                        (x < size / 2 ? pattern : (edge ? 220 : 40)) + noise(generator),
+                        static_cast<int>(128.0f + (1.0f - u * v) * 127.0f) // opaque for BC1
+                    };
+
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        image[(static_cast<size_t>(y) * size + x) * 4 + c] = static_cast<std::byte>(min(max(value[c], 0), 255));
+                    }
+                }
+            }
+        }
+
+        // The lowest acceptable quality, the image is harder than most textures since it's noisy
+        struct Case
+        {
+            RHI_Format format;
+            float psnr_min;
+        };
+        const Case cases[] =
+        {
+            { RHI_Format_BC1_Unorm, 35.0f },
+            { RHI_Format_BC3_Unorm, 36.0f },
+            { RHI_Format_BC4_Unorm, 45.0f },
+            { RHI_Format_BC5_Unorm, 45.0f },
+            { RHI_Format_BC7_Unorm, 38.0f }
+        };
+
+        for (const Case& test : cases)
+        {
+            vector<vector<std::byte>> mips = { image };
+            Stopwatch timer;
+            check(Compress(mips, size, size, test.format, threading), "the image compresses");
+            const float time_ms = timer.GetElapsedTimeMs();
+
+            check(mips[0].size() == static_cast<size_t>(size / 4) * (size / 4) * rhi_format_block_size(test.format), "the blocks have the size of the format");
+
+            // Encoding is deterministic, so splitting it over threads can't change the result
+            if (threading)
+            {
+                vector<vector<std::byte>> mips_serial = { image };
+                Compress(mips_serial, size, size, test.format, nullptr);
+                check(mips_serial[0] == mips[0], "threads produce the same blocks");
+            }
+
+            vector<std::byte> decoded;
+            check(Decompress(mips[0], size, size, test.format, decoded), "the blocks decompress");
+            const float psnr = decoded.size() == image.size() ? ComputePsnr(image, decoded, test.format) : 0.0f;
+            check(psnr >= test.psnr_min, "the quality is acceptable");
+
+            LOG_INFO("%s: %.2f ms, %.1f MPixels/s, PSNR %.2f dB", rhi_format_to_string(test.format), time_ms, (static_cast<float>(size) * size / 1000000.0f) / (time_ms / 1000.0f), psnr);
+        }
+
+        // A flat tile is exact, except for the precision of the end points
+        {
+            vector<std::byte> flat(4 * 4 * 4);
+            for (size_t i = 0; i < flat.size(); i += 4)
+            {
+                flat[i + 0] = static_cast<std::byte>(200);
+                flat[i + 1] = static_cast<std::byte>(100);
+                flat[i + 2] = static_cast<std::byte>(50);
+                flat[i + 3] = static_cast<std::byte>(255);
+            }
+
+            for (const RHI_Format format : { RHI_Format_BC4_Unorm, RHI_Format_BC5_Unorm, RHI_Format_BC7_Unorm })
+            {
+                vector<vector<std::byte>> mips = { flat };
+                vector<std::byte> decoded;
+                Compress(mips, 4, 4, format, nullptr);
+                Decompress(mips[0], 4, 4, format, decoded);
+                check(ComputePsnr(flat, decoded, format) >= 50.0f, "a flat tile is exact");
+            }
+        }
+
+        // Transparent BC1 pixels decode as transparent
+        {
+            vector<std::byte> cutout = image;
+            for (size_t i = 3; i < cutout.size(); i += 8)
+            {
+                cutout[i] = static_cast<std::byte>(0);
+            }
+
+            vector<vector<std::byte>> mips = { cutout };
+            vector<std::byte> decoded;
+            Compress(mips, size, size, RHI_Format_BC1_Unorm, nullptr);
+            Decompress(mips[0], size, size, RHI_Format_BC1_Unorm, decoded);
+
+            bool alpha_kept = true;
+            for (size_t i = 3; i < cutout.size(); i += 4)
+            {
+                alpha_kept = alpha_kept && ((static_cast<uint8_t>(cutout[i]) >= 128) == (static_cast<uint8_t>(decoded[i]) == 255));
+            }
+            check(alpha_kept, "BC1 keeps 1 bit alpha");
+        }
+
+        // Mips which aren't a multiple of 4 are padded
+        {
+            vector<vector<std::byte>> mips =
+            {
+                vector<std::byte>(static_cast<size_t>(4) * 4 * 4, static_cast<std::byte>(64)),
+                vector<std::byte>(static_cast<size_t>(2) * 2 * 4, static_cast<std::byte>(128))
+            };
+            check(Compress(mips, 4, 4, RHI_Format_BC7_Unorm, threading) && mips[1].size() == 16, "a 2x2 mip is a single block");
+        }
+
+        LOG_INFO("%s", valid ? "Block compression is valid" : "Block compression is invalid");
+        return valid;
+    }
+}
@@ -0,0 +1,52 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+namespace Spartan
+{
+    class Threading;
+
+    // CPU encoder for block compressed formats. Pixels are RGBA8, every 4x4 tile is encoded independently, so
+    // rows of tiles are spread over the threads. BC1/BC3/BC4/BC5 endpoints are fitted along the principal axis
+    // of the tile and refined with least squares, BC7 always uses mode 6 (one subset, RGBA, 16 indices).
+    class SPARTAN_CLASS BlockCompressor
+    {
+    public:
+        static RHI_Format GetFormat(const RHI_Texture_Compression compression, const bool transparent, const bool grayscale);
+
+        // Replaces RGBA8 mips (mip 0 is width x height) with their blocks, tiles of every mip are encoded in parallel
+        static bool Compress(std::vector<std::vector<std::byte>>& mips, uint32_t width, uint32_t height, RHI_Format format, Threading* threading = nullptr);
+        static bool Decompress(const std::vector<std::byte>& blocks, uint32_t width, uint32_t height, RHI_Format format, std::vector<std::byte>& pixels);
+
+        // Peak signal to noise ratio (in dB) of the channels the format stores
+        static float ComputePsnr(const std::vector<std::byte>& pixels, const std::vector<std::byte>& pixels_decoded, RHI_Format format);
+
+        // Encodes a generated image to every format, fails if any of them drops below its PSNR threshold
+        static bool Benchmark(Threading* threading, uint32_t size = 1024);
+    };
+}
@@ -25,9 +25,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ImageImporter.h"
 #include <FreeImage.h>
 #include <Utilities.h>
+#include "BlockCompressor.h"
+#include "MipGenerator.h"
 #include "../../Threading/Threading.h"
 #include "../../Core/Settings.h"
+#include "../../Core/Stopwatch.h"
 #include "../../Math/MathHelper.h"
+#include "../../Rendering/Renderer.h"
+#include "../../RHI/RHI_Device.h"
+#include "../../RHI/RHI_Implementation.h"
 #include "../../RHI/RHI_Texture2D.h"
 //====================================
 
@@ -39,6 +45,12 @@ namespace Spartan::freeimage_helper
 {
 	static FREE_IMAGE_FILTER rescale_filter = FILTER_LANCZOS3;
 
+    // Alpha below this is discarded by the mask test in GBuffer.hlsl, mips of transparent color textures keep the coverage it yields
+    static const float alpha_test_threshold = 0.6f;
+
+    // Part of the settings of every import, so increment it whenever the output of an import changes
+    static const uint32_t version = 1;
+
 	// A struct that rescaling threads will work with
 	struct RescaleJob
 	{
@@ -217,7 +229,21 @@ namespace Spartan
 		// If the texture supports mipmaps, generate them
 		if (generate_mipmaps)
 		{
-			GenerateMipmaps(bitmap, texture, image_width, image_height, image_channel_count);
+            // Each mip is downsampled from the previous one, FreeImage (which rescales the full image for every mip) is the fallback
+            if (MipGenerator::IsSupported(image_format))
+            {
+                // Only textures which a material samples as color are known to be sRGB, anything else (data maps, or textures
+                // which haven't been assigned to a material slot) is filtered linearly
+                const bool is_color                         = texture->GetCompression() == RHI_Texture_Compression_Color;
+                const bool is_srgb                          = is_color && image_format == RHI_Format_R8G8B8A8_Unorm;
+                const float alpha_coverage_threshold        = is_color && image_is_transparent ? freeimage_helper::alpha_test_threshold : 0.0f;
+
+                MipGenerator::Generate(texture->GetData(), image_width, image_height, image_format, is_srgb, alpha_coverage_threshold, m_context->GetSubsystem<Threading>());
+            }
+            else
+            {
+                GenerateMipmaps(bitmap, texture->GetData(), image_width, image_height, image_channel_count);
+            }
 		}
 
 		// Free memory 
@@ -232,9 +258,102 @@ namespace Spartan
 		texture->SetFormat(image_format);
 		texture->SetGrayscale(image_is_grayscale);
 
+        // Block compress (if requested and possible)
+        if (texture->GetCompression() != RHI_Texture_Compression_None)
+        {
+            CompressTexture(texture, image_is_transparent, image_is_grayscale);
+        }
+
 		return true;
 	}
 
+    string ImageImporter::GetSettings(const RHI_Texture* texture, const bool generate_mipmaps) const
+    {
+        // Everything, other than the image itself, that Load() depends on
+        const RHI_Context* rhi_context = m_context->GetSubsystem<Renderer>()->GetRhiDevice()->GetContextRhi();
+        return "image_importer_v"  + to_string(freeimage_helper::version) +
+            " mips:"                + to_string(generate_mipmaps) +
+            " compression:"         + to_string(static_cast<uint32_t>(texture->GetCompression())) +
+            " bc:"                  + to_string(rhi_context->texture_compression_bc) +
+            " size:"                + to_string(texture->GetWidth()) + "x" + to_string(texture->GetHeight()) +
+            " flags:"               + to_string(texture->GetFlags());
+    }
+
+    bool ImageImporter::Benchmark(const uint32_t size /*= 4096*/)
+    {
+        FIBITMAP* bitmap = FreeImage_Allocate(size, size, 32);
+        if (!bitmap)
+        {
+            LOG_ERROR("Failed to allocate a %dx%d bitmap", size, size);
+            return false;
+        }
+
+        // Gradients and a pattern, so that neither path gets to skip work
+        BYTE* bits = FreeImage_GetBits(bitmap);
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                BYTE* pixel = bits + (static_cast<size_t>(y) * size + x) * 4;
+                pixel[0]    = static_cast<BYTE>(x * 255 / size);
+                pixel[1]    = static_cast<BYTE>(y * 255 / size);
+                pixel[2]    = static_cast<BYTE>(((x / 8) + (y / 8)) % 2 ? 220 : 30);
+                pixel[3]    = 255;
+            }
+        }
+
+        vector<vector<std::byte>> mips_freeimage(1);
+        GetBitsFromFibitmap(&mips_freeimage[0], bitmap, size, size, 4);
+        vector<vector<std::byte>> mips_cascaded = mips_freeimage;
+
+        Stopwatch timer;
+        GenerateMipmaps(bitmap, mips_freeimage, size, size, 4);
+        const float time_freeimage_ms = timer.GetElapsedTimeMs();
+
+        timer.Start();
+        const bool generated = MipGenerator::Generate(mips_cascaded, size, size, RHI_Format_R8G8B8A8_Unorm, true, 0.0f, m_context->GetSubsystem<Threading>());
+        const float time_cascaded_ms = timer.GetElapsedTimeMs();
+
+        FreeImage_Unload(bitmap);
+
+        // Both paths have to produce the same chain (the filters differ, so the pixels do too)
+        bool valid = generated && mips_freeimage.size() == mips_cascaded.size();
+        for (size_t i = 0; valid && i < mips_freeimage.size(); i++)
+        {
+            valid = mips_freeimage[i].size() == mips_cascaded[i].size();
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("The mip chains don't match");
+            return false;
+        }
+
+        LOG_INFO("%dx%d, %d mips: FreeImage %.2f ms, cascaded %.2f ms (%.1fx)", size, size, static_cast<uint32_t>(mips_cascaded.size()), time_freeimage_ms, time_cascaded_ms, time_freeimage_ms / max(time_cascaded_ms, 0.001f));
+        return true;
+    }
+
+    bool ImageImporter::CompressTexture(RHI_Texture* texture, const bool is_transparent, const bool is_grayscale) const
+    {
+        // Block compression works on 4x4 tiles of RGBA8, D3D11 also requires the top mip to be a whole number of tiles
+        if (texture->GetFormat() != RHI_Format_R8G8B8A8_Unorm || texture->GetWidth() % 4 != 0 || texture->GetHeight() % 4 != 0)
+            return false;
+
+        const RHI_Context* rhi_context = m_context->GetSubsystem<Renderer>()->GetRhiDevice()->GetContextRhi();
+        if (!rhi_context->texture_compression_bc)
+            return false;
+
+        const RHI_Format format = BlockCompressor::GetFormat(texture->GetCompression(), is_transparent, is_grayscale);
+        if (!BlockCompressor::Compress(texture->GetData(), texture->GetWidth(), texture->GetHeight(), format, m_context->GetSubsystem<Threading>()))
+        {
+            LOG_ERROR("Failed to compress to %s", rhi_format_to_string(format));
+            return false;
+        }
+
+        texture->SetFormat(format);
+        return true;
+    }
+
 	bool ImageImporter::GetBitsFromFibitmap(vector<std::byte>* data, FIBITMAP* bitmap, const uint32_t width, const uint32_t height, const uint32_t channels) const
     {
 		if (!data || width == 0 || height == 0 || channels == 0)
@@ -259,9 +378,9 @@ namespace Spartan
 		return true;
 	}
 
-	void ImageImporter::GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels)
+	void ImageImporter::GenerateMipmaps(FIBITMAP* bitmap, vector<vector<std::byte>>& mips, uint32_t width, uint32_t height, uint32_t channels)
 	{
-		if (!texture)
+		if (!bitmap || mips.empty())
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
@@ -275,18 +394,18 @@ namespace Spartan
 			height	= Math::Helper::Max(height / 2, static_cast<uint32_t>(1));
 			jobs.emplace_back(width, height, channels);
 			
-			// Resize the RHI_Texture vector accordingly
+			// Resize the mip vector accordingly
 			const auto size = width * height * channels;
-			auto mip		= texture->AddMipmap();
-			mip->reserve(size);
-			mip->resize(size);
+			auto& mip		= mips.emplace_back();
+			mip.reserve(size);
+			mip.resize(size);
 		}
 
-		// Pass data pointers (now that the RHI_Texture mip vector has been constructed)
+		// Pass data pointers (now that the mip vector has been constructed)
 		for (uint32_t i = 0; i < jobs.size(); i++)
 		{
 			// reminder: i + 1 because the 0 mip is the default image size
-			jobs[i].data = texture->GetData(i + 1);
+			jobs[i].data = &mips[i + 1];
 		}
 
 		// Parallelize mipmap generation using multiple threads (because FreeImage_Rescale() using FILTER_LANCZOS3 is expensive)
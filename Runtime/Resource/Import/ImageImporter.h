@@ -42,9 +42,16 @@ namespace Spartan
 
 		bool Load(const std::string& file_path, RHI_Texture* texture, bool generate_mipmaps = true);
 
+        // Identifies the settings Load() would import a texture with, for the import database
+        std::string GetSettings(const RHI_Texture* texture, bool generate_mipmaps) const;
+
+        // Times the mip chain of a synthetic RGBA8 image, FreeImage (every mip from the full image) against MipGenerator (every mip from the previous one)
+        bool Benchmark(uint32_t size = 4096);
+
 	private:	
+        bool CompressTexture(RHI_Texture* texture, bool is_transparent, bool is_grayscale) const;
 		bool GetBitsFromFibitmap(std::vector<std::byte>* data, FIBITMAP* bitmap, uint32_t width, uint32_t height, uint32_t channels) const;
-		void GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels);
+		void GenerateMipmaps(FIBITMAP* bitmap, std::vector<std::vector<std::byte>>& mips, uint32_t width, uint32_t height, uint32_t channels);
 		FIBITMAP* ApplyBitmapCorrections(FIBITMAP* bitmap) const;
 		FIBITMAP* _FreeImage_ConvertTo32Bits(FIBITMAP* bitmap) const;
 		FIBITMAP* _FreeImage_Rescale(FIBITMAP* bitmap, uint32_t width, uint32_t height) const;
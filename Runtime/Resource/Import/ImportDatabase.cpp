@@ -0,0 +1,463 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "ImportDatabase.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <memory>
+#include <cstring>
+#include "../../IO/FileStream.h"
+#include "../../Logging/Log.h"
+#include "../../Core/Stopwatch.h"
+//===============================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::import_database
+{
+    static const uint32_t magic     = 0x42444953; // "SIDB"
+    static const uint32_t version   = 1;
+    static const char* file_name    = "import.db";
+    static const uint64_t block     = 1024 * 1024;
+
+    // XXH64
+    static const uint64_t prime_1 = 11400714785074694791ULL;
+    static const uint64_t prime_2 = 14029467366897019727ULL;
+    static const uint64_t prime_3 = 1609587929392839161ULL;
+    static const uint64_t prime_4 = 9650029242287828579ULL;
+    static const uint64_t prime_5 = 2870177450012600261ULL;
+
+    inline uint64_t rotate(const uint64_t value, const uint32_t bits)   { return (value << bits) | (value >> (64 - bits)); }
+    inline uint64_t read_64(const uint8_t* data)                        { uint64_t value; memcpy(&value, data, sizeof(value)); return value; }
+    inline uint32_t read_32(const uint8_t* data)                        { uint32_t value; memcpy(&value, data, sizeof(value)); return value; }
+
+    inline uint64_t xxh_round(uint64_t accumulator, const uint64_t input)
+    {
+        accumulator += input * prime_2;
+        accumulator = rotate(accumulator, 31);
+        return accumulator * prime_1;
+    }
+
+    inline uint64_t xxh_merge(uint64_t accumulator, const uint64_t value)
+    {
+        accumulator ^= xxh_round(0, value);
+        return accumulator * prime_1 + prime_4;
+    }
+
+    inline string normalize(const string& path)
+    {
+        return filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    inline bool stat(const string& path, uint64_t& size, int64_t& time)
+    {
+        error_code error;
+        size = filesystem::file_size(path, error);
+        if (error)
+            return false;
+
+        time = static_cast<int64_t>(filesystem::last_write_time(path, error).time_since_epoch().count());
+        return !error;
+    }
+}
+
+namespace Spartan
+{
+    ImportDatabase::ImportDatabase(const string& directory)
+    {
+        m_directory = directory;
+        if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+        {
+            m_directory += "/";
+        }
+
+        error_code error;
+        if (!filesystem::is_directory(m_directory, error) && !filesystem::create_directories(m_directory, error))
+        {
+            LOG_WARNING("Failed to create \"%s\", imports will not be remembered", m_directory.c_str());
+        }
+    }
+
+    ImportDatabase::~ImportDatabase()
+    {
+        Save();
+    }
+
+    uint64_t ImportDatabase::GetKey(const string& source_path, const string& settings)
+    {
+        const string path = import_database::normalize(source_path);
+
+        uint64_t size   = 0;
+        int64_t time    = 0;
+        if (!import_database::stat(path, size, time))
+            return 0;
+
+        // Only hash the content if the file changed since it was last hashed
+        uint64_t hash = 0;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            auto it = m_sources.find(path);
+            if (it != m_sources.end() && it->second.size == size && it->second.time == time)
+            {
+                hash = it->second.hash;
+            }
+        }
+
+        if (hash == 0)
+        {
+            hash = HashFile(path);
+            if (hash == 0)
+                return 0;
+
+            lock_guard<mutex> lock(m_mutex);
+            m_sources[path] = { size, time, hash };
+            m_dirty         = true;
+        }
+
+        // Never 0, so it can signify failure
+        const uint64_t key = Hash(settings.data(), settings.size(), hash);
+        return key != 0 ? key : 1;
+    }
+
+    bool ImportDatabase::Find(const uint64_t key, vector<string>& products) const
+    {
+        if (key == 0)
+            return false;
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            auto it = m_imports.find(key);
+            if (it == m_imports.end())
+                return false;
+
+            products = it->second;
+        }
+
+        // A product might have been deleted, in which case the import has to happen again
+        error_code error;
+        for (const string& product : products)
+        {
+            if (!filesystem::is_regular_file(product, error))
+                return false;
+        }
+
+        return true;
+    }
+
+    void ImportDatabase::Add(const uint64_t key, const vector<string>& products)
+    {
+        if (key == 0)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+        m_imports[key]  = products;
+        m_dirty         = true;
+    }
+
+    string ImportDatabase::GetProductPath(const uint64_t key, const string& extension) const
+    {
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return m_directory + name + extension;
+    }
+
+    bool ImportDatabase::Load()
+    {
+        const string file_path = m_directory + import_database::file_name;
+        error_code error;
+        if (!filesystem::is_regular_file(file_path, error))
+            return false;
+
+        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        if (!file->IsOpen())
+            return false;
+
+        if (file->ReadAs<uint32_t>() != import_database::magic || file->ReadAs<uint32_t>() != import_database::version)
+        {
+            LOG_WARNING("\"%s\" is not a supported import database, everything will be imported again", file_path.c_str());
+            return false;
+        }
+
+        lock_guard<mutex> lock(m_mutex);
+        m_sources.clear();
+        m_imports.clear();
+
+        const uint32_t source_count = file->ReadAs<uint32_t>();
+        m_sources.reserve(source_count);
+        for (uint32_t i = 0; i < source_count; i++)
+        {
+            const string path   = file->ReadAs<string>();
+            SourceFile& source  = m_sources[path];
+            file->Read(&source.size);
+            file->Read(&source.time);
+            file->Read(&source.hash);
+        }
+
+        const uint32_t import_count = file->ReadAs<uint32_t>();
+        m_imports.reserve(import_count);
+        for (uint32_t i = 0; i < import_count; i++)
+        {
+            const uint64_t key = file->ReadAs<uint64_t>();
+            file->Read(&m_imports[key]);
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    bool ImportDatabase::Save()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_dirty)
+            return true;
+
+        const string file_path = m_directory + import_database::file_name;
+        auto file = make_unique<FileStream>(file_path, FileStream_Write);
+        if (!file->IsOpen())
+            return false;
+
+        file->Write(import_database::magic);
+        file->Write(import_database::version);
+
+        file->Write(static_cast<uint32_t>(m_sources.size()));
+        for (const auto& it : m_sources)
+        {
+            file->Write(it.first);
+            file->Write(it.second.size);
+            file->Write(it.second.time);
+            file->Write(it.second.hash);
+        }
+
+        file->Write(static_cast<uint32_t>(m_imports.size()));
+        for (const auto& it : m_imports)
+        {
+            file->Write(it.first);
+            file->Write(it.second);
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    uint64_t ImportDatabase::Hash(const void* data, const uint64_t size, const uint64_t seed /*= 0*/)
+    {
+        using namespace import_database;
+
+        const uint8_t* input    = static_cast<const uint8_t*>(data);
+        const uint8_t* end      = input + size;
+        uint64_t hash           = 0;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + prime_1 + prime_2;
+            uint64_t v2 = seed + prime_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - prime_1;
+
+            const uint8_t* limit = end - 32;
+            do
+            {
+                v1 = xxh_round(v1, read_64(input));      input += 8;
+                v2 = xxh_round(v2, read_64(input));      input += 8;
+                v3 = xxh_round(v3, read_64(input));      input += 8;
+                v4 = xxh_round(v4, read_64(input));      input += 8;
+            } while (input <= limit);
+
+            hash = rotate(v1, 1) + rotate(v2, 7) + rotate(v3, 12) + rotate(v4, 18);
+            hash = xxh_merge(hash, v1);
+            hash = xxh_merge(hash, v2);
+            hash = xxh_merge(hash, v3);
+            hash = xxh_merge(hash, v4);
+        }
+        else
+        {
+            hash = seed + prime_5;
+        }
+
+        hash += size;
+
+        for (; input + 8 <= end; input += 8)
+        {
+            hash ^= xxh_round(0, read_64(input));
+            hash = rotate(hash, 27) * prime_1 + prime_4;
+        }
+
+        if (input + 4 <= end)
+        {
+            hash ^= static_cast<uint64_t>(read_32(input)) * prime_1;
+            hash = rotate(hash, 23) * prime_2 + prime_3;
+            input += 4;
+        }
+
+        for (; input < end; input++)
+        {
+            hash ^= static_cast<uint64_t>(*input) * prime_5;
+            hash = rotate(hash, 11) * prime_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime_2;
+        hash ^= hash >> 29;
+        hash *= prime_3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    uint64_t ImportDatabase::HashFile(const string& file_path)
+    {
+        ifstream file(file_path, ios::binary);
+        if (!file)
+            return 0;
+
+        // Block by block, each seeded with the hash of the previous one, so large files don't have to fit in memory
+        vector<char> buffer(import_database::block);
+        uint64_t hash = 0;
+        do
+        {
+            file.read(buffer.data(), buffer.size());
+            hash = Hash(buffer.data(), static_cast<uint64_t>(file.gcount()), hash);
+        } while (file);
+
+        return hash != 0 ? hash : 1;
+    }
+
+    bool ImportDatabase::Benchmark(const string& directory, const uint32_t file_count /*= 256*/, const uint32_t file_size /*= 1024 * 1024*/)
+    {
+        bool valid = true;
+        auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        const filesystem::path root         = filesystem::path(directory) / "import_database_benchmark";
+        const filesystem::path source_dir   = root / "source";
+        const string cache_dir              = (root / "cache").string();
+        error_code error;
+        filesystem::remove_all(root, error);
+        filesystem::create_directories(source_dir, error);
+
+        // A synthetic asset folder
+        mt19937 generator(1337);
+        vector<string> sources(file_count);
+        {
+            vector<uint32_t> data(file_size / sizeof(uint32_t));
+            for (uint32_t i = 0; i < file_count; i++)
+            {
+                for (uint32_t& value : data) { value = generator(); }
+                sources[i] = (source_dir / ("asset_" + to_string(i) + ".bin")).string();
+                ofstream(sources[i], ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint32_t));
+            }
+        }
+
+        // Imports everything, the import itself being a write of a small product, returns how many files were imported
+        const string settings = "benchmark_importer_v1";
+        auto import = [&sources](ImportDatabase& database, const string& settings)
+        {
+            uint32_t imported = 0;
+            for (const string& source : sources)
+            {
+                const uint64_t key = database.GetKey(source, settings);
+                vector<string> products;
+                if (!database.Find(key, products))
+                {
+                    const string product = database.GetProductPath(key, ".product");
+                    ofstream(product, ios::binary) << source;
+                    database.Add(key, { product });
+                    imported++;
+                }
+            }
+            return imported;
+        };
+
+        float time_cold = 0.0f;
+        float time_warm = 0.0f;
+        {
+            ImportDatabase database(cache_dir);
+            Stopwatch timer;
+            check(import(database, settings) == file_count, "everything is imported the first time");
+            time_cold = timer.GetElapsedTimeMs();
+            check(database.Save(), "the database saves");
+        }
+
+        ImportDatabase database(cache_dir);
+        check(database.Load(), "the database loads");
+        {
+            Stopwatch timer;
+            check(import(database, settings) == 0, "nothing is imported again when nothing changed");
+            time_warm = timer.GetElapsedTimeMs();
+        }
+
+        // A write time change alone costs a hash, but not an import
+        filesystem::last_write_time(sources[0], filesystem::last_write_time(sources[0], error) + chrono::seconds(1), error);
+        check(import(database, settings) == 0, "a file which was only touched isn't imported again");
+
+        // So does a copy, the content is what matters
+        const string copy = (source_dir / "copy.bin").string();
+        filesystem::copy_file(sources[1], copy, error);
+        {
+            const uint64_t key = database.GetKey(copy, settings);
+            vector<string> products;
+            check(key == database.GetKey(sources[1], settings) && database.Find(key, products), "a copied file isn't imported again");
+        }
+
+        // An edit
+        {
+            fstream file(sources[2], ios::binary | ios::in | ios::out);
+            file.seekp(file_size / 2);
+            file.put('x');
+            file.put('y');
+        }
+        filesystem::last_write_time(sources[2], filesystem::last_write_time(sources[2], error) + chrono::seconds(1), error);
+        check(import(database, settings) == 1, "an edited file is imported again");
+
+        // A deleted product
+        {
+            const uint64_t key = database.GetKey(sources[3], settings);
+            vector<string> products;
+            if (database.Find(key, products))
+            {
+                filesystem::remove(products.front(), error);
+            }
+            check(import(database, settings) == 1, "a file whose product was deleted is imported again");
+        }
+
+        // Different settings
+        check(import(database, "benchmark_importer_v2") == file_count, "everything is imported again when the settings change");
+
+        database.m_dirty = false;
+        filesystem::remove_all(root, error);
+
+        const double megabytes = static_cast<double>(file_count) * file_size / (1024.0 * 1024.0);
+        LOG_INFO("%d files (%.0f MB): first import %.1f ms, unchanged reimport %.2f ms", file_count, megabytes, time_cold, time_warm);
+        LOG_INFO("%s", valid ? "Import database is valid" : "Import database is invalid");
+
+        return valid;
+    }
+}
@@ -0,0 +1,77 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include "../../Core/EngineDefs.h"
+//=============================
+
+namespace Spartan
+{
+    // Remembers what importing a file produced. An import is keyed by the hash of the source file's content combined
+    // with the hash of the importer settings, so a file which was moved or copied still hits, while a file which was
+    // edited, or imported with different settings, misses. Hashing the content of every file would still mean reading
+    // all of it, so the hash of each file is kept along with its size and write time and is only recomputed when either
+    // of those changes. It has no dependency on the engine's subsystems, so it can be used (and tested) headless.
+    class SPARTAN_CLASS ImportDatabase
+    {
+    public:
+        ImportDatabase(const std::string& directory);
+        ~ImportDatabase();
+
+        // Returns 0 if the source file can't be read
+        uint64_t GetKey(const std::string& source_path, const std::string& settings);
+
+        // Hits only if every product of the import still exists
+        bool Find(uint64_t key, std::vector<std::string>& products) const;
+        void Add(uint64_t key, const std::vector<std::string>& products);
+        std::string GetProductPath(uint64_t key, const std::string& extension) const;
+
+        bool Load();
+        bool Save();
+        const std::string& GetDirectory() const { return m_directory; }
+
+        static uint64_t Hash(const void* data, uint64_t size, uint64_t seed = 0);
+        static uint64_t HashFile(const std::string& file_path);
+
+        // Reimports a folder of generated files after touching, copying, editing and deleting, only real changes may import again
+        static bool Benchmark(const std::string& directory, uint32_t file_count = 256, uint32_t file_size = 1024 * 1024);
+
+    private:
+        struct SourceFile
+        {
+            uint64_t size   = 0;
+            int64_t time    = 0;
+            uint64_t hash   = 0;
+        };
+
+        std::string m_directory;
+        std::unordered_map<std::string, SourceFile> m_sources;
+        std::unordered_map<uint64_t, std::vector<std::string>> m_imports;
+        bool m_dirty = false;
+        mutable std::mutex m_mutex;
+    };
+}
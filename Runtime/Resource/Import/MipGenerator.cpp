@@ -0,0 +1,444 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include "MipGenerator.h"
+#include <cmath>
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include "../../Core/Stopwatch.h"
+#include "../../Logging/Log.h"
+#include "../../Threading/Threading.h"
+//======================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::mip_generator
+{
+    // Entries of the linear to sRGB table, fine enough that dark values (where sRGB is steep) still round correctly
+    static const uint32_t linear_to_srgb_size = 16384;
+
+    struct Tables
+    {
+        float srgb_to_linear[256];
+        float unorm_to_float[256];
+        uint8_t linear_to_srgb[linear_to_srgb_size];
+
+        Tables()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                const float value   = i / 255.0f;
+                srgb_to_linear[i]   = value <= 0.04045f ? value / 12.92f : pow((value + 0.055f) / 1.055f, 2.4f);
+                unorm_to_float[i]   = value;
+            }
+
+            for (uint32_t i = 0; i < linear_to_srgb_size; i++)
+            {
+                const float value   = i / static_cast<float>(linear_to_srgb_size - 1);
+                const float srgb    = value <= 0.0031308f ? value * 12.92f : 1.055f * pow(value, 1.0f / 2.4f) - 0.055f;
+                linear_to_srgb[i]   = static_cast<uint8_t>(srgb * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    inline const Tables& get_tables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+    // The source pixels which a destination pixel averages, along one axis
+    struct Footprint
+    {
+        uint32_t start;
+        uint32_t count;
+    };
+
+    inline vector<Footprint> get_footprints(const uint32_t size_source, const uint32_t size_destination)
+    {
+        vector<Footprint> footprints(size_destination);
+        for (uint32_t i = 0; i < size_destination; i++)
+        {
+            footprints[i].start = min(i * 2, size_source - 1);
+            footprints[i].count = size_source == 1 ? 1 : 2;
+        }
+
+        // An odd dimension folds its last row or column into the last pixel
+        if (size_source > 1 && size_source % 2 == 1)
+        {
+            footprints.back().count = 3;
+        }
+
+        return footprints;
+    }
+
+    inline __m128 load_pixel(const uint8_t* pixel, const float* table_color, const float* table_alpha)
+    {
+        return _mm_setr_ps(table_color[pixel[0]], table_color[pixel[1]], table_color[pixel[2]], table_alpha[pixel[3]]);
+    }
+
+    inline __m128 load_pixel(const float* pixel, const float*, const float*)
+    {
+        return _mm_loadu_ps(pixel);
+    }
+
+    inline void store_pixel(const __m128 value, uint8_t* pixel, const bool srgb)
+    {
+        const __m128 clamped = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+        if (srgb)
+        {
+            // Color goes through the table, alpha is linear
+            alignas(16) int32_t indices[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_setr_ps(linear_to_srgb_size - 1, linear_to_srgb_size - 1, linear_to_srgb_size - 1, 255.0f))));
+
+            const uint8_t* table = get_tables().linear_to_srgb;
+            pixel[0] = table[indices[0]];
+            pixel[1] = table[indices[1]];
+            pixel[2] = table[indices[2]];
+            pixel[3] = static_cast<uint8_t>(indices[3]);
+        }
+        else
+        {
+            // Round, pack to 16 bits and then to 8 bits
+            const __m128i value_i32 = _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)));
+            const __m128i value_u8  = _mm_packus_epi16(_mm_packs_epi32(value_i32, value_i32), _mm_setzero_si128());
+            const int32_t packed    = _mm_cvtsi128_si32(value_u8);
+            memcpy(pixel, &packed, sizeof(packed));
+        }
+    }
+
+    inline void store_pixel(const __m128 value, float* pixel, const bool)
+    {
+        _mm_storeu_ps(pixel, value);
+    }
+
+    // Downsamples rows [start, end) of a level
+    template<typename T>
+    void downsample_rows(const T* source, const uint32_t width_source, T* destination, const uint32_t width_destination, const vector<Footprint>& footprints_x, const vector<Footprint>& footprints_y, const bool srgb, const uint32_t start, const uint32_t end)
+    {
+        const Tables& tables        = get_tables();
+        const float* table_color    = srgb ? tables.srgb_to_linear : tables.unorm_to_float;
+        const float* table_alpha    = tables.unorm_to_float;
+
+        for (uint32_t y = start; y < end; y++)
+        {
+            const Footprint& footprint_y = footprints_y[y];
+            for (uint32_t x = 0; x < width_destination; x++)
+            {
+                const Footprint& footprint_x = footprints_x[x];
+
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t j = 0; j < footprint_y.count; j++)
+                {
+                    const T* row = source + static_cast<size_t>(footprint_y.start + j) * width_source * 4;
+                    for (uint32_t i = 0; i < footprint_x.count; i++)
+                    {
+                        sum = _mm_add_ps(sum, load_pixel(row + static_cast<size_t>(footprint_x.start + i) * 4, table_color, table_alpha));
+                    }
+                }
+
+                const __m128 average = _mm_mul_ps(sum, _mm_set1_ps(1.0f / (footprint_x.count * footprint_y.count)));
+                store_pixel(average, destination + (static_cast<size_t>(y) * width_destination + x) * 4, srgb);
+            }
+        }
+    }
+
+    inline float get_alpha(const vector<std::byte>& pixels, const RHI_Format format, const size_t index)
+    {
+        if (format == RHI_Format_R8G8B8A8_Unorm)
+            return static_cast<uint8_t>(pixels[index * 4 + 3]) / 255.0f;
+
+        float alpha;
+        memcpy(&alpha, pixels.data() + (index * 4 + 3) * sizeof(float), sizeof(float));
+        return alpha;
+    }
+
+    // Scales alpha so that the mip keeps the coverage of mip 0 (alpha tested foliage and fences would otherwise thin out with distance)
+    inline void preserve_alpha_coverage(vector<std::byte>& pixels, const RHI_Format format, const float threshold, const float coverage_target)
+    {
+        // A histogram of alpha turns every coverage estimate of the search into 256 steps, instead of a pass over the pixels
+        uint32_t histogram[256] = {};
+        const size_t pixel_count = pixels.size() / (format == RHI_Format_R8G8B8A8_Unorm ? 4 : 4 * sizeof(float));
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            histogram[static_cast<uint32_t>(min(max(get_alpha(pixels, format, i), 0.0f), 1.0f) * 255.0f + 0.5f)]++;
+        }
+
+        const auto get_coverage = [&histogram, pixel_count, threshold](const float scale)
+        {
+            uint32_t covered = 0;
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                covered += (i / 255.0f) * scale > threshold ? histogram[i] : 0;
+            }
+            return static_cast<float>(covered) / pixel_count;
+        };
+
+        // Coverage only grows with the scale, so bisect for the scale which matches the target
+        float scale_min = 0.0f;
+        float scale_max = 4.0f;
+        float scale     = 1.0f;
+        for (uint32_t iteration = 0; iteration < 12; iteration++)
+        {
+            scale = (scale_min + scale_max) * 0.5f;
+            if (get_coverage(scale) < coverage_target)
+            {
+                scale_min = scale;
+            }
+            else
+            {
+                scale_max = scale;
+            }
+        }
+
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            const float alpha = min(get_alpha(pixels, format, i) * scale, 1.0f);
+            if (format == RHI_Format_R8G8B8A8_Unorm)
+            {
+                pixels[i * 4 + 3] = static_cast<std::byte>(alpha * 255.0f + 0.5f);
+            }
+            else
+            {
+                memcpy(pixels.data() + (i * 4 + 3) * sizeof(float), &alpha, sizeof(float));
+            }
+        }
+    }
+}
+
+namespace Spartan
+{
+    bool MipGenerator::IsSupported(const RHI_Format format)
+    {
+        return format == RHI_Format_R8G8B8A8_Unorm || format == RHI_Format_R32G32B32A32_Float;
+    }
+
+    bool MipGenerator::Generate(vector<vector<std::byte>>& mips, uint32_t width, uint32_t height, const RHI_Format format, const bool srgb, const float alpha_coverage_threshold /*= 0.0f*/, Threading* threading /*= nullptr*/)
+    {
+        const uint32_t bytes_per_pixel = format == RHI_Format_R8G8B8A8_Unorm ? 4 : 16;
+        if (mips.empty() || width == 0 || height == 0 || !IsSupported(format) || mips[0].size() < static_cast<size_t>(width) * height * bytes_per_pixel)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        mips.resize(1);
+
+        const bool preserve_coverage    = alpha_coverage_threshold > 0.0f;
+        const float coverage            = preserve_coverage ? ComputeAlphaCoverage(mips[0], format, alpha_coverage_threshold) : 0.0f;
+
+        while (width > 1 && height > 1)
+        {
+            const uint32_t width_destination    = max(width / 2, 1u);
+            const uint32_t height_destination   = max(height / 2, 1u);
+            const vector<mip_generator::Footprint> footprints_x = mip_generator::get_footprints(width, width_destination);
+            const vector<mip_generator::Footprint> footprints_y = mip_generator::get_footprints(height, height_destination);
+
+            mips.emplace_back(static_cast<size_t>(width_destination) * height_destination * bytes_per_pixel);
+            const std::byte* source = mips[mips.size() - 2].data();
+            std::byte* destination  = mips.back().data();
+
+            const auto downsample = [&](const uint32_t start, const uint32_t end)
+            {
+                if (format == RHI_Format_R8G8B8A8_Unorm)
+                {
+                    mip_generator::downsample_rows(reinterpret_cast<const uint8_t*>(source), width, reinterpret_cast<uint8_t*>(destination), width_destination, footprints_x, footprints_y, srgb, start, end);
+                }
+                else
+                {
+                    mip_generator::downsample_rows(reinterpret_cast<const float*>(source), width, reinterpret_cast<float*>(destination), width_destination, footprints_x, footprints_y, srgb, start, end);
+                }
+            };
+
+            if (threading)
+            {
+                threading->AddTaskLoop(downsample, height_destination);
+            }
+            else
+            {
+                downsample(0, height_destination);
+            }
+
+            if (preserve_coverage)
+            {
+                mip_generator::preserve_alpha_coverage(mips.back(), format, alpha_coverage_threshold, coverage);
+            }
+
+            width   = width_destination;
+            height  = height_destination;
+        }
+
+        return true;
+    }
+
+    float MipGenerator::ComputeAlphaCoverage(const vector<std::byte>& pixels, const RHI_Format format, const float threshold)
+    {
+        const size_t pixel_count = pixels.size() / (format == RHI_Format_R8G8B8A8_Unorm ? 4 : 4 * sizeof(float));
+        if (pixel_count == 0)
+            return 0.0f;
+
+        size_t covered = 0;
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            covered += mip_generator::get_alpha(pixels, format, i) > threshold ? 1 : 0;
+        }
+
+        return static_cast<float>(covered) / pixel_count;
+    }
+
+    bool MipGenerator::Benchmark(Threading* threading, const uint32_t size /*= 2048*/)
+    {
+        if (size < 2)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        bool valid = true;
+        const auto check = [&valid](const bool condition, const char* description)
+        {
+            if (!condition)
+            {
+                LOG_ERROR("Check failed: %s", description);
+                valid = false;
+            }
+        };
+
+        const auto fill = [](const uint32_t width, const uint32_t height, const function<void(uint32_t, uint32_t, uint8_t*)>& get_pixel)
+        {
+            vector<std::byte> pixels(static_cast<size_t>(width) * height * 4);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    get_pixel(x, y, reinterpret_cast<uint8_t*>(pixels.data()) + (static_cast<size_t>(y) * width + x) * 4);
+                }
+            }
+            return pixels;
+        };
+
+        // Throughput, on a noisy image, with a fixed seed so that runs are comparable
+        {
+            mt19937 generator(1337);
+            uniform_int_distribution<int> noise(0, 255);
+            vector<vector<std::byte>> mips = { fill(size, size, [&](uint32_t, uint32_t, uint8_t* pixel) { for (uint32_t c = 0; c < 4; c++) pixel[c] = static_cast<uint8_t>(noise(generator)); }) };
+            const vector<std::byte> image = mips[0];
+
+            Stopwatch timer;
+            check(Generate(mips, size, size, RHI_Format_R8G8B8A8_Unorm, true, 0.0f, threading), "the chain generates");
+            const float time_ms = timer.GetElapsedTimeMs();
+
+            size_t mip_count = 1;
+            for (uint32_t mip_size = size; mip_size > 1; mip_size /= 2)
+            {
+                mip_count++;
+            }
+            check(mips.size() == mip_count && mips.back().size() == 4, "the chain ends at 1x1");
+
+            if (threading)
+            {
+                vector<vector<std::byte>> mips_serial = { image };
+                Generate(mips_serial, size, size, RHI_Format_R8G8B8A8_Unorm, true, 0.0f, nullptr);
+                check(mips_serial == mips, "threads produce the same chain");
+            }
+
+            LOG_INFO("%dx%d RGBA8 sRGB, %d mips: %.2f ms, %.1f MPixels/s", size, size, static_cast<uint32_t>(mips.size()), time_ms, (static_cast<float>(size) * size / 1000000.0f) / (time_ms / 1000.0f));
+        }
+
+        // Filtering happens in linear space, a black and white checkerboard is 50% linear (188 in sRGB), not 128
+        {
+            vector<vector<std::byte>> mips = { fill(8, 8, [](uint32_t x, uint32_t y, uint8_t* pixel) { const uint8_t value = (x + y) % 2 ? 255 : 0; pixel[0] = pixel[1] = pixel[2] = value; pixel[3] = 255; }) };
+            const vector<std::byte> image = mips[0];
+            Generate(mips, 8, 8, RHI_Format_R8G8B8A8_Unorm, true);
+            check(abs(static_cast<int>(mips[1][0]) - 188) <= 1, "sRGB is averaged in linear space");
+
+            mips = { image };
+            Generate(mips, 8, 8, RHI_Format_R8G8B8A8_Unorm, false);
+            check(abs(static_cast<int>(mips[1][0]) - 128) <= 1, "linear data is averaged as is");
+        }
+
+        // A flat image stays flat, including along odd dimensions (which fold 3 rows or columns into one)
+        {
+            vector<vector<std::byte>> mips = { fill(7, 5, [](uint32_t, uint32_t, uint8_t* pixel) { pixel[0] = 200; pixel[1] = 100; pixel[2] = 50; pixel[3] = 255; }) };
+            Generate(mips, 7, 5, RHI_Format_R8G8B8A8_Unorm, true);
+
+            bool flat = mips.size() == 3 && mips[1].size() == 3 * 2 * 4 && mips[2].size() == 1 * 1 * 4;
+            for (const vector<std::byte>& mip : mips)
+            {
+                for (size_t i = 0; i < mip.size(); i += 4)
+                {
+                    flat = flat && abs(static_cast<int>(mip[i]) - 200) <= 1 && abs(static_cast<int>(mip[i + 1]) - 100) <= 1 && abs(static_cast<int>(mip[i + 2]) - 50) <= 1;
+                }
+            }
+            check(flat, "a flat image stays flat");
+
+            vector<vector<std::byte>> mips_float = { vector<std::byte>(static_cast<size_t>(6) * 6 * 4 * sizeof(float)) };
+            float* pixels = reinterpret_cast<float*>(mips_float[0].data());
+            for (uint32_t i = 0; i < 6 * 6 * 4; i++)
+            {
+                pixels[i] = 8.0f; // HDR, nothing clamps
+            }
+            Generate(mips_float, 6, 6, RHI_Format_R32G32B32A32_Float, false);
+            check(reinterpret_cast<const float*>(mips_float.back().data())[0] == 8.0f, "a flat HDR image stays flat");
+        }
+
+        // Alpha tested foliage, thin blades which would otherwise fade into nothing
+        {
+            const uint32_t cutout_size  = 256;
+            const float threshold       = 0.6f;
+            const auto blades = [](uint32_t x, uint32_t y, uint8_t* pixel)
+            {
+                const float blade   = 0.5f + 0.5f * sin(x * 0.2f + y * 0.02f);
+                pixel[0]            = 40;
+                pixel[1]            = 160;
+                pixel[2]            = 30;
+                pixel[3]            = static_cast<uint8_t>(blade > 0.8f ? 255.0f * blade : 0.0f);
+            };
+
+            vector<vector<std::byte>> mips_plain    = { fill(cutout_size, cutout_size, blades) };
+            vector<vector<std::byte>> mips_coverage = mips_plain;
+            Generate(mips_plain, cutout_size, cutout_size, RHI_Format_R8G8B8A8_Unorm, true);
+            Generate(mips_coverage, cutout_size, cutout_size, RHI_Format_R8G8B8A8_Unorm, true, threshold, threading);
+
+            const float coverage = ComputeAlphaCoverage(mips_plain[0], RHI_Format_R8G8B8A8_Unorm, threshold);
+            float error_plain    = 0.0f;
+            float error_coverage = 0.0f;
+            for (uint32_t mip = 1; (cutout_size >> mip) >= 32; mip++)
+            {
+                error_plain    = max(error_plain, abs(ComputeAlphaCoverage(mips_plain[mip], RHI_Format_R8G8B8A8_Unorm, threshold) - coverage));
+                error_coverage = max(error_coverage, abs(ComputeAlphaCoverage(mips_coverage[mip], RHI_Format_R8G8B8A8_Unorm, threshold) - coverage));
+            }
+            // Not exact, alpha is quantized to 8 bits and neighbouring blades merge at the smaller mips
+            check(error_coverage < 0.03f && error_coverage < error_plain * 0.5f, "alpha coverage is preserved");
+
+            LOG_INFO("Alpha coverage %.3f, largest error without preservation %.3f, with %.3f", coverage, error_plain, error_coverage);
+        }
+
+        LOG_INFO("%s", valid ? "Mip generation is valid" : "Mip generation is invalid");
+        return valid;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+namespace Spartan
+{
+    class Threading;
+
+    // Builds a mip chain on the CPU, every level is downsampled from the previous one (instead of from the full
+    // resolution image), so the whole chain costs about a third of the top level. The filter is a box (2x2, or 3
+    // taps along an odd dimension so that no row or column is dropped) which is evaluated with SSE, in linear
+    // space when the texture is sRGB. Rows of a level are spread over the threads.
+    class SPARTAN_CLASS MipGenerator
+    {
+    public:
+        // RGBA8 and RGBA32F
+        static bool IsSupported(RHI_Format format);
+
+        // Appends mips to mips[0] (which is width x height) until either dimension reaches 1, the same chain ImageImporter has always produced.
+        // An alpha coverage threshold larger than 0 rescales the alpha of every mip, so that as many pixels pass an alpha test as in mip 0.
+        static bool Generate(std::vector<std::vector<std::byte>>& mips, uint32_t width, uint32_t height, RHI_Format format, bool srgb, float alpha_coverage_threshold = 0.0f, Threading* threading = nullptr);
+
+        // Fraction of the pixels whose alpha is above the threshold
+        static float ComputeAlphaCoverage(const std::vector<std::byte>& pixels, RHI_Format format, float threshold);
+
+        // Validates the chain of synthetic images and logs the throughput
+        static bool Benchmark(Threading* threading, uint32_t size = 2048);
+    };
+}
@@ -21,19 +21,32 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================================
 #include "ModelImporter.h"
+#include <atomic>
+#include <random>
+#include <cstring>
+#include <unordered_map>
+#include <emmintrin.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/version.h>
 #include "AssimpHelper.h"
+#include "ImportDatabase.h"
 #include "../ProgressReport.h"
-#include "../../RHI/RHI_Texture.h"
+#include "../ResourceCache.h"
+#include "../../RHI/RHI_Texture2D.h"
 #include "../../Core/Settings.h"
+#include "../../Core/Stopwatch.h"
+#include "../../Rendering/MeshOptimizer.h"
+#include "../../Threading/Threading.h"
 #include "../../Rendering/Model.h"
+#include "../../Rendering/Mesh.h"
 #include "../../Rendering/Animation.h"
 #include "../../Rendering/Material.h"
 #include "../../World/World.h"
 #include "../../World/Components/Renderable.h"
+#include "../../World/Components/Transform.h"
 #include "../../RHI/RHI_Vertex.h"
+#include "../../IO/FileStream.h"
 //============================================
 
 //= NAMESPACES ================
@@ -42,8 +55,85 @@ using namespace Spartan::Math;
 using namespace Assimp;
 //=============================
 
+namespace Spartan::hierarchy_file
+{
+    // The entities an import created, depth first, which along with the model and material files is what an import produces
+    static const uint32_t magic             = 0x52454948; // "HIER"
+    static const uint32_t version_current   = 1;
+    static const char* extension            = ".hierarchy";
+    static const uint32_t none              = numeric_limits<uint32_t>::max();
+
+    struct node
+    {
+        string name;
+        uint32_t parent         = none;
+        bool is_active          = true;
+        Vector3 position        = Vector3::Zero;
+        Quaternion rotation     = Quaternion::Identity;
+        Vector3 scale           = Vector3::One;
+        bool has_renderable     = false;
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        uint32_t vertex_offset  = 0;
+        uint32_t vertex_count   = 0;
+        BoundingBox aabb;
+        uint32_t material_index = none;
+    };
+
+    inline void gather(const Transform* transform, const uint32_t parent, const vector<shared_ptr<Material>>& materials, vector<bool>& materials_used, vector<node>& nodes)
+    {
+        Entity* entity = transform->GetEntity();
+
+        node node;
+        node.name       = entity->GetName();
+        node.parent     = parent;
+        node.is_active  = entity->IsActive();
+        node.position   = transform->GetPositionLocal();
+        node.rotation   = transform->GetRotationLocal();
+        node.scale      = transform->GetScaleLocal();
+
+        if (const Renderable* renderable = entity->GetComponent<Renderable>())
+        {
+            node.has_renderable = true;
+            node.index_offset   = renderable->GeometryIndexOffset();
+            node.index_count    = renderable->GeometryIndexCount();
+            node.vertex_offset  = renderable->GeometryVertexOffset();
+            node.vertex_count   = renderable->GeometryVertexCount();
+            node.aabb           = renderable->GetBoundingBox();
+
+            // The renderable holds the cached material, which is matched by name
+            const Material* material = renderable->GetMaterial();
+            for (uint32_t i = 0; material && i < static_cast<uint32_t>(materials.size()); i++)
+            {
+                if (materials[i] && materials[i]->GetResourceName() == material->GetResourceName())
+                {
+                    node.material_index = i;
+                    materials_used[i]   = true;
+                    break;
+                }
+            }
+        }
+
+        const uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back(node);
+        for (const Transform* child : transform->GetChildren())
+        {
+            gather(child, index, materials, materials_used, nodes);
+        }
+    }
+}
+
 namespace Spartan
 {
+    // A texture which a material uses
+    struct ModelImporter::TextureSlot
+    {
+        uint32_t material_index = 0;
+        Material_Property type  = Material_Unknown;
+        bool is_albedo          = false;
+        std::string file_path;
+    };
+
 	ModelImporter::ModelImporter(Context* context)
 	{
 		m_context	= context;
@@ -104,7 +194,6 @@ namespace Spartan
             aiProcess_GenSmoothNormals |
             aiProcess_JoinIdenticalVertices |
             aiProcess_OptimizeMeshes |              // reduce the number of meshes         
-            aiProcess_ImproveCacheLocality |        // re-order triangles for better vertex cache locality.
             aiProcess_RemoveRedundantMaterials |    // remove redundant/unreferenced materials.
             aiProcess_LimitBoneWeights |
             aiProcess_SplitLargeMeshes |
@@ -120,14 +209,51 @@ namespace Spartan
         // aiProcess_FixInfacingNormals - is not reliable and fails often.
         // aiProcess_OptimizeGraph      - works but because it merges as nodes as possible, you can't really click and select anything other than the entire thing.
 
+        // If the same file was imported with the same settings before, load the native assets that import produced instead
+        ImportDatabase* import_database = m_context->GetSubsystem<ResourceCache>()->GetImportDatabase();
+        uint64_t import_key             = 0;
+        if (import_database)
+        {
+            const string settings =
+                "model_importer_v2 assimp:" + to_string(aiGetVersionMajor()) + "." + to_string(aiGetVersionMinor()) + "." + to_string(aiGetVersionRevision()) +
+                " flags:"       + to_string(importer_flags) +
+                " triangles:"   + to_string(params.triangle_limit) +
+                " vertices:"    + to_string(params.vertex_limit) +
+                " normals:"     + to_string(params.max_normal_smoothing_angle) +
+                " tangents:"    + to_string(params.max_tangent_smoothing_angle);
+
+            import_key = import_database->GetKey(file_path, settings);
+            vector<string> products;
+            if (import_database->Find(import_key, products))
+            {
+                if (LoadImported(params, products))
+                    return true;
+
+                LOG_WARNING("Failed to load the previous import of \"%s\", importing it again", file_path.c_str());
+                model->Clear();
+            }
+        }
+
 		// Read the 3D model file from disk
-		if (const aiScene* scene = importer.ReadFile(file_path, importer_flags))
+        const aiScene* scene = importer.ReadFile(file_path, importer_flags);
+
+		if (scene)
 		{
 			FIRE_EVENT(Event_World_Stop);
 
             params.scene            = scene;
             params.has_animation    = scene->mNumAnimations != 0;
 
+            // Convert the meshes and load the materials (and their textures) first, both in parallel, so that all that's left is creating the entities
+            LoadMeshes(scene->mMeshes, scene->mNumMeshes, model->GetMesh().get(), params.meshes, m_context->GetSubsystem<Threading>());
+            OptimizeMeshes(model->GetMesh().get(), params.meshes, m_context->GetSubsystem<Threading>());
+            GenerateLods(model->GetMesh().get(), params.meshes, m_context->GetSubsystem<Threading>());
+            for (const ModelMesh& mesh : params.meshes)
+            {
+                model->SetLods(mesh.index_offset, mesh.lods);
+            }
+            LoadMaterials(params);
+
             // Create root entity to match Assimp's root node
             const bool is_active = false;
             shared_ptr<Entity> new_entity = m_world->EntityCreate(is_active);
@@ -143,9 +269,16 @@ namespace Spartan
 			ParseNode(scene->mRootNode, params, nullptr, new_entity.get());
             // Parse animations
 			ParseAnimations(params);
-            // Update model geometry
+            // Update model geometry (static models get a quantized vertex buffer, which is less than half the size)
+            model->SetVertexQuantization(!params.has_animation);
 			model->UpdateGeometry();
 
+            // Animations aren't part of what's kept, so animated models are always imported
+            if (import_key != 0 && !params.has_animation)
+            {
+                SaveImported(params, import_key);
+            }
+
 			FIRE_EVENT(Event_World_Start);
 		}
 		else
@@ -158,6 +291,327 @@ namespace Spartan
         return params.scene != nullptr;
 	}
 
+    bool ModelImporter::LoadImported(ModelParams& params, const vector<string>& products)
+    {
+        // The model file, the hierarchy file and then a material file for every material which is used (the rest only has to exist)
+        if (products.size() < 2)
+            return false;
+
+        // Geometry and levels of detail
+        const bool geometry_loaded = params.model->LoadFromFile(products[0]);
+        params.model->SetResourceFilePath(params.file_path);
+        if (!geometry_loaded)
+            return false;
+
+        auto file = make_unique<FileStream>(products[1], FileStream_Read);
+        if (!file->IsOpen() || file->ReadAs<uint32_t>() != hierarchy_file::magic || file->ReadAs<uint32_t>() != hierarchy_file::version_current)
+            return false;
+
+        // Materials, named the way LoadMaterial() names them
+        params.materials.resize(file->ReadAs<uint32_t>());
+        uint32_t product_index = 2;
+        for (shared_ptr<Material>& material : params.materials)
+        {
+            const string name = file->ReadAs<string>();
+            if (name.empty())
+                continue;
+
+            material = make_shared<Material>(m_context);
+            if (product_index >= products.size() || !material->LoadFromFile(products[product_index++]))
+                return false;
+
+            material->SetResourceFilePath(FileSystem::GetDirectoryFromFilePath(params.file_path) + name + EXTENSION_MATERIAL);
+        }
+
+        // Read the whole hierarchy before creating any entity, so that nothing has to be undone if it's invalid
+        vector<hierarchy_file::node> nodes(file->ReadAs<uint32_t>());
+        const uint32_t index_count = params.model->GetMesh()->Indices_Count();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(nodes.size()); i++)
+        {
+            hierarchy_file::node& node = nodes[i];
+            file->Read(&node.name);
+            file->Read(&node.parent);
+            file->Read(&node.is_active);
+            file->Read(&node.position);
+            file->Read(&node.rotation);
+            file->Read(&node.scale);
+            file->Read(&node.has_renderable);
+            if (node.has_renderable)
+            {
+                file->Read(&node.index_offset);
+                file->Read(&node.index_count);
+                file->Read(&node.vertex_offset);
+                file->Read(&node.vertex_count);
+                file->Read(&node.aabb);
+                file->Read(&node.material_index);
+            }
+
+            const bool parent_valid     = i == 0 ? node.parent == hierarchy_file::none : node.parent < i;
+            const bool geometry_valid   = !node.has_renderable || node.index_offset + node.index_count <= index_count;
+            const bool material_valid   = node.material_index == hierarchy_file::none || (node.material_index < params.materials.size() && params.materials[node.material_index]);
+            if (!parent_valid || !geometry_valid || !material_valid)
+                return false;
+        }
+        file->Close();
+
+        if (nodes.empty())
+            return false;
+
+        // Create the entities, the same way ParseNode() does
+        FIRE_EVENT(Event_World_Stop);
+        vector<Entity*> entities(nodes.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(nodes.size()); i++)
+        {
+            const hierarchy_file::node& node    = nodes[i];
+            shared_ptr<Entity> entity           = m_world->EntityCreate(node.is_active);
+            entities[i]                         = entity.get();
+            if (i == 0)
+            {
+                params.model->SetRootEntity(entity);
+            }
+
+            entity->SetName(node.name);
+            entity->GetTransform()->SetParent(node.parent == hierarchy_file::none ? nullptr : entities[node.parent]->GetTransform());
+            entity->GetTransform()->SetPositionLocal(node.position);
+            entity->GetTransform()->SetRotationLocal(node.rotation);
+            entity->GetTransform()->SetScaleLocal(node.scale);
+
+            if (node.has_renderable)
+            {
+                entity->AddComponent<Renderable>()->GeometrySet(node.name, node.index_offset, node.index_count, node.vertex_offset, node.vertex_count, node.aabb, params.model);
+                if (node.material_index != hierarchy_file::none)
+                {
+                    params.model->AddMaterial(params.materials[node.material_index], entity->GetPtrShared());
+                }
+            }
+        }
+        FIRE_EVENT(Event_World_Start);
+
+        return true;
+    }
+
+    void ModelImporter::SaveImported(const ModelParams& params, const uint64_t import_key) const
+    {
+        ImportDatabase* import_database = m_context->GetSubsystem<ResourceCache>()->GetImportDatabase();
+        const shared_ptr<Entity> root   = params.model->GetRootEntity();
+        if (!import_database || !root)
+            return;
+
+        vector<string> products =
+        {
+            import_database->GetProductPath(import_key, EXTENSION_MODEL),
+            import_database->GetProductPath(import_key, hierarchy_file::extension)
+        };
+
+        // Geometry and levels of detail
+        if (!params.model->SaveToFile(products[0]))
+        {
+            LOG_WARNING("Failed to keep the import of \"%s\"", params.file_path.c_str());
+            return;
+        }
+
+        vector<hierarchy_file::node> nodes;
+        vector<bool> materials_used(params.materials.size(), false);
+        hierarchy_file::gather(root->GetTransform(), hierarchy_file::none, params.materials, materials_used, nodes);
+
+        auto file = make_unique<FileStream>(products[1], FileStream_Write);
+        if (!file->IsOpen())
+        {
+            LOG_WARNING("Failed to keep the import of \"%s\"", params.file_path.c_str());
+            return;
+        }
+
+        file->Write(hierarchy_file::magic);
+        file->Write(hierarchy_file::version_current);
+
+        // Materials, the ones which are used were saved next to the model when the renderables cached them
+        file->Write(static_cast<uint32_t>(params.materials.size()));
+        vector<string> texture_paths;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(params.materials.size()); i++)
+        {
+            const shared_ptr<Material>& material = params.materials[i];
+            if (!materials_used[i] || !material)
+            {
+                file->Write(string());
+                continue;
+            }
+
+            const string product = import_database->GetProductPath(import_key, "_" + to_string(i) + EXTENSION_MATERIAL);
+            if (!FileSystem::CopyFileFromTo(material->GetResourceFilePathNative(), product))
+            {
+                LOG_WARNING("Failed to keep the import of \"%s\"", params.file_path.c_str());
+                return;
+            }
+
+            file->Write(material->GetResourceName());
+            products.emplace_back(product);
+
+            // The materials refer to the textures, which were saved next to the model when they were cached
+            for (const string& texture_path : material->GetTexturePaths())
+            {
+                if (!texture_path.empty())
+                {
+                    texture_paths.emplace_back(texture_path);
+                }
+            }
+        }
+
+        file->Write(static_cast<uint32_t>(nodes.size()));
+        for (const hierarchy_file::node& node : nodes)
+        {
+            file->Write(node.name);
+            file->Write(node.parent);
+            file->Write(node.is_active);
+            file->Write(node.position);
+            file->Write(node.rotation);
+            file->Write(node.scale);
+            file->Write(node.has_renderable);
+            if (node.has_renderable)
+            {
+                file->Write(node.index_offset);
+                file->Write(node.index_count);
+                file->Write(node.vertex_offset);
+                file->Write(node.vertex_count);
+                file->Write(node.aabb);
+                file->Write(node.material_index);
+            }
+        }
+        file->Close();
+
+        // If a texture goes missing, the import has to happen again
+        products.insert(products.end(), texture_paths.begin(), texture_paths.end());
+        import_database->Add(import_key, products);
+    }
+
+    bool ModelImporter::Benchmark(Threading* threading, const uint32_t mesh_count /*= 1000*/, const uint32_t triangle_count /*= 1000000*/)
+    {
+        // Meshes which vary in size, with every attribute the conversion reads
+        mt19937 generator(1337);
+        uniform_real_distribution<float> distribution_value(-100.0f, 100.0f);
+        uniform_real_distribution<float> distribution_size(0.2f, 1.8f);
+        vector<unique_ptr<aiMesh>> assimp_meshes(mesh_count);
+        vector<const aiMesh*> assimp_mesh_pointers(mesh_count);
+        uint32_t triangles_generated = 0;
+        for (uint32_t i = 0; i < mesh_count; i++)
+        {
+            const uint32_t mesh_triangle_count  = max(1u, static_cast<uint32_t>(distribution_size(generator) * triangle_count / mesh_count));
+            const uint32_t mesh_vertex_count    = mesh_triangle_count + 2;
+
+            aiMesh* assimp_mesh                 = new aiMesh();
+            assimp_mesh->mNumVertices           = mesh_vertex_count;
+            assimp_mesh->mVertices              = new aiVector3D[mesh_vertex_count];
+            assimp_mesh->mNormals               = new aiVector3D[mesh_vertex_count];
+            assimp_mesh->mTangents              = new aiVector3D[mesh_vertex_count];
+            assimp_mesh->mTextureCoords[0]      = new aiVector3D[mesh_vertex_count];
+            assimp_mesh->mNumUVComponents[0]    = 2;
+            for (aiVector3D* attribute : { assimp_mesh->mVertices, assimp_mesh->mNormals, assimp_mesh->mTangents, assimp_mesh->mTextureCoords[0] })
+            {
+                for (uint32_t j = 0; j < mesh_vertex_count; j++)
+                {
+                    attribute[j] = aiVector3D(distribution_value(generator), distribution_value(generator), distribution_value(generator));
+                }
+            }
+
+            // A strip
+            assimp_mesh->mNumFaces  = mesh_triangle_count;
+            assimp_mesh->mFaces     = new aiFace[mesh_triangle_count];
+            for (uint32_t j = 0; j < mesh_triangle_count; j++)
+            {
+                aiFace& face        = assimp_mesh->mFaces[j];
+                face.mNumIndices    = 3;
+                face.mIndices       = new unsigned int[3] { j, j + 1, j + 2 };
+            }
+
+            assimp_meshes[i].reset(assimp_mesh);
+            assimp_mesh_pointers[i] = assimp_mesh;
+            triangles_generated     += mesh_triangle_count;
+        }
+
+        // Serially, a vertex at a time, into vectors which are then appended (the way meshes used to be converted)
+        Stopwatch timer;
+        Mesh mesh_serial;
+        vector<BoundingBox> aabbs_serial(mesh_count);
+        for (uint32_t i = 0; i < mesh_count; i++)
+        {
+            const aiMesh* assimp_mesh = assimp_mesh_pointers[i];
+            vector<RHI_Vertex_PosTexNorTan> vertices(assimp_mesh->mNumVertices);
+            for (uint32_t j = 0; j < assimp_mesh->mNumVertices; j++)
+            {
+                auto& vertex = vertices[j];
+
+                const auto& pos = assimp_mesh->mVertices[j];
+                vertex.pos[0]   = pos.x;
+                vertex.pos[1]   = pos.y;
+                vertex.pos[2]   = pos.z;
+
+                if (assimp_mesh->mNormals)
+                {
+                    const auto& normal = assimp_mesh->mNormals[j];
+                    vertex.nor[0] = normal.x;
+                    vertex.nor[1] = normal.y;
+                    vertex.nor[2] = normal.z;
+                }
+
+                if (assimp_mesh->mTangents)
+                {
+                    const auto& tangent = assimp_mesh->mTangents[j];
+                    vertex.tan[0] = tangent.x;
+                    vertex.tan[1] = tangent.y;
+                    vertex.tan[2] = tangent.z;
+                }
+
+                if (assimp_mesh->HasTextureCoords(0))
+                {
+                    const auto& tex_coords = assimp_mesh->mTextureCoords[0][j];
+                    vertex.tex[0] = tex_coords.x;
+                    vertex.tex[1] = tex_coords.y;
+                }
+            }
+
+            vector<uint32_t> indices(assimp_mesh->mNumFaces * 3);
+            for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
+            {
+                const aiFace& face          = assimp_mesh->mFaces[face_index];
+                indices[face_index * 3 + 0] = face.mIndices[0];
+                indices[face_index * 3 + 1] = face.mIndices[1];
+                indices[face_index * 3 + 2] = face.mIndices[2];
+            }
+
+            aabbs_serial[i] = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
+            mesh_serial.Indices_Append(indices, nullptr);
+            mesh_serial.Vertices_Append(vertices, nullptr);
+        }
+        const float time_serial = timer.GetElapsedTimeMs();
+
+        // In parallel, straight into the geometry
+        timer.Start();
+        Mesh mesh_parallel;
+        vector<ModelMesh> meshes;
+        LoadMeshes(assimp_mesh_pointers.data(), mesh_count, &mesh_parallel, meshes, threading);
+        const float time_parallel = timer.GetElapsedTimeMs();
+
+        // Both have to produce the same geometry
+        const auto& vertices_serial     = mesh_serial.Vertices_Get();
+        const auto& vertices_parallel   = mesh_parallel.Vertices_Get();
+        bool valid =
+            mesh_serial.Indices_Get() == mesh_parallel.Indices_Get() &&
+            vertices_serial.size() == vertices_parallel.size() &&
+            memcmp(vertices_serial.data(), vertices_parallel.data(), vertices_serial.size() * sizeof(RHI_Vertex_PosTexNorTan)) == 0;
+        for (uint32_t i = 0; valid && i < mesh_count; i++)
+        {
+            valid = aabbs_serial[i].GetMin() == meshes[i].aabb.GetMin() && aabbs_serial[i].GetMax() == meshes[i].aabb.GetMax();
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("The converted geometry doesn't match");
+            return false;
+        }
+
+        LOG_INFO("%d meshes, %d triangles: serial %.2f ms, parallel %.2f ms (%.1fx)", mesh_count, triangles_generated, time_serial, time_parallel, time_serial / max(time_parallel, 0.001f));
+        return true;
+    }
+
 	void ModelImporter::ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node, Entity* new_entity)
 	{
         if (parent_node) // parent node is already set
@@ -209,8 +663,30 @@ namespace Spartan
             // Set entity name
             entity->SetName(_name);
 
-            // Process mesh
-            LoadMesh(assimp_mesh, entity, params);
+            // Add a renderable component to this entity and set the geometry, which has already been converted
+            const uint32_t mesh_index   = assimp_node->mMeshes[i];
+            const ModelMesh& mesh       = params.meshes[mesh_index];
+            auto renderable             = entity->AddComponent<Renderable>();
+            renderable->GeometrySet(
+                entity->GetName(),
+                mesh.index_offset,
+                mesh.index_count,
+                mesh.vertex_offset,
+                mesh.vertex_count,
+                mesh.aabb,
+                params.model
+            );
+
+            // Material
+            if (assimp_mesh->mMaterialIndex < params.materials.size() && params.materials[assimp_mesh->mMaterialIndex])
+            {
+                shared_ptr<Material> material = params.materials[assimp_mesh->mMaterialIndex];
+                params.model->AddMaterial(material, entity->GetPtrShared());
+            }
+
+            // Bones
+            LoadBones(assimp_mesh, params);
+
             entity->SetActive(true);
         }
     }
@@ -265,108 +741,203 @@ namespace Spartan
 		}
 	}
 
-	void ModelImporter::LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params)
-	{
-		if (!assimp_mesh || !entity_parent)
-		{
-			LOG_ERROR_INVALID_PARAMETER();
-			return;
-		}
+    void ModelImporter::LoadMeshes(const aiMesh* const* assimp_meshes, const uint32_t mesh_count, Mesh* mesh, vector<ModelMesh>& meshes, Threading* threading)
+    {
+        vector<uint32_t>& indices                   = mesh->Indices_Get();
+        vector<RHI_Vertex_PosTexNorTan>& vertices   = mesh->Vertices_Get();
+
+        // Lay the meshes out one after the other and allocate all of the geometry at once
+        meshes.resize(mesh_count);
+        uint32_t index_offset   = static_cast<uint32_t>(indices.size());
+        uint32_t vertex_offset  = static_cast<uint32_t>(vertices.size());
+        for (uint32_t i = 0; i < mesh_count; i++)
+        {
+            meshes[i].index_offset  = index_offset;
+            meshes[i].index_count   = assimp_meshes[i]->mNumFaces * 3;
+            meshes[i].vertex_offset = vertex_offset;
+            meshes[i].vertex_count  = assimp_meshes[i]->mNumVertices;
+            index_offset            += meshes[i].index_count;
+            vertex_offset           += meshes[i].vertex_count;
+        }
+        indices.resize(index_offset);
+        vertices.resize(vertex_offset);
 
-        const uint32_t vertex_count = assimp_mesh->mNumVertices;
-        const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
+        // Meshes vary a lot in size, so the ranges are ignored and every task takes the next mesh until there are none left
+        atomic<uint32_t> next = { 0 };
+        const auto convert = [&](uint32_t /*start*/, uint32_t /*end*/)
+        {
+            for (uint32_t i = next++; i < mesh_count; i = next++)
+            {
+                ModelMesh& model_mesh = meshes[i];
+                LoadMesh(assimp_meshes[i], &vertices[model_mesh.vertex_offset], &indices[model_mesh.index_offset]);
+                model_mesh.aabb = BoundingBox(&vertices[model_mesh.vertex_offset], model_mesh.vertex_count);
+            }
+        };
 
-		// Vertices
-        vector<RHI_Vertex_PosTexNorTan> vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
-		{
-			for (uint32_t i = 0; i < vertex_count; i++)
-			{
-				auto& vertex = vertices[i];
+        if (threading)
+        {
+            threading->AddTaskLoop(convert, mesh_count);
+        }
+        else
+        {
+            convert(0, mesh_count);
+        }
+    }
 
-				// Position
-				const auto& pos = assimp_mesh->mVertices[i];
-				vertex.pos[0] = pos.x;
-				vertex.pos[1] = pos.y;
-				vertex.pos[2] = pos.z;
+    void ModelImporter::OptimizeMeshes(Mesh* mesh, vector<ModelMesh>& meshes, Threading* threading)
+    {
+        if (meshes.empty())
+            return;
 
-				// Normal
-				if (assimp_mesh->mNormals)
-				{
-					const auto& normal = assimp_mesh->mNormals[i];
-					vertex.nor[0] = normal.x;
-					vertex.nor[1] = normal.y;
-					vertex.nor[2] = normal.z;
-				}
+        vector<uint32_t>& indices                   = mesh->Indices_Get();
+        vector<RHI_Vertex_PosTexNorTan>& vertices   = mesh->Vertices_Get();
 
-				// Tangent
-				if (assimp_mesh->mTangents)
-				{
-					const auto& tangent = assimp_mesh->mTangents[i];
-					vertex.tan[0] = tangent.x;
-					vertex.tan[1] = tangent.y;
-					vertex.tan[2] = tangent.z;
-				}
+        // Indices are relative to the mesh they belong to, so every mesh can be optimized on its own
+        atomic<uint32_t> next = { 0 };
+        const uint32_t mesh_count = static_cast<uint32_t>(meshes.size());
+        const auto optimize = [&](uint32_t /*start*/, uint32_t /*end*/)
+        {
+            for (uint32_t i = next++; i < mesh_count; i = next++)
+            {
+                ModelMesh& model_mesh   = meshes[i];
+                model_mesh.vertex_count = MeshOptimizer::Optimize(&indices[model_mesh.index_offset], model_mesh.index_count, &vertices[model_mesh.vertex_offset], model_mesh.vertex_count);
+                model_mesh.aabb         = BoundingBox(&vertices[model_mesh.vertex_offset], model_mesh.vertex_count);
+            }
+        };
 
-				// Texture coordinates
-				const uint32_t uv_channel = 0;
-				if (assimp_mesh->HasTextureCoords(uv_channel))
-				{
-					const auto& tex_coords = assimp_mesh->mTextureCoords[uv_channel][i];
-					vertex.tex[0] = tex_coords.x;
-					vertex.tex[1] = tex_coords.y;
-				}
-			}
-		}
+        if (threading)
+        {
+            threading->AddTaskLoop(optimize, mesh_count);
+        }
+        else
+        {
+            optimize(0, mesh_count);
+        }
 
-		// Indices
-		vector<uint32_t> indices = vector<uint32_t>(index_count);
-		{
-			// Get indices by iterating through each face of the mesh.
-			for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
-			{
-				// if (aiPrimitiveType_LINE | aiPrimitiveType_POINT) && aiProcess_Triangulate) then (face.mNumIndices == 3)
-				auto& face					= assimp_mesh->mFaces[face_index];
-				const auto indices_index	= (face_index * 3);
-				indices[indices_index + 0]	= face.mIndices[0];
-				indices[indices_index + 1]	= face.mIndices[1];
-				indices[indices_index + 2]	= face.mIndices[2];
-			}
-		}
+        // Merged and unused vertices leave gaps at the end of each mesh, close them
+        uint32_t vertex_offset = meshes.front().vertex_offset;
+        for (ModelMesh& model_mesh : meshes)
+        {
+            if (model_mesh.vertex_offset != vertex_offset)
+            {
+                move(vertices.begin() + model_mesh.vertex_offset, vertices.begin() + model_mesh.vertex_offset + model_mesh.vertex_count, vertices.begin() + vertex_offset);
+                model_mesh.vertex_offset = vertex_offset;
+            }
+            vertex_offset += model_mesh.vertex_count;
+        }
+        vertices.resize(vertex_offset);
+        vertices.shrink_to_fit();
+    }
+
+    void ModelImporter::GenerateLods(Mesh* mesh, vector<ModelMesh>& meshes, Threading* threading)
+    {
+        // Every level has half the triangles of the one before, down to meshes which are too small to bother
+        const uint32_t lod_count            = 4;
+        const uint32_t lod_triangle_count   = 256;
+
+        vector<uint32_t>& indices                       = mesh->Indices_Get();
+        const vector<RHI_Vertex_PosTexNorTan>& vertices = mesh->Vertices_Get();
+
+        // Each mesh writes its levels to its own indices, with offsets relative to them
+        vector<vector<uint32_t>> lod_indices(meshes.size());
+        atomic<uint32_t> next = { 0 };
+        const uint32_t mesh_count = static_cast<uint32_t>(meshes.size());
+        const auto simplify = [&](uint32_t /*start*/, uint32_t /*end*/)
+        {
+            for (uint32_t i = next++; i < mesh_count; i = next++)
+            {
+                ModelMesh& model_mesh       = meshes[i];
+                vector<uint32_t>& lods      = lod_indices[i];
+                uint32_t index_count        = model_mesh.index_count;
+                model_mesh.lods.clear();
+
+                for (uint32_t lod = 1; lod < lod_count && index_count / 3 >= lod_triangle_count; lod++)
+                {
+                    // Always from the full detail, so that the errors don't add up
+                    const uint32_t offset = static_cast<uint32_t>(lods.size());
+                    lods.resize(offset + model_mesh.index_count);
+                    float error = 0.0f;
+                    const uint32_t lod_index_count = MeshOptimizer::Simplify(&lods[offset], &indices[model_mesh.index_offset], model_mesh.index_count, &vertices[model_mesh.vertex_offset], model_mesh.vertex_count, index_count / 6 * 3, &error);
+                    lods.resize(offset + lod_index_count);
+
+                    // Not worth a level, the mesh can't be simplified much further without breaking apart
+                    if (lod_index_count > index_count * 3 / 4)
+                    {
+                        lods.resize(offset);
+                        break;
+                    }
+
+                    MeshOptimizer::OptimizeVertexCache(&lods[offset], lod_index_count, model_mesh.vertex_count);
+                    model_mesh.lods.push_back({ offset, lod_index_count, error });
+                    index_count = lod_index_count;
+                }
+            }
+        };
+
+        if (threading)
+        {
+            threading->AddTaskLoop(simplify, mesh_count);
+        }
+        else
+        {
+            simplify(0, mesh_count);
+        }
+
+        // The levels go after the full detail indices of every mesh, so those stay where they are
+        for (uint32_t i = 0; i < mesh_count; i++)
+        {
+            for (Geometry_Lod& lod : meshes[i].lods)
+            {
+                lod.index_offset += static_cast<uint32_t>(indices.size());
+            }
+            indices.insert(indices.end(), lod_indices[i].begin(), lod_indices[i].end());
+        }
+    }
 
-		// Compute AABB (before doing move operation on vertices)
-		const auto aabb = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
-
-		// Add the mesh to the model
-		uint32_t index_offset;
-		uint32_t vertex_offset;
-        params.model->AppendGeometry(move(indices), move(vertices), &index_offset, &vertex_offset);
-
-		// Add a renderable component to this entity
-		auto renderable	= entity_parent->AddComponent<Renderable>();
-
-		// Set the geometry
-		renderable->GeometrySet(
-			entity_parent->GetName(),
-			index_offset,
-			static_cast<uint32_t>(indices.size()),
-			vertex_offset,
-			static_cast<uint32_t>(vertices.size()),
-			aabb,
-            params.model
-		);
-
-		// Material
-		if (params.scene->HasMaterials())
+	void ModelImporter::LoadMesh(const aiMesh* assimp_mesh, RHI_Vertex_PosTexNorTan* vertices, uint32_t* indices)
+	{
+        static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "The vertices are converted as floats");
+
+        const uint32_t vertex_count     = assimp_mesh->mNumVertices;
+        const aiVector3D* positions     = assimp_mesh->mVertices;
+        const aiVector3D* normals       = assimp_mesh->mNormals;
+        const aiVector3D* tangents      = assimp_mesh->mTangents;
+        const aiVector3D* tex_coords    = assimp_mesh->HasTextureCoords(0) ? assimp_mesh->mTextureCoords[0] : nullptr;
+
+		// Vertices, four floats at a time. Each store spills a float into the attribute that follows (the tangent into the
+		// next vertex) which is written right after, so the last vertex, which would spill (and read) past the end, is copied
+		// one float at a time
+        const __m128 zero                   = _mm_setzero_ps();
+        const uint32_t vertex_count_simd    = vertex_count != 0 ? vertex_count - 1 : 0;
+        for (uint32_t i = 0; i < vertex_count_simd; i++)
+        {
+            RHI_Vertex_PosTexNorTan& vertex = vertices[i];
+            _mm_storeu_ps(vertex.pos, _mm_loadu_ps(&positions[i].x));
+            _mm_storel_pi(reinterpret_cast<__m64*>(vertex.tex), tex_coords ? _mm_loadu_ps(&tex_coords[i].x) : zero);
+            _mm_storeu_ps(vertex.nor, normals ? _mm_loadu_ps(&normals[i].x) : zero);
+            _mm_storeu_ps(vertex.tan, tangents ? _mm_loadu_ps(&tangents[i].x) : zero);
+        }
+
+        for (uint32_t i = vertex_count_simd; i < vertex_count; i++)
+        {
+            RHI_Vertex_PosTexNorTan& vertex = vertices[i];
+            const aiVector3D zero_vector    = aiVector3D(0.0f, 0.0f, 0.0f);
+            const aiVector3D& position      = positions[i];
+            const aiVector3D& tex_coord     = tex_coords ? tex_coords[i] : zero_vector;
+            const aiVector3D& normal        = normals ? normals[i] : zero_vector;
+            const aiVector3D& tangent       = tangents ? tangents[i] : zero_vector;
+            vertex                          = RHI_Vertex_PosTexNorTan(Vector3(position.x, position.y, position.z), Vector2(tex_coord.x, tex_coord.y), Vector3(normal.x, normal.y, normal.z), Vector3(tangent.x, tangent.y, tangent.z));
+        }
+
+		// Indices (if (aiPrimitiveType_LINE | aiPrimitiveType_POINT) && aiProcess_Triangulate) then (face.mNumIndices == 3))
+		for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
 		{
-			// Get aiMaterial
-			const auto assimp_material = params.scene->mMaterials[assimp_mesh->mMaterialIndex];
-			// Convert it and add it to the model
-            shared_ptr<Material> material = LoadMaterial(assimp_material, params);
-            params.model->AddMaterial(material, entity_parent->GetPtrShared());
+			const aiFace& face		= assimp_mesh->mFaces[face_index];
+			uint32_t* triangle		= indices + face_index * 3;
+			triangle[0]				= face.mIndices[0];
+			triangle[1]				= face.mIndices[1];
+			triangle[2]				= face.mIndices[2];
 		}
-
-		// Bones
-        LoadBones(assimp_mesh, params);
 	}
 
     void ModelImporter::LoadBones(const aiMesh* assimp_mesh, const ModelParams& params)
@@ -409,7 +980,92 @@ namespace Spartan
         //boneTransforms.resize(numBones);
     }
 
-    shared_ptr<Material> ModelImporter::LoadMaterial(aiMaterial* assimp_material, const ModelParams& params)
+    void ModelImporter::LoadMaterials(ModelParams& params)
+    {
+        // The materials, and the textures they use
+        vector<TextureSlot> texture_slots;
+        params.materials.resize(params.scene->mNumMaterials);
+        for (uint32_t i = 0; i < params.scene->mNumMaterials; i++)
+        {
+            params.materials[i] = LoadMaterial(params.scene->mMaterials[i], params, i, texture_slots);
+        }
+
+        // Every texture once, those which aren't cached already are loaded in parallel
+        ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
+        unordered_map<string, uint32_t> texture_indices;
+        vector<shared_ptr<RHI_Texture>> textures;
+        vector<const TextureSlot*> texture_loads;
+        for (const TextureSlot& slot : texture_slots)
+        {
+            if (texture_indices.find(slot.file_path) != texture_indices.end())
+                continue;
+
+            texture_indices[slot.file_path] = static_cast<uint32_t>(textures.size());
+            textures.emplace_back(resource_cache->GetByName<RHI_Texture2D>(FileSystem::GetFileNameNoExtensionFromFilePath(slot.file_path)));
+            texture_loads.emplace_back(&slot); // the first slot which uses a texture decides its compression
+        }
+
+        ProgressReport::Get().SetStatus(g_progress_model_importer, "Loading textures...");
+        atomic<uint32_t> next = { 0 };
+        const auto load = [&](uint32_t /*start*/, uint32_t /*end*/)
+        {
+            for (uint32_t i = next++; i < static_cast<uint32_t>(textures.size()); i = next++)
+            {
+                if (textures[i])
+                    continue;
+
+                const bool generate_mipmaps = true;
+                auto texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
+                texture->SetCompression(Model::GetTextureCompression(texture_loads[i]->type));
+                if (texture->LoadFromFile(texture_loads[i]->file_path))
+                {
+                    textures[i] = texture;
+                }
+            }
+        };
+        m_context->GetSubsystem<Threading>()->AddTaskLoop(load, static_cast<uint32_t>(textures.size()));
+
+        // Assign them, which caches them, serially
+        for (const TextureSlot& slot : texture_slots)
+        {
+            const shared_ptr<RHI_Texture>& texture = textures[texture_indices[slot.file_path]];
+            if (!texture)
+                continue;
+
+            shared_ptr<Material>& material = params.materials[slot.material_index];
+            material->SetTextureSlot(slot.type, texture);
+
+            // FIX: materials that have a diffuse texture should not be tinted black/gray
+            if (slot.is_albedo)
+            {
+                material->SetColorAlbedo(Vector4::One);
+            }
+
+            // Some models (or Assimp) pass a normal map as a height map
+            // auto textureType others pass a height map as a normal map, we try to fix that.
+            if (slot.type == Material_Normal || slot.type == Material_Height)
+            {
+                if (const auto texture_cached = material->GetTexture_PtrShared(slot.type))
+                {
+                    auto proper_type = slot.type;
+                    proper_type = (proper_type == Material_Normal && texture_cached->GetGrayscale()) ? Material_Height : proper_type;
+                    proper_type = (proper_type == Material_Height && !texture_cached->GetGrayscale()) ? Material_Normal : proper_type;
+
+                    if (proper_type != slot.type)
+                    {
+                        material->SetTextureSlot(slot.type, shared_ptr<RHI_Texture>());
+                        material->SetTextureSlot(proper_type, texture_cached);
+                    }
+                }
+                else
+                {
+                    LOG_ERROR("Failed to get texture");
+                }
+            }
+        }
+    }
+
+    shared_ptr<Material> ModelImporter::LoadMaterial(aiMaterial* assimp_material, const ModelParams& params, const uint32_t material_index, vector<TextureSlot>& texture_slots)
 	{
 		if (!assimp_material)
 		{
@@ -435,8 +1091,8 @@ namespace Spartan
 
 		material->SetColorAlbedo(Vector4(color_diffuse.r, color_diffuse.g, color_diffuse.b, opacity.r));
 
-		// TEXTURES
-		const auto load_mat_tex = [&params, &assimp_material, &material](const Material_Property type_spartan, const aiTextureType type_assimp_pbr, const aiTextureType type_assimp_legacy)
+		// TEXTURES, which are loaded (all of them at once) by LoadMaterials()
+		const auto load_mat_tex = [&params, &assimp_material, &texture_slots, material_index](const Material_Property type_spartan, const aiTextureType type_assimp_pbr, const aiTextureType type_assimp_legacy)
 		{
             aiTextureType type_assimp   = assimp_material->GetTextureCount(type_assimp_pbr)     > 0 ? type_assimp_pbr       : aiTextureType_NONE;
             type_assimp                 = assimp_material->GetTextureCount(type_assimp_legacy)  > 0 ? type_assimp_legacy    : type_assimp;
@@ -449,35 +1105,12 @@ namespace Spartan
 					const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, params.file_path);
 					if (FileSystem::IsSupportedImageFile(deduced_path))
 					{
-                        params.model->AddTexture(material, type_spartan, AssimpHelper::texture_validate_path(texture_path.data, params.file_path));
-
-						if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
-						{
-							// FIX: materials that have a diffuse texture should not be tinted black/gray
-							material->SetColorAlbedo(Vector4::One);
-						}
-
-						// Some models (or Assimp) pass a normal map as a height map
-						// auto textureType others pass a height map as a normal map, we try to fix that.
-						if (type_spartan == Material_Normal || type_spartan == Material_Height)
-						{
-                            if (const auto texture = material->GetTexture_PtrShared(type_spartan))
-                            {
-                                auto proper_type = type_spartan;
-                                proper_type = (proper_type == Material_Normal && texture->GetGrayscale()) ? Material_Height : proper_type;
-                                proper_type = (proper_type == Material_Height && !texture->GetGrayscale()) ? Material_Normal : proper_type;
-
-                                if (proper_type != type_spartan)
-                                {
-                                    material->SetTextureSlot(type_spartan, shared_ptr<RHI_Texture>());
-                                    material->SetTextureSlot(proper_type, texture);
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("Failed to get texture");
-                            }
-						}
+                        TextureSlot slot;
+                        slot.material_index = material_index;
+                        slot.type           = type_spartan;
+                        slot.is_albedo      = type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE;
+                        slot.file_path      = deduced_path;
+                        texture_slots.emplace_back(slot);
 					}
 				}
 			}
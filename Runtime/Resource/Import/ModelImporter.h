@@ -23,8 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include "../../Core/EngineDefs.h"
+#include "../../Math/BoundingBox.h"
+#include "../../World/Components/Renderable.h"
 #include <memory>
 #include <string>
+#include <vector>
 //================================
 
 struct aiNode;
@@ -38,7 +41,21 @@ namespace Spartan
 	class Material;
 	class Entity;
 	class Model;
+	class Mesh;
 	class World;
+	class Threading;
+	struct RHI_Vertex_PosTexNorTan;
+
+    // Where an Assimp mesh ended up in the geometry of the model
+    struct ModelMesh
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        uint32_t vertex_offset  = 0;
+        uint32_t vertex_count   = 0;
+        Math::BoundingBox aabb;
+        std::vector<Geometry_Lod> lods;
+    };
 
     struct ModelParams
     {
@@ -51,6 +68,8 @@ namespace Spartan
         bool has_animation;
         Model* model            = nullptr;
         const aiScene* scene    = nullptr;
+        std::vector<ModelMesh> meshes;                      // one for every mesh of the scene
+        std::vector<std::shared_ptr<Material>> materials;   // one for every material of the scene
     };
 
 	class SPARTAN_CLASS ModelImporter
@@ -61,16 +80,33 @@ namespace Spartan
 
 		bool Load(Model* model, const std::string& file_path);
 
+        // Converts meshes straight into the geometry of a mesh, which grows to fit them, in parallel
+        static void LoadMeshes(const aiMesh* const* assimp_meshes, uint32_t mesh_count, Mesh* mesh, std::vector<ModelMesh>& meshes, Threading* threading);
+        // Runs the MeshOptimizer on every mesh, in parallel, and packs the vertices that are left together
+        static void OptimizeMeshes(Mesh* mesh, std::vector<ModelMesh>& meshes, Threading* threading);
+        // Simplifies every mesh into levels of detail, in parallel, whose indices follow those of all the meshes
+        static void GenerateLods(Mesh* mesh, std::vector<ModelMesh>& meshes, Threading* threading);
+
+        // Converts a generated scene one mesh at a time and with LoadMeshes(), both have to produce the same vertices and indices
+        static bool Benchmark(Threading* threading, uint32_t mesh_count = 1000, uint32_t triangle_count = 1000000);
+
 	private:
-        // Parsing
+        struct TextureSlot;
+
+        // Parsing, which creates the entities, once the meshes and the materials have been loaded
 		void ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
         void ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, const ModelParams& params);
         void ParseAnimations(const ModelParams& params);
 
         // Loading
-		void LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params);
+		static void LoadMesh(const aiMesh* assimp_mesh, RHI_Vertex_PosTexNorTan* vertices, uint32_t* indices);
         void LoadBones(const aiMesh* assimp_mesh, const ModelParams& params);
-		std::shared_ptr<Material> LoadMaterial(aiMaterial* assimp_material, const ModelParams& params);
+        void LoadMaterials(ModelParams& params);
+		std::shared_ptr<Material> LoadMaterial(aiMaterial* assimp_material, const ModelParams& params, uint32_t material_index, std::vector<TextureSlot>& texture_slots);
+
+        // The native assets an import produced (geometry, materials and the hierarchy), so that the next import of the same file can skip Assimp
+        bool LoadImported(ModelParams& params, const std::vector<std::string>& products);
+        void SaveImported(const ModelParams& params, uint64_t import_key) const;
 
         // Dependencies
 		Context* m_context;
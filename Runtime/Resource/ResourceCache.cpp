@@ -25,9 +25,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Import/ImageImporter.h"
 #include "Import/ModelImporter.h"
 #include "Import/FontImporter.h"
+#include "Import/ImportDatabase.h"
 #include "../World/World.h"
 #include "../World/Entity.h"
 #include "../IO/FileStream.h"
+#include "../IO/Package.h"
+#include "../Threading/Threading.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
 #include "../Audio/AudioClip.h"
@@ -68,6 +71,12 @@ namespace Spartan
 		// Unsubscribe from event
 		UNSUBSCRIBE_FROM_EVENT(Event_World_Unload, EVENT_HANDLER(Clear));
 		Clear();
+
+		// Remember what was imported during this session
+		if (m_import_database)
+		{
+			m_import_database->Save();
+		}
 	}
 
 	bool ResourceCache::Initialize()
@@ -76,6 +85,14 @@ namespace Spartan
 		m_importer_image	= make_shared<ImageImporter>(m_context);
 		m_importer_model	= make_shared<ModelImporter>(m_context);
 		m_importer_font		= make_shared<FontImporter>(m_context);
+
+		// Imports of unchanged files are skipped, the native assets they produced the last time are used instead
+		m_import_database = make_unique<ImportDatabase>(GetDataDirectory() + "/import_cache");
+		m_import_database->Load();
+
+		// Mount again, now that threading is available for decompression
+		MountPackages();
+
 		return true;
 	}
 
@@ -169,6 +186,11 @@ namespace Spartan
 			}
 		}
 
+		if (m_import_database)
+		{
+			m_import_database->Save();
+		}
+
 		// Finish with progress report
 		ProgressReport::Get().SetIsLoading(g_progress_resource_cache, false);
 	}
@@ -291,6 +313,18 @@ namespace Spartan
 		}
 
 		m_project_directory = directory;
+		MountPackages();
+	}
+
+	void ResourceCache::MountPackages()
+	{
+		for (const string& file_path : FileSystem::GetFilesInDirectory(m_project_directory))
+		{
+			if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_PACKAGE)
+			{
+				Package::Mount(file_path, m_project_directory, m_context->GetSubsystem<Threading>());
+			}
+		}
 	}
 
 	string ResourceCache::GetProjectDirectoryAbsolute() const
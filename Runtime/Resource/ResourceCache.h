@@ -33,6 +33,7 @@ namespace Spartan
     class FontImporter;
     class ImageImporter;
     class ModelImporter;
+    class ImportDatabase;
 
 	enum Asset_Type
 	{
@@ -196,8 +197,12 @@ namespace Spartan
 		auto GetModelImporter() const { return m_importer_model.get(); }
 		auto GetImageImporter() const { return m_importer_image.get(); }
 		auto GetFontImporter()  const { return m_importer_font.get(); }
+		auto GetImportDatabase() const { return m_import_database.get(); }
 
 	private:
+		// Mounts the packages in the project directory, so that their files load as if they were on disk
+		void MountPackages();
+
 		// Cache
 		std::unordered_map<Resource_Type, std::vector<std::shared_ptr<IResource>>> m_resource_groups;
 		std::mutex m_mutex;
@@ -210,5 +215,6 @@ namespace Spartan
 		std::shared_ptr<ModelImporter> m_importer_model;
 		std::shared_ptr<ImageImporter> m_importer_image;
 		std::shared_ptr<FontImporter> m_importer_font;
+		std::unique_ptr<ImportDatabase> m_import_database;
 	};
 }
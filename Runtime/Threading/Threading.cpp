@@ -74,14 +74,8 @@ namespace Spartan
 
     uint32_t Threading::GetThreadsAvailable() const
     {
-        uint32_t available_threads = m_thread_count;
-
-        for (const auto& task : m_tasks)
-        {
-            available_threads -= task->IsExecuting() ? 1 : 0;
-        }
-
-        return available_threads;
+        const uint32_t tasks_pending = m_tasks_pending;
+        return tasks_pending < m_thread_count ? m_thread_count - tasks_pending : 0;
     }
 
     void Threading::Flush(bool removed_queued /*= false*/)
@@ -89,6 +83,8 @@ namespace Spartan
         // Clear any queued tasks
         if (removed_queued)
         {
+            unique_lock<mutex> lock(m_mutex_tasks);
+            m_tasks_pending -= static_cast<uint32_t>(m_tasks.size());
             m_tasks.clear();
         }
 
@@ -125,6 +121,7 @@ namespace Spartan
 
             // Execute the task.
             task->Execute();
+            m_tasks_pending--;
         }
     }
 }
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <deque>
 #include <unordered_map>
 #include <functional>
+#include <atomic>
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
 //=============================
@@ -70,6 +71,7 @@ namespace Spartan
 
 			// Save the task
 			m_tasks.push_back(std::make_shared<Task>(std::bind(std::forward<Function>(function))));
+            m_tasks_pending++;
 
 			// Unlock the mutex
 			lock.unlock();
@@ -82,9 +84,10 @@ namespace Spartan
         template <typename Function>
         void AddTaskLoop(Function&& function, uint32_t range)
         {
-            uint32_t available_threads  = GetThreadsAvailable();
-            vector<bool> tasks_done     = vector<bool>(available_threads, false);
-            const uint32_t task_count   = available_threads + 1; // plus one for the current thread
+            // Only threads which are idle take part, so a task can run a loop of its own without waiting on threads that are busy
+            uint32_t available_threads          = GetThreadsAvailable();
+            std::atomic<uint32_t> tasks_done    = { 0 };
+            const uint32_t task_count           = available_threads + 1; // plus one for the current thread
 
             uint32_t start  = 0;
             uint32_t end    = 0;
@@ -94,22 +97,14 @@ namespace Spartan
                 end     = start + (range / task_count);
 
                 // Kick off task
-                AddTask([&function, &tasks_done, i, start, end] { function(start, end); tasks_done[i] = true; });
+                AddTask([&function, &tasks_done, start, end] { function(start, end); tasks_done++; });
             }
 
             // Do last task in the current thread
             function(end, range);
 
             // Wait till the threads are done
-            uint32_t tasks = 0;
-            while (tasks != tasks_done.size())
-            {
-                tasks = 0;
-                for (const bool job_done : tasks_done)
-                {
-                    tasks += job_done ? 1 : 0;
-                }
-            }
+            while (tasks_done != available_threads) {}
         }
 
         // Get the number of threads used
@@ -133,6 +128,7 @@ namespace Spartan
 		std::deque<std::shared_ptr<Task>> m_tasks;
 		std::mutex m_mutex_tasks;
 		std::condition_variable m_condition_var;
+        std::atomic<uint32_t> m_tasks_pending = { 0 }; // queued or executing
         std::unordered_map<std::thread::id, std::string> m_thread_names;
 		bool m_stopping;
 	};
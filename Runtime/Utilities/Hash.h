@@ -21,6 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+//= INCLUDES ======
+#include <cstdint>
+#include <functional>
+//=================
+
 namespace Spartan::Utility::Hash
 {
     template <class T>
@@ -29,4 +34,18 @@ namespace Spartan::Utility::Hash
         std::hash<T> hasher;
         seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
+
+    // 64-bit FNV-1a, unlike std::hash the result is the same across runs and platforms, so it can be persisted
+    constexpr uint64_t fnv1a_64_offset = 14695981039346656037ull;
+    inline uint64_t fnv1a_64(const void* data, const size_t size, uint64_t hash = fnv1a_64_offset)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
 }
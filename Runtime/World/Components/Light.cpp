@@ -24,11 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Transform.h"
 #include "Camera.h"
 #include "Renderable.h"
-#include "../World.h"
+#include "../../Core/EventSystem.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
 #include "../../RHI/RHI_Texture2D.h"
-#include "../../RHI/RHI_TextureCube.h"
 //====================================
 
 //= NAMESPACES ===============
@@ -116,12 +115,9 @@ namespace Spartan
 
             ComputeViewMatrix();
 
-            if (m_shadow_map.texture_depth)
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_shadow_map.slices.size()); i++)
             {
-                for (uint32_t i = 0; i < m_shadow_map.texture_depth->GetArraySize(); i++)
-                {
-                    ComputeProjectionMatrix(i);
-                }
+                ComputeProjectionMatrix(i);
             }
         }
 
@@ -171,8 +167,8 @@ namespace Spartan
             CreateShadowMap();
         }
 
-        
-        m_context->GetSubsystem<World>()->MakeDirty();
+        // Make the scene resolve
+        FIRE_EVENT_DATA(Event_World_Resolve_Pending, m_entity);
 	}
 
 	void Light::SetShadowsEnabled(bool cast_shadows)
@@ -265,7 +261,7 @@ namespace Spartan
 
 	bool Light::ComputeProjectionMatrix(uint32_t index /*= 0*/)
 	{
-		if (index >= m_shadow_map.texture_depth->GetArraySize())
+		if (index >= static_cast<uint32_t>(m_shadow_map.slices.size()))
         {
             LOG_ERROR_INVALID_PARAMETER();
             return false;
@@ -284,9 +280,7 @@ namespace Spartan
 		}
 		else
 		{
-			const float width			= static_cast<float>(m_shadow_map.texture_depth->GetWidth());
-			const float height			= static_cast<float>(m_shadow_map.texture_depth->GetHeight());
-			const auto aspect_ratio		= width / height;
+			const auto aspect_ratio		= 1.0f; // shadow atlas tiles are square
 			const float fov				= 1.57079633f; // 1.57079633 = 90 deg
 			const float near_plane		= reverse_z ? m_range : 0.1f;
 			const float far_plane		= reverse_z ? 0.1f : m_range;
@@ -423,7 +417,7 @@ namespace Spartan
 
     uint32_t Light::GetShadowArraySize() const
     {
-        return m_shadow_map.texture_depth ? m_shadow_map.texture_depth->GetArraySize() : 0;
+        return static_cast<uint32_t>(m_shadow_map.slices.size());
     }
 
     void Light::CreateShadowMap()
@@ -442,6 +436,8 @@ namespace Spartan
         if (!m_shadows_enabled)
         {
             m_shadow_map.texture_depth = nullptr;
+            m_shadow_map.texture_color = nullptr;
+            m_shadow_map.slices.clear();
             return;
         }
 
@@ -461,27 +457,12 @@ namespace Spartan
 
             m_shadow_map.slices = vector<ShadowSlice>(m_cascade_count);
 		}
-		else if (GetLightType() == LightType_Point)
-		{
-            m_shadow_map.texture_depth = make_unique<RHI_TextureCube>(m_context, resolution, resolution, RHI_Format_D32_Float);
-
-            if (m_shadows_transparent_enabled)
-            {
-                m_shadow_map.texture_color = make_unique<RHI_TextureCube>(m_context, resolution, resolution, RHI_Format_R8G8B8A8_Unorm);
-            }
-
-            m_shadow_map.slices = vector<ShadowSlice>(6);
-		}
-		else if (GetLightType() == LightType_Spot)
+		else
 		{
-            m_shadow_map.texture_depth  = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_D32_Float, 1);
-
-            if (m_shadows_transparent_enabled)
-            {
-                m_shadow_map.texture_color = make_unique<RHI_Texture2D>(m_context, resolution, resolution, RHI_Format_R8G8B8A8_Unorm, 1);
-            }
-
-            m_shadow_map.slices = vector<ShadowSlice>(1);
+            // Point and spot lights render into the renderer's shadow atlas, one tile per face
+            m_shadow_map.texture_depth = nullptr;
+            m_shadow_map.texture_color = nullptr;
+            m_shadow_map.slices        = vector<ShadowSlice>(GetLightType() == LightType_Point ? 6 : 1);
 		}
 	}
 
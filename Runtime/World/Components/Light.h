@@ -116,6 +116,7 @@ namespace Spartan
 		const Math::Matrix& GetViewMatrix(uint32_t index = 0) const;
 		const Math::Matrix& GetProjectionMatrix(uint32_t index = 0) const;
 
+        // Directional lights only, point and spot lights render into the renderer's shadow atlas
 		RHI_Texture* GetDepthTexture() const { return m_shadow_map.texture_depth.get(); }
         RHI_Texture* GetColorTexture() const { return m_shadow_map.texture_color.get(); }
         uint32_t GetShadowArraySize() const;
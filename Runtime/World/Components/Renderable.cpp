@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../RHI/RHI_Texture2D.h"
 #include "../../Rendering/Model.h"
 #include "../../RHI/RHI_Vertex.h"
+#include "../World.h"
 //=======================================
 
 //= NAMESPACES ===============
@@ -37,6 +38,9 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	// A coarser level has to be this far below the threshold, so that a size right at it doesn't switch levels every frame
+	static const float lod_hysteresis = 0.8f;
+
 	inline void build(const Geometry_Type type, Renderable* renderable)
 	{	
 		auto model = make_shared<Model>(renderable->GetContext());
@@ -104,6 +108,7 @@ namespace Spartan
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_material,              shared_ptr<Material>);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_castShadows,           bool);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_receiveShadows,        bool);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_occluder,              bool);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryIndexOffset,   uint32_t);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryIndexCount,    uint32_t);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryVertexOffset,  uint32_t);
@@ -111,6 +116,7 @@ namespace Spartan
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryName,          string);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_model,                 shared_ptr<Model>);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounding_box,          BoundingBox);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometry_lods,         vector<Geometry_Lod>);
 		REGISTER_ATTRIBUTE_GET_SET(Geometry_Type, GeometrySet, Geometry_Type);
 	}
 
@@ -128,6 +134,7 @@ namespace Spartan
 		// Material
 		stream->Write(m_castShadows);
 		stream->Write(m_receiveShadows);
+		stream->Write(m_occluder);
 		stream->Write(m_material_default);
 		if (!m_material_default)
 		{
@@ -147,6 +154,11 @@ namespace Spartan
 		string model_name;
 		stream->Read(&model_name);
 		m_model = m_context->GetSubsystem<ResourceCache>()->GetByName<Model>(model_name);
+		m_geometry_lods.clear();
+		if (m_model)
+		{
+			m_geometry_lods = m_model->GetLods(m_geometryIndexOffset);
+		}
 
 		// If it was a default mesh, we have to reconstruct it
 		if (m_geometry_type != Geometry_Custom) 
@@ -157,6 +169,10 @@ namespace Spartan
 		// Material
 		stream->Read(&m_castShadows);
 		stream->Read(&m_receiveShadows);
+		if (m_context->GetSubsystem<World>()->GetFileVersion() >= 1)
+		{
+			stream->Read(&m_occluder);
+		}
 		stream->Read(&m_material_default);
 		if (m_material_default)
 		{
@@ -179,6 +195,28 @@ namespace Spartan
 		m_geometryVertexCount	= vertex_count;
 		m_bounding_box			= bounding_box;
 		m_model					= model ? model->GetSharedPtr() : nullptr;
+		m_geometry_lods			= model ? model->GetLods(index_offset) : vector<Geometry_Lod>();
+		m_geometry_lod			= 0;
+		m_geometry_lod_shadows	= 0;
+	}
+
+	void Renderable::GeometryLodUpdate(const float screen_size, const float threshold, const uint32_t shadow_bias)
+	{
+		// The errors are relative to the radius
+		const auto error = [this, screen_size](const uint32_t lod) { return lod == 0 ? 0.0f : m_geometry_lods[lod - 1].error * screen_size * 0.5f; };
+
+		while (m_geometry_lod + 1 < GeometryLodCount() && error(m_geometry_lod + 1) < threshold * lod_hysteresis)
+		{
+			m_geometry_lod++;
+		}
+
+		while (m_geometry_lod > 0 && error(m_geometry_lod) > threshold)
+		{
+			m_geometry_lod--;
+		}
+
+		// Shadows are blurred and seen from further away, they can take a coarser level
+		m_geometry_lod_shadows = Helper::Min(m_geometry_lod + shadow_bias, GeometryLodCount() - 1);
 	}
 
 	void Renderable::GeometrySet(const Geometry_Type type)
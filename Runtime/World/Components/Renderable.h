@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include "../../Math/BoundingBox.h"
 #include "../../Math/Matrix.h"
+#include "../../Rendering/Mesh.h"
 //=================================
 
 namespace Spartan
@@ -84,6 +85,17 @@ namespace Spartan
         const Math::BoundingBox& GetAabb();
 		//=====================================================================================================
 
+		//= LEVEL OF DETAIL =====================================================================================================
+		// The levels come from the model, which keeps them with its geometry
+		// Picks the coarsest level whose error, in pixels, is below the threshold, screen_size is the diameter of the geometry in pixels
+		void GeometryLodUpdate(float screen_size, float threshold, uint32_t shadow_bias);
+		uint32_t GeometryLodCount()						const { return static_cast<uint32_t>(m_geometry_lods.size()) + 1; }
+		uint32_t GeometryLod()							const { return m_geometry_lod; }
+		uint32_t GeometryLodShadows()					const { return m_geometry_lod_shadows; }
+		uint32_t GeometryIndexOffset(uint32_t lod)		const { return lod == 0 || m_geometry_lods.empty() ? m_geometryIndexOffset : m_geometry_lods[Math::Helper::Min(lod, GeometryLodCount() - 1) - 1].index_offset; }
+		uint32_t GeometryIndexCount(uint32_t lod)		const { return lod == 0 || m_geometry_lods.empty() ? m_geometryIndexCount : m_geometry_lods[Math::Helper::Min(lod, GeometryLodCount() - 1) - 1].index_count; }
+		//=======================================================================================================================
+
 		//= MATERIAL ============================================================
 		// Sets a material from memory (adds it to the resource cache by default)
 		void SetMaterial(const std::shared_ptr<Material>& material);
@@ -102,6 +114,8 @@ namespace Spartan
 		auto GetCastShadows() const							{ return m_castShadows; }
 		void SetReceiveShadows(const bool receive_shadows)	{ m_receiveShadows = receive_shadows; }
 		auto GetReceiveShadows() const						{ return m_receiveShadows; }
+		void SetOccluder(const bool occluder)				{ m_occluder = occluder; }
+		auto IsOccluder() const								{ return m_occluder; } // always used as an occluder by occlusion culling
 		//=========================================================================================
 
 	private:
@@ -114,9 +128,13 @@ namespace Spartan
 		Geometry_Type m_geometry_type;
 		Math::BoundingBox m_bounding_box;
 		Math::BoundingBox m_aabb;
+		std::vector<Geometry_Lod> m_geometry_lods;
+		uint32_t m_geometry_lod			= 0;
+		uint32_t m_geometry_lod_shadows	= 0;
         Math::Matrix m_last_transform   = Math::Matrix::Identity;
         bool m_castShadows              = true;
         bool m_receiveShadows           = true;
+        bool m_occluder                 = false;
 		bool m_material_default;
         std::shared_ptr<Material> m_material;
 	};
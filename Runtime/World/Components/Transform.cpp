@@ -43,6 +43,7 @@ namespace Spartan
 		m_matrixLocal		= Matrix::Identity;
 		m_wvp_previous		= Matrix::Identity;
 		m_parent			= nullptr;
+		m_revision			= 0;
 
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_positionLocal,	Vector3);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_rotationLocal,	Quaternion);
@@ -89,6 +90,8 @@ namespace Spartan
 	//===============================================================================================
 	void Transform::UpdateTransform()
 	{
+		const Matrix matrix_previous = m_matrix;
+
 		// Compute local transform
 		m_matrixLocal = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
 
@@ -101,6 +104,12 @@ namespace Spartan
 		{
 			m_matrix = m_matrixLocal * GetParentTransformMatrix();
 		}
+
+		// Dirty tracking, lets anything which caches work based on this transform know that it moved
+		if (m_matrix != matrix_previous)
+		{
+			m_revision++;
+		}
 		
 		// Update children
 		for (const auto& child : m_children)
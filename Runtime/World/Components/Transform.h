@@ -107,6 +107,7 @@ namespace Spartan
 		const Math::Matrix& GetLocalMatrix()                const { return m_matrixLocal; }
         const Math::Matrix& GetWvpLastFrame()               const { return m_wvp_previous; }
         void SetWvpLastFrame(const Math::Matrix& matrix)          { m_wvp_previous = matrix;}
+        uint32_t GetRevision()                              const { return m_revision; } // increments every time the world matrix changes
 
 	private:
 		Math::Matrix GetParentTransformMatrix() const;
@@ -124,5 +125,6 @@ namespace Spartan
 		std::vector<Transform*> m_children; // the children of this transform
 
 		Math::Matrix m_wvp_previous;
+		uint32_t m_revision;
 	};
 }
@@ -272,7 +272,7 @@ namespace Spartan
         }
 
 		// Make the scene resolve
-		FIRE_EVENT(Event_World_Resolve_Pending);
+		FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
 	}
 
     IComponent* Entity::AddComponent(const ComponentType type, uint32_t id /*= 0*/)
@@ -336,6 +336,6 @@ namespace Spartan
         }
 
 		// Make the scene resolve
-		FIRE_EVENT(Event_World_Resolve_Pending);
+		FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
 	}
 }
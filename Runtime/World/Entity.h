@@ -51,7 +51,14 @@ namespace Spartan
 		void SetName(const std::string& name)							{ m_name = name; }
 
 		bool IsActive() const											{ return m_is_active; }
-		void SetActive(const bool active)								{ m_is_active = active; }
+		void SetActive(const bool active)
+		{
+			if (m_is_active == active)
+				return;
+
+			m_is_active = active;
+			FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
+		}
 
 		bool IsVisibleInHierarchy() const								{ return m_hierarchy_visibility; }
 		void SetHierarchyVisibility(const bool hierarchy_visibility)	{ m_hierarchy_visibility = hierarchy_visibility; }
@@ -83,7 +90,7 @@ namespace Spartan
             component->OnInitialize();
 
 			// Make the scene resolve
-			FIRE_EVENT(Event_World_Resolve_Pending);
+			FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
 
             return component.get();
 		}
@@ -159,7 +166,7 @@ namespace Spartan
 			}
 
 			// Make the scene resolve
-			FIRE_EVENT(Event_World_Resolve_Pending);
+			FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
 		}
 
 		void RemoveComponentById(uint32_t id);
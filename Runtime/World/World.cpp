@@ -43,12 +43,20 @@ using namespace std;
 using namespace Spartan::Math;
 //=============================
 
+namespace Spartan::world_file
+{
+    // Layout: magic | version | root entity count | root entity ids | root entities
+    // Files which predate the header start directly with the root entity count.
+    static const uint32_t magic             = 0x444C5257; // "WRLD"
+    static const uint32_t version_current   = 1;
+}
+
 namespace Spartan
 {
 	World::World(Context* context) : ISubsystem(context)
 	{
 		// Subscribe to events
-		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Pending, [this](Variant) { m_is_dirty = true; });
+		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Pending, EVENT_HANDLER_VARIANT(EntityMarkModified));
 		SUBSCRIBE_TO_EVENT(Event_World_Stop,	        [this](Variant)	{ m_state = Idle; });
 		SUBSCRIBE_TO_EVENT(Event_World_Start,	        [this](Variant)	{ m_state = Ticking; });
 	}
@@ -117,25 +125,54 @@ namespace Spartan
             }
 		}
 
-        if (m_is_dirty)
+        // Resolve
         {
-            // Update dirty entities
+            m_resolve_delta.Clear();
+
             {
-                // Make a copy so we can iterate while removing entities
-                auto entities_copy = m_entities;
+                lock_guard<recursive_mutex> lock(m_entities_mutex);
+
+                // Remove entities pending destruction, their descendants are appended as they are found
+                for (uint32_t i = 0; i < static_cast<uint32_t>(m_entities_pending_destruction.size()); i++)
+                {
+                    const shared_ptr<Entity> entity = m_entities_pending_destruction[i];
+                    _EntityRemove(entity);
+                }
+                m_entities_pending_destruction.clear();
 
-                for (const auto& entity : entities_copy)
+                if (m_is_dirty)
+                {
+                    // Full resolve, publish every entity
+                    m_resolve_delta.reset = true;
+                    m_resolve_delta.added.reserve(m_entities.size());
+                    for (const auto& entity : m_entities)
+                    {
+                        m_resolve_delta.added.emplace_back(entity.get());
+                    }
+                }
+                else
                 {
-                    if (entity->IsPendingDestruction())
+                    m_resolve_delta.added.swap(m_entities_added);
+                    m_resolve_delta.modified.assign(m_entities_modified.begin(), m_entities_modified.end());
+                    for (const auto& entity : m_entities_removed)
                     {
-                        _EntityRemove(entity);
+                        m_resolve_delta.removed.emplace_back(entity.get());
                     }
                 }
+
+                m_entities_added.clear();
+                m_entities_modified.clear();
+                m_is_dirty = false;
             }
 
             // Notify Renderer
-            FIRE_EVENT_DATA(Event_World_Resolve_Complete, m_entities);
-            m_is_dirty = false;
+            if (!m_resolve_delta.IsEmpty())
+            {
+                FIRE_EVENT_DATA(Event_World_Resolve_Complete, &m_resolve_delta);
+            }
+
+            // Removed entities can now be released
+            m_entities_removed.clear();
         }
 	}
 
@@ -144,8 +181,16 @@ namespace Spartan
         // Notify any systems that the entities are about to be cleared
 		FIRE_EVENT(Event_World_Unload);
 
+        lock_guard<recursive_mutex> lock(m_entities_mutex);
+
         m_entities.clear();
         m_entities.shrink_to_fit();
+        m_entity_indices.clear();
+
+        m_entities_added.clear();
+        m_entities_modified.clear();
+        m_entities_pending_destruction.clear();
+        m_entities_removed.clear();
 
 		m_is_dirty = true;
 	}
@@ -183,6 +228,10 @@ namespace Spartan
 
 		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
 
+		// Save the header
+		file->Write(world_file::magic);
+		file->Write(world_file::version_current);
+
 		// Save root entity count
 		file->Write(root_entity_count);
 
@@ -243,6 +292,22 @@ namespace Spartan
 		// Notify subsystems that need to load data
 		FIRE_EVENT(Event_World_Load);
 
+		// Load the header, components read older layouts based on the version
+		m_file_version = 0;
+		if (file->ReadAs<uint32_t>() == world_file::magic)
+		{
+			file->Read(&m_file_version);
+			if (m_file_version > world_file::version_current)
+			{
+				LOG_ERROR("\"%s\" is version %d, this build reads up to version %d", file_path.c_str(), m_file_version, world_file::version_current);
+				return false;
+			}
+		}
+		else
+		{
+			file->Seek(0);
+		}
+
 		// Load root entity count
         const auto root_entity_count = file->ReadAs<uint32_t>();
 
@@ -273,8 +338,12 @@ namespace Spartan
 
     shared_ptr<Entity>& World::EntityCreate(bool is_active /*= true*/)
     {
+        lock_guard<recursive_mutex> lock(m_entities_mutex);
+
         auto& entity = m_entities.emplace_back(make_shared<Entity>(m_context));
+        m_entity_indices[entity.get()] = static_cast<uint32_t>(m_entities.size() - 1);
         entity->SetActive(is_active);
+        m_entities_added.emplace_back(entity.get());
         return entity;
     }
 
@@ -285,6 +354,10 @@ namespace Spartan
 		if (!entity)
 			return empty;
 
+        lock_guard<recursive_mutex> lock(m_entities_mutex);
+
+        m_entities_added.emplace_back(entity.get());
+        m_entity_indices[entity.get()] = static_cast<uint32_t>(m_entities.size());
 		return m_entities.emplace_back(entity);
 	}
 
@@ -298,13 +371,15 @@ namespace Spartan
 
 	void World::EntityRemove(const shared_ptr<Entity>& entity)
 	{
-		if (!entity)
+		if (!entity || entity->IsPendingDestruction())
 			return;
 
+        lock_guard<recursive_mutex> lock(m_entities_mutex);
+
         // Mark for destruction but don't delete now
 	    // as the Renderer might still be using it.
         entity->MarkForDestruction();
-        m_is_dirty = true;
+        m_entities_pending_destruction.emplace_back(entity);
 	}
 
 	vector<shared_ptr<Entity>> World::EntityGetRoots()
@@ -358,18 +433,25 @@ namespace Spartan
         // Keep a reference to it's parent (in case it has one)
         auto parent = entity->GetTransform()->GetParent();
 
-        // Remove this entity
-        for (auto it = m_entities.begin(); it < m_entities.end();)
+        // Remove this entity by swapping it with the last one, it's kept alive until the renderer has been notified
+        auto it = m_entity_indices.find(entity.get());
+        if (it != m_entity_indices.end())
         {
-            const auto temp = *it;
-            if (temp->GetId() == entity->GetId())
+            const uint32_t index = it->second;
+            m_entity_indices.erase(it);
+            m_entities_removed.emplace_back(m_entities[index]);
+
+            if (index != m_entities.size() - 1)
             {
-                it = m_entities.erase(it);
-                break;
+                m_entities[index] = move(m_entities.back());
+                m_entity_indices[m_entities[index].get()] = index;
             }
-            ++it;
+            m_entities.pop_back();
         }
 
+        // Don't publish it as modified, it may be released before the next resolve
+        m_entities_modified.erase(entity.get());
+
         // If there was a parent, update it
         if (parent)
         {
@@ -377,6 +459,25 @@ namespace Spartan
         }
     }
 
+    void World::EntityMarkModified(const Variant& entity)
+    {
+        lock_guard<recursive_mutex> lock(m_entities_mutex);
+
+        // Events without an entity can't be resolved incrementally
+        Entity* const* entity_modified = get_if<Entity*>(&entity.GetVariantRaw());
+        if (!entity_modified || !*entity_modified)
+        {
+            m_is_dirty = true;
+            return;
+        }
+
+        // Removed entities are dropped by the renderer, don't bring them back
+        if ((*entity_modified)->IsPendingDestruction())
+            return;
+
+        m_entities_modified.insert(*entity_modified);
+    }
+
 	shared_ptr<Entity>& World::CreateEnvironment()
 	{
 		auto& environment = EntityCreate();
@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <memory>
 #include <string>
+#include <mutex>
+#include <unordered_set>
+#include <unordered_map>
 #include "../Core/EngineDefs.h"
 #include "../Core/ISubsystem.h"
 //=============================
@@ -35,6 +38,7 @@ namespace Spartan
 	class Light;
 	class Input;
 	class Profiler;
+	class Variant;
 
 	enum Scene_State
 	{
@@ -44,6 +48,25 @@ namespace Spartan
 		Loading
 	};
 
+	// The changes since the previous resolve, it's what Event_World_Resolve_Complete carries
+	struct WorldResolveDelta
+	{
+		std::vector<Entity*> added;
+		std::vector<Entity*> modified;	// components were added/removed or the entity was (de)activated
+		std::vector<Entity*> removed;	// still alive while the event is handled, don't hold on to them
+		bool reset = false;				// everything acquired so far should be dropped, added holds all the entities
+
+		void Clear()
+		{
+			added.clear();
+			modified.clear();
+			removed.clear();
+			reset = false;
+		}
+
+		bool IsEmpty() const { return !reset && added.empty() && modified.empty() && removed.empty(); }
+	};
+
 	class SPARTAN_CLASS World : public ISubsystem
 	{
 	public:
@@ -59,7 +82,8 @@ namespace Spartan
 		bool SaveToFile(const std::string& filePath);
 		bool LoadFromFile(const std::string& file_path);
 		const auto& GetName() const { return m_name; }
-        void MakeDirty() { m_is_dirty = true; }
+        void MakeDirty() { m_is_dirty = true; } // forces a full resolve, prefer firing Event_World_Resolve_Pending with the entity that changed
+        uint32_t GetFileVersion() const { return m_file_version; } // of the file being loaded, for components which have to read older layouts
 
 		//= Entities ===========================================================================
 		std::shared_ptr<Entity>& EntityCreate(bool is_active = true);
@@ -75,6 +99,7 @@ namespace Spartan
 
 	private:
         void _EntityRemove(const std::shared_ptr<Entity>& entity);
+        void EntityMarkModified(const Variant& entity);
 
 		//= COMMON ENTITY CREATION ========================
 		std::shared_ptr<Entity>& CreateEnvironment();
@@ -85,10 +110,20 @@ namespace Spartan
         std::string m_name;
         bool m_was_in_editor_mode   = false;
         bool m_is_dirty             = true;
+        uint32_t m_file_version     = 0;
         Scene_State m_state         = Ticking;	
         Input* m_input              = nullptr;
         Profiler* m_profiler        = nullptr;
 
         std::vector<std::shared_ptr<Entity>> m_entities;
+        std::unordered_map<const Entity*, uint32_t> m_entity_indices; // index into m_entities, keyed by address since ids are reassigned during deserialization
+
+        // Changes waiting for the next resolve, entities can be created from other threads (e.g. model loading)
+        std::vector<Entity*> m_entities_added;
+        std::unordered_set<Entity*> m_entities_modified; // purged when an entity is removed
+        std::vector<std::shared_ptr<Entity>> m_entities_pending_destruction;
+        std::vector<std::shared_ptr<Entity>> m_entities_removed; // kept alive until the delta has been published
+        WorldResolveDelta m_resolve_delta;
+        std::recursive_mutex m_entities_mutex;
 	};
 }
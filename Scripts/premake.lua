@@ -20,10 +20,14 @@
 SOLUTION_NAME		= "Spartan"
 EDITOR_NAME			= "Editor"
 RUNTIME_NAME		= "Runtime"
+PACKER_NAME			= "Packer"
+BENCHMARK_NAME		= "Benchmark"
 TARGET_NAME			= "Spartan" -- Name of executable
 DEBUG_FORMAT		= "c7"
 EDITOR_DIR			= "../" .. EDITOR_NAME
 RUNTIME_DIR			= "../" .. RUNTIME_NAME
+PACKER_DIR			= "../" .. PACKER_NAME
+BENCHMARK_DIR		= "../" .. BENCHMARK_NAME
 IGNORE_FILES		= {}
 LIBRARY_DIR			= "../ThirdParty/libraries"
 INTERMEDIATE_DIR	= "../Binaries/Intermediate"
@@ -37,16 +41,25 @@ if API_GRAPHICS == "d3d11" then
 	TARGET_NAME		= "Spartan_d3d11"
 	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D12/**"
 	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/Vulkan/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Null/**"
 elseif API_GRAPHICS == "d3d12" then
 	API_GRAPHICS	= "API_GRAPHICS_D3D12"
 	TARGET_NAME		= "Spartan_d3d12"
 	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D11/**"
 	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/Vulkan/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Null/**"
 elseif API_GRAPHICS == "vulkan" then
 	API_GRAPHICS	= "API_GRAPHICS_VULKAN"
 	TARGET_NAME		= "Spartan_vk"
 	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D11/**"
 	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/D3D12/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Null/**"
+elseif API_GRAPHICS == "null" then
+	API_GRAPHICS	= "API_GRAPHICS_NULL"
+	TARGET_NAME		= "Spartan_null"
+	IGNORE_FILES[0]	= RUNTIME_DIR .. "/RHI/D3D11/**"
+	IGNORE_FILES[1]	= RUNTIME_DIR .. "/RHI/D3D12/**"
+	IGNORE_FILES[2]	= RUNTIME_DIR .. "/RHI/Vulkan/**"
 end
 
 -- Solution
@@ -100,7 +113,7 @@ project (RUNTIME_NAME)
 	}
 	
 	-- Source to ignore
-	removefiles { IGNORE_FILES[0], IGNORE_FILES[1] }
+	removefiles { IGNORE_FILES[0], IGNORE_FILES[1], IGNORE_FILES[2] }
 
 	-- Includes
 	includedirs { "../ThirdParty/DirectXShaderCompiler" }
@@ -182,4 +195,75 @@ project (EDITOR_NAME)
 	-- "Release"
 	filter "configurations:Release"
 		targetdir (TARGET_DIR_RELEASE)
-		debugdir (TARGET_DIR_RELEASE)
\ No newline at end of file
+		debugdir (TARGET_DIR_RELEASE)
+
+-- Packer --------------------------------------------------------------------------------------------------
+project (PACKER_NAME)
+	location (PACKER_DIR)
+	links { RUNTIME_NAME }
+	dependson { RUNTIME_NAME }
+	objdir (INTERMEDIATE_DIR)
+	kind "ConsoleApp"
+	staticruntime "On"
+	defines{ "SPARTAN_PACKER", API_GRAPHICS }
+	
+	-- Files
+	files 
+	{ 
+		PACKER_DIR .. "/**.h",
+		PACKER_DIR .. "/**.cpp"
+	}
+	
+	-- Includes
+	includedirs { "../" .. RUNTIME_NAME }
+	
+	-- Libraries
+	libdirs (LIBRARY_DIR)
+
+	-- "Debug"
+	filter "configurations:Debug"
+		targetdir (TARGET_DIR_DEBUG)	
+		debugdir (TARGET_DIR_DEBUG)
+		debugformat (DEBUG_FORMAT)		
+				
+	-- "Release"
+	filter "configurations:Release"
+		targetdir (TARGET_DIR_RELEASE)
+		debugdir (TARGET_DIR_RELEASE)
+
+-- Benchmark -----------------------------------------------------------------------------------------------
+-- Headless, so it only goes into the null solution
+if API_GRAPHICS == "API_GRAPHICS_NULL" then
+project (BENCHMARK_NAME)
+	location (BENCHMARK_DIR)
+	links { RUNTIME_NAME }
+	dependson { RUNTIME_NAME }
+	objdir (INTERMEDIATE_DIR)
+	kind "ConsoleApp"
+	staticruntime "On"
+	defines{ "SPARTAN_BENCHMARK", API_GRAPHICS }
+	
+	-- Files
+	files 
+	{ 
+		BENCHMARK_DIR .. "/**.h",
+		BENCHMARK_DIR .. "/**.cpp"
+	}
+	
+	-- Includes
+	includedirs { "../" .. RUNTIME_NAME }
+	
+	-- Libraries
+	libdirs (LIBRARY_DIR)
+
+	-- "Debug"
+	filter "configurations:Debug"
+		targetdir (TARGET_DIR_DEBUG)	
+		debugdir (TARGET_DIR_DEBUG)
+		debugformat (DEBUG_FORMAT)		
+				
+	-- "Release"
+	filter "configurations:Release"
+		targetdir (TARGET_DIR_RELEASE)
+		debugdir (TARGET_DIR_RELEASE)
+end
\ No newline at end of file